@@ -0,0 +1,995 @@
+// Headless pipeline benchmark: N sources through capture -> FrameBuffer -> recorder
+// Build: cd build && cmake .. && make bench_pipeline
+// Run:   ./bench_pipeline [--source synthetic|camera|<file>|<rtsp url>] [--counts 1,4,8,16,32]
+//                         [--duration 10] [--warmup 2] [--size 1280x720] [--fps 30]
+//                         [--rate 1.0] [--record <dir>] [--no-buffer] [--motion]
+//                         [--analytics] [--render 480x270] [--memory-budget 512] [--paced 60]
+//                         [--verbose]
+//
+// Uses the application's own QtCameraCapture / QtRtspCapture / SyntheticCapture, FrameTap,
+// FramePool, FrameBuffer, QtVideoRecorder, RtspRemuxRecorder, MotionDetector, AnalyticsStage and FrameScaler
+// (the software renderer's conversion) - only the widgets are left out. For each slot count the sources are started, left to
+// settle for --warmup seconds and measured for --duration seconds.
+//
+// Output: one JSON object per slot count on stdout (JSON Lines, so runs can be
+// compared with jq or a spreadsheet), a summary table on stderr.
+
+#include <QApplication>
+
+#ifdef Q_OS_DARWIN
+#include <QtPlugin>
+Q_IMPORT_PLUGIN(QDarwinCameraPermissionPlugin)
+#endif
+
+#include <QCommandLineParser>
+#include <QEventLoop>
+#include <QTimer>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QVideoSink>
+#include <QVideoFrame>
+#include <QPainter>
+#include <QMediaDevices>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QDebug>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <memory>
+#include <vector>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+#ifdef Q_OS_DARWIN
+#include <mach/mach.h>
+#endif
+
+#include "src/core/Config.h"
+#include "src/core/Telemetry.h"
+#include "src/core/RecordingStorage.h"
+#include "src/core/FrameBuffer.h"
+#include "src/core/FramePool.h"
+#include "src/core/FrameScaler.h"
+#include "src/core/QtVideoRecorder.h"
+#include "src/core/RtspRemuxRecorder.h"
+#include "src/core/CaptureWorkerPool.h"
+#include "src/core/MotionDetector.h"
+#include "src/core/AnalyticsStage.h"
+#include "src/core/MemoryGovernor.h"
+#include "src/core/ThreadPolicy.h"
+#include "src/capture/QtCameraCapture.h"
+#include "src/capture/QtRtspCapture.h"
+#include "src/capture/SyntheticCapture.h"
+#include "src/capture/FrameTap.h"
+
+using namespace MCM;
+
+namespace {
+
+bool g_verbose = false;
+
+void messageHandler(QtMsgType type, const QMessageLogContext& context, const QString& message) {
+    // The capture classes log every state change; keep stderr readable
+    if (type == QtDebugMsg && !g_verbose) {
+        return;
+    }
+    std::fprintf(stderr, "%s\n", qPrintable(qFormatLogMessage(type, context, message)));
+}
+
+void waitMs(int ms) {
+    QEventLoop loop;
+    QTimer::singleShot(ms, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+struct BenchOptions {
+    QString source = "synthetic";  // synthetic | camera | file path | rtsp:// URL
+    QList<int> counts{1, 4, 8, 16, 32};
+    int durationSec = 10;
+    int warmupSec = 2;
+    QSize size{1280, 720};         // Synthetic only
+    int fps = 30;                  // Synthetic only
+    double rate = 1.0;             // Media file only: replay speed
+    QString recordDir;             // Empty = no recording
+    bool buffer = true;
+    bool motion = false;           // MotionDetector on every slot
+    bool analytics = false;        // Every slot in AnalyticsStage's batches
+    int pacedHz = 0;               // Consume buffers PTS-paced at this display rate (0 = as fast as possible)
+    QSize renderSize;              // Software-render every frame into a tile this size (empty = off)
+};
+
+enum class SourceKind { Synthetic, Camera, Media };
+
+struct ProcessStats {
+    double cpuSeconds{-1.0};
+    double rssMb{-1.0};
+    double peakRssMb{-1.0};  // Process lifetime
+};
+
+ProcessStats processStats() {
+    ProcessStats stats;
+#ifdef Q_OS_UNIX
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        stats.cpuSeconds = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+                         + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+#ifdef Q_OS_DARWIN
+        stats.peakRssMb = usage.ru_maxrss / (1024.0 * 1024.0);  // bytes
+#else
+        stats.peakRssMb = usage.ru_maxrss / 1024.0;             // kilobytes
+#endif
+    }
+#endif
+#ifdef Q_OS_LINUX
+    QFile statm("/proc/self/statm");
+    if (statm.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1) {
+            stats.rssMb = fields[1].toLongLong() * sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0);
+        }
+    }
+#elif defined(Q_OS_DARWIN)
+    mach_task_basic_info info{};
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                  reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS) {
+        stats.rssMb = info.resident_size / (1024.0 * 1024.0);
+    }
+#endif
+    return stats;
+}
+
+/**
+ * @brief Stage timings and counters of one run, shared by all slots
+ */
+struct StageStats {
+    LatencyHistogram deliver;   // Synthetic: generated -> FrameTap on the capture worker
+    LatencyHistogram map;       // FramePool CPU copy + QImage view
+    LatencyHistogram queue;     // FrameBuffer push -> consumer pop
+
+    std::atomic<bool> measuring{false};
+    std::atomic<quint64> mapFailures{0};
+};
+
+/**
+ * @brief One benchmarked camera slot (CameraSlot without the widgets)
+ */
+struct BenchSlot {
+    int id{0};
+    StageStats* stats{nullptr};
+    bool synthetic{false};
+
+    QVideoSink* sink{nullptr};  // Stands in for the tile's video item
+    QtCameraCapture* camera{nullptr};
+    QtRtspCapture* player{nullptr};
+    SyntheticCapture* pattern{nullptr};
+    QtVideoRecorder* recorder{nullptr};
+    RtspRemuxRecorder* remux{nullptr};
+    SlotTelemetry* telemetry{nullptr};
+    MotionDetector* motion{nullptr};
+    MotionDetector::Stats motionBase;  // Detector counters at the start of the window
+
+    // Software rendering stage (VideoWidget's conversion, capture worker only)
+    std::unique_ptr<FrameScaler> scaler;
+    QSize renderBox;
+    QImage tile;
+    std::atomic<quint64> rendered{0};
+    std::atomic<qint64> renderUs{0};
+    std::atomic<quint64> renderFallbacks{0};  // Formats FrameScaler does not handle
+
+    // CPU consumer stage
+    FrameBuffer* buffer{nullptr};
+    int memoryConsumer{0};  // The buffer's MemoryGovernor registration
+    FrameBuffer::PacingStats pacingBase;  // At the start of the window
+    std::unique_ptr<std::atomic<qint64>[]> pushTimes;  // Ring of push times, FIFO with the buffer
+    quint64 pushTimeCount{0};
+    quint64 pushed{0};  // Capture worker only
+    quint64 popped{0};  // Consumer thread only
+
+    std::atomic<quint64> observed{0};
+    quint64 generatedBase{0};  // Pattern counters at the start of the window
+    quint64 skippedBase{0};
+
+    FrameTap* tap() const {
+        if (camera) {
+            return camera->frameTap();
+        }
+        return player ? player->frameTap() : pattern->frameTap();
+    }
+
+    /**
+     * @brief FrameTap observer - runs on the slot's capture worker
+     */
+    void onFrame(const QVideoFrame& frame) {
+        const bool measuring = stats->measuring.load(std::memory_order_relaxed);
+        const qint64 arrivalUs = Telemetry::nowUs();
+        if (measuring) {
+            observed.fetch_add(1, std::memory_order_relaxed);
+            if (synthetic && frame.startTime() >= 0) {
+                stats->deliver.record(arrivalUs - frame.startTime());
+            }
+        }
+        if (!buffer && !scaler) {
+            return;
+        }
+
+        FrameRef ref = FramePool::instance().map(frame);
+        if (!ref) {
+            if (measuring) {
+                stats->mapFailures++;
+            }
+            return;
+        }
+        if (scaler) {
+            render(*ref, measuring);
+        }
+        if (!buffer) {
+            return;
+        }
+        const QImage image = ref->toImage();
+        const qint64 pushUs = Telemetry::nowUs();
+        if (measuring) {
+            stats->map.record(pushUs - arrivalUs);
+        }
+
+        // Twice the buffer capacity, so a refused push never overwrites a
+        // time the consumer has yet to read
+        pushTimes[pushed % pushTimeCount].store(pushUs, std::memory_order_relaxed);
+        if (buffer->push(image, frame.startTime())) {
+            pushed++;
+        }
+    }
+
+    /**
+     * @brief What VideoWidget::displayFrame(FrameRef) does before the blit
+     */
+    void render(const CpuFrame& frame, bool measuring) {
+        const qint64 startUs = Telemetry::nowUs();
+        const QSize fitted = frame.size().scaled(renderBox, Qt::KeepAspectRatio);
+        if (fitted.isEmpty()) {
+            return;
+        }
+        if (tile.size() != fitted) {
+            tile = QImage(fitted, QImage::Format_RGB32);
+        }
+        if (!scaler->scale(frame, tile)) {
+            // Same fallback as the widget: Qt's conversion, then a scaled draw
+            QPainter painter(&tile);
+            painter.drawImage(tile.rect(), frame.toImage());
+            if (measuring) {
+                renderFallbacks.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        if (measuring) {
+            rendered.fetch_add(1, std::memory_order_relaxed);
+            renderUs.fetch_add(Telemetry::nowUs() - startUs, std::memory_order_relaxed);
+        }
+    }
+};
+
+/**
+ * @brief Drains every slot's FrameBuffer (one consumer per buffer, as SPSC requires)
+ *
+ * Either as fast as frames come, or PTS-paced: one popPaced() per slot at
+ * every tick of a simulated display refresh.
+ */
+class BufferConsumer : public QThread {
+public:
+    BufferConsumer(const std::vector<std::unique_ptr<BenchSlot>>& slots, StageStats* stats, int pacedHz)
+        : m_slots(slots)
+        , m_stats(stats)
+        , m_refreshUs(pacedHz > 0 ? 1000000 / pacedHz : 0)
+    {
+        setObjectName("BufferConsumer");
+    }
+
+    void requestStop() { m_stop = true; }
+
+protected:
+    void run() override {
+        if (m_refreshUs > 0) {
+            runPaced();
+            return;
+        }
+        while (!m_stop) {
+            bool idle = true;
+            for (const auto& slot : m_slots) {
+                if (!slot->buffer) {
+                    continue;
+                }
+                const QImage image = slot->buffer->tryPop();
+                if (image.isNull()) {
+                    continue;
+                }
+                idle = false;
+                const qint64 pushUs = slot->pushTimes[slot->popped++ % slot->pushTimeCount]
+                                          .load(std::memory_order_relaxed);
+                if (m_stats->measuring.load(std::memory_order_relaxed)) {
+                    m_stats->queue.record(Telemetry::nowUs() - pushUs);
+                }
+            }
+            if (idle) {
+                QThread::usleep(500);
+            }
+        }
+    }
+
+    void runPaced() {
+        qint64 vsyncUs = Telemetry::nowUs();
+        while (!m_stop) {
+            vsyncUs += m_refreshUs;
+            const qint64 waitUs = vsyncUs - Telemetry::nowUs();
+            if (waitUs > 0) {
+                QThread::usleep(static_cast<unsigned long>(waitUs));
+            } else if (-waitUs > m_refreshUs) {
+                vsyncUs = Telemetry::nowUs();  // Missed refreshes: catch up, as a compositor would
+            }
+            for (const auto& slot : m_slots) {
+                if (!slot->buffer) {
+                    continue;
+                }
+                const FrameBuffer::PacedFrame frame = slot->buffer->popPaced(vsyncUs, m_refreshUs);
+                if (frame.isNull()) {
+                    continue;
+                }
+                // Dropped frames leave the push-time FIFO too
+                slot->popped += frame.dropped;
+                const qint64 pushUs = slot->pushTimes[slot->popped++ % slot->pushTimeCount]
+                                          .load(std::memory_order_relaxed);
+                if (m_stats->measuring.load(std::memory_order_relaxed)) {
+                    m_stats->queue.record(Telemetry::nowUs() - pushUs);
+                }
+            }
+        }
+    }
+
+private:
+    const std::vector<std::unique_ptr<BenchSlot>>& m_slots;
+    StageStats* m_stats;
+    qint64 m_refreshUs;
+    std::atomic<bool> m_stop{false};
+};
+
+// Telemetry objects outlive their runs - a frame already queued on a worker
+// may still hold the pointer after the capture is gone
+std::list<std::unique_ptr<SlotTelemetry>> g_telemetry;
+
+SourceKind sourceKind(const QString& source) {
+    if (source == "synthetic") {
+        return SourceKind::Synthetic;
+    }
+    if (source == "camera") {
+        return SourceKind::Camera;
+    }
+    return SourceKind::Media;
+}
+
+bool isLocalFile(const QString& source) {
+    return !source.contains("://");
+}
+
+std::unique_ptr<BenchSlot> createSlot(int id, const BenchOptions& options, SourceKind kind,
+                                      StageStats* stats) {
+    auto slot = std::make_unique<BenchSlot>();
+    slot->id = id;
+    slot->stats = stats;
+    slot->synthetic = kind == SourceKind::Synthetic;
+    slot->sink = new QVideoSink();
+
+    const bool record = !options.recordDir.isEmpty();
+
+    switch (kind) {
+    case SourceKind::Synthetic: {
+        // The application's test-pattern source (SourceType::Synthetic)
+        slot->pattern = new SyntheticCapture(id);
+        slot->pattern->setSpec(QString("%1x%2@%3").arg(options.size.width())
+                                   .arg(options.size.height()).arg(options.fps));
+        slot->pattern->setVideoOutput(slot->sink);
+        break;
+    }
+    case SourceKind::Camera: {
+        slot->camera = new QtCameraCapture(id);
+        slot->camera->setDeviceIndex(id);
+        slot->camera->setVideoOutput(slot->sink);
+        break;
+    }
+    case SourceKind::Media: {
+        // Files replay as SourceType::File does: looped, at --rate
+        slot->player = new QtRtspCapture(id);
+        slot->player->setVideoOutput(slot->sink);
+        if (isLocalFile(options.source)) {
+            slot->player->setMediaFile(QFileInfo(options.source).absoluteFilePath(), options.rate);
+        } else {
+            slot->player->setRtspUrl(options.source);
+        }
+        break;
+    }
+    }
+
+    if (options.buffer) {
+        const BufferConfig& bufferConfig = Config::instance().buffer();
+        slot->buffer = new FrameBuffer(bufferConfig, FrameBuffer::Mode::LockFreeSpsc);
+        FrameBuffer* buffer = slot->buffer;
+        slot->memoryConsumer = MemoryGovernor::instance().addConsumer({"framebuffer", id,
+            [buffer]() { return buffer->memoryBytes(); },
+            [buffer]() { return buffer->minimumMemoryBytes(); },
+            [buffer](qint64 limit) { buffer->setMemoryLimit(limit); }});
+        slot->pushTimeCount = static_cast<quint64>(slot->buffer->maxSize()) * 2;
+        slot->pushTimes.reset(new std::atomic<qint64>[slot->pushTimeCount]);
+    }
+
+    if (record) {
+        const RecordingConfig& recordingConfig = Config::instance().recording();
+        // Synthetic frames are recordable from Qt 6.8 (QVideoFrameInput)
+        if (kind == SourceKind::Camera || (slot->pattern && slot->pattern->captureSession())) {
+            slot->recorder = new QtVideoRecorder(id);
+            slot->recorder->setRotationMode(QtVideoRecorder::rotationModeFromString(recordingConfig.rotationMode));
+            slot->recorder->setEncodingProfile(Config::instance().encodingProfile(id));
+        } else if (kind == SourceKind::Media && isLocalFile(options.source)) {
+            slot->remux = new RtspRemuxRecorder(id);
+            slot->remux->setRtspUrl(QFileInfo(options.source).absoluteFilePath());
+            slot->remux->setFileReplay(options.rate);
+        } else if (kind == SourceKind::Media && options.source.startsWith("rtsp://", Qt::CaseInsensitive)) {
+            slot->remux = new RtspRemuxRecorder(id);
+            slot->remux->setRtspUrl(options.source);
+        }
+    }
+
+    if (!options.renderSize.isEmpty()) {
+        slot->scaler = std::make_unique<FrameScaler>();
+        slot->renderBox = options.renderSize;
+    }
+
+    if (options.motion) {
+        slot->motion = new MotionDetector(id);
+        slot->motion->setConfig(Config::instance().motion());
+        slot->motion->setEnabled(true);
+    }
+
+    BenchSlot* raw = slot.get();
+    FrameTap* tap = slot->tap();
+    tap->addObserver([raw](const QVideoFrame& frame) {
+        raw->onFrame(frame);
+    });
+    if (QtVideoRecorder* recorder = slot->recorder) {
+        tap->addObserver([recorder](const QVideoFrame& frame) {
+            recorder->notifyFrame(frame);
+        });
+    }
+    if (MotionDetector* motion = slot->motion) {
+        tap->addObserver([motion](const QVideoFrame& frame) {
+            motion->submit(frame);
+        });
+    }
+    if (options.analytics) {
+        AnalyticsStage::instance().setFrameSource(id, [tap](quint64* serial, qint64* arrivalUs) {
+            return tap->latestFrame(serial, arrivalUs);
+        });
+    }
+    return slot;
+}
+
+void startSlot(BenchSlot* slot, const BenchOptions& options) {
+    const RecordingConfig& recordingConfig = Config::instance().recording();
+    if (slot->pattern) {
+        if (slot->recorder) {
+            slot->recorder->setSession(slot->pattern->captureSession());
+            slot->recorder->startRecording(options.recordDir, recordingConfig.chunkDurationSeconds);
+        }
+        slot->pattern->start();
+    } else if (slot->camera) {
+        // Record once the camera delivers, as CameraSlot does
+        QtCameraCapture* camera = slot->camera;
+        QtVideoRecorder* recorder = slot->recorder;
+        QObject::connect(camera, &QtCameraCapture::firstFrameReceived, camera,
+                         [camera, recorder, options, recordingConfig]() {
+                             if (recorder && !recorder->isRecording()) {
+                                 recorder->setSession(camera->captureSession());
+                                 recorder->startRecording(options.recordDir,
+                                                          recordingConfig.chunkDurationSeconds);
+                             }
+                         });
+        camera->start();
+    } else if (slot->player) {
+        slot->player->start();
+        if (slot->remux) {
+            slot->remux->startRecording(options.recordDir, recordingConfig.chunkDurationSeconds);
+        }
+    }
+}
+
+void stopSlot(BenchSlot* slot) {
+    if (slot->pattern) {
+        slot->pattern->stop();
+    }
+    if (slot->camera) {
+        slot->camera->stop();
+    }
+    if (slot->player) {
+        slot->player->stop();
+    }
+    if (slot->recorder) {
+        slot->recorder->stopRecording();
+    }
+    if (slot->remux) {
+        slot->remux->stopRecording();
+    }
+}
+
+void destroySlot(BenchSlot* slot) {
+    // Before its tap goes away
+    AnalyticsStage::instance().removeFrameSource(slot->id);
+    if (slot->memoryConsumer) {
+        MemoryGovernor::instance().removeConsumer(slot->memoryConsumer);
+    }
+    // Captures first: deleting one releases its tap, which removes our observers
+    delete slot->camera;
+    delete slot->player;
+    delete slot->pattern;
+    delete slot->recorder;
+    delete slot->remux;
+    delete slot->sink;
+    delete slot->buffer;
+    if (slot->motion) {
+        slot->motion->release();
+    }
+}
+
+QJsonObject runBenchmark(const BenchOptions& options, int requestedSlots) {
+    const SourceKind kind = sourceKind(options.source);
+    int slotCount = requestedSlots;
+    if (kind == SourceKind::Camera) {
+        // A device cannot be opened twice
+        slotCount = qMin(requestedSlots, static_cast<int>(QMediaDevices::videoInputs().size()));
+    }
+
+    auto stats = std::make_unique<StageStats>();
+    std::vector<std::unique_ptr<BenchSlot>> slots;
+    for (int i = 0; i < slotCount; ++i) {
+        slots.push_back(createSlot(i, options, kind, stats.get()));
+    }
+
+    BufferConsumer consumer(slots, stats.get(), options.pacedHz);
+    if (options.buffer) {
+        consumer.start();
+    }
+
+    for (const auto& slot : slots) {
+        startSlot(slot.get(), options);
+    }
+    waitMs(options.warmupSec * 1000);
+
+    // Measurement window: fresh telemetry, so warmup does not count
+    for (const auto& slot : slots) {
+        g_telemetry.push_back(std::make_unique<SlotTelemetry>(slot->id));
+        slot->telemetry = g_telemetry.back().get();
+        slot->tap()->setTelemetry(slot->telemetry);
+        if (slot->recorder) {
+            slot->recorder->setTelemetry(slot->telemetry);
+        }
+        if (slot->pattern) {
+            slot->generatedBase = slot->pattern->framesGenerated();
+            slot->skippedBase = slot->pattern->framesSkipped();
+        }
+        if (slot->motion) {
+            slot->motionBase = slot->motion->stats();
+        }
+        if (slot->buffer) {
+            slot->pacingBase = slot->buffer->pacingStats();
+        }
+        slot->rendered = 0;
+        slot->renderUs = 0;
+        slot->renderFallbacks = 0;
+    }
+    const AnalyticsStage::Stats analyticsBase = AnalyticsStage::instance().stats();
+    const quint64 memoryTrimsBase = MemoryGovernor::instance().usage().trims;
+    ThreadPolicy::instance().sampleUsage();  // Per-thread CPU baseline
+    const ProcessStats before = processStats();
+    QElapsedTimer wall;
+    wall.start();
+    stats->measuring = true;
+
+    waitMs(options.durationSec * 1000);
+
+    // Encoder backlog is a gauge - read it before stopRecording() clears it
+    qint64 maxBacklogMs = -1;
+    for (const auto& slot : slots) {
+        maxBacklogMs = qMax(maxBacklogMs, slot->telemetry->snapshot().encoderBacklogMs);
+    }
+    const RecordingStorage::Stats storage = RecordingStorage::instance().stats();
+    stats->measuring = false;
+    const double wallSec = wall.nsecsElapsed() / 1e9;
+    const ProcessStats after = processStats();
+    const AnalyticsStage::Stats analyticsEnd = AnalyticsStage::instance().stats();
+    MemoryGovernor::instance().rebalance();
+    const MemoryGovernor::Usage memory = MemoryGovernor::instance().usage();
+    const QList<ThreadPolicy::ThreadUsage> threads = ThreadPolicy::instance().sampleUsage();
+
+    // Collect
+    quint64 observed = 0;
+    quint64 staleDrops = 0;
+    quint64 rotationDrops = 0;
+    quint64 coalescedDrops = 0;  // Superseded in the tap's mailbox while the worker was busy
+    quint64 bufferDrops = 0;
+    int slotsStreaming = 0;
+    double minSlotFps = -1.0;
+    double maxSlotFps = 0.0;
+    quint64 generated = 0;
+    quint64 generatorDrops = 0;  // Late ticks skipped, or refused by the frame input
+    LatencyHistogram::Snapshot jitter;
+    MotionDetector::Stats motion;  // Window totals over all slots
+    FrameBuffer::PacingStats pacing;  // Window totals; delay and jitter summed for the mean
+    int pacedSlots = 0;
+    quint64 rendered = 0;
+    qint64 renderUs = 0;
+    quint64 renderFallbacks = 0;
+    for (const auto& slot : slots) {
+        const SlotTelemetry::Snapshot t = slot->telemetry->snapshot();
+        const quint64 slotObserved = slot->observed.load();
+        observed += slotObserved;
+        staleDrops += t.dropped[static_cast<int>(SlotTelemetry::DropStage::Stale)];
+        rotationDrops += t.dropped[static_cast<int>(SlotTelemetry::DropStage::Rotation)];
+        coalescedDrops += t.dropped[static_cast<int>(SlotTelemetry::DropStage::Coalesced)];
+        bufferDrops += slot->buffer ? slot->buffer->droppedFrames() : 0;
+        if (slot->buffer) {
+            const FrameBuffer::PacingStats p = slot->buffer->pacingStats();
+            pacing.released += p.released - slot->pacingBase.released;
+            pacing.dropped += p.dropped - slot->pacingBase.dropped;
+            pacing.late += p.late - slot->pacingBase.late;
+            pacing.underruns += p.underruns - slot->pacingBase.underruns;
+            pacing.targetDelayUs += p.targetDelayUs;
+            pacing.jitterUs += p.jitterUs;
+            pacedSlots++;
+        }
+        jitter.merge(t.jitter);
+        if (slot->pattern) {
+            generated += slot->pattern->framesGenerated() - slot->generatedBase;
+            generatorDrops += slot->pattern->framesSkipped() - slot->skippedBase;
+        }
+        if (slot->motion) {
+            const MotionDetector::Stats m = slot->motion->stats();
+            motion.analyzed += m.analyzed - slot->motionBase.analyzed;
+            motion.superseded += m.superseded - slot->motionBase.superseded;
+            motion.busyUs += m.busyUs - slot->motionBase.busyUs;
+        }
+        rendered += slot->rendered.load();
+        renderUs += slot->renderUs.load();
+        renderFallbacks += slot->renderFallbacks.load();
+
+        const double slotFps = slotObserved / wallSec;
+        minSlotFps = minSlotFps < 0 ? slotFps : qMin(minSlotFps, slotFps);
+        maxSlotFps = qMax(maxSlotFps, slotFps);
+        if (slotObserved > 0) {
+            slotsStreaming++;
+        }
+    }
+
+    // Teardown
+    for (const auto& slot : slots) {
+        stopSlot(slot.get());
+    }
+    if (!options.recordDir.isEmpty()) {
+        waitMs(2000);  // Let the recorders finalize their chunks
+    }
+    consumer.requestStop();
+    consumer.wait();
+    for (const auto& slot : slots) {
+        destroySlot(slot.get());
+    }
+    waitMs(200);  // Taps are deleted on their workers
+    FramePool::instance().trim();
+
+    QJsonObject result;
+    result["slotsRequested"] = requestedSlots;
+    result["slots"] = slotCount;
+    result["slotsStreaming"] = slotsStreaming;
+    result["source"] = options.source;
+    if (kind == SourceKind::Synthetic) {
+        result["size"] = QString("%1x%2").arg(options.size.width()).arg(options.size.height());
+        result["targetFps"] = options.fps;
+    } else if (kind == SourceKind::Media && isLocalFile(options.source)) {
+        result["playbackRate"] = options.rate;
+    }
+    result["durationSec"] = wallSec;
+    result["recording"] = !options.recordDir.isEmpty();
+    result["buffer"] = options.buffer;
+    result["qtVersion"] = QString(qVersion());
+    result["captureWorkers"] = CaptureWorkerPool::instance().threadCount();
+    result["cores"] = QThread::idealThreadCount();
+
+    result["throughputFps"] = observed / wallSec;
+    result["slotFps"] = QJsonObject{
+        {"min", qMax(0.0, minSlotFps)},
+        {"mean", slotCount > 0 ? observed / wallSec / slotCount : 0.0},
+        {"max", maxSlotFps}
+    };
+
+    const double cpuSeconds = after.cpuSeconds - before.cpuSeconds;
+    result["cpuPercent"] = before.cpuSeconds < 0 ? -1.0 : 100.0 * cpuSeconds / wallSec;
+    result["rssMb"] = after.rssMb;
+    result["peakRssMb"] = after.peakRssMb;
+
+    QJsonObject frames{{"observed", static_cast<double>(observed)}};
+    if (kind == SourceKind::Synthetic) {
+        frames["generated"] = static_cast<double>(generated);
+    }
+    result["frames"] = frames;
+
+    QJsonObject dropped{
+        {"stale", static_cast<double>(staleDrops)},
+        {"buffer", static_cast<double>(bufferDrops)},
+        {"rotation", static_cast<double>(rotationDrops)},
+        {"coalesced", static_cast<double>(coalescedDrops)},
+        {"mapFailed", static_cast<double>(stats->mapFailures.load())}
+    };
+    if (kind == SourceKind::Synthetic) {
+        dropped["generator"] = static_cast<double>(generatorDrops);
+        // Handed to the pipeline but never reached the tap in the window
+        const quint64 accounted = observed + coalescedDrops;
+        dropped["inFlight"] = static_cast<double>(generated > accounted ? generated - accounted : 0);
+    }
+    result["dropped"] = dropped;
+
+    QJsonObject latency{
+        {"map", stats->map.snapshot().toJson()},
+        {"queue", stats->queue.snapshot().toJson()},
+        {"jitter", jitter.toJson()}
+    };
+    if (kind == SourceKind::Synthetic) {
+        latency["deliver"] = stats->deliver.snapshot().toJson();
+    }
+    result["latency"] = latency;
+    result["encoderBacklogMs"] = static_cast<double>(maxBacklogMs);
+    if (options.motion) {
+        // All detectors share one analysis thread: corePercent is its load
+        result["motion"] = QJsonObject{
+            {"kernel", MotionDetector::kernelName()},
+            {"analyzedFps", motion.analyzed / wallSec},
+            {"superseded", static_cast<double>(motion.superseded)},
+            {"corePercent", 100.0 * motion.busyUs / 1e6 / wallSec},
+            {"meanMs", motion.analyzed > 0 ? motion.busyUs / 1000.0 / motion.analyzed : 0.0}
+        };
+    }
+    if (options.buffer && options.pacedHz > 0) {
+        // latency.queue is push -> release, so it includes the pacing delay
+        result["pacing"] = QJsonObject{
+            {"displayHz", options.pacedHz},
+            {"releasedFps", pacing.released / wallSec},
+            {"dropped", static_cast<double>(pacing.dropped)},
+            {"late", static_cast<double>(pacing.late)},
+            {"underruns", static_cast<double>(pacing.underruns)},
+            {"targetDelayMs", pacedSlots > 0 ? pacing.targetDelayUs / 1000.0 / pacedSlots : 0.0},
+            {"jitterMs", pacedSlots > 0 ? pacing.jitterUs / 1000.0 / pacedSlots : 0.0}
+        };
+    }
+    // Frame buffers, pool and caches as the governor counts them, at the end of the window
+    result["memory"] = QJsonObject{
+        {"budgetMB", memory.budgetBytes / 1048576.0},
+        {"usedMB", memory.usedBytes / 1048576.0},
+        {"trims", static_cast<double>(memory.trims - memoryTrimsBase)},
+        {"pressure", memory.pressure}
+    };
+    // CPU per thread role over the window, and the busiest threads (Linux)
+    if (!threads.isEmpty()) {
+        QJsonObject roles;
+        QJsonArray top;
+        int offPolicy = 0;
+        for (const ThreadPolicy::ThreadUsage& thread : threads) {
+            const QString role = ThreadPolicy::roleName(thread.role);
+            roles[role] = roles.value(role).toDouble() + thread.cpuPercent;
+            offPolicy += thread.onPolicy ? 0 : 1;
+            if (top.size() < 8) {
+                top.append(QJsonObject{
+                    {"name", thread.name},
+                    {"role", role},
+                    {"cpuPercent", thread.cpuPercent},
+                    {"core", thread.lastCore},
+                    {"nice", thread.nice}
+                });
+            }
+        }
+        result["threads"] = QJsonObject{
+            {"count", threads.size()},
+            {"rolePercent", roles},
+            {"offPolicy", offPolicy},
+            {"top", top}
+        };
+    }
+    if (options.analytics) {
+        // One inference call per tick over all slots ("none" model: batching cost only)
+        const quint64 batches = analyticsEnd.batches - analyticsBase.batches;
+        const quint64 frames = analyticsEnd.frames - analyticsBase.frames;
+        const qint64 prepareUs = analyticsEnd.prepareUs - analyticsBase.prepareUs;
+        const qint64 inferUs = analyticsEnd.inferUs - analyticsBase.inferUs;
+        result["analytics"] = QJsonObject{
+            {"model", analyticsEnd.model},
+            {"batchesPerSec", batches / wallSec},
+            {"analyzedFps", frames / wallSec},
+            {"meanBatch", batches > 0 ? static_cast<double>(frames) / batches : 0.0},
+            {"stale", static_cast<double>(analyticsEnd.stale - analyticsBase.stale)},
+            {"deferred", static_cast<double>(analyticsEnd.deferred - analyticsBase.deferred)},
+            {"prepareMs", batches > 0 ? prepareUs / 1000.0 / batches : 0.0},
+            {"inferMs", batches > 0 ? inferUs / 1000.0 / batches : 0.0},
+            {"corePercent", 100.0 * (prepareUs + inferUs) / 1e6 / wallSec}
+        };
+    }
+    if (!options.renderSize.isEmpty()) {
+        // Summed over the capture workers: corePercent is what rendering every
+        // slot's tile would cost on one core
+        result["render"] = QJsonObject{
+            {"kernel", FrameScaler::kernelName()},
+            {"tile", QString("%1x%2").arg(options.renderSize.width()).arg(options.renderSize.height())},
+            {"renderedFps", rendered / wallSec},
+            {"fallbacks", static_cast<double>(renderFallbacks)},
+            {"corePercent", 100.0 * renderUs / 1e6 / wallSec},
+            {"meanMs", rendered > 0 ? renderUs / 1000.0 / rendered : 0.0}
+        };
+    }
+    if (!options.recordDir.isEmpty()) {
+        // Last flush interval of the recording storage thread
+        result["storage"] = QJsonObject{
+            {"ingestMBps", storage.ingestBytesPerSec / 1048576.0},
+            {"flushMBps", storage.flushBytesPerSec / 1048576.0},
+            {"utilization", storage.utilization},
+            {"backpressure", storage.backpressure}
+        };
+    }
+
+    return result;
+}
+
+void printSummary(const QJsonObject& r) {
+    const QJsonObject latency = r["latency"].toObject();
+    auto p95 = [&latency](const char* stage) {
+        return latency.contains(stage) ? latency[stage].toObject()["p95Ms"].toDouble() : -1.0;
+    };
+    const QJsonObject dropped = r["dropped"].toObject();
+    double drops = 0.0;
+    for (auto it = dropped.begin(); it != dropped.end(); ++it) {
+        drops += it.value().toDouble();
+    }
+    std::fprintf(stderr, "%5d %9d %11.1f %9.1f %7.0f %8.0f %8.0f %9.0f %8.0f %8.0f %8.0f\n",
+                 r["slots"].toInt(), r["slotsStreaming"].toInt(),
+                 r["throughputFps"].toDouble(), r["slotFps"].toObject()["mean"].toDouble(),
+                 r["cpuPercent"].toDouble(), r["rssMb"].toDouble(), drops,
+                 p95("deliver"), p95("map"), p95("queue"), r["encoderBacklogMs"].toDouble());
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    // Headless: no window system needed unless the caller asks for one
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+#ifdef Q_OS_LINUX
+    // Same backend as the application
+    if (!std::getenv("QT_MEDIA_BACKEND")) {
+        qputenv("QT_MEDIA_BACKEND", "ffmpeg");
+    }
+#endif
+
+    QApplication app(argc, argv);
+    QApplication::setApplicationName("bench_pipeline");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless multi-camera pipeline benchmark");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"source", "synthetic, camera, a media file or an rtsp:// URL.", "source", "synthetic"},
+        {"counts", "Comma-separated slot counts.", "list", "1,4,8,16,32"},
+        {"duration", "Measured seconds per slot count.", "seconds", "10"},
+        {"warmup", "Seconds to settle before measuring.", "seconds", "2"},
+        {"size", "Synthetic frame size.", "WxH", "1280x720"},
+        {"fps", "Synthetic frame rate.", "fps", "30"},
+        {"rate", "Media file replay speed (1.0 = native rate).", "factor", "1.0"},
+        {"record", "Record into this directory (QtVideoRecorder / RtspRemuxRecorder).", "dir"},
+        {"no-buffer", "Skip the FramePool -> FrameBuffer CPU consumer stage."},
+        {"motion", "Run motion analysis on every slot (motion settings from --config)."},
+        {"analytics", "Batch every slot through AnalyticsStage (analytics settings from --config, enabled)."},
+        {"render", "Software-render every frame into a tile of this size (VideoWidget path).", "WxH"},
+        {"memory-budget", "MemoryGovernor budget in MB for buffers and caches (overrides --config).", "MB"},
+        {"paced", "Consume the buffers PTS-paced against a display refreshing at this rate.", "Hz"},
+        {"config", "Configuration file (buffer, recording and encoding settings).", "file", "config.json"},
+        {"verbose", "Show the pipeline's debug output."}
+    });
+    parser.process(app);
+
+    g_verbose = parser.isSet("verbose");
+    qInstallMessageHandler(messageHandler);
+
+    BenchOptions options;
+    options.source = parser.value("source");
+    options.durationSec = qMax(1, parser.value("duration").toInt());
+    options.warmupSec = qMax(0, parser.value("warmup").toInt());
+    options.fps = parser.value("fps").toInt();
+    options.rate = parser.value("rate").toDouble();
+    options.recordDir = parser.value("record");
+    options.buffer = !parser.isSet("no-buffer");
+    options.motion = parser.isSet("motion");
+    options.analytics = parser.isSet("analytics");
+    options.pacedHz = qBound(0, parser.value("paced").toInt(), 240);
+    if (parser.isSet("render")) {
+        const QStringList parts = parser.value("render").split('x');
+        options.renderSize = parts.size() == 2 ? QSize(parts[0].toInt(), parts[1].toInt()) : QSize();
+        if (options.renderSize.isEmpty()) {
+            qWarning() << "Invalid --render" << parser.value("render") << "- expected WxH";
+            return 1;
+        }
+    }
+    QSize patternSize;
+    int patternFps = 0;
+    if (!SyntheticCapture::parseSpec(QString("%1@%2").arg(parser.value("size")).arg(options.fps),
+                                     &patternSize, &patternFps)) {
+        qWarning() << "Invalid --size/--fps" << parser.value("size") << options.fps
+                   << "- expected even WxH of at least 16x16 and 1-240 fps";
+        return 1;
+    }
+    options.size = patternSize;
+    if (options.rate <= 0.0) {
+        qWarning() << "Invalid --rate" << parser.value("rate");
+        return 1;
+    }
+    options.counts.clear();
+    for (const QString& part : parser.value("counts").split(',', Qt::SkipEmptyParts)) {
+        const int count = part.trimmed().toInt();
+        if (count > 0) {
+            options.counts.append(count);
+        }
+    }
+    if (options.counts.isEmpty()) {
+        qWarning() << "Invalid --counts" << parser.value("counts");
+        return 1;
+    }
+
+    if (QFile::exists(parser.value("config"))) {
+        Config::instance().load(parser.value("config"));
+    }
+    MemoryConfig memory = Config::instance().memory();
+    if (parser.isSet("memory-budget")) {
+        memory.budgetMB = qMax(0, parser.value("memory-budget").toInt());
+    }
+    MemoryGovernor::instance().configure(memory);
+    // Placement from --config; the report is the JSON's "threads" object instead of the log
+    SchedulingConfig scheduling = Config::instance().scheduling();
+    scheduling.reportIntervalSeconds = 0;
+    ThreadPolicy::instance().configure(scheduling);
+    if (options.analytics) {
+        AnalyticsConfig analytics = Config::instance().analytics();
+        analytics.enabled = true;
+        AnalyticsStage::instance().configure(analytics);
+    }
+    const SourceKind kind = sourceKind(options.source);
+    if (kind == SourceKind::Media && isLocalFile(options.source) && !QFile::exists(options.source)) {
+        qWarning() << "Source file not found:" << options.source;
+        return 1;
+    }
+#if QT_VERSION < QT_VERSION_CHECK(6, 8, 0)
+    if (kind == SourceKind::Synthetic && !options.recordDir.isEmpty()) {
+        qWarning() << "Recording synthetic sources needs Qt 6.8 (QVideoFrameInput) - recording skipped";
+    }
+#endif
+
+    std::fprintf(stderr, "bench_pipeline: source=%s duration=%ds warmup=%ds buffer=%s record=%s\n",
+                 qPrintable(options.source), options.durationSec, options.warmupSec,
+                 options.buffer ? "on" : "off",
+                 options.recordDir.isEmpty() ? "off" : qPrintable(options.recordDir));
+    std::fprintf(stderr, "%5s %9s %11s %9s %7s %8s %8s %9s %8s %8s %8s\n",
+                 "slots", "streaming", "total fps", "slot fps", "cpu %", "rss MB", "dropped",
+                 "deliver95", "map95", "queue95", "backlog");
+
+    for (int count : options.counts) {
+        const QJsonObject result = runBenchmark(options, count);
+        std::fprintf(stdout, "%s\n", QJsonDocument(result).toJson(QJsonDocument::Compact).constData());
+        std::fflush(stdout);
+        printSummary(result);
+    }
+    return 0;
+}
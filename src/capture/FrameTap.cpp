@@ -0,0 +1,177 @@
+#include "FrameTap.h"
+#include "core/CaptureWorkerPool.h"
+#include "core/Telemetry.h"
+#include <QMutexLocker>
+#include <QThread>
+#include <QDebug>
+
+namespace MCM {
+
+FrameTap::FrameTap(int slotId)
+    : QObject(nullptr)
+    , m_slotId(slotId)
+    , m_mailbox(this, [this](Pending pending) { process(pending); })
+{
+    m_clock.start();
+    moveToThread(CaptureWorkerPool::instance().threadFor(slotId));
+}
+
+void FrameTap::release() {
+    // Owners stop their session or player first, so no direct delivery is in flight
+    setSource(nullptr);
+    {
+        QMutexLocker locker(&m_observerMutex);
+        m_observers.clear();
+    }
+    m_generation++;  // Anything still queued is dropped
+    m_mailbox.clear();
+
+    // Once the pool has stopped there is no event loop left to run deleteLater
+    if (thread()->isRunning() && thread() != QThread::currentThread()) {
+        deleteLater();
+    } else {
+        delete this;
+    }
+}
+
+void FrameTap::setSource(QVideoSink* source) {
+    if (m_source == source && m_sourceConnection) {
+        return;
+    }
+    disconnect(m_sourceConnection);
+    m_source = source;
+    connectSource();
+}
+
+void FrameTap::reset() {
+    m_generation++;
+    m_frameCount = 0;
+    m_fps = 0.0;
+    m_awaitingFirstFrame = true;
+    if (SlotTelemetry* telemetry = m_telemetry.load()) {
+        telemetry->resetStream();
+    }
+    {
+        QMutexLocker locker(&m_frameMutex);
+        m_latestFrame = QVideoFrame();
+        m_latestSerial++;
+    }
+    disconnect(m_sourceConnection);
+    connectSource();
+}
+
+void FrameTap::connectSource() {
+    if (!m_source) {
+        m_sourceConnection = QMetaObject::Connection();
+        return;
+    }
+    // Arrivals are recorded on whichever thread the backend delivers on; the
+    // generation tags frames so a reset() discards anything still in flight
+    const quint64 generation = m_generation.load();
+    m_sourceConnection = connect(m_source, &QVideoSink::videoFrameChanged, this,
+                                 [this, generation](const QVideoFrame& frame) {
+                                     onArrival(frame, generation);
+                                 }, Qt::DirectConnection);
+}
+
+QVideoFrame FrameTap::latestFrame(quint64* serial, qint64* arrivalUs) const {
+    QMutexLocker locker(&m_frameMutex);
+    if (serial) {
+        *serial = m_latestSerial;
+    }
+    if (arrivalUs) {
+        *arrivalUs = m_latestArrivalUs;
+    }
+    return m_latestFrame;
+}
+
+int FrameTap::addObserver(FrameObserver observer) {
+    QMutexLocker locker(&m_observerMutex);
+    const int id = m_nextObserverId++;
+    m_observers.append(Observer{id, std::move(observer)});
+    return id;
+}
+
+void FrameTap::removeObserver(int id) {
+    // Observers run under this mutex, so none is mid-call once we hold it
+    QMutexLocker locker(&m_observerMutex);
+    for (int i = 0; i < m_observers.size(); ++i) {
+        if (m_observers[i].id == id) {
+            m_observers.removeAt(i);
+            return;
+        }
+    }
+}
+
+void FrameTap::onArrival(const QVideoFrame& frame, quint64 generation) {
+    SlotTelemetry* telemetry = m_telemetry.load();
+    if (generation != m_generation.load()) {
+        if (telemetry) {
+            telemetry->recordDrop(SlotTelemetry::DropStage::Stale);
+        }
+        return;
+    }
+    if (!frame.isValid()) {
+        return;
+    }
+    const qint64 arrivalUs = Telemetry::nowUs();
+    if (telemetry) {
+        telemetry->recordArrival(frame.startTime(), arrivalUs);
+    }
+
+    const qint64 nowMs = m_clock.elapsed();
+    const qint64 lastMs = m_lastArrivalMs.exchange(nowMs, std::memory_order_relaxed);
+    const quint64 count = m_frameCount.fetch_add(1, std::memory_order_relaxed);
+    if (count < 10 || count % 100 == 0) {
+        qDebug() << "FrameTap slot" << m_slotId << "frame#" << count
+                 << "size:" << frame.size()
+                 << "interval:" << (count == 0 ? 0 : nowMs - lastMs) << "ms"
+                 << "thread:" << QThread::currentThread();
+    }
+
+    // Keep the frame handle only - CPU mapping happens on demand (FramePool)
+    {
+        QMutexLocker locker(&m_frameMutex);
+        m_latestFrame = frame;
+        m_latestSerial++;
+        m_latestArrivalUs = arrivalUs;
+    }
+
+    if (m_mailbox.post(Pending{frame, generation}) && telemetry) {
+        telemetry->recordDrop(SlotTelemetry::DropStage::Coalesced);
+    }
+}
+
+void FrameTap::process(const Pending& pending) {
+    if (pending.generation != m_generation.load()) {
+        return;  // Counted as arrived; the stream was reset before we got to it
+    }
+
+    const quint64 count = m_frameCount.load(std::memory_order_relaxed);
+    if (pending.generation != m_seenGeneration) {
+        m_seenGeneration = pending.generation;
+        m_fpsWindowStart = count > 0 ? count - 1 : 0;
+        m_fpsClock.start();
+    }
+
+    const qint64 windowMs = m_fpsClock.elapsed();
+    if (windowMs >= 1000) {
+        // A reset() racing with us restarts the count; the next window is clean
+        m_fps = count >= m_fpsWindowStart ? ((count - m_fpsWindowStart) * 1000.0) / windowMs : 0.0;
+        m_fpsWindowStart = count;
+        m_fpsClock.restart();
+    }
+
+    {
+        QMutexLocker locker(&m_observerMutex);
+        for (const Observer& observer : m_observers) {
+            observer.callback(pending.frame);
+        }
+    }
+
+    if (m_awaitingFirstFrame.exchange(false)) {
+        emit firstFrame(pending.frame);
+    }
+}
+
+} // namespace MCM
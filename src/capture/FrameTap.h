@@ -0,0 +1,167 @@
+#ifndef FRAMETAP_H
+#define FRAMETAP_H
+
+#include <QObject>
+#include <QPointer>
+#include <QMutex>
+#include <QList>
+#include <QVideoSink>
+#include <QVideoFrame>
+#include <QElapsedTimer>
+#include <atomic>
+#include <functional>
+#include "core/LatestValueMailbox.h"
+
+namespace MCM {
+
+class SlotTelemetry;
+
+/**
+ * @brief Per-camera frame worker running on a CaptureWorkerPool thread
+ *
+ * Taps the sink that the capture session (or media player) renders into.
+ * Arrival bookkeeping - frame count, telemetry, latest-frame storage - runs
+ * directly on the thread that delivers the frame and takes a few atomics
+ * and one short lock. Everything else - fps, frame observers such as the
+ * recorder's frame-boundary hook and motion sampling - runs on the worker,
+ * fed through a latest-value mailbox: however far the worker falls behind,
+ * at most one delivery is queued and it carries the newest frame. The GUI
+ * thread only hears about a stream once, through firstFrame(); display
+ * stays sink-to-item as before.
+ *
+ * Created by the capture classes; they own the tap and release() it when
+ * they are destroyed. The capture objects themselves (QCamera,
+ * QMediaCaptureSession, QMediaPlayer, QMediaRecorder) stay on the GUI
+ * thread - Qt Multimedia requires them to live where their video outputs
+ * and windowing integration live.
+ */
+class FrameTap : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Called on the worker thread with the newest frame
+     *
+     * Frames that arrive while the worker is busy replace each other (and
+     * are counted as coalesced drops), so an observer sees every frame only
+     * as long as it keeps up. Must be quick and must not call back into the tap.
+     */
+    using FrameObserver = std::function<void(const QVideoFrame&)>;
+
+    /**
+     * @brief Create the tap and move it to the slot's worker thread
+     */
+    explicit FrameTap(int slotId);
+    ~FrameTap() override = default;
+
+    /**
+     * @brief Detach and delete the tap (call instead of delete)
+     *
+     * Stop the source delivering frames first: arrivals run on its thread.
+     */
+    void release();
+
+    /**
+     * @brief Sink to tap (nullptr detaches); callable from the owner's thread
+     */
+    void setSource(QVideoSink* source);
+    QVideoSink* source() const { return m_source; }
+
+    /**
+     * @brief Start a new stream: clears counters and the latest frame
+     *
+     * Frames still queued from the previous stream are discarded, and the
+     * next frame emits firstFrame() again.
+     */
+    void reset();
+
+    /**
+     * @brief Latest valid frame (thread-safe)
+     * @param serial If set, receives a number that changes with every frame
+     * @param arrivalUs If set, receives when the frame arrived (Telemetry::nowUs() clock)
+     */
+    QVideoFrame latestFrame(quint64* serial = nullptr, qint64* arrivalUs = nullptr) const;
+
+    /**
+     * @brief Frames received since the last reset()
+     */
+    quint64 frameCount() const { return m_frameCount.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Frame rate over the last full second
+     */
+    double fps() const { return m_fps.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Register a per-frame observer
+     * @return Id for removeObserver()
+     */
+    int addObserver(FrameObserver observer);
+
+    /**
+     * @brief Remove an observer; it is not called any more once this returns
+     */
+    void removeObserver(int id);
+
+    /**
+     * @brief Record arrivals, jitter and stale drops here (nullptr = off)
+     */
+    void setTelemetry(SlotTelemetry* telemetry) { m_telemetry = telemetry; }
+
+signals:
+    /**
+     * @brief First valid frame after reset() (emitted on the worker thread)
+     */
+    void firstFrame(const QVideoFrame& frame);
+
+private:
+    struct Pending {
+        QVideoFrame frame;
+        quint64 generation{0};
+    };
+
+    void connectSource();
+    void onArrival(const QVideoFrame& frame, quint64 generation);  // Delivering thread
+    void process(const Pending& pending);                          // Worker thread
+
+    struct Observer {
+        int id;
+        FrameObserver callback;
+    };
+
+    int m_slotId;
+    QPointer<QVideoSink> m_source;
+    QMetaObject::Connection m_sourceConnection;
+
+    std::atomic<SlotTelemetry*> m_telemetry{nullptr};
+
+    // Bumped by reset()/release() (not setSource()); frames queued under an older value are stale
+    std::atomic<quint64> m_generation{0};
+
+    mutable QMutex m_frameMutex;
+    QVideoFrame m_latestFrame;
+    quint64 m_latestSerial{0};
+    qint64 m_latestArrivalUs{0};
+
+    QMutex m_observerMutex;
+    QList<Observer> m_observers;
+    int m_nextObserverId{1};
+
+    // Arrival state (delivering thread)
+    std::atomic<quint64> m_frameCount{0};
+    std::atomic<qint64> m_lastArrivalMs{0};
+    QElapsedTimer m_clock;
+
+    LatestValueMailbox<Pending> m_mailbox;
+
+    // Worker-thread state
+    std::atomic<double> m_fps{0.0};
+    std::atomic<bool> m_awaitingFirstFrame{true};
+    QElapsedTimer m_fpsClock;
+    quint64 m_fpsWindowStart{0};    // m_frameCount when the fps window opened
+    quint64 m_seenGeneration{0};
+};
+
+} // namespace MCM
+
+#endif // FRAMETAP_H
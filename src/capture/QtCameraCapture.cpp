@@ -1,5 +1,8 @@
 #include "QtCameraCapture.h"
 #include "widgets/OptimizedVideoWidget.h"
+#include "utils/CapabilityCache.h"
+#include "VideoFanout.h"
+#include "FrameTap.h"
 #include <QDebug>
 #include <QCameraFormat>
 #include <QGraphicsVideoItem>
@@ -7,22 +10,60 @@
 #include <QThread>
 #include <QCoreApplication>
 #include <QDateTime>
+#include <QThreadPool>
 
 namespace MCM {
 
+namespace {
+
+QCameraFormat scoreFormats(const QList<QCameraFormat>& formats) {
+    QCameraFormat bestFormat;
+    int bestScore = -1;
+    
+    for (const auto& format : formats) {
+        QSize res = format.resolution();
+        float fps = format.maxFrameRate();
+        
+        int score = 0;
+        // Prefer 720p to reduce buffer pool contention with multiple cameras
+        if (res.height() == 720) {
+            score += 1000;  // 720p highest priority
+        } else if (res.height() == 1080) {
+            score += 800;   // 1080p as fallback
+        } else if (res.height() >= 480 && res.height() <= 1080) {
+            score += 100;
+        }
+        // Prefer frame rates around 30fps
+        if (fps >= 25 && fps <= 35) {
+            score += 100;
+        } else if (fps >= 50 && fps <= 65) {
+            score += 50;    // 60fps acceptable but not preferred (higher bandwidth)
+        }
+        
+        if (score > bestScore) {
+            bestScore = score;
+            bestFormat = format;
+        }
+    }
+    return bestFormat;
+}
+
+} // namespace
+
 QtCameraCapture::QtCameraCapture(int slotId, QObject* parent)
     : QObject(parent)
     , m_slotId(slotId)
-    , m_frameCount(0)
-    , m_lastFrameTime(QDateTime::currentMSecsSinceEpoch())
 {
     // Create capture session (manages the pipeline)
     m_session = new QMediaCaptureSession(this);
     
     // Create a video sink for frame access (needed for recording)
     m_frameSink = new QVideoSink(this);
-    connect(m_frameSink, &QVideoSink::videoFrameChanged,
-            this, &QtCameraCapture::onVideoFrameChanged);
+    m_fanout = new VideoFanout(this);
+    
+    // Per-frame work happens on a capture worker thread, not here
+    m_tap = new FrameTap(m_slotId);
+    connect(m_tap, &FrameTap::firstFrame, this, &QtCameraCapture::onFirstFrame);
     
     qDebug() << "QtCameraCapture::Constructor slot" << m_slotId 
              << "thread:" << QThread::currentThread()
@@ -32,12 +73,30 @@ QtCameraCapture::QtCameraCapture(int slotId, QObject* parent)
 QtCameraCapture::~QtCameraCapture() {
     stop();
     cleanupCamera();
+    m_tap->release();
 }
 
 QList<QCameraDevice> QtCameraCapture::availableDevices() {
     return QMediaDevices::videoInputs();
 }
 
+QCameraFormat QtCameraCapture::selectFormat(const QCameraDevice& device) {
+    // Known devices open straight into their last known-good format
+    return CapabilityCache::instance().resolveFormat(device, scoreFormats);
+}
+
+void QtCameraCapture::prefetchFormats(const QList<QCameraDevice>& devices) {
+    for (const QCameraDevice& device : devices) {
+        if (CapabilityCache::instance().contains(device)) {
+            continue;
+        }
+        // QCameraDevice is an implicitly shared value - safe to read off the GUI thread
+        QThreadPool::globalInstance()->start([device]() {
+            selectFormat(device);
+        });
+    }
+}
+
 void QtCameraCapture::setDeviceIndex(int index) {
     qDebug() << "=== QtCameraCapture::setDeviceIndex ===" << "slot" << m_slotId << "index:" << index;
     m_deviceIndex = index;
@@ -89,8 +148,7 @@ void QtCameraCapture::setupCamera(const QCameraDevice& device) {
              << "isMainThread:" << (QThread::currentThread() == QCoreApplication::instance()->thread());
     
     // Reset frame counter for new camera
-    m_frameCount = 0;
-    m_lastFrameTime = QDateTime::currentMSecsSinceEpoch();
+    m_tap->reset();
     
     // Store video output to restore after camera swap (like test_qt_only approach)
     QObject* savedVideoOutput = m_videoOutput;
@@ -142,34 +200,19 @@ void QtCameraCapture::setupCamera(const QCameraDevice& device) {
     QCoreApplication::processEvents();
     qDebug() << "  [" << timer.elapsed() << "ms] Events processed after setCamera";
     
-    // Configure camera format (prefer 1080p @ 30fps for quality)
-    auto formats = device.videoFormats();
-    QCameraFormat bestFormat;
-    int bestScore = -1;
-    
-    for (const auto& format : formats) {
-        QSize res = format.resolution();
-        float fps = format.maxFrameRate();
-        
-        int score = 0;
-        // Prefer 720p to reduce buffer pool contention with multiple cameras
-        if (res.height() == 720) {
-            score += 1000;  // 720p highest priority
-        } else if (res.height() == 1080) {
-            score += 800;   // 1080p as fallback
-        } else if (res.height() >= 480 && res.height() <= 1080) {
-            score += 100;
-        }
-        // Prefer frame rates around 30fps
-        if (fps >= 25 && fps <= 35) {
-            score += 100;
-        } else if (fps >= 50 && fps <= 65) {
-            score += 50;    // 60fps acceptable but not preferred (higher bandwidth)
+    // Configure camera format (usually already chosen by prefetchFormats)
+    QCameraFormat bestFormat = selectFormat(device);
+    if (m_maxCaptureHeight > 0 && bestFormat.resolution().height() > m_maxCaptureHeight) {
+        // Display-only slot: the tile never shows more than this, don't capture it
+        QList<QCameraFormat> capped;
+        for (const QCameraFormat& format : device.videoFormats()) {
+            if (format.resolution().height() <= m_maxCaptureHeight) {
+                capped.append(format);
+            }
         }
-        
-        if (score > bestScore) {
-            bestScore = score;
-            bestFormat = format;
+        if (!capped.isEmpty()) {
+            bestFormat = scoreFormats(capped);
+            qDebug() << "  Capture capped to" << m_maxCaptureHeight << "p for preview";
         }
     }
     
@@ -209,24 +252,14 @@ void QtCameraCapture::setVideoOutput(QObject* videoOutput) {
     qDebug() << "QtCameraCapture::setVideoOutput" << "slot" << m_slotId 
              << "videoOutput:" << videoOutput << "session:" << m_session;
     m_videoOutput = videoOutput;  // Store for session recreation
+    m_fanout->setSource(VideoFanout::sinkFor(videoOutput));
+    
+    // The frame tap follows the output's sink (item <-> preview sink switch)
+    // and sees every frame on its worker thread without touching the display
+    m_tap->setSource(VideoFanout::sinkFor(videoOutput));
     if (m_session) {
         m_session->setVideoOutput(videoOutput);
         qDebug() << "  Video output SET on session";
-        
-        // Connect to the video item's internal sink for frame access
-        // This allows us to get frames for FPS calculation without conflicting with display
-        QGraphicsVideoItem* videoItem = qobject_cast<QGraphicsVideoItem*>(videoOutput);
-        if (videoItem) {
-            QVideoSink* itemSink = videoItem->videoSink();
-            if (itemSink) {
-                // Disconnect any previous connection to avoid duplicates
-                disconnect(itemSink, &QVideoSink::videoFrameChanged,
-                          this, &QtCameraCapture::onVideoFrameChanged);
-                connect(itemSink, &QVideoSink::videoFrameChanged,
-                       this, &QtCameraCapture::onVideoFrameChanged);
-                qDebug() << "  Connected to video item's sink for frame access";
-            }
-        }
     } else {
         qDebug() << "  WARNING: No session to set video output on!";
     }
@@ -240,6 +273,18 @@ void QtCameraCapture::setVideoSink(QVideoSink* sink) {
     }
 }
 
+void QtCameraCapture::setTelemetry(SlotTelemetry* telemetry) {
+    m_tap->setTelemetry(telemetry);
+}
+
+void QtCameraCapture::addVideoOutput(QObject* output) {
+    m_fanout->addOutput(output);
+}
+
+void QtCameraCapture::removeVideoOutput(QObject* output) {
+    m_fanout->removeOutput(output);
+}
+
 void QtCameraCapture::start() {
     QElapsedTimer timer;
     timer.start();
@@ -302,6 +347,8 @@ void QtCameraCapture::stop() {
         m_session->setVideoOutput(nullptr);
     }
     m_videoOutput = nullptr;  // Clear stored pointer - video item will be recreated
+    m_tap->setSource(nullptr);
+    m_tap->reset();  // Drops the last frame and anything still queued
     
     m_connected = false;
     qDebug() << "  Stop complete";
@@ -318,7 +365,7 @@ void QtCameraCapture::onCameraActiveChanged(bool active) {
     qDebug() << "*** QtCameraCapture::onCameraActiveChanged ***" << "slot" << m_slotId
              << "active:" << active << "was_connected:" << m_connected
              << "timeSinceStart:" << timeSinceStart << "ms"
-             << "framesReceived:" << m_frameCount;
+             << "framesReceived:" << m_tap->frameCount();
     
     if (active && !m_connected) {
         m_connected = true;
@@ -335,6 +382,11 @@ void QtCameraCapture::onCameraErrorOccurred(QCamera::Error error, const QString&
     qWarning() << "QtCameraCapture: Error" << error << "-" << errorString 
                << "for slot" << m_slotId;
     
+    // Failed before delivering anything - don't open this format again
+    if (m_camera && m_tap->frameCount() == 0) {
+        CapabilityCache::instance().markFailed(m_camera->cameraDevice(), m_camera->cameraFormat());
+    }
+    
     if (m_connected) {
         m_connected = false;
         emit connectionLost();
@@ -343,36 +395,18 @@ void QtCameraCapture::onCameraErrorOccurred(QCamera::Error error, const QString&
     emit errorOccurred(errorString);
 }
 
-void QtCameraCapture::onVideoFrameChanged(const QVideoFrame& frame) {
+void QtCameraCapture::onFirstFrame(const QVideoFrame& frame) {
     qint64 now = QDateTime::currentMSecsSinceEpoch();
+    qint64 timeSinceStart = m_startRequestTime > 0 ? (now - m_startRequestTime) : 0;
+    qDebug() << "  ★★★ FIRST FRAME for slot" << m_slotId << "★★★"
+             << "Time from start() to first frame:" << timeSinceStart << "ms"
+             << "size:" << frame.size();
     
-    // Log first 10 frames AND every 100th frame with timing info
-    if (m_frameCount < 10 || (m_frameCount % 100 == 0)) {
-        qint64 timeSinceStart = m_startRequestTime > 0 ? (now - m_startRequestTime) : 0;
-        qint64 timeSinceLastFrame = now - m_lastFrameTime;
-        
-        qDebug() << "*** FRAME RECEIVED *** slot" << m_slotId
-                 << "frame#" << m_frameCount 
-                 << "valid:" << frame.isValid()
-                 << "size:" << frame.size()
-                 << "sinceStart:" << timeSinceStart << "ms"
-                 << "interval:" << timeSinceLastFrame << "ms";
-        
-        // First frame is especially important - log more details
-        if (m_frameCount == 0) {
-            qDebug() << "  ★★★ FIRST FRAME for slot" << m_slotId << "★★★"
-                     << "Time from start() to first frame:" << timeSinceStart << "ms";
-        }
-    }
-    
-    m_frameCount++;
-    m_lastFrameTime = now;
-    
-    // Emit frame for recording (if needed)
-    if (frame.isValid()) {
-        emit frameReady(frame);
+    // Delivered a frame - this format is known good for the device
+    if (m_camera) {
+        CapabilityCache::instance().markVerified(m_camera->cameraDevice(), m_camera->cameraFormat());
     }
+    emit firstFrameReceived();
 }
 
 } // namespace MCM
-
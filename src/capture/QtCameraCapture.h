@@ -13,6 +13,9 @@
 namespace MCM {
 
 class OptimizedVideoWidget;
+class VideoFanout;
+class FrameTap;
+class SlotTelemetry;
 
 /**
  * @brief Qt Multimedia-based camera capture
@@ -62,6 +65,15 @@ public:
      */
     void setVideoSink(QVideoSink* sink);
 
+    /**
+     * @brief Attach an extra display of the same decode (e.g. an expanded view)
+     *
+     * Frames reach the extra output sink-to-sink on the delivering thread (see
+     * VideoFanout) and keep flowing across restarts of this capture.
+     */
+    void addVideoOutput(QObject* output);
+    void removeVideoOutput(QObject* output);
+
     /**
      * @brief Start capturing
      */
@@ -107,6 +119,45 @@ public:
      */
     static QList<QCameraDevice> availableDevices();
 
+    /**
+     * @brief Pick the capture format for a device (720p@30 preferred)
+     *
+     * Backed by CapabilityCache: a device seen before (same bus info and
+     * mode list) gets its last known-good format without re-scoring, and
+     * formats that failed before their first frame are skipped.
+     */
+    static QCameraFormat selectFormat(const QCameraDevice& device);
+
+    /**
+     * @brief Enumerate and score formats for all devices on the thread pool
+     *
+     * Call before starting many slots so setupCamera() finds the choice
+     * already made instead of enumerating on the GUI thread.
+     */
+    static void prefetchFormats(const QList<QCameraDevice>& devices);
+
+    /**
+     * @brief Cap the capture resolution (0 = no cap, the default)
+     *
+     * Only for slots whose frames go to the display alone: the cap also
+     * applies to anything recorded from this session. Takes effect on the
+     * next setCameraDevice()/setDeviceIndex().
+     */
+    void setMaxCaptureHeight(int height) { m_maxCaptureHeight = qMax(0, height); }
+
+    /**
+     * @brief Per-frame tap of this capture (runs on a capture worker thread)
+     *
+     * Frame counts, fps, the latest frame and per-frame observers such as
+     * the recorder hook live here instead of in a per-frame signal.
+     */
+    FrameTap* frameTap() const { return m_tap; }
+
+    /**
+     * @brief Report this capture's frame metrics to @p telemetry (nullptr = off)
+     */
+    void setTelemetry(SlotTelemetry* telemetry);
+
 signals:
     /**
      * @brief Emitted when connection is established
@@ -124,14 +175,14 @@ signals:
     void errorOccurred(const QString& message);
 
     /**
-     * @brief Emitted when a new frame is available (optional, for recording)
+     * @brief Emitted once per camera setup, when the first frame arrives
      */
-    void frameReady(const QVideoFrame& frame);
+    void firstFrameReceived();
 
 private slots:
     void onCameraActiveChanged(bool active);
     void onCameraErrorOccurred(QCamera::Error error, const QString& errorString);
-    void onVideoFrameChanged(const QVideoFrame& frame);
+    void onFirstFrame(const QVideoFrame& frame);
 
 private:
     void setupCamera(const QCameraDevice& device);
@@ -140,15 +191,16 @@ private:
     int m_slotId;
     int m_deviceIndex{-1};
     bool m_connected{false};
+    int m_maxCaptureHeight{0};
 
     QCamera* m_camera{nullptr};
     QMediaCaptureSession* m_session{nullptr};
     QVideoSink* m_frameSink{nullptr};  // For frame access (recording)
     QObject* m_videoOutput{nullptr};   // Store for session recreation
+    VideoFanout* m_fanout{nullptr};    // Extra outputs fed from m_videoOutput's sink
+    FrameTap* m_tap{nullptr};          // Per-frame work, on a capture worker thread
     
     // Debug tracking
-    int m_frameCount{0};
-    qint64 m_lastFrameTime{0};
     qint64 m_startRequestTime{0};
 };
 
@@ -1,9 +1,32 @@
 #include "QtRtspCapture.h"
 #include "widgets/OptimizedVideoWidget.h"
+#include "VideoFanout.h"
+#include "FrameTap.h"
+#include "core/Telemetry.h"
+#include "core/DecoderScheduler.h"
 #include <QDebug>
 
+#if QT_VERSION >= QT_VERSION_CHECK(6, 10, 0)
+#include <QPlaybackOptions>
+#endif
+
 namespace MCM {
 
+namespace {
+
+// FFmpeg's RTSP demuxer reads the lower transport from the URL ("?tcp",
+// "&udp") and strips it before the request reaches the camera
+QUrl withTransport(const QUrl& url, const QString& transport) {
+    if (url.scheme().toLower() != "rtsp" || (transport != "tcp" && transport != "udp")) {
+        return url;
+    }
+    QUrl result(url);
+    result.setQuery(url.hasQuery() ? url.query() + "&" + transport : transport);
+    return result;
+}
+
+} // namespace
+
 QtRtspCapture::QtRtspCapture(int slotId, QObject* parent)
     : QObject(parent)
     , m_slotId(slotId)
@@ -12,8 +35,20 @@ QtRtspCapture::QtRtspCapture(int slotId, QObject* parent)
     
     // Create media player
     m_player = new QMediaPlayer(this);
+    m_fanout = new VideoFanout(this);
     qDebug() << "  QMediaPlayer created:" << m_player;
     
+    // Per-frame work happens on a capture worker thread, not here
+    m_tap = new FrameTap(m_slotId);
+    connect(m_tap, &FrameTap::firstFrame, this, [this](const QVideoFrame& frame) {
+        qDebug() << "*** QtRtspCapture first frame ***" << "slot" << m_slotId << "size:" << frame.size();
+        const auto path = DecoderScheduler::instance().reportFrame(this, frame);
+        if (m_telemetry) {
+            m_telemetry->setDecodePath(DecoderScheduler::pathName(path));
+        }
+        onFirstFrame();
+    });
+    
     // Note: Don't set videoSink here - it conflicts with setVideoOutput()
     // Video output will be set via setVideoOutput() when starting stream
     
@@ -57,6 +92,7 @@ QtRtspCapture::QtRtspCapture(int slotId, QObject* parent)
 
 QtRtspCapture::~QtRtspCapture() {
     stop();
+    m_tap->release();
 }
 
 void QtRtspCapture::setRtspUrl(const QString& url) {
@@ -70,10 +106,49 @@ void QtRtspCapture::setRtspUrl(const QString& url) {
         qWarning() << "  WARNING: Invalid RTSP URL format";
     }
     
-    m_player->setSource(qurl);
+    m_sourceUrl = withTransport(qurl, m_profile.transport);
+    qDebug() << "  Profile: transport" << m_profile.transport << "lowLatency" << m_profile.lowLatency
+             << "probeSize" << m_profile.probeSizeBytes;
+    m_player->setLoops(QMediaPlayer::Once);
+    m_player->setPlaybackRate(1.0);
+    applyPlaybackOptions(true);  // Read when the source is opened
+    m_player->setSource(m_sourceUrl);
     qDebug() << "  Source set on player";
 }
 
+void QtRtspCapture::setMediaFile(const QString& path, qreal playbackRate) {
+    qDebug() << "=== QtRtspCapture::setMediaFile ===" << "slot" << m_slotId;
+    qDebug() << "  File:" << path << "rate:" << playbackRate;
+    m_rtspUrl = path;
+    
+    // Loop forever so a short clip stands in for a camera
+    m_player->setLoops(QMediaPlayer::Infinite);
+    m_player->setPlaybackRate(qBound<qreal>(0.1, playbackRate, 16.0));
+    m_sourceUrl = QUrl::fromLocalFile(path);
+    applyPlaybackOptions(false);
+    m_player->setSource(m_sourceUrl);
+}
+
+void QtRtspCapture::applyPlaybackOptions(bool live) {
+    const bool tuned = live && (m_profile.lowLatency || m_profile.probeSizeBytes > 0);
+#if QT_VERSION >= QT_VERSION_CHECK(6, 10, 0)
+    QPlaybackOptions options;
+    if (tuned && m_profile.lowLatency) {
+        // nobuffer/low_delay demuxing, render on arrival, drop late frames
+        options.setPlaybackIntent(QPlaybackOptions::PlaybackIntent::LowLatencyStreaming);
+    }
+    if (tuned && m_profile.probeSizeBytes > 0) {
+        options.setProbeSize(m_profile.probeSizeBytes);
+    }
+    m_player->setPlaybackOptions(options);
+#else
+    if (tuned) {
+        qWarning() << "QtRtspCapture slot" << m_slotId
+                   << ": low-latency playback and probe size need Qt 6.10 - using default buffering";
+    }
+#endif
+}
+
 void QtRtspCapture::setVideoOutput(QObject* videoOutput) {
     qDebug() << "=== QtRtspCapture::setVideoOutput ===" << "slot" << m_slotId;
     qDebug() << "  VideoOutput:" << videoOutput;
@@ -83,7 +158,25 @@ void QtRtspCapture::setVideoOutput(QObject* videoOutput) {
     qDebug() << "  Player:" << m_player;
     qDebug() << "  Player current videoOutput before:" << m_player->videoOutput();
     m_player->setVideoOutput(videoOutput);
+    m_fanout->setSource(VideoFanout::sinkFor(videoOutput));
     qDebug() << "  Player videoOutput after:" << m_player->videoOutput();
+    
+    // The output's sink (item or decimating preview sink) carries every
+    // decoded frame - the tap handles them on its worker thread
+    m_tap->setSource(VideoFanout::sinkFor(videoOutput));
+}
+
+void QtRtspCapture::setTelemetry(SlotTelemetry* telemetry) {
+    m_telemetry = telemetry;
+    m_tap->setTelemetry(telemetry);
+}
+
+void QtRtspCapture::addVideoOutput(QObject* output) {
+    m_fanout->addOutput(output);
+}
+
+void QtRtspCapture::removeVideoOutput(QObject* output) {
+    m_fanout->removeOutput(output);
 }
 
 void QtRtspCapture::setVideoSink(QVideoSink* sink) {
@@ -112,7 +205,11 @@ void QtRtspCapture::start() {
     }
     
     m_shouldPlay = true;
-    m_reconnectAttempts = 0;
+    m_backoff.setConfig(Config::instance().reconnect());
+    m_backoff.reset();
+    m_outageTimer.invalidate();
+    m_tap->reset();
+    DecoderScheduler::instance().acquire(this, m_slotId, m_profile.decode);
     
     qDebug() << "  Calling m_player->play()...";
     m_player->play();
@@ -125,6 +222,7 @@ void QtRtspCapture::stop() {
     qDebug() << "=== QtRtspCapture::stop ===" << "slot" << m_slotId;
     m_shouldPlay = false;
     m_reconnectTimer->stop();
+    m_outageTimer.invalidate();
     
     if (m_player->playbackState() != QMediaPlayer::StoppedState) {
         qDebug() << "  Stopping playback...";
@@ -134,7 +232,10 @@ void QtRtspCapture::stop() {
     // Clear video output to ensure clean state for source switching
     qDebug() << "  Clearing video output...";
     m_player->setVideoOutput(nullptr);
+    m_tap->setSource(nullptr);
+    m_tap->reset();  // Drops the last frame and anything still queued
     
+    DecoderScheduler::instance().release(this);
     m_connected = false;
     qDebug() << "  Stop complete";
 }
@@ -153,18 +254,13 @@ void QtRtspCapture::onPlaybackStateChanged(QMediaPlayer::PlaybackState state) {
     qDebug() << "*** QtRtspCapture::onPlaybackStateChanged ***" << "slot" << m_slotId
              << "state:" << stateStr << "m_connected:" << m_connected;
     
+    // Backoff is reset by the first frame, not here: a camera that accepts
+    // the session and drops it at once must still back off
     if (state == QMediaPlayer::PlayingState && !m_connected) {
         m_connected = true;
-        m_reconnectAttempts = 0;
         emit connectionEstablished();
     } else if (state == QMediaPlayer::StoppedState && m_connected) {
-        m_connected = false;
-        emit connectionLost();
-        
-        // Attempt reconnection if we should be playing
-        if (m_shouldPlay && m_reconnectAttempts < MAX_RECONNECT_ATTEMPTS) {
-            m_reconnectTimer->start(RECONNECT_DELAY_MS);
-        }
+        handleDisconnect();
     }
 }
 
@@ -198,7 +294,6 @@ void QtRtspCapture::onMediaStatusChanged(QMediaPlayer::MediaStatus status) {
             // Buffering complete, connection stable
             if (!m_connected) {
                 m_connected = true;
-                m_reconnectAttempts = 0;
                 emit connectionEstablished();
             }
             break;
@@ -206,15 +301,7 @@ void QtRtspCapture::onMediaStatusChanged(QMediaPlayer::MediaStatus status) {
         case QMediaPlayer::EndOfMedia:
         case QMediaPlayer::InvalidMedia:
             // Stream ended or invalid
-            if (m_connected) {
-                m_connected = false;
-                emit connectionLost();
-            }
-            
-            // Attempt reconnection
-            if (m_shouldPlay && m_reconnectAttempts < MAX_RECONNECT_ATTEMPTS) {
-                m_reconnectTimer->start(RECONNECT_DELAY_MS);
-            }
+            handleDisconnect();
             break;
             
         case QMediaPlayer::StalledMedia:
@@ -239,39 +326,79 @@ void QtRtspCapture::onErrorOccurred(QMediaPlayer::Error error, const QString& er
     qWarning() << "*** QtRtspCapture::onErrorOccurred ***" << "slot" << m_slotId
                << "error:" << errorType << "-" << errorString;
     
+    emit errorOccurred(errorString);
+    handleDisconnect();
+}
+
+void QtRtspCapture::handleDisconnect() {
     if (m_connected) {
         m_connected = false;
         emit connectionLost();
     }
-    
-    emit errorOccurred(errorString);
-    
-    // Attempt reconnection on error
-    if (m_shouldPlay && m_reconnectAttempts < MAX_RECONNECT_ATTEMPTS) {
-        m_reconnectTimer->start(RECONNECT_DELAY_MS);
+    if (m_shouldPlay && !m_outageTimer.isValid()) {
+        m_outageTimer.start();
+    }
+    scheduleReconnect();
+}
+
+void QtRtspCapture::scheduleReconnect() {
+    // Loss, error and status changes often arrive together - one retry each time
+    if (!m_shouldPlay || m_reconnectTimer->isActive()) {
+        return;
     }
+    if (!m_backoff.canRetry()) {
+        qWarning() << "QtRtspCapture: Giving up on slot" << m_slotId << "after"
+                   << m_backoff.attempts() << "reconnect attempts";
+        emit errorOccurred(QString("Stream lost, gave up after %1 reconnect attempts").arg(m_backoff.attempts()));
+        return;
+    }
+    const int delayMs = m_backoff.nextDelayMs();
+    qDebug() << "QtRtspCapture: Reconnect attempt" << m_backoff.attempts() << "for slot" << m_slotId
+             << "in" << delayMs << "ms";
+    m_reconnectTimer->start(delayMs);
 }
 
 void QtRtspCapture::attemptReconnect() {
     if (!m_shouldPlay) {
         return;
     }
+    if (m_telemetry) {
+        m_telemetry->recordReconnect();
+    }
     
-    m_reconnectAttempts++;
-    qDebug() << "QtRtspCapture: Reconnect attempt" << m_reconnectAttempts 
-             << "/" << MAX_RECONNECT_ATTEMPTS << "for slot" << m_slotId;
+    // A new stream for the tap: first frame re-armed, timestamp baseline dropped
+    m_tap->reset();
     
-    // Reset source and play
-    m_player->setSource(QUrl(m_rtspUrl));
+    const QMediaPlayer::MediaStatus status = m_player->mediaStatus();
+    const bool warm = m_backoff.attempts() == 1 && m_player->source() == m_sourceUrl
+                   && status != QMediaPlayer::InvalidMedia && status != QMediaPlayer::NoMedia;
+    if (warm) {
+        // Same player, source, output and sink - only the session is reopened
+        qDebug() << "QtRtspCapture: Warm reconnect for slot" << m_slotId;
+        m_player->stop();
+        m_player->play();
+        return;
+    }
+    
+    // Cold: setSource() ignores the URL it already has, so clear it first
+    qDebug() << "QtRtspCapture: Reopening source for slot" << m_slotId;
+    m_player->setSource(QUrl());
+    m_player->setSource(m_sourceUrl);
     m_player->play();
 }
 
-void QtRtspCapture::onVideoFrameChanged(const QVideoFrame& frame) {
-    // Emit frame for recording (if needed)
-    if (frame.isValid()) {
-        emit frameReady(frame);
+void QtRtspCapture::onFirstFrame() {
+    // Frames flow again: the outage is over and the backoff starts afresh
+    m_backoff.reset();
+    if (m_outageTimer.isValid()) {
+        const qint64 outageMs = m_outageTimer.elapsed();
+        m_outageTimer.invalidate();
+        qDebug() << "QtRtspCapture: Slot" << m_slotId << "recovered after" << outageMs << "ms";
+        if (m_telemetry) {
+            m_telemetry->recordRecovery(outageMs);
+        }
     }
+    emit firstFrameReceived();
 }
 
 } // namespace MCM
-
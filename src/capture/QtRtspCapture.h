@@ -7,11 +7,17 @@
 #include <QVideoFrame>
 #include <QUrl>
 #include <QTimer>
+#include <QElapsedTimer>
 #include "core/Config.h"
+#include "core/ReconnectBackoff.h"
+#include "core/DecoderScheduler.h"
 
 namespace MCM {
 
 class OptimizedVideoWidget;
+class VideoFanout;
+class FrameTap;
+class SlotTelemetry;
 
 /**
  * @brief Qt Multimedia-based RTSP stream capture
@@ -23,6 +29,12 @@ class OptimizedVideoWidget;
  * - Direct GPU pipeline (no CPU frame copying)
  * - Lower latency
  * - Simpler code (no manual FFmpeg management)
+ *
+ * A lost stream is retried with exponential backoff and jitter (see
+ * ReconnectConfig), indefinitely by default. The first retry is warm - the
+ * player keeps its source, output and sink and just plays again; later
+ * retries reopen the source. The outage (loss to first frame) is reported
+ * to telemetry as time to recover.
  * 
  * Usage:
  *   QtRtspCapture* capture = new QtRtspCapture(slotId);
@@ -43,6 +55,30 @@ public:
      */
     void setRtspUrl(const QString& url);
 
+    /**
+     * @brief Transport and buffering for RTSP streams (applied by the next setRtspUrl())
+     *
+     * The transport goes to FFmpeg as an RTSP URL option; low-latency mode
+     * and probe size need QMediaPlayer playback options (Qt 6.10+) and are
+     * ignored, with a warning, on older Qt.
+     */
+    void setStreamProfile(const StreamProfile& profile) { m_profile = profile; }
+    const StreamProfile& streamProfile() const { return m_profile; }
+
+    /**
+     * @brief Decode path seen on the first frame (expected path until then)
+     */
+    DecoderScheduler::Path decodePath() const { return DecoderScheduler::instance().activePath(this); }
+
+    /**
+     * @brief Play a local media file instead of a stream (File source type)
+     * @param path File to play; it loops until stop()
+     * @param playbackRate 1.0 = native rate, 2.0 = twice as fast
+     *
+     * Replaces any URL set with setRtspUrl(); rtspUrl() then returns @p path.
+     */
+    void setMediaFile(const QString& path, qreal playbackRate = 1.0);
+
     /**
      * @brief Get the current RTSP URL
      */
@@ -60,6 +96,15 @@ public:
      */
     void setVideoSink(QVideoSink* sink);
 
+    /**
+     * @brief Attach an extra display of the same decode (e.g. an expanded view)
+     *
+     * Frames reach the extra output sink-to-sink on the delivering thread (see
+     * VideoFanout) and keep flowing across restarts of this capture.
+     */
+    void addVideoOutput(QObject* output);
+    void removeVideoOutput(QObject* output);
+
     /**
      * @brief Start playback/capture
      */
@@ -90,6 +135,21 @@ public:
      */
     QMediaPlayer* mediaPlayer() const { return m_player; }
 
+    /**
+     * @brief Per-frame tap of this capture (runs on a capture worker thread)
+     */
+    FrameTap* frameTap() const { return m_tap; }
+
+    /**
+     * @brief Report frame metrics, reconnects and recoveries to @p telemetry (nullptr = off)
+     */
+    void setTelemetry(SlotTelemetry* telemetry);
+
+    /**
+     * @brief Consecutive reconnect attempts of the current outage (0 = streaming)
+     */
+    int reconnectAttempts() const { return m_backoff.attempts(); }
+
 signals:
     /**
      * @brief Emitted when connection is established
@@ -107,31 +167,39 @@ signals:
     void errorOccurred(const QString& message);
 
     /**
-     * @brief Emitted when a new frame is available (optional, for recording)
+     * @brief Emitted once per start(), when the first frame arrives
      */
-    void frameReady(const QVideoFrame& frame);
+    void firstFrameReceived();
 
 private slots:
     void onPlaybackStateChanged(QMediaPlayer::PlaybackState state);
     void onMediaStatusChanged(QMediaPlayer::MediaStatus status);
     void onErrorOccurred(QMediaPlayer::Error error, const QString& errorString);
-    void onVideoFrameChanged(const QVideoFrame& frame);
     void attemptReconnect();
 
 private:
+    void applyPlaybackOptions(bool live);
+    void handleDisconnect();
+    void scheduleReconnect();
+    void onFirstFrame();
+
     int m_slotId;
     QString m_rtspUrl;
+    QUrl m_sourceUrl;  // What the player was given (RTSP URL + transport option, or file URL)
+    StreamProfile m_profile;
     bool m_connected{false};
     bool m_shouldPlay{false};  // Track if user wants playback
 
     QMediaPlayer* m_player{nullptr};
     QVideoSink* m_frameSink{nullptr};  // For frame access (recording)
+    VideoFanout* m_fanout{nullptr};    // Extra outputs fed from the player's output sink
+    FrameTap* m_tap{nullptr};          // Per-frame work, on a capture worker thread
+    SlotTelemetry* m_telemetry{nullptr};
     
     // Reconnection
     QTimer* m_reconnectTimer{nullptr};
-    int m_reconnectAttempts{0};
-    static constexpr int MAX_RECONNECT_ATTEMPTS = 5;
-    static constexpr int RECONNECT_DELAY_MS = 3000;
+    ReconnectBackoff m_backoff;
+    QElapsedTimer m_outageTimer;  // Running from connection loss to the next first frame
 };
 
 } // namespace MCM
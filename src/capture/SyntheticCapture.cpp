@@ -0,0 +1,321 @@
+#include "SyntheticCapture.h"
+#include "VideoFanout.h"
+#include "FrameTap.h"
+#include "core/Telemetry.h"
+#include "core/ThreadPolicy.h"
+#include <QThread>
+#include <QTimer>
+#include <QImage>
+#include <QPainter>
+#include <QPointer>
+#include <QStringList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVideoSink>
+#include <QVideoFrame>
+#include <QVideoFrameFormat>
+#include <QMediaCaptureSession>
+#include <QDebug>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+#include <QVideoFrameInput>
+#define MCM_HAVE_FRAME_INPUT 1
+#else
+#define MCM_HAVE_FRAME_INPUT 0
+#endif
+
+namespace MCM {
+
+/**
+ * @brief Frame generator, living on the capture's own thread
+ *
+ * Each frame is a copy of a pre-rendered background plus a moving bar, so
+ * the per-frame cost is close to a decoder handing over a buffer and the
+ * content changes like real video for encoders and motion analytics.
+ */
+class SyntheticCapture::Generator : public QObject {
+public:
+    explicit Generator(int slotId) : m_slotId(slotId) {}
+
+    /**
+     * @brief Render the background for a format (only while stopped)
+     */
+    void configure(const QSize& size, int fps) {
+        m_fps = qMax(1, fps);
+        m_intervalUs = 1000000 / m_fps;
+        m_format = QVideoFrameFormat(size, QVideoFrameFormat::pixelFormatFromImageFormat(QImage::Format_RGB32));
+
+        m_background = QImage(size, QImage::Format_RGB32);
+        m_background.fill(QColor::fromHsv((m_slotId * 37) % 360, 90, 70));
+        QPainter painter(&m_background);
+        painter.setPen(Qt::white);
+        painter.setFont(QFont("Sans", qMax(8, size.height() / 12)));
+        painter.drawText(m_background.rect(), Qt::AlignCenter,
+                         QString("Slot %1\n%2x%3 @ %4").arg(m_slotId).arg(size.width())
+                             .arg(size.height()).arg(m_fps));
+    }
+
+    void setSink(QVideoSink* sink) {
+        QMutexLocker locker(&m_sinkMutex);
+        m_sink = sink;
+    }
+
+#if MCM_HAVE_FRAME_INPUT
+    void setFrameInput(QVideoFrameInput* input) { m_input = input; }
+#endif
+
+    // Generator thread
+    void start() {
+        if (!m_timer) {
+            m_timer = new QTimer(this);
+            m_timer->setTimerType(Qt::PreciseTimer);
+            m_timer->setSingleShot(true);
+            connect(m_timer, &QTimer::timeout, this, [this]() { tick(); });
+        }
+        m_frameIndex = 0;
+        m_nextUs = Telemetry::nowUs();
+        m_timer->start(0);
+    }
+
+    void stop() {
+        if (m_timer) {
+            m_timer->stop();
+        }
+    }
+
+    std::atomic<quint64> generated{0};
+    std::atomic<quint64> skipped{0};
+
+private:
+    void tick() {
+        const qint64 startUs = Telemetry::nowUs();
+
+        // More than a frame behind (loaded machine): skip ahead, like a
+        // camera dropping at the sensor, instead of sending a burst
+        m_nextUs += m_intervalUs;
+        while (m_nextUs < startUs - m_intervalUs) {
+            m_nextUs += m_intervalUs;
+            skipped.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        QVideoFrame frame(m_format);
+        if (frame.map(QVideoFrame::WriteOnly)) {
+            uchar* bits = frame.bits(0);
+            const int stride = frame.bytesPerLine(0);
+            const int rowBytes = qMin<int>(m_background.bytesPerLine(), stride);
+            const int width = m_background.width();
+            const int barWidth = qMax(1, width / 16);
+            // Crosses the frame in two seconds
+            const int step = qMax(1, (width - barWidth) / (2 * m_fps));
+            const int barX = static_cast<int>((m_frameIndex * step) % static_cast<quint64>(width - barWidth + 1));
+            for (int y = 0; y < m_background.height(); ++y) {
+                uchar* row = bits + y * stride;
+                std::memcpy(row, m_background.constScanLine(y), rowBytes);
+                quint32* bar = reinterpret_cast<quint32*>(row) + barX;
+                std::fill(bar, bar + barWidth, 0xFFFFFFFFu);
+            }
+            frame.unmap();
+            frame.setStartTime(startUs);
+            frame.setEndTime(startUs + m_intervalUs);
+            m_frameIndex++;
+
+#if MCM_HAVE_FRAME_INPUT
+            if (m_input) {
+                if (!m_input->sendVideoFrame(frame)) {
+                    skipped.fetch_add(1, std::memory_order_relaxed);  // Session not ready
+                } else {
+                    generated.fetch_add(1, std::memory_order_relaxed);
+                }
+            } else
+#endif
+            {
+                QMutexLocker locker(&m_sinkMutex);
+                if (m_sink) {
+                    m_sink->setVideoFrame(frame);
+                }
+                generated.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        m_timer->start(static_cast<int>(qMax<qint64>(0, (m_nextUs - Telemetry::nowUs()) / 1000)));
+    }
+
+    int m_slotId;
+    int m_fps{30};
+    qint64 m_intervalUs{33333};
+    QVideoFrameFormat m_format;
+    QImage m_background;
+
+    QMutex m_sinkMutex;
+    QPointer<QVideoSink> m_sink;
+#if MCM_HAVE_FRAME_INPUT
+    QVideoFrameInput* m_input{nullptr};
+#endif
+
+    QTimer* m_timer{nullptr};
+    quint64 m_frameIndex{0};
+    qint64 m_nextUs{0};
+};
+
+SyntheticCapture::SyntheticCapture(int slotId, QObject* parent)
+    : QObject(parent)
+    , m_slotId(slotId)
+{
+    m_fanout = new VideoFanout(this);
+
+    m_tap = new FrameTap(m_slotId);
+    connect(m_tap, &FrameTap::firstFrame, this, [this]() {
+        if (m_active) {
+            emit firstFrameReceived();
+        }
+    });
+
+    m_thread = new QThread();
+    m_thread->setObjectName(QString("Synthetic-%1").arg(m_slotId));
+    ThreadPolicy::instance().attach(m_thread, ThreadPolicy::Role::Capture);
+    m_generator = new Generator(m_slotId);
+
+#if MCM_HAVE_FRAME_INPUT
+    // Frames enter a capture session like camera frames, so QtVideoRecorder can record them
+    auto* input = new QVideoFrameInput();
+    m_session = new QMediaCaptureSession(this);
+    m_session->setVideoFrameInput(input);
+    m_generator->setFrameInput(input);
+    input->moveToThread(m_thread);
+    m_frameInput = input;
+#endif
+    m_generator->moveToThread(m_thread);
+
+    qDebug() << "SyntheticCapture: Created slot" << m_slotId
+             << (m_session ? "(recordable)" : "(display only, recording needs Qt 6.8)");
+}
+
+SyntheticCapture::~SyntheticCapture() {
+    stop();
+    m_thread->quit();
+    m_thread->wait();
+    // Thread has finished, so its objects can go from here
+    delete m_generator;
+    delete m_session;
+    delete m_frameInput;
+    delete m_thread;
+    m_tap->release();
+}
+
+bool SyntheticCapture::parseSpec(const QString& spec, QSize* size, int* fps) {
+    const QStringList parts = spec.trimmed().toLower().split('@');
+    const QStringList dims = parts.value(0).split('x');
+    if (parts.size() > 2 || dims.size() != 2) {
+        return false;
+    }
+    bool okWidth = false;
+    bool okHeight = false;
+    bool okFps = true;
+    const QSize parsedSize(dims[0].toInt(&okWidth), dims[1].toInt(&okHeight));
+    const int parsedFps = parts.size() == 2 ? parts[1].toInt(&okFps) : 30;
+    // Even dimensions keep every encoder happy
+    if (!okWidth || !okHeight || !okFps || parsedSize.width() < 16 || parsedSize.height() < 16
+        || parsedSize.width() % 2 || parsedSize.height() % 2 || parsedFps < 1 || parsedFps > 240) {
+        return false;
+    }
+    *size = parsedSize;
+    *fps = parsedFps;
+    return true;
+}
+
+bool SyntheticCapture::setSpec(const QString& spec) {
+    QSize size;
+    int fps = 0;
+    if (!parseSpec(spec.isEmpty() ? QString(DEFAULT_SPEC) : spec, &size, &fps)) {
+        qWarning() << "SyntheticCapture: Invalid spec" << spec << "- expected WIDTHxHEIGHT@FPS";
+        emit errorOccurred(QString("Invalid test pattern format: %1").arg(spec));
+        return false;
+    }
+    m_size = size;
+    m_fps = fps;
+    return true;
+}
+
+void SyntheticCapture::setVideoOutput(QObject* videoOutput) {
+    m_videoOutput = videoOutput;
+    QVideoSink* sink = VideoFanout::sinkFor(videoOutput);
+    m_fanout->setSource(sink);
+    m_tap->setSource(sink);
+    if (m_session) {
+        m_session->setVideoOutput(videoOutput);
+    } else {
+        m_generator->setSink(sink);
+    }
+}
+
+void SyntheticCapture::addVideoOutput(QObject* output) {
+    m_fanout->addOutput(output);
+}
+
+void SyntheticCapture::removeVideoOutput(QObject* output) {
+    m_fanout->removeOutput(output);
+}
+
+void SyntheticCapture::setTelemetry(SlotTelemetry* telemetry) {
+    m_tap->setTelemetry(telemetry);
+}
+
+quint64 SyntheticCapture::framesGenerated() const {
+    return m_generator->generated.load(std::memory_order_relaxed);
+}
+
+quint64 SyntheticCapture::framesSkipped() const {
+    return m_generator->skipped.load(std::memory_order_relaxed);
+}
+
+void SyntheticCapture::start() {
+    if (m_active) {
+        return;
+    }
+    qDebug() << "SyntheticCapture::start slot" << m_slotId << m_size << "@" << m_fps << "fps";
+    if (!m_videoOutput) {
+        qWarning() << "  WARNING: No video output set - frames won't be displayed!";
+    }
+
+    m_active = true;
+    m_tap->reset();
+    m_generator->configure(m_size, m_fps);
+    if (!m_thread->isRunning()) {
+        m_thread->start();
+    }
+    Generator* generator = m_generator;
+    QMetaObject::invokeMethod(generator, [generator]() { generator->start(); }, Qt::QueuedConnection);
+
+    // Reported from the event loop, as camera backends do
+    QMetaObject::invokeMethod(this, [this]() {
+        if (m_active) {
+            emit connectionEstablished();
+        }
+    }, Qt::QueuedConnection);
+}
+
+void SyntheticCapture::stop() {
+    if (!m_active) {
+        return;
+    }
+    qDebug() << "SyntheticCapture::stop slot" << m_slotId
+             << "generated:" << framesGenerated() << "skipped:" << framesSkipped();
+    m_active = false;
+
+    // Blocking, so no frame is in flight once we detach the output
+    Generator* generator = m_generator;
+    QMetaObject::invokeMethod(generator, [generator]() { generator->stop(); }, Qt::BlockingQueuedConnection);
+
+    if (m_session) {
+        m_session->setVideoOutput(nullptr);
+    }
+    m_generator->setSink(nullptr);
+    m_videoOutput = nullptr;
+    m_tap->setSource(nullptr);
+    m_tap->reset();
+}
+
+} // namespace MCM
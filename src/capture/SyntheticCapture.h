@@ -0,0 +1,142 @@
+#ifndef SYNTHETICCAPTURE_H
+#define SYNTHETICCAPTURE_H
+
+#include <QObject>
+#include <QSize>
+#include <QString>
+#include <QElapsedTimer>
+
+class QThread;
+class QMediaCaptureSession;
+class QVideoFrame;
+
+namespace MCM {
+
+class VideoFanout;
+class FrameTap;
+class SlotTelemetry;
+
+/**
+ * @brief Test-pattern source for load testing (Synthetic source type)
+ *
+ * Generates frames of a chosen size and rate on its own thread, the way a
+ * camera backend delivers them, and feeds the same outputs, frame tap and
+ * recorder hooks as QtCameraCapture. A slot configured as synthetic costs
+ * what a camera of that format costs downstream, without the camera.
+ *
+ * Frames carry Telemetry::nowUs() as their start time, so latency figures
+ * for synthetic slots are absolute.
+ *
+ * Recording goes through captureSession() with QVideoFrameInput, which
+ * needs Qt 6.8; on older Qt the frames go straight to the video output and
+ * captureSession() is nullptr (display and analytics only).
+ *
+ * Usage:
+ *   SyntheticCapture* capture = new SyntheticCapture(slotId);
+ *   capture->setSpec("1920x1080@30");
+ *   capture->setVideoOutput(optimizedWidget->videoItem());
+ *   capture->start();
+ */
+class SyntheticCapture : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr const char* DEFAULT_SPEC = "1280x720@30";
+
+    explicit SyntheticCapture(int slotId, QObject* parent = nullptr);
+    ~SyntheticCapture() override;
+
+    /**
+     * @brief Set pattern size and rate as "WIDTHxHEIGHT@FPS" (empty = DEFAULT_SPEC)
+     * @return false (and keep the previous format) if @p spec does not parse
+     *
+     * Takes effect at the next start().
+     */
+    bool setSpec(const QString& spec);
+
+    /**
+     * @brief Parse "WIDTHxHEIGHT@FPS"; "@FPS" is optional (30)
+     */
+    static bool parseSpec(const QString& spec, QSize* size, int* fps);
+
+    QSize frameSize() const { return m_size; }
+    int fps() const { return m_fps; }
+
+    /**
+     * @brief Set video output (QGraphicsVideoItem, QVideoWidget or QVideoSink)
+     */
+    void setVideoOutput(QObject* videoOutput);
+
+    /**
+     * @brief Attach an extra display of the same frames (e.g. an expanded view)
+     */
+    void addVideoOutput(QObject* output);
+    void removeVideoOutput(QObject* output);
+
+    void start();
+    void stop();
+    bool isActive() const { return m_active; }
+    bool isConnected() const { return m_active; }
+
+    int slotId() const { return m_slotId; }
+
+    /**
+     * @brief Session the frames pass through, for QtVideoRecorder (nullptr before Qt 6.8)
+     */
+    QMediaCaptureSession* captureSession() const { return m_session; }
+
+    /**
+     * @brief Per-frame tap of this source (runs on a capture worker thread)
+     */
+    FrameTap* frameTap() const { return m_tap; }
+
+    /**
+     * @brief Report frame metrics to @p telemetry (nullptr = off)
+     */
+    void setTelemetry(SlotTelemetry* telemetry);
+
+    /**
+     * @brief Frames generated, and ticks skipped because the generator fell behind
+     */
+    quint64 framesGenerated() const;
+    quint64 framesSkipped() const;
+
+signals:
+    /**
+     * @brief Emitted once the generator is running
+     */
+    void connectionEstablished();
+
+    /**
+     * @brief Never emitted (a pattern cannot drop out); here for interface parity
+     */
+    void connectionLost();
+
+    void errorOccurred(const QString& message);
+
+    /**
+     * @brief Emitted once per start(), when the first frame reaches the tap
+     */
+    void firstFrameReceived();
+
+private:
+    class Generator;
+
+    int m_slotId;
+    QSize m_size{1280, 720};
+    int m_fps{30};
+    bool m_active{false};
+
+    QObject* m_videoOutput{nullptr};
+    QMediaCaptureSession* m_session{nullptr};  // Qt 6.8+: frames enter through a frame input
+    QObject* m_frameInput{nullptr};            // QVideoFrameInput, lives on the generator thread
+    VideoFanout* m_fanout{nullptr};
+    FrameTap* m_tap{nullptr};
+
+    QThread* m_thread{nullptr};
+    Generator* m_generator{nullptr};
+};
+
+} // namespace MCM
+
+#endif // SYNTHETICCAPTURE_H
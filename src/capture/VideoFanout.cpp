@@ -0,0 +1,100 @@
+#include "VideoFanout.h"
+#include <QGraphicsVideoItem>
+#include <QVideoWidget>
+#include <QDebug>
+
+namespace MCM {
+
+VideoFanout::VideoFanout(QObject* parent)
+    : QObject(parent)
+{
+}
+
+QVideoSink* VideoFanout::sinkFor(QObject* output) {
+    if (!output) {
+        return nullptr;
+    }
+    if (QGraphicsVideoItem* item = qobject_cast<QGraphicsVideoItem*>(output)) {
+        return item->videoSink();
+    }
+    if (QVideoWidget* widget = qobject_cast<QVideoWidget*>(output)) {
+        return widget->videoSink();
+    }
+    return qobject_cast<QVideoSink*>(output);
+}
+
+void VideoFanout::setSource(QVideoSink* source) {
+    if (m_source == source) {
+        return;
+    }
+
+    if (m_source) {
+        for (const QPointer<QVideoSink>& sink : m_outputs) {
+            if (sink) {
+                disconnect(m_source, &QVideoSink::videoFrameChanged,
+                           sink, &QVideoSink::setVideoFrame);
+            }
+        }
+    }
+
+    m_source = source;
+
+    m_outputs.removeAll(QPointer<QVideoSink>());
+    for (const QPointer<QVideoSink>& sink : m_outputs) {
+        connectOutput(sink);
+    }
+}
+
+void VideoFanout::addOutput(QObject* output) {
+    QVideoSink* sink = sinkFor(output);
+    if (!sink || sink == m_source) {
+        return;
+    }
+
+    m_outputs.removeAll(QPointer<QVideoSink>());
+    for (const QPointer<QVideoSink>& existing : m_outputs) {
+        if (existing == sink) {
+            return;
+        }
+    }
+
+    m_outputs.append(sink);
+    connectOutput(sink);
+    qDebug() << "VideoFanout: Added output" << output << "(" << m_outputs.size() << "extra outputs)";
+}
+
+void VideoFanout::removeOutput(QObject* output) {
+    QVideoSink* sink = sinkFor(output);
+    if (!sink) {
+        return;
+    }
+    if (m_source) {
+        disconnect(m_source, &QVideoSink::videoFrameChanged, sink, &QVideoSink::setVideoFrame);
+    }
+    m_outputs.removeAll(QPointer<QVideoSink>(sink));
+    m_outputs.removeAll(QPointer<QVideoSink>());
+}
+
+int VideoFanout::outputCount() const {
+    int count = 0;
+    for (const QPointer<QVideoSink>& sink : m_outputs) {
+        if (sink) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void VideoFanout::connectOutput(QVideoSink* sink) {
+    if (!m_source || !sink) {
+        return;
+    }
+    // Direct: the frame goes sink-to-sink on the delivering thread, exactly
+    // like the primary output. The receiving item schedules its own repaint.
+    // Destroying either sink breaks the connection automatically.
+    connect(m_source, &QVideoSink::videoFrameChanged,
+            sink, &QVideoSink::setVideoFrame,
+            static_cast<Qt::ConnectionType>(Qt::DirectConnection | Qt::UniqueConnection));
+}
+
+} // namespace MCM
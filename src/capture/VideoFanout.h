@@ -0,0 +1,62 @@
+#ifndef VIDEOFANOUT_H
+#define VIDEOFANOUT_H
+
+#include <QObject>
+#include <QPointer>
+#include <QList>
+#include <QVideoSink>
+
+namespace MCM {
+
+/**
+ * @brief Delivers one decode to several video outputs
+ *
+ * QMediaCaptureSession and QMediaPlayer accept a single video output. The
+ * fan-out taps the sink that output feeds (the source) and hands each frame
+ * to every extra output's sink from the thread that delivered it, through a
+ * direct connection - the same way the multimedia backend feeds the primary
+ * output. No per-frame hop through the GUI thread, no intermediate slots.
+ *
+ * Outputs can be a QGraphicsVideoItem, a QVideoWidget or a QVideoSink; they
+ * are dropped automatically when destroyed. Changing the source (new stream,
+ * preview sink switch) moves all outputs over.
+ */
+class VideoFanout : public QObject {
+    Q_OBJECT
+
+public:
+    explicit VideoFanout(QObject* parent = nullptr);
+
+    /**
+     * @brief Sink that receives every decoded frame (nullptr detaches)
+     */
+    void setSource(QVideoSink* source);
+    QVideoSink* source() const { return m_source; }
+
+    /**
+     * @brief Add an extra output (no-op if already attached)
+     */
+    void addOutput(QObject* output);
+
+    /**
+     * @brief Remove an extra output
+     */
+    void removeOutput(QObject* output);
+
+    int outputCount() const;
+
+    /**
+     * @brief Sink behind a video output object (item, widget or sink)
+     */
+    static QVideoSink* sinkFor(QObject* output);
+
+private:
+    void connectOutput(QVideoSink* sink);
+
+    QPointer<QVideoSink> m_source;
+    QList<QPointer<QVideoSink>> m_outputs;
+};
+
+} // namespace MCM
+
+#endif // VIDEOFANOUT_H
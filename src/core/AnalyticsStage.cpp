@@ -0,0 +1,382 @@
+#include "AnalyticsStage.h"
+#include "FramePool.h"
+#include "Telemetry.h"
+#include "ThreadPolicy.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QPainter>
+#include <QTimer>
+#include <QDebug>
+#include <algorithm>
+
+namespace MCM {
+
+namespace {
+
+/**
+ * @brief Built-in "none" model: no detections, for measuring the batching path
+ */
+class NullAnalyticsModel : public AnalyticsModel {
+public:
+    bool load(const QString& path, QString* error) override {
+        Q_UNUSED(path);
+        Q_UNUSED(error);
+        return true;
+    }
+
+    InputSpec inputSpec() const override {
+        InputSpec spec;
+        spec.maxBatch = 256;
+        return spec;
+    }
+
+    bool infer(const AnalyticsBatch& batch, std::vector<QList<AnalyticsDetection>>& results) override {
+        Q_UNUSED(batch);
+        Q_UNUSED(results);
+        return true;
+    }
+};
+
+} // namespace
+
+AnalyticsStage& AnalyticsStage::instance() {
+    static AnalyticsStage instance;
+    return instance;
+}
+
+QMap<QString, AnalyticsStage::ModelFactory>& AnalyticsStage::registry() {
+    static QMap<QString, ModelFactory> models{
+        {"none", []() { return std::make_unique<NullAnalyticsModel>(); }}
+    };
+    return models;
+}
+
+QMutex& AnalyticsStage::registryMutex() {
+    static QMutex mutex;
+    return mutex;
+}
+
+void AnalyticsStage::registerModel(const QString& name, ModelFactory factory) {
+    QMutexLocker locker(&registryMutex());
+    registry().insert(name, std::move(factory));
+}
+
+QStringList AnalyticsStage::modelNames() {
+    QMutexLocker locker(&registryMutex());
+    return registry().keys();
+}
+
+AnalyticsStage::AnalyticsStage()
+    : QObject(nullptr)
+{
+    qRegisterMetaType<MCM::AnalyticsResult>();
+
+    m_thread.setObjectName("AnalyticsStage");
+    ThreadPolicy::instance().attach(&m_thread, ThreadPolicy::Role::Analysis);
+    m_timer = new QTimer;
+    m_timer->setTimerType(Qt::PreciseTimer);
+    m_timer->moveToThread(&m_thread);
+    connect(m_timer, &QTimer::timeout, m_timer, [this]() { tick(); });
+    m_thread.start();
+
+    if (QCoreApplication* app = QCoreApplication::instance()) {
+        connect(app, &QCoreApplication::aboutToQuit, this, &AnalyticsStage::shutdown);
+    }
+}
+
+AnalyticsStage::~AnalyticsStage() {
+    shutdown();
+}
+
+void AnalyticsStage::configure(const AnalyticsConfig& config) {
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_shutdown) {
+            return;
+        }
+    }
+    qDebug() << "AnalyticsStage:" << (config.enabled ? "model" : "off") << config.model
+             << "at" << config.fps << "fps, batch" << config.maxBatch
+             << "max latency" << config.maxBatchLatencyMs << "ms";
+    QMetaObject::invokeMethod(m_timer, [this, config]() { applyConfig(config); }, Qt::QueuedConnection);
+}
+
+void AnalyticsStage::setFrameSource(int slotId, FrameSource source) {
+    QMutexLocker locker(&m_mutex);
+    Entry& entry = m_entries[slotId];
+    entry.source = std::move(source);
+    entry.lastSerial = 0;
+}
+
+void AnalyticsStage::removeFrameSource(int slotId) {
+    QMutexLocker locker(&m_mutex);  // Sources are only called under the lock
+    m_entries.remove(slotId);
+}
+
+AnalyticsResult AnalyticsStage::latestResult(int slotId) const {
+    QMutexLocker locker(&m_mutex);
+    const auto it = m_entries.constFind(slotId);
+    return it != m_entries.cend() ? it->latest : AnalyticsResult();
+}
+
+AnalyticsStage::Stats AnalyticsStage::stats() const {
+    QMutexLocker locker(&m_mutex);
+    Stats stats = m_stats;
+    stats.slots = m_entries.size();
+    return stats;
+}
+
+void AnalyticsStage::shutdown() {
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_shutdown) {
+            return;
+        }
+        m_shutdown = true;
+    }
+    if (m_thread.isRunning()) {
+        QMetaObject::invokeMethod(m_timer, [this]() {
+            m_timer->stop();
+            m_model.reset();
+        }, Qt::BlockingQueuedConnection);
+        m_thread.quit();
+        m_thread.wait();
+    }
+    delete m_timer;
+    m_timer = nullptr;
+}
+
+void AnalyticsStage::applyConfig(const AnalyticsConfig& config) {
+    const bool reload = !m_model || config.model != m_config.model || config.modelPath != m_config.modelPath;
+    m_config = config;
+    m_timer->stop();
+
+    if (!config.enabled) {
+        m_model.reset();
+        m_modelName.clear();
+        QMutexLocker locker(&m_mutex);
+        m_stats.model.clear();
+        return;
+    }
+
+    if (reload) {
+        m_model.reset();
+        m_modelName.clear();
+        ModelFactory factory;
+        {
+            QMutexLocker locker(&registryMutex());
+            factory = registry().value(config.model);
+        }
+        if (!factory) {
+            qWarning() << "AnalyticsStage: Unknown model" << config.model << "- available:" << modelNames();
+            return;
+        }
+        std::unique_ptr<AnalyticsModel> model = factory();
+        QString error;
+        if (!model || !model->load(config.modelPath, &error)) {
+            qWarning() << "AnalyticsStage: Cannot load" << config.model << config.modelPath << "-" << error;
+            return;
+        }
+        m_model = std::move(model);
+        m_modelName = config.model;
+        m_spec = m_model->inputSpec();
+        qDebug() << "AnalyticsStage: Loaded" << config.model << "input" << m_spec.size
+                 << (m_spec.planar ? "NCHW" : "NHWC") << "max batch" << m_spec.maxBatch;
+    }
+
+    // Everything a tick touches is allocated here, not per batch
+    const int capacity = qMax(1, qMin(config.maxBatch, m_spec.maxBatch));
+    const size_t floats = static_cast<size_t>(3) * m_spec.size.width() * m_spec.size.height() * capacity;
+    if (m_tensor.size() != floats) {
+        m_tensor.assign(floats, 0.0f);
+    }
+    m_resized.resize(capacity);
+    for (QImage& image : m_resized) {
+        if (image.size() != m_spec.size) {
+            image = QImage(m_spec.size, QImage::Format_RGB32);
+        }
+    }
+    m_results.resize(capacity);
+    for (int c = 0; c < 3; ++c) {
+        for (int v = 0; v < 256; ++v) {
+            m_lut[c][v] = (v - m_spec.mean[c]) * m_spec.scale[c];
+        }
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stats.model = m_modelName;
+    }
+    m_timer->start(1000 / config.fps);
+}
+
+void AnalyticsStage::tick() {
+    if (!m_model) {
+        return;
+    }
+    const qint64 tickUs = Telemetry::nowUs();
+    const qint64 maxAgeUs = m_config.maxBatchLatencyMs * 1000LL;
+    const int capacity = static_cast<int>(m_resized.size());
+    m_tickCount++;
+
+    // Latest frame of every slot: unchanged ones are skipped, old ones dropped
+    std::vector<Candidate> candidates;
+    quint64 stale = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        candidates.reserve(m_entries.size());
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            quint64 serial = 0;
+            qint64 arrivalUs = 0;
+            QVideoFrame frame = it->source(&serial, &arrivalUs);
+            if (!frame.isValid() || serial == it->lastSerial) {
+                continue;
+            }
+            if (tickUs - arrivalUs > maxAgeUs) {
+                it->lastSerial = serial;
+                stale++;
+                continue;
+            }
+            candidates.push_back(Candidate{it.key(), std::move(frame), serial, arrivalUs, it->lastTick});
+        }
+        m_stats.stale += stale;
+    }
+    if (candidates.empty()) {
+        return;
+    }
+
+    // More fresh frames than fit: the slots that waited longest go first
+    quint64 deferred = 0;
+    if (static_cast<int>(candidates.size()) > capacity) {
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+            return a.lastTick != b.lastTick ? a.lastTick < b.lastTick : a.slotId < b.slotId;
+        });
+        deferred = candidates.size() - capacity;
+        candidates.resize(capacity);
+    }
+
+    // Resize, convert and normalize into the batch tensor
+    QElapsedTimer timer;
+    timer.start();
+    const qsizetype frameFloats = static_cast<qsizetype>(3) * m_spec.size.width() * m_spec.size.height();
+    int count = 0;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (!prepare(count, candidates[i])) {
+            continue;  // Unmappable frame: not part of the batch
+        }
+        normalize(m_resized[count], m_tensor.data() + frameFloats * count);
+        if (static_cast<size_t>(count) != i) {
+            candidates[count] = std::move(candidates[i]);
+        }
+        count++;
+    }
+    const qint64 prepareUs = timer.nsecsElapsed() / 1000;
+    if (count == 0) {
+        return;
+    }
+
+    // One inference call for the whole batch
+    AnalyticsBatch batch;
+    batch.data = m_tensor.data();
+    batch.count = count;
+    batch.height = m_spec.size.height();
+    batch.width = m_spec.size.width();
+    batch.planar = m_spec.planar;
+    m_results.resize(count);
+    for (auto& detections : m_results) {
+        detections.clear();
+    }
+    timer.restart();
+    const bool ok = m_model->infer(batch, m_results);
+    const qint64 inferUs = timer.nsecsElapsed() / 1000;
+    if (!ok) {
+        qWarning() << "AnalyticsStage:" << m_modelName << "failed on a batch of" << count;
+    }
+    const qint64 completedUs = Telemetry::nowUs();
+
+    // Back to the slots
+    QList<AnalyticsResult> results;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (int i = 0; i < count; ++i) {
+            const Candidate& candidate = candidates[i];
+            auto it = m_entries.find(candidate.slotId);
+            if (it == m_entries.end()) {
+                continue;  // Unsubscribed meanwhile
+            }
+            it->lastSerial = candidate.serial;
+            it->lastTick = m_tickCount;
+            if (!ok) {
+                continue;
+            }
+            AnalyticsResult result;
+            result.slotId = candidate.slotId;
+            result.frameTimeUs = candidate.frame.startTime();
+            result.arrivalUs = candidate.arrivalUs;
+            result.completedUs = completedUs;
+            result.detections = i < static_cast<int>(m_results.size()) ? m_results[i] : QList<AnalyticsDetection>();
+            it->latest = result;
+            results.append(result);
+        }
+        m_stats.batches++;
+        m_stats.frames += count;
+        m_stats.deferred += deferred;
+        m_stats.prepareUs += prepareUs;
+        m_stats.inferUs += inferUs;
+    }
+    for (const AnalyticsResult& result : results) {
+        emit resultReady(result);
+    }
+}
+
+bool AnalyticsStage::prepare(int index, const Candidate& candidate) {
+    Telemetry::instance().slot(candidate.slotId)->recordFrameMap(candidate.frame);
+    const FrameRef frame = FramePool::instance().map(candidate.frame);
+    if (!frame) {
+        return false;
+    }
+    // Stretched to the input size: box coordinates normalized to the input
+    // are then normalized to the source frame as well
+    QImage& target = m_resized[index];
+    if (!FrameScaler::supports(frame->pixelFormat()) || !m_scalers[candidate.slotId].scale(*frame, target)) {
+        QPainter painter(&target);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.drawImage(target.rect(), frame->toImage());
+    }
+    return true;
+}
+
+void AnalyticsStage::normalize(const QImage& image, float* out) const {
+    const int width = image.width();
+    const int height = image.height();
+    const qsizetype plane = static_cast<qsizetype>(width) * height;
+    // Channel 0 is red unless the model wants BGR
+    const int firstShift = m_spec.bgr ? 0 : 16;
+    const int lastShift = m_spec.bgr ? 16 : 0;
+
+    for (int y = 0; y < height; ++y) {
+        const quint32* line = reinterpret_cast<const quint32*>(image.constScanLine(y));
+        const qsizetype row = static_cast<qsizetype>(y) * width;
+        if (m_spec.planar) {
+            float* c0 = out + row;
+            float* c1 = c0 + plane;
+            float* c2 = c1 + plane;
+            for (int x = 0; x < width; ++x) {
+                const quint32 pixel = line[x];
+                c0[x] = m_lut[0][(pixel >> firstShift) & 0xff];
+                c1[x] = m_lut[1][(pixel >> 8) & 0xff];
+                c2[x] = m_lut[2][(pixel >> lastShift) & 0xff];
+            }
+        } else {
+            float* o = out + row * 3;
+            for (int x = 0; x < width; ++x) {
+                const quint32 pixel = line[x];
+                o[3 * x] = m_lut[0][(pixel >> firstShift) & 0xff];
+                o[3 * x + 1] = m_lut[1][(pixel >> 8) & 0xff];
+                o[3 * x + 2] = m_lut[2][(pixel >> lastShift) & 0xff];
+            }
+        }
+    }
+}
+
+} // namespace MCM
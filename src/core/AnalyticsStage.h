@@ -0,0 +1,247 @@
+#ifndef ANALYTICSSTAGE_H
+#define ANALYTICSSTAGE_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QRectF>
+#include <QSize>
+#include <QThread>
+#include <QVideoFrame>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "core/Config.h"
+#include "core/FrameScaler.h"
+
+class QTimer;
+
+namespace MCM {
+
+/**
+ * @brief One object found by an analytics model
+ */
+struct AnalyticsDetection {
+    QRectF box;           // Normalized to the source frame, (0,0)-(1,1)
+    int classId{-1};
+    float score{0.0f};
+    QString label;
+};
+
+/**
+ * @brief A model's output for one frame, as delivered by AnalyticsStage
+ */
+struct AnalyticsResult {
+    int slotId{-1};
+    qint64 frameTimeUs{-1};   // Start time of the analysed frame (source clock)
+    qint64 arrivalUs{0};      // When the frame arrived (Telemetry::nowUs() clock)
+    qint64 completedUs{0};    // When inference of its batch finished (same clock)
+    QList<AnalyticsDetection> detections;
+};
+
+/**
+ * @brief Frames of one inference call, packed for the model
+ *
+ * count frames of channels x height x width float32, planar per frame
+ * (NCHW) or interleaved (NHWC) as the model asked for, already resized
+ * and normalized. The memory belongs to the stage and is reused.
+ */
+struct AnalyticsBatch {
+    const float* data{nullptr};
+    int count{0};
+    int channels{3};
+    int height{0};
+    int width{0};
+    bool planar{true};
+
+    qsizetype frameFloats() const { return static_cast<qsizetype>(channels) * height * width; }
+    const float* frame(int index) const { return data + frameFloats() * index; }
+};
+
+/**
+ * @brief Detection model plugged into AnalyticsStage
+ *
+ * Implementations wrap an inference runtime (TensorRT, ONNX Runtime,
+ * OpenVINO, ...) and are registered by name with
+ * AnalyticsStage::registerModel(); analytics.model selects one. All calls
+ * come from the stage's thread, so a model needs no locking of its own.
+ */
+class AnalyticsModel {
+public:
+    /**
+     * @brief Input the model expects; the stage prepares batches to match
+     */
+    struct InputSpec {
+        QSize size{640, 640};
+        int maxBatch{32};                     // Largest batch one infer() call takes
+        bool planar{true};                    // NCHW (true) or NHWC
+        bool bgr{false};                      // Channel order
+        float mean[3]{0.0f, 0.0f, 0.0f};      // Per channel, in 0-255 units
+        float scale[3]{1.0f / 255, 1.0f / 255, 1.0f / 255};  // Applied after subtracting mean
+    };
+
+    virtual ~AnalyticsModel() = default;
+
+    /**
+     * @brief Load weights / build the engine (analytics.modelPath)
+     */
+    virtual bool load(const QString& path, QString* error) = 0;
+
+    virtual InputSpec inputSpec() const = 0;
+
+    /**
+     * @brief Run the model on a whole batch
+     * @param results One entry per batch frame, in batch order
+     */
+    virtual bool infer(const AnalyticsBatch& batch, std::vector<QList<AnalyticsDetection>>& results) = 0;
+};
+
+/**
+ * @brief Cross-camera batched inference for analytics models (Singleton)
+ *
+ * Instead of one inference call per slot and frame, the stage runs one
+ * call per tick (analytics.fps) over all subscribed slots: it takes each
+ * slot's latest frame, resizes and converts it with FrameScaler and
+ * normalizes it into one preallocated batch tensor, calls the model once
+ * and hands the detections back per slot with the frame's timestamps.
+ *
+ * Nothing is queued. A slot whose frame has not changed since the last
+ * tick is skipped, a frame older than maxBatchLatencyMs is dropped as
+ * stale, and when there are more fresh frames than the batch holds the
+ * slots left out go first at the next tick. All work runs on the stage's
+ * own thread, so a slow model only lowers the rate at which results come.
+ *
+ * Usage:
+ *   AnalyticsStage::registerModel("yolo-trt", [] { return std::make_unique<TrtYolo>(); });
+ *   AnalyticsStage::instance().configure(Config::instance().analytics());
+ *   AnalyticsStage::instance().setFrameSource(slotId, [tap](quint64* serial, qint64* arrivalUs) {
+ *       return tap->latestFrame(serial, arrivalUs);
+ *   });
+ *   connect(&AnalyticsStage::instance(), &AnalyticsStage::resultReady, ...);
+ */
+class AnalyticsStage : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Latest frame of a slot, a number that changes with every frame, and its arrival time
+     *
+     * Called on the stage's thread under its lock: must be quick.
+     */
+    using FrameSource = std::function<QVideoFrame(quint64* serial, qint64* arrivalUs)>;
+    using ModelFactory = std::function<std::unique_ptr<AnalyticsModel>()>;
+
+    struct Stats {
+        quint64 batches{0};       // Inference calls
+        quint64 frames{0};        // Frames analysed
+        quint64 stale{0};         // Frames dropped for being older than maxBatchLatencyMs
+        quint64 deferred{0};      // Fresh frames left out of a full batch
+        qint64 prepareUs{0};      // Resize + normalize, all batches
+        qint64 inferUs{0};        // Model calls, all batches
+        int slots{0};
+        QString model;            // Model in use (empty = not running)
+    };
+
+    static AnalyticsStage& instance();
+
+    // Prevent copying
+    AnalyticsStage(const AnalyticsStage&) = delete;
+    AnalyticsStage& operator=(const AnalyticsStage&) = delete;
+
+    /**
+     * @brief Make a model available under a name (before configure())
+     *
+     * "none" is built in: it returns no detections, for measuring the
+     * batching itself.
+     */
+    static void registerModel(const QString& name, ModelFactory factory);
+    static QStringList modelNames();
+
+    /**
+     * @brief Apply the settings; the model is (re)loaded when model or modelPath change
+     */
+    void configure(const AnalyticsConfig& config);
+
+    /**
+     * @brief Subscribe a slot (or replace its source)
+     */
+    void setFrameSource(int slotId, FrameSource source);
+
+    /**
+     * @brief Unsubscribe a slot; the source is not called any more once this returns
+     */
+    void removeFrameSource(int slotId);
+
+    /**
+     * @brief Most recent result of a slot (thread-safe; slotId -1 if none yet)
+     */
+    AnalyticsResult latestResult(int slotId) const;
+
+    Stats stats() const;
+
+    /**
+     * @brief Stop ticking and release the model (on quit)
+     */
+    void shutdown();
+
+signals:
+    /**
+     * @brief Detections of one slot's frame (emitted on the stage's thread)
+     */
+    void resultReady(const MCM::AnalyticsResult& result);
+
+private:
+    AnalyticsStage();
+    ~AnalyticsStage() override;
+
+    struct Entry {
+        FrameSource source;
+        quint64 lastSerial{0};     // Frame last analysed or dropped
+        quint64 lastTick{0};       // Tick the slot was last batched in (fairness)
+        AnalyticsResult latest;
+    };
+
+    struct Candidate {
+        int slotId;
+        QVideoFrame frame;
+        quint64 serial;
+        qint64 arrivalUs;
+        quint64 lastTick;
+    };
+
+    void applyConfig(const AnalyticsConfig& config);   // Stage thread
+    void tick();                                       // Stage thread
+    bool prepare(int index, const Candidate& candidate);
+    void normalize(const QImage& image, float* out) const;
+
+    static QMap<QString, ModelFactory>& registry();
+    static QMutex& registryMutex();
+
+    QThread m_thread;
+    QTimer* m_timer{nullptr};          // Lives on m_thread
+
+    // Stage thread state
+    AnalyticsConfig m_config;
+    std::unique_ptr<AnalyticsModel> m_model;
+    AnalyticsModel::InputSpec m_spec;
+    QString m_modelName;
+    std::vector<float> m_tensor;       // maxBatch frames, allocated once per model / size
+    std::vector<QImage> m_resized;     // Input-size RGB32 image per batch position
+    QHash<int, FrameScaler> m_scalers; // Per slot: each keeps the tables for its source size
+    std::vector<QList<AnalyticsDetection>> m_results;
+    float m_lut[3][256]{};             // 8-bit value -> normalized input, per channel
+    quint64 m_tickCount{0};
+
+    mutable QMutex m_mutex;            // Entries and counters
+    QHash<int, Entry> m_entries;
+    Stats m_stats;
+    bool m_shutdown{false};
+};
+
+} // namespace MCM
+
+Q_DECLARE_METATYPE(MCM::AnalyticsResult)
+
+#endif // ANALYTICSSTAGE_H
@@ -0,0 +1,82 @@
+#include "CaptureWorkerPool.h"
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <QDebug>
+
+namespace MCM {
+
+CaptureWorkerPool& CaptureWorkerPool::instance() {
+    static CaptureWorkerPool instance;
+    return instance;
+}
+
+CaptureWorkerPool::CaptureWorkerPool() {
+    // Leave one core to the GUI thread
+    const int count = qBound(1, QThread::idealThreadCount() - 1, MAX_THREADS);
+    for (int i = 0; i < count; ++i) {
+        QThread* thread = new QThread();
+        thread->setObjectName(QStringLiteral("CaptureWorker%1").arg(i));
+        m_threads.append(thread);
+    }
+    m_analysisThread = new QThread();
+    m_analysisThread->setObjectName(QStringLiteral("Analysis"));
+
+    // Threads must be joined while the application still exists
+    if (QCoreApplication* app = QCoreApplication::instance()) {
+        connect(app, &QCoreApplication::aboutToQuit, this, &CaptureWorkerPool::shutdown);
+    }
+
+    qDebug() << "CaptureWorkerPool:" << count << "worker threads";
+}
+
+CaptureWorkerPool::~CaptureWorkerPool() {
+    shutdown();
+    qDeleteAll(m_threads);
+    delete m_analysisThread;
+}
+
+QThread* CaptureWorkerPool::threadFor(int slotId) {
+    QMutexLocker locker(&m_mutex);
+    QThread* thread = m_threads.at(qAbs(slotId) % m_threads.size());
+    if (!m_shutdown && !thread->isRunning()) {
+        thread->start();
+    }
+    return thread;
+}
+
+QThread* CaptureWorkerPool::analysisThread() {
+    QMutexLocker locker(&m_mutex);
+    if (!m_shutdown && !m_analysisThread->isRunning()) {
+        m_analysisThread->start(QThread::LowPriority);
+    }
+    return m_analysisThread;
+}
+
+int CaptureWorkerPool::threadCount() const {
+    QMutexLocker locker(&m_mutex);
+    return m_threads.size();
+}
+
+QList<QThread*> CaptureWorkerPool::workerThreads() const {
+    QMutexLocker locker(&m_mutex);
+    return m_threads;
+}
+
+void CaptureWorkerPool::shutdown() {
+    QMutexLocker locker(&m_mutex);
+    if (m_shutdown) {
+        return;
+    }
+    m_shutdown = true;
+    for (QThread* thread : m_threads) {
+        thread->quit();
+    }
+    for (QThread* thread : m_threads) {
+        thread->wait();
+    }
+    m_analysisThread->quit();
+    m_analysisThread->wait();
+    qDebug() << "CaptureWorkerPool: Worker threads stopped";
+}
+
+} // namespace MCM
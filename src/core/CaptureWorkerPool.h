@@ -0,0 +1,82 @@
+#ifndef CAPTUREWORKERPOOL_H
+#define CAPTUREWORKERPOOL_H
+
+#include <QObject>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+
+namespace MCM {
+
+/**
+ * @brief Small pool of threads that run per-camera frame work (Singleton)
+ *
+ * Every decoded frame used to be handled on the GUI thread: frame counting,
+ * first-frame detection, latest-frame bookkeeping and recorder notification
+ * ran once per frame per camera in the main event loop. Per-camera workers
+ * (see FrameTap) are now moved onto one of these threads instead, spread
+ * round-robin by slot, so GUI load no longer grows with camera count.
+ *
+ * The pool is sized from the core count (one core left for the GUI, at most
+ * MAX_THREADS) and threads start on first use.
+ *
+ * Usage:
+ *   worker->moveToThread(CaptureWorkerPool::instance().threadFor(slotId));
+ */
+class CaptureWorkerPool : public QObject {
+    Q_OBJECT
+
+public:
+    static CaptureWorkerPool& instance();
+
+    // Prevent copying
+    CaptureWorkerPool(const CaptureWorkerPool&) = delete;
+    CaptureWorkerPool& operator=(const CaptureWorkerPool&) = delete;
+
+    /**
+     * @brief Worker thread for a slot (started on first use)
+     *
+     * The same slot always maps to the same thread, so a camera's frames are
+     * handled in order.
+     */
+    QThread* threadFor(int slotId);
+
+    /**
+     * @brief Low-priority thread shared by frame analytics (started on first use)
+     *
+     * Analysis (e.g. MotionDetector) is kept off the capture workers so a
+     * slow pass can never delay frame delivery; all slots share one core.
+     */
+    QThread* analysisThread();
+
+    /**
+     * @brief Number of worker threads
+     */
+    int threadCount() const;
+
+    /**
+     * @brief Worker threads and the analysis thread, started or not (for ThreadPolicy)
+     */
+    QList<QThread*> workerThreads() const;
+    QThread* analysisThreadHandle() const { return m_analysisThread; }
+
+    /**
+     * @brief Stop all worker threads (called on application quit)
+     */
+    void shutdown();
+
+private:
+    CaptureWorkerPool();
+    ~CaptureWorkerPool() override;
+
+    mutable QMutex m_mutex;
+    QList<QThread*> m_threads;
+    QThread* m_analysisThread{nullptr};
+    bool m_shutdown{false};
+
+    static constexpr int MAX_THREADS = 4;
+};
+
+} // namespace MCM
+
+#endif // CAPTUREWORKERPOOL_H
@@ -0,0 +1,436 @@
+#include "ChunkIndex.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QTimeZone>
+#include <QMutexLocker>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+namespace MCM {
+
+namespace {
+
+constexpr qint64 RECORD_SIZE = sizeof(ChunkIndexRecord);
+constexpr qint64 MERGE_GAP_MS = 1000;  // Coverage spans closer than this are one span
+constexpr qint64 LIVE_SLACK_MS = 3600 * 1000;  // An open chunk untouched this long was cut off by a crash
+
+ChunkIndexRecord headerRecord() {
+    ChunkIndexRecord record;
+    record.type = ChunkIndexRecord::Header;
+    record.chunk = ChunkIndex::FORMAT_VERSION;
+    return record;
+}
+
+} // namespace
+
+// ============================================================================
+// ChunkIndex (reader)
+// ============================================================================
+
+ChunkIndex::ChunkIndex(const QString& slotDirectory)
+    : m_directory(QDir::cleanPath(slotDirectory))
+{
+}
+
+ChunkIndex::~ChunkIndex() {
+    qDeleteAll(m_days);  // QFile unmaps on destruction
+}
+
+QString ChunkIndex::dayFile(const QString& slotDirectory, const QDate& utcDay) {
+    return QString("%1/index_%2.idx").arg(slotDirectory, utcDay.toString("yyyyMMdd"));
+}
+
+QString ChunkIndex::chunkBaseName(int chunkNumber, const QDateTime& startTime) {
+    return QString("%1_%2.mp4")
+        .arg(chunkNumber, 3, 10, QChar('0'))  // Zero-padded: 001, 002, ...
+        .arg(startTime.toString("yyyyMMdd_HHmmss"));
+}
+
+int ChunkIndex::removeDaysBefore(const QString& slotDirectory, const QDate& utcDay) {
+    int removed = 0;
+    const QFileInfoList files = QDir(slotDirectory).entryInfoList({"index_*.idx"}, QDir::Files);
+    for (const QFileInfo& info : files) {
+        const QDate day = QDate::fromString(info.completeBaseName().mid(6), "yyyyMMdd");
+        if (day.isValid() && day < utcDay && QFile::remove(info.absoluteFilePath())) {
+            removed++;
+        }
+    }
+    return removed;
+}
+
+QDate ChunkIndex::utcDay(qint64 wallMs) {
+    return QDateTime::fromMSecsSinceEpoch(wallMs, QTimeZone::utc()).date();
+}
+
+ChunkIndex::Day* ChunkIndex::day(const QDate& utcDay) {
+    Day*& entry = m_days[utcDay];
+    if (!entry) {
+        entry = new Day;
+        entry->file = std::make_unique<QFile>(dayFile(m_directory, utcDay));
+    }
+    refresh(*entry);
+    return entry->valid ? entry : nullptr;
+}
+
+void ChunkIndex::refresh(Day& day) {
+    QFile& file = *day.file;
+    if (!file.isOpen()) {
+        if (!file.exists() || !file.open(QIODevice::ReadOnly)) {
+            return;  // Checked again next time: the live day's file appears at its first chunk
+        }
+    }
+
+    // Whole records only: a torn last record is not there yet
+    const qint64 count = file.size() / RECORD_SIZE;
+    if (count <= day.mappedCount) {
+        return;
+    }
+    if (day.records) {
+        file.unmap(reinterpret_cast<uchar*>(const_cast<ChunkIndexRecord*>(day.records)));
+        day.records = nullptr;
+    }
+    uchar* data = file.map(0, count * RECORD_SIZE);
+    if (!data) {
+        qWarning() << "ChunkIndex: Cannot map" << file.fileName() << ":" << file.errorString();
+        day.mappedCount = 0;
+        day.valid = false;
+        return;
+    }
+    day.records = reinterpret_cast<const ChunkIndexRecord*>(data);
+    day.mappedCount = count;
+
+    if (day.scannedCount == 0) {
+        const ChunkIndexRecord& header = day.records[0];
+        if (header.type != ChunkIndexRecord::Header || header.chunk != FORMAT_VERSION) {
+            qWarning() << "ChunkIndex: Ignoring" << file.fileName() << "(unknown format)";
+            return;
+        }
+        day.scannedCount = 1;
+        day.valid = true;
+    }
+    if (day.valid) {
+        scan(day);
+    }
+}
+
+void ChunkIndex::scan(Day& day) {
+    for (qint64 i = day.scannedCount; i < day.mappedCount; ++i) {
+        const ChunkIndexRecord& record = day.records[i];
+        ChunkEntry* open = !day.chunks.empty() && day.chunks.back().endMs < 0 ? &day.chunks.back() : nullptr;
+        switch (record.type) {
+            case ChunkIndexRecord::ChunkStart: {
+                ChunkEntry entry;
+                entry.chunk = static_cast<int>(record.chunk);
+                entry.startMs = record.wallMs;
+                entry.nameMs = record.value0;
+                entry.firstKeyframe = static_cast<int>(day.keyframes.size());
+                day.chunks.push_back(entry);
+                break;
+            }
+            case ChunkIndexRecord::Keyframe:
+                if (open && open->chunk == static_cast<int>(record.chunk)) {
+                    day.keyframes.push_back(static_cast<qint32>(i));
+                    open->keyframeCount++;
+                }
+                break;
+            case ChunkIndexRecord::ChunkEnd:
+                if (open && open->chunk == static_cast<int>(record.chunk)) {
+                    open->endMs = qMax(record.wallMs, open->startMs);
+                }
+                break;
+            case ChunkIndexRecord::Event:
+                day.events.push_back(static_cast<qint32>(i));
+                break;
+            default:
+                break;  // Unknown record of a newer writer
+        }
+    }
+    day.scannedCount = day.mappedCount;
+}
+
+qint64 ChunkIndex::endOf(const Day& day, const ChunkEntry& entry) {
+    if (entry.endMs >= 0) {
+        return entry.endMs;
+    }
+    if (entry.keyframeCount > 0) {
+        return day.records[day.keyframes[entry.firstKeyframe + entry.keyframeCount - 1]].wallMs;
+    }
+    return entry.startMs;
+}
+
+ChunkIndex::Position ChunkIndex::position(const Day& day, const ChunkEntry& entry, qint64 wallMs) const {
+    Position pos;
+    pos.path = m_directory + "/" + chunkBaseName(entry.chunk, QDateTime::fromMSecsSinceEpoch(entry.nameMs));
+    pos.chunk = entry.chunk;
+    pos.chunkStartMs = entry.startMs;
+    pos.chunkEndMs = endOf(day, entry);
+    pos.offsetMs = qMax<qint64>(0, wallMs - entry.startMs);
+    pos.open = entry.endMs < 0;
+
+    // Last keyframe at or before the time (the chunk itself opens on one)
+    const auto first = day.keyframes.begin() + entry.firstKeyframe;
+    const auto last = first + entry.keyframeCount;
+    const auto after = std::upper_bound(first, last, wallMs, [&day](qint64 t, qint32 record) {
+        return t < day.records[record].wallMs;
+    });
+    if (after != first) {
+        const ChunkIndexRecord& keyframe = day.records[*(after - 1)];
+        pos.keyframeOffsetMs = keyframe.value0;
+        pos.keyframeByte = keyframe.value1;
+    }
+    return pos;
+}
+
+ChunkIndex::Position ChunkIndex::locate(qint64 wallMs) {
+    // A chunk that holds this time started on its day or, across midnight, the day before
+    const QDate today = utcDay(wallMs);
+    for (const QDate& date : {today, today.addDays(-1)}) {
+        const Day* d = day(date);
+        if (!d || d->chunks.empty()) {
+            continue;
+        }
+        const auto after = std::upper_bound(d->chunks.begin(), d->chunks.end(), wallMs,
+            [](qint64 t, const ChunkEntry& entry) { return t < entry.startMs; });
+        if (after == d->chunks.begin()) {
+            continue;
+        }
+        const ChunkEntry& entry = *(after - 1);
+        const bool live = entry.endMs < 0 && after == d->chunks.end()
+            && wallMs - endOf(*d, entry) < LIVE_SLACK_MS;
+        if (wallMs < endOf(*d, entry) || live) {
+            return position(*d, entry, wallMs);
+        }
+        if (date == today) {
+            break;  // In a gap; an earlier day's chunk cannot reach past this one
+        }
+    }
+    return Position();
+}
+
+ChunkIndex::Position ChunkIndex::next(qint64 wallMs) {
+    const QDate today = utcDay(wallMs);
+    for (const QDate& date : {today.addDays(-1), today, today.addDays(1)}) {
+        const Day* d = day(date);
+        if (!d) {
+            continue;
+        }
+        const auto after = std::upper_bound(d->chunks.begin(), d->chunks.end(), wallMs,
+            [](qint64 t, const ChunkEntry& entry) { return t < entry.startMs; });
+        if (after != d->chunks.end()) {
+            return position(*d, *after, after->startMs);
+        }
+    }
+    return Position();
+}
+
+QList<QPair<qint64, qint64>> ChunkIndex::coverage(qint64 fromMs, qint64 toMs) {
+    QList<QPair<qint64, qint64>> spans;
+    if (toMs <= fromMs) {
+        return spans;
+    }
+    for (QDate date = utcDay(fromMs).addDays(-1); date <= utcDay(toMs); date = date.addDays(1)) {
+        const Day* d = day(date);
+        if (!d) {
+            continue;
+        }
+        for (const ChunkEntry& entry : d->chunks) {
+            const qint64 start = qMax(entry.startMs, fromMs);
+            const qint64 end = qMin(endOf(*d, entry), toMs);
+            if (end <= start) {
+                continue;
+            }
+            if (!spans.isEmpty() && start - spans.last().second <= MERGE_GAP_MS) {
+                spans.last().second = qMax(spans.last().second, end);
+            } else {
+                spans.append({start, end});
+            }
+        }
+    }
+    return spans;
+}
+
+QList<ChunkIndex::Marker> ChunkIndex::markers(qint64 fromMs, qint64 toMs) {
+    QList<Marker> result;
+    for (QDate date = utcDay(fromMs).addDays(-1); date <= utcDay(toMs); date = date.addDays(1)) {
+        const Day* d = day(date);
+        if (!d) {
+            continue;
+        }
+        for (qint32 i : d->events) {
+            const ChunkIndexRecord& record = d->records[i];
+            if (record.wallMs < fromMs || record.wallMs >= toMs) {
+                continue;
+            }
+            char text[sizeof(record.value0) + sizeof(record.value1) + 1] = {};
+            std::memcpy(text, &record.value0, sizeof(record.value0));
+            std::memcpy(text + sizeof(record.value0), &record.value1, sizeof(record.value1));
+            result.append(Marker{record.wallMs, static_cast<int>(record.chunk), QString::fromLatin1(text)});
+        }
+    }
+    std::stable_sort(result.begin(), result.end(),
+                     [](const Marker& a, const Marker& b) { return a.wallMs < b.wallMs; });
+    return result;
+}
+
+// ============================================================================
+// ChunkIndexWriter
+// ============================================================================
+
+ChunkIndexWriter& ChunkIndexWriter::instance() {
+    static ChunkIndexWriter instance;
+    return instance;
+}
+
+ChunkIndexWriter::~ChunkIndexWriter() {
+    shutdown();
+}
+
+void ChunkIndexWriter::setRootDirectory(const QString& rootDirectory) {
+    QMutexLocker locker(&m_mutex);
+    m_rootDirectory = rootDirectory;
+}
+
+ChunkIndexWriter::SlotState& ChunkIndexWriter::slot(int slotId) {
+    SlotState& state = m_slots[slotId];
+    if (state.directory.isEmpty() && !m_rootDirectory.isEmpty()) {
+        state.directory = QString("%1/slot_%2").arg(m_rootDirectory).arg(slotId);
+    }
+    return state;
+}
+
+bool ChunkIndexWriter::append(SlotState& state, const QDate& utcDay, const ChunkIndexRecord& record) {
+    if (state.directory.isEmpty()) {
+        return false;
+    }
+
+    if (!state.file || state.day != utcDay) {
+        delete state.file;
+        state.file = nullptr;
+        state.day = utcDay;
+
+        QDir().mkpath(state.directory);
+        auto* file = new QFile(ChunkIndex::dayFile(state.directory, utcDay));
+        if (!file->open(QIODevice::ReadWrite | QIODevice::Append | QIODevice::Unbuffered)) {
+            qWarning() << "ChunkIndexWriter: Cannot open" << file->fileName() << ":" << file->errorString();
+            delete file;
+            return false;
+        }
+        // A record torn by a crash would shift everything after it
+        const qint64 whole = file->size() / RECORD_SIZE * RECORD_SIZE;
+        if (whole != file->size()) {
+            file->resize(whole);
+        }
+        if (whole == 0) {
+            const ChunkIndexRecord header = headerRecord();
+            file->write(reinterpret_cast<const char*>(&header), RECORD_SIZE);
+        }
+        state.file = file;
+    }
+
+    if (state.file->write(reinterpret_cast<const char*>(&record), RECORD_SIZE) != RECORD_SIZE) {
+        qWarning() << "ChunkIndexWriter: Write failed:" << state.file->fileName() << state.file->errorString();
+        delete state.file;
+        state.file = nullptr;  // Reopened (and a partial record cut off) on the next record
+        return false;
+    }
+    return true;
+}
+
+void ChunkIndexWriter::chunkStarted(int slotId, const QString& filename, int chunkNumber,
+                                    const QDateTime& nameTime, qint64 startWallMs) {
+    QMutexLocker locker(&m_mutex);
+    SlotState& state = slot(slotId);
+    state.directory = QFileInfo(filename).absolutePath();
+    state.chunk = chunkNumber;
+    state.chunkStartMs = startWallMs;
+
+    ChunkIndexRecord record;
+    record.type = ChunkIndexRecord::ChunkStart;
+    record.chunk = static_cast<quint32>(chunkNumber);
+    record.wallMs = startWallMs;
+    record.value0 = nameTime.toMSecsSinceEpoch();
+    append(state, QDateTime::fromMSecsSinceEpoch(startWallMs, QTimeZone::utc()).date(), record);
+}
+
+void ChunkIndexWriter::keyframe(int slotId, int chunkNumber, qint64 offsetMs, qint64 byteOffset) {
+    QMutexLocker locker(&m_mutex);
+    SlotState& state = slot(slotId);
+    if (state.chunk != chunkNumber || chunkNumber == 0) {
+        return;
+    }
+
+    ChunkIndexRecord record;
+    record.type = ChunkIndexRecord::Keyframe;
+    record.chunk = static_cast<quint32>(chunkNumber);
+    record.wallMs = state.chunkStartMs + offsetMs;
+    record.value0 = offsetMs;
+    record.value1 = byteOffset;
+    append(state, state.day, record);
+}
+
+void ChunkIndexWriter::chunkFinished(int slotId, int chunkNumber, qint64 durationMs, qint64 bytes) {
+    QMutexLocker locker(&m_mutex);
+    SlotState& state = slot(slotId);
+    if (state.chunk != chunkNumber || chunkNumber == 0) {
+        return;
+    }
+    if (durationMs < 0) {
+        durationMs = qMax<qint64>(0, QDateTime::currentMSecsSinceEpoch() - state.chunkStartMs);
+    }
+
+    ChunkIndexRecord record;
+    record.type = ChunkIndexRecord::ChunkEnd;
+    record.chunk = static_cast<quint32>(chunkNumber);
+    record.wallMs = state.chunkStartMs + durationMs;
+    record.value0 = durationMs;
+    record.value1 = bytes;
+    append(state, state.day, record);
+    state.chunk = 0;
+}
+
+void ChunkIndexWriter::marker(int slotId, const QString& reason) {
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    QMutexLocker locker(&m_mutex);
+    if (slotId < 0) {
+        for (auto it = m_slots.begin(); it != m_slots.end(); ++it) {
+            appendMarker(it.value(), reason, nowMs);
+        }
+        return;
+    }
+    appendMarker(slot(slotId), reason, nowMs);
+}
+
+void ChunkIndexWriter::appendMarker(SlotState& state, const QString& reason, qint64 nowMs) {
+    if (reason == state.lastReason && nowMs - state.lastMarkerMs < MARKER_MERGE_MS) {
+        return;
+    }
+    state.lastReason = reason;
+    state.lastMarkerMs = nowMs;
+
+    ChunkIndexRecord record;
+    record.type = ChunkIndexRecord::Event;
+    record.chunk = static_cast<quint32>(state.chunk);
+    record.wallMs = nowMs;
+    const QByteArray text = reason.toLatin1().left(sizeof(record.value0) + sizeof(record.value1));
+    char bytes[sizeof(record.value0) + sizeof(record.value1)] = {};
+    std::memcpy(bytes, text.constData(), static_cast<size_t>(text.size()));
+    std::memcpy(&record.value0, bytes, sizeof(record.value0));
+    std::memcpy(&record.value1, bytes + sizeof(record.value0), sizeof(record.value1));
+
+    // With a chunk open, into its file (the reader looks a day back for markers too)
+    const QDate day = state.chunk != 0 ? state.day
+                                       : QDateTime::fromMSecsSinceEpoch(nowMs, QTimeZone::utc()).date();
+    append(state, day, record);
+}
+
+void ChunkIndexWriter::shutdown() {
+    QMutexLocker locker(&m_mutex);
+    for (SlotState& state : m_slots) {
+        delete state.file;
+        state.file = nullptr;
+    }
+}
+
+} // namespace MCM
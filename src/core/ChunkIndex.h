@@ -0,0 +1,257 @@
+#ifndef CHUNKINDEX_H
+#define CHUNKINDEX_H
+
+#include <QString>
+#include <QDate>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QMutex>
+#include <memory>
+#include <vector>
+
+class QFile;
+
+namespace MCM {
+
+/**
+ * @brief One fixed-size entry of a chunk index file
+ *
+ * Files are a header record followed by records in the order they were
+ * written, in host byte order. Fixed size keeps the file seekable by
+ * record number and lets a torn write at a crash be cut off cleanly.
+ */
+struct ChunkIndexRecord {
+    enum Type : quint32 {
+        Header = 0x4944434d,   // "MCMI"; chunk = format version
+        ChunkStart = 1,        // value0 = file name time (ms since epoch)
+        Keyframe = 2,          // value0 = media offset in the chunk (ms), value1 = bytes written before it
+        ChunkEnd = 3,          // value0 = media duration (ms), value1 = file size (0 = unknown)
+        Event = 4              // value0/value1 = reason, up to 16 Latin-1 characters
+    };
+
+    quint32 type{0};
+    quint32 chunk{0};          // Chunk number (Event: chunk open at the time, 0 = none)
+    qint64 wallMs{0};          // Wall clock of the entry, ms since epoch (UTC)
+    qint64 value0{0};
+    qint64 value1{0};
+};
+static_assert(sizeof(ChunkIndexRecord) == 32, "ChunkIndexRecord must stay 32 bytes");
+
+/**
+ * @brief Read side of a slot's chunk index (memory-mapped)
+ *
+ * Every slot_N folder holds one append-only index file per UTC day,
+ * index_yyyyMMdd.idx, with the start and end of each chunk, its keyframes
+ * and the event markers (see ChunkIndexWriter). All records of a chunk go
+ * to the file of the day it started in, so the chunk that holds a given
+ * time is in that day's file or the previous one.
+ *
+ * A day file is mapped and scanned once, building a small table of its
+ * chunks; after that locate() is two binary searches on the mapping, no
+ * reads and no directory listing - a day of 16 slots is about 45 MB of
+ * index at one keyframe per second. Files that grew since (the live day)
+ * are remapped and only the new records are scanned.
+ *
+ * Not thread-safe; one instance per reader.
+ *
+ * Usage:
+ *   ChunkIndex index(recordingsDir + "/slot_3");
+ *   ChunkIndex::Position pos = index.locate(QDateTime::currentMSecsSinceEpoch() - 60000);
+ *   if (pos.isValid()) player->setSource(QUrl::fromLocalFile(pos.path)), player->setPosition(pos.offsetMs);
+ */
+class ChunkIndex {
+public:
+    /**
+     * @brief Where a wall-clock time is recorded
+     */
+    struct Position {
+        QString path;              // Chunk file
+        int chunk{0};
+        qint64 chunkStartMs{0};    // Wall clock of the chunk's first frame
+        qint64 chunkEndMs{0};      // Wall clock of its end (open chunk: last indexed keyframe)
+        qint64 offsetMs{0};        // Requested time as media position in the chunk
+        qint64 keyframeOffsetMs{0};  // Media position of the last keyframe at or before it
+        qint64 keyframeByte{-1};   // Bytes written before that keyframe (-1 = not indexed)
+        bool open{false};          // Chunk still being written
+
+        bool isValid() const { return !path.isEmpty(); }
+    };
+
+    struct Marker {
+        qint64 wallMs{0};
+        int chunk{0};
+        QString reason;
+    };
+
+    /**
+     * @param slotDirectory recordings/slot_N folder
+     */
+    explicit ChunkIndex(const QString& slotDirectory);
+    ~ChunkIndex();
+
+    // Prevent copying
+    ChunkIndex(const ChunkIndex&) = delete;
+    ChunkIndex& operator=(const ChunkIndex&) = delete;
+
+    QString slotDirectory() const { return m_directory; }
+
+    /**
+     * @brief Chunk and media position recorded at @p wallMs
+     * @return Invalid position if nothing was recorded then
+     */
+    Position locate(qint64 wallMs);
+
+    /**
+     * @brief First chunk that starts after @p wallMs (within the next day)
+     * @return Invalid position if there is none; offsetMs is 0
+     */
+    Position next(qint64 wallMs);
+
+    /**
+     * @brief Recorded spans overlapping [fromMs, toMs), as (start, end) wall-clock pairs
+     */
+    QList<QPair<qint64, qint64>> coverage(qint64 fromMs, qint64 toMs);
+
+    /**
+     * @brief Event markers in [fromMs, toMs), oldest first
+     */
+    QList<Marker> markers(qint64 fromMs, qint64 toMs);
+
+    /**
+     * @brief Index file of a slot folder for a UTC day
+     */
+    static QString dayFile(const QString& slotDirectory, const QDate& utcDay);
+
+    /**
+     * @brief File name of a chunk (shared with the recorders)
+     * @return {chunk:03}_{yyyyMMdd_HHmmss}.mp4 in @p startTime's local time
+     */
+    static QString chunkBaseName(int chunkNumber, const QDateTime& startTime);
+
+    /**
+     * @brief Delete a slot folder's index files of days before @p utcDay
+     * @return Number of files removed
+     */
+    static int removeDaysBefore(const QString& slotDirectory, const QDate& utcDay);
+
+    static constexpr quint32 FORMAT_VERSION = 1;
+
+private:
+    struct ChunkEntry {
+        int chunk{0};
+        qint64 startMs{0};
+        qint64 endMs{-1};          // -1 = no ChunkEnd yet
+        qint64 nameMs{0};
+        int firstKeyframe{0};      // Range in Day::keyframes
+        int keyframeCount{0};
+    };
+
+    struct Day {
+        std::unique_ptr<QFile> file;
+        const ChunkIndexRecord* records{nullptr};
+        qint64 mappedCount{0};     // Records in the mapping
+        qint64 scannedCount{0};    // Records already in chunks / keyframes / events
+        bool valid{false};
+        std::vector<ChunkEntry> chunks;   // Start order
+        std::vector<qint32> keyframes;    // Record numbers
+        std::vector<qint32> events;       // Record numbers
+    };
+
+    Day* day(const QDate& utcDay);
+    void refresh(Day& day);
+    void scan(Day& day);
+    Position position(const Day& day, const ChunkEntry& entry, qint64 wallMs) const;
+    static qint64 endOf(const Day& day, const ChunkEntry& entry);
+    static QDate utcDay(qint64 wallMs);
+
+    QString m_directory;
+    QHash<QDate, Day*> m_days;
+};
+
+/**
+ * @brief Write side of the chunk indexes of all slots (Singleton)
+ *
+ * Recorders report chunk starts and ends and, where they see the packets
+ * (RtspRemuxRecorder), every keyframe; EventTrigger's triggers become
+ * markers. Each call appends one 32-byte record to the slot's index file
+ * of the day; the files are never rewritten, only removed by retention
+ * together with the day's chunks (RecordingStorage).
+ *
+ * Thread-safe. Records are written unbuffered, so a reader sees a chunk as
+ * soon as it starts.
+ *
+ * Usage:
+ *   ChunkIndexWriter::instance().chunkStarted(slotId, filename, number, nameTime, startWallMs);
+ *   ChunkIndexWriter::instance().keyframe(slotId, number, offsetMs, bytesBefore);
+ *   ChunkIndexWriter::instance().chunkFinished(slotId, number, durationMs);
+ */
+class ChunkIndexWriter {
+public:
+    static ChunkIndexWriter& instance();
+
+    // Prevent copying
+    ChunkIndexWriter(const ChunkIndexWriter&) = delete;
+    ChunkIndexWriter& operator=(const ChunkIndexWriter&) = delete;
+
+    /**
+     * @brief Recordings directory, for markers of slots that have not started a chunk yet
+     */
+    void setRootDirectory(const QString& rootDirectory);
+
+    /**
+     * @param filename Chunk path, named by ChunkIndex::chunkBaseName(chunkNumber, nameTime)
+     * @param startWallMs Wall clock of the chunk's first frame (earlier than now with pre-roll)
+     */
+    void chunkStarted(int slotId, const QString& filename, int chunkNumber,
+                      const QDateTime& nameTime, qint64 startWallMs);
+
+    /**
+     * @brief A keyframe of the open chunk, @p offsetMs into its media
+     */
+    void keyframe(int slotId, int chunkNumber, qint64 offsetMs, qint64 byteOffset);
+
+    /**
+     * @param durationMs Media duration (-1 = wall time since the start)
+     */
+    void chunkFinished(int slotId, int chunkNumber, qint64 durationMs, qint64 bytes = 0);
+
+    /**
+     * @brief Event marker at the current time (slotId -1 = every slot)
+     */
+    void marker(int slotId, const QString& reason);
+
+    /**
+     * @brief Close all index files
+     */
+    void shutdown();
+
+private:
+    ChunkIndexWriter() = default;
+    ~ChunkIndexWriter();
+
+    struct SlotState {
+        QString directory;
+        QDate day;                  // Day file of the open chunk
+        QFile* file{nullptr};
+        int chunk{0};               // Open chunk (0 = none)
+        qint64 chunkStartMs{0};
+        QString lastReason;
+        qint64 lastMarkerMs{0};
+    };
+
+    SlotState& slot(int slotId);
+    bool append(SlotState& state, const QDate& utcDay, const ChunkIndexRecord& record);
+    void appendMarker(SlotState& state, const QString& reason, qint64 nowMs);
+
+    QMutex m_mutex;
+    QString m_rootDirectory;
+    QHash<int, SlotState> m_slots;
+
+    static constexpr qint64 MARKER_MERGE_MS = 5000;  // Repeats of one reason (motion) within this are one marker
+};
+
+} // namespace MCM
+
+#endif // CHUNKINDEX_H
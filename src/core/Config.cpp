@@ -1,5 +1,6 @@
 #include "Config.h"
 #include <QDebug>
+#include <utility>
 
 namespace MCM {
 
@@ -7,7 +8,8 @@ namespace MCM {
 QJsonObject GridConfig::toJson() const {
     return QJsonObject{
         {"rows", rows},
-        {"columns", columns}
+        {"columns", columns},
+        {"renderer", renderer}
         // maxSlots is computed as rows * columns, not stored
     };
 }
@@ -16,6 +18,10 @@ GridConfig GridConfig::fromJson(const QJsonObject& obj) {
     GridConfig config;
     config.rows = obj.value("rows").toInt(2);
     config.columns = obj.value("columns").toInt(4);
+    config.renderer = obj.value("renderer").toString("perSlot");
+    if (config.renderer != "shared" && config.renderer != "software") {
+        config.renderer = "perSlot";
+    }
     // maxSlots is computed automatically as rows * columns
     return config;
 }
@@ -25,7 +31,8 @@ QJsonObject BufferConfig::toJson() const {
     return QJsonObject{
         {"frameCount", frameCount},
         {"minMaintenance", minMaintenance},
-        {"displayFps", displayFps}
+        {"displayFps", displayFps},
+        {"previewMaxHeight", previewMaxHeight}
     };
 }
 
@@ -33,7 +40,122 @@ BufferConfig BufferConfig::fromJson(const QJsonObject& obj) {
     BufferConfig config;
     config.frameCount = obj.value("frameCount").toInt(30);
     config.minMaintenance = obj.value("minMaintenance").toInt(10);
-    config.displayFps = obj.value("displayFps").toInt(30);
+    config.displayFps = qMax(0, obj.value("displayFps").toInt(30));
+    config.previewMaxHeight = qMax(0, obj.value("previewMaxHeight").toInt(0));
+    return config;
+}
+
+// EncodingProfile implementation
+QJsonObject EncodingProfile::toJson() const {
+    return QJsonObject{
+        {"codec", codec},
+        {"bitrateKbps", bitrateKbps},
+        {"maxHeight", maxHeight},
+        {"fps", fps},
+        {"acceleration", acceleration},
+        {"adaptive", adaptive},
+        {"minBitrateKbps", minBitrateKbps},
+        {"priority", priority}
+    };
+}
+
+EncodingProfile EncodingProfile::fromJson(const QJsonObject& obj, const EncodingProfile& base) {
+    EncodingProfile profile;
+    profile.codec = obj.value("codec").toString(base.codec).toLower();
+    profile.bitrateKbps = qMax(100, obj.value("bitrateKbps").toInt(base.bitrateKbps));
+    profile.maxHeight = qMax(0, obj.value("maxHeight").toInt(base.maxHeight));
+    profile.fps = qMax(0, obj.value("fps").toInt(base.fps));
+    if (obj.contains("gopFrames")) {
+        // QMediaRecorder has no keyframe-interval setting, so this never applied
+        qWarning() << "Config: encoding.gopFrames is not supported and is ignored (the encoder default applies)";
+    }
+    profile.acceleration = obj.value("acceleration").toString(base.acceleration).toLower();
+    profile.adaptive = obj.value("adaptive").toBool(base.adaptive);
+    profile.minBitrateKbps = qBound(100, obj.value("minBitrateKbps").toInt(base.minBitrateKbps),
+                                    profile.bitrateKbps);
+    profile.priority = obj.value("priority").toInt(base.priority);
+    return profile;
+}
+
+// StreamProfile implementation
+QJsonObject StreamProfile::toJson() const {
+    return QJsonObject{
+        {"transport", transport},
+        {"lowLatency", lowLatency},
+        {"probeSizeBytes", probeSizeBytes},
+        {"decode", decode}
+    };
+}
+
+StreamProfile StreamProfile::fromJson(const QJsonObject& obj, const StreamProfile& base) {
+    StreamProfile profile;
+    profile.transport = obj.value("transport").toString(base.transport).toLower();
+    if (profile.transport != "udp" && profile.transport != "tcp") {
+        profile.transport = "auto";
+    }
+    profile.lowLatency = obj.value("lowLatency").toBool(base.lowLatency);
+    profile.probeSizeBytes = qMax(0, obj.value("probeSizeBytes").toInt(base.probeSizeBytes));
+    profile.decode = DecodeConfig::normalizedAcceleration(obj.value("decode").toString(base.decode));
+    return profile;
+}
+
+StreamProfile StreamProfile::forMinMaintenance(int minMaintenance) {
+    StreamProfile profile;
+    if (minMaintenance <= LOW_LATENCY_MAINTENANCE) {
+        // Operator/PTZ use: display as soon as the first keyframe decodes
+        profile.lowLatency = true;
+        profile.probeSizeBytes = 32 * 1024;
+    } else if (minMaintenance < BALANCED_MAINTENANCE) {
+        profile.lowLatency = true;
+        profile.probeSizeBytes = 256 * 1024;
+    }
+    return profile;
+}
+
+// DecodeConfig implementation
+QJsonObject DecodeConfig::toJson() const {
+    return QJsonObject{
+        {"acceleration", acceleration},
+        {"gpuResident", gpuResident}
+    };
+}
+
+DecodeConfig DecodeConfig::fromJson(const QJsonObject& obj) {
+    DecodeConfig config;
+    config.acceleration = normalizedAcceleration(obj.value("acceleration").toString("auto"));
+    if (obj.contains("maxHardwareStreams")) {
+        // The backend decodes every player on the process's engine order; a
+        // per-stream budget could not be enforced
+        qWarning() << "Config: decode.maxHardwareStreams is no longer supported and is ignored";
+    }
+    config.gpuResident = obj.value("gpuResident").toBool(false);
+    return config;
+}
+
+QString DecodeConfig::normalizedAcceleration(const QString& name) {
+    const QString lower = name.toLower();
+    if (lower == "vaapi" || lower == "nvdec" || lower == "videotoolbox" || lower == "software") {
+        return lower;
+    }
+    return "auto";
+}
+
+// EventRecordingConfig implementation
+QJsonObject EventRecordingConfig::toJson() const {
+    return QJsonObject{
+        {"preRollSeconds", preRollSeconds},
+        {"postRollSeconds", postRollSeconds},
+        {"preRollMaxMB", preRollMaxMB},
+        {"motionThreshold", motionThreshold}
+    };
+}
+
+EventRecordingConfig EventRecordingConfig::fromJson(const QJsonObject& obj) {
+    EventRecordingConfig config;
+    config.preRollSeconds = qBound(0, obj.value("preRollSeconds").toInt(10), 300);
+    config.postRollSeconds = qMax(1, obj.value("postRollSeconds").toInt(30));
+    config.preRollMaxMB = qMax(1, obj.value("preRollMaxMB").toInt(32));
+    config.motionThreshold = qBound(0.0, obj.value("motionThreshold").toDouble(0.0), 1.0);
     return config;
 }
 
@@ -44,7 +166,12 @@ QJsonObject RecordingConfig::toJson() const {
         {"chunkDurationSeconds", chunkDurationSeconds},
         {"outputDirectory", outputDirectory},
         {"fps", fps},
-        {"codec", codec}
+        {"rtspPassthrough", rtspPassthrough},
+        {"rotationMode", rotationMode},
+        {"encoding", encoding.toJson()},
+        {"hardwareEncoderSessions", hardwareEncoderSessions},
+        {"mode", mode},
+        {"event", event.toJson()}
     };
 }
 
@@ -54,7 +181,249 @@ RecordingConfig RecordingConfig::fromJson(const QJsonObject& obj) {
     config.chunkDurationSeconds = obj.value("chunkDurationSeconds").toInt(300);
     config.outputDirectory = obj.value("outputDirectory").toString("recordings");
     config.fps = obj.value("fps").toInt(30);
-    config.codec = obj.value("codec").toString("mp4v");
+    config.rtspPassthrough = obj.value("rtspPassthrough").toBool(true);
+    config.rotationMode = obj.value("rotationMode").toString("timer");
+    if (obj.contains("codec")) {
+        // Older files carry a FourCC here ("mp4v" was written by default);
+        // the recorder only ever used encoding.codec
+        qWarning() << "Config: recording.codec is no longer used, set recording.encoding.codec instead";
+    }
+    
+    // Legacy top-level fps seeds the profile when no encoding section exists
+    EncodingProfile legacy;
+    legacy.fps = obj.contains("encoding") ? 0 : qMax(0, obj.value("fps").toInt(0));
+    config.encoding = EncodingProfile::fromJson(obj.value("encoding").toObject(), legacy);
+    config.hardwareEncoderSessions = obj.value("hardwareEncoderSessions").toInt(0);
+    config.mode = obj.value("mode").toString("continuous") == "event" ? "event" : "continuous";
+    config.event = EventRecordingConfig::fromJson(obj.value("event").toObject());
+    return config;
+}
+
+// StartupConfig implementation
+QJsonObject StartupConfig::toJson() const {
+    return QJsonObject{
+        {"maxConcurrentOpens", maxConcurrentOpens},
+        {"openTimeoutMs", openTimeoutMs}
+    };
+}
+
+StartupConfig StartupConfig::fromJson(const QJsonObject& obj) {
+    StartupConfig config;
+    config.maxConcurrentOpens = qMax(1, obj.value("maxConcurrentOpens").toInt(4));
+    config.openTimeoutMs = qMax(500, obj.value("openTimeoutMs").toInt(5000));
+    return config;
+}
+
+// ReconnectConfig implementation
+QJsonObject ReconnectConfig::toJson() const {
+    return QJsonObject{
+        {"initialDelayMs", initialDelayMs},
+        {"maxDelayMs", maxDelayMs},
+        {"multiplier", multiplier},
+        {"jitter", jitter},
+        {"maxAttempts", maxAttempts}
+    };
+}
+
+ReconnectConfig ReconnectConfig::fromJson(const QJsonObject& obj) {
+    ReconnectConfig config;
+    config.initialDelayMs = qMax(50, obj.value("initialDelayMs").toInt(500));
+    config.maxDelayMs = qMax(config.initialDelayMs, obj.value("maxDelayMs").toInt(30000));
+    config.multiplier = qMax(1.0, obj.value("multiplier").toDouble(2.0));
+    config.jitter = qBound(0.0, obj.value("jitter").toDouble(0.5), 1.0);
+    config.maxAttempts = qMax(0, obj.value("maxAttempts").toInt(0));
+    return config;
+}
+
+// StorageConfig implementation
+QJsonObject StorageConfig::toJson() const {
+    return QJsonObject{
+        {"preallocate", preallocate},
+        {"flushIntervalMs", flushIntervalMs},
+        {"backpressureUtilization", backpressureUtilization},
+        {"maxSizeGB", maxSizeGB},
+        {"maxAgeHours", maxAgeHours},
+        {"minFreeMB", minFreeMB},
+        {"retentionIntervalSeconds", retentionIntervalSeconds}
+    };
+}
+
+StorageConfig StorageConfig::fromJson(const QJsonObject& obj) {
+    StorageConfig config;
+    config.preallocate = obj.value("preallocate").toBool(true);
+    const int flushMs = obj.value("flushIntervalMs").toInt(2000);
+    config.flushIntervalMs = flushMs <= 0 ? 0 : qMax(250, flushMs);
+    config.backpressureUtilization = qBound(0.1, obj.value("backpressureUtilization").toDouble(0.8), 1.0);
+    config.maxSizeGB = qMax(0.0, obj.value("maxSizeGB").toDouble(0.0));
+    config.maxAgeHours = qMax(0, obj.value("maxAgeHours").toInt(0));
+    config.minFreeMB = qMax(0, obj.value("minFreeMB").toInt(1024));
+    config.retentionIntervalSeconds = qMax(5, obj.value("retentionIntervalSeconds").toInt(60));
+    return config;
+}
+
+// MotionConfig implementation
+QJsonObject MotionConfig::toJson() const {
+    return QJsonObject{
+        {"enabled", enabled},
+        {"analysisFps", analysisFps},
+        {"gridColumns", gridColumns},
+        {"cellThreshold", cellThreshold}
+    };
+}
+
+MotionConfig MotionConfig::fromJson(const QJsonObject& obj) {
+    MotionConfig config;
+    config.enabled = obj.value("enabled").toBool(false);
+    config.analysisFps = qBound(1, obj.value("analysisFps").toInt(5), 30);
+    config.gridColumns = qBound(16, obj.value("gridColumns").toInt(64), 256);
+    config.cellThreshold = qBound(1, obj.value("cellThreshold").toInt(12), 255);
+    return config;
+}
+
+// SnapshotConfig implementation
+QJsonObject SnapshotConfig::toJson() const {
+    return QJsonObject{
+        {"intervalMs", intervalMs},
+        {"maxWidth", maxWidth},
+        {"quality", quality},
+        {"maxCacheMB", maxCacheMB},
+        {"threads", threads}
+    };
+}
+
+SnapshotConfig SnapshotConfig::fromJson(const QJsonObject& obj) {
+    SnapshotConfig config;
+    config.intervalMs = qMax(100, obj.value("intervalMs").toInt(2000));
+    config.maxWidth = qBound(32, obj.value("maxWidth").toInt(320), 3840);
+    config.quality = qBound(1, obj.value("quality").toInt(75), 100);
+    config.maxCacheMB = qMax(1, obj.value("maxCacheMB").toInt(16));
+    config.threads = qBound(1, obj.value("threads").toInt(2), 8);
+    return config;
+}
+
+// EgressConfig implementation
+QJsonObject EgressConfig::toJson() const {
+    return QJsonObject{
+        {"enabled", enabled},
+        {"bindAddress", bindAddress},
+        {"port", port},
+        {"maxClientsPerSlot", maxClientsPerSlot},
+        {"clientBufferKB", clientBufferKB},
+        {"fragmentMs", fragmentMs}
+    };
+}
+
+EgressConfig EgressConfig::fromJson(const QJsonObject& obj) {
+    EgressConfig config;
+    config.enabled = obj.value("enabled").toBool(false);
+    config.bindAddress = obj.value("bindAddress").toString("0.0.0.0");
+    config.port = qBound(1, obj.value("port").toInt(8090), 65535);
+    config.maxClientsPerSlot = qBound(1, obj.value("maxClientsPerSlot").toInt(8), 256);
+    config.clientBufferKB = qMax(64, obj.value("clientBufferKB").toInt(2048));
+    config.fragmentMs = qBound(100, obj.value("fragmentMs").toInt(500), 10000);
+    return config;
+}
+
+// AnalyticsConfig implementation
+QJsonObject AnalyticsConfig::toJson() const {
+    return QJsonObject{
+        {"enabled", enabled},
+        {"model", model},
+        {"modelPath", modelPath},
+        {"fps", fps},
+        {"maxBatch", maxBatch},
+        {"maxBatchLatencyMs", maxBatchLatencyMs}
+    };
+}
+
+AnalyticsConfig AnalyticsConfig::fromJson(const QJsonObject& obj) {
+    AnalyticsConfig config;
+    config.enabled = obj.value("enabled").toBool(false);
+    config.model = obj.value("model").toString("none");
+    config.modelPath = obj.value("modelPath").toString();
+    config.fps = qBound(1, obj.value("fps").toInt(5), 60);
+    config.maxBatch = qBound(1, obj.value("maxBatch").toInt(32), 256);
+    config.maxBatchLatencyMs = qBound(10, obj.value("maxBatchLatencyMs").toInt(150), 10000);
+    return config;
+}
+
+// MemoryConfig implementation
+QJsonObject MemoryConfig::toJson() const {
+    return QJsonObject{
+        {"budgetMB", budgetMB},
+        {"minAvailableMB", minAvailableMB},
+        {"intervalMs", intervalMs}
+    };
+}
+
+MemoryConfig MemoryConfig::fromJson(const QJsonObject& obj) {
+    MemoryConfig config;
+    config.budgetMB = qMax(0, obj.value("budgetMB").toInt(0));
+    config.minAvailableMB = qMax(0, obj.value("minAvailableMB").toInt(256));
+    config.intervalMs = qBound(100, obj.value("intervalMs").toInt(1000), 60000);
+    return config;
+}
+
+// SchedulingConfig implementation
+QJsonObject SchedulingConfig::toJson() const {
+    return QJsonObject{
+        {"enabled", enabled},
+        {"uiCore", uiCore},
+        {"captureCores", captureCores},
+        {"backgroundCores", backgroundCores},
+        {"displayNice", displayNice},
+        {"backgroundNice", backgroundNice},
+        {"reportIntervalSeconds", reportIntervalSeconds}
+    };
+}
+
+SchedulingConfig SchedulingConfig::fromJson(const QJsonObject& obj) {
+    SchedulingConfig config;
+    config.enabled = obj.value("enabled").toBool(false);
+    config.uiCore = qMax(-1, obj.value("uiCore").toInt(0));
+    config.captureCores = obj.value("captureCores").toString();
+    config.backgroundCores = obj.value("backgroundCores").toString();
+    config.displayNice = qBound(-20, obj.value("displayNice").toInt(-5), 19);
+    config.backgroundNice = qBound(-20, obj.value("backgroundNice").toInt(10), 19);
+    config.reportIntervalSeconds = qBound(0, obj.value("reportIntervalSeconds").toInt(0), 3600);
+    return config;
+}
+
+// ShardingConfig implementation
+QJsonObject ShardingConfig::toJson() const {
+    return QJsonObject{
+        {"workers", workers},
+        {"previewMaxWidth", previewMaxWidth},
+        {"previewMaxHeight", previewMaxHeight},
+        {"restartDelayMs", restartDelayMs}
+    };
+}
+
+ShardingConfig ShardingConfig::fromJson(const QJsonObject& obj) {
+    ShardingConfig config;
+    config.workers = qBound(0, obj.value("workers").toInt(0), 64);
+    config.previewMaxWidth = qBound(160, obj.value("previewMaxWidth").toInt(1280), 3840);
+    config.previewMaxHeight = qBound(120, obj.value("previewMaxHeight").toInt(720), 2160);
+    config.restartDelayMs = qBound(100, obj.value("restartDelayMs").toInt(2000), 60000);
+    return config;
+}
+
+// TelemetryConfig implementation
+QJsonObject TelemetryConfig::toJson() const {
+    return QJsonObject{
+        {"enabled", enabled},
+        {"intervalSeconds", intervalSeconds},
+        {"jsonPath", jsonPath},
+        {"prometheusPath", prometheusPath}
+    };
+}
+
+TelemetryConfig TelemetryConfig::fromJson(const QJsonObject& obj) {
+    TelemetryConfig config;
+    config.enabled = obj.value("enabled").toBool(false);
+    config.intervalSeconds = qMax(1, obj.value("intervalSeconds").toInt(15));
+    config.jsonPath = obj.value("jsonPath").toString("telemetry.json");
+    config.prometheusPath = obj.value("prometheusPath").toString("telemetry.prom");
     return config;
 }
 
@@ -65,6 +434,8 @@ QString SlotConfig::sourceTypeToString(SourceType type) {
         case SourceType::Auto: return "auto";
         case SourceType::Wired: return "wired";
         case SourceType::Rtsp: return "rtsp";
+        case SourceType::File: return "file";
+        case SourceType::Synthetic: return "synthetic";
         default: return "auto";
     }
 }
@@ -74,23 +445,125 @@ SourceType SlotConfig::stringToSourceType(const QString& str) {
     if (str == "auto") return SourceType::Auto;
     if (str == "wired") return SourceType::Wired;
     if (str == "rtsp") return SourceType::Rtsp;
+    if (str == "file") return SourceType::File;
+    if (str == "synthetic") return SourceType::Synthetic;
     return SourceType::Auto;
 }
 
 QJsonObject SlotConfig::toJson() const {
-    return QJsonObject{
+    QJsonObject obj{
         {"type", sourceTypeToString(type)},
         {"source", source}
     };
+    if (!subSource.isEmpty()) {
+        obj["subSource"] = subSource;
+    }
+    if (!encoding.isEmpty()) {
+        obj["encoding"] = encoding;
+    }
+    if (!stream.isEmpty()) {
+        obj["stream"] = stream;
+    }
+    if (previewFps >= 0) {
+        obj["previewFps"] = previewFps;
+    }
+    if (previewMaxHeight >= 0) {
+        obj["previewMaxHeight"] = previewMaxHeight;
+    }
+    if (type == SourceType::File && playbackRate != 1.0) {
+        obj["playbackRate"] = playbackRate;
+    }
+    if (motion >= 0) {
+        obj["motion"] = motion > 0;
+    }
+    return obj;
 }
 
 SlotConfig SlotConfig::fromJson(const QJsonObject& obj) {
     SlotConfig config;
     config.type = stringToSourceType(obj.value("type").toString("auto"));
     config.source = obj.value("source").toString();
+    config.subSource = obj.value("subSource").toString();
+    config.encoding = obj.value("encoding").toObject();
+    config.stream = obj.value("stream").toObject();
+    config.previewFps = obj.value("previewFps").toInt(-1);
+    config.previewMaxHeight = obj.value("previewMaxHeight").toInt(-1);
+    config.playbackRate = obj.value("playbackRate").toDouble(1.0);
+    if (obj.contains("motion")) {
+        config.motion = obj.value("motion").toBool() ? 1 : 0;
+    }
     return config;
 }
 
+// ConfigSnapshot implementation
+const SlotConfig& ConfigSnapshot::slot(int index) const {
+    static SlotConfig defaultSlot;
+    
+    if (index >= 0 && index < static_cast<int>(slots.size())) {
+        return slots[index];
+    }
+    return defaultSlot;
+}
+
+EncodingProfile ConfigSnapshot::encodingProfile(int slotIndex) const {
+    if (slotIndex >= 0 && slotIndex < static_cast<int>(slots.size())) {
+        return EncodingProfile::fromJson(slots[slotIndex].encoding, recording.encoding);
+    }
+    return recording.encoding;
+}
+
+StreamProfile ConfigSnapshot::streamProfile(int slotIndex) const {
+    StreamProfile base = StreamProfile::forMinMaintenance(buffer.minMaintenance);
+    base.decode = decode.acceleration;
+    if (slotIndex >= 0 && slotIndex < static_cast<int>(slots.size())) {
+        return StreamProfile::fromJson(slots[slotIndex].stream, base);
+    }
+    return base;
+}
+
+int ConfigSnapshot::previewFps(int slotIndex) const {
+    if (slotIndex >= 0 && slotIndex < static_cast<int>(slots.size())
+        && slots[slotIndex].previewFps >= 0) {
+        return slots[slotIndex].previewFps;
+    }
+    return buffer.displayFps;
+}
+
+int ConfigSnapshot::previewMaxHeight(int slotIndex) const {
+    if (slotIndex >= 0 && slotIndex < static_cast<int>(slots.size())
+        && slots[slotIndex].previewMaxHeight >= 0) {
+        return slots[slotIndex].previewMaxHeight;
+    }
+    return buffer.previewMaxHeight;
+}
+
+bool ConfigSnapshot::motionEnabled(int slotIndex) const {
+    if (slotIndex >= 0 && slotIndex < static_cast<int>(slots.size())
+        && slots[slotIndex].motion >= 0) {
+        return slots[slotIndex].motion > 0;
+    }
+    return motion.enabled
+        || (recording.enabled && recording.eventTriggered() && recording.event.motionThreshold > 0.0);
+}
+
+// ConfigDiff implementation
+QStringList ConfigDiff::sectionNames() const {
+    static const std::pair<Section, const char*> names[] = {
+        {Grid, "grid"}, {Buffer, "buffer"}, {Recording, "recording"}, {Startup, "startup"},
+        {Telemetry, "telemetry"}, {Reconnect, "reconnect"}, {Storage, "storage"},
+        {Motion, "motion"}, {Snapshot, "snapshot"}, {Egress, "egress"}, {Decode, "decode"},
+        {Slots, "slots"}, {Sharding, "sharding"}, {Analytics, "analytics"},
+        {Memory, "memory"}, {Scheduling, "scheduling"}
+    };
+    QStringList result;
+    for (const auto& [section, name] : names) {
+        if (has(section)) {
+            result.append(QString::fromLatin1(name));
+        }
+    }
+    return result;
+}
+
 // Config implementation
 Config& Config::instance() {
     static Config instance;
@@ -99,29 +572,29 @@ Config& Config::instance() {
 
 Config::Config() {
     initializeDefaults();
+    publishLocked();
 }
 
 void Config::initializeDefaults() {
-    m_grid = GridConfig();
-    m_buffer = BufferConfig();
-    m_recording = RecordingConfig();
+    m_values = ConfigSnapshot();
     
-    m_slots.clear();
-    for (int i = 0; i < m_grid.maxSlots(); ++i) {
+    for (int i = 0; i < m_values.grid.maxSlots(); ++i) {
         SlotConfig slot;
         slot.type = SourceType::Auto;
         slot.source = QString::number(i);  // Slot index = device index
-        m_slots.push_back(slot);
+        m_values.slots.push_back(slot);
     }
 }
 
-bool Config::load(const QString& path) {
-    QMutexLocker locker(&m_mutex);
-    
+void Config::publishLocked() {
+    std::atomic_store(&m_current, std::shared_ptr<const ConfigSnapshot>(
+        std::make_shared<ConfigSnapshot>(m_values)));
+}
+
+bool Config::parseFile(const QString& path, ConfigSnapshot& values) {
     QFile file(path);
     if (!file.open(QIODevice::ReadOnly)) {
         qWarning() << "Could not open config file:" << path;
-        initializeDefaults();
         return false;
     }
     
@@ -133,64 +606,246 @@ bool Config::load(const QString& path) {
     
     if (error.error != QJsonParseError::NoError) {
         qWarning() << "JSON parse error:" << error.errorString();
-        initializeDefaults();
         return false;
     }
     
     QJsonObject root = doc.object();
+    ConfigSnapshot parsed;
     
     // Parse grid config
     if (root.contains("grid")) {
-        m_grid = GridConfig::fromJson(root.value("grid").toObject());
+        parsed.grid = GridConfig::fromJson(root.value("grid").toObject());
     }
     
     // Parse buffer config
     if (root.contains("buffer")) {
-        m_buffer = BufferConfig::fromJson(root.value("buffer").toObject());
+        parsed.buffer = BufferConfig::fromJson(root.value("buffer").toObject());
     }
     
     // Parse recording config
     if (root.contains("recording")) {
-        m_recording = RecordingConfig::fromJson(root.value("recording").toObject());
+        parsed.recording = RecordingConfig::fromJson(root.value("recording").toObject());
+    }
+    
+    // Parse startup config
+    if (root.contains("startup")) {
+        parsed.startup = StartupConfig::fromJson(root.value("startup").toObject());
+    }
+    
+    // Parse telemetry config
+    if (root.contains("telemetry")) {
+        parsed.telemetry = TelemetryConfig::fromJson(root.value("telemetry").toObject());
+    }
+    
+    // Parse reconnect config
+    if (root.contains("reconnect")) {
+        parsed.reconnect = ReconnectConfig::fromJson(root.value("reconnect").toObject());
+    }
+    
+    // Parse storage config
+    if (root.contains("storage")) {
+        parsed.storage = StorageConfig::fromJson(root.value("storage").toObject());
+    }
+    
+    // Parse motion config
+    if (root.contains("motion")) {
+        parsed.motion = MotionConfig::fromJson(root.value("motion").toObject());
+    }
+    
+    // Parse snapshot config
+    if (root.contains("snapshot")) {
+        parsed.snapshot = SnapshotConfig::fromJson(root.value("snapshot").toObject());
+    }
+    
+    // Parse egress config
+    if (root.contains("egress")) {
+        parsed.egress = EgressConfig::fromJson(root.value("egress").toObject());
+    }
+    
+    // Parse decode config
+    if (root.contains("decode")) {
+        parsed.decode = DecodeConfig::fromJson(root.value("decode").toObject());
+    }
+    
+    // Parse sharding config
+    if (root.contains("sharding")) {
+        parsed.sharding = ShardingConfig::fromJson(root.value("sharding").toObject());
+    }
+    
+    // Parse analytics config
+    if (root.contains("analytics")) {
+        parsed.analytics = AnalyticsConfig::fromJson(root.value("analytics").toObject());
+    }
+    
+    // Parse memory config
+    if (root.contains("memory")) {
+        parsed.memory = MemoryConfig::fromJson(root.value("memory").toObject());
+    }
+    
+    // Parse scheduling config
+    if (root.contains("scheduling")) {
+        parsed.scheduling = SchedulingConfig::fromJson(root.value("scheduling").toObject());
     }
     
     // Parse slots config
-    m_slots.clear();
     if (root.contains("slots")) {
         QJsonArray slotsArray = root.value("slots").toArray();
         for (const QJsonValue& val : slotsArray) {
-            m_slots.push_back(SlotConfig::fromJson(val.toObject()));
+            parsed.slots.push_back(SlotConfig::fromJson(val.toObject()));
         }
     }
     
     // Ensure we have exactly the right number of slots (rows * columns)
     // Add slots if we have too few
-    while (static_cast<int>(m_slots.size()) < m_grid.maxSlots()) {
+    while (static_cast<int>(parsed.slots.size()) < parsed.grid.maxSlots()) {
         SlotConfig slot;
         slot.type = SourceType::Auto;
-        slot.source = QString::number(m_slots.size());
-        m_slots.push_back(slot);
+        slot.source = QString::number(parsed.slots.size());
+        parsed.slots.push_back(slot);
     }
     // Remove slots if we have too many
-    while (static_cast<int>(m_slots.size()) > m_grid.maxSlots()) {
-        m_slots.pop_back();
+    while (static_cast<int>(parsed.slots.size()) > parsed.grid.maxSlots()) {
+        parsed.slots.pop_back();
+    }
+    
+    values = std::move(parsed);
+    return true;
+}
+
+bool Config::load(const QString& path) {
+    QMutexLocker locker(&m_mutex);
+    
+    m_unsavedSlots.clear();
+    if (!parseFile(path, m_values)) {
+        initializeDefaults();
+        m_savedSlots.clear();
+        publishLocked();
+        return false;
     }
+    m_savedSlots = m_values.slots;
+    publishLocked();
     
     m_configPath = path;
     qDebug() << "Config loaded from:" << path;
     return true;
 }
 
+bool Config::reload() {
+    QMutexLocker locker(&m_mutex);
+    
+    if (m_configPath.isEmpty()) {
+        return false;
+    }
+    ConfigSnapshot parsed;
+    if (!parseFile(m_configPath, parsed)) {
+        qWarning() << "Config: Keeping current configuration, could not reload" << m_configPath;
+        return false;
+    }
+    
+    // Unsaved slot edits (a tile's source selector) survive a reload, unless
+    // the file changed the same slot: then the external edit wins
+    const std::vector<SlotConfig> fileSlots = parsed.slots;
+    for (auto it = m_unsavedSlots.begin(); it != m_unsavedSlots.end();) {
+        const int index = *it;
+        const bool keep = index < static_cast<int>(parsed.slots.size())
+            && index < static_cast<int>(m_values.slots.size())
+            && index < static_cast<int>(m_savedSlots.size())
+            && parsed.slots[index].toJson() == m_savedSlots[index].toJson();
+        if (keep) {
+            parsed.slots[index] = m_values.slots[index];
+            ++it;
+        } else {
+            it = m_unsavedSlots.erase(it);
+        }
+    }
+    m_savedSlots = fileSlots;
+    m_values = std::move(parsed);
+    publishLocked();
+    
+    qDebug() << "Config reloaded from:" << m_configPath;
+    return true;
+}
+
+ConfigDiff Config::diff(const ConfigSnapshot& from, const ConfigSnapshot& to) {
+    ConfigDiff diff;
+    
+    // Sections compare by their JSON form: the same fields save() writes
+    auto section = [&diff](ConfigDiff::Section bit, const QJsonObject& a, const QJsonObject& b) {
+        if (a != b) {
+            diff.sections |= bit;
+        }
+    };
+    section(ConfigDiff::Grid, from.grid.toJson(), to.grid.toJson());
+    section(ConfigDiff::Buffer, from.buffer.toJson(), to.buffer.toJson());
+    section(ConfigDiff::Recording, from.recording.toJson(), to.recording.toJson());
+    section(ConfigDiff::Startup, from.startup.toJson(), to.startup.toJson());
+    section(ConfigDiff::Telemetry, from.telemetry.toJson(), to.telemetry.toJson());
+    section(ConfigDiff::Reconnect, from.reconnect.toJson(), to.reconnect.toJson());
+    section(ConfigDiff::Storage, from.storage.toJson(), to.storage.toJson());
+    section(ConfigDiff::Motion, from.motion.toJson(), to.motion.toJson());
+    section(ConfigDiff::Snapshot, from.snapshot.toJson(), to.snapshot.toJson());
+    section(ConfigDiff::Egress, from.egress.toJson(), to.egress.toJson());
+    section(ConfigDiff::Decode, from.decode.toJson(), to.decode.toJson());
+    section(ConfigDiff::Sharding, from.sharding.toJson(), to.sharding.toJson());
+    section(ConfigDiff::Analytics, from.analytics.toJson(), to.analytics.toJson());
+    section(ConfigDiff::Memory, from.memory.toJson(), to.memory.toJson());
+    section(ConfigDiff::Scheduling, from.scheduling.toJson(), to.scheduling.toJson());
+    
+    // Recorders and detectors take these at stream start
+    const bool streamsAffected = diff.has(ConfigDiff::Recording) || diff.has(ConfigDiff::Motion)
+        || from.decode.gpuResident != to.decode.gpuResident;
+    
+    const int common = static_cast<int>(qMin(from.slots.size(), to.slots.size()));
+    for (int i = 0; i < common; ++i) {
+        const SlotConfig& a = from.slots[i];
+        const SlotConfig& b = to.slots[i];
+        if (a.toJson() != b.toJson()) {
+            diff.sections |= ConfigDiff::Slots;
+        }
+        
+        if (a.type != b.type || a.source != b.source) {
+            diff.sourceChanged.append(i);
+        } else if (streamsAffected
+                   || a.subSource != b.subSource
+                   || a.playbackRate != b.playbackRate
+                   || from.streamProfile(i).toJson() != to.streamProfile(i).toJson()
+                   || from.encodingProfile(i).toJson() != to.encodingProfile(i).toJson()
+                   || from.previewMaxHeight(i) != to.previewMaxHeight(i)
+                   || from.motionEnabled(i) != to.motionEnabled(i)) {
+            diff.restartNeeded.append(i);
+        } else if (from.previewFps(i) != to.previewFps(i)) {
+            diff.previewChanged.append(i);
+        }
+    }
+    if (from.slots.size() != to.slots.size()) {
+        diff.sections |= ConfigDiff::Slots;
+    }
+    
+    return diff;
+}
+
 bool Config::save(const QString& path) {
     QMutexLocker locker(&m_mutex);
     
     QJsonObject root;
-    root["grid"] = m_grid.toJson();
-    root["buffer"] = m_buffer.toJson();
-    root["recording"] = m_recording.toJson();
+    root["grid"] = m_values.grid.toJson();
+    root["buffer"] = m_values.buffer.toJson();
+    root["recording"] = m_values.recording.toJson();
+    root["startup"] = m_values.startup.toJson();
+    root["telemetry"] = m_values.telemetry.toJson();
+    root["reconnect"] = m_values.reconnect.toJson();
+    root["storage"] = m_values.storage.toJson();
+    root["motion"] = m_values.motion.toJson();
+    root["snapshot"] = m_values.snapshot.toJson();
+    root["egress"] = m_values.egress.toJson();
+    root["decode"] = m_values.decode.toJson();
+    root["sharding"] = m_values.sharding.toJson();
+    root["analytics"] = m_values.analytics.toJson();
+    root["memory"] = m_values.memory.toJson();
+    root["scheduling"] = m_values.scheduling.toJson();
     
     QJsonArray slotsArray;
-    for (const auto& slot : m_slots) {
+    for (const auto& slot : m_values.slots) {
         slotsArray.append(slot.toJson());
     }
     root["slots"] = slotsArray;
@@ -206,6 +861,8 @@ bool Config::save(const QString& path) {
     file.write(doc.toJson(QJsonDocument::Indented));
     file.close();
     
+    m_savedSlots = m_values.slots;
+    m_unsavedSlots.clear();
     m_configPath = path;
     qDebug() << "Config saved to:" << path;
     return true;
@@ -213,51 +870,124 @@ bool Config::save(const QString& path) {
 
 const SlotConfig& Config::slot(int index) const {
     QMutexLocker locker(&m_mutex);
-    static SlotConfig defaultSlot;
-    
-    if (index >= 0 && index < static_cast<int>(m_slots.size())) {
-        return m_slots[index];
-    }
-    return defaultSlot;
+    return m_values.slot(index);
 }
 
 void Config::setGrid(const GridConfig& config) {
     QMutexLocker locker(&m_mutex);
-    m_grid = config;
+    m_values.grid = config;
     
     // Adjust slots array to match new grid size
-    while (static_cast<int>(m_slots.size()) < m_grid.maxSlots()) {
+    std::vector<SlotConfig>& slots = m_values.slots;
+    while (static_cast<int>(slots.size()) < m_values.grid.maxSlots()) {
         SlotConfig slot;
         slot.type = SourceType::Auto;
-        slot.source = QString::number(m_slots.size());
-        m_slots.push_back(slot);
+        slot.source = QString::number(slots.size());
+        slots.push_back(slot);
     }
-    while (static_cast<int>(m_slots.size()) > m_grid.maxSlots()) {
-        m_slots.pop_back();
+    while (static_cast<int>(slots.size()) > m_values.grid.maxSlots()) {
+        slots.pop_back();
     }
+    publishLocked();
 }
 
 void Config::setBuffer(const BufferConfig& config) {
     QMutexLocker locker(&m_mutex);
-    m_buffer = config;
+    m_values.buffer = config;
+    publishLocked();
 }
 
 void Config::setRecording(const RecordingConfig& config) {
     QMutexLocker locker(&m_mutex);
-    m_recording = config;
+    m_values.recording = config;
+    publishLocked();
+}
+
+void Config::setStartup(const StartupConfig& config) {
+    QMutexLocker locker(&m_mutex);
+    m_values.startup = config;
+    publishLocked();
+}
+
+void Config::setTelemetry(const TelemetryConfig& config) {
+    QMutexLocker locker(&m_mutex);
+    m_values.telemetry = config;
+    publishLocked();
+}
+
+void Config::setReconnect(const ReconnectConfig& config) {
+    QMutexLocker locker(&m_mutex);
+    m_values.reconnect = config;
+    publishLocked();
+}
+
+void Config::setStorage(const StorageConfig& config) {
+    QMutexLocker locker(&m_mutex);
+    m_values.storage = config;
+    publishLocked();
+}
+
+void Config::setMotion(const MotionConfig& config) {
+    QMutexLocker locker(&m_mutex);
+    m_values.motion = config;
+    publishLocked();
+}
+
+void Config::setSnapshot(const SnapshotConfig& config) {
+    QMutexLocker locker(&m_mutex);
+    m_values.snapshot = config;
+    publishLocked();
+}
+
+void Config::setEgress(const EgressConfig& config) {
+    QMutexLocker locker(&m_mutex);
+    m_values.egress = config;
+    publishLocked();
+}
+
+void Config::setDecode(const DecodeConfig& config) {
+    QMutexLocker locker(&m_mutex);
+    m_values.decode = config;
+    publishLocked();
+}
+
+void Config::setSharding(const ShardingConfig& config) {
+    QMutexLocker locker(&m_mutex);
+    m_values.sharding = config;
+    publishLocked();
+}
+
+void Config::setAnalytics(const AnalyticsConfig& config) {
+    QMutexLocker locker(&m_mutex);
+    m_values.analytics = config;
+    publishLocked();
+}
+
+void Config::setMemory(const MemoryConfig& config) {
+    QMutexLocker locker(&m_mutex);
+    m_values.memory = config;
+    publishLocked();
+}
+
+void Config::setScheduling(const SchedulingConfig& config) {
+    QMutexLocker locker(&m_mutex);
+    m_values.scheduling = config;
+    publishLocked();
 }
 
 void Config::setSlot(int index, const SlotConfig& config) {
     QMutexLocker locker(&m_mutex);
-    if (index >= 0 && index < static_cast<int>(m_slots.size())) {
-        m_slots[index] = config;
+    if (index >= 0 && index < static_cast<int>(m_values.slots.size())) {
+        m_values.slots[index] = config;
+        m_unsavedSlots.insert(index);
+        publishLocked();
     }
 }
 
 void Config::resetToDefaults() {
     QMutexLocker locker(&m_mutex);
     initializeDefaults();
+    publishLocked();
 }
 
 } // namespace MCM
-
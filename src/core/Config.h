@@ -5,10 +5,13 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QJsonDocument>
+#include <QList>
+#include <QStringList>
 #include <QFile>
 #include <QDir>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QSet>
 #include <vector>
 #include <memory>
 
@@ -20,6 +23,7 @@ namespace MCM {
 struct GridConfig {
     int rows = 2;
     int columns = 4;
+    QString renderer = "perSlot";  // "perSlot" (one view per tile), "shared" (one scene for the grid) or "software" (CPU painting)
     
     // Computed property - total slots = rows * columns
     int maxSlots() const { return rows * columns; }
@@ -34,12 +38,98 @@ struct GridConfig {
 struct BufferConfig {
     int frameCount = 30;       // Maximum frames in buffer
     int minMaintenance = 10;   // Minimum frames before playback starts
-    int displayFps = 30;       // Display refresh rate
+    int displayFps = 30;       // Max frames/s shown per tile (0 = every frame; recording is unaffected)
+    int previewMaxHeight = 0;  // Max capture height for display-only wired slots (0 = no cap)
     
     QJsonObject toJson() const;
     static BufferConfig fromJson(const QJsonObject& obj);
 };
 
+/**
+ * @brief Encoder settings for QtVideoRecorder
+ *
+ * RecordingConfig::encoding is the default; a slot may override any
+ * subset of fields via SlotConfig::encoding (see Config::encodingProfile).
+ */
+struct EncodingProfile {
+    QString codec = "h264";          // h264, hevc, mpeg4
+    int bitrateKbps = 4000;
+    int maxHeight = 0;               // Downscale to this height (0 = source resolution)
+    int fps = 0;                     // 0 = source frame rate
+    QString acceleration = "auto";   // auto, hardware, software
+    bool adaptive = false;           // Step bitrate/resolution down when the encoder backs up
+    int minBitrateKbps = 1000;       // Adaptive floor
+    int priority = 0;                // Hardware encoder priority (higher wins)
+    
+    QJsonObject toJson() const;
+    
+    /**
+     * @brief Parse a profile; missing fields are taken from base
+     */
+    static EncodingProfile fromJson(const QJsonObject& obj,
+                                    const EncodingProfile& base = EncodingProfile());
+};
+
+/**
+ * @brief RTSP playback tuning for QtRtspCapture (latency vs smoothness)
+ *
+ * The base profile follows BufferConfig::minMaintenance - the latency
+ * slider in Settings (see forMinMaintenance()); a slot may override any
+ * subset of fields via SlotConfig::stream (see Config::streamProfile).
+ * Passthrough recording keeps its own TCP session and is not affected.
+ */
+struct StreamProfile {
+    QString transport = "auto";  // auto (FFmpeg: UDP, then TCP), udp, tcp (interleaved)
+    bool lowLatency = false;     // No demuxer buffering; frames shown as soon as decoded, late ones dropped (Qt 6.10+)
+    int probeSizeBytes = 0;      // Bytes read to detect the stream (0 = FFmpeg default, 5 MB; Qt 6.10+)
+    QString decode = "auto";     // auto, vaapi, nvdec, videotoolbox, software (base: decode.acceleration)
+    
+    QJsonObject toJson() const;
+    
+    /**
+     * @brief Parse a profile; missing fields are taken from base
+     */
+    static StreamProfile fromJson(const QJsonObject& obj,
+                                  const StreamProfile& base = StreamProfile());
+    
+    /**
+     * @brief Profile for a latency/smoothness setting (fewer frames = lower latency)
+     */
+    static StreamProfile forMinMaintenance(int minMaintenance);
+    
+    static constexpr int LOW_LATENCY_MAINTENANCE = 5;  // At or below: lowest-latency profile
+    static constexpr int BALANCED_MAINTENANCE = 10;    // At or above: FFmpeg defaults
+};
+
+/**
+ * @brief Video decode acceleration for players (see DecoderScheduler)
+ */
+struct DecodeConfig {
+    QString acceleration = "auto";  // auto, vaapi, nvdec, videotoolbox, software; slots add to the order via stream.decode
+    bool gpuResident = false;       // Player tiles and expanded views render decoded textures directly (no CPU copy)
+    
+    QJsonObject toJson() const;
+    static DecodeConfig fromJson(const QJsonObject& obj);
+    
+    /**
+     * @brief Lower-cased @p name if it is a known setting, else "auto"
+     */
+    static QString normalizedAcceleration(const QString& name);
+};
+
+/**
+ * @brief Event-triggered recording: what is kept around a trigger
+ */
+struct EventRecordingConfig {
+    int preRollSeconds = 10;      // Compressed packets kept before a trigger (RTSP/file slots)
+    int postRollSeconds = 30;     // Keep recording this long after the last trigger
+    int preRollMaxMB = 32;        // Per-slot cap on the pre-roll ring
+    double motionThreshold = 0.0; // Motion score (0..1) that triggers a recording (0 = motion ignored)
+    
+    QJsonObject toJson() const;
+    static EventRecordingConfig fromJson(const QJsonObject& obj);
+};
+
 /**
  * @brief Recording configuration for video saving
  */
@@ -48,12 +138,184 @@ struct RecordingConfig {
     int chunkDurationSeconds = 300;  // 5 minutes default
     QString outputDirectory = "recordings";
     int fps = 30;
-    QString codec = "mp4v";
+    bool rtspPassthrough = true;  // Remux RTSP packets to MP4 (no re-encode)
+    QString rotationMode = "timer";     // "timer" or "next-frame" (swap once the next frame arrives)
+    EncodingProfile encoding;           // Default encoder profile for all slots
+    int hardwareEncoderSessions = 0;    // Concurrent HW encoder sessions (0 = learn from failures, -1 = unlimited)
+    QString mode = "continuous";        // "continuous" or "event" (record around triggers only)
+    EventRecordingConfig event;
+    
+    bool eventTriggered() const { return mode == "event"; }
     
     QJsonObject toJson() const;
     static RecordingConfig fromJson(const QJsonObject& obj);
 };
 
+/**
+ * @brief Stream startup configuration
+ */
+struct StartupConfig {
+    int maxConcurrentOpens = 4;   // Slots opening at the same time
+    int openTimeoutMs = 5000;     // Wait this long for a first frame before starting the next slot
+    
+    QJsonObject toJson() const;
+    static StartupConfig fromJson(const QJsonObject& obj);
+};
+
+/**
+ * @brief Stream reconnect policy (RTSP playback and passthrough recording)
+ *
+ * Delays grow exponentially from initialDelayMs up to maxDelayMs; each one
+ * is randomized by the jitter fraction so cameras behind a rebooting switch
+ * do not all retry in the same instant.
+ */
+struct ReconnectConfig {
+    int initialDelayMs = 500;
+    int maxDelayMs = 30000;
+    double multiplier = 2.0;
+    double jitter = 0.5;   // 0 = no jitter, 1 = delay anywhere in [0, backoff]
+    int maxAttempts = 0;   // Consecutive failures before giving up (0 = never give up)
+    
+    QJsonObject toJson() const;
+    static ReconnectConfig fromJson(const QJsonObject& obj);
+};
+
+/**
+ * @brief Recording storage: disk writeback, back-pressure and retention
+ *
+ * Retention treats the recordings directory as one ring buffer shared by
+ * all slots: the oldest chunks go first, whichever slot wrote them.
+ */
+struct StorageConfig {
+    bool preallocate = true;          // Reserve each chunk's expected size on disk up front
+    int flushIntervalMs = 2000;       // Write back open chunks this often (0 = leave it to the OS)
+    double backpressureUtilization = 0.8;  // Share of the flush interval spent syncing that signals back-pressure
+    double maxSizeGB = 0.0;           // Total recordings budget across all slots (0 = no limit)
+    int maxAgeHours = 0;              // Delete chunks older than this (0 = keep)
+    int minFreeMB = 1024;             // Delete oldest chunks to keep this much disk free (0 = off)
+    int retentionIntervalSeconds = 60;
+    
+    QJsonObject toJson() const;
+    static StorageConfig fromJson(const QJsonObject& obj);
+};
+
+/**
+ * @brief Motion analysis of decoded frames
+ *
+ * Frames are sampled at analysisFps, decimated to a small luma grid and
+ * compared with the previous sample; the score is the share of grid cells
+ * that changed by more than cellThreshold.
+ */
+struct MotionConfig {
+    bool enabled = false;     // Analyse every slot (slots override with "motion": true/false)
+    int analysisFps = 5;      // Frames analysed per second per slot
+    int gridColumns = 64;     // Target grid width; rows follow the aspect ratio
+    int cellThreshold = 12;   // Mean luma change (0-255) that makes a cell count as moving
+    
+    QJsonObject toJson() const;
+    static MotionConfig fromJson(const QJsonObject& obj);
+};
+
+/**
+ * @brief Cached JPEG thumbnails served by SnapshotService
+ */
+struct SnapshotConfig {
+    int intervalMs = 2000;   // A slot is encoded at most this often, however many clients ask
+    int maxWidth = 320;      // Thumbnail width; height follows the aspect ratio
+    int quality = 75;        // JPEG quality (1-100)
+    int maxCacheMB = 16;     // Thumbnails kept across all slots; least recently requested go first
+    int threads = 2;         // Encoder pool size
+    
+    QJsonObject toJson() const;
+    static SnapshotConfig fromJson(const QJsonObject& obj);
+};
+
+/**
+ * @brief HTTP fMP4 re-publishing of passthrough streams (StreamEgress)
+ */
+struct EgressConfig {
+    bool enabled = false;
+    QString bindAddress = "0.0.0.0";
+    int port = 8090;
+    int maxClientsPerSlot = 8;
+    int clientBufferKB = 2048;   // Unsent data per viewer before it skips to the next keyframe
+    int fragmentMs = 500;        // Longest fragment; keyframes always start a new one
+    
+    QJsonObject toJson() const;
+    static EgressConfig fromJson(const QJsonObject& obj);
+};
+
+/**
+ * @brief Pipeline telemetry export configuration
+ */
+struct TelemetryConfig {
+    bool enabled = false;                      // Periodic export to the files below
+    int intervalSeconds = 15;
+    QString jsonPath = "telemetry.json";       // Empty = no JSON file
+    QString prometheusPath = "telemetry.prom"; // Empty = no Prometheus text file
+    
+    QJsonObject toJson() const;
+    static TelemetryConfig fromJson(const QJsonObject& obj);
+};
+
+/**
+ * @brief Cross-camera batched inference (AnalyticsStage)
+ */
+struct AnalyticsConfig {
+    bool enabled = false;
+    QString model = "none";       // Registered model (AnalyticsStage::registerModel); "none" = batching only
+    QString modelPath;            // Weights / engine file handed to the model
+    int fps = 5;                  // Inference calls per second, one batch of all slots each
+    int maxBatch = 32;            // Frames per call (the model may allow fewer)
+    int maxBatchLatencyMs = 150;  // Frames older than this when the batch is built are dropped
+    
+    QJsonObject toJson() const;
+    static AnalyticsConfig fromJson(const QJsonObject& obj);
+};
+
+/**
+ * @brief Process-wide memory budget for frame buffers and caches (MemoryGovernor)
+ */
+struct MemoryConfig {
+    int budgetMB = 0;             // Shared by frame buffers, pre-roll rings and caches (0 = no fixed budget)
+    int minAvailableMB = 256;     // Trim when the system has less than this available (0 = off; Linux)
+    int intervalMs = 1000;        // How often usage is checked
+    
+    QJsonObject toJson() const;
+    static MemoryConfig fromJson(const QJsonObject& obj);
+};
+
+/**
+ * @brief Thread placement and priorities (ThreadPolicy)
+ *
+ * Core lists are comma separated indexes and ranges, e.g. "2-7,10".
+ */
+struct SchedulingConfig {
+    bool enabled = false;
+    int uiCore = 0;               // Core kept for the GUI thread (-1 = none reserved)
+    QString captureCores;         // Capture workers and generators (empty = every core but uiCore)
+    QString backgroundCores;      // Recording, disk I/O, analysis (empty = every core but uiCore)
+    int displayNice = -5;         // GUI thread and capture workers (below 0 needs CAP_SYS_NICE; Linux)
+    int backgroundNice = 10;      // Writeback/retention and analysis
+    int reportIntervalSeconds = 0;  // Per-thread CPU report in the log (0 = off; Linux)
+    
+    QJsonObject toJson() const;
+    static SchedulingConfig fromJson(const QJsonObject& obj);
+};
+
+/**
+ * @brief Multi-process slot sharding (ShardSupervisor / ShardWorker)
+ */
+struct ShardingConfig {
+    int workers = 0;              // Worker processes running the slots (0 = all in the UI process)
+    int previewMaxWidth = 1280;   // Largest preview frame a worker shares with the UI
+    int previewMaxHeight = 720;
+    int restartDelayMs = 2000;    // First restart delay of a crashed worker (doubles, up to 30 s)
+    
+    QJsonObject toJson() const;
+    static ShardingConfig fromJson(const QJsonObject& obj);
+};
+
 /**
  * @brief Source type enumeration
  */
@@ -61,7 +323,9 @@ enum class SourceType {
     None,    // No streaming
     Auto,    // Automatic (slot index = device index)
     Wired,   // Specific wired camera
-    Rtsp     // RTSP stream
+    Rtsp,    // RTSP stream
+    File,    // Local media file, looped like a live camera (load testing)
+    Synthetic  // Generated test pattern (load testing)
 };
 
 /**
@@ -69,7 +333,14 @@ enum class SourceType {
  */
 struct SlotConfig {
     SourceType type = SourceType::Auto;
-    QString source;  // Device index for wired/auto, URL for RTSP
+    QString source;  // Device index for wired/auto, URL for RTSP (main stream), path for file, "WxH@fps" for synthetic
+    QString subSource;  // RTSP only: optional low-resolution sub-stream shown in the grid tile
+    QJsonObject encoding;  // Per-slot EncodingProfile overrides (empty = use recording.encoding)
+    QJsonObject stream;    // RTSP only: per-slot StreamProfile overrides (empty = follow buffer.minMaintenance)
+    int previewFps = -1;        // Tile display fps (-1 = buffer.displayFps, 0 = every frame)
+    int previewMaxHeight = -1;  // Display-only capture cap (-1 = buffer.previewMaxHeight, 0 = none)
+    double playbackRate = 1.0;  // File only: replay speed (1.0 = native rate)
+    int motion = -1;            // Motion analysis (-1 = motion.enabled or motion-triggered recording, 0 = off, 1 = on)
     
     QJsonObject toJson() const;
     static SlotConfig fromJson(const QJsonObject& obj);
@@ -78,6 +349,84 @@ struct SlotConfig {
     static SourceType stringToSourceType(const QString& str);
 };
 
+/**
+ * @brief Immutable copy of the whole configuration
+ *
+ * Config publishes a new one after every change. Readers on any thread take
+ * it with Config::current() - no Config mutex, and a consistent view for as
+ * long as they keep the pointer, even across a reload.
+ */
+struct ConfigSnapshot {
+    GridConfig grid;
+    BufferConfig buffer;
+    RecordingConfig recording;
+    StartupConfig startup;
+    TelemetryConfig telemetry;
+    ReconnectConfig reconnect;
+    StorageConfig storage;
+    MotionConfig motion;
+    SnapshotConfig snapshot;
+    EgressConfig egress;
+    DecodeConfig decode;
+    ShardingConfig sharding;
+    AnalyticsConfig analytics;
+    MemoryConfig memory;
+    SchedulingConfig scheduling;
+    std::vector<SlotConfig> slots;
+    
+    const SlotConfig& slot(int index) const;
+    
+    // Effective per-slot settings, see the Config methods of the same name
+    EncodingProfile encodingProfile(int slotIndex) const;
+    StreamProfile streamProfile(int slotIndex) const;
+    int previewFps(int slotIndex) const;
+    int previewMaxHeight(int slotIndex) const;
+    bool motionEnabled(int slotIndex) const;
+};
+
+/**
+ * @brief What changed between two configurations (see Config::diff)
+ *
+ * Slots are classified by what it takes to apply their change: a new
+ * source recreates the slot, a changed effective stream/recording/motion
+ * setting restarts its running stream, a display rate change is applied
+ * to the tile in place. Slots that only appear or disappear with the grid
+ * size are left to the regrid.
+ */
+struct ConfigDiff {
+    enum Section {
+        Grid      = 1 << 0,
+        Buffer    = 1 << 1,
+        Recording = 1 << 2,
+        Startup   = 1 << 3,
+        Telemetry = 1 << 4,
+        Reconnect = 1 << 5,
+        Storage   = 1 << 6,
+        Motion    = 1 << 7,
+        Snapshot  = 1 << 8,
+        Egress    = 1 << 9,
+        Decode    = 1 << 10,
+        Slots     = 1 << 11,
+        Sharding  = 1 << 12,
+        Analytics = 1 << 13,
+        Memory    = 1 << 14,
+        Scheduling = 1 << 15
+    };
+    
+    int sections{0};               // Section bits of changed top-level sections
+    QList<int> sourceChanged;      // Type or source changed
+    QList<int> restartNeeded;      // Same source, effective settings changed
+    QList<int> previewChanged;     // Only the tile display rate changed
+    
+    bool has(Section section) const { return (sections & section) != 0; }
+    bool isEmpty() const { return sections == 0; }
+    
+    /**
+     * @brief Names of the changed sections, for logs
+     */
+    QStringList sectionNames() const;
+};
+
 /**
  * @brief Main configuration manager (Singleton)
  */
@@ -93,17 +442,87 @@ public:
     bool load(const QString& path = "config.json");
     bool save(const QString& path = "config.json");
     
+    /**
+     * @brief Re-read the file last loaded (configPath())
+     *
+     * Unlike load(), a file that cannot be read or parsed - e.g. caught
+     * half-written by an editor - leaves the current configuration alone.
+     * Slots changed with setSlot() since the last load or save keep their
+     * in-memory settings unless the file changed that slot too.
+     * @return false if the file was not applied
+     */
+    bool reload();
+    
+    /**
+     * @brief Configuration as of now, safe to read on any thread without locking
+     */
+    std::shared_ptr<const ConfigSnapshot> current() const { return std::atomic_load(&m_current); }
+    
+    /**
+     * @brief Changes needed to go from one configuration to another
+     */
+    static ConfigDiff diff(const ConfigSnapshot& from, const ConfigSnapshot& to);
+    
     // Getters
-    const GridConfig& grid() const { return m_grid; }
-    const BufferConfig& buffer() const { return m_buffer; }
-    const RecordingConfig& recording() const { return m_recording; }
+    const GridConfig& grid() const { return m_values.grid; }
+    const BufferConfig& buffer() const { return m_values.buffer; }
+    const RecordingConfig& recording() const { return m_values.recording; }
+    const StartupConfig& startup() const { return m_values.startup; }
+    const TelemetryConfig& telemetry() const { return m_values.telemetry; }
+    const ReconnectConfig& reconnect() const { return m_values.reconnect; }
+    const StorageConfig& storage() const { return m_values.storage; }
+    const MotionConfig& motion() const { return m_values.motion; }
+    const SnapshotConfig& snapshot() const { return m_values.snapshot; }
+    const EgressConfig& egress() const { return m_values.egress; }
+    const DecodeConfig& decode() const { return m_values.decode; }
+    const ShardingConfig& sharding() const { return m_values.sharding; }
+    const AnalyticsConfig& analytics() const { return m_values.analytics; }
+    const MemoryConfig& memory() const { return m_values.memory; }
+    const SchedulingConfig& scheduling() const { return m_values.scheduling; }
     const SlotConfig& slot(int index) const;
-    int slotCount() const { return static_cast<int>(m_slots.size()); }
+    int slotCount() const { return static_cast<int>(m_values.slots.size()); }
+    
+    /**
+     * @brief Effective encoding profile for a slot (recording default + slot overrides)
+     */
+    EncodingProfile encodingProfile(int slotIndex) const { return current()->encodingProfile(slotIndex); }
+    
+    /**
+     * @brief Effective RTSP playback profile for a slot (latency setting + slot overrides)
+     */
+    StreamProfile streamProfile(int slotIndex) const { return current()->streamProfile(slotIndex); }
+    
+    /**
+     * @brief Effective preview settings for a slot (buffer default + slot overrides)
+     */
+    int previewFps(int slotIndex) const { return current()->previewFps(slotIndex); }
+    int previewMaxHeight(int slotIndex) const { return current()->previewMaxHeight(slotIndex); }
+    
+    /**
+     * @brief Whether a slot runs motion analysis (slot override, else
+     *        motion.enabled, else on when motion triggers event recording)
+     */
+    bool motionEnabled(int slotIndex) const { return current()->motionEnabled(slotIndex); }
     
     // Setters
     void setGrid(const GridConfig& config);
     void setBuffer(const BufferConfig& config);
     void setRecording(const RecordingConfig& config);
+    void setStartup(const StartupConfig& config);
+    void setTelemetry(const TelemetryConfig& config);
+    void setReconnect(const ReconnectConfig& config);
+    void setStorage(const StorageConfig& config);
+    void setMotion(const MotionConfig& config);
+    void setSnapshot(const SnapshotConfig& config);
+    void setEgress(const EgressConfig& config);
+    void setDecode(const DecodeConfig& config);
+    void setSharding(const ShardingConfig& config);
+    void setAnalytics(const AnalyticsConfig& config);
+    void setMemory(const MemoryConfig& config);
+    void setScheduling(const SchedulingConfig& config);
+    /**
+     * @brief Change one slot in memory (written by the next save())
+     */
     void setSlot(int index, const SlotConfig& config);
     
     // Utility
@@ -116,11 +535,21 @@ private:
     
     void initializeDefaults();
     
-    GridConfig m_grid;
-    BufferConfig m_buffer;
-    RecordingConfig m_recording;
-    std::vector<SlotConfig> m_slots;
+    /**
+     * @brief Parse a config file into @p values (untouched on failure)
+     */
+    static bool parseFile(const QString& path, ConfigSnapshot& values);
+    
+    /**
+     * @brief Make m_values visible to current() (call with m_mutex held)
+     */
+    void publishLocked();
+    
+    ConfigSnapshot m_values;
+    std::shared_ptr<const ConfigSnapshot> m_current;
     QString m_configPath;
+    std::vector<SlotConfig> m_savedSlots;   // Slots as last loaded or saved
+    QSet<int> m_unsavedSlots;               // setSlot() since then
     
     mutable QMutex m_mutex;
 };
@@ -0,0 +1,84 @@
+#include "ConfigWatcher.h"
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileSystemWatcher>
+#include <QFileInfo>
+#include <QDebug>
+
+namespace MCM {
+
+ConfigWatcher::ConfigWatcher(QObject* parent)
+    : QObject(parent)
+{
+    m_watcher = new QFileSystemWatcher(this);
+    m_debounce.setSingleShot(true);
+    m_debounce.setInterval(DEBOUNCE_MS);
+    connect(&m_debounce, &QTimer::timeout, this, &ConfigWatcher::checkNow);
+
+    // Files replaced by rename show up as a change of their directory
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, this, [this]() { m_debounce.start(); });
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, [this]() { m_debounce.start(); });
+}
+
+void ConfigWatcher::watch(const QString& path) {
+    if (!m_watcher->files().isEmpty()) {
+        m_watcher->removePaths(m_watcher->files());
+    }
+    if (!m_watcher->directories().isEmpty()) {
+        m_watcher->removePaths(m_watcher->directories());
+    }
+
+    m_path = QFileInfo(path).absoluteFilePath();
+    m_applied = Config::instance().current();
+    m_hash = fileHash();
+    m_watcher->addPath(QFileInfo(m_path).absolutePath());
+    rearm();
+    qDebug() << "ConfigWatcher: Watching" << m_path;
+}
+
+void ConfigWatcher::rearm() {
+    if (!m_watcher->files().contains(m_path) && QFileInfo::exists(m_path)) {
+        m_watcher->addPath(m_path);
+    }
+}
+
+QByteArray ConfigWatcher::fileHash() const {
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return QCryptographicHash::hash(file.readAll(), QCryptographicHash::Sha1);
+}
+
+void ConfigWatcher::checkNow() {
+    rearm();
+    if (m_path.isEmpty() || !QFileInfo::exists(m_path)) {
+        return;
+    }
+
+    // Directory events also fire for neighbouring files: only a change of
+    // config.json's own content is reloaded
+    const QByteArray hash = fileHash();
+    if (hash.isEmpty() || hash == m_hash) {
+        return;
+    }
+    m_hash = hash;
+    if (!Config::instance().reload()) {
+        return;
+    }
+
+    std::shared_ptr<const ConfigSnapshot> now = Config::instance().current();
+    const ConfigDiff diff = Config::diff(*m_applied, *now);
+    m_applied = now;
+    if (diff.isEmpty()) {
+        return;
+    }
+
+    qDebug() << "ConfigWatcher: Changed" << diff.sectionNames().join(", ")
+             << "- sources:" << diff.sourceChanged.size()
+             << "restarts:" << diff.restartNeeded.size()
+             << "preview:" << diff.previewChanged.size();
+    emit configChanged(diff);
+}
+
+} // namespace MCM
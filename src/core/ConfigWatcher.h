@@ -0,0 +1,69 @@
+#ifndef CONFIGWATCHER_H
+#define CONFIGWATCHER_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <memory>
+#include "core/Config.h"
+
+class QFileSystemWatcher;
+
+namespace MCM {
+
+/**
+ * @brief Reloads config.json when it changes on disk
+ *
+ * Events are debounced (editors write in several steps, or replace the file
+ * by renaming a new one over it, which also drops the watch - it is
+ * re-armed on every change). The reloaded configuration is compared with
+ * the one last reported, so saves from the Settings screen come through as
+ * a diff too, and a file rewritten with the same content reports nothing.
+ * Nothing is reloaded unless config.json's own content changed: the watched
+ * directory also reports neighbouring files (telemetry output, recordings).
+ * A file that does not parse is ignored until it is written again.
+ *
+ * Usage:
+ *   ConfigWatcher watcher;
+ *   connect(&watcher, &ConfigWatcher::configChanged, screen, &MonitoringScreen::applyConfigChange);
+ *   watcher.watch(Config::instance().configPath());
+ */
+class ConfigWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ConfigWatcher(QObject* parent = nullptr);
+    ~ConfigWatcher() override = default;
+
+    /**
+     * @brief Start watching @p path (the file Config was loaded from)
+     */
+    void watch(const QString& path);
+
+    /**
+     * @brief Reload now instead of waiting for a file event
+     */
+    void checkNow();
+
+signals:
+    /**
+     * @brief Emitted after a reload that changed something (never for empty diffs)
+     */
+    void configChanged(const ConfigDiff& diff);
+
+private:
+    void rearm();
+    QByteArray fileHash() const;
+
+    static constexpr int DEBOUNCE_MS = 300;
+
+    QFileSystemWatcher* m_watcher{nullptr};
+    QTimer m_debounce;
+    QString m_path;
+    QByteArray m_hash;                                 // config.json's content at the last check
+    std::shared_ptr<const ConfigSnapshot> m_applied;   // Last configuration reported
+};
+
+} // namespace MCM
+
+#endif // CONFIGWATCHER_H
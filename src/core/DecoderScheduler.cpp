@@ -0,0 +1,311 @@
+#include "DecoderScheduler.h"
+#include <QMutexLocker>
+#include <QMap>
+#include <QVideoFrame>
+#include <QDebug>
+#include <algorithm>
+
+extern "C" {
+#include <libavutil/hwcontext.h>
+#include <libavutil/buffer.h>
+#include <libavutil/error.h>
+}
+
+namespace MCM {
+
+namespace {
+
+// FFmpeg device type behind each engine (NVDEC is reached through CUDA)
+const char* ffmpegDeviceType(DecoderScheduler::Path path) {
+    switch (path) {
+    case DecoderScheduler::Path::Vaapi: return "vaapi";
+    case DecoderScheduler::Path::Nvdec: return "cuda";
+    case DecoderScheduler::Path::VideoToolbox: return "videotoolbox";
+    default: return nullptr;
+    }
+}
+
+QList<DecoderScheduler::Path> platformEngines() {
+#if defined(Q_OS_DARWIN)
+    return {DecoderScheduler::Path::VideoToolbox};
+#elif defined(Q_OS_LINUX)
+    return {DecoderScheduler::Path::Vaapi, DecoderScheduler::Path::Nvdec};
+#else
+    return {DecoderScheduler::Path::Nvdec};
+#endif
+}
+
+bool isHardware(DecoderScheduler::Path path) {
+    return path != DecoderScheduler::Path::Unknown && path != DecoderScheduler::Path::Software;
+}
+
+constexpr const char* DEVICE_TYPES_ENV = "QT_FFMPEG_DECODING_HW_DEVICE_TYPES";
+
+} // namespace
+
+DecoderScheduler& DecoderScheduler::instance() {
+    static DecoderScheduler instance;
+    return instance;
+}
+
+const char* DecoderScheduler::pathName(Path path) {
+    switch (path) {
+    case Path::Software: return "software";
+    case Path::Hardware: return "hardware";
+    case Path::Vaapi: return "vaapi";
+    case Path::Nvdec: return "nvdec";
+    case Path::VideoToolbox: return "videotoolbox";
+    case Path::Unknown: break;
+    }
+    return "unknown";
+}
+
+DecoderScheduler::Path DecoderScheduler::pathFromName(const QString& name) {
+    const QString lower = name.toLower();
+    if (lower == "vaapi") return Path::Vaapi;
+    if (lower == "nvdec") return Path::Nvdec;
+    if (lower == "videotoolbox") return Path::VideoToolbox;
+    if (lower == "software") return Path::Software;
+    return Path::Unknown;
+}
+
+bool DecoderScheduler::isHardwareFrame(const QVideoFrame& frame) {
+    // GPU-resident frames only come from hardware decoders
+    if (frame.handleType() != QVideoFrame::NoHandle) {
+        return true;
+    }
+    // Downloaded hardware frames keep the decoder's semi-planar layout;
+    // FFmpeg's software H.264/HEVC decoders produce planar YUV
+    switch (frame.pixelFormat()) {
+    case QVideoFrameFormat::Format_NV12:
+    case QVideoFrameFormat::Format_P010:
+    case QVideoFrameFormat::Format_P016:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void DecoderScheduler::configure(const DecodeConfig& config, const QList<QString>& requests) {
+    QMutexLocker locker(&m_mutex);
+    m_config = config;
+    probeLocked();
+
+    // Explicit engines first - the global setting, then the slots' by popularity
+    QList<QString> all{config.acceleration};
+    all += requests;
+    QMap<Path, int> votes;
+    bool wantsAuto = false;
+    bool wantsHardware = false;
+    for (const QString& request : std::as_const(all)) {
+        const Path path = pathFromName(request);
+        if (path == Path::Software) {
+            continue;
+        }
+        wantsHardware = true;
+        if (path == Path::Unknown) {
+            wantsAuto = true;
+        } else {
+            votes[path] += request.toLower() == config.acceleration ? 1000 : 1;
+        }
+    }
+
+    QList<Path> order = votes.keys();
+    std::sort(order.begin(), order.end(), [&votes](Path a, Path b) { return votes.value(a) > votes.value(b); });
+    for (const Path path : QList<Path>(order)) {
+        if (!engineAvailableLocked(path)) {
+            qWarning() << "DecoderScheduler:" << pathName(path) << "decoding requested but not available on this machine";
+            order.removeAll(path);
+        }
+    }
+    const bool explicitOnly = !wantsAuto && !votes.isEmpty();
+
+    m_userDeviceList = !m_deviceOrderSet && qEnvironmentVariableIsSet(DEVICE_TYPES_ENV);
+    m_softwareOnly = !wantsHardware || (explicitOnly && order.isEmpty());
+    if (wantsAuto) {
+        // "auto" may use any engine that opened here, after the explicit ones
+        for (const Engine& engine : std::as_const(m_engines)) {
+            if (engine.available && !order.contains(engine.path)) {
+                order.append(engine.path);
+            }
+        }
+    }
+    m_deviceOrder = m_softwareOnly ? QList<Path>() : order;
+
+    if (m_userDeviceList) {
+        qDebug() << "DecoderScheduler: Keeping" << DEVICE_TYPES_ENV << "=" << qgetenv(DEVICE_TYPES_ENV);
+    } else if (m_softwareOnly || explicitOnly) {
+        // An empty list means software only; with "auto" everywhere Qt keeps its own order
+        QByteArrayList names;
+        for (const Path path : std::as_const(m_deviceOrder)) {
+            names.append(ffmpegDeviceType(path));
+        }
+        qputenv(DEVICE_TYPES_ENV, names.join(','));
+        m_deviceOrderSet = true;
+    }
+
+    QStringList orderNames;
+    for (const Path path : std::as_const(m_deviceOrder)) {
+        orderNames.append(pathName(path));
+    }
+    qDebug() << "DecoderScheduler: Decode" << (m_softwareOnly ? QString("in software") : orderNames.join(", "));
+#if QT_VERSION < QT_VERSION_CHECK(6, 7, 0)
+    qDebug() << "DecoderScheduler: Qt" << QT_VERSION_STR << "ignores the device order; paths are still verified";
+#endif
+
+    for (Claim& claim : m_claims) {
+        if (claim.detected == Path::Unknown) {
+            claim.expected = expectedLocked();
+        }
+    }
+}
+
+QList<DecoderScheduler::Engine> DecoderScheduler::engines() const {
+    QMutexLocker locker(&m_mutex);
+    return m_engines;
+}
+
+DecoderScheduler::Path DecoderScheduler::processEngine() const {
+    QMutexLocker locker(&m_mutex);
+    return processEngineLocked();
+}
+
+DecoderScheduler::Path DecoderScheduler::processEngineLocked() const {
+    if (m_userDeviceList) {
+        return Path::Hardware;  // The user's list: hardware, engine not known here
+    }
+    if (m_softwareOnly) {
+        return Path::Software;
+    }
+    if (m_deviceOrder.isEmpty()) {
+        return Path::Hardware;  // Qt's own order found nothing we probe, but may find others
+    }
+    // Our list is tried in order; Qt's own order only tells us the engine if one exists
+    return m_deviceOrder.size() == 1 || m_deviceOrderSet ? m_deviceOrder.first() : Path::Hardware;
+}
+
+DecoderScheduler::Path DecoderScheduler::acquire(const QObject* stream, int slotId, const QString& requested) {
+    QMutexLocker locker(&m_mutex);
+    probeLocked();
+
+    Claim& claim = m_claims[stream];
+    claim.slotId = slotId;
+    claim.requested = requested;
+    claim.detected = Path::Unknown;  // New stream, verified again on its first frame
+    claim.warned = false;
+
+    const Path wanted = pathFromName(requested);
+    if (isHardware(wanted) && !engineAvailableLocked(wanted)) {
+        qWarning() << "DecoderScheduler: Slot" << slotId << "asks for" << pathName(wanted)
+                   << "decoding, which is not available here";
+    }
+    claim.expected = expectedLocked();
+    if (wanted == Path::Software && isHardware(claim.expected)) {
+        // One device order per process: software for one player is not possible
+        qDebug() << "DecoderScheduler: Slot" << slotId
+                 << "asks for software decoding, but the process decodes on" << pathName(claim.expected);
+    }
+
+    qDebug() << "DecoderScheduler: Slot" << slotId << "decode" << requested << "-> expected" << pathName(claim.expected);
+    return claim.expected;
+}
+
+void DecoderScheduler::release(const QObject* stream) {
+    QMutexLocker locker(&m_mutex);
+    m_claims.remove(stream);
+}
+
+DecoderScheduler::Path DecoderScheduler::reportFrame(const QObject* stream, const QVideoFrame& frame) {
+    const bool hardware = isHardwareFrame(frame);
+
+    QMutexLocker locker(&m_mutex);
+    const Path engine = processEngineLocked();
+    auto it = m_claims.find(stream);
+    if (it == m_claims.end()) {
+        return Path::Unknown;
+    }
+    Claim& claim = it.value();
+    claim.detected = hardware ? (isHardware(engine) ? engine : Path::Hardware) : Path::Software;
+
+    if (!claim.warned && isHardware(claim.expected) && !hardware) {
+        claim.warned = true;
+        qWarning() << "DecoderScheduler: Slot" << claim.slotId << "is decoding in SOFTWARE although"
+                   << pathName(claim.expected) << "was expected (frame format" << frame.pixelFormat()
+                   << ") - check the GPU driver and the stream's codec/profile";
+    } else {
+        qDebug() << "DecoderScheduler: Slot" << claim.slotId << "decodes on" << pathName(claim.detected);
+    }
+    return claim.detected;
+}
+
+DecoderScheduler::Path DecoderScheduler::activePath(const QObject* stream) const {
+    QMutexLocker locker(&m_mutex);
+    const auto it = m_claims.constFind(stream);
+    if (it == m_claims.constEnd()) {
+        return Path::Unknown;
+    }
+    return it->detected != Path::Unknown ? it->detected : it->expected;
+}
+
+int DecoderScheduler::hardwareStreams() const {
+    QMutexLocker locker(&m_mutex);
+    return static_cast<int>(std::count_if(m_claims.cbegin(), m_claims.cend(),
+                                          [](const Claim& claim) { return isHardware(claim.detected); }));
+}
+
+int DecoderScheduler::fallbackStreams() const {
+    QMutexLocker locker(&m_mutex);
+    return static_cast<int>(std::count_if(m_claims.cbegin(), m_claims.cend(), [](const Claim& claim) {
+        return isHardware(claim.expected) && claim.detected == Path::Software;
+    }));
+}
+
+void DecoderScheduler::probeLocked() {
+    if (m_probed) {
+        return;
+    }
+    m_probed = true;
+
+    // Opening the device once is the only reliable check (driver, permissions, GPU present)
+    for (const Path path : platformEngines()) {
+        Engine engine;
+        engine.path = path;
+        const AVHWDeviceType type = av_hwdevice_find_type_by_name(ffmpegDeviceType(path));
+        if (type == AV_HWDEVICE_TYPE_NONE) {
+            engine.detail = "not built into FFmpeg";
+        } else {
+            AVBufferRef* device = nullptr;
+            const int ret = av_hwdevice_ctx_create(&device, type, nullptr, nullptr, 0);
+            if (ret >= 0) {
+                engine.available = true;
+                av_buffer_unref(&device);
+            } else {
+                char buffer[AV_ERROR_MAX_STRING_SIZE] = {0};
+                av_strerror(ret, buffer, sizeof(buffer));
+                engine.detail = QString::fromUtf8(buffer);
+            }
+        }
+        qDebug() << "DecoderScheduler:" << pathName(path)
+                 << (engine.available ? QString("available") : "unavailable (" + engine.detail + ")");
+        m_engines.append(engine);
+    }
+}
+
+bool DecoderScheduler::engineAvailableLocked(Path path) const {
+    for (const Engine& engine : m_engines) {
+        if (engine.path == path) {
+            return engine.available;
+        }
+    }
+    return false;
+}
+
+DecoderScheduler::Path DecoderScheduler::expectedLocked() const {
+    if (!m_userDeviceList && m_deviceOrder.isEmpty()) {
+        return Path::Software;
+    }
+    // Every player takes the first engine of the process order that opens
+    return processEngineLocked();
+}
+
+} // namespace MCM
@@ -0,0 +1,158 @@
+#ifndef DECODERSCHEDULER_H
+#define DECODERSCHEDULER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include "core/Config.h"
+
+class QVideoFrame;
+
+namespace MCM {
+
+/**
+ * @brief Hardware decode engine selection and verification (Singleton)
+ *
+ * Players decode through Qt's FFmpeg backend, which tries its list of
+ * hardware device types in order and falls back to software without
+ * saying so. This makes the choice explicit and checks it:
+ *
+ * - configure() probes which engines this machine actually has (VA-API,
+ *   NVDEC via CUDA, VideoToolbox) by opening each once, and hands the
+ *   backend the device order derived from decode.acceleration and the
+ *   slots' stream.decode overrides (QT_FFMPEG_DECODING_HW_DEVICE_TYPES,
+ *   read by Qt 6.7+ when the first player opens). An explicit engine that
+ *   is missing is dropped from the list instead of silently trying others.
+ * - acquire() gives each stream its expected path: the process's first
+ *   engine, or software when the process decodes in software only.
+ * - reportFrame() classifies the first frame of a stream - GPU handle or
+ *   the NV12/P010 layout hardware decoders produce (software H.264/HEVC
+ *   decodes to planar YUV) - and warns once when a stream meant for
+ *   hardware is decoded in software.
+ *
+ * The backend picks one device order per process; within it each player
+ * takes the first engine that opens. Per-slot settings therefore only shape
+ * that order; they cannot pin a single player to an engine or to software
+ * (with sharding.workers each worker process has its own order).
+ *
+ * Usage:
+ *   DecoderScheduler::instance().configure(config.decode(), requests);   // main(), before players
+ *   scheduler.acquire(this, slotId, profile.decode);                    // start
+ *   scheduler.reportFrame(this, firstFrame);                            // first frame
+ *   scheduler.release(this);                                            // stop
+ */
+class DecoderScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    enum class Path {
+        Unknown,       // No frame yet
+        Software,
+        Hardware,      // Hardware frames from an engine not probed here (e.g. user device list)
+        Vaapi,
+        Nvdec,
+        VideoToolbox
+    };
+
+    struct Engine {
+        Path path{Path::Unknown};
+        bool available{false};
+        QString detail;            // Why it is unavailable
+    };
+
+    static DecoderScheduler& instance();
+
+    // Prevent copying
+    DecoderScheduler(const DecoderScheduler&) = delete;
+    DecoderScheduler& operator=(const DecoderScheduler&) = delete;
+
+    /**
+     * @brief Short name ("vaapi", "software", ...); static storage, safe to keep
+     */
+    static const char* pathName(Path path);
+
+    /**
+     * @brief Engine of a decode setting; "auto" and "software" map to Unknown / Software
+     */
+    static Path pathFromName(const QString& name);
+
+    /**
+     * @brief Whether frames look like the output of a hardware decoder
+     */
+    static bool isHardwareFrame(const QVideoFrame& frame);
+
+    /**
+     * @brief Probe engines and set the backend's device order (call before any player opens)
+     * @param requests Decode settings of the slots that use players (stream.decode)
+     */
+    void configure(const DecodeConfig& config, const QList<QString>& requests);
+
+    QList<Engine> engines() const;
+
+    /**
+     * @brief Engine the backend tries first; Software if it was told to decode in software
+     */
+    Path processEngine() const;
+
+    /**
+     * @brief Register a starting stream
+     * @param stream Owner of the claim (one per player; a slot may have several)
+     * @param requested stream.decode of the slot
+     * @return Path the stream is expected to decode on
+     */
+    Path acquire(const QObject* stream, int slotId, const QString& requested);
+
+    /**
+     * @brief Unregister a stream
+     */
+    void release(const QObject* stream);
+
+    /**
+     * @brief Record the path seen on the stream's first frame; returns it
+     */
+    Path reportFrame(const QObject* stream, const QVideoFrame& frame);
+
+    /**
+     * @brief Detected path of a stream, else its expected path while no frame arrived
+     */
+    Path activePath(const QObject* stream) const;
+
+    /**
+     * @brief Streams detected on hardware / expected on hardware but found in software
+     */
+    int hardwareStreams() const;
+    int fallbackStreams() const;
+
+private:
+    DecoderScheduler() = default;
+    ~DecoderScheduler() override = default;
+
+    struct Claim {
+        int slotId{-1};
+        QString requested;
+        Path expected{Path::Unknown};
+        Path detected{Path::Unknown};
+        bool warned{false};
+    };
+
+    void probeLocked();
+    bool engineAvailableLocked(Path path) const;
+    Path processEngineLocked() const;
+    Path expectedLocked() const;
+
+    mutable QMutex m_mutex;
+    QList<Engine> m_engines;
+    bool m_probed{false};
+    DecodeConfig m_config;
+    QList<Path> m_deviceOrder;         // Engines handed to the backend, in order
+    bool m_softwareOnly{false};
+    bool m_userDeviceList{false};      // QT_FFMPEG_DECODING_HW_DEVICE_TYPES set by the user
+    bool m_deviceOrderSet{false};      // ... set by configure()
+    QHash<const QObject*, Claim> m_claims;
+};
+
+} // namespace MCM
+
+#endif // DECODERSCHEDULER_H
@@ -0,0 +1,213 @@
+#include "EncoderScheduler.h"
+#include <QMutexLocker>
+#include <QDebug>
+#include <algorithm>
+#include <limits>
+
+namespace MCM {
+
+EncoderScheduler& EncoderScheduler::instance() {
+    static EncoderScheduler instance;
+    return instance;
+}
+
+EncoderScheduler::EncoderScheduler()
+    : m_budget(DEFAULT_BUDGET)
+{
+}
+
+void EncoderScheduler::setHardwareSessionBudget(int sessions) {
+    QList<int> changed;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_budget = sessions == 0 ? DEFAULT_BUDGET : sessions;
+        qDebug() << "EncoderScheduler: Hardware session budget"
+                 << (m_budget < 0 ? QString("unlimited") : QString::number(m_budget));
+        changed = rebalanceLocked();
+    }
+    notifyChanges(changed);
+}
+
+int EncoderScheduler::hardwareSessionBudget() const {
+    QMutexLocker locker(&m_mutex);
+    return m_budget;
+}
+
+bool EncoderScheduler::acquire(int slotId, int priority) {
+    QList<int> changed;
+    bool granted = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_claims.find(slotId);
+        if (it == m_claims.end()) {
+            Claim claim;
+            claim.priority = priority;
+            claim.order = m_nextOrder++;
+            it = m_claims.insert(slotId, claim);
+        } else {
+            it->priority = priority;
+        }
+
+        changed = rebalanceLocked();
+        granted = m_claims.value(slotId).hardware;
+        changed.removeAll(slotId);  // Caller gets its answer directly
+    }
+    notifyChanges(changed);
+
+    qDebug() << "EncoderScheduler: Slot" << slotId << "priority" << priority
+             << (granted ? "-> hardware" : "-> software");
+    return granted;
+}
+
+void EncoderScheduler::release(int slotId) {
+    QList<int> changed;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_claims.remove(slotId) == 0) {
+            return;
+        }
+        if (m_overlapSlot == slotId) {
+            m_overlapSlot = -1;
+        }
+        changed = rebalanceLocked();
+    }
+    notifyChanges(changed);
+}
+
+bool EncoderScheduler::hasHardware(int slotId) const {
+    QMutexLocker locker(&m_mutex);
+    return m_claims.value(slotId).hardware;
+}
+
+void EncoderScheduler::reportHardwareFailure(int slotId) {
+    QList<int> changed;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_claims.find(slotId);
+        if (it == m_claims.end() || it->failed) {
+            return;
+        }
+
+        // Everything that was running besides the failing session is what the
+        // device actually supports
+        int working = 0;
+        for (auto c = m_claims.cbegin(); c != m_claims.cend(); ++c) {
+            if (c.value().hardware && c.key() != slotId) {
+                working++;
+            }
+        }
+        if (m_overlapSlot >= 0 && m_overlapSlot != slotId) {
+            working++;
+        }
+
+        if (m_budget < 0 || working < m_budget) {
+            qWarning() << "EncoderScheduler: Hardware encoder failed for slot" << slotId
+                       << "- limiting budget to" << working << "sessions";
+            m_budget = working;
+        }
+
+        it->failed = true;
+        changed = rebalanceLocked();
+        changed.removeAll(slotId);  // The failing recorder already knows
+    }
+    notifyChanges(changed);
+}
+
+bool EncoderScheduler::beginOverlap(int slotId) {
+    QMutexLocker locker(&m_mutex);
+    if (m_budget < 0) {
+        return true;  // No cap to protect
+    }
+    if (m_budget < 2) {
+        return false;  // No spare session - rotation must be sequential
+    }
+    if (m_overlapSlot >= 0 && m_overlapSlot != slotId) {
+        return false;  // Another slot is rotating
+    }
+    m_overlapSlot = slotId;
+    return true;
+}
+
+bool EncoderScheduler::overlapPossible() const {
+    QMutexLocker locker(&m_mutex);
+    return m_budget < 0 || m_budget >= 2;
+}
+
+void EncoderScheduler::endOverlap(int slotId) {
+    QMutexLocker locker(&m_mutex);
+    if (m_overlapSlot == slotId) {
+        m_overlapSlot = -1;
+    }
+}
+
+int EncoderScheduler::hardwareSessionsInUse() const {
+    QMutexLocker locker(&m_mutex);
+    int count = m_overlapSlot >= 0 ? 1 : 0;
+    for (const Claim& claim : m_claims) {
+        if (claim.hardware) {
+            count++;
+        }
+    }
+    return count;
+}
+
+int EncoderScheduler::grantLimitLocked() const {
+    if (m_budget < 0) {
+        return std::numeric_limits<int>::max();
+    }
+    // Keep one session back for rotation overlap when the budget allows it
+    return m_budget >= 2 ? m_budget - 1 : m_budget;
+}
+
+QList<int> EncoderScheduler::rebalanceLocked() {
+    QList<int> order;
+    for (auto it = m_claims.cbegin(); it != m_claims.cend(); ++it) {
+        if (!it.value().failed) {
+            order.append(it.key());
+        }
+    }
+
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        const Claim ca = m_claims.value(a);
+        const Claim cb = m_claims.value(b);
+        if (ca.priority != cb.priority) {
+            return ca.priority > cb.priority;
+        }
+        return ca.order < cb.order;
+    });
+
+    const int limit = grantLimitLocked();
+    QList<int> changed;
+    int granted = 0;
+
+    for (auto it = m_claims.begin(); it != m_claims.end(); ++it) {
+        if (it->failed && it->hardware) {
+            it->hardware = false;
+            changed.append(it.key());
+        }
+    }
+
+    for (int slotId : order) {
+        Claim& claim = m_claims[slotId];
+        const bool hardware = granted < limit;
+        if (hardware) {
+            granted++;
+        }
+        if (claim.hardware != hardware) {
+            claim.hardware = hardware;
+            changed.append(slotId);
+        }
+    }
+    return changed;
+}
+
+void EncoderScheduler::notifyChanges(const QList<int>& changed) {
+    // Emitted outside the lock - receivers may call back into the scheduler
+    for (int slotId : changed) {
+        const bool hardware = hasHardware(slotId);
+        qDebug() << "EncoderScheduler: Slot" << slotId << (hardware ? "granted" : "moved to software");
+        emit grantChanged(slotId, hardware);
+    }
+}
+
+} // namespace MCM
@@ -0,0 +1,126 @@
+#ifndef ENCODERSCHEDULER_H
+#define ENCODERSCHEDULER_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+
+namespace MCM {
+
+/**
+ * @brief Process-wide hardware encoder session budget (Singleton)
+ *
+ * Some drivers (NVENC on consumer GPUs) cap concurrent encode sessions.
+ * Instead of letting recorders fail one by one and fall back afterwards,
+ * recorders claim a session through this scheduler: the highest-priority
+ * claims get hardware, the rest are told to use software up front.
+ *
+ * One session of the budget is held back for chunk rotation. A recorder
+ * swapping A/B hardware encoders must hold the overlap token, so at most
+ * one extra session exists at any time (rotations are serialized).
+ *
+ * Usage:
+ *   bool hw = EncoderScheduler::instance().acquire(slotId, priority);
+ *   ...
+ *   if (EncoderScheduler::instance().beginOverlap(slotId)) { swap; ... endOverlap(slotId); }
+ *   EncoderScheduler::instance().release(slotId);
+ */
+class EncoderScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    static EncoderScheduler& instance();
+
+    // Prevent copying
+    EncoderScheduler(const EncoderScheduler&) = delete;
+    EncoderScheduler& operator=(const EncoderScheduler&) = delete;
+
+    /**
+     * @brief Set the number of concurrent hardware sessions
+     * @param sessions Session count, 0 = default (unlimited until a session is refused), <0 = unlimited
+     */
+    void setHardwareSessionBudget(int sessions);
+    int hardwareSessionBudget() const;
+
+    /**
+     * @brief Register a recorder and ask for a hardware session
+     * @param slotId Slot owning the recorder
+     * @param priority Higher wins; equal priorities are first come, first served
+     * @return true if the slot should use a hardware encoder
+     */
+    bool acquire(int slotId, int priority = 0);
+
+    /**
+     * @brief Unregister a recorder (its session goes to the next claim)
+     */
+    void release(int slotId);
+
+    /**
+     * @brief Check whether a slot currently holds a hardware session
+     */
+    bool hasHardware(int slotId) const;
+
+    /**
+     * @brief Hardware encoder failed to start for this slot
+     *
+     * Treats the failure as the real device limit: the budget shrinks to the
+     * sessions that were working, and the slot is moved to software.
+     */
+    void reportHardwareFailure(int slotId);
+
+    /**
+     * @brief Take the rotation token (one transient extra hardware session)
+     * @return false if another slot is rotating - retry shortly
+     */
+    bool beginOverlap(int slotId);
+    void endOverlap(int slotId);
+
+    /**
+     * @brief false when the budget has no spare session (rotate stop-then-start)
+     */
+    bool overlapPossible() const;
+
+    /**
+     * @brief Hardware sessions currently granted (including a rotation overlap)
+     */
+    int hardwareSessionsInUse() const;
+
+signals:
+    /**
+     * @brief A slot gained or lost its hardware session (applies at its next chunk)
+     */
+    void grantChanged(int slotId, bool hardware);
+
+private:
+    EncoderScheduler();
+    ~EncoderScheduler() override = default;
+
+    struct Claim {
+        int priority{0};
+        quint64 order{0};        // Arrival order, tie-breaker
+        bool hardware{false};
+        bool failed{false};      // Hardware failed - software only from now on
+    };
+
+    /**
+     * @brief Hand out grants by priority; returns slots whose grant changed
+     */
+    QList<int> rebalanceLocked();
+    int grantLimitLocked() const;
+    void notifyChanges(const QList<int>& changed);
+
+    mutable QMutex m_mutex;
+    QHash<int, Claim> m_claims;
+    int m_budget{-1};            // <0 = unlimited
+    int m_overlapSlot{-1};       // Slot holding the rotation token
+    quint64 m_nextOrder{0};
+
+    // No fixed cap: session limits differ by driver and GPU (VA-API has none,
+    // NVENC's changed over driver releases), so the limit is learned from the
+    // first refused session (reportHardwareFailure)
+    static constexpr int DEFAULT_BUDGET = -1;
+};
+
+} // namespace MCM
+
+#endif // ENCODERSCHEDULER_H
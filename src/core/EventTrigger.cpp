@@ -0,0 +1,43 @@
+#include "EventTrigger.h"
+#include "Config.h"
+#include <QMutexLocker>
+#include <QDebug>
+
+namespace MCM {
+
+EventTrigger& EventTrigger::instance() {
+    static EventTrigger instance;
+    return instance;
+}
+
+EventTrigger::EventTrigger()
+    : QObject(nullptr)
+{
+    m_clock.start();
+}
+
+void EventTrigger::trigger(int slotId, const QString& reason) {
+    qDebug() << "EventTrigger: Slot" << slotId << "triggered:" << reason;
+    emit triggered(slotId, reason);
+}
+
+void EventTrigger::reportMotion(int slotId, double score) {
+    // Called per analysed frame on the analysis thread: read the published snapshot
+    const double threshold = Config::instance().current()->recording.event.motionThreshold;
+    if (threshold <= 0.0 || score < threshold) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        const qint64 now = m_clock.elapsed();
+        auto it = m_lastMotionMs.find(slotId);
+        if (it != m_lastMotionMs.end() && now - it.value() < MOTION_RETRIGGER_MS) {
+            return;
+        }
+        m_lastMotionMs.insert(slotId, now);
+    }
+    emit triggered(slotId, QStringLiteral("motion"));
+}
+
+} // namespace MCM
@@ -0,0 +1,67 @@
+#ifndef EVENTTRIGGER_H
+#define EVENTTRIGGER_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QString>
+
+namespace MCM {
+
+/**
+ * @brief Entry point for recording triggers (Singleton)
+ *
+ * In event recording mode (recording.mode = "event") slots only write
+ * chunks around triggers. Triggers come from the UI, from integrations
+ * (alarm inputs, door contacts) calling trigger(), and from motion
+ * analytics reporting a score per frame. Each slot listens for its own id.
+ *
+ * Thread-safe; triggered() is delivered to receivers on their own thread.
+ *
+ * Usage:
+ *   EventTrigger::instance().trigger(slotId, "alarm-input-2");
+ *   EventTrigger::instance().reportMotion(slotId, score);   // e.g. per analysed frame
+ */
+class EventTrigger : public QObject {
+    Q_OBJECT
+
+public:
+    static EventTrigger& instance();
+
+    // Prevent copying
+    EventTrigger(const EventTrigger&) = delete;
+    EventTrigger& operator=(const EventTrigger&) = delete;
+
+    /**
+     * @brief Fire a trigger for a slot (-1 = every slot)
+     */
+    void trigger(int slotId, const QString& reason);
+
+    /**
+     * @brief Report a motion score in [0, 1]
+     *
+     * Fires a "motion" trigger when the score reaches
+     * recording.event.motionThreshold (0 = motion never triggers). Repeated
+     * motion re-triggers at most once per MOTION_RETRIGGER_MS per slot,
+     * which is plenty to keep extending the post-roll.
+     */
+    void reportMotion(int slotId, double score);
+
+signals:
+    void triggered(int slotId, const QString& reason);
+
+private:
+    EventTrigger();
+    ~EventTrigger() override = default;
+
+    QMutex m_mutex;
+    QHash<int, qint64> m_lastMotionMs;  // Per slot, on m_clock
+    QElapsedTimer m_clock;
+
+    static constexpr qint64 MOTION_RETRIGGER_MS = 1000;
+};
+
+} // namespace MCM
+
+#endif // EVENTTRIGGER_H
@@ -0,0 +1,213 @@
+#include "Fmp4Segmenter.h"
+#include <QDebug>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/error.h>
+#include <libavutil/mathematics.h>
+#include <libavutil/mem.h>
+}
+
+namespace MCM {
+
+namespace {
+
+QString ffmpegError(int code) {
+    char buffer[AV_ERROR_MAX_STRING_SIZE] = {0};
+    av_strerror(code, buffer, sizeof(buffer));
+    return QString::fromUtf8(buffer);
+}
+
+} // namespace
+
+/**
+ * @brief AVIOContext write callback: appends muxer output to the pending fragment
+ */
+struct Fmp4SegmenterIo {
+#if LIBAVFORMAT_VERSION_MAJOR >= 61
+    static int write(void* opaque, const uint8_t* buffer, int size) {
+#else
+    static int write(void* opaque, uint8_t* buffer, int size) {
+#endif
+        auto* segmenter = static_cast<Fmp4Segmenter*>(opaque);
+        segmenter->m_output.append(reinterpret_cast<const char*>(buffer), size);
+        return size;
+    }
+};
+
+Fmp4Segmenter::Fmp4Segmenter(FragmentHandler handler)
+    : m_handler(std::move(handler))
+{
+}
+
+Fmp4Segmenter::~Fmp4Segmenter() {
+    close();
+}
+
+bool Fmp4Segmenter::open(const AVCodecParameters* codecpar, AVRational inputTimeBase, int fragmentMs,
+                         QString* error) {
+    close();
+
+    int ret = avformat_alloc_output_context2(&m_context, nullptr, "mp4", nullptr);
+    if (ret < 0 || !m_context) {
+        if (error) *error = QString("Cannot create MP4 muxer: %1").arg(ffmpegError(ret));
+        m_context = nullptr;
+        return false;
+    }
+
+    m_stream = avformat_new_stream(m_context, nullptr);
+    if (!m_stream) {
+        if (error) *error = "Cannot create output stream";
+        close();
+        return false;
+    }
+
+    ret = avcodec_parameters_copy(m_stream->codecpar, codecpar);
+    if (ret < 0) {
+        if (error) *error = QString("Cannot copy codec parameters: %1").arg(ffmpegError(ret));
+        close();
+        return false;
+    }
+    m_stream->codecpar->codec_tag = 0;
+    m_stream->time_base = inputTimeBase;
+    m_inputTimeBase = inputTimeBase;
+    m_fragmentTicks = av_rescale_q(qMax(fragmentMs, 1), AVRational{1, 1000}, inputTimeBase);
+
+    auto* buffer = static_cast<uint8_t*>(av_malloc(IO_BUFFER_SIZE));
+    m_context->pb = buffer
+        ? avio_alloc_context(buffer, IO_BUFFER_SIZE, 1, this, nullptr, &Fmp4SegmenterIo::write, nullptr)
+        : nullptr;
+    if (!m_context->pb) {
+        av_free(buffer);
+        if (error) *error = "Out of memory";
+        close();
+        return false;
+    }
+    m_context->flags |= AVFMT_FLAG_CUSTOM_IO;
+
+    // Empty moov up front, fragments cut only where write() decides
+    AVDictionary* options = nullptr;
+    av_dict_set(&options, "movflags", "empty_moov+default_base_moof+frag_custom", 0);
+    m_output.clear();
+    ret = avformat_write_header(m_context, &options);
+    av_dict_free(&options);
+    if (ret < 0) {
+        if (error) *error = QString("Cannot write MP4 header: %1").arg(ffmpegError(ret));
+        close();
+        return false;
+    }
+    avio_flush(m_context->pb);
+
+    m_init = m_output;
+    m_output = QByteArray();
+    m_firstTimestamp = INT64_MIN;
+    m_lastDts = INT64_MIN;
+    m_fragmentPackets = 0;
+    m_fragmentsWritten = 0;
+    return true;
+}
+
+bool Fmp4Segmenter::write(const AVPacket* packet, QString* error) {
+    if (!m_context || !packet) {
+        return false;
+    }
+
+    const bool keyframe = (packet->flags & AV_PKT_FLAG_KEY) != 0;
+    if (m_firstTimestamp == INT64_MIN && !keyframe) {
+        return true;  // Nothing decodable before the first keyframe
+    }
+
+    AVPacket* out = av_packet_clone(packet);  // Shares the payload buffer (refcounted)
+    if (!out) {
+        if (error) *error = "Out of memory";
+        return false;
+    }
+
+    // Same rebasing as Mp4ChunkWriter: start at t=0, strictly increasing DTS
+    if (m_firstTimestamp == INT64_MIN) {
+        m_firstTimestamp = out->dts != AV_NOPTS_VALUE ? out->dts : out->pts;
+        if (m_firstTimestamp == AV_NOPTS_VALUE) {
+            m_firstTimestamp = 0;
+        }
+    }
+
+    int64_t dts = out->dts != AV_NOPTS_VALUE ? out->dts - m_firstTimestamp : m_lastDts + 1;
+    int64_t pts = out->pts != AV_NOPTS_VALUE ? out->pts - m_firstTimestamp : dts;
+    if (m_lastDts != INT64_MIN && dts <= m_lastDts) {
+        dts = m_lastDts + 1;
+    }
+    if (pts < dts) {
+        pts = dts;
+    }
+    m_lastDts = dts;
+
+    // Cut before a keyframe so every keyframe fragment is a join point
+    if (m_fragmentPackets > 0 && (keyframe || dts - m_fragmentStartDts >= m_fragmentTicks)) {
+        flushFragment();
+    }
+    if (m_fragmentPackets == 0) {
+        m_fragmentStartDts = dts;
+        m_fragmentKeyframe = keyframe;
+    }
+
+    out->dts = av_rescale_q(dts, m_inputTimeBase, m_stream->time_base);
+    out->pts = av_rescale_q(pts, m_inputTimeBase, m_stream->time_base);
+    out->duration = av_rescale_q(out->duration, m_inputTimeBase, m_stream->time_base);
+    out->stream_index = m_stream->index;
+    out->pos = -1;
+
+    // Single stream: no interleaving needed, and av_write_frame() keeps fragment cuts exact
+    const int ret = av_write_frame(m_context, out);
+    av_packet_free(&out);
+    if (ret < 0) {
+        if (error) *error = QString("Write failed: %1").arg(ffmpegError(ret));
+        return false;
+    }
+    m_fragmentPackets++;
+    return true;
+}
+
+void Fmp4Segmenter::flushFragment() {
+    // With frag_custom a null packet writes the buffered samples as one moof + mdat
+    av_write_frame(m_context, nullptr);
+    avio_flush(m_context->pb);
+    m_fragmentPackets = 0;
+    if (m_output.isEmpty()) {
+        return;
+    }
+
+    // Hand over the buffer and start a fresh one, so receivers can keep sharing it
+    const QByteArray fragment = std::move(m_output);
+    m_output = QByteArray();
+    m_fragmentsWritten++;
+    if (m_handler) {
+        m_handler(fragment, m_fragmentKeyframe);
+    }
+}
+
+void Fmp4Segmenter::close() {
+    if (!m_context) {
+        return;
+    }
+
+    if (m_context->pb) {
+        if (!m_init.isEmpty()) {  // Header written
+            if (m_fragmentPackets > 0) {
+                flushFragment();
+            }
+            av_write_trailer(m_context);  // Only an mfra index nobody live needs
+        }
+        av_freep(&m_context->pb->buffer);
+        avio_context_free(&m_context->pb);
+    }
+
+    avformat_free_context(m_context);
+    m_context = nullptr;
+    m_stream = nullptr;
+    m_output.clear();
+    m_init.clear();
+    m_fragmentPackets = 0;
+}
+
+} // namespace MCM
@@ -0,0 +1,104 @@
+#ifndef FMP4SEGMENTER_H
+#define FMP4SEGMENTER_H
+
+#include <QByteArray>
+#include <QString>
+#include <cstdint>
+#include <functional>
+
+extern "C" {
+#include <libavutil/rational.h>
+}
+
+struct AVFormatContext;
+struct AVStream;
+struct AVCodecParameters;
+struct AVPacket;
+
+namespace MCM {
+
+/**
+ * @brief Remuxes encoded video packets into fragmented MP4 in memory
+ *
+ * The live counterpart of Mp4ChunkWriter: same libavformat remux and
+ * timestamp handling, but the muxer writes into memory and cuts a
+ * fragment (moof + mdat) at every keyframe and after fragmentMs. A
+ * viewer needs initSegment() (ftyp + moov) followed by fragments starting
+ * at one flagged as a keyframe - which is also where a lagging viewer can
+ * skip to.
+ *
+ * Usage:
+ *   Fmp4Segmenter segmenter([](const QByteArray& fragment, bool keyframe) { ... });
+ *   segmenter.open(inputStream->codecpar, inputStream->time_base, 500);
+ *   send(segmenter.initSegment());
+ *   segmenter.write(packet);   // packets before the first keyframe are skipped
+ *   segmenter.close();         // flushes the last fragment
+ */
+class Fmp4Segmenter {
+public:
+    /**
+     * @brief Receives each finished fragment (on the thread calling write())
+     * @param keyframe The fragment starts with a keyframe
+     */
+    using FragmentHandler = std::function<void(const QByteArray& fragment, bool keyframe)>;
+
+    explicit Fmp4Segmenter(FragmentHandler handler);
+    ~Fmp4Segmenter();
+
+    // Prevent copying
+    Fmp4Segmenter(const Fmp4Segmenter&) = delete;
+    Fmp4Segmenter& operator=(const Fmp4Segmenter&) = delete;
+
+    /**
+     * @brief Set up the muxer and produce the init segment
+     * @param fragmentMs Longest fragment; keyframes always start a new one
+     */
+    bool open(const AVCodecParameters* codecpar, AVRational inputTimeBase, int fragmentMs,
+              QString* error = nullptr);
+
+    /**
+     * @brief Add one packet (timestamps in inputTimeBase); not consumed by the call
+     */
+    bool write(const AVPacket* packet, QString* error = nullptr);
+
+    /**
+     * @brief Flush the last fragment and free the muxer
+     */
+    void close();
+
+    bool isOpen() const { return m_context != nullptr; }
+
+    /**
+     * @brief ftyp + moov; valid after open()
+     */
+    QByteArray initSegment() const { return m_init; }
+
+    qint64 fragmentsWritten() const { return m_fragmentsWritten; }
+
+private:
+    friend struct Fmp4SegmenterIo;
+
+    void flushFragment();
+
+    FragmentHandler m_handler;
+    AVFormatContext* m_context{nullptr};
+    AVStream* m_stream{nullptr};
+    AVRational m_inputTimeBase{1, 90000};
+    int64_t m_fragmentTicks{0};   // fragmentMs in inputTimeBase
+
+    QByteArray m_init;
+    QByteArray m_output;          // Muxer output since the last fragment cut
+
+    int64_t m_firstTimestamp{INT64_MIN};
+    int64_t m_lastDts{INT64_MIN};
+    int64_t m_fragmentStartDts{0};
+    int m_fragmentPackets{0};
+    bool m_fragmentKeyframe{false};
+    qint64 m_fragmentsWritten{0};
+
+    static constexpr int IO_BUFFER_SIZE = 64 * 1024;
+};
+
+} // namespace MCM
+
+#endif // FMP4SEGMENTER_H
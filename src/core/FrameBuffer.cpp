@@ -1,5 +1,8 @@
 #include "FrameBuffer.h"
+#include "Telemetry.h"
 #include <QMutexLocker>
+#include <QDeadlineTimer>
+#include <QMetaMethod>
 
 namespace MCM {
 
@@ -8,120 +11,449 @@ FrameBuffer::FrameBuffer(int maxSize, int minMaintenance, QObject* parent)
     , m_maxSize(maxSize)
     , m_minMaintenance(minMaintenance)
 {
+    m_clock.start();
+}
+
+FrameBuffer::FrameBuffer(const BufferConfig& config, Mode mode, QObject* parent)
+    : QObject(parent)
+    , m_mode(mode)
+    , m_maxSize(qMax(1, config.frameCount))
+    , m_minMaintenance(config.minMaintenance)
+{
+    m_clock.start();
+
+    if (m_mode == Mode::LockFreeSpsc) {
+        // Preallocate all slots up front - no allocation on the hot path
+        m_ring.resize(static_cast<size_t>(m_maxSize));
+        m_ringTiming.resize(static_cast<size_t>(m_maxSize));
+    }
 }
 
 FrameBuffer::~FrameBuffer() {
     stop();
 }
 
-bool FrameBuffer::push(const QImage& frame) {
+bool FrameBuffer::push(const QImage& frame, qint64 ptsUs) {
     if (m_stopped) {
         return false;
     }
-    
-    QMutexLocker locker(&m_mutex);
-    
-    // Drop oldest frame if buffer is full (circular behavior)
-    if (static_cast<int>(m_buffer.size()) >= m_maxSize) {
-        m_buffer.pop_front();
+
+    if (m_mode == Mode::LockFreeSpsc) {
+        return ringPush(frame, ptsUs);
+    }
+
+    m_frameBytes.store(frame.sizeInBytes(), std::memory_order_relaxed);
+
+    int currentSize = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+
+        // Drop oldest frame if buffer is full (circular behavior)
+        const int depth = depthLimit();
+        while (!m_buffer.empty() && static_cast<int>(m_buffer.size()) >= depth) {
+            m_buffer.pop_front();
+        }
+
+        m_buffer.push_back(Entry{frame, schedule(ptsUs)});
+        currentSize = static_cast<int>(m_buffer.size());
+
+        // Wake up any waiting consumer
+        m_notEmpty.wakeOne();
     }
-    
-    m_buffer.push_back(frame);
-    
-    int currentSize = static_cast<int>(m_buffer.size());
+
     checkHealthChange(currentSize);
-    
-    emit sizeChanged(currentSize);
-    
-    // Wake up any waiting consumer
-    m_notEmpty.wakeOne();
-    
+    maybeEmitSizeChanged(currentSize);
+
     return true;
 }
 
 QImage FrameBuffer::pop(int timeout) {
-    QMutexLocker locker(&m_mutex);
-    
-    // Wait for data or stop signal
-    while (m_buffer.empty() && !m_stopped) {
-        if (timeout < 0) {
-            m_notEmpty.wait(&m_mutex);
-        } else {
-            if (!m_notEmpty.wait(&m_mutex, timeout)) {
-                return QImage();  // Timeout
+    if (m_mode == Mode::LockFreeSpsc) {
+        QImage frame = ringPop();
+        if (!frame.isNull() || timeout == 0) {
+            return frame;
+        }
+
+        // Slow path: ring is empty, park on the condition variable.
+        // The producer only takes the mutex when it sees m_consumerWaiting.
+        QDeadlineTimer deadline = timeout < 0 ? QDeadlineTimer(QDeadlineTimer::Forever)
+                                               : QDeadlineTimer(timeout);
+        QMutexLocker locker(&m_mutex);
+        m_consumerWaiting.store(true);
+        while (!m_stopped && m_head.load() == m_tail.load()) {
+            if (!m_notEmpty.wait(&m_mutex, deadline)) {
+                break;  // Timeout
             }
         }
+        m_consumerWaiting.store(false);
+        locker.unlock();
+
+        return m_stopped ? QImage() : ringPop();
     }
-    
-    if (m_stopped || m_buffer.empty()) {
-        return QImage();
+
+    int currentSize = 0;
+    QImage frame;
+    {
+        QMutexLocker locker(&m_mutex);
+
+        // Wait for data or stop signal
+        while (m_buffer.empty() && !m_stopped) {
+            if (timeout < 0) {
+                m_notEmpty.wait(&m_mutex);
+            } else {
+                if (!m_notEmpty.wait(&m_mutex, timeout)) {
+                    return QImage();  // Timeout
+                }
+            }
+        }
+
+        if (m_stopped || m_buffer.empty()) {
+            return QImage();
+        }
+
+        frame = std::move(m_buffer.front().image);
+        m_buffer.pop_front();
+        currentSize = static_cast<int>(m_buffer.size());
     }
-    
-    QImage frame = m_buffer.front();
-    m_buffer.pop_front();
-    
-    int currentSize = static_cast<int>(m_buffer.size());
+
     checkHealthChange(currentSize);
-    
-    emit sizeChanged(currentSize);
-    
+    maybeEmitSizeChanged(currentSize);
+
     return frame;
 }
 
 QImage FrameBuffer::tryPop() {
-    QMutexLocker locker(&m_mutex);
-    
-    if (m_buffer.empty()) {
+    if (m_mode == Mode::LockFreeSpsc) {
+        return ringPop();
+    }
+
+    int currentSize = 0;
+    QImage frame;
+    {
+        QMutexLocker locker(&m_mutex);
+
+        if (m_buffer.empty()) {
+            return QImage();
+        }
+
+        frame = std::move(m_buffer.front().image);
+        m_buffer.pop_front();
+        currentSize = static_cast<int>(m_buffer.size());
+    }
+
+    checkHealthChange(currentSize);
+    maybeEmitSizeChanged(currentSize);
+
+    return frame;
+}
+
+bool FrameBuffer::ringPush(const QImage& frame, qint64 ptsUs) {
+    const quint64 tail = m_tail.load(std::memory_order_relaxed);
+    const quint64 head = m_head.load(std::memory_order_acquire);
+    const quint64 capacity = m_ring.size();
+
+    if (tail - head >= static_cast<quint64>(depthLimit())) {
+        // Full: the oldest slot belongs to the consumer, so drop the new frame
+        m_droppedFrames.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Shallow copy - the slot's previous pixel data is released here
+    m_ring[tail % capacity] = frame;
+    m_ringTiming[tail % capacity] = schedule(ptsUs);
+    m_frameBytes.store(frame.sizeInBytes(), std::memory_order_relaxed);
+    m_tail.store(tail + 1, std::memory_order_seq_cst);
+
+    wakeWaitingConsumer();
+
+    int currentSize = static_cast<int>(tail + 1 - head);
+    checkHealthChange(currentSize);
+    maybeEmitSizeChanged(currentSize);
+    return true;
+}
+
+QImage* FrameBuffer::beginWrite(const QSize& size, QImage::Format format) {
+    if (m_mode != Mode::LockFreeSpsc || m_stopped) {
+        return nullptr;
+    }
+
+    const quint64 tail = m_tail.load(std::memory_order_relaxed);
+    const quint64 head = m_head.load(std::memory_order_acquire);
+    const quint64 capacity = m_ring.size();
+
+    if (tail - head >= static_cast<quint64>(depthLimit())) {
+        m_droppedFrames.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    QImage& slot = m_ring[tail % capacity];
+
+    // Recycle the slot's storage when geometry matches. If a consumer still
+    // holds the previous frame, bits() will detach (copy-on-write) - correct,
+    // just not allocation-free.
+    if (slot.size() != size || slot.format() != format) {
+        slot = QImage(size, format);
+    }
+    m_frameBytes.store(slot.sizeInBytes(), std::memory_order_relaxed);
+
+    m_writeOpen = true;
+    return &slot;
+}
+
+void FrameBuffer::commitWrite(qint64 ptsUs) {
+    if (m_mode != Mode::LockFreeSpsc || !m_writeOpen) {
+        return;
+    }
+    m_writeOpen = false;
+
+    const quint64 tail = m_tail.load(std::memory_order_relaxed);
+    const quint64 head = m_head.load(std::memory_order_acquire);
+    m_ringTiming[tail % m_ring.size()] = schedule(ptsUs);
+
+    m_tail.store(tail + 1, std::memory_order_seq_cst);
+    wakeWaitingConsumer();
+
+    int currentSize = static_cast<int>(tail + 1 - head);
+    checkHealthChange(currentSize);
+    maybeEmitSizeChanged(currentSize);
+}
+
+QImage FrameBuffer::ringPop() {
+    const quint64 head = m_head.load(std::memory_order_relaxed);
+    const quint64 tail = m_tail.load(std::memory_order_acquire);
+
+    if (head == tail) {
         return QImage();
     }
-    
-    QImage frame = m_buffer.front();
-    m_buffer.pop_front();
-    
-    int currentSize = static_cast<int>(m_buffer.size());
+
+    // Shallow copy keeps the slot's storage alive for recycling by beginWrite(),
+    // except under a memory cap, where it goes with the consumer's copy
+    QImage& slot = m_ring[head % m_ring.size()];
+    QImage frame = slot;
+    if (m_memoryLimit.load(std::memory_order_relaxed) >= 0) {
+        slot = QImage();
+    }
+    m_head.store(head + 1, std::memory_order_release);
+
+    int currentSize = static_cast<int>(tail - head - 1);
     checkHealthChange(currentSize);
-    
-    emit sizeChanged(currentSize);
-    
+    maybeEmitSizeChanged(currentSize);
     return frame;
 }
 
+FrameBuffer::Timing FrameBuffer::schedule(qint64 ptsUs) {
+    if (ptsUs < 0) {
+        return Timing{};
+    }
+    const qint64 transitUs = Telemetry::nowUs() - ptsUs;
+
+    // A new timeline (first frame, seek, reconnect, file loop) starts over
+    const bool restart = m_lastPtsUs < 0 || ptsUs < m_lastPtsUs
+        || ptsUs - m_lastPtsUs > DISCONTINUITY_US || qAbs(transitUs - m_baseTransitUs) > DISCONTINUITY_US;
+    if (restart) {
+        m_baseTransitUs = transitUs;
+        m_jitterUs = 0;
+        m_lastPresentUs = -1;
+    } else {
+        const qint64 intervalUs = ptsUs - m_lastPtsUs;
+        m_frameIntervalUs = m_frameIntervalUs > 0 ? (m_frameIntervalUs * 7 + intervalUs) / 8 : intervalUs;
+        if (transitUs < m_baseTransitUs) {
+            m_baseTransitUs = transitUs;  // Fastest path so far
+        } else {
+            m_baseTransitUs += (transitUs - m_baseTransitUs) / BASE_FOLLOW;  // Source clock drift
+        }
+    }
+    m_lastPtsUs = ptsUs;
+
+    // Peak-hold jitter, decaying slowly: the delay grows at once and shrinks once the source calms
+    m_jitterUs = qMax(transitUs - m_baseTransitUs, m_jitterUs - m_jitterUs / JITTER_DECAY);
+    const qint64 maxDelayUs = m_frameIntervalUs > 0
+        ? qMin(MAX_DELAY_US, m_frameIntervalUs * qMax(1, m_maxSize - 1)) : MAX_DELAY_US;
+    const qint64 targetUs = qBound<qint64>(0, m_jitterUs + SAFETY_US, maxDelayUs);
+
+    // Never before the previous frame, even while the delay shrinks
+    const qint64 presentUs = qMax(ptsUs + m_baseTransitUs + targetUs, m_lastPresentUs);
+    m_lastPresentUs = presentUs;
+
+    m_targetDelayUs.store(targetUs, std::memory_order_relaxed);
+    m_jitterStatUs.store(m_jitterUs, std::memory_order_relaxed);
+    m_frameIntervalStatUs.store(m_frameIntervalUs, std::memory_order_relaxed);
+    return Timing{ptsUs, presentUs};
+}
+
+FrameBuffer::PacedFrame FrameBuffer::popPaced(qint64 vsyncUs, qint64 refreshIntervalUs) {
+    // The frame for this refresh is the newest one due by its midpoint
+    const qint64 deadlineUs = vsyncUs + refreshIntervalUs / 2;
+    PacedFrame result;
+    bool empty = false;
+    int currentSize = 0;
+
+    if (m_mode == Mode::LockFreeSpsc) {
+        const quint64 head = m_head.load(std::memory_order_relaxed);
+        const quint64 tail = m_tail.load(std::memory_order_acquire);
+        const quint64 capacity = m_ring.size();
+        quint64 due = head;
+        while (due < tail && m_ringTiming[due % capacity].presentUs <= deadlineUs) {
+            ++due;
+        }
+        empty = head == tail;
+        if (due > head) {
+            const quint64 index = due - 1;
+            QImage& slot = m_ring[index % capacity];
+            result.image = slot;
+            result.ptsUs = m_ringTiming[index % capacity].ptsUs;
+            result.presentUs = m_ringTiming[index % capacity].presentUs;
+            result.dropped = static_cast<int>(index - head);
+            // Under a memory cap the consumed slots give their storage back, as in ringPop()
+            if (m_memoryLimit.load(std::memory_order_relaxed) >= 0) {
+                for (quint64 i = head; i <= index; ++i) {
+                    m_ring[i % capacity] = QImage();
+                }
+            }
+            m_head.store(due, std::memory_order_release);
+        }
+        currentSize = static_cast<int>(tail - due);
+    } else {
+        QMutexLocker locker(&m_mutex);
+        size_t due = 0;
+        while (due < m_buffer.size() && m_buffer[due].timing.presentUs <= deadlineUs) {
+            ++due;
+        }
+        empty = m_buffer.empty();
+        if (due > 0) {
+            Entry& entry = m_buffer[due - 1];
+            result.image = std::move(entry.image);
+            result.ptsUs = entry.timing.ptsUs;
+            result.presentUs = entry.timing.presentUs;
+            result.dropped = static_cast<int>(due - 1);
+            m_buffer.erase(m_buffer.begin(), m_buffer.begin() + static_cast<std::ptrdiff_t>(due));
+        }
+        currentSize = static_cast<int>(m_buffer.size());
+    }
+
+    checkHealthChange(currentSize);
+    maybeEmitSizeChanged(currentSize);
+    return finishPaced(std::move(result), vsyncUs, refreshIntervalUs, empty);
+}
+
+FrameBuffer::PacedFrame FrameBuffer::finishPaced(PacedFrame frame, qint64 vsyncUs, qint64 refreshIntervalUs,
+                                                 bool empty) {
+    if (frame.isNull()) {
+        // Dry while the next frame should already be up: the source or the delay fell short
+        if (empty && !m_inUnderrun && m_releasedPresentUs >= 0
+            && vsyncUs > m_releasedPresentUs + m_releasedIntervalUs + refreshIntervalUs) {
+            m_inUnderrun = true;
+            m_underruns.fetch_add(1, std::memory_order_relaxed);
+        }
+        return frame;
+    }
+
+    frame.late = frame.presentUs >= 0 && frame.presentUs < vsyncUs - refreshIntervalUs;
+    if (frame.presentUs >= 0) {
+        if (m_releasedPresentUs >= 0 && frame.presentUs > m_releasedPresentUs) {
+            m_releasedIntervalUs = frame.presentUs - m_releasedPresentUs;
+        }
+        m_releasedPresentUs = frame.presentUs;
+    }
+    m_inUnderrun = false;
+    m_pacedReleased.fetch_add(1, std::memory_order_relaxed);
+    m_pacedDropped.fetch_add(frame.dropped, std::memory_order_relaxed);
+    if (frame.late) {
+        m_pacedLate.fetch_add(1, std::memory_order_relaxed);
+    }
+    return frame;
+}
+
+FrameBuffer::PacingStats FrameBuffer::pacingStats() const {
+    PacingStats stats;
+    stats.released = m_pacedReleased.load(std::memory_order_relaxed);
+    stats.dropped = m_pacedDropped.load(std::memory_order_relaxed);
+    stats.late = m_pacedLate.load(std::memory_order_relaxed);
+    stats.underruns = m_underruns.load(std::memory_order_relaxed);
+    stats.targetDelayUs = m_targetDelayUs.load(std::memory_order_relaxed);
+    stats.jitterUs = m_jitterStatUs.load(std::memory_order_relaxed);
+    stats.frameIntervalUs = m_frameIntervalStatUs.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void FrameBuffer::wakeWaitingConsumer() {
+    // Pairs with the seq_cst store of m_consumerWaiting in pop(): either the
+    // consumer sees the new tail, or we see it waiting and signal it.
+    if (m_consumerWaiting.load()) {
+        QMutexLocker locker(&m_mutex);
+        m_notEmpty.wakeOne();
+    }
+}
+
 void FrameBuffer::checkHealthChange(int currentSize) {
     // Simple threshold: healthy when we have at least 5 frames
     // Once healthy, stay healthy (no buffering interruptions)
     constexpr int STARTUP_THRESHOLD = 5;
-    
-    if (!m_wasHealthy && currentSize >= STARTUP_THRESHOLD) {
-        m_wasHealthy = true;
+
+    if (currentSize >= STARTUP_THRESHOLD && !m_wasHealthy.exchange(true)) {
         emit healthChanged(true);
     }
     // Note: We don't go back to unhealthy - display continues even if buffer drops
 }
 
+void FrameBuffer::maybeEmitSizeChanged(int currentSize) {
+    // Emitted per push - a queued receiver would otherwise see one event per frame
+    static const QMetaMethod signal = QMetaMethod::fromSignal(&FrameBuffer::sizeChanged);
+    if (!isSignalConnected(signal)) {
+        return;
+    }
+
+    const int interval = m_signalIntervalMs.load(std::memory_order_relaxed);
+    if (interval <= 0) {
+        emit sizeChanged(currentSize);
+        return;
+    }
+
+    const qint64 now = m_clock.elapsed();
+    qint64 last = m_lastSizeSignalMs.load(std::memory_order_relaxed);
+    if (last >= 0 && now - last < interval) {
+        return;
+    }
+
+    // Producer and consumer may race here - only one of them emits
+    if (m_lastSizeSignalMs.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+        emit sizeChanged(currentSize);
+    }
+}
+
 int FrameBuffer::size() const {
+    if (m_mode == Mode::LockFreeSpsc) {
+        const quint64 head = m_head.load(std::memory_order_acquire);
+        const quint64 tail = m_tail.load(std::memory_order_acquire);
+        return tail > head ? static_cast<int>(tail - head) : 0;
+    }
+
     QMutexLocker locker(&m_mutex);
     return static_cast<int>(m_buffer.size());
 }
 
 bool FrameBuffer::isEmpty() const {
-    QMutexLocker locker(&m_mutex);
-    return m_buffer.empty();
+    return size() == 0;
 }
 
 bool FrameBuffer::isBelowMaintenance() const {
-    QMutexLocker locker(&m_mutex);
-    return static_cast<int>(m_buffer.size()) < m_minMaintenance;
+    return size() < m_minMaintenance;
 }
 
 bool FrameBuffer::isHealthy() const {
-    QMutexLocker locker(&m_mutex);
-    int currentSize = static_cast<int>(m_buffer.size());
+    int currentSize = size();
     return m_wasHealthy ? (currentSize >= m_minMaintenance) : (currentSize >= m_maxSize);
 }
 
 void FrameBuffer::clear() {
-    QMutexLocker locker(&m_mutex);
-    m_buffer.clear();
+    if (m_mode == Mode::LockFreeSpsc) {
+        // Consumer-side clear: discard everything published so far
+        m_head.store(m_tail.load(std::memory_order_acquire), std::memory_order_release);
+    } else {
+        QMutexLocker locker(&m_mutex);
+        m_buffer.clear();
+    }
+
     m_wasHealthy = false;
     emit healthChanged(false);
     emit sizeChanged(0);
@@ -129,32 +461,77 @@ void FrameBuffer::clear() {
 
 void FrameBuffer::stop() {
     m_stopped = true;
+    QMutexLocker locker(&m_mutex);
     m_notEmpty.wakeAll();
 }
 
 void FrameBuffer::reset() {
-    QMutexLocker locker(&m_mutex);
-    m_buffer.clear();
+    if (m_mode == Mode::LockFreeSpsc) {
+        m_head.store(m_tail.load(std::memory_order_acquire), std::memory_order_release);
+    } else {
+        QMutexLocker locker(&m_mutex);
+        m_buffer.clear();
+    }
     m_stopped = false;
     m_wasHealthy = false;
 }
 
 void FrameBuffer::setMaxSize(int maxSize) {
+    if (m_mode == Mode::LockFreeSpsc) {
+        return;  // Capacity fixed at construction (slots are preallocated)
+    }
+
     QMutexLocker locker(&m_mutex);
     m_maxSize = maxSize;
-    
+
     // Trim buffer if needed
     while (static_cast<int>(m_buffer.size()) > m_maxSize) {
         m_buffer.pop_front();
     }
 }
 
-void FrameBuffer::setMinMaintenance(int minMaintenance) {
+qint64 FrameBuffer::memoryBytes() const {
+    const qint64 frameBytes = m_frameBytes.load(std::memory_order_relaxed);
+    if (m_mode == Mode::Locked) {
+        return size() * frameBytes;
+    }
+    // Slots written at least once keep their storage, unless released under a cap
+    qint64 held = static_cast<qint64>(qMin<quint64>(m_tail.load(std::memory_order_acquire), m_ring.size()));
+    if (m_memoryLimit.load(std::memory_order_relaxed) >= 0) {
+        held = qMin<qint64>(held, size() + 1);
+    }
+    return held * frameBytes;
+}
+
+qint64 FrameBuffer::minimumMemoryBytes() const {
+    return qBound(1, m_minMaintenance, m_maxSize) * m_frameBytes.load(std::memory_order_relaxed);
+}
+
+void FrameBuffer::setMemoryLimit(qint64 bytes) {
+    m_memoryLimit.store(bytes, std::memory_order_relaxed);
+    if (m_mode == Mode::LockFreeSpsc) {
+        return;  // The producer sees the new depth at its next push
+    }
+
     QMutexLocker locker(&m_mutex);
+    const int depth = depthLimit();
+    while (static_cast<int>(m_buffer.size()) > depth) {
+        m_buffer.pop_front();
+    }
+}
+
+int FrameBuffer::depthLimit() const {
+    const qint64 limit = m_memoryLimit.load(std::memory_order_relaxed);
+    const qint64 frameBytes = m_frameBytes.load(std::memory_order_relaxed);
+    if (limit < 0 || frameBytes <= 0) {
+        return m_maxSize;
+    }
+    return static_cast<int>(qBound<qint64>(1, limit / frameBytes, m_maxSize));
+}
+
+void FrameBuffer::setMinMaintenance(int minMaintenance) {
     m_minMaintenance = minMaintenance;
-    
-    int currentSize = static_cast<int>(m_buffer.size());
-    checkHealthChange(currentSize);
+    checkHealthChange(size());
 }
 
 } // namespace MCM
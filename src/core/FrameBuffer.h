@@ -5,35 +5,124 @@
 #include <QImage>
 #include <QMutex>
 #include <QWaitCondition>
+#include <QElapsedTimer>
 #include <deque>
+#include <vector>
 #include <atomic>
+#include "core/Config.h"
 
 namespace MCM {
 
 /**
  * @brief Thread-safe circular frame buffer with maintenance threshold
- * 
+ *
  * This buffer ensures smooth playback by maintaining a minimum number
  * of frames before allowing consumption. When buffer drops below the
  * maintenance threshold, playback should pause until buffer recovers.
- * 
- * Uses std::deque as a FIFO queue.
+ *
+ * Two storage modes are available:
+ * - Locked: std::deque FIFO guarded by a QMutex (original behavior)
+ * - LockFreeSpsc: fixed-capacity single-producer/single-consumer ring
+ *   with preallocated slots. push/pop never take a lock on the hot path,
+ *   and slot pixel storage is recycled via beginWrite()/commitWrite().
+ *
+ * In LockFreeSpsc mode exactly one thread may push and one thread may pop.
+ * The producer never touches slots owned by the consumer, so when the ring
+ * is full the incoming frame is dropped (and counted) instead of the oldest.
+ *
+ * Frames pushed with their capture PTS can be consumed paced instead of
+ * oldest-first: popPaced() is called once per display refresh and returns
+ * the frame due at that vsync. Each frame is scheduled at its PTS plus the
+ * fastest capture-to-push transit seen plus a target delay that follows
+ * the arrival jitter (peak-hold, slowly decaying), so the buffer holds as
+ * little as the source's jitter allows rather than a fixed cushion. When
+ * several frames are due at one vsync the newest is shown and the rest are
+ * dropped; when none is due the display repeats its current frame.
  */
 class FrameBuffer : public QObject {
     Q_OBJECT
 
 public:
+    enum class Mode {
+        Locked,        // Mutex + deque, unbounded allocation (default)
+        LockFreeSpsc   // Wait-free SPSC ring, fixed capacity
+    };
+
     explicit FrameBuffer(int maxSize = 30, int minMaintenance = 10, QObject* parent = nullptr);
+
+    /**
+     * @brief Create a buffer sized from BufferConfig
+     * @param config Capacity comes from frameCount, threshold from minMaintenance
+     * @param mode Storage mode (LockFreeSpsc preallocates frameCount slots)
+     */
+    FrameBuffer(const BufferConfig& config, Mode mode, QObject* parent = nullptr);
     ~FrameBuffer();
 
     /**
      * @brief Push a frame into the buffer (producer side)
      * @param frame The frame to add
+     * @param ptsUs Capture presentation time in microseconds (QVideoFrame::startTime(),
+     *        -1 = none: a paced consumer gets the frame at its next vsync)
      * @return true if frame was added, false if buffer was stopped
-     * 
-     * If buffer is full, oldest frame is dropped (circular behavior)
+     *         (or, in LockFreeSpsc mode, full)
+     *
+     * Locked mode: if buffer is full, oldest frame is dropped (circular behavior)
+     */
+    bool push(const QImage& frame, qint64 ptsUs = -1);
+
+    /**
+     * @brief Get a recycled slot image to fill in place (LockFreeSpsc only)
+     * @param size Frame size the producer is about to write
+     * @param format Pixel format the producer is about to write
+     * @return Writable image backed by the slot's storage, or nullptr if the
+     *         ring is full/stopped or the buffer is in Locked mode
+     *
+     * Storage is reallocated only when size/format change or a consumer still
+     * holds a reference to the slot's previous frame. Must be followed by
+     * commitWrite() before the next beginWrite().
      */
-    bool push(const QImage& frame);
+    QImage* beginWrite(const QSize& size, QImage::Format format);
+
+    /**
+     * @brief Publish the slot obtained from beginWrite() to the consumer
+     * @param ptsUs Capture presentation time, as for push()
+     */
+    void commitWrite(qint64 ptsUs = -1);
+
+    /**
+     * @brief A frame released by popPaced()
+     */
+    struct PacedFrame {
+        QImage image;          // Null: nothing due, keep showing the current frame
+        qint64 ptsUs{-1};
+        qint64 presentUs{-1};  // When it was scheduled for (Telemetry::nowUs() clock; -1 = no PTS)
+        int dropped{0};        // Older due frames skipped for this one
+        bool late{false};      // Its vsync had already passed
+
+        bool isNull() const { return image.isNull(); }
+    };
+
+    struct PacingStats {
+        quint64 released{0};
+        quint64 dropped{0};         // Superseded at a vsync by a newer due frame
+        quint64 late{0};            // Released at least one refresh after their time
+        quint64 underruns{0};       // Buffer ran dry when the next frame was due
+        qint64 targetDelayUs{0};    // Current delay added on top of the fastest transit
+        qint64 jitterUs{0};         // Arrival jitter the delay follows
+        qint64 frameIntervalUs{0};  // Source frame interval from the PTS
+    };
+
+    /**
+     * @brief Frame to show at the display refresh at @p vsyncUs (consumer side, never blocks)
+     * @param vsyncUs Time of the refresh on the Telemetry::nowUs() clock
+     * @param refreshIntervalUs Display refresh interval
+     *
+     * Returns the newest frame scheduled no later than half a refresh after
+     * vsyncUs, dropping older due frames, or a null frame when none is due.
+     */
+    PacedFrame popPaced(qint64 vsyncUs, qint64 refreshIntervalUs);
+
+    PacingStats pacingStats() const;
 
     /**
      * @brief Pop a frame from the buffer (consumer side)
@@ -71,6 +160,8 @@ public:
 
     /**
      * @brief Clear all frames from buffer
+     *
+     * In LockFreeSpsc mode this must be called from the consumer thread.
      */
     void clear();
 
@@ -86,12 +177,51 @@ public:
 
     /**
      * @brief Update buffer configuration
+     *
+     * setMaxSize() is ignored in LockFreeSpsc mode (capacity is fixed).
      */
     void setMaxSize(int maxSize);
     void setMinMaintenance(int minMaintenance);
 
+    /**
+     * @brief Limit sizeChanged emission to at most one per interval
+     * @param ms Minimum interval in milliseconds (0 = emit on every change)
+     */
+    void setSignalInterval(int ms) { m_signalIntervalMs.store(ms, std::memory_order_relaxed); }
+
     int maxSize() const { return m_maxSize; }
     int minMaintenance() const { return m_minMaintenance; }
+    Mode mode() const { return m_mode; }
+
+    /**
+     * @brief Approximate bytes held: frames buffered (or kept for reuse) x frame size
+     */
+    qint64 memoryBytes() const;
+
+    /**
+     * @brief Bytes of minMaintenance frames, what the buffer needs to play smoothly
+     */
+    qint64 minimumMemoryBytes() const;
+
+    /**
+     * @brief Cap the depth to what fits in @p bytes (MemoryGovernor; -1 = maxSize only)
+     *
+     * Never below one frame. Locked mode drops the oldest frames beyond the
+     * cap at once. LockFreeSpsc mode keeps its slots but accepts no more
+     * frames than the cap, and while capped the consumer releases the
+     * storage of the slots it pops instead of keeping it for reuse.
+     */
+    void setMemoryLimit(qint64 bytes);
+
+    /**
+     * @brief Frames the buffer holds at most right now (maxSize, or less under a memory cap)
+     */
+    int depthLimit() const;
+
+    /**
+     * @brief Frames rejected because the ring was full (LockFreeSpsc only)
+     */
+    quint64 droppedFrames() const { return m_droppedFrames.load(std::memory_order_relaxed); }
 
 signals:
     /**
@@ -103,20 +233,88 @@ signals:
     /**
      * @brief Emitted when buffer size changes significantly
      * @param currentSize Current number of frames in buffer
+     *
+     * Rate-limited by setSignalInterval() (100 ms by default) and skipped
+     * entirely while nothing is connected.
      */
     void sizeChanged(int currentSize);
 
 private:
+    struct Timing {
+        qint64 ptsUs{-1};
+        qint64 presentUs{-1};  // -1 = due at once
+    };
+
+    struct Entry {
+        QImage image;
+        Timing timing;
+    };
+
+    Timing schedule(qint64 ptsUs);     // Producer side (under m_mutex in Locked mode)
+    PacedFrame finishPaced(PacedFrame frame, qint64 vsyncUs, qint64 refreshIntervalUs, bool empty);
+
     void checkHealthChange(int currentSize);
-    
-    std::deque<QImage> m_buffer;  // FIFO queue
+    void maybeEmitSizeChanged(int currentSize);
+
+    // Lock-free ring helpers
+    bool ringPush(const QImage& frame, qint64 ptsUs);
+    QImage ringPop();
+    void wakeWaitingConsumer();
+
+    Mode m_mode{Mode::Locked};
+
+    std::deque<Entry> m_buffer;   // FIFO queue (Locked mode)
     mutable QMutex m_mutex;
     QWaitCondition m_notEmpty;
-    
+
+    // SPSC ring (LockFreeSpsc mode). Indices grow monotonically; slot = index % capacity.
+    // m_tail is written only by the producer, m_head only by the consumer.
+    std::vector<QImage> m_ring;
+    std::vector<Timing> m_ringTiming;  // Per slot, written with the slot
+    alignas(64) std::atomic<quint64> m_head{0};
+    alignas(64) std::atomic<quint64> m_tail{0};
+    std::atomic<bool> m_consumerWaiting{false};
+    std::atomic<quint64> m_droppedFrames{0};
+    bool m_writeOpen{false};  // Producer-only: beginWrite() slot awaiting commit
+
     int m_maxSize;
     int m_minMaintenance;
     std::atomic<bool> m_stopped{false};
-    bool m_wasHealthy{false};
+    std::atomic<bool> m_wasHealthy{false};
+
+    // Pacing, producer side
+    qint64 m_lastPtsUs{-1};
+    qint64 m_lastPresentUs{-1};
+    qint64 m_baseTransitUs{0};         // Fastest push time - PTS seen (follows clock drift slowly)
+    qint64 m_jitterUs{0};
+    qint64 m_frameIntervalUs{0};
+    std::atomic<qint64> m_targetDelayUs{0};
+    std::atomic<qint64> m_jitterStatUs{0};
+    std::atomic<qint64> m_frameIntervalStatUs{0};
+
+    // Pacing, consumer side
+    qint64 m_releasedPresentUs{-1};
+    qint64 m_releasedIntervalUs{0};
+    bool m_inUnderrun{false};
+    std::atomic<quint64> m_pacedReleased{0};
+    std::atomic<quint64> m_pacedDropped{0};
+    std::atomic<quint64> m_pacedLate{0};
+    std::atomic<quint64> m_underruns{0};
+
+    static constexpr qint64 DISCONTINUITY_US = 1000000;  // PTS / transit jump that restarts pacing
+    static constexpr qint64 MAX_DELAY_US = 1000000;
+    static constexpr qint64 SAFETY_US = 2000;            // On top of the jitter
+    static constexpr int JITTER_DECAY = 256;             // Frames for the peak to decay by ~1/e
+    static constexpr int BASE_FOLLOW = 4096;             // Frames for the base transit to follow a rise
+
+    // Memory accounting (MemoryGovernor)
+    std::atomic<qint64> m_frameBytes{0};       // Size of the last frame pushed
+    std::atomic<qint64> m_memoryLimit{-1};
+
+    // Signal coalescing
+    QElapsedTimer m_clock;
+    std::atomic<int> m_signalIntervalMs{100};
+    std::atomic<qint64> m_lastSizeSignalMs{-1};
 };
 
 } // namespace MCM
@@ -0,0 +1,216 @@
+#include "FramePool.h"
+#include <QMutexLocker>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+namespace MCM {
+
+// CpuFrame implementation
+QImage CpuFrame::toImage() const {
+    const QImage::Format imageFormat = QVideoFrameFormat::imageFormatFromPixelFormat(m_key.format);
+
+    if (imageFormat != QImage::Format_Invalid && m_planeCount == 1) {
+        // Zero-copy: the image holds a reference to this frame until destroyed
+        auto* keepAlive = new FrameRef(shared_from_this());
+        return QImage(m_planes[0], m_key.size.width(), m_key.size.height(),
+                      m_bytesPerLine[0], imageFormat,
+                      [](void* info) { delete static_cast<FrameRef*>(info); },
+                      keepAlive);
+    }
+
+    // YUV formats: rebuild a QVideoFrame and let Qt do the color conversion
+    QVideoFrameFormat format(m_key.size, m_key.format);
+    format.setColorSpace(m_colorSpace);
+    QVideoFrame temp(format);
+    if (!temp.map(QVideoFrame::WriteOnly)) {
+        return QImage();
+    }
+
+    for (int plane = 0; plane < qMin(m_planeCount, temp.planeCount()); ++plane) {
+        const int srcStride = m_bytesPerLine[plane];
+        const int dstStride = temp.bytesPerLine(plane);
+        if (srcStride <= 0 || dstStride <= 0) {
+            continue;
+        }
+        const qsizetype rows = qMin(m_planeBytes[plane] / srcStride,
+                                    static_cast<qsizetype>(temp.mappedBytes(plane) / dstStride));
+        const int rowBytes = qMin(srcStride, dstStride);
+        for (qsizetype row = 0; row < rows; ++row) {
+            std::memcpy(temp.bits(plane) + row * dstStride, m_planes[plane] + row * srcStride, rowBytes);
+        }
+    }
+
+    temp.unmap();
+    return temp.toImage();
+}
+
+// FramePool implementation
+FramePool& FramePool::instance() {
+    static FramePool instance;
+    return instance;
+}
+
+FramePool::FramePool()
+    : m_state(std::make_shared<State>())
+{
+}
+
+FrameRef FramePool::map(const QVideoFrame& frame) {
+    if (!frame.isValid()) {
+        return nullptr;
+    }
+
+    // map() is non-const; a shallow copy shares the underlying buffer
+    QVideoFrame source(frame);
+    if (!source.map(QVideoFrame::ReadOnly)) {
+        qWarning() << "FramePool: Failed to map frame" << frame.size() << frame.pixelFormat();
+        return nullptr;
+    }
+
+    const FrameKey key{source.size(), source.pixelFormat()};
+    const int planeCount = qMin(source.planeCount(), CpuFrame::MaxPlanes);
+
+    qsizetype totalBytes = 0;
+    for (int plane = 0; plane < planeCount; ++plane) {
+        totalBytes += source.mappedBytes(plane);
+    }
+
+    if (totalBytes <= 0) {
+        source.unmap();
+        return nullptr;
+    }
+
+    // Acquire storage: most recently released buffer of this shape first (cache-warm)
+    std::unique_ptr<uchar[]> storage;
+    qsizetype capacity = 0;
+    {
+        QMutexLocker locker(&m_state->mutex);
+        auto it = m_state->idle.find(key);
+        if (it != m_state->idle.end()) {
+            auto& buffers = it.value();
+            for (size_t i = buffers.size(); i-- > 0;) {
+                if (buffers[i].capacity >= totalBytes) {
+                    storage = std::move(buffers[i].storage);
+                    capacity = buffers[i].capacity;
+                    buffers.erase(buffers.begin() + static_cast<std::ptrdiff_t>(i));
+                    m_state->idleBytes -= capacity;
+
+                    auto& order = m_state->idleOrder;
+                    auto orderIt = std::find(order.rbegin(), order.rend(), key);
+                    if (orderIt != order.rend()) {
+                        order.erase(std::next(orderIt).base());
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    if (storage) {
+        m_state->hits.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        m_state->misses.fetch_add(1, std::memory_order_relaxed);
+        storage.reset(new uchar[static_cast<size_t>(totalBytes)]);
+        capacity = totalBytes;
+    }
+    m_state->bytesInUse.fetch_add(capacity, std::memory_order_relaxed);
+
+    auto* cpuFrame = new CpuFrame();
+    cpuFrame->m_key = key;
+    cpuFrame->m_planeCount = planeCount;
+    cpuFrame->m_totalBytes = totalBytes;
+    cpuFrame->m_startTime = frame.startTime();
+    cpuFrame->m_colorSpace = frame.surfaceFormat().colorSpace();
+
+    uchar* dst = storage.get();
+    for (int plane = 0; plane < planeCount; ++plane) {
+        const qsizetype bytes = source.mappedBytes(plane);
+        std::memcpy(dst, source.bits(plane), static_cast<size_t>(bytes));
+        cpuFrame->m_planes[plane] = dst;
+        cpuFrame->m_bytesPerLine[plane] = source.bytesPerLine(plane);
+        cpuFrame->m_planeBytes[plane] = bytes;
+        dst += bytes;
+    }
+    source.unmap();
+
+    cpuFrame->m_storage = std::move(storage);
+    cpuFrame->m_capacity = capacity;
+
+    std::weak_ptr<State> weakState = m_state;
+    return FrameRef(cpuFrame, [weakState](CpuFrame* released) {
+        if (auto state = weakState.lock()) {
+            state->bytesInUse.fetch_sub(released->m_capacity, std::memory_order_relaxed);
+            state->release(released->m_key, std::move(released->m_storage), released->m_capacity);
+        }
+        delete released;
+    });
+}
+
+void FramePool::State::release(const FrameKey& key, std::unique_ptr<uchar[]> storage,
+                               qsizetype capacity) {
+    if (!storage) {
+        return;
+    }
+
+    QMutexLocker locker(&mutex);
+    idle[key].push_back(IdleBuffer{std::move(storage), capacity});
+    idleOrder.push_back(key);
+    idleBytes += capacity;
+
+    if (idleBytes > maxIdleBytes) {
+        trimLocked(maxIdleBytes);
+    }
+}
+
+void FramePool::State::trimLocked(qint64 keepIdleBytes) {
+    while (idleBytes > keepIdleBytes && !idleOrder.empty()) {
+        const FrameKey key = idleOrder.front();
+        idleOrder.erase(idleOrder.begin());
+
+        auto it = idle.find(key);
+        if (it == idle.end() || it.value().empty()) {
+            continue;
+        }
+
+        // Oldest buffer of this shape is at the front
+        auto& buffers = it.value();
+        idleBytes -= buffers.front().capacity;
+        buffers.erase(buffers.begin());
+        if (buffers.empty()) {
+            idle.erase(it);
+        }
+    }
+}
+
+FramePool::Stats FramePool::stats() const {
+    Stats s;
+    s.hits = m_state->hits.load(std::memory_order_relaxed);
+    s.misses = m_state->misses.load(std::memory_order_relaxed);
+    s.bytesInUse = m_state->bytesInUse.load(std::memory_order_relaxed);
+
+    QMutexLocker locker(&m_state->mutex);
+    s.bytesResident = m_state->idleBytes + s.bytesInUse;
+    for (auto it = m_state->idle.cbegin(); it != m_state->idle.cend(); ++it) {
+        s.idleBuffers += static_cast<int>(it.value().size());
+    }
+    return s;
+}
+
+void FramePool::setMaxIdleBytes(qint64 bytes) {
+    QMutexLocker locker(&m_state->mutex);
+    m_state->maxIdleBytes = qMax<qint64>(0, bytes);
+    m_state->trimLocked(m_state->maxIdleBytes);
+}
+
+qint64 FramePool::maxIdleBytes() const {
+    QMutexLocker locker(&m_state->mutex);
+    return m_state->maxIdleBytes;
+}
+
+void FramePool::trim(qint64 keepIdleBytes) {
+    QMutexLocker locker(&m_state->mutex);
+    m_state->trimLocked(keepIdleBytes);
+}
+
+} // namespace MCM
@@ -0,0 +1,172 @@
+#ifndef FRAMEPOOL_H
+#define FRAMEPOOL_H
+
+#include <QVideoFrame>
+#include <QVideoFrameFormat>
+#include <QImage>
+#include <QSize>
+#include <QHash>
+#include <QMutex>
+#include <memory>
+#include <vector>
+#include <atomic>
+
+namespace MCM {
+
+/**
+ * @brief Pool key - buffers are only recycled between frames of the same shape
+ */
+struct FrameKey {
+    QSize size;
+    QVideoFrameFormat::PixelFormat format{QVideoFrameFormat::Format_Invalid};
+
+    bool operator==(const FrameKey& other) const {
+        return size == other.size && format == other.format;
+    }
+};
+
+inline size_t qHash(const FrameKey& key, size_t seed = 0) {
+    return qHashMulti(seed, key.size.width(), key.size.height(), static_cast<int>(key.format));
+}
+
+class FramePool;
+
+/**
+ * @brief Read-only CPU copy of a decoded frame, backed by pooled storage
+ *
+ * Holds all planes of the source QVideoFrame in one contiguous buffer.
+ * When the last FrameRef goes away the buffer returns to the pool instead
+ * of being freed, so steady-state capture does not allocate.
+ */
+class CpuFrame : public std::enable_shared_from_this<CpuFrame> {
+public:
+    static constexpr int MaxPlanes = 4;
+
+    QSize size() const { return m_key.size; }
+    QVideoFrameFormat::PixelFormat pixelFormat() const { return m_key.format; }
+    int planeCount() const { return m_planeCount; }
+    const uchar* bits(int plane) const { return plane < m_planeCount ? m_planes[plane] : nullptr; }
+    int bytesPerLine(int plane) const { return plane < m_planeCount ? m_bytesPerLine[plane] : 0; }
+    qsizetype planeBytes(int plane) const { return plane < m_planeCount ? m_planeBytes[plane] : 0; }
+    qsizetype totalBytes() const { return m_totalBytes; }
+
+    /**
+     * @brief Presentation start time of the source frame (microseconds)
+     */
+    qint64 startTime() const { return m_startTime; }
+
+    /**
+     * @brief YUV matrix of the source frame (ColorSpace_Undefined if the source did not say)
+     */
+    QVideoFrameFormat::ColorSpace colorSpace() const { return m_colorSpace; }
+
+    /**
+     * @brief View the frame as a QImage
+     *
+     * RGB-family formats are wrapped without copying (the image keeps this
+     * frame alive). YUV formats are converted, which allocates.
+     */
+    QImage toImage() const;
+
+private:
+    friend class FramePool;
+
+    FrameKey m_key;
+    int m_planeCount{0};
+    const uchar* m_planes[MaxPlanes]{};
+    int m_bytesPerLine[MaxPlanes]{};
+    qsizetype m_planeBytes[MaxPlanes]{};
+    qsizetype m_totalBytes{0};
+    qint64 m_startTime{-1};
+    QVideoFrameFormat::ColorSpace m_colorSpace{QVideoFrameFormat::ColorSpace_Undefined};
+
+    // Pool storage (returned to the pool on destruction)
+    std::unique_ptr<uchar[]> m_storage;
+    qsizetype m_capacity{0};
+};
+
+using FrameRef = std::shared_ptr<const CpuFrame>;
+
+/**
+ * @brief Process-wide reference-counted frame arena (Singleton)
+ *
+ * Replaces per-consumer map()+copy of QVideoFrame with a single mapping
+ * per decoded frame. Consumers (snapshots, analytics, software rendering)
+ * share the resulting FrameRef read-only.
+ *
+ * Buffers are keyed by resolution and pixel format. Idle buffers are kept
+ * up to maxIdleBytes() and released oldest-first beyond that.
+ *
+ * Usage:
+ *   FrameRef ref = FramePool::instance().map(videoFrame);
+ *   if (ref) analyze(ref->bits(0), ref->bytesPerLine(0));
+ */
+class FramePool {
+public:
+    struct Stats {
+        quint64 hits{0};            // Acquisitions served from an idle buffer
+        quint64 misses{0};          // Acquisitions that had to allocate
+        qint64 bytesResident{0};    // Idle + in-use bytes owned by the pool
+        qint64 bytesInUse{0};       // Bytes referenced by live FrameRefs
+        int idleBuffers{0};
+    };
+
+    static FramePool& instance();
+
+    // Prevent copying
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    /**
+     * @brief Map a frame once and copy its planes into pooled storage
+     * @return Shared read-only frame, or nullptr if the frame cannot be mapped
+     */
+    FrameRef map(const QVideoFrame& frame);
+
+    /**
+     * @brief Get pool statistics
+     */
+    Stats stats() const;
+
+    /**
+     * @brief Cap on idle (unreferenced) bytes kept for reuse
+     */
+    void setMaxIdleBytes(qint64 bytes);
+    qint64 maxIdleBytes() const;
+
+    /**
+     * @brief Release idle buffers down to the given byte count
+     */
+    void trim(qint64 keepIdleBytes = 0);
+
+private:
+    FramePool();
+    ~FramePool() = default;
+
+    struct IdleBuffer {
+        std::unique_ptr<uchar[]> storage;
+        qsizetype capacity{0};
+    };
+
+    // Shared with FrameRef deleters so frames may outlive the singleton at exit
+    struct State {
+        mutable QMutex mutex;
+        QHash<FrameKey, std::vector<IdleBuffer>> idle;
+        std::vector<FrameKey> idleOrder;  // Oldest first, for trimming
+        qint64 idleBytes{0};
+        qint64 maxIdleBytes{64 * 1024 * 1024};
+
+        std::atomic<quint64> hits{0};
+        std::atomic<quint64> misses{0};
+        std::atomic<qint64> bytesInUse{0};
+
+        void release(const FrameKey& key, std::unique_ptr<uchar[]> storage, qsizetype capacity);
+        void trimLocked(qint64 keepIdleBytes);
+    };
+
+    std::shared_ptr<State> m_state;
+};
+
+} // namespace MCM
+
+#endif // FRAMEPOOL_H
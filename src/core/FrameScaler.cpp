@@ -0,0 +1,365 @@
+#include "FrameScaler.h"
+#include <QtGlobal>
+#include <algorithm>
+#include <iterator>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MCM_SCALER_SSE2 1
+#include <emmintrin.h>
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+#define MCM_SCALER_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace MCM {
+
+namespace {
+
+/**
+ * @brief Limited-range YUV -> RGB matrix in 6-bit fixed point
+ *
+ * Small enough for 16-bit lanes: the only sums that can overflow are
+ * bright blues/reds that clamp to 255 anyway, so saturating adds are exact.
+ */
+struct Coefficients {
+    qint16 y;    // 1.164
+    qint16 rv;
+    qint16 gu;
+    qint16 gv;
+    qint16 bu;
+};
+
+constexpr Coefficients BT601{75, 102, -25, -52, 129};
+constexpr Coefficients BT709{75, 115, -14, -34, 135};
+constexpr Coefficients BT2020{75, 107, -12, -42, 137};
+
+/**
+ * @brief Matrix of the frame's colour space; by height when the source did not say
+ */
+const Coefficients& coefficients(QVideoFrameFormat::ColorSpace colorSpace, int height) {
+    switch (colorSpace) {
+    case QVideoFrameFormat::ColorSpace_BT601: return BT601;
+    case QVideoFrameFormat::ColorSpace_BT709: return BT709;
+    case QVideoFrameFormat::ColorSpace_BT2020: return BT2020;
+    default: return height >= 720 ? BT709 : BT601;
+    }
+}
+
+/**
+ * @brief Where Y, U and V of a pixel sit
+ *
+ * Y of source column x is byte x * yStep + yOffset of its row; U/V are
+ * byte (x / 2) * chromaStep + offset of their (possibly subsampled) row.
+ */
+struct YuvLayout {
+    int planes[3];
+    int chromaRowShift;
+    int yStep;
+    int yOffset;
+    int chromaStep;
+    int uOffset;
+    int vOffset;
+};
+
+bool yuvLayout(QVideoFrameFormat::PixelFormat format, YuvLayout* layout) {
+    switch (format) {
+    case QVideoFrameFormat::Format_NV12:
+        *layout = {{0, 1, 1}, 1, 1, 0, 2, 0, 1};
+        return true;
+    case QVideoFrameFormat::Format_NV21:
+        *layout = {{0, 1, 1}, 1, 1, 0, 2, 1, 0};
+        return true;
+    case QVideoFrameFormat::Format_YUV420P:
+        *layout = {{0, 1, 2}, 1, 1, 0, 1, 0, 0};
+        return true;
+    case QVideoFrameFormat::Format_YV12:
+        *layout = {{0, 2, 1}, 1, 1, 0, 1, 0, 0};
+        return true;
+    case QVideoFrameFormat::Format_YUV422P:
+        *layout = {{0, 1, 2}, 0, 1, 0, 1, 0, 0};
+        return true;
+    case QVideoFrameFormat::Format_YUYV:
+        *layout = {{0, 0, 0}, 0, 2, 0, 4, 1, 3};
+        return true;
+    case QVideoFrameFormat::Format_UYVY:
+        *layout = {{0, 0, 0}, 0, 2, 1, 4, 0, 2};
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Byte of R, G and B within a 4-byte pixel (memory order)
+ */
+bool rgbLayout(QVideoFrameFormat::PixelFormat format, int* offsets) {
+    switch (format) {
+    case QVideoFrameFormat::Format_BGRA8888:
+    case QVideoFrameFormat::Format_BGRA8888_Premultiplied:
+    case QVideoFrameFormat::Format_BGRX8888:
+        offsets[0] = 2; offsets[1] = 1; offsets[2] = 0;
+        return true;
+    case QVideoFrameFormat::Format_RGBA8888:
+    case QVideoFrameFormat::Format_RGBX8888:
+        offsets[0] = 0; offsets[1] = 1; offsets[2] = 2;
+        return true;
+    case QVideoFrameFormat::Format_ARGB8888:
+    case QVideoFrameFormat::Format_ARGB8888_Premultiplied:
+    case QVideoFrameFormat::Format_XRGB8888:
+        offsets[0] = 1; offsets[1] = 2; offsets[2] = 3;
+        return true;
+    case QVideoFrameFormat::Format_ABGR8888:
+    case QVideoFrameFormat::Format_XBGR8888:
+        offsets[0] = 3; offsets[1] = 2; offsets[2] = 1;
+        return true;
+    default:
+        return false;
+    }
+}
+
+// out[i] = 0xffRRGGBB of (y[i], u[i], v[i])
+using ConvertRowFn = void (*)(const uchar* y, const uchar* u, const uchar* v, quint32* out, int count,
+                              const Coefficients& k);
+
+inline quint32 clampChannel(int value) {
+    return static_cast<quint32>(qBound(0, value >> 6, 255));
+}
+
+void convertRowScalar(const uchar* y, const uchar* u, const uchar* v, quint32* out, int count,
+                      const Coefficients& k) {
+    for (int i = 0; i < count; ++i) {
+        const int yy = k.y * (int(y[i]) - 16) + 32;
+        const int uu = int(u[i]) - 128;
+        const int vv = int(v[i]) - 128;
+        out[i] = 0xff000000u
+            | clampChannel(yy + k.rv * vv) << 16
+            | clampChannel(yy + k.gu * uu + k.gv * vv) << 8
+            | clampChannel(yy + k.bu * uu);
+    }
+}
+
+#ifdef MCM_SCALER_SSE2
+void convertRowSse2(const uchar* y, const uchar* u, const uchar* v, quint32* out, int count,
+                    const Coefficients& k) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha = _mm_set1_epi8(static_cast<char>(0xff));
+    const __m128i c16 = _mm_set1_epi16(16);
+    const __m128i c128 = _mm_set1_epi16(128);
+    const __m128i round = _mm_set1_epi16(32);
+    const __m128i ky = _mm_set1_epi16(k.y);
+    const __m128i krv = _mm_set1_epi16(k.rv);
+    const __m128i kgu = _mm_set1_epi16(k.gu);
+    const __m128i kgv = _mm_set1_epi16(k.gv);
+    const __m128i kbu = _mm_set1_epi16(k.bu);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i y8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + i));
+        const __m128i u8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + i));
+        const __m128i v8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + i));
+        const __m128i yy = _mm_adds_epi16(
+            _mm_mullo_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(y8, zero), c16), ky), round);
+        const __m128i uu = _mm_sub_epi16(_mm_unpacklo_epi8(u8, zero), c128);
+        const __m128i vv = _mm_sub_epi16(_mm_unpacklo_epi8(v8, zero), c128);
+
+        const __m128i r = _mm_srai_epi16(_mm_adds_epi16(yy, _mm_mullo_epi16(vv, krv)), 6);
+        const __m128i g = _mm_srai_epi16(
+            _mm_adds_epi16(yy, _mm_add_epi16(_mm_mullo_epi16(uu, kgu), _mm_mullo_epi16(vv, kgv))), 6);
+        const __m128i b = _mm_srai_epi16(_mm_adds_epi16(yy, _mm_mullo_epi16(uu, kbu)), 6);
+
+        // Bytes B, G, R, 0xff per pixel = 0xffRRGGBB little-endian
+        const __m128i bg = _mm_unpacklo_epi8(_mm_packus_epi16(b, zero), _mm_packus_epi16(g, zero));
+        const __m128i ra = _mm_unpacklo_epi8(_mm_packus_epi16(r, zero), alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi16(bg, ra));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 4), _mm_unpackhi_epi16(bg, ra));
+    }
+    convertRowScalar(y + i, u + i, v + i, out + i, count - i, k);
+}
+#endif
+
+#ifdef MCM_SCALER_NEON
+void convertRowNeon(const uchar* y, const uchar* u, const uchar* v, quint32* out, int count,
+                    const Coefficients& k) {
+    const int16x8_t c16 = vdupq_n_s16(16);
+    const int16x8_t c128 = vdupq_n_s16(128);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const int16x8_t yy = vmulq_n_s16(
+            vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(y + i))), c16), k.y);
+        const int16x8_t uu = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(u + i))), c128);
+        const int16x8_t vv = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(v + i))), c128);
+
+        uint8x8x4_t pixels;
+        // Rounding, saturating narrow: >> 6 and clamp to 0..255 in one step
+        pixels.val[0] = vqrshrun_n_s16(vqaddq_s16(yy, vmulq_n_s16(uu, k.bu)), 6);
+        pixels.val[1] = vqrshrun_n_s16(
+            vqaddq_s16(yy, vaddq_s16(vmulq_n_s16(uu, k.gu), vmulq_n_s16(vv, k.gv))), 6);
+        pixels.val[2] = vqrshrun_n_s16(vqaddq_s16(yy, vmulq_n_s16(vv, k.rv)), 6);
+        pixels.val[3] = vdup_n_u8(0xff);
+        vst4_u8(reinterpret_cast<uint8_t*>(out + i), pixels);
+    }
+    convertRowScalar(y + i, u + i, v + i, out + i, count - i, k);
+}
+#endif
+
+struct Kernel {
+    ConvertRowFn convertRow;
+    const char* name;
+};
+
+const Kernel& kernel() {
+#if defined(MCM_SCALER_SSE2)
+    static const Kernel selected{convertRowSse2, "sse2"};
+#elif defined(MCM_SCALER_NEON)
+    static const Kernel selected{convertRowNeon, "neon"};
+#else
+    static const Kernel selected{convertRowScalar, "scalar"};
+#endif
+    return selected;
+}
+
+/**
+ * @brief Source sample of each output position (pixel centres, nearest neighbour)
+ */
+int sourceIndex(int index, int sourceLength, int targetLength) {
+    const qint64 scaled = (2 * static_cast<qint64>(index) + 1) * sourceLength / (2 * static_cast<qint64>(targetLength));
+    return static_cast<int>(qMin<qint64>(scaled, sourceLength - 1));
+}
+
+} // namespace
+
+bool FrameScaler::supports(QVideoFrameFormat::PixelFormat format) {
+    YuvLayout layout;
+    int offsets[3];
+    return yuvLayout(format, &layout) || rgbLayout(format, offsets);
+}
+
+const char* FrameScaler::kernelName() {
+    return kernel().name;
+}
+
+bool FrameScaler::prepare(const CpuFrame& frame, const QSize& targetSize) {
+    const FrameKey key{frame.size(), frame.pixelFormat()};
+    if (!(key == m_source) || targetSize != m_target) {
+        m_source = key;
+        m_target = targetSize;
+        m_valid = buildTables();
+    }
+    if (!m_valid) {
+        return false;
+    }
+
+    // Strides and plane sizes can change between frames of the same size:
+    // check on every frame that the extreme sampled bytes lie inside their planes
+    auto fits = [&frame](int plane, int lastRow, int lastByte) {
+        const int stride = frame.bytesPerLine(plane);
+        return frame.bits(plane) && stride > lastByte
+            && frame.planeBytes(plane) >= static_cast<qsizetype>(lastRow) * stride + lastByte + 1;
+    };
+    const int lastRow = m_rows.back();
+    if (m_rgb) {
+        return fits(0, lastRow, m_yIndex.back() + 3);
+    }
+    const int lastChromaRow = lastRow >> m_chromaRowShift;
+    return fits(m_planes[0], lastRow, m_yIndex.back())
+        && fits(m_planes[1], lastChromaRow, m_uIndex.back())
+        && fits(m_planes[2], lastChromaRow, m_vIndex.back());
+}
+
+bool FrameScaler::buildTables() {
+    const int srcWidth = m_source.size.width();
+    const int srcHeight = m_source.size.height();
+    const int width = m_target.width();
+    const int height = m_target.height();
+    if (srcWidth <= 0 || srcHeight <= 0 || width <= 0 || height <= 0) {
+        return false;
+    }
+
+    YuvLayout layout{};
+    m_rgb = rgbLayout(m_source.format, m_rgbOffsets);
+    if (m_rgb) {
+        layout = {{0, 0, 0}, 0, 4, 0, 0, 0, 0};
+    } else if (!yuvLayout(m_source.format, &layout)) {
+        return false;
+    }
+    std::copy(std::begin(layout.planes), std::end(layout.planes), std::begin(m_planes));
+    m_chromaRowShift = layout.chromaRowShift;
+
+    m_rows.resize(height);
+    for (int row = 0; row < height; ++row) {
+        m_rows[row] = sourceIndex(row, srcHeight, height);
+    }
+    m_yIndex.resize(width);
+    m_uIndex.resize(width);
+    m_vIndex.resize(width);
+    for (int column = 0; column < width; ++column) {
+        const int x = sourceIndex(column, srcWidth, width);
+        m_yIndex[column] = x * layout.yStep + layout.yOffset;
+        m_uIndex[column] = (x / 2) * layout.chromaStep + layout.uOffset;
+        m_vIndex[column] = (x / 2) * layout.chromaStep + layout.vOffset;
+    }
+    m_y.resize(width);
+    m_u.resize(width);
+    m_v.resize(width);
+    return true;
+}
+
+bool FrameScaler::scale(const CpuFrame& frame, QImage& target) {
+    if (target.isNull() || target.format() != QImage::Format_RGB32
+        || !prepare(frame, target.size())) {
+        return false;
+    }
+
+    const int width = m_target.width();
+    const int height = m_target.height();
+
+    if (m_rgb) {
+        const uchar* base = frame.bits(0);
+        const int stride = frame.bytesPerLine(0);
+        const int r = m_rgbOffsets[0];
+        const int g = m_rgbOffsets[1];
+        const int b = m_rgbOffsets[2];
+        for (int row = 0; row < height; ++row) {
+            const uchar* src = base + static_cast<qsizetype>(m_rows[row]) * stride;
+            quint32* out = reinterpret_cast<quint32*>(target.scanLine(row));
+            for (int column = 0; column < width; ++column) {
+                const uchar* pixel = src + m_yIndex[column];
+                out[column] = 0xff000000u | quint32(pixel[r]) << 16 | quint32(pixel[g]) << 8 | pixel[b];
+            }
+        }
+        return true;
+    }
+
+    const Coefficients& k = coefficients(frame.colorSpace(), m_source.size.height());
+    const ConvertRowFn convertRow = kernel().convertRow;
+    const uchar* yPlane = frame.bits(m_planes[0]);
+    const uchar* uPlane = frame.bits(m_planes[1]);
+    const uchar* vPlane = frame.bits(m_planes[2]);
+    const int yStride = frame.bytesPerLine(m_planes[0]);
+    const int uStride = frame.bytesPerLine(m_planes[1]);
+    const int vStride = frame.bytesPerLine(m_planes[2]);
+    const int* yIndex = m_yIndex.data();
+    const int* uIndex = m_uIndex.data();
+    const int* vIndex = m_vIndex.data();
+    uchar* ys = m_y.data();
+    uchar* us = m_u.data();
+    uchar* vs = m_v.data();
+
+    for (int row = 0; row < height; ++row) {
+        const int sourceRow = m_rows[row];
+        const int chromaRow = sourceRow >> m_chromaRowShift;
+        const uchar* yRow = yPlane + static_cast<qsizetype>(sourceRow) * yStride;
+        const uchar* uRow = uPlane + static_cast<qsizetype>(chromaRow) * uStride;
+        const uchar* vRow = vPlane + static_cast<qsizetype>(chromaRow) * vStride;
+
+        // Gather the shown samples into L1-resident scratch, then convert the row
+        for (int column = 0; column < width; ++column) {
+            ys[column] = yRow[yIndex[column]];
+            us[column] = uRow[uIndex[column]];
+            vs[column] = vRow[vIndex[column]];
+        }
+        convertRow(ys, us, vs, reinterpret_cast<quint32*>(target.scanLine(row)), width, k);
+    }
+    return true;
+}
+
+} // namespace MCM
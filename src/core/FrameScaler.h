@@ -0,0 +1,78 @@
+#ifndef FRAMESCALER_H
+#define FRAMESCALER_H
+
+#include <QImage>
+#include <QSize>
+#include <QVideoFrameFormat>
+#include <vector>
+#include "core/FramePool.h"
+
+namespace MCM {
+
+/**
+ * @brief Fused colour conversion and scaling of CPU frames for software rendering
+ *
+ * Turns an NV12/NV21, YUV420P/YV12/YUV422P, YUYV/UYVY or 32-bit RGB frame
+ * straight into an RGB32 image of the target size, in one pass over the
+ * output: each output row samples its source pixels through precomputed
+ * column tables (nearest neighbour, like Qt::FastTransformation) and
+ * converts them 8 at a time (SSE2 on x86, NEON on ARM). There is no
+ * full-resolution intermediate image, and only the source pixels that are
+ * shown are read - a 1080p frame shown in a 480x270 tile touches one
+ * sixteenth of it.
+ *
+ * YUV is taken as limited range, with the BT.601, BT.709 or BT.2020
+ * matrix of the frame's colour space. Frames that do not carry one get
+ * BT.709 from 720 lines up and BT.601 below, which is what cameras and
+ * the FFmpeg decoders produce.
+ *
+ * Tables and row scratch are kept while the source and target shapes stay
+ * the same; strides and plane sizes are checked on every frame. One
+ * instance per render target; not thread-safe.
+ *
+ * Usage:
+ *   QImage tile(480, 270, QImage::Format_RGB32);          // Reused every frame
+ *   if (!scaler.scale(*frameRef, tile)) tile = frameRef->toImage().scaled(...);
+ */
+class FrameScaler {
+public:
+    /**
+     * @brief Whether scale() handles this pixel format
+     */
+    static bool supports(QVideoFrameFormat::PixelFormat format);
+
+    /**
+     * @brief Conversion kernels in use ("sse2", "neon" or "scalar")
+     */
+    static const char* kernelName();
+
+    /**
+     * @brief Convert and scale @p frame to fill @p target
+     * @param target Format_RGB32 image of the output size (pixels are overwritten)
+     * @return false if the format is unsupported or the frame's planes are too small
+     */
+    bool scale(const CpuFrame& frame, QImage& target);
+
+private:
+    bool prepare(const CpuFrame& frame, const QSize& targetSize);
+    bool buildTables();
+
+    FrameKey m_source;
+    QSize m_target;
+    bool m_valid{false};                  // Tables built for m_source / m_target
+    bool m_rgb{false};                    // 32-bit RGB source: plain gather, no conversion
+    int m_planes[3]{};                    // Planes holding Y, U, V (RGB: plane 0)
+    int m_chromaRowShift{0};              // Chroma row = source row >> shift
+    int m_rgbOffsets[3]{};                // RGB source: byte of R, G, B within a pixel
+    std::vector<int> m_rows;              // Source row of each output row
+    std::vector<int> m_yIndex;            // Byte offsets within the sampled rows, per output column
+    std::vector<int> m_uIndex;
+    std::vector<int> m_vIndex;
+    std::vector<uchar> m_y;               // Gathered samples of the current output row
+    std::vector<uchar> m_u;
+    std::vector<uchar> m_v;
+};
+
+} // namespace MCM
+
+#endif // FRAMESCALER_H
@@ -0,0 +1,104 @@
+#ifndef LATESTVALUEMAILBOX_H
+#define LATESTVALUEMAILBOX_H
+
+#include <QObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <atomic>
+#include <functional>
+#include <optional>
+#include <utility>
+
+namespace MCM {
+
+/**
+ * @brief Latest-value-wins handoff to another thread's event loop
+ *
+ * post() parks the value and queues at most one delivery to the context
+ * object's thread; values posted before that delivery runs replace each
+ * other. A slow or stalled receiver therefore costs one pending meta-call,
+ * never a queue that grows with the frame rate. For consumers that only
+ * care about the newest frame, score or state.
+ *
+ * Owned by (a member of) the context object: deliveries still queued when
+ * the context is destroyed are dropped by Qt.
+ *
+ * Usage:
+ *   LatestValueMailbox<QVideoFrame> m_mailbox{this, [this](QVideoFrame f) { process(f); }};
+ *   m_mailbox.post(frame);   // Any thread
+ */
+template <typename T>
+class LatestValueMailbox {
+public:
+    using Handler = std::function<void(T)>;
+
+    LatestValueMailbox(QObject* context, Handler handler)
+        : m_context(context)
+        , m_handler(std::move(handler))
+    {
+    }
+
+    // Prevent copying
+    LatestValueMailbox(const LatestValueMailbox&) = delete;
+    LatestValueMailbox& operator=(const LatestValueMailbox&) = delete;
+
+    /**
+     * @brief Offer a value (thread-safe, never blocks on the receiver)
+     * @return true if an undelivered value was replaced
+     */
+    bool post(T value) {
+        bool replaced = false;
+        bool schedule = false;
+        {
+            QMutexLocker locker(&m_mutex);
+            replaced = m_value.has_value();
+            m_value = std::move(value);
+            schedule = !m_queued;
+            m_queued = true;
+        }
+        if (replaced) {
+            m_superseded.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (schedule) {
+            QMetaObject::invokeMethod(m_context, [this]() { deliver(); }, Qt::QueuedConnection);
+        }
+        return replaced;
+    }
+
+    /**
+     * @brief Drop the undelivered value, if any
+     */
+    void clear() {
+        QMutexLocker locker(&m_mutex);
+        m_value.reset();
+    }
+
+    /**
+     * @brief Values replaced before they were delivered
+     */
+    quint64 superseded() const { return m_superseded.load(std::memory_order_relaxed); }
+
+private:
+    void deliver() {
+        std::optional<T> value;
+        {
+            QMutexLocker locker(&m_mutex);
+            value.swap(m_value);
+            m_queued = false;
+        }
+        if (value) {
+            m_handler(std::move(*value));
+        }
+    }
+
+    QObject* m_context;
+    Handler m_handler;
+    QMutex m_mutex;
+    std::optional<T> m_value;
+    bool m_queued{false};
+    std::atomic<quint64> m_superseded{0};
+};
+
+} // namespace MCM
+
+#endif // LATESTVALUEMAILBOX_H
@@ -0,0 +1,268 @@
+#include "MemoryGovernor.h"
+#include "FramePool.h"
+#include "SnapshotService.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QThread>
+#include <QDebug>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+#ifdef Q_OS_DARWIN
+#include <mach/mach.h>
+#endif
+
+namespace MCM {
+
+namespace {
+
+constexpr qint64 MB = 1024 * 1024;
+
+} // namespace
+
+MemoryGovernor& MemoryGovernor::instance() {
+    static MemoryGovernor instance;
+    return instance;
+}
+
+MemoryGovernor::MemoryGovernor()
+    : QObject(nullptr)
+{
+    // Checks run on the GUI thread whoever touches the governor first
+    if (QCoreApplication* app = QCoreApplication::instance()) {
+        moveToThread(app->thread());
+        m_timer.moveToThread(app->thread());
+    }
+    connect(&m_timer, &QTimer::timeout, this, &MemoryGovernor::rebalance);
+    registerSharedCaches();
+}
+
+void MemoryGovernor::registerSharedCaches() {
+    // Idle frame pool buffers are a pure reuse cache; frames in use are not the pool's to free
+    const qint64 poolIdleCap = FramePool::instance().maxIdleBytes();
+    addConsumer({"framepool", -1,
+        []() { return FramePool::instance().stats().bytesResident; },
+        []() { return FramePool::instance().stats().bytesInUse; },
+        [poolIdleCap](qint64 limit) {
+            FramePool& pool = FramePool::instance();
+            pool.setMaxIdleBytes(limit < 0 ? poolIdleCap
+                                           : qBound<qint64>(0, limit - pool.stats().bytesInUse, poolIdleCap));
+        }});
+
+    // Thumbnails are re-encoded on the next request
+    addConsumer({"snapshots", -1,
+        []() { return SnapshotService::instance().stats().cacheBytes; },
+        nullptr,
+        [](qint64 limit) { SnapshotService::instance().setMemoryLimit(limit); }});
+}
+
+void MemoryGovernor::configure(const MemoryConfig& config) {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_config = config;
+    }
+    qDebug() << "MemoryGovernor: Budget"
+             << (config.budgetMB > 0 ? QString("%1 MB").arg(config.budgetMB) : QString("none"))
+             << "- keep" << config.minAvailableMB << "MB available, check every" << config.intervalMs << "ms";
+
+    const bool active = config.budgetMB > 0 || config.minAvailableMB > 0;
+    if (active) {
+        m_timer.start(config.intervalMs);
+    } else {
+        m_timer.stop();
+        QMutexLocker locker(&m_mutex);
+        relaxLocked(true);
+        m_pressure = false;
+    }
+}
+
+MemoryConfig MemoryGovernor::processShare(const MemoryConfig& config, int processes) {
+    MemoryConfig share = config;
+    if (share.budgetMB > 0 && processes > 1) {
+        share.budgetMB = qMax(1, share.budgetMB / processes);
+    }
+    return share;
+}
+
+int MemoryGovernor::addConsumer(Consumer consumer) {
+    QMutexLocker locker(&m_mutex);
+    const int id = m_nextId++;
+    Entry entry;
+    entry.consumer = std::move(consumer);
+    m_consumers.insert(id, std::move(entry));
+    return id;
+}
+
+void MemoryGovernor::removeConsumer(int id) {
+    QMutexLocker locker(&m_mutex);  // Callbacks are only called under the lock
+    m_consumers.remove(id);
+}
+
+void MemoryGovernor::setSlotPriority(int slotId, Priority priority) {
+    QMutexLocker locker(&m_mutex);
+    m_priorities.insert(slotId, priority);
+}
+
+MemoryGovernor::Usage MemoryGovernor::usage() const {
+    QMutexLocker locker(&m_mutex);
+    Usage usage;
+    usage.budgetBytes = m_config.budgetMB * MB;
+    usage.usedBytes = m_usedBytes;
+    usage.rssBytes = m_rssBytes;
+    usage.availableBytes = m_availableBytes;
+    usage.pressure = m_pressure;
+    usage.trims = m_trims;
+    for (const Entry& entry : m_consumers) {
+        usage.consumers.append(ConsumerUsage{entry.consumer.name, entry.consumer.slotId, entry.bytes, entry.limit});
+    }
+    return usage;
+}
+
+void MemoryGovernor::rebalance() {
+    bool changed = false;
+    bool pressure = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        const qint64 budget = m_config.budgetMB * MB;
+        const qint64 minAvailable = m_config.minAvailableMB * MB;
+
+        qint64 used = 0;
+        for (Entry& entry : m_consumers) {
+            entry.bytes = qMax<qint64>(0, entry.consumer.usage());
+            entry.minimum = entry.consumer.minimum ? qBound<qint64>(0, entry.consumer.minimum(), entry.bytes) : 0;
+            used += entry.bytes;
+        }
+        m_usedBytes = used;
+        m_rssBytes = residentBytes();
+        m_availableBytes = minAvailable > 0 ? availableSystemBytes() : -1;
+
+        // Bytes to give back: down to TARGET_PERCENT of the budget, and enough
+        // to get the system a quarter above its minimum again
+        qint64 excess = 0;
+        if (budget > 0 && used > budget) {
+            excess = used - budget * TARGET_PERCENT / 100;
+        }
+        if (m_availableBytes >= 0 && m_availableBytes < minAvailable) {
+            excess = qMax(excess, minAvailable + minAvailable / 4 - m_availableBytes);
+        }
+
+        pressure = excess > 0;
+        if (pressure) {
+            m_calmChecks = 0;
+            m_trims++;
+            shedLocked(excess);
+        } else {
+            const bool belowBudget = budget <= 0 || used < budget * RELAX_PERCENT / 100;
+            const bool systemFine = m_availableBytes < 0 || m_availableBytes > 2 * minAvailable;
+            if (belowBudget && systemFine) {
+                relaxLocked(++m_calmChecks >= RELEASE_CHECKS);
+            } else {
+                m_calmChecks = 0;  // Close to the budget: hold the caps where they are
+            }
+        }
+
+        changed = pressure != m_pressure;
+        m_pressure = pressure;
+        if (changed) {
+            if (pressure) {
+                qWarning() << "MemoryGovernor: Trimming -" << used / MB << "MB in buffers and caches, budget"
+                           << budget / MB << "MB, available" << (m_availableBytes < 0 ? -1 : m_availableBytes / MB)
+                           << "MB, RSS" << (m_rssBytes < 0 ? -1 : m_rssBytes / MB) << "MB";
+            } else {
+                qDebug() << "MemoryGovernor: Back within budget -" << used / MB << "MB";
+            }
+        }
+    }
+    if (changed) {
+        emit pressureChanged(pressure);
+    }
+}
+
+int MemoryGovernor::levelOf(const Entry& entry) const {
+    if (entry.consumer.slotId < 0) {
+        return 0;  // Shared caches go first
+    }
+    return 1 + static_cast<int>(m_priorities.value(entry.consumer.slotId, Priority::Normal));
+}
+
+void MemoryGovernor::shedLocked(qint64 excess) {
+    constexpr int LEVELS = 1 + static_cast<int>(Priority::High) + 1;
+    for (int level = 0; level < LEVELS && excess > 0; ++level) {
+        qint64 reducible = 0;
+        for (const Entry& entry : m_consumers) {
+            if (levelOf(entry) == level) {
+                reducible += entry.bytes - entry.minimum;
+            }
+        }
+        if (reducible <= 0) {
+            continue;
+        }
+        // Proportional to what each holds above its minimum
+        const qint64 take = qMin(excess, reducible);
+        for (Entry& entry : m_consumers) {
+            const qint64 spare = entry.bytes - entry.minimum;
+            if (levelOf(entry) != level || spare <= 0) {
+                continue;
+            }
+            const qint64 cut = static_cast<qint64>(static_cast<double>(spare) * take / reducible);
+            const qint64 limit = entry.bytes - cut;
+            if (entry.limit < 0 || limit < entry.limit) {
+                entry.limit = limit;
+                entry.consumer.setLimit(limit);
+            }
+        }
+        excess -= take;
+    }
+}
+
+void MemoryGovernor::relaxLocked(bool release) {
+    for (Entry& entry : m_consumers) {
+        if (entry.limit < 0) {
+            continue;
+        }
+        entry.limit = release ? -1 : entry.limit + qMax(entry.limit / 4, MB);
+        entry.consumer.setLimit(entry.limit);
+    }
+    if (release) {
+        m_calmChecks = 0;
+    }
+}
+
+qint64 MemoryGovernor::residentBytes() {
+#ifdef Q_OS_LINUX
+    QFile statm("/proc/self/statm");
+    if (statm.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1) {
+            return fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+        }
+    }
+#elif defined(Q_OS_DARWIN)
+    mach_task_basic_info info{};
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                  reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS) {
+        return static_cast<qint64>(info.resident_size);
+    }
+#endif
+    return -1;
+}
+
+qint64 MemoryGovernor::availableSystemBytes() {
+#ifdef Q_OS_LINUX
+    QFile meminfo("/proc/meminfo");
+    if (meminfo.open(QIODevice::ReadOnly)) {
+        // procfs reports size 0: read it in one go rather than by line
+        for (const QByteArray& line : meminfo.readAll().split('\n')) {
+            if (line.startsWith("MemAvailable:")) {
+                const QList<QByteArray> fields = line.simplified().split(' ');
+                return fields.size() > 1 ? fields[1].toLongLong() * 1024 : -1;  // kB
+            }
+        }
+    }
+#endif
+    return -1;
+}
+
+} // namespace MCM
@@ -0,0 +1,167 @@
+#ifndef MEMORYGOVERNOR_H
+#define MEMORYGOVERNOR_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QTimer>
+#include <functional>
+#include "core/Config.h"
+
+namespace MCM {
+
+/**
+ * @brief One process-wide memory budget for frame buffers, pre-roll rings and caches (Singleton)
+ *
+ * Every buffer that can hold a lot of frame data registers as a consumer:
+ * how many bytes it holds, how many it needs to keep working, and a call
+ * that caps it. Once per interval the governor adds them up. Over
+ * memory.budgetMB - or with less than memory.minAvailableMB left on the
+ * system - it sheds the excess: shared caches first (the frame pool's idle
+ * buffers, snapshot thumbnails), then slots from the lowest priority up,
+ * so hidden tiles lose depth before visible ones and an expanded slot
+ * last. Within a priority the cut is proportional to what each consumer
+ * holds above its minimum. Caps are loosened step by step once usage is
+ * well below the budget again, and lifted after a calm period.
+ *
+ * Callbacks run on the governor's thread (the GUI thread) under its lock:
+ * they must be quick and must not call back into the governor.
+ *
+ * Usage:
+ *   const int id = MemoryGovernor::instance().addConsumer({"preroll", slotId,
+ *       [this] { return m_bytes.load(); }, nullptr,
+ *       [this](qint64 limit) { m_limit.store(limit); }});
+ *   ...
+ *   MemoryGovernor::instance().removeConsumer(id);
+ */
+class MemoryGovernor : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Slot priority; lower ones are trimmed first
+     */
+    enum class Priority {
+        Low,        // Not on screen
+        Normal,     // Shown in the grid
+        High        // Expanded / active
+    };
+
+    struct Consumer {
+        QString name;                          // "framebuffer", "preroll", ...
+        int slotId{-1};                        // -1 = shared cache, trimmed before any slot
+        std::function<qint64()> usage;         // Bytes held now
+        std::function<qint64()> minimum;       // Bytes it needs to keep working (null = 0)
+        std::function<void(qint64)> setLimit;  // Stay under this many bytes (-1 = own limits only)
+    };
+
+    struct ConsumerUsage {
+        QString name;
+        int slotId{-1};
+        qint64 bytes{0};
+        qint64 limit{-1};          // Cap set by the governor (-1 = none)
+    };
+
+    struct Usage {
+        qint64 budgetBytes{0};     // 0 = no fixed budget
+        qint64 usedBytes{0};       // Sum over the consumers at the last check
+        qint64 rssBytes{-1};       // Process resident set (-1 = unknown on this platform)
+        qint64 availableBytes{-1}; // System memory available (-1 = unknown / not checked)
+        bool pressure{false};      // Trimming at the last check
+        quint64 trims{0};          // Checks that had to trim
+        QList<ConsumerUsage> consumers;
+    };
+
+    static MemoryGovernor& instance();
+
+    // Prevent copying
+    MemoryGovernor(const MemoryGovernor&) = delete;
+    MemoryGovernor& operator=(const MemoryGovernor&) = delete;
+
+    /**
+     * @brief Apply budget and check interval (call from the GUI thread)
+     */
+    void configure(const MemoryConfig& config);
+
+    /**
+     * @brief This process's part of the budget when @p processes share the machine's
+     *
+     * Sharded mode: the UI and every worker get an equal part (at least 1 MB).
+     */
+    static MemoryConfig processShare(const MemoryConfig& config, int processes);
+
+    /**
+     * @brief Register a consumer
+     * @return Id for removeConsumer()
+     */
+    int addConsumer(Consumer consumer);
+
+    /**
+     * @brief Unregister; the callbacks are not called any more once this returns
+     */
+    void removeConsumer(int id);
+
+    /**
+     * @brief Set how a slot's consumers rank when trimming (default Normal)
+     */
+    void setSlotPriority(int slotId, Priority priority);
+
+    /**
+     * @brief Usage at the last check (thread-safe)
+     */
+    Usage usage() const;
+
+    /**
+     * @brief Check usage and trim or loosen caps now (the timer does this every interval)
+     */
+    void rebalance();
+
+signals:
+    /**
+     * @brief Trimming started (true) or stopped (false)
+     */
+    void pressureChanged(bool underPressure);
+
+private:
+    MemoryGovernor();
+    ~MemoryGovernor() override = default;
+
+    struct Entry {
+        Consumer consumer;
+        qint64 bytes{0};           // At the last check
+        qint64 minimum{0};
+        qint64 limit{-1};
+    };
+
+    int levelOf(const Entry& entry) const;
+    void shedLocked(qint64 excess);
+    void relaxLocked(bool release);
+    void registerSharedCaches();
+
+    static qint64 residentBytes();
+    static qint64 availableSystemBytes();
+
+    mutable QMutex m_mutex;
+    QMap<int, Entry> m_consumers;
+    QHash<int, Priority> m_priorities;
+    MemoryConfig m_config;
+    QTimer m_timer;
+    int m_nextId{1};
+    int m_calmChecks{0};           // Checks in a row well below the budget
+    bool m_pressure{false};
+    quint64 m_trims{0};
+    qint64 m_usedBytes{0};
+    qint64 m_rssBytes{-1};
+    qint64 m_availableBytes{-1};
+
+    static constexpr int TARGET_PERCENT = 90;   // Trim down to this share of the budget
+    static constexpr int RELAX_PERCENT = 75;    // Loosen caps below this share
+    static constexpr int RELEASE_CHECKS = 30;   // Calm checks before caps are lifted
+};
+
+} // namespace MCM
+
+#endif // MEMORYGOVERNOR_H
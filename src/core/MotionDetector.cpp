@@ -0,0 +1,426 @@
+#include "MotionDetector.h"
+#include "CaptureWorkerPool.h"
+#include "EventTrigger.h"
+#include "Telemetry.h"
+#include <QMutexLocker>
+#include <QThread>
+#include <QtAlgorithms>
+#include <QDebug>
+#include <cstdlib>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MCM_MOTION_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+// AVX2 is compiled per function and picked at runtime, so the build needs no -mavx2
+#define MCM_MOTION_AVX2 1
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MCM_MOTION_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace MCM {
+
+namespace {
+
+/**
+ * @brief Where luma sits in plane 0: every step-th byte, starting at offset
+ */
+struct LumaLayout {
+    int step{1};
+    int offset{0};
+};
+
+bool lumaLayout(QVideoFrameFormat::PixelFormat format, LumaLayout* layout) {
+    switch (format) {
+    case QVideoFrameFormat::Format_YUV420P:
+    case QVideoFrameFormat::Format_YUV422P:
+    case QVideoFrameFormat::Format_YV12:
+    case QVideoFrameFormat::Format_NV12:
+    case QVideoFrameFormat::Format_NV21:
+    case QVideoFrameFormat::Format_IMC1:
+    case QVideoFrameFormat::Format_IMC2:
+    case QVideoFrameFormat::Format_IMC3:
+    case QVideoFrameFormat::Format_IMC4:
+    case QVideoFrameFormat::Format_Y8:
+        *layout = {1, 0};
+        return true;
+    case QVideoFrameFormat::Format_YUYV:
+        *layout = {2, 0};
+        return true;
+    case QVideoFrameFormat::Format_UYVY:
+    case QVideoFrameFormat::Format_P010:   // Little-endian 16-bit: high byte
+    case QVideoFrameFormat::Format_P016:
+    case QVideoFrameFormat::Format_Y16:
+        *layout = {2, 1};
+        return true;
+    case QVideoFrameFormat::Format_AYUV:
+    case QVideoFrameFormat::Format_AYUV_Premultiplied:
+        *layout = {4, 1};
+        return true;
+    // RGB: green stands in for luma (it carries most of it)
+    case QVideoFrameFormat::Format_BGRA8888:
+    case QVideoFrameFormat::Format_BGRA8888_Premultiplied:
+    case QVideoFrameFormat::Format_BGRX8888:
+    case QVideoFrameFormat::Format_RGBA8888:
+    case QVideoFrameFormat::Format_RGBX8888:
+        *layout = {4, 1};
+        return true;
+    case QVideoFrameFormat::Format_ARGB8888:
+    case QVideoFrameFormat::Format_ARGB8888_Premultiplied:
+    case QVideoFrameFormat::Format_XRGB8888:
+    case QVideoFrameFormat::Format_ABGR8888:
+    case QVideoFrameFormat::Format_XBGR8888:
+        *layout = {4, 2};
+        return true;
+    default:
+        return false;
+    }
+}
+
+// sums[b] += sum of the masked bytes of row[16 * b .. 16 * b + 15]
+using SumBlocksFn = void (*)(const uchar* row, int blocks, const uchar* mask, quint32* sums);
+// Number of i with |a[i] - b[i]| > threshold
+using CountChangedFn = int (*)(const uchar* a, const uchar* b, int count, uchar threshold);
+
+void sumBlocksScalar(const uchar* row, int blocks, const uchar* mask, quint32* sums) {
+    for (int b = 0; b < blocks; ++b) {
+        const uchar* block = row + b * 16;
+        quint32 sum = 0;
+        for (int i = 0; i < 16; ++i) {
+            sum += block[i] & mask[i];
+        }
+        sums[b] += sum;
+    }
+}
+
+int countChangedScalar(const uchar* a, const uchar* b, int count, uchar threshold) {
+    int changed = 0;
+    for (int i = 0; i < count; ++i) {
+        changed += std::abs(int(a[i]) - int(b[i])) > threshold ? 1 : 0;
+    }
+    return changed;
+}
+
+#ifdef MCM_MOTION_SSE2
+void sumBlocksSse2(const uchar* row, int blocks, const uchar* mask, quint32* sums) {
+    const __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask));
+    const __m128i zero = _mm_setzero_si128();
+    for (int b = 0; b < blocks; ++b) {
+        const __m128i v = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + b * 16)), m);
+        const __m128i sad = _mm_sad_epu8(v, zero);  // Two 8-byte sums
+        sums[b] += static_cast<quint32>(_mm_cvtsi128_si32(sad) + _mm_cvtsi128_si32(_mm_srli_si128(sad, 8)));
+    }
+}
+
+int countChangedSse2(const uchar* a, const uchar* b, int count, uchar threshold) {
+    const __m128i t = _mm_set1_epi8(static_cast<char>(threshold));
+    const __m128i zero = _mm_setzero_si128();
+    int changed = 0;
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        const __m128i diff = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+        const __m128i still = _mm_cmpeq_epi8(_mm_subs_epu8(diff, t), zero);
+        changed += 16 - qPopulationCount(static_cast<quint32>(_mm_movemask_epi8(still)));
+    }
+    return changed + countChangedScalar(a + i, b + i, count - i, threshold);
+}
+#endif
+
+#ifdef MCM_MOTION_AVX2
+__attribute__((target("avx2")))
+void sumBlocksAvx2(const uchar* row, int blocks, const uchar* mask, quint32* sums) {
+    const __m256i m = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(mask)));
+    const __m256i zero = _mm256_setzero_si256();
+    int b = 0;
+    for (; b + 2 <= blocks; b += 2) {
+        const __m256i v = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + b * 16)), m);
+        const __m256i sad = _mm256_sad_epu8(v, zero);  // Lanes 0-1: block b, lanes 2-3: block b + 1
+        const __m128i lo = _mm256_castsi256_si128(sad);
+        const __m128i hi = _mm256_extracti128_si256(sad, 1);
+        sums[b] += static_cast<quint32>(_mm_cvtsi128_si32(lo) + _mm_cvtsi128_si32(_mm_srli_si128(lo, 8)));
+        sums[b + 1] += static_cast<quint32>(_mm_cvtsi128_si32(hi) + _mm_cvtsi128_si32(_mm_srli_si128(hi, 8)));
+    }
+    if (b < blocks) {
+        sumBlocksSse2(row + b * 16, blocks - b, mask, sums + b);
+    }
+}
+
+__attribute__((target("avx2")))
+int countChangedAvx2(const uchar* a, const uchar* b, int count, uchar threshold) {
+    const __m256i t = _mm256_set1_epi8(static_cast<char>(threshold));
+    const __m256i zero = _mm256_setzero_si256();
+    int changed = 0;
+    int i = 0;
+    for (; i + 32 <= count; i += 32) {
+        const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        const __m256i diff = _mm256_or_si256(_mm256_subs_epu8(va, vb), _mm256_subs_epu8(vb, va));
+        const __m256i still = _mm256_cmpeq_epi8(_mm256_subs_epu8(diff, t), zero);
+        changed += 32 - qPopulationCount(static_cast<quint32>(_mm256_movemask_epi8(still)));
+    }
+    return changed + countChangedSse2(a + i, b + i, count - i, threshold);
+}
+#endif
+
+#ifdef MCM_MOTION_NEON
+void sumBlocksNeon(const uchar* row, int blocks, const uchar* mask, quint32* sums) {
+    const uint8x16_t m = vld1q_u8(mask);
+    for (int b = 0; b < blocks; ++b) {
+        const uint8x16_t v = vandq_u8(vld1q_u8(row + b * 16), m);
+#if defined(__aarch64__)
+        sums[b] += vaddlvq_u8(v);
+#else
+        const uint64x2_t sum = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(v)));
+        sums[b] += static_cast<quint32>(vgetq_lane_u64(sum, 0) + vgetq_lane_u64(sum, 1));
+#endif
+    }
+}
+
+int countChangedNeon(const uchar* a, const uchar* b, int count, uchar threshold) {
+    const uint8x16_t t = vdupq_n_u8(threshold);
+    int changed = 0;
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16_t diff = vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i));
+        const uint8x16_t ones = vshrq_n_u8(vcgtq_u8(diff, t), 7);  // 1 per changed cell
+#if defined(__aarch64__)
+        changed += vaddlvq_u8(ones);
+#else
+        const uint64x2_t sum = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(ones)));
+        changed += static_cast<int>(vgetq_lane_u64(sum, 0) + vgetq_lane_u64(sum, 1));
+#endif
+    }
+    return changed + countChangedScalar(a + i, b + i, count - i, threshold);
+}
+#endif
+
+struct Kernels {
+    SumBlocksFn sumBlocks;
+    CountChangedFn countChanged;
+    const char* name;
+};
+
+Kernels selectKernels() {
+#ifdef MCM_MOTION_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        return {sumBlocksAvx2, countChangedAvx2, "avx2"};
+    }
+#endif
+#if defined(MCM_MOTION_SSE2)
+    return {sumBlocksSse2, countChangedSse2, "sse2"};
+#elif defined(MCM_MOTION_NEON)
+    return {sumBlocksNeon, countChangedNeon, "neon"};
+#else
+    return {sumBlocksScalar, countChangedScalar, "scalar"};
+#endif
+}
+
+const Kernels& kernels() {
+    static const Kernels selected = selectKernels();
+    return selected;
+}
+
+} // namespace
+
+MotionDetector::MotionDetector(int slotId)
+    : QObject(nullptr)
+    , m_slotId(slotId)
+{
+    m_clock.start();
+    moveToThread(CaptureWorkerPool::instance().analysisThread());
+}
+
+void MotionDetector::release() {
+    setEnabled(false);
+    {
+        QMutexLocker locker(&m_mailboxMutex);
+        m_pending = QVideoFrame();
+    }
+
+    // Once the pool has stopped there is no event loop left to run deleteLater
+    if (thread()->isRunning() && thread() != QThread::currentThread()) {
+        deleteLater();
+    } else {
+        delete this;
+    }
+}
+
+void MotionDetector::setConfig(const MotionConfig& config) {
+    m_intervalMs = 1000 / qMax(1, config.analysisFps);
+    m_gridColumns = qBound(16, config.gridColumns, 256);
+    m_cellThreshold = qBound(1, config.cellThreshold, 255);
+}
+
+void MotionDetector::setEnabled(bool enabled) {
+    if (m_enabled.exchange(enabled) != enabled && enabled) {
+        qDebug() << "MotionDetector slot" << m_slotId << ": Analysis on," << kernelName() << "kernels,"
+                 << 1000 / m_intervalMs.load() << "fps";
+    }
+}
+
+void MotionDetector::reset() {
+    m_generation++;
+    m_nextSampleMs = 0;
+    m_score = 0.0;
+    QMutexLocker locker(&m_mailboxMutex);
+    m_pending = QVideoFrame();
+}
+
+void MotionDetector::submit(const QVideoFrame& frame) {
+    if (!m_enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    const qint64 nowMs = m_clock.elapsed();
+    if (nowMs < m_nextSampleMs.load(std::memory_order_relaxed)) {
+        return;
+    }
+    m_nextSampleMs.store(nowMs + m_intervalMs.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    // Hand over the frame handle only; mapping happens on the analysis thread
+    bool post = false;
+    {
+        QMutexLocker locker(&m_mailboxMutex);
+        if (m_pending.isValid()) {
+            m_superseded.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_pending = frame;
+        m_pendingGeneration = m_generation.load();
+        post = !m_queued;
+        m_queued = true;
+    }
+    if (post) {
+        QMetaObject::invokeMethod(this, [this]() { analyzePending(); }, Qt::QueuedConnection);
+    }
+}
+
+MotionDetector::Stats MotionDetector::stats() const {
+    Stats stats;
+    stats.analyzed = m_analyzed.load();
+    stats.superseded = m_superseded.load();
+    stats.busyUs = m_busyUs.load();
+    return stats;
+}
+
+const char* MotionDetector::kernelName() {
+    return kernels().name;
+}
+
+void MotionDetector::analyzePending() {
+    QVideoFrame frame;
+    quint64 generation = 0;
+    {
+        QMutexLocker locker(&m_mailboxMutex);
+        frame = m_pending;
+        generation = m_pendingGeneration;
+        m_pending = QVideoFrame();
+        m_queued = false;
+    }
+    if (!frame.isValid() || generation != m_generation.load()) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    if (!decimate(frame, &m_current)) {
+        return;
+    }
+
+    double score = 0.0;
+    const bool comparable = m_referenceGeneration == generation && !m_reference.cells.empty()
+        && m_reference.columns == m_current.columns && m_reference.rows == m_current.rows;
+    if (comparable) {
+        const int cells = static_cast<int>(m_current.cells.size());
+        const int changed = kernels().countChanged(m_current.cells.data(), m_reference.cells.data(), cells,
+                                                   static_cast<uchar>(m_cellThreshold.load()));
+        score = static_cast<double>(changed) / cells;
+    }
+    std::swap(m_reference, m_current);
+    m_referenceGeneration = generation;
+
+    m_busyUs.fetch_add(timer.nsecsElapsed() / 1000, std::memory_order_relaxed);
+    m_analyzed.fetch_add(1, std::memory_order_relaxed);
+    if (!comparable) {
+        return;  // First frame of a stream (or a new resolution) is only the reference
+    }
+    m_score.store(score, std::memory_order_relaxed);
+    emit motionScore(m_slotId, score);
+    EventTrigger::instance().reportMotion(m_slotId, score);
+}
+
+bool MotionDetector::decimate(const QVideoFrame& source, LumaGrid* grid) {
+    LumaLayout layout;
+    if (!lumaLayout(source.pixelFormat(), &layout)) {
+        if (!m_formatWarned) {
+            qWarning() << "MotionDetector slot" << m_slotId << ": No luma plane in" << source.pixelFormat()
+                       << "- motion analysis skipped";
+            m_formatWarned = true;
+        }
+        return false;
+    }
+
+    // map() is non-const; a shallow copy shares the underlying buffer
+    QVideoFrame frame = source;
+    if (SlotTelemetry* telemetry = m_telemetry.load()) {
+        telemetry->recordFrameMap(frame);
+    }
+    if (!frame.map(QVideoFrame::ReadOnly)) {
+        return false;
+    }
+    const uchar* plane = frame.bits(0);
+    const int bytesPerLine = frame.bytesPerLine(0);
+    const int width = frame.width();
+    const int height = frame.height();
+    const int rowBytes = width * layout.step;
+    if (!plane || rowBytes < 16 || height < 1 || bytesPerLine < rowBytes) {
+        frame.unmap();
+        return false;
+    }
+
+    // Cells are whole 16-byte blocks wide and about square
+    const int target = m_gridColumns.load();
+    const int blocksPerCell = qMax(1, (rowBytes + 8 * target) / (16 * target));
+    const int columns = rowBytes / (16 * blocksPerCell);
+    const int cellWidthPixels = 16 * blocksPerCell / layout.step;
+    const int rows = qMax(1, height / cellWidthPixels);
+    const int cellHeight = height / rows;
+    const int samples = qMin(cellHeight, SAMPLE_ROWS);
+    const int blocks = columns * blocksPerCell;
+    const quint32 pixelsPerCell = static_cast<quint32>(blocksPerCell * (16 / layout.step) * samples);
+
+    uchar mask[16];
+    for (int i = 0; i < 16; ++i) {
+        mask[i] = (i % layout.step) == layout.offset ? 0xFF : 0x00;
+    }
+
+    grid->columns = columns;
+    grid->rows = rows;
+    grid->cells.resize(static_cast<size_t>(columns) * rows);
+    m_blockSums.resize(blocks);
+
+    const SumBlocksFn sumBlocks = kernels().sumBlocks;
+    for (int row = 0; row < rows; ++row) {
+        std::fill(m_blockSums.begin(), m_blockSums.end(), 0u);
+        for (int s = 0; s < samples; ++s) {
+            const int y = row * cellHeight + (2 * s + 1) * cellHeight / (2 * samples);
+            sumBlocks(plane + static_cast<qsizetype>(y) * bytesPerLine, blocks, mask, m_blockSums.data());
+        }
+        uchar* out = grid->cells.data() + static_cast<size_t>(row) * columns;
+        for (int column = 0; column < columns; ++column) {
+            quint32 sum = 0;
+            for (int b = 0; b < blocksPerCell; ++b) {
+                sum += m_blockSums[column * blocksPerCell + b];
+            }
+            out[column] = static_cast<uchar>(sum / pixelsPerCell);
+        }
+    }
+
+    frame.unmap();
+    return true;
+}
+
+} // namespace MCM
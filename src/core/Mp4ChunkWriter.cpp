@@ -0,0 +1,177 @@
+#include "Mp4ChunkWriter.h"
+#include <QDebug>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/error.h>
+#include <libavutil/mathematics.h>
+}
+
+namespace MCM {
+
+namespace {
+
+QString ffmpegError(int code) {
+    char buffer[AV_ERROR_MAX_STRING_SIZE] = {0};
+    av_strerror(code, buffer, sizeof(buffer));
+    return QString::fromUtf8(buffer);
+}
+
+} // namespace
+
+Mp4ChunkWriter::~Mp4ChunkWriter() {
+    close();
+}
+
+bool Mp4ChunkWriter::open(const QString& filename, const AVCodecParameters* codecpar,
+                          AVRational inputTimeBase, QString* error) {
+    close();
+
+    const QByteArray path = filename.toUtf8();
+    int ret = avformat_alloc_output_context2(&m_context, nullptr, "mp4", path.constData());
+    if (ret < 0 || !m_context) {
+        if (error) *error = QString("Cannot create MP4 muxer: %1").arg(ffmpegError(ret));
+        m_context = nullptr;
+        return false;
+    }
+
+    m_stream = avformat_new_stream(m_context, nullptr);
+    if (!m_stream) {
+        if (error) *error = "Cannot create output stream";
+        close();
+        return false;
+    }
+
+    ret = avcodec_parameters_copy(m_stream->codecpar, codecpar);
+    if (ret < 0) {
+        if (error) *error = QString("Cannot copy codec parameters: %1").arg(ffmpegError(ret));
+        close();
+        return false;
+    }
+    // Let the MP4 muxer pick the tag (avc1/hev1) - RTSP tags are not valid here
+    m_stream->codecpar->codec_tag = 0;
+    m_stream->time_base = inputTimeBase;
+    m_inputTimeBase = inputTimeBase;
+
+    if (!(m_context->oformat->flags & AVFMT_NOFILE)) {
+        ret = avio_open(&m_context->pb, path.constData(), AVIO_FLAG_WRITE);
+        if (ret < 0) {
+            if (error) *error = QString("Cannot open %1: %2").arg(filename, ffmpegError(ret));
+            close();
+            return false;
+        }
+    }
+
+    // Fragmented: a moof per keyframe, flushed as it is cut, so the open chunk
+    // is playable up to its last GOP and a crash loses only that GOP
+    AVDictionary* options = nullptr;
+    av_dict_set(&options, "movflags", "frag_keyframe+empty_moov+default_base_moof", 0);
+    m_context->flush_packets = 1;
+    ret = avformat_write_header(m_context, &options);
+    av_dict_free(&options);
+    if (ret < 0) {
+        if (error) *error = QString("Cannot write MP4 header: %1").arg(ffmpegError(ret));
+        if (m_context->pb) {
+            avio_closep(&m_context->pb);
+        }
+        avformat_free_context(m_context);
+        m_context = nullptr;
+        m_stream = nullptr;
+        return false;
+    }
+
+    m_filename = filename;
+    m_firstTimestamp = INT64_MIN;
+    m_lastDts = INT64_MIN;
+    m_lastPts = INT64_MIN;
+    m_packetsWritten = 0;
+    m_bytesWritten = 0;
+    return true;
+}
+
+bool Mp4ChunkWriter::write(const AVPacket* packet, QString* error) {
+    if (!m_context || !packet) {
+        return false;
+    }
+
+    AVPacket* out = av_packet_clone(packet);  // Shares the payload buffer (refcounted)
+    if (!out) {
+        if (error) *error = "Out of memory";
+        return false;
+    }
+
+    // Rebase so the chunk starts at t=0
+    if (m_firstTimestamp == INT64_MIN) {
+        m_firstTimestamp = out->dts != AV_NOPTS_VALUE ? out->dts : out->pts;
+        if (m_firstTimestamp == AV_NOPTS_VALUE) {
+            m_firstTimestamp = 0;
+        }
+    }
+
+    // A packet without DTS follows the previous one; the first of a chunk starts at its PTS
+    int64_t dts = 0;
+    if (out->dts != AV_NOPTS_VALUE) {
+        dts = out->dts - m_firstTimestamp;
+    } else if (m_lastDts != INT64_MIN) {
+        dts = m_lastDts + 1;
+    } else if (out->pts != AV_NOPTS_VALUE) {
+        dts = out->pts - m_firstTimestamp;
+    }
+    int64_t pts = out->pts != AV_NOPTS_VALUE ? out->pts - m_firstTimestamp : dts;
+
+    // MP4 requires strictly increasing DTS and PTS >= DTS
+    if (m_lastDts != INT64_MIN && dts <= m_lastDts) {
+        dts = m_lastDts + 1;
+    }
+    if (pts < dts) {
+        pts = dts;
+    }
+    m_lastDts = dts;
+    m_lastPts = qMax(m_lastPts, pts);
+
+    out->dts = av_rescale_q(dts, m_inputTimeBase, m_stream->time_base);
+    out->pts = av_rescale_q(pts, m_inputTimeBase, m_stream->time_base);
+    out->duration = av_rescale_q(out->duration, m_inputTimeBase, m_stream->time_base);
+    out->stream_index = m_stream->index;
+    out->pos = -1;
+
+    const int size = out->size;
+    int ret = av_interleaved_write_frame(m_context, out);
+    av_packet_free(&out);
+
+    if (ret < 0) {
+        if (error) *error = QString("Write failed: %1").arg(ffmpegError(ret));
+        return false;
+    }
+
+    m_packetsWritten++;
+    m_bytesWritten += size;
+    return true;
+}
+
+void Mp4ChunkWriter::close() {
+    if (!m_context) {
+        return;
+    }
+
+    if (m_context->pb) {
+        av_write_trailer(m_context);
+        if (!(m_context->oformat->flags & AVFMT_NOFILE)) {
+            avio_closep(&m_context->pb);
+        }
+    }
+
+    avformat_free_context(m_context);
+    m_context = nullptr;
+    m_stream = nullptr;
+}
+
+qint64 Mp4ChunkWriter::durationMs() const {
+    if (m_lastPts == INT64_MIN) {
+        return 0;
+    }
+    return av_rescale_q(m_lastPts, m_inputTimeBase, AVRational{1, 1000});
+}
+
+} // namespace MCM
@@ -0,0 +1,91 @@
+#ifndef MP4CHUNKWRITER_H
+#define MP4CHUNKWRITER_H
+
+#include <QString>
+#include <cstdint>
+
+extern "C" {
+#include <libavutil/rational.h>
+}
+
+struct AVFormatContext;
+struct AVStream;
+struct AVCodecParameters;
+struct AVPacket;
+
+namespace MCM {
+
+/**
+ * @brief Writes already-encoded video packets into a single MP4 file
+ *
+ * Pure remux (libavformat), no decoding or encoding. Timestamps are
+ * rebased so every chunk starts at zero and kept monotonic, which is
+ * required by the MP4 muxer when cutting a live stream.
+ *
+ * The file is fragmented MP4 with one fragment per keyframe: the header
+ * (empty moov) is written by open() and each GOP reaches the file when the
+ * next keyframe arrives, so a crash loses at most the GOP in progress.
+ *
+ * Usage:
+ *   Mp4ChunkWriter writer;
+ *   writer.open(filename, inputStream->codecpar, inputStream->time_base);
+ *   writer.write(packet);   // first packet should be a keyframe
+ *   writer.close();         // last fragment + fragment index
+ */
+class Mp4ChunkWriter {
+public:
+    Mp4ChunkWriter() = default;
+    ~Mp4ChunkWriter();
+
+    // Prevent copying
+    Mp4ChunkWriter(const Mp4ChunkWriter&) = delete;
+    Mp4ChunkWriter& operator=(const Mp4ChunkWriter&) = delete;
+
+    /**
+     * @brief Create the output file and write the container header
+     * @param filename Output path (.mp4)
+     * @param codecpar Codec parameters copied from the input stream
+     * @param inputTimeBase Time base of packets passed to write()
+     * @param error Optional error description on failure
+     */
+    bool open(const QString& filename, const AVCodecParameters* codecpar,
+              AVRational inputTimeBase, QString* error = nullptr);
+
+    /**
+     * @brief Write one packet (timestamps in inputTimeBase)
+     *
+     * The packet is not modified or consumed by the call.
+     */
+    bool write(const AVPacket* packet, QString* error = nullptr);
+
+    /**
+     * @brief Write the last fragment and the trailer (fragment index) and close the file
+     */
+    void close();
+
+    bool isOpen() const { return m_context != nullptr; }
+    QString filename() const { return m_filename; }
+    qint64 packetsWritten() const { return m_packetsWritten; }
+    qint64 bytesWritten() const { return m_bytesWritten; }
+
+    /**
+     * @brief Duration of written media in milliseconds (by packet timestamps)
+     */
+    qint64 durationMs() const;
+
+private:
+    AVFormatContext* m_context{nullptr};
+    AVStream* m_stream{nullptr};
+    AVRational m_inputTimeBase{1, 90000};
+    QString m_filename;
+
+    int64_t m_firstTimestamp{INT64_MIN};
+    int64_t m_lastDts{INT64_MIN};
+    int64_t m_lastPts{INT64_MIN};
+    qint64 m_packetsWritten{0};
+    qint64 m_bytesWritten{0};
+};
+
+} // namespace MCM
+
+#endif // MP4CHUNKWRITER_H
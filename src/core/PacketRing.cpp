@@ -0,0 +1,92 @@
+#include "PacketRing.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+namespace MCM {
+
+PacketRing::PacketRing(qint64 maxDurationMs, qint64 maxBytes)
+    : m_maxDurationMs(qMax<qint64>(0, maxDurationMs))
+    , m_maxBytes(qMax<qint64>(1, maxBytes))
+{
+}
+
+PacketRing::~PacketRing() {
+    clear();
+}
+
+void PacketRing::setLimits(qint64 maxDurationMs, qint64 maxBytes) {
+    m_maxDurationMs = qMax<qint64>(0, maxDurationMs);
+    m_maxBytes = qMax<qint64>(1, maxBytes);
+}
+
+bool PacketRing::push(const AVPacket* packet, qint64 timestampMs) {
+    const bool keyframe = (packet->flags & AV_PKT_FLAG_KEY) != 0;
+    if (m_entries.empty() && !keyframe) {
+        return false;  // Pre-roll must open on a keyframe
+    }
+
+    AVPacket* ref = av_packet_clone(packet);  // Shares the payload buffer (refcounted)
+    if (!ref) {
+        return false;
+    }
+    m_entries.push_back(Entry{ref, timestampMs, keyframe});
+    m_bytes += ref->size;
+    if (keyframe) {
+        m_keyframeTimes.push_back(timestampMs);
+    }
+
+    // Drop the oldest GOP while the rest still covers the pre-roll
+    while (m_keyframeTimes.size() > 1 && timestampMs - m_keyframeTimes[1] >= m_maxDurationMs) {
+        dropFrontGop();
+    }
+    // Over the memory cap: drop GOPs even if that shortens the pre-roll
+    while (m_bytes > m_maxBytes && !m_entries.empty()) {
+        dropFrontGop();
+    }
+    return !m_entries.empty();
+}
+
+void PacketRing::dropFrontGop() {
+    // First entry is always a keyframe: remove it and everything up to the next one
+    do {
+        Entry entry = m_entries.front();
+        m_entries.pop_front();
+        m_bytes -= entry.packet->size;
+        av_packet_free(&entry.packet);
+        m_droppedPackets++;
+    } while (!m_entries.empty() && !m_entries.front().keyframe);
+    m_keyframeTimes.pop_front();
+}
+
+AVPacket* PacketRing::pop() {
+    if (m_entries.empty()) {
+        return nullptr;
+    }
+    Entry entry = m_entries.front();
+    m_entries.pop_front();
+    m_bytes -= entry.packet->size;
+    if (entry.keyframe) {
+        m_keyframeTimes.pop_front();
+    }
+    return entry.packet;
+}
+
+void PacketRing::clear() {
+    for (Entry& entry : m_entries) {
+        av_packet_free(&entry.packet);
+    }
+    m_entries.clear();
+    m_keyframeTimes.clear();
+    m_bytes = 0;
+}
+
+qint64 PacketRing::durationMs() const {
+    if (m_entries.empty()) {
+        return 0;
+    }
+    return m_entries.back().timestampMs - m_entries.front().timestampMs;
+}
+
+} // namespace MCM
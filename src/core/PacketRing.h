@@ -0,0 +1,92 @@
+#ifndef PACKETRING_H
+#define PACKETRING_H
+
+#include <QtGlobal>
+#include <deque>
+
+struct AVPacket;
+
+namespace MCM {
+
+/**
+ * @brief Bounded queue of compressed video packets (event pre-roll)
+ *
+ * Same semantics as FrameBuffer's Locked mode - when full, the oldest data
+ * goes - but holding encoded packets, and dropping whole GOPs: the queue
+ * always starts on a keyframe, so it can be written straight into a new
+ * chunk. It keeps at least maxDurationMs of packets when they fit in
+ * maxBytes.
+ *
+ * Packets are referenced, not copied (av_packet_ref). Not thread-safe: it
+ * is owned by the recording worker that reads the stream.
+ *
+ * Usage:
+ *   PacketRing ring(10000, 32 * 1024 * 1024);
+ *   ring.push(packet, timestampMs);          // for every packet
+ *   while (AVPacket* p = ring.pop()) { writer.write(p); av_packet_free(&p); }
+ */
+class PacketRing {
+public:
+    PacketRing(qint64 maxDurationMs = 10000, qint64 maxBytes = 32 * 1024 * 1024);
+    ~PacketRing();
+
+    // Prevent copying
+    PacketRing(const PacketRing&) = delete;
+    PacketRing& operator=(const PacketRing&) = delete;
+
+    void setLimits(qint64 maxDurationMs, qint64 maxBytes);
+
+    /**
+     * @brief Append a packet
+     * @param timestampMs Monotonic packet time in milliseconds (decode order)
+     * @return false if the packet was not kept (no keyframe yet, or out of memory)
+     */
+    bool push(const AVPacket* packet, qint64 timestampMs);
+
+    /**
+     * @brief Remove the oldest packet; caller frees it with av_packet_free()
+     * @return nullptr when empty
+     */
+    AVPacket* pop();
+
+    void clear();
+
+    /**
+     * @brief Oldest packet (a keyframe), still owned by the ring; nullptr when empty
+     */
+    const AVPacket* front() const { return m_entries.empty() ? nullptr : m_entries.front().packet; }
+
+    bool isEmpty() const { return m_entries.empty(); }
+    int size() const { return static_cast<int>(m_entries.size()); }
+    qint64 bytes() const { return m_bytes; }
+
+    /**
+     * @brief Time covered from the first to the last packet
+     */
+    qint64 durationMs() const;
+
+    /**
+     * @brief Packets dropped from the front (whole GOPs) to stay in bounds
+     */
+    quint64 droppedPackets() const { return m_droppedPackets; }
+
+private:
+    struct Entry {
+        AVPacket* packet;
+        qint64 timestampMs;
+        bool keyframe;
+    };
+
+    void dropFrontGop();
+
+    std::deque<Entry> m_entries;
+    std::deque<qint64> m_keyframeTimes;  // Timestamps of the keyframes in m_entries
+    qint64 m_maxDurationMs;
+    qint64 m_maxBytes;
+    qint64 m_bytes{0};
+    quint64 m_droppedPackets{0};
+};
+
+} // namespace MCM
+
+#endif // PACKETRING_H
@@ -1,9 +1,14 @@
 #include "QtVideoRecorder.h"
+#include "ChunkIndex.h"
+#include "EncoderScheduler.h"
+#include "RecordingStorage.h"
+#include "Telemetry.h"
 #include <QDir>
 #include <QDebug>
 #include <QStandardPaths>
 #include <QCoreApplication>
 #include <QFileInfo>
+#include <QMutexLocker>
 #include <cstdlib>
 
 namespace MCM {
@@ -43,6 +48,17 @@ QtVideoRecorder::QtVideoRecorder(int slotId, QObject* parent)
     m_chunkTimer->setSingleShot(true);
     connect(m_chunkTimer, &QTimer::timeout,
             this, &QtVideoRecorder::onChunkTimerTimeout);
+    
+    m_clock.start();
+    
+    // Hardware session grants can move between slots while recording
+    connect(&EncoderScheduler::instance(), &EncoderScheduler::grantChanged,
+            this, &QtVideoRecorder::onHardwareGrantChanged);
+    
+    // Disk falling behind the write rate (reported from the storage thread)
+    m_storageBackpressure = RecordingStorage::instance().backpressure();
+    connect(&RecordingStorage::instance(), &RecordingStorage::backpressureChanged,
+            this, &QtVideoRecorder::onStorageBackpressureChanged);
 }
 
 QtVideoRecorder::~QtVideoRecorder() {
@@ -63,26 +79,32 @@ void QtVideoRecorder::configureRecorder(QMediaRecorder* recorder) {
     // Use MP4 container
     format.setFileFormat(QMediaFormat::MPEG4);
     
+    const QMediaFormat::VideoCodec profileCodec = videoCodecFromString(m_profile.codec);
+    const bool software = !hardwareEncoderSelected();
+    
 #ifdef Q_OS_LINUX
     // On Linux with FFmpeg backend:
     // Hardware encoding priority (auto-detected by FFmpeg):
-    // 1. VA-API (Intel/AMD) - h264_vaapi
-    // 2. NVENC (NVIDIA) - h264_nvenc  
+    // 1. VA-API (Intel/AMD) - h264_vaapi / hevc_vaapi
+    // 2. NVENC (NVIDIA) - h264_nvenc / hevc_nvenc
     // 3. Software fallback - MPEG4
-    // If hardware encoding fails, we fall back to MPEG4 (software)
-    if (m_useHardwareEncoding && !m_hardwareEncodingFailed) {
-        format.setVideoCodec(QMediaFormat::VideoCodec::H264);
+    // If hardware encoding fails, the profile asks for software, or the
+    // EncoderScheduler has no session left for this slot, use MPEG4
+    if (!software) {
+        format.setVideoCodec(profileCodec);
         qDebug() << "QtVideoRecorder slot" << m_slotId 
-                 << ": Using H.264 (VA-API/NVENC hardware)";
+                 << ": Using" << m_profile.codec << "(VA-API/NVENC hardware)";
     } else {
         format.setVideoCodec(QMediaFormat::VideoCodec::MPEG4);
         qDebug() << "QtVideoRecorder slot" << m_slotId 
                  << ": Using MPEG4 (software fallback)";
     }
 #else
-    // Use H.264 codec - hardware accelerated on macOS/Windows
-    format.setVideoCodec(QMediaFormat::VideoCodec::H264);
-    qDebug() << "QtVideoRecorder: Using MP4/H264";
+    // macOS/Windows: the backend picks a hardware or software encoder for the
+    // profile codec itself, so software only changes the rate control below
+    format.setVideoCodec(profileCodec);
+    qDebug() << "QtVideoRecorder slot" << m_slotId << ": Using MP4/" << m_profile.codec
+             << (software ? "(software rate control)" : "(hardware)");
 #endif
     
     // Explicitly disable audio - set to Unspecified to avoid microphone access
@@ -93,22 +115,160 @@ void QtVideoRecorder::configureRecorder(QMediaRecorder* recorder) {
     // Set quality - NormalQuality is more compatible across codecs
     recorder->setQuality(QMediaRecorder::NormalQuality);
     
-#ifdef Q_OS_LINUX
-    // On Linux with hardware encoding (VA-API/NVENC), use average bitrate
-    if (m_useHardwareEncoding && !m_hardwareEncodingFailed) {
+    if (!software) {
+        // Hardware encoders: average bitrate (adaptive mode may have lowered it)
         recorder->setEncodingMode(QMediaRecorder::AverageBitRateEncoding);
-        recorder->setVideoBitRate(4000000);  // 4 Mbps
+        recorder->setVideoBitRate(m_currentBitrateKbps * 1000);
     } else {
         // Software encoding (MPEG4) - constant quality is more compatible
         recorder->setEncodingMode(QMediaRecorder::ConstantQualityEncoding);
     }
-#else
-    // Use average bit rate encoding on other platforms
-    recorder->setEncodingMode(QMediaRecorder::AverageBitRateEncoding);
-    recorder->setVideoBitRate(4000000);  // 4 Mbps - good quality for 720p/1080p
-#endif
     
-    recorder->setVideoFrameRate(0);  // 0 = use source frame rate (better for capture cards)
+    // Downscale only - never ask the encoder to upscale
+    recorder->setVideoResolution(targetResolution());
+    
+    recorder->setVideoFrameRate(m_profile.fps);  // 0 = use source frame rate (better for capture cards)
+
+}
+
+bool QtVideoRecorder::hardwareEncoderSelected() const {
+    if (videoCodecFromString(m_profile.codec) == QMediaFormat::VideoCodec::MPEG4) {
+        return false;
+    }
+    return m_useHardwareEncoding && !m_hardwareEncodingFailed && m_hardwareGranted
+           && m_profile.acceleration != "software";
+}
+
+void QtVideoRecorder::onHardwareGrantChanged(int slotId, bool hardware) {
+    if (slotId != m_slotId || hardware == m_hardwareGranted) {
+        return;
+    }
+    
+    m_hardwareGranted = hardware;
+    qDebug() << "QtVideoRecorder slot" << m_slotId << ":"
+             << (hardware ? "Hardware encoder granted" : "Hardware encoder revoked, switching to software");
+    
+    // Switch encoders now rather than at the end of the chunk, so a revoked
+    // session is actually freed for the slot that needs it
+    if (m_recording && hardwareEncoderSelected() != m_activeHardware) {
+        requestRotation();
+    }
+}
+
+void QtVideoRecorder::onStorageBackpressureChanged(bool active) {
+    m_storageBackpressure = active;
+    if (m_recording && active && !m_profile.adaptive) {
+        qDebug() << "QtVideoRecorder slot" << m_slotId
+                 << ": Storage back-pressure, profile is not adaptive - keeping" << m_currentBitrateKbps << "kbps";
+    }
+    // Adaptive profiles react on the next duration update (see onDurationChanged)
+}
+
+QMediaFormat::VideoCodec QtVideoRecorder::videoCodecFromString(const QString& codec) {
+    if (codec == "hevc" || codec == "h265") return QMediaFormat::VideoCodec::H265;
+    if (codec == "mpeg4" || codec == "mp4v" || codec == "xvid") return QMediaFormat::VideoCodec::MPEG4;
+    return QMediaFormat::VideoCodec::H264;
+}
+
+QSize QtVideoRecorder::targetResolution() const {
+    if (m_currentMaxHeight <= 0) {
+        return QSize();  // Source resolution
+    }
+    
+    // Aspect ratio from the last delivered frame, 16:9 until one arrives
+    const QSize last = sourceSize();
+    const QSize source = last.isValid() ? last : QSize(1920, 1080);
+    if (m_currentMaxHeight >= source.height()) {
+        return QSize();
+    }
+    
+    // Encoders want even dimensions
+    int height = m_currentMaxHeight & ~1;
+    int width = static_cast<int>(qint64(source.width()) * height / source.height()) & ~1;
+    return QSize(width, height);
+}
+
+void QtVideoRecorder::setEncodingProfile(const EncodingProfile& profile) {
+    m_profile = profile;
+    m_currentBitrateKbps = profile.bitrateKbps;
+    m_currentMaxHeight = profile.maxHeight;
+    m_lastAdaptMs = m_clock.elapsed();
+    
+    qDebug() << "QtVideoRecorder slot" << m_slotId << ": Encoding profile"
+             << profile.codec << profile.bitrateKbps << "kbps"
+             << "maxHeight:" << profile.maxHeight << "fps:" << profile.fps
+             << "accel:" << profile.acceleration << (profile.adaptive ? "(adaptive)" : "");
+    // Recorders are configured from the profile at each rotation
+}
+
+qint64 QtVideoRecorder::measureBacklog(qint64 duration) {
+    // Encoder backlog = how far encoded media time falls behind wall time in
+    // this chunk, relative to the first measurement (removes the startup gap)
+    const qint64 lag = (m_clock.elapsed() - m_chunkStartMs) - duration;
+    if (m_lagBaselineMs < 0) {
+        m_lagBaselineMs = lag;
+        return -1;
+    }
+    return lag - m_lagBaselineMs;
+}
+
+void QtVideoRecorder::updateAdaptiveEncoding(qint64 backlog) {
+    const qint64 now = m_clock.elapsed();
+    if (backlog > ENCODER_BACKLOG_HIGH_MS && now - m_lastAdaptMs >= ADAPT_DOWN_COOLDOWN_MS) {
+        // Bitrate first, then resolution
+        const QSize source = sourceSize();
+        const int sourceHeight = source.isValid() ? source.height() : 1080;
+        const int height = m_currentMaxHeight > 0 ? m_currentMaxHeight : sourceHeight;
+        if (m_currentBitrateKbps > m_profile.minBitrateKbps) {
+            m_currentBitrateKbps = qMax(m_profile.minBitrateKbps, m_currentBitrateKbps * 3 / 4);
+        } else if (height > MIN_ADAPTIVE_HEIGHT) {
+            m_currentMaxHeight = qMax(MIN_ADAPTIVE_HEIGHT, height * 2 / 3);
+        } else {
+            return;  // Already at the floor
+        }
+        
+        m_lastAdaptMs = now;
+        qWarning() << "QtVideoRecorder slot" << m_slotId << ": Encoder backlog" << backlog
+                   << "ms, lowering to" << m_currentBitrateKbps << "kbps, maxHeight"
+                   << m_currentMaxHeight;
+        emit encodingAdapted(m_currentBitrateKbps, m_currentMaxHeight);
+        
+        // A running encoder cannot be reconfigured - cut a new chunk now
+        requestRotation();
+    } else if (backlog < ENCODER_BACKLOG_LOW_MS && now - m_lastAdaptMs >= ADAPT_UP_COOLDOWN_MS) {
+        // Recover in reverse order: resolution first, then bitrate
+        if (m_currentMaxHeight != m_profile.maxHeight) {
+            const int restored = m_currentMaxHeight * 3 / 2;
+            const QSize source = sourceSize();
+            const bool full = m_profile.maxHeight <= 0
+                ? (source.isValid() && restored >= source.height())
+                : restored >= m_profile.maxHeight;
+            m_currentMaxHeight = full ? m_profile.maxHeight : restored;
+        } else if (m_currentBitrateKbps < m_profile.bitrateKbps) {
+            m_currentBitrateKbps = qMin(m_profile.bitrateKbps, m_currentBitrateKbps * 4 / 3);
+        } else {
+            return;  // Fully restored
+        }
+        
+        m_lastAdaptMs = now;
+        qDebug() << "QtVideoRecorder slot" << m_slotId << ": Encoder keeping up, raising to"
+                 << m_currentBitrateKbps << "kbps, maxHeight" << m_currentMaxHeight;
+        emit encodingAdapted(m_currentBitrateKbps, m_currentMaxHeight);
+        // No hurry - applies at the next regular rotation
+    }
+}
+
+void QtVideoRecorder::requestRotation() {
+    if (!m_recording) {
+        return;
+    }
+    
+    if (m_rotationMode == RotationMode::NextFrame) {
+        m_rotationPending = true;
+        m_chunkTimer->start(ROTATION_FALLBACK_MS);
+    } else {
+        rotateChunk();
+    }
 }
 
 QMediaRecorder* QtVideoRecorder::getStandbyRecorder() const {
@@ -152,29 +312,17 @@ bool QtVideoRecorder::startRecording(const QString& outputDirectory, int chunkDu
     }
     
     // Convert to absolute path if relative
-    QString absOutputDir = outputDirectory;
-    QFileInfo dirInfo(outputDirectory);
-    if (dirInfo.isRelative()) {
-        // Use project root (parent of build directory) as base for relative paths
-        // On macOS, app is in build/multi-camera-monitor.app/Contents/MacOS/
-        // So we go up 4 levels to get to project root
-        QDir appDir(QCoreApplication::applicationDirPath());
-#ifdef Q_OS_MACOS
-        // macOS app bundle: go up from MacOS -> Contents -> .app -> build -> project root
-        appDir.cdUp();  // Contents
-        appDir.cdUp();  // .app
-        appDir.cdUp();  // build
-        appDir.cdUp();  // project root
-#else
-        // On other platforms, just go up one level from build
-        appDir.cdUp();
-#endif
-        absOutputDir = appDir.absolutePath() + "/" + outputDirectory;
-    }
-    
-    m_outputDirectory = absOutputDir;
+    m_outputDirectory = resolveOutputDirectory(outputDirectory);
     m_chunkDurationSeconds = chunkDurationSeconds;
     m_chunkNumber = 0;
+    m_rotationPending = false;
+    m_awaitingFirstFrame = nullptr;
+    m_awaitingFinalize = nullptr;
+    m_deferredStart = nullptr;
+    m_overlapWaitStartMs = -1;
+    m_lastSourcePtsUs = -1;
+    m_chunkFirstPtsUs = -1;
+    m_frameIntervalUs = 0;
     
     qDebug() << "  Output dir (absolute):" << m_outputDirectory;
     
@@ -187,6 +335,10 @@ bool QtVideoRecorder::startRecording(const QString& outputDirectory, int chunkDu
     
     qDebug() << "  Slot directory created:" << slotDir;
     
+    // Claim a hardware session up front instead of discovering the limit by failure
+    m_hardwareGranted = m_profile.acceleration != "software"
+        && EncoderScheduler::instance().acquire(m_slotId, m_profile.priority);
+    
     m_recording = true;
     
     // Start first chunk
@@ -206,6 +358,14 @@ void QtVideoRecorder::stopRecording() {
     
     m_recording = false;
     m_chunkTimer->stop();
+    m_rotationPending = false;
+    m_awaitingFirstFrame = nullptr;
+    m_awaitingFinalize = nullptr;
+    m_deferredStart = nullptr;
+    m_overlapWaitStartMs = -1;
+    if (m_telemetry) {
+        m_telemetry->setEncoderBacklogMs(-1);  // Not recording
+    }
     
     // Stop both recorders (one might be finishing up from last rotation)
     if (m_recorderA && m_recorderA->recorderState() == QMediaRecorder::RecordingState) {
@@ -216,10 +376,18 @@ void QtVideoRecorder::stopRecording() {
     }
     
     if (!m_currentFilename.isEmpty()) {
+        ChunkIndexWriter::instance().chunkFinished(m_slotId, m_chunkNumber, -1);
         emit chunkCompleted(m_chunkNumber, m_currentFilename);
     }
     
     m_activeRecorder = nullptr;
+    m_activeHardware = false;
+    
+    if (m_holdingOverlap) {
+        EncoderScheduler::instance().endOverlap(m_slotId);
+        m_holdingOverlap = false;
+    }
+    EncoderScheduler::instance().release(m_slotId);
     
     emit recordingStateChanged(false);
     qDebug() << "QtVideoRecorder: Recording stopped for slot" << m_slotId;
@@ -237,6 +405,43 @@ void QtVideoRecorder::rotateChunk() {
         return;
     }
     
+    if (m_deferredStart) {
+        return;  // Sequential swap in progress - the new chunk starts when the old one stops
+    }
+    
+    const bool afterFrame = m_rotationPending;
+    m_rotationPending = false;
+    
+    // Two hardware encoders overlap during the swap. The scheduler hands out
+    // that extra session to one slot at a time; with no spare session at all,
+    // stop the old encoder before starting the new one.
+    const bool oldActive = m_activeRecorder
+        && m_activeRecorder->recorderState() == QMediaRecorder::RecordingState;
+    const bool newHardware = hardwareEncoderSelected();
+    bool sequential = false;
+    if (oldActive && m_activeHardware && newHardware) {
+        auto& scheduler = EncoderScheduler::instance();
+        if (scheduler.beginOverlap(m_slotId)) {
+            m_holdingOverlap = true;
+        } else if (scheduler.overlapPossible()) {
+            if (m_overlapWaitStartMs < 0) {
+                m_overlapWaitStartMs = m_clock.elapsed();
+            }
+            if (m_clock.elapsed() - m_overlapWaitStartMs < OVERLAP_WAIT_MS) {
+                // Another slot is rotating - try again shortly
+                QTimer::singleShot(OVERLAP_RETRY_MS, this, [this]() {
+                    if (m_recording) rotateChunk();
+                });
+                return;
+            }
+            qDebug() << "QtVideoRecorder slot" << m_slotId << ": Rotation token busy, swapping sequentially";
+            sequential = true;
+        } else {
+            sequential = true;
+        }
+    }
+    m_overlapWaitStartMs = -1;
+    
     // Save reference to old recorder (may be null on first chunk)
     QMediaRecorder* oldRecorder = m_activeRecorder;
     QString oldFilename = m_currentFilename;
@@ -247,6 +452,13 @@ void QtVideoRecorder::rotateChunk() {
     m_chunkStartTime = QDateTime::currentDateTime();
     m_currentFilename = generateFilename();
     
+    // Timeline index: the encoder's keyframes are not visible here, only the chunk span
+    if (oldRecorder) {
+        ChunkIndexWriter::instance().chunkFinished(m_slotId, oldChunkNumber, -1);
+    }
+    ChunkIndexWriter::instance().chunkStarted(m_slotId, m_currentFilename, m_chunkNumber,
+                                              m_chunkStartTime, m_chunkStartTime.toMSecsSinceEpoch());
+    
     // Get the standby recorder (the one NOT currently recording)
     QMediaRecorder* newRecorder = getStandbyRecorder();
     
@@ -262,13 +474,45 @@ void QtVideoRecorder::rotateChunk() {
     // This immediately starts sending frames to the new recorder
     m_session->setRecorder(newRecorder);
     m_activeRecorder = newRecorder;
+    m_activeHardware = newHardware;
+    m_chunkStartMs = m_clock.elapsed();
+    m_lagBaselineMs = -1;
+    
+    // Source time the closing chunk was given: from its first delivered frame
+    // through the last one before the swap, plus that frame's own duration
+    const qint64 firstPts = m_chunkFirstPtsUs.exchange(-1);
+    const qint64 lastPts = m_lastSourcePtsUs.load();
+    m_closedSpanUs = firstPts >= 0 && lastPts >= firstPts
+        ? lastPts - firstPts + m_frameIntervalUs.load() : -1;
+    
+    // Gap measurement starts when the old recorder stops receiving frames
+    if (oldRecorder) {
+        m_pendingMetrics = RotationMetrics();
+        m_pendingMetrics.chunkNumber = m_chunkNumber;
+        m_pendingMetrics.afterFrame = afterFrame;
+        m_swapTimeMs = m_clock.elapsed();
+        m_awaitingFirstFrame = newRecorder;
+        m_awaitingFinalize = nullptr;
+    }
+    
+    // Reserve the chunk on disk; the storage thread picks the file up once the backend creates it
+    RecordingStorage::instance().chunkStarted(
+        m_slotId, m_currentFilename,
+        RecordingStorage::expectedChunkBytes(m_currentBitrateKbps, m_chunkDurationSeconds));
     
     // Start the new recorder (it's already receiving frames from session)
-    newRecorder->record();
+    // In sequential mode it starts once the old encoder session is closed
+    if (sequential) {
+        m_deferredStart = newRecorder;
+    } else {
+        newRecorder->record();
+    }
     
     // NOW stop the old recorder (it's already detached from session)
     // No frames are lost because new recorder is already capturing
     if (oldRecorder && oldRecorder->recorderState() == QMediaRecorder::RecordingState) {
+        m_stopTimeMs = m_clock.elapsed();
+        m_awaitingFinalize = oldRecorder;
         oldRecorder->stop();
         
         // Emit completion for previous chunk
@@ -290,10 +534,98 @@ void QtVideoRecorder::startNextChunk() {
 }
 
 void QtVideoRecorder::onChunkTimerTimeout() {
-    if (m_recording) {
-        qDebug() << "QtVideoRecorder: Chunk timer expired, rotating...";
-        rotateChunk();
+    if (!m_recording) {
+        return;
+    }
+    
+    if (m_rotationMode == RotationMode::NextFrame && !m_rotationPending) {
+        // Defer the swap until a frame is delivered (see notifyFrame).
+        // The timer is re-armed as a fallback in case frames stop arriving.
+        qDebug() << "QtVideoRecorder: Chunk timer expired, rotating on next frame...";
+        m_rotationPending = true;
+        m_chunkTimer->start(ROTATION_FALLBACK_MS);
+        return;
+    }
+    
+    if (m_rotationPending) {
+        qWarning() << "QtVideoRecorder slot" << m_slotId
+                   << ": No frame within" << ROTATION_FALLBACK_MS << "ms, rotating anyway";
+        m_rotationPending = false;
+    }
+    
+    qDebug() << "QtVideoRecorder: Chunk timer expired, rotating...";
+    rotateChunk();
+}
+
+void QtVideoRecorder::notifyFrame(const QVideoFrame& frame) {
+    if (!m_recording) {
+        return;
+    }
+    {
+        QMutexLocker locker(&m_sourceMutex);
+        m_sourceSize = frame.size();  // Aspect ratio for downscaling
+    }
+    
+    // Timestamps of what the active chunk was given, for the loss measurement
+    const qint64 pts = frame.startTime();
+    if (pts >= 0) {
+        const qint64 previous = m_lastSourcePtsUs.exchange(pts);
+        const qint64 delta = pts - previous;
+        if (previous >= 0 && delta > 0 && delta < 1000000) {
+            const qint64 interval = m_frameIntervalUs.load();
+            m_frameIntervalUs = interval > 0 ? (interval * 7 + delta) / 8 : delta;
+        }
+        qint64 unset = -1;
+        m_chunkFirstPtsUs.compare_exchange_strong(unset, pts);
     }
+    
+    // Called from a capture worker: the swap itself is queued to our thread,
+    // so it lands after this frame but not necessarily before the next one.
+    if (m_rotationPending && !m_rotationQueued.exchange(true)) {
+        QMetaObject::invokeMethod(this, [this]() {
+            m_rotationQueued = false;
+            if (m_recording && m_rotationPending) {
+                rotateChunk();
+            }
+        }, Qt::QueuedConnection);
+    }
+}
+
+QSize QtVideoRecorder::sourceSize() const {
+    QMutexLocker locker(&m_sourceMutex);
+    return m_sourceSize;
+}
+
+QtVideoRecorder::RotationMode QtVideoRecorder::rotationModeFromString(const QString& mode) {
+    // "keyframe" is the old name of next-frame: every chunk opens on a keyframe anyway
+    if (mode.compare("next-frame", Qt::CaseInsensitive) == 0
+        || mode.compare("keyframe", Qt::CaseInsensitive) == 0) {
+        return RotationMode::NextFrame;
+    }
+    return RotationMode::Timer;
+}
+
+void QtVideoRecorder::maybeFinishRotationMetrics() {
+    // Both the new recorder's first frame and the old file's finalize must be in
+    if (m_awaitingFirstFrame || m_awaitingFinalize || m_pendingMetrics.chunkNumber == 0) {
+        return;
+    }
+    
+    m_lastRotationMetrics = m_pendingMetrics;
+    m_pendingMetrics = RotationMetrics();
+    
+    qDebug() << "QtVideoRecorder slot" << m_slotId << ": Rotation to chunk"
+             << m_lastRotationMetrics.chunkNumber
+             << "gap:" << m_lastRotationMetrics.gapMs << "ms"
+             << "lost:" << m_lastRotationMetrics.framesLost
+             << "finalize:" << m_lastRotationMetrics.finalizeMs << "ms"
+             << (m_lastRotationMetrics.afterFrame ? "(next-frame)" : "(timer)");
+    
+    if (m_telemetry) {
+        m_telemetry->recordRotation(m_lastRotationMetrics.gapMs, m_lastRotationMetrics.framesLost,
+                                    m_lastRotationMetrics.finalizeMs);
+    }
+    emit rotationMeasured(m_lastRotationMetrics);
 }
 
 void QtVideoRecorder::onRecorderStateChanged(QMediaRecorder::RecorderState state) {
@@ -307,6 +639,48 @@ void QtVideoRecorder::onRecorderStateChanged(QMediaRecorder::RecorderState state
         case QMediaRecorder::PausedState: stateStr = "Paused"; break;
     }
     qDebug() << "QtVideoRecorder: State changed to" << stateStr << "for slot" << m_slotId;
+    
+    // Old chunk finalized (trailer written, file closed)
+    auto* recorder = qobject_cast<QMediaRecorder*>(sender());
+    if (state == QMediaRecorder::StoppedState && recorder) {
+        // Trim the reservation and fsync off this thread
+        const QString finished = recorder->actualLocation().toLocalFile();
+        if (!finished.isEmpty()) {
+            RecordingStorage::instance().chunkFinished(m_slotId, finished);
+        }
+    }
+    if (state == QMediaRecorder::StoppedState && recorder && recorder == m_awaitingFinalize) {
+        m_pendingMetrics.finalizeMs = m_clock.elapsed() - m_stopTimeMs;
+        
+        // Lost = source time the chunk was given minus the media time it holds.
+        // Frames lost at either end of the chunk count (its start is the
+        // previous swap); a span beyond twice the chunk length means the
+        // source timestamps jumped, and is not measured
+        const qint64 intervalUs = m_frameIntervalUs.load();
+        const qint64 recordedMs = recorder->duration();
+        if (m_closedSpanUs > 0 && intervalUs > 0 && recordedMs > 0
+            && m_closedSpanUs / 1000 <= 2LL * m_chunkDurationSeconds * 1000) {
+            const qint64 missingUs = qMax<qint64>(0, m_closedSpanUs - recordedMs * 1000);
+            // Half a frame of slack for millisecond rounding of the duration
+            m_pendingMetrics.framesLost = static_cast<int>((missingUs + intervalUs / 2) / intervalUs);
+        }
+        m_awaitingFinalize = nullptr;
+        
+        // Old encoder session is gone
+        if (m_holdingOverlap) {
+            EncoderScheduler::instance().endOverlap(m_slotId);
+            m_holdingOverlap = false;
+        }
+        if (m_deferredStart) {
+            QMediaRecorder* next = m_deferredStart;
+            m_deferredStart = nullptr;
+            if (m_recording && next == m_activeRecorder) {
+                next->record();
+            }
+        }
+        
+        maybeFinishRotationMetrics();
+    }
 }
 
 void QtVideoRecorder::onRecorderErrorOccurred(QMediaRecorder::Error error, const QString& errorString) {
@@ -338,6 +712,9 @@ void QtVideoRecorder::onRecorderErrorOccurred(QMediaRecorder::Error error, const
         m_hardwareEncodingFailed = true;
         m_useHardwareEncoding = false;
         
+        // Likely the device session limit - let the other recorders know
+        EncoderScheduler::instance().reportHardwareFailure(m_slotId);
+        
         // Reconfigure both recorders with software encoding
         configureRecorder(m_recorderA);
         configureRecorder(m_recorderB);
@@ -371,6 +748,28 @@ void QtVideoRecorder::onRecorderErrorOccurred(QMediaRecorder::Error error, const
 }
 
 void QtVideoRecorder::onDurationChanged(qint64 duration) {
+    // First duration update from the new recorder = first frame encoded, gap closed
+    auto* recorder = qobject_cast<QMediaRecorder*>(sender());
+    if (recorder && recorder == m_awaitingFirstFrame && duration > 0) {
+        m_pendingMetrics.gapMs = m_clock.elapsed() - m_swapTimeMs;
+        m_awaitingFirstFrame = nullptr;
+        maybeFinishRotationMetrics();
+    }
+    
+    if (m_recording && recorder && recorder == m_activeRecorder) {
+        const qint64 backlog = measureBacklog(duration);
+        if (backlog >= 0) {
+            if (m_telemetry) {
+                m_telemetry->setEncoderBacklogMs(backlog);
+            }
+            if (m_profile.adaptive) {
+                // A disk that cannot keep up counts as a backlog: step down, never up
+                updateAdaptiveEncoding(m_storageBackpressure
+                    ? qMax(backlog, ENCODER_BACKLOG_HIGH_MS + 1) : backlog);
+            }
+        }
+    }
+    
     // Log duration periodically (every 10 seconds)
     static qint64 lastLog = 0;
     if (duration - lastLog >= 10000) {
@@ -381,14 +780,37 @@ void QtVideoRecorder::onDurationChanged(qint64 duration) {
 }
 
 QString QtVideoRecorder::generateFilename() const {
-    QString slotDir = QString("%1/slot_%2").arg(m_outputDirectory).arg(m_slotId);
+    return chunkFilename(m_outputDirectory, m_slotId, m_chunkNumber, m_chunkStartTime);
+}
+
+QString QtVideoRecorder::resolveOutputDirectory(const QString& outputDirectory) {
+    QFileInfo dirInfo(outputDirectory);
+    if (!dirInfo.isRelative()) {
+        return outputDirectory;
+    }
     
-    QString filename = QString("%1/%2_%3.mp4")
-        .arg(slotDir)
-        .arg(m_chunkNumber, 3, 10, QChar('0'))  // Zero-padded: 001, 002, ...
-        .arg(m_chunkStartTime.toString("yyyyMMdd_HHmmss"));
+    // Use project root (parent of build directory) as base for relative paths
+    // On macOS, app is in build/multi-camera-monitor.app/Contents/MacOS/
+    // So we go up 4 levels to get to project root
+    QDir appDir(QCoreApplication::applicationDirPath());
+#ifdef Q_OS_MACOS
+    // macOS app bundle: go up from MacOS -> Contents -> .app -> build -> project root
+    appDir.cdUp();  // Contents
+    appDir.cdUp();  // .app
+    appDir.cdUp();  // build
+    appDir.cdUp();  // project root
+#else
+    // On other platforms, just go up one level from build
+    appDir.cdUp();
+#endif
+    return appDir.absolutePath() + "/" + outputDirectory;
+}
+
+QString QtVideoRecorder::chunkFilename(const QString& outputDirectory, int slotId,
+                                       int chunkNumber, const QDateTime& startTime) {
+    QString slotDir = QString("%1/slot_%2").arg(outputDirectory).arg(slotId);
     
-    return filename;
+    return slotDir + "/" + ChunkIndex::chunkBaseName(chunkNumber, startTime);
 }
 
 bool QtVideoRecorder::ensureDirectoryExists(const QString& path) {
@@ -8,11 +8,28 @@
 #include <QUrl>
 #include <QTimer>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QString>
+#include <QVideoFrame>
+#include <QMutex>
 #include <atomic>
+#include "core/Config.h"
 
 namespace MCM {
 
+class SlotTelemetry;
+
+/**
+ * @brief Measurements for one A/B recorder swap
+ */
+struct RotationMetrics {
+    int chunkNumber{0};          // Chunk that was started by the swap
+    qint64 gapMs{-1};            // Old recorder detached -> new recorder encoding first frame
+    int framesLost{-1};          // Source frames missing from the chunk the swap closed, -1 if unknown
+    qint64 finalizeMs{-1};       // Old recorder stop() -> file finalized (StoppedState)
+    bool afterFrame{false};      // Swap was triggered by a delivered frame (NextFrame mode)
+};
+
 /**
  * @brief Hardware-accelerated video recorder using Qt Multimedia
  * 
@@ -21,7 +38,9 @@ namespace MCM {
  * - Direct GPU pipeline (no frame copying/conversion)
  * - Lower CPU usage (~80% reduction)
  * 
- * Supports chunk-based recording with automatic rotation.
+ * Supports chunk-based recording with automatic rotation. Chunks are
+ * registered with RecordingStorage, which preallocates and syncs them and
+ * applies retention; adaptive profiles also step down on its back-pressure.
  * 
  * Usage:
  *   QtVideoRecorder* recorder = new QtVideoRecorder(slotId);
@@ -32,6 +51,23 @@ class QtVideoRecorder : public QObject {
     Q_OBJECT
 
 public:
+    /**
+     * @brief When chunk rotation happens
+     *
+     * Timer:     swap recorders as soon as the chunk timer fires
+     * NextFrame: wait until the next frame is delivered, then queue the swap
+     *            to the recorder's thread - it lands shortly after a frame,
+     *            not on an exact frame boundary. Only useful when frames are
+     *            sparse (low fps, motion-gated sources). Requires
+     *            notifyFrame() from the capture path.
+     *
+     * Either way a fresh encoder opens every chunk with a keyframe.
+     */
+    enum class RotationMode {
+        Timer,
+        NextFrame
+    };
+
     explicit QtVideoRecorder(int slotId, QObject* parent = nullptr);
     ~QtVideoRecorder() override;
 
@@ -76,6 +112,68 @@ public:
      */
     QMediaRecorder* mediaRecorder() const { return m_activeRecorder; }
 
+    /**
+     * @brief Set rotation mode (takes effect at the next rotation)
+     */
+    void setRotationMode(RotationMode mode) { m_rotationMode = mode; }
+    RotationMode rotationMode() const { return m_rotationMode; }
+
+    /**
+     * @brief Parse "timer" / "next-frame" (old name "keyframe" -> NextFrame, anything else -> Timer)
+     */
+    static RotationMode rotationModeFromString(const QString& mode);
+
+    /**
+     * @brief Tell the recorder a frame was delivered to the capture session
+     *
+     * Used to trigger NextFrame rotations and to measure frames lost across
+     * a swap from the frames' timestamps. Safe to call from any thread (the frame tap
+     * calls it on a capture worker); the swap itself runs on the recorder's
+     * thread. Ignored while not recording.
+     */
+    void notifyFrame(const QVideoFrame& frame);
+
+    /**
+     * @brief Metrics of the most recent completed rotation measurement
+     */
+    RotationMetrics lastRotationMetrics() const { return m_lastRotationMetrics; }
+
+    /**
+     * @brief Report encoder backlog and rotation metrics to @p telemetry (nullptr = off)
+     */
+    void setTelemetry(SlotTelemetry* telemetry) { m_telemetry = telemetry; }
+
+    /**
+     * @brief Set the encoder profile (takes effect at the next chunk)
+     */
+    void setEncodingProfile(const EncodingProfile& profile);
+    const EncodingProfile& encodingProfile() const { return m_profile; }
+
+    /**
+     * @brief Bitrate/height currently in use (differs from the profile in adaptive mode)
+     */
+    int currentBitrateKbps() const { return m_currentBitrateKbps; }
+    int currentMaxHeight() const { return m_currentMaxHeight; }
+
+    /**
+     * @brief Resolve a (possibly relative) recordings directory to an absolute path
+     * 
+     * Relative paths are anchored at the project root (parent of the build dir),
+     * so every recorder type writes to the same place.
+     */
+    static QString resolveOutputDirectory(const QString& outputDirectory);
+
+    /**
+     * @brief Build the chunk filename: {dir}/slot_{N}/{chunk:03}_{yyyyMMdd_HHmmss}.mp4
+     */
+    static QString chunkFilename(const QString& outputDirectory, int slotId,
+                                 int chunkNumber, const QDateTime& startTime);
+
+    /**
+     * @brief Ensure output directory exists
+     */
+    static bool ensureDirectoryExists(const QString& path);
+
 signals:
     /**
      * @brief Emitted when a new chunk is started
@@ -97,11 +195,23 @@ signals:
      */
     void recordingStateChanged(bool recording);
 
+    /**
+     * @brief Emitted once gap and finalize time of a rotation are known
+     */
+    void rotationMeasured(const RotationMetrics& metrics);
+
+    /**
+     * @brief Emitted when adaptive mode changes bitrate or resolution
+     */
+    void encodingAdapted(int bitrateKbps, int maxHeight);
+
 private slots:
     void onRecorderStateChanged(QMediaRecorder::RecorderState state);
     void onRecorderErrorOccurred(QMediaRecorder::Error error, const QString& errorString);
     void onDurationChanged(qint64 duration);
     void onChunkTimerTimeout();
+    void onHardwareGrantChanged(int slotId, bool hardware);
+    void onStorageBackpressureChanged(bool active);
 
 private:
     /**
@@ -119,10 +229,6 @@ private:
      */
     QString generateFilename() const;
 
-    /**
-     * @brief Ensure output directory exists
-     */
-    bool ensureDirectoryExists(const QString& path);
 
     /**
      * @brief Configure media format for optimal hardware encoding
@@ -151,6 +257,88 @@ private:
     
     QTimer* m_chunkTimer{nullptr};
     
+    // Rotation alignment and measurement
+    RotationMode m_rotationMode{RotationMode::Timer};
+    std::atomic<bool> m_rotationPending{false};  // Timer fired, waiting for next frame
+    std::atomic<bool> m_rotationQueued{false};   // NextFrame swap posted to our thread
+    QElapsedTimer m_clock;
+    
+    // Source timestamps (us), written on the capture worker
+    std::atomic<qint64> m_lastSourcePtsUs{-1};    // Newest frame delivered
+    std::atomic<qint64> m_chunkFirstPtsUs{-1};    // First frame delivered to the active chunk
+    std::atomic<qint64> m_frameIntervalUs{0};     // Smoothed source frame interval
+    qint64 m_closedSpanUs{-1};                    // Source time delivered to the chunk a swap closed
+    
+    RotationMetrics m_pendingMetrics;
+    QMediaRecorder* m_awaitingFirstFrame{nullptr};  // New recorder, gap still open
+    QMediaRecorder* m_awaitingFinalize{nullptr};    // Old recorder, still writing
+    qint64 m_swapTimeMs{0};
+    qint64 m_stopTimeMs{0};
+    RotationMetrics m_lastRotationMetrics;
+    SlotTelemetry* m_telemetry{nullptr};
+    
+    static constexpr int ROTATION_FALLBACK_MS = 2000;  // Rotate anyway if no frame arrives
+    
+    /**
+     * @brief Emit rotationMeasured once both halves of a measurement are in
+     */
+    void maybeFinishRotationMetrics();
+    
+    // Encoding profile and adaptive state
+    EncodingProfile m_profile;
+    int m_currentBitrateKbps{4000};
+    int m_currentMaxHeight{0};
+    QSize m_sourceSize;                 // Guarded by m_sourceMutex (written per frame)
+    mutable QMutex m_sourceMutex;
+    QSize sourceSize() const;
+    qint64 m_chunkStartMs{0};
+    qint64 m_lagBaselineMs{-1};
+    qint64 m_lastAdaptMs{0};
+    bool m_storageBackpressure{false};  // RecordingStorage says the disk is behind
+    
+    static constexpr qint64 ENCODER_BACKLOG_HIGH_MS = 1500;  // Step down above this
+    static constexpr qint64 ENCODER_BACKLOG_LOW_MS = 300;    // Step up below this
+    static constexpr qint64 ADAPT_DOWN_COOLDOWN_MS = 10000;
+    static constexpr qint64 ADAPT_UP_COOLDOWN_MS = 60000;
+    static constexpr int MIN_ADAPTIVE_HEIGHT = 360;
+    
+    /**
+     * @brief Encoder backlog in ms for a duration update (-1 while taking the baseline)
+     */
+    qint64 measureBacklog(qint64 duration);
+    
+    /**
+     * @brief Step bitrate/resolution based on encoder backlog (adaptive profiles)
+     */
+    void updateAdaptiveEncoding(qint64 backlog);
+    
+    /**
+     * @brief Start a new chunk soon (next frame in NextFrame mode)
+     */
+    void requestRotation();
+    
+    /**
+     * @brief Output resolution for the current max height (invalid = source)
+     */
+    QSize targetResolution() const;
+    
+    static QMediaFormat::VideoCodec videoCodecFromString(const QString& codec);
+    
+    /**
+     * @brief Whether the next chunk will use a hardware encoder
+     */
+    bool hardwareEncoderSelected() const;
+    
+    // Hardware session scheduling (see EncoderScheduler)
+    bool m_hardwareGranted{false};
+    bool m_activeHardware{false};        // Active recorder holds a hardware session
+    bool m_holdingOverlap{false};        // Holding the rotation token
+    QMediaRecorder* m_deferredStart{nullptr};  // Sequential swap: start after old stops
+    qint64 m_overlapWaitStartMs{-1};
+    
+    static constexpr int OVERLAP_RETRY_MS = 100;
+    static constexpr int OVERLAP_WAIT_MS = 3000;    // Then swap sequentially
+    
     /**
      * @brief Configure a specific recorder instance
      */
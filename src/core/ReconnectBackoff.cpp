@@ -0,0 +1,26 @@
+#include "ReconnectBackoff.h"
+#include <QRandomGenerator>
+#include <cmath>
+
+namespace MCM {
+
+ReconnectBackoff::ReconnectBackoff(const ReconnectConfig& config)
+    : m_config(config)
+{
+}
+
+int ReconnectBackoff::nextDelayMs() {
+    // Exponent capped so the double cannot overflow on a long outage
+    const int exponent = qMin(m_attempts, 30);
+    m_attempts++;
+    const double backoffMs = qMin<double>(m_config.maxDelayMs,
+                                          m_config.initialDelayMs * std::pow(m_config.multiplier, exponent));
+
+    // The fixed part keeps a floor under the delay; the random part spreads
+    // slots that failed together
+    const double randomMs = backoffMs * m_config.jitter;
+    const double delayMs = backoffMs - randomMs + QRandomGenerator::global()->generateDouble() * randomMs;
+    return qMax(1, static_cast<int>(delayMs));
+}
+
+} // namespace MCM
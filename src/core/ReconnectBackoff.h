@@ -0,0 +1,54 @@
+#ifndef RECONNECTBACKOFF_H
+#define RECONNECTBACKOFF_H
+
+#include "core/Config.h"
+
+namespace MCM {
+
+/**
+ * @brief Exponential reconnect delays with jitter
+ *
+ * The n-th consecutive failure waits initialDelayMs * multiplier^(n-1),
+ * capped at maxDelayMs, of which the jitter fraction is randomized. Call
+ * reset() once a connection is proven good (first frame), not merely when
+ * the socket opens, so a camera that accepts and drops at once still backs
+ * off.
+ *
+ * Not thread-safe; each reconnecting object owns one.
+ *
+ * Usage:
+ *   ReconnectBackoff backoff(Config::instance().reconnect());
+ *   if (backoff.canRetry()) timer->start(backoff.nextDelayMs());
+ */
+class ReconnectBackoff {
+public:
+    explicit ReconnectBackoff(const ReconnectConfig& config = ReconnectConfig());
+
+    void setConfig(const ReconnectConfig& config) { m_config = config; }
+    const ReconnectConfig& config() const { return m_config; }
+
+    /**
+     * @brief Delay before the next attempt; counts the attempt
+     */
+    int nextDelayMs();
+
+    /**
+     * @brief Whether the policy allows another attempt (always, when maxAttempts is 0)
+     */
+    bool canRetry() const { return m_config.maxAttempts <= 0 || m_attempts < m_config.maxAttempts; }
+
+    /**
+     * @brief Consecutive attempts since the last reset()
+     */
+    int attempts() const { return m_attempts; }
+
+    void reset() { m_attempts = 0; }
+
+private:
+    ReconnectConfig m_config;
+    int m_attempts{0};
+};
+
+} // namespace MCM
+
+#endif // RECONNECTBACKOFF_H
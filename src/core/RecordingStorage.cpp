@@ -0,0 +1,480 @@
+#include "RecordingStorage.h"
+#include "ChunkIndex.h"
+#include "ThreadPolicy.h"
+#include <QThread>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QStorageInfo>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QMutexLocker>
+#include <QDebug>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if defined(Q_OS_LINUX)
+#include <fcntl.h>
+#include <unistd.h>
+#elif defined(Q_OS_UNIX)
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <io.h>
+#endif
+
+namespace MCM {
+
+namespace {
+
+QString chunkKey(const QString& filename) {
+    return QDir::cleanPath(QFileInfo(filename).absoluteFilePath());
+}
+
+constexpr qint64 MB = 1024 * 1024;
+constexpr int SAMPLE_INTERVAL_MS = 1000;  // Picks up new files when periodic writeback is off
+
+} // namespace
+
+RecordingStorage& RecordingStorage::instance() {
+    static RecordingStorage instance;
+    return instance;
+}
+
+RecordingStorage::RecordingStorage()
+    : QObject(nullptr)
+{
+    m_clock.start();
+}
+
+RecordingStorage::~RecordingStorage() {
+    shutdown();
+}
+
+qint64 RecordingStorage::expectedChunkBytes(int bitrateKbps, int chunkDurationSeconds) {
+    if (bitrateKbps <= 0 || chunkDurationSeconds <= 0) {
+        return 0;
+    }
+    // 10% on top for bitrate overshoot and the moov atom
+    return qint64(bitrateKbps) * 1000 / 8 * chunkDurationSeconds * 11 / 10;
+}
+
+void RecordingStorage::configure(const StorageConfig& config, const QString& rootDirectory) {
+    qDebug() << "RecordingStorage: Root" << rootDirectory
+             << "maxSize:" << config.maxSizeGB << "GB maxAge:" << config.maxAgeHours << "h"
+             << "minFree:" << config.minFreeMB << "MB flush:" << config.flushIntervalMs << "ms"
+             << (config.preallocate ? "(preallocate)" : "");
+
+    const QString root = rootDirectory.isEmpty() ? QString() : chunkKey(rootDirectory);
+    post([this, config, root]() {
+        m_config = config;
+        if (root != m_rootDirectory) {
+            m_rootDirectory = root;
+            m_lastScanMs = -1;  // Index the new directory on the next retention pass
+        }
+        enforceRetention();
+    });
+}
+
+void RecordingStorage::chunkStarted(int slotId, const QString& filename, qint64 expectedBytes) {
+    const QString key = chunkKey(filename);
+    post([this, slotId, key, expectedBytes]() { startChunk(slotId, key, expectedBytes); });
+}
+
+void RecordingStorage::chunkFinished(int slotId, const QString& filename, std::function<void()> close) {
+    const QString key = chunkKey(filename);
+    m_pendingFinalize++;
+    post([this, slotId, key, close = std::move(close)]() {
+        finalizeChunk(slotId, key, close);
+        m_pendingFinalize--;
+    });
+}
+
+void RecordingStorage::enforceRetentionNow() {
+    post([this]() { enforceRetention(); });
+}
+
+RecordingStorage::Stats RecordingStorage::stats() const {
+    Stats stats;
+    stats.ingestBytesPerSec = m_ingestBytesPerSec.load();
+    stats.flushBytesPerSec = m_flushBytesPerSec.load();
+    stats.utilization = m_utilization.load();
+    stats.backpressure = m_backpressure.load();
+    stats.openChunks = m_openCount.load();
+    stats.pendingFinalize = m_pendingFinalize.load();
+    stats.storedBytes = m_storedBytesPublished.load();
+    stats.freeBytes = m_freeBytes.load();
+    stats.chunksDeleted = m_chunksDeleted.load();
+    return stats;
+}
+
+void RecordingStorage::post(Job job) {
+    {
+        QMutexLocker locker(&m_jobMutex);
+        if (!m_stopped) {
+            if (!m_worker) {
+                m_worker = QThread::create([this]() { runWorker(); });
+                m_worker->setObjectName("RecordingStorage");
+                m_worker->start(QThread::LowPriority);
+            }
+            m_jobs.push_back(std::move(job));
+            m_jobCondition.wakeOne();
+            return;
+        }
+    }
+    // Storage thread is gone (exit): do the work on the caller's thread
+    job();
+}
+
+void RecordingStorage::shutdown() {
+    QThread* worker = nullptr;
+    {
+        QMutexLocker locker(&m_jobMutex);
+        if (m_stopping) {
+            return;
+        }
+        m_stopping = true;
+        worker = m_worker;
+        m_jobCondition.wakeOne();
+    }
+
+    if (worker) {
+        worker->wait();  // Drains the queue first
+    }
+
+    // Anything posted while the thread was exiting runs here
+    std::deque<Job> jobs;
+    {
+        QMutexLocker locker(&m_jobMutex);
+        jobs.swap(m_jobs);
+        m_stopped = true;
+        m_worker = nullptr;
+    }
+    for (Job& job : jobs) {
+        job();
+    }
+    delete worker;
+
+    // Recorders still writing keep their files; only give back unused reservations
+    for (auto it = m_openChunks.begin(); it != m_openChunks.end(); ++it) {
+        if (it->file) {
+            if (it->preallocated) {
+                trimFile(it->file, it->expectedBytes);
+            }
+            delete it->file;
+        }
+    }
+    m_openChunks.clear();
+    m_openCount = 0;
+}
+
+void RecordingStorage::runWorker() {
+    ThreadPolicy::instance().applyToCurrentThread(ThreadPolicy::Role::Storage);
+    QElapsedTimer& clock = m_clock;
+    qint64 lastTickMs = clock.elapsed();
+    qint64 lastRetentionMs = lastTickMs;
+
+    while (true) {
+        std::deque<Job> jobs;
+        {
+            QMutexLocker locker(&m_jobMutex);
+            if (m_jobs.empty() && !m_stopping) {
+                const int tickMs = m_config.flushIntervalMs > 0 ? m_config.flushIntervalMs : SAMPLE_INTERVAL_MS;
+                const qint64 waitMs = qMax<qint64>(1, lastTickMs + tickMs - clock.elapsed());
+                m_jobCondition.wait(&m_jobMutex, static_cast<unsigned long>(waitMs));
+            }
+            jobs.swap(m_jobs);
+            if (m_stopping && jobs.empty()) {
+                break;
+            }
+        }
+
+        for (Job& job : jobs) {
+            job();
+        }
+
+        const qint64 now = clock.elapsed();
+        const int tickMs = m_config.flushIntervalMs > 0 ? m_config.flushIntervalMs : SAMPLE_INTERVAL_MS;
+        if (now - lastTickMs >= tickMs) {
+            flushOpenChunks(qMax<qint64>(1, now - lastTickMs));
+            lastTickMs = now;
+        }
+        if (now - lastRetentionMs >= m_config.retentionIntervalSeconds * 1000LL) {
+            enforceRetention();
+            lastRetentionMs = now;
+        }
+    }
+}
+
+void RecordingStorage::startChunk(int slotId, const QString& filename, qint64 expectedBytes) {
+    if (m_openChunks.contains(filename)) {
+        return;
+    }
+    OpenChunk chunk;
+    chunk.slotId = slotId;
+    chunk.expectedBytes = expectedBytes;
+    openChunkFile(filename, chunk);  // Not there yet for QMediaRecorder - retried on flush
+    m_openChunks.insert(filename, chunk);
+    m_openCount = m_openChunks.size();
+}
+
+bool RecordingStorage::openChunkFile(const QString& filename, OpenChunk& chunk) {
+    // ReadWrite so nothing is truncated; the recorder keeps writing through its own handle
+    auto* file = new QFile(filename);
+    if (!file->open(QIODevice::ReadWrite | QIODevice::ExistingOnly)) {
+        delete file;
+        return false;
+    }
+    chunk.file = file;
+    if (m_config.preallocate && chunk.expectedBytes > 0) {
+        chunk.preallocated = preallocateFile(file, chunk.expectedBytes);
+    }
+    return true;
+}
+
+void RecordingStorage::finalizeChunk(int slotId, const QString& filename, const std::function<void()>& close) {
+    if (close) {
+        close();  // Trailer (moov) written here rather than on the recording thread
+    }
+
+    if (!m_openChunks.contains(filename) && !close) {
+        return;  // Not one of ours, or already finalized
+    }
+    OpenChunk chunk = m_openChunks.take(filename);
+    m_openCount = m_openChunks.size();
+
+    if (!chunk.file) {
+        chunk.expectedBytes = 0;  // Complete already - nothing left to reserve
+    }
+    if (!chunk.file && !openChunkFile(filename, chunk)) {
+        qDebug() << "RecordingStorage: Slot" << slotId << "chunk" << filename << "was never written";
+        return;
+    }
+
+    if (chunk.preallocated) {
+        trimFile(chunk.file, chunk.expectedBytes);
+    }
+    QElapsedTimer syncTimer;
+    syncTimer.start();
+    if (!syncFile(chunk.file)) {
+        qWarning() << "RecordingStorage: fsync failed for" << filename << "-" << std::strerror(errno);
+    }
+    const qint64 syncMs = syncTimer.elapsed();
+    const qint64 bytes = chunk.file->size();
+    delete chunk.file;
+
+    StoredChunk stored;
+    stored.path = filename;
+    stored.bytes = bytes;
+    stored.modified = QFileInfo(filename).lastModified();
+    m_storedChunks.append(stored);
+    m_storedBytes += bytes;
+    m_storedBytesPublished = m_storedBytes;
+
+    qDebug() << "RecordingStorage: Slot" << slotId << "finalized" << QFileInfo(filename).fileName()
+             << bytes / MB << "MB, sync" << syncMs << "ms";
+    emit chunkFinalized(slotId, filename, bytes);
+
+    // Don't wait for the next retention pass when the disk is about to fill
+    if (m_config.minFreeMB > 0) {
+        const QStorageInfo storage(filename);
+        if (storage.isValid() && storage.bytesAvailable() < m_config.minFreeMB * MB) {
+            enforceRetention();
+        }
+    }
+}
+
+void RecordingStorage::flushOpenChunks(qint64 intervalMs) {
+    const bool flush = m_config.flushIntervalMs > 0;
+    qint64 grown = 0;
+    qint64 syncMs = 0;
+    QElapsedTimer syncTimer;
+
+    for (auto it = m_openChunks.begin(); it != m_openChunks.end(); ++it) {
+        OpenChunk& chunk = it.value();
+        if (!chunk.file && !openChunkFile(it.key(), chunk)) {
+            continue;
+        }
+        const qint64 size = chunk.file->size();
+        const qint64 delta = size - chunk.lastSize;
+        chunk.lastSize = size;
+        if (delta <= 0) {
+            continue;
+        }
+        grown += delta;
+        if (flush) {
+            // Everything written since the last pass is still dirty in the page cache
+            syncTimer.start();
+            syncFile(chunk.file);
+            syncMs += syncTimer.elapsed();
+        }
+    }
+
+    m_ingestBytesPerSec = grown * 1000 / intervalMs;
+    if (!flush) {
+        return;
+    }
+    m_flushBytesPerSec = syncMs > 0 ? grown * 1000 / syncMs : m_ingestBytesPerSec.load();
+    updateBackpressure(static_cast<double>(syncMs) / intervalMs);
+}
+
+void RecordingStorage::updateBackpressure(double utilization) {
+    m_utilization = utilization;
+
+    // Hysteresis: on after consecutive busy intervals, off below half the limit
+    const double limit = m_config.backpressureUtilization;
+    if (utilization >= limit) {
+        m_highIntervals++;
+    } else {
+        m_highIntervals = 0;
+    }
+
+    if (!m_backpressure && m_highIntervals >= BACKPRESSURE_ON_INTERVALS) {
+        m_backpressure = true;
+        qWarning() << "RecordingStorage: Disk busy" << qRound(utilization * 100) << "% of the time, ingest"
+                   << m_ingestBytesPerSec.load() / MB << "MB/s - asking encoders to back off";
+        emit backpressureChanged(true);
+    } else if (m_backpressure && utilization < limit / 2) {
+        m_backpressure = false;
+        qDebug() << "RecordingStorage: Disk keeping up again (" << qRound(utilization * 100) << "% busy)";
+        emit backpressureChanged(false);
+    }
+}
+
+void RecordingStorage::scanStoredChunks() {
+    m_storedChunks.clear();
+    m_storedBytes = 0;
+
+    // Only files the recorders name: {chunk:03}_{yyyyMMdd_HHmmss}.mp4 in slot_N
+    static const QRegularExpression chunkName("^\\d{3,}_\\d{8}_\\d{6}\\.mp4$");
+    const QDir root(m_rootDirectory);
+    const QFileInfoList slotDirs = root.entryInfoList({"slot_*"}, QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QFileInfo& slotDir : slotDirs) {
+        const QFileInfoList files = QDir(slotDir.absoluteFilePath()).entryInfoList({"*.mp4"}, QDir::Files);
+        for (const QFileInfo& info : files) {
+            const QString path = chunkKey(info.absoluteFilePath());
+            if (!chunkName.match(info.fileName()).hasMatch() || m_openChunks.contains(path)) {
+                continue;
+            }
+            m_storedChunks.append(StoredChunk{path, info.size(), info.lastModified()});
+            m_storedBytes += info.size();
+        }
+    }
+
+    std::stable_sort(m_storedChunks.begin(), m_storedChunks.end(),
+                     [](const StoredChunk& a, const StoredChunk& b) { return a.modified < b.modified; });
+    qDebug() << "RecordingStorage: Indexed" << m_storedChunks.size() << "chunks,"
+             << m_storedBytes / MB << "MB in" << m_rootDirectory;
+}
+
+void RecordingStorage::enforceRetention() {
+    if (m_rootDirectory.isEmpty()) {
+        return;
+    }
+
+    if (m_lastScanMs < 0 || m_clock.elapsed() - m_lastScanMs >= RESCAN_INTERVAL_MS) {
+        scanStoredChunks();
+        m_lastScanMs = m_clock.elapsed();
+    }
+
+    const QStorageInfo storage(m_rootDirectory);
+    qint64 freeBytes = storage.isValid() ? storage.bytesAvailable() : -1;
+    const qint64 maxBytes = static_cast<qint64>(m_config.maxSizeGB * 1024 * MB);
+    const qint64 minFree = m_config.minFreeMB * MB;
+    const QDateTime cutoff = m_config.maxAgeHours > 0
+        ? QDateTime::currentDateTime().addSecs(-m_config.maxAgeHours * 3600LL) : QDateTime();
+
+    int deleted = 0;
+    qint64 freed = 0;
+    QHash<QString, QDate> prunedSlots;  // Slot folder -> UTC day of its newest deleted chunk
+    while (!m_storedChunks.isEmpty()) {
+        const StoredChunk& oldest = m_storedChunks.first();
+        const bool overSize = maxBytes > 0 && m_storedBytes > maxBytes;
+        const bool lowSpace = minFree > 0 && freeBytes >= 0 && freeBytes < minFree;
+        const bool expired = cutoff.isValid() && oldest.modified < cutoff;
+        if (!overSize && !lowSpace && !expired) {
+            break;
+        }
+
+        const StoredChunk chunk = m_storedChunks.takeFirst();
+        m_storedBytes -= chunk.bytes;
+        if (!QFile::remove(chunk.path) && QFileInfo::exists(chunk.path)) {
+            qWarning() << "RecordingStorage: Cannot delete" << chunk.path;
+            continue;
+        }
+        if (freeBytes >= 0) {
+            freeBytes += chunk.bytes;
+        }
+        freed += chunk.bytes;
+        deleted++;
+        m_chunksDeleted++;
+        prunedSlots[QFileInfo(chunk.path).absolutePath()] = chunk.modified.toUTC().date();
+        emit chunkDeleted(chunk.path);
+    }
+
+    // Timeline index days go with their chunks. A chunk may have started the
+    // day before it was last written, so that day's index stays.
+    for (auto it = prunedSlots.cbegin(); it != prunedSlots.cend(); ++it) {
+        ChunkIndex::removeDaysBefore(it.key(), it.value().addDays(-1));
+    }
+
+    if (deleted > 0) {
+        qDebug() << "RecordingStorage: Retention deleted" << deleted << "chunks," << freed / MB << "MB;"
+                 << m_storedBytes / MB << "MB kept," << (freeBytes >= 0 ? freeBytes / MB : -1) << "MB free";
+    }
+
+    const bool lowSpace = minFree > 0 && freeBytes >= 0 && freeBytes < minFree;
+    if (lowSpace && !m_lowSpaceWarned) {
+        qWarning() << "RecordingStorage: Only" << freeBytes / MB << "MB free in" << m_rootDirectory
+                   << "and no finished chunks left to delete";
+    }
+    m_lowSpaceWarned = lowSpace;
+    m_freeBytes = freeBytes;
+    m_storedBytesPublished = m_storedBytes;
+}
+
+bool RecordingStorage::preallocateFile(QFile* file, qint64 bytes) {
+#if defined(Q_OS_LINUX)
+    // KEEP_SIZE reserves blocks past EOF: the file still looks as long as what
+    // the muxer wrote, but its growth lands in one contiguous extent
+    if (::fallocate(file->handle(), FALLOC_FL_KEEP_SIZE, 0, bytes) == 0) {
+        return true;
+    }
+    if (errno != EOPNOTSUPP && errno != ENOSYS) {
+        qDebug() << "RecordingStorage: Cannot preallocate" << file->fileName() << "-" << std::strerror(errno);
+    }
+    return false;
+#else
+    // No reservation without changing the file size outside Linux
+    Q_UNUSED(file);
+    Q_UNUSED(bytes);
+    return false;
+#endif
+}
+
+void RecordingStorage::trimFile(QFile* file, qint64 reservedBytes) {
+#if defined(Q_OS_LINUX)
+    // Give back the reservation the chunk did not use
+    const qint64 size = file->size();
+    if (reservedBytes > size) {
+        ::fallocate(file->handle(), FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, size, reservedBytes - size);
+    }
+#else
+    Q_UNUSED(file);
+    Q_UNUSED(reservedBytes);
+#endif
+}
+
+bool RecordingStorage::syncFile(QFile* file) {
+#if defined(Q_OS_LINUX)
+    return ::fdatasync(file->handle()) == 0;
+#elif defined(Q_OS_UNIX)
+    return ::fsync(file->handle()) == 0;
+#elif defined(Q_OS_WIN)
+    return ::_commit(file->handle()) == 0;
+#else
+    return file->flush();
+#endif
+}
+
+} // namespace MCM
@@ -0,0 +1,212 @@
+#ifndef RECORDINGSTORAGE_H
+#define RECORDINGSTORAGE_H
+
+#include <QObject>
+#include <QString>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include "core/Config.h"
+
+class QThread;
+class QFile;
+
+namespace MCM {
+
+/**
+ * @brief Disk side of recording, shared by all recorders (Singleton)
+ *
+ * Recorders write their own chunks (QMediaRecorder, Mp4ChunkWriter); this
+ * class owns everything that touches the disk around them, on one storage
+ * thread instead of the GUI or capture threads:
+ * - Preallocation: each chunk's expected size is reserved up front
+ *   (fallocate, Linux) so 16 growing files do not interleave on disk.
+ * - Writeback: open chunks are flushed every flushIntervalMs, so the OS
+ *   never builds a rotation-sized burst of dirty pages, and finished chunks
+ *   are trimmed and fsynced here (the remux writer's trailer too).
+ * - Back-pressure: the share of each interval spent flushing is the disk's
+ *   utilization; above the limit backpressureChanged(true) tells adaptive
+ *   encoders to step down before the disk falls behind.
+ * - Retention: the recordings directory is one ring buffer for all slots.
+ *   The oldest chunks are deleted first to stay within the size and age
+ *   limits and above the free-space floor. Open chunks are never deleted.
+ *
+ * Usage:
+ *   RecordingStorage::instance().configure(config.storage(), recordingsDir);
+ *   RecordingStorage::instance().chunkStarted(slotId, filename, expectedBytes);
+ *   ...
+ *   RecordingStorage::instance().chunkFinished(slotId, filename);
+ */
+class RecordingStorage : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Disk figures of the last flush interval
+     */
+    struct Stats {
+        qint64 ingestBytesPerSec{0};   // Growth of all open chunks
+        qint64 flushBytesPerSec{0};    // Write-back rate the disk achieved
+        double utilization{0.0};       // Share of the interval spent flushing
+        bool backpressure{false};
+        int openChunks{0};
+        int pendingFinalize{0};
+        qint64 storedBytes{0};         // Finished chunks under the retention policy
+        qint64 freeBytes{-1};
+        quint64 chunksDeleted{0};
+    };
+
+    static RecordingStorage& instance();
+
+    // Prevent copying
+    RecordingStorage(const RecordingStorage&) = delete;
+    RecordingStorage& operator=(const RecordingStorage&) = delete;
+
+    /**
+     * @brief Apply a storage policy to a recordings directory
+     * @param rootDirectory Absolute recordings directory (holds the slot_N folders)
+     *
+     * Until this is called nothing is deleted; chunks are still preallocated,
+     * flushed and synced with the default policy.
+     */
+    void configure(const StorageConfig& config, const QString& rootDirectory);
+
+    /**
+     * @brief A recorder started writing @p filename (callable from any thread)
+     * @param expectedBytes Size to preallocate (0 = unknown, no preallocation)
+     *
+     * The file may not exist yet (QMediaRecorder creates it asynchronously);
+     * it is picked up on the next flush.
+     */
+    void chunkStarted(int slotId, const QString& filename, qint64 expectedBytes);
+
+    /**
+     * @brief A recorder is done with @p filename (callable from any thread)
+     * @param close Runs first on the storage thread, e.g. to write the
+     *        container trailer; empty if the file is already closed
+     *
+     * The file is then trimmed to its real size, fsynced and handed to the
+     * retention policy; chunkFinalized() follows.
+     */
+    void chunkFinished(int slotId, const QString& filename, std::function<void()> close = {});
+
+    /**
+     * @brief Disk cannot keep up with the write rate (thread-safe)
+     */
+    bool backpressure() const { return m_backpressure.load(); }
+
+    Stats stats() const;
+
+    /**
+     * @brief Run the retention policy now (asynchronous)
+     */
+    void enforceRetentionNow();
+
+    /**
+     * @brief Finish all queued finalizations and stop the storage thread
+     *
+     * Called at exit; later chunkFinished() calls run inline.
+     */
+    void shutdown();
+
+    /**
+     * @brief Expected chunk size for a bitrate, with headroom for the container
+     */
+    static qint64 expectedChunkBytes(int bitrateKbps, int chunkDurationSeconds);
+
+signals:
+    /**
+     * @brief Disk utilization crossed the limit (emitted on the storage thread)
+     */
+    void backpressureChanged(bool active);
+
+    /**
+     * @brief Chunk is closed, synced and on disk (emitted on the storage thread)
+     */
+    void chunkFinalized(int slotId, const QString& filename, qint64 bytes);
+
+    /**
+     * @brief Retention removed a chunk (emitted on the storage thread)
+     */
+    void chunkDeleted(const QString& filename);
+
+private:
+    RecordingStorage();
+    ~RecordingStorage() override;
+
+    struct OpenChunk {
+        int slotId{0};
+        qint64 expectedBytes{0};
+        QFile* file{nullptr};      // Our own handle, once the recorder has created the file
+        bool preallocated{false};
+        qint64 lastSize{0};
+    };
+
+    struct StoredChunk {
+        QString path;
+        qint64 bytes{0};
+        QDateTime modified;
+    };
+
+    using Job = std::function<void()>;
+
+    void post(Job job);
+    void runWorker();
+
+    // Storage thread
+    void startChunk(int slotId, const QString& filename, qint64 expectedBytes);
+    void finalizeChunk(int slotId, const QString& filename, const std::function<void()>& close);
+    bool openChunkFile(const QString& filename, OpenChunk& chunk);
+    void flushOpenChunks(qint64 intervalMs);
+    void updateBackpressure(double utilization);
+    void scanStoredChunks();
+    void enforceRetention();
+
+    static bool preallocateFile(QFile* file, qint64 bytes);
+    static void trimFile(QFile* file, qint64 reservedBytes);
+    static bool syncFile(QFile* file);
+
+    // Configuration, copied to the storage thread through jobs
+    StorageConfig m_config;
+    QString m_rootDirectory;
+
+    QThread* m_worker{nullptr};
+    QMutex m_jobMutex;
+    QWaitCondition m_jobCondition;
+    std::deque<Job> m_jobs;
+    bool m_stopping{false};
+    bool m_stopped{false};     // Jobs run inline from here on
+
+    // Storage thread state
+    QHash<QString, OpenChunk> m_openChunks;
+    QList<StoredChunk> m_storedChunks;   // Oldest first
+    qint64 m_storedBytes{0};
+    int m_highIntervals{0};
+    qint64 m_lastScanMs{-1};
+    bool m_lowSpaceWarned{false};
+    QElapsedTimer m_clock;
+
+    // Published for stats() and backpressure()
+    std::atomic<bool> m_backpressure{false};
+    std::atomic<qint64> m_ingestBytesPerSec{0};
+    std::atomic<qint64> m_flushBytesPerSec{0};
+    std::atomic<double> m_utilization{0.0};
+    std::atomic<int> m_openCount{0};
+    std::atomic<int> m_pendingFinalize{0};
+    std::atomic<qint64> m_storedBytesPublished{0};
+    std::atomic<qint64> m_freeBytes{-1};
+    std::atomic<quint64> m_chunksDeleted{0};
+
+    static constexpr int BACKPRESSURE_ON_INTERVALS = 2;  // Consecutive busy intervals before signalling
+    static constexpr qint64 RESCAN_INTERVAL_MS = 30 * 60 * 1000;  // Pick up files changed behind our back
+};
+
+} // namespace MCM
+
+#endif // RECORDINGSTORAGE_H
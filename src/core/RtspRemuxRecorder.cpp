@@ -0,0 +1,508 @@
+#include "RtspRemuxRecorder.h"
+#include "ChunkIndex.h"
+#include "Mp4ChunkWriter.h"
+#include "QtVideoRecorder.h"
+#include "ReconnectBackoff.h"
+#include "RecordingStorage.h"
+#include "PacketRing.h"
+#include "MemoryGovernor.h"
+#include "Fmp4Segmenter.h"
+#include "StreamEgress.h"
+#include "ThreadPolicy.h"
+#include <QThread>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QDebug>
+#include <memory>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/error.h>
+#include <libavutil/mathematics.h>
+}
+
+namespace MCM {
+
+namespace {
+
+QString ffmpegError(int code) {
+    char buffer[AV_ERROR_MAX_STRING_SIZE] = {0};
+    av_strerror(code, buffer, sizeof(buffer));
+    return QString::fromUtf8(buffer);
+}
+
+} // namespace
+
+RtspRemuxRecorder::RtspRemuxRecorder(int slotId, QObject* parent)
+    : QObject(parent)
+    , m_slotId(slotId)
+{
+    qDebug() << "RtspRemuxRecorder: Creating passthrough recorder for slot" << slotId;
+    m_eventClock.start();
+
+    // The pre-roll ring is the only large buffer here
+    m_memoryConsumer = MemoryGovernor::instance().addConsumer({"preroll", slotId,
+        [this]() { return m_preRollBytes.load(std::memory_order_relaxed); },
+        [this]() { return qMin(m_preRollBytes.load(std::memory_order_relaxed), MIN_PREROLL_BYTES); },
+        [this](qint64 limit) { m_preRollLimit.store(limit, std::memory_order_relaxed); }});
+}
+
+RtspRemuxRecorder::~RtspRemuxRecorder() {
+    MemoryGovernor::instance().removeConsumer(m_memoryConsumer);
+    stopRecording();
+}
+
+void RtspRemuxRecorder::setRtspUrl(const QString& url) {
+    QMutexLocker locker(&m_mutex);
+    m_rtspUrl = url;
+}
+
+QString RtspRemuxRecorder::rtspUrl() const {
+    QMutexLocker locker(&m_mutex);
+    return m_rtspUrl;
+}
+
+void RtspRemuxRecorder::setEventMode(bool enabled, const EventRecordingConfig& config) {
+    if (m_recording) {
+        qWarning() << "RtspRemuxRecorder: Cannot change event mode while recording";
+        return;
+    }
+    m_eventMode = enabled;
+    m_eventConfig = config;
+}
+
+void RtspRemuxRecorder::setEgress(bool enabled, bool writeChunks) {
+    if (m_recording) {
+        qWarning() << "RtspRemuxRecorder: Cannot change egress while recording";
+        return;
+    }
+    m_egress = enabled;
+    m_writeChunks = writeChunks || !enabled;  // Without egress the worker only records
+}
+
+void RtspRemuxRecorder::trigger() {
+    if (!m_eventMode) {
+        return;
+    }
+    const qint64 until = m_eventClock.elapsed() + m_eventConfig.postRollSeconds * 1000LL;
+    if (!isEventActive()) {
+        qDebug() << "RtspRemuxRecorder slot" << m_slotId << ": Event started, recording until"
+                 << m_eventConfig.postRollSeconds << "s after the last trigger";
+    }
+    m_eventUntilMs = until;
+}
+
+bool RtspRemuxRecorder::isEventActive() const {
+    return m_eventClock.elapsed() < m_eventUntilMs.load();
+}
+
+bool RtspRemuxRecorder::startRecording(const QString& outputDirectory, int chunkDurationSeconds) {
+    if (m_recording) {
+        qDebug() << "RtspRemuxRecorder: Already recording for slot" << m_slotId;
+        return true;
+    }
+
+    if (rtspUrl().isEmpty()) {
+        emit errorOccurred("No RTSP URL set");
+        return false;
+    }
+
+    m_outputDirectory = QtVideoRecorder::resolveOutputDirectory(outputDirectory);
+    m_chunkDurationSeconds = qMax(1, chunkDurationSeconds);
+    m_chunkNumber = 0;
+    const std::shared_ptr<const ConfigSnapshot> config = Config::instance().current();
+    m_reconnectConfig = config->reconnect;
+
+    m_egressFragmentMs = config->egress.fragmentMs;
+
+    if (m_writeChunks) {
+        QString slotDir = QString("%1/slot_%2").arg(m_outputDirectory).arg(m_slotId);
+        if (!QtVideoRecorder::ensureDirectoryExists(slotDir)) {
+            emit errorOccurred(QString("Failed to create output directory: %1").arg(slotDir));
+            return false;
+        }
+
+        qDebug() << "RtspRemuxRecorder: Starting passthrough recording for slot" << m_slotId;
+        qDebug() << "  Output directory:" << m_outputDirectory;
+        qDebug() << "  Chunk duration:" << m_chunkDurationSeconds << "seconds";
+        if (m_eventMode) {
+            qDebug() << "  Event mode: pre-roll" << m_eventConfig.preRollSeconds << "s, post-roll"
+                     << m_eventConfig.postRollSeconds << "s";
+        }
+    } else {
+        qDebug() << "RtspRemuxRecorder: Starting stream egress for slot" << m_slotId << "(not recording)";
+    }
+    if (m_egress) {
+        qDebug() << "  Re-published through StreamEgress," << m_egressFragmentMs << "ms fragments";
+    }
+
+    m_stopRequested = false;
+    m_eventUntilMs = -1;  // A new recording waits for its first trigger
+    m_recording = true;
+
+    m_worker = QThread::create([this]() { runWorker(); });
+    m_worker->setObjectName(QString("RtspRemux-%1").arg(m_slotId));
+    m_worker->start();
+
+    emit recordingStateChanged(true);
+    return true;
+}
+
+void RtspRemuxRecorder::stopRecording() {
+    if (!m_recording) {
+        return;
+    }
+
+    qDebug() << "RtspRemuxRecorder: Stopping recording for slot" << m_slotId;
+
+    // Interrupt callback aborts any blocking network read
+    m_stopRequested = true;
+    if (m_worker) {
+        m_worker->wait();
+        delete m_worker;
+        m_worker = nullptr;
+    }
+
+    m_recording = false;
+    emit recordingStateChanged(false);
+}
+
+int RtspRemuxRecorder::interruptCallback(void* opaque) {
+    auto* self = static_cast<RtspRemuxRecorder*>(opaque);
+    return self->m_stopRequested.load() ? 1 : 0;
+}
+
+void RtspRemuxRecorder::runWorker() {
+    ThreadPolicy::instance().applyToCurrentThread(ThreadPolicy::Role::Recording);
+    
+    // Never gives up on its own: the slot stops recording when the stream is lost for good
+    ReconnectBackoff backoff(m_reconnectConfig);
+    QElapsedTimer sessionTimer;
+    while (!m_stopRequested) {
+        QString error;
+        sessionTimer.start();
+        const bool ok = recordSession(&error);
+        if (sessionTimer.elapsed() >= STABLE_SESSION_MS) {
+            backoff.reset();
+        }
+        const int delayMs = backoff.nextDelayMs();
+        if (!ok && !m_stopRequested) {
+            qWarning() << "RtspRemuxRecorder slot" << m_slotId << ":" << error
+                       << "- reconnecting in" << delayMs << "ms (attempt" << backoff.attempts() << ")";
+            emit errorOccurred(error);
+        }
+
+        // Sleep in small steps so stopRecording() does not wait for the full delay
+        QElapsedTimer waited;
+        waited.start();
+        while (waited.elapsed() < delayMs && !m_stopRequested) {
+            QThread::msleep(static_cast<unsigned long>(qBound<qint64>(1, delayMs - waited.elapsed(), 100)));
+        }
+    }
+}
+
+bool RtspRemuxRecorder::recordSession(QString* error) {
+    const QByteArray url = rtspUrl().toUtf8();
+
+    AVFormatContext* input = avformat_alloc_context();
+    if (!input) {
+        *error = "Out of memory";
+        return false;
+    }
+    input->interrupt_callback.callback = &RtspRemuxRecorder::interruptCallback;
+    input->interrupt_callback.opaque = this;
+
+    const double replayRate = m_replayRate.load();
+    AVDictionary* options = nullptr;
+    if (replayRate <= 0) {
+        av_dict_set(&options, "rtsp_transport", "tcp", 0);  // No UDP packet loss in recordings
+        av_dict_set(&options, "timeout", QByteArray::number(SOCKET_TIMEOUT_US).constData(), 0);
+    }
+
+    int ret = avformat_open_input(&input, url.constData(), nullptr, &options);
+    av_dict_free(&options);
+    if (ret < 0) {
+        // avformat_open_input frees the context on failure
+        *error = QString("Cannot open RTSP stream: %1").arg(ffmpegError(ret));
+        return false;
+    }
+
+    ret = avformat_find_stream_info(input, nullptr);
+    if (ret < 0) {
+        *error = QString("Cannot read stream info: %1").arg(ffmpegError(ret));
+        avformat_close_input(&input);
+        return false;
+    }
+
+    const int videoIndex = av_find_best_stream(input, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (videoIndex < 0) {
+        *error = "No video stream in RTSP source";
+        avformat_close_input(&input);
+        return false;
+    }
+
+    AVStream* videoStream = input->streams[videoIndex];
+    const AVRational timeBase = videoStream->time_base;
+    qDebug() << "RtspRemuxRecorder slot" << m_slotId << ": Remuxing"
+             << avcodec_get_name(videoStream->codecpar->codec_id)
+             << videoStream->codecpar->width << "x" << videoStream->codecpar->height;
+
+    // Egress: a second, in-memory mux of the same packets for network viewers
+    std::unique_ptr<Fmp4Segmenter> egress;
+    if (m_egress && StreamEgress::instance().isEnabled()) {
+        egress = std::make_unique<Fmp4Segmenter>([this](const QByteArray& fragment, bool keyframe) {
+            StreamEgress::instance().publishFragment(m_slotId, fragment, keyframe);
+        });
+        QString egressError;
+        if (egress->open(videoStream->codecpar, timeBase, m_egressFragmentMs, &egressError)) {
+            StreamEgress::instance().startStream(m_slotId, egress->initSegment());
+        } else {
+            qWarning() << "RtspRemuxRecorder slot" << m_slotId << ": Stream egress unavailable:" << egressError;
+            egress.reset();
+        }
+    }
+    const bool writeChunks = m_writeChunks.load();
+
+    AVPacket* packet = av_packet_alloc();
+    auto writer = std::make_shared<Mp4ChunkWriter>();
+    qint64 lastChunkBytes = 0;   // Size and length of the previous chunk, to size the next one
+    qint64 lastChunkMs = 0;
+    int64_t chunkStartTs = AV_NOPTS_VALUE;
+    QElapsedTimer chunkClock;  // Fallback when the camera sends no timestamps
+    int chunkNumber = 0;
+    bool ok = true;
+
+    // File replay: pace packets to wall time and continue the timeline across loops
+    QElapsedTimer replayClock;
+    int64_t replayStartTs = AV_NOPTS_VALUE;  // First (shifted) dts, at replayClock = 0
+    int64_t fileFirstTs = AV_NOPTS_VALUE;    // First timestamp in the file
+    int64_t lastTs = AV_NOPTS_VALUE;         // Highest (shifted) timestamp written
+    int64_t frameDuration = 1;
+    int64_t loopOffset = 0;
+    if (videoStream->avg_frame_rate.num > 0) {
+        frameDuration = qMax<int64_t>(1, av_rescale_q(1, av_inv_q(videoStream->avg_frame_rate), timeBase));
+    }
+
+    // Event mode: packets wait in the pre-roll ring until a trigger
+    const bool eventMode = m_eventMode.load();
+    const qint64 preRollMs = m_eventConfig.preRollSeconds * 1000LL;
+    const qint64 preRollMaxBytes = m_eventConfig.preRollMaxMB * 1024LL * 1024LL;
+    PacketRing preRoll(preRollMs, preRollMaxBytes);
+    qint64 preRollLimit = -1;  // Governor cap applied to the ring
+    QElapsedTimer sessionClock;  // Ring time for packets without timestamps
+    sessionClock.start();
+    const int chunkSeconds = eventMode
+        ? qMin(m_chunkDurationSeconds, m_eventConfig.preRollSeconds + m_eventConfig.postRollSeconds)
+        : m_chunkDurationSeconds;
+
+    auto finishChunk = [&]() {
+        if (writer->isOpen()) {
+            const QString filename = writer->filename();
+            lastChunkBytes = writer->bytesWritten();
+            lastChunkMs = writer->durationMs();
+            // Trailer and fsync on the storage thread; the next chunk opens right away
+            std::shared_ptr<Mp4ChunkWriter> finished = std::move(writer);
+            writer = std::make_shared<Mp4ChunkWriter>();
+            RecordingStorage::instance().chunkFinished(m_slotId, filename, [finished]() { finished->close(); });
+            ChunkIndexWriter::instance().chunkFinished(m_slotId, chunkNumber, lastChunkMs, lastChunkBytes);
+            qDebug() << "RtspRemuxRecorder slot" << m_slotId << ": Chunk" << chunkNumber << "completed";
+            emit chunkCompleted(chunkNumber, filename);
+        }
+    };
+
+    // Every keyframe that goes into a chunk is indexed: the timeline seeks straight to it
+    auto writeChunkPacket = [&](const AVPacket* chunkPacket, QString* writeError) {
+        if (chunkPacket->flags & AV_PKT_FLAG_KEY) {
+            const int64_t keyTs = chunkPacket->pts != AV_NOPTS_VALUE ? chunkPacket->pts : chunkPacket->dts;
+            const qint64 offsetMs = (keyTs != AV_NOPTS_VALUE && chunkStartTs != AV_NOPTS_VALUE)
+                ? av_rescale_q(keyTs - chunkStartTs, timeBase, AVRational{1, 1000})
+                : chunkClock.elapsed();
+            ChunkIndexWriter::instance().keyframe(m_slotId, chunkNumber, qMax<qint64>(0, offsetMs),
+                                                  writer->bytesWritten());
+        }
+        return writer->write(chunkPacket, writeError);
+    };
+
+    while (!m_stopRequested) {
+        ret = av_read_frame(input, packet);
+        if (ret == AVERROR_EOF && replayRate > 0 && lastTs != AV_NOPTS_VALUE) {
+            // Loop: the next pass starts one frame after the last one written
+            loopOffset = lastTs + frameDuration - fileFirstTs;
+            const int64_t start = videoStream->start_time != AV_NOPTS_VALUE ? videoStream->start_time : 0;
+            ret = av_seek_frame(input, videoIndex, start, AVSEEK_FLAG_BACKWARD);
+            if (ret >= 0) {
+                continue;
+            }
+        }
+        if (ret < 0) {
+            if (!m_stopRequested) {
+                *error = ret == AVERROR_EOF ? QString("RTSP stream ended")
+                                            : QString("RTSP read failed: %1").arg(ffmpegError(ret));
+                ok = false;
+            }
+            break;
+        }
+
+        if (packet->stream_index != videoIndex) {
+            av_packet_unref(packet);
+            continue;
+        }
+
+        if (replayRate > 0) {
+            if (fileFirstTs == AV_NOPTS_VALUE) {
+                fileFirstTs = packet->dts != AV_NOPTS_VALUE ? packet->dts : packet->pts;
+            }
+            if (packet->pts != AV_NOPTS_VALUE) {
+                packet->pts += loopOffset;
+            }
+            if (packet->dts != AV_NOPTS_VALUE) {
+                packet->dts += loopOffset;
+            }
+
+            // dts is monotonic (pts is not with B-frames)
+            const int64_t paceTs = packet->dts != AV_NOPTS_VALUE ? packet->dts : packet->pts;
+            if (paceTs != AV_NOPTS_VALUE) {
+                if (replayStartTs == AV_NOPTS_VALUE) {
+                    replayStartTs = paceTs;
+                    replayClock.start();
+                }
+                const qint64 dueMs = static_cast<qint64>(
+                    av_rescale_q(paceTs - replayStartTs, timeBase, AVRational{1, 1000}) / replayRate);
+                while (!m_stopRequested && replayClock.elapsed() < dueMs) {
+                    QThread::msleep(static_cast<unsigned long>(qMin<qint64>(20, dueMs - replayClock.elapsed())));
+                }
+                lastTs = qMax(lastTs == AV_NOPTS_VALUE ? paceTs : lastTs,
+                              qMax(paceTs, packet->pts != AV_NOPTS_VALUE ? packet->pts : paceTs));
+            }
+            if (packet->duration > 0) {
+                frameDuration = packet->duration;
+            }
+        }
+
+        // Viewers get every packet, whether or not a chunk or event is open
+        if (egress) {
+            QString egressError;
+            if (!egress->write(packet, &egressError)) {
+                qWarning() << "RtspRemuxRecorder slot" << m_slotId << ": Stream egress stopped:" << egressError;
+                egress.reset();
+                StreamEgress::instance().endStream(m_slotId);
+            }
+        }
+        if (!writeChunks) {
+            av_packet_unref(packet);
+            continue;
+        }
+
+        const bool keyframe = (packet->flags & AV_PKT_FLAG_KEY) != 0;
+        const int64_t ts = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+
+        const bool recordingEvent = !eventMode || isEventActive();
+
+        if (writer->isOpen() && keyframe) {
+            // Cut only on keyframes so each chunk starts decodable (an event
+            // that is over is cut here too, and this keyframe opens the next pre-roll)
+            const qint64 elapsedMs = (ts != AV_NOPTS_VALUE && chunkStartTs != AV_NOPTS_VALUE)
+                ? av_rescale_q(ts - chunkStartTs, timeBase, AVRational{1, 1000})
+                : chunkClock.elapsed();
+            if (elapsedMs >= m_chunkDurationSeconds * 1000LL || !recordingEvent) {
+                finishChunk();
+            }
+        }
+
+        if (!writer->isOpen() && !recordingEvent) {
+            const qint64 limit = m_preRollLimit.load(std::memory_order_relaxed);
+            if (limit != preRollLimit) {
+                preRollLimit = limit;
+                preRoll.setLimits(preRollMs, limit < 0 ? preRollMaxBytes : qBound<qint64>(1, limit, preRollMaxBytes));
+            }
+            const int64_t ringTs = packet->dts != AV_NOPTS_VALUE ? packet->dts : ts;
+            preRoll.push(packet, ringTs != AV_NOPTS_VALUE
+                ? av_rescale_q(ringTs, timeBase, AVRational{1, 1000}) : sessionClock.elapsed());
+            m_preRollBytes.store(preRoll.bytes(), std::memory_order_relaxed);
+            av_packet_unref(packet);
+            continue;
+        }
+
+        if (!writer->isOpen()) {
+            // The chunk opens on a keyframe: the oldest pre-roll packet, or this one
+            const AVPacket* first = preRoll.isEmpty() ? packet : preRoll.front();
+            if (!(first->flags & AV_PKT_FLAG_KEY)) {
+                av_packet_unref(packet);  // Wait for the first keyframe
+                continue;
+            }
+            const int64_t firstTs = first->pts != AV_NOPTS_VALUE ? first->pts : first->dts;
+
+            chunkNumber = ++m_chunkNumber;
+            const QDateTime openedAt = QDateTime::currentDateTime();
+            const QString filename = QtVideoRecorder::chunkFilename(
+                m_outputDirectory, m_slotId, chunkNumber, openedAt);
+            QtVideoRecorder::ensureDirectoryExists(QFileInfo(filename).absolutePath());
+
+            QString openError;
+            if (!writer->open(filename, videoStream->codecpar, timeBase, &openError)) {
+                *error = openError;
+                ok = false;
+                av_packet_unref(packet);
+                break;
+            }
+
+            // Camera bitrate: measured on the last chunk, else what the stream advertises
+            qint64 expectedBytes = 0;
+            if (lastChunkBytes > 0 && lastChunkMs > 0) {
+                expectedBytes = lastChunkBytes * chunkSeconds * 1000 / lastChunkMs * 11 / 10;
+            } else if (videoStream->codecpar->bit_rate > 0) {
+                expectedBytes = RecordingStorage::expectedChunkBytes(
+                    static_cast<int>(videoStream->codecpar->bit_rate / 1000), chunkSeconds);
+            }
+            RecordingStorage::instance().chunkStarted(m_slotId, filename, expectedBytes);
+
+            chunkStartTs = firstTs;
+            chunkClock.start();
+            // With pre-roll the chunk's first frame is older than the file
+            ChunkIndexWriter::instance().chunkStarted(m_slotId, filename, chunkNumber, openedAt,
+                openedAt.toMSecsSinceEpoch() - preRoll.durationMs());
+            qDebug() << "RtspRemuxRecorder slot" << m_slotId << ": Chunk" << chunkNumber << "started:" << filename
+                     << (preRoll.isEmpty() ? QString() : QString("(pre-roll %1 ms)").arg(preRoll.durationMs()));
+            emit chunkStarted(chunkNumber, filename);
+
+            // Pre-roll goes in first, then the live stream continues
+            QString preRollError;
+            while (AVPacket* buffered = preRoll.pop()) {
+                if (ok && !writeChunkPacket(buffered, &preRollError)) {
+                    *error = preRollError;
+                    ok = false;
+                }
+                av_packet_free(&buffered);
+            }
+            m_preRollBytes.store(0, std::memory_order_relaxed);
+            if (!ok) {
+                av_packet_unref(packet);
+                break;
+            }
+        }
+
+        QString writeError;
+        if (!writeChunkPacket(packet, &writeError)) {
+            *error = writeError;
+            ok = false;
+            av_packet_unref(packet);
+            break;
+        }
+        av_packet_unref(packet);
+    }
+
+    finishChunk();
+    if (egress) {
+        egress->close();  // Last fragment still goes out
+        StreamEgress::instance().endStream(m_slotId);
+    }
+    preRoll.clear();
+    m_preRollBytes.store(0, std::memory_order_relaxed);
+    av_packet_free(&packet);
+    avformat_close_input(&input);
+    return ok;
+}
+
+} // namespace MCM
@@ -0,0 +1,194 @@
+#ifndef RTSPREMUXRECORDER_H
+#define RTSPREMUXRECORDER_H
+
+#include <QObject>
+#include <QString>
+#include <QDateTime>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <atomic>
+#include "core/Config.h"
+
+class QThread;
+
+namespace MCM {
+
+/**
+ * @brief Chunked MP4 recorder for RTSP cameras without re-encoding
+ *
+ * IP cameras already deliver H.264/H.265. This recorder opens the stream
+ * with libavformat and copies the compressed packets straight into MP4
+ * chunks (no decode/encode round trip), so recording costs almost no CPU.
+ *
+ * Chunks are cut on keyframes, so every file starts decodable. Files use
+ * the same layout as QtVideoRecorder: {dir}/slot_{N}/{chunk:03}_{time}.mp4
+ *
+ * Note: QMediaPlayer does not expose compressed packets, so this opens its
+ * own RTSP session alongside the preview player (TCP interleaved). A failed
+ * session is reopened with the same backoff policy as the player
+ * (ReconnectConfig), until stopRecording(). With setEgress() the same
+ * packets are also re-published to network viewers (StreamEgress).
+ *
+ * Usage:
+ *   RtspRemuxRecorder* recorder = new RtspRemuxRecorder(slotId);
+ *   recorder->setRtspUrl(url);
+ *   recorder->startRecording(outputDir, chunkDurationSec);
+ */
+class RtspRemuxRecorder : public QObject {
+    Q_OBJECT
+
+public:
+    explicit RtspRemuxRecorder(int slotId, QObject* parent = nullptr);
+    ~RtspRemuxRecorder() override;
+
+    /**
+     * @brief Set the RTSP URL to record from
+     *
+     * Must be called before startRecording()
+     */
+    void setRtspUrl(const QString& url);
+    QString rtspUrl() const;
+
+    /**
+     * @brief Treat the URL as a local file replayed like a live camera (File source type)
+     * @param playbackRate Packets are written at this multiple of real time and
+     *        the file loops; 0 (default) = live stream, write packets as they arrive
+     *
+     * Must be called before startRecording()
+     */
+    void setFileReplay(double playbackRate) { m_replayRate = qMax(0.0, playbackRate); }
+
+    /**
+     * @brief Record only around triggers (recording.mode = "event")
+     *
+     * Between events the last preRollSeconds of packets are kept in memory
+     * (PacketRing); trigger() writes them into a new chunk followed by the
+     * live stream, until postRollSeconds after the last trigger. The stream
+     * is still read, so the pre-roll is always warm. The ring counts against
+     * MemoryGovernor's budget and may be held below preRollMaxMB.
+     *
+     * Must be called before startRecording()
+     */
+    void setEventMode(bool enabled, const EventRecordingConfig& config = EventRecordingConfig());
+    bool eventMode() const { return m_eventMode; }
+
+    /**
+     * @brief Re-publish the stream through StreamEgress while the worker runs
+     * @param writeChunks false = stream only, nothing is written to disk
+     *
+     * Packets are muxed once more into fragmented MP4 (Fmp4Segmenter) for
+     * network viewers, independent of chunks and events. The egress server
+     * must be enabled when a session opens.
+     *
+     * Must be called before startRecording()
+     */
+    void setEgress(bool enabled, bool writeChunks = true);
+
+    /**
+     * @brief Start an event, or extend the running one (thread-safe, event mode only)
+     */
+    void trigger();
+
+    /**
+     * @brief Whether an event is being recorded (post-roll not over)
+     */
+    bool isEventActive() const;
+
+    /**
+     * @brief Start chunk-based recording
+     * @param outputDirectory Base directory for recordings
+     * @param chunkDurationSeconds Duration of each chunk (default 300 = 5 min)
+     * @return true if the recording worker was started
+     */
+    bool startRecording(const QString& outputDirectory, int chunkDurationSeconds = 300);
+
+    /**
+     * @brief Stop recording and finalize current chunk (blocks until the worker exits)
+     */
+    void stopRecording();
+
+    /**
+     * @brief Check if currently recording
+     */
+    bool isRecording() const { return m_recording; }
+
+    /**
+     * @brief Get the slot ID
+     */
+    int slotId() const { return m_slotId; }
+
+    /**
+     * @brief Get current chunk number
+     */
+    int currentChunkNumber() const { return m_chunkNumber; }
+
+signals:
+    /**
+     * @brief Emitted when a new chunk is started
+     */
+    void chunkStarted(int chunkNumber, const QString& filename);
+
+    /**
+     * @brief Emitted when a chunk is completed
+     *
+     * The file is handed to RecordingStorage, which writes the trailer and
+     * syncs it shortly after (RecordingStorage::chunkFinalized).
+     */
+    void chunkCompleted(int chunkNumber, const QString& filename);
+
+    /**
+     * @brief Emitted when an error occurs
+     */
+    void errorOccurred(const QString& message);
+
+    /**
+     * @brief Emitted when recording state changes
+     */
+    void recordingStateChanged(bool recording);
+
+private:
+    /**
+     * @brief Worker thread body: connect, remux, reconnect until stopped
+     */
+    void runWorker();
+
+    /**
+     * @brief One RTSP session; returns when the stream ends or fails
+     */
+    bool recordSession(QString* error);
+
+    static int interruptCallback(void* opaque);
+
+    int m_slotId;
+    std::atomic<bool> m_recording{false};
+    std::atomic<bool> m_stopRequested{false};
+    std::atomic<int> m_chunkNumber{0};
+
+    mutable QMutex m_mutex;  // Guards m_rtspUrl
+    QString m_rtspUrl;
+    QString m_outputDirectory;
+    int m_chunkDurationSeconds{300};
+    std::atomic<double> m_replayRate{0.0};
+    ReconnectConfig m_reconnectConfig;  // Copied in startRecording(), read by the worker
+
+    std::atomic<bool> m_eventMode{false};
+    EventRecordingConfig m_eventConfig;  // Set while stopped, read by the worker
+    std::atomic<bool> m_egress{false};
+    std::atomic<bool> m_writeChunks{true};
+    int m_egressFragmentMs{500};         // Copied in startRecording(), read by the worker
+    QElapsedTimer m_eventClock;
+    std::atomic<qint64> m_eventUntilMs{-1};  // Event runs while m_eventClock is below this
+    std::atomic<qint64> m_preRollBytes{0};   // Held by the worker's ring (MemoryGovernor)
+    std::atomic<qint64> m_preRollLimit{-1};  // Governor cap on the ring (-1 = preRollMaxMB)
+    int m_memoryConsumer{0};
+
+    QThread* m_worker{nullptr};
+
+    static constexpr int STABLE_SESSION_MS = 10000;  // A session this long resets the backoff
+    static constexpr int SOCKET_TIMEOUT_US = 5000000;  // 5s
+    static constexpr qint64 MIN_PREROLL_BYTES = 2 * 1024 * 1024;  // Kept under memory pressure
+};
+
+} // namespace MCM
+
+#endif // RTSPREMUXRECORDER_H
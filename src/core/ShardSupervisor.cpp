@@ -0,0 +1,369 @@
+#include "ShardSupervisor.h"
+#include "EventTrigger.h"
+#include <QCoreApplication>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QJsonDocument>
+#include <QFileInfo>
+#include <QTimer>
+#include <QDebug>
+
+namespace MCM {
+
+ShardSupervisor& ShardSupervisor::instance() {
+    static ShardSupervisor instance;
+    return instance;
+}
+
+ShardSupervisor::ShardSupervisor() {
+    m_clock.start();
+    connect(&EventTrigger::instance(), &EventTrigger::triggered,
+            this, &ShardSupervisor::forwardTrigger);
+    if (QCoreApplication* app = QCoreApplication::instance()) {
+        connect(app, &QCoreApplication::aboutToQuit, this, &ShardSupervisor::shutdown);
+    }
+}
+
+ShardSupervisor::~ShardSupervisor() {
+    shutdown();
+    qDeleteAll(m_rings);
+}
+
+void ShardSupervisor::configure(const ShardingConfig& config, int openTimeoutMs, const QString& configPath) {
+    if (!m_workers.empty()) {
+        qWarning() << "ShardSupervisor: Workers already running, sharding changes apply after a restart";
+        return;
+    }
+    m_config = config;
+    m_openTimeoutMs = openTimeoutMs;
+    m_configPath = configPath.isEmpty() ? QString() : QFileInfo(configPath).absoluteFilePath();
+    if (isActive()) {
+        qDebug() << "ShardSupervisor:" << m_config.workers << "worker processes, preview up to"
+                 << m_config.previewMaxWidth << "x" << m_config.previewMaxHeight;
+    }
+}
+
+bool ShardSupervisor::listen() {
+    if (m_server) {
+        return m_server->isListening();
+    }
+    m_server = new QLocalServer(this);
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(m_server, &QLocalServer::newConnection, this, &ShardSupervisor::onNewConnection);
+
+    const QString name = QString("mcm-shards-%1").arg(QCoreApplication::applicationPid());
+    QLocalServer::removeServer(name);  // Stale socket file of a crashed run with the same pid
+    if (!m_server->listen(name)) {
+        qWarning() << "ShardSupervisor: Cannot listen on" << name << "-" << m_server->errorString();
+        return false;
+    }
+    return true;
+}
+
+ShardSupervisor::Worker& ShardSupervisor::worker(int shard) {
+    if (m_workers.empty()) {
+        ReconnectConfig restart;
+        restart.initialDelayMs = m_config.restartDelayMs;
+        restart.maxDelayMs = qMax(m_config.restartDelayMs, static_cast<int>(MAX_RESTART_DELAY_MS));
+        restart.maxAttempts = 0;
+        for (int i = 0; i < m_config.workers; ++i) {
+            auto created = std::make_unique<Worker>();
+            created->shard = i;
+            created->backoff.setConfig(restart);
+            m_workers.push_back(std::move(created));
+        }
+    }
+    return *m_workers[shard];
+}
+
+QString ShardSupervisor::ringKey(int slotId) const {
+    return QString("mcm-%1-slot-%2").arg(QCoreApplication::applicationPid()).arg(slotId);
+}
+
+SharedFrameRing* ShardSupervisor::startSlot(int slotId, const SlotConfig& config) {
+    if (!isActive() || m_shuttingDown || !listen()) {
+        return nullptr;
+    }
+
+    // Created here and kept across worker restarts; the worker attaches
+    SharedFrameRing* ring = m_rings.value(slotId);
+    if (!ring) {
+        ring = new SharedFrameRing;
+        if (!ring->create(ringKey(slotId), QSize(m_config.previewMaxWidth, m_config.previewMaxHeight))) {
+            delete ring;
+            return nullptr;
+        }
+        m_rings.insert(slotId, ring);
+    }
+
+    Worker& owner = worker(shardOf(slotId));
+    const QJsonObject message{
+        {"cmd", "start"},
+        {"slot", slotId},
+        {"ring", ring->key()},
+        {"config", config.toJson()}
+    };
+    owner.running.insert(slotId, message);
+    if (owner.socket) {
+        owner.startDeadlines.insert(slotId, m_clock.elapsed() + m_openTimeoutMs);
+    }  // Otherwise from its hello, when the worker gets the message
+    send(owner, message);
+    qDebug() << "ShardSupervisor: Slot" << slotId << "started in worker" << owner.shard;
+    return ring;
+}
+
+void ShardSupervisor::stopSlot(int slotId) {
+    if (!isActive() || m_workers.empty()) {
+        return;
+    }
+    Worker& owner = worker(shardOf(slotId));
+    owner.startDeadlines.remove(slotId);
+    if (owner.running.remove(slotId) > 0 && owner.process) {
+        send(owner, QJsonObject{{"cmd", "stop"}, {"slot", slotId}});
+    }
+}
+
+qint64 ShardSupervisor::workerProcessId(int slotId) const {
+    const int shard = shardOf(slotId);
+    if (shard < 0 || shard >= static_cast<int>(m_workers.size())) {
+        return 0;
+    }
+    const QProcess* process = m_workers[shard]->process;
+    return process ? process->processId() : 0;
+}
+
+void ShardSupervisor::launch(Worker& worker) {
+    const int shard = worker.shard;
+    QStringList arguments{"--slot-worker", QString::number(shard), "--ipc", m_server->serverName()};
+    if (!m_configPath.isEmpty()) {
+        arguments << "--config" << m_configPath;
+    }
+
+    // Workers have no windows; their logs go to the UI's terminal
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert("QT_QPA_PLATFORM", "offscreen");
+
+    worker.process = new QProcess(this);
+    worker.process->setProcessChannelMode(QProcess::ForwardedChannels);
+    worker.process->setProcessEnvironment(environment);
+    connect(worker.process, &QProcess::finished, this, [this, shard](int exitCode, QProcess::ExitStatus) {
+        onWorkerFinished(shard, exitCode);
+    });
+    connect(worker.process, &QProcess::errorOccurred, this, [this, shard](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            onWorkerFinished(shard, -1);  // No finished() follows
+        }
+    });
+
+    if (!m_watchdog) {
+        m_watchdog = new QTimer(this);
+        connect(m_watchdog, &QTimer::timeout, this, &ShardSupervisor::checkWorkers);
+        m_watchdog->start(HEARTBEAT_INTERVAL_MS);
+    }
+    // Until its hello the worker gets openTimeoutMs on top of the heartbeat window to start up
+    worker.lastBeatMs = m_clock.elapsed() + m_openTimeoutMs;
+    worker.killed = false;
+
+    qDebug() << "ShardSupervisor: Launching worker" << shard;
+    worker.process->start(QCoreApplication::applicationFilePath(), arguments);
+}
+
+void ShardSupervisor::send(Worker& worker, const QJsonObject& message) {
+    const QByteArray line = QJsonDocument(message).toJson(QJsonDocument::Compact) + '\n';
+    if (worker.socket && worker.socket->state() == QLocalSocket::ConnectedState) {
+        worker.socket->write(line);
+        return;
+    }
+    worker.pending.append(line);
+    if (!worker.process && !worker.restartScheduled) {
+        launch(worker);
+    }
+}
+
+void ShardSupervisor::onNewConnection() {
+    while (QLocalSocket* socket = m_server->nextPendingConnection()) {
+        m_unassigned.append(socket);
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { onWorkerReadyRead(socket); });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            m_unassigned.removeOne(socket);
+            for (const auto& worker : m_workers) {
+                if (worker->socket == socket) {
+                    worker->socket = nullptr;
+                }
+            }
+            socket->deleteLater();
+        });
+    }
+}
+
+void ShardSupervisor::onWorkerReadyRead(QLocalSocket* socket) {
+    while (socket->canReadLine()) {
+        const QJsonObject message = QJsonDocument::fromJson(socket->readLine()).object();
+        const QString event = message.value("event").toString();
+
+        if (event == "hello") {
+            const int shard = message.value("shard").toInt(-1);
+            if (shard < 0 || shard >= static_cast<int>(m_workers.size())) {
+                qWarning() << "ShardSupervisor: Connection from unknown worker" << shard;
+                socket->disconnectFromServer();
+                return;
+            }
+            Worker& owner = *m_workers[shard];
+            m_unassigned.removeOne(socket);
+            owner.socket = socket;
+            for (const QByteArray& line : owner.pending) {
+                socket->write(line);
+            }
+            owner.pending.clear();
+            owner.lastBeatMs = m_clock.elapsed();
+            for (auto it = owner.running.cbegin(); it != owner.running.cend(); ++it) {
+                owner.startDeadlines.insert(it.key(), owner.lastBeatMs + m_openTimeoutMs);
+            }
+            qDebug() << "ShardSupervisor: Worker" << shard << "connected";
+        } else if (event == "alive") {
+            for (const auto& worker : m_workers) {
+                if (worker->socket == socket) {
+                    worker->lastBeatMs = m_clock.elapsed();
+                }
+            }
+        } else if (event == "state") {
+            const int slotId = message.value("slot").toInt(-1);
+            const QString state = message.value("state").toString();
+            const int shard = shardOf(slotId);
+            if (shard >= 0 && shard < static_cast<int>(m_workers.size())) {
+                Worker& owner = *m_workers[shard];
+                if (state != "starting") {
+                    owner.startDeadlines.remove(slotId);  // Opened, or failed visibly
+                }
+                if (state == "streaming") {
+                    owner.backoff.reset();  // Proven good, next crash restarts quickly
+                }
+            }
+            emit slotStateChanged(slotId, state);
+        }
+    }
+}
+
+void ShardSupervisor::onWorkerFinished(int shard, int exitCode) {
+    Worker& finished = *m_workers[shard];
+    if (finished.process) {
+        finished.process->deleteLater();
+        finished.process = nullptr;
+    }
+    if (finished.socket) {
+        finished.socket->disconnectFromServer();
+        finished.socket = nullptr;
+    }
+    finished.pending.clear();
+    finished.startDeadlines.clear();
+    finished.killed = false;
+    if (m_shuttingDown) {
+        return;
+    }
+
+    qWarning() << "ShardSupervisor: Worker" << shard << "exited (code" << exitCode << ") with"
+               << finished.running.size() << "running slots";
+    if (finished.running.isEmpty() || finished.restartScheduled) {
+        return;  // Launched again by the next startSlot()
+    }
+    for (auto it = finished.running.cbegin(); it != finished.running.cend(); ++it) {
+        emit slotStateChanged(it.key(), "restarting");
+    }
+
+    finished.restartScheduled = true;
+    const int delayMs = finished.backoff.nextDelayMs();
+    qDebug() << "ShardSupervisor: Restarting worker" << shard << "in" << delayMs << "ms";
+    QTimer::singleShot(delayMs, this, [this, shard]() {
+        Worker& restarted = *m_workers[shard];
+        restarted.restartScheduled = false;
+        if (m_shuttingDown || restarted.process || restarted.running.isEmpty()) {
+            return;
+        }
+        // A fresh worker only needs the slots that should run now
+        restarted.pending.clear();
+        for (auto it = restarted.running.cbegin(); it != restarted.running.cend(); ++it) {
+            restarted.pending.append(QJsonDocument(it.value()).toJson(QJsonDocument::Compact) + '\n');
+        }
+        launch(restarted);
+    });
+}
+
+void ShardSupervisor::checkWorkers() {
+    if (m_shuttingDown) {
+        return;
+    }
+    const qint64 now = m_clock.elapsed();
+    for (const auto& worker : m_workers) {
+        if (!worker->process || worker->killed) {
+            continue;
+        }
+        QString reason;
+        if (now - worker->lastBeatMs > MISSED_BEATS * HEARTBEAT_INTERVAL_MS) {
+            reason = QString("no heartbeat for %1 ms").arg(now - worker->lastBeatMs);
+        } else {
+            for (auto it = worker->startDeadlines.cbegin(); it != worker->startDeadlines.cend(); ++it) {
+                if (now >= it.value()) {
+                    reason = QString("slot %1 still starting after %2 ms").arg(it.key()).arg(m_openTimeoutMs);
+                    break;
+                }
+            }
+        }
+        if (reason.isEmpty()) {
+            continue;
+        }
+        // finished() follows and takes the restart path like a crash
+        qWarning() << "ShardSupervisor: Worker" << worker->shard << "is hung (" << reason << ") - killing it";
+        worker->killed = true;
+        worker->process->kill();
+    }
+}
+
+void ShardSupervisor::forwardTrigger(int slotId, const QString& reason) {
+    const QJsonObject message{{"cmd", "trigger"}, {"slot", slotId}, {"reason", reason}};
+    for (const auto& worker : m_workers) {
+        if (worker->process && (slotId == -1 || worker->running.contains(slotId))) {
+            send(*worker, message);
+        }
+    }
+}
+
+void ShardSupervisor::shutdown() {
+    if (m_shuttingDown) {
+        return;
+    }
+    m_shuttingDown = true;
+    if (m_watchdog) {
+        m_watchdog->stop();
+    }
+
+    for (const auto& worker : m_workers) {
+        if (worker->socket && worker->socket->state() == QLocalSocket::ConnectedState) {
+            worker->socket->write(QJsonDocument(QJsonObject{{"cmd", "quit"}}).toJson(QJsonDocument::Compact) + '\n');
+            worker->socket->flush();
+        }
+    }
+    // Workers finish their open chunks before exiting
+    for (const auto& worker : m_workers) {
+        if (!worker->process) {
+            continue;
+        }
+        worker->process->disconnect(this);
+        if (!worker->process->waitForFinished(QUIT_TIMEOUT_MS)) {
+            qWarning() << "ShardSupervisor: Worker" << worker->shard << "did not quit, killing it";
+            worker->process->kill();
+            worker->process->waitForFinished(QUIT_TIMEOUT_MS);
+        }
+        delete worker->process;
+        worker->process = nullptr;
+    }
+    m_workers.clear();
+
+    // Rings stay until exit: tiles may still be torn down after this
+    if (m_server) {
+        m_server->close();
+    }
+}
+
+} // namespace MCM
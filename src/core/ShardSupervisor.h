@@ -0,0 +1,145 @@
+#ifndef SHARDSUPERVISOR_H
+#define SHARDSUPERVISOR_H
+
+#include <QObject>
+#include <QHash>
+#include <QJsonObject>
+#include <QElapsedTimer>
+#include <memory>
+#include <vector>
+#include "Config.h"
+#include "ReconnectBackoff.h"
+#include "SharedFrameRing.h"
+
+class QLocalServer;
+class QLocalSocket;
+class QProcess;
+class QTimer;
+
+namespace MCM {
+
+/**
+ * @brief Runs the slots in worker processes (sharding.workers > 0) (Singleton)
+ *
+ * Each worker is this executable started with --slot-worker and owns the
+ * slots i with i % workers == its number: capture, recording, motion and
+ * the chunk index run there, so a driver or decoder that hangs or crashes
+ * takes down one worker's slots, not the UI or the other workers, and the
+ * slots spread over as many event loops and cores as there are workers.
+ *
+ * The UI keeps the tiles. A tile starts its slot through startSlot() and
+ * shows the frames the worker puts into the slot's SharedFrameRing, which
+ * this class creates. Workers are driven over a local socket with one
+ * JSON object per line:
+ *   UI -> worker:  {"cmd":"start","slot":3,"ring":"...","config":{...}}, stop, trigger, quit
+ *   worker -> UI:  {"event":"hello","shard":1}, {"event":"alive"}, {"event":"state","slot":3,"state":"streaming"}
+ *
+ * A worker that exits unexpectedly is restarted after a growing delay and
+ * its running slots are started again; the tiles show "restarting" until
+ * the first frame. A hung worker never exits, so it is killed and goes the
+ * same way when it misses MISSED_BEATS heartbeats (main thread stuck) or a
+ * started slot reports nothing past "starting" within startup.openTimeoutMs
+ * (open or first decode stuck on another thread).
+ */
+class ShardSupervisor : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr int HEARTBEAT_INTERVAL_MS = 1000;   // Period of the workers' "alive" event
+
+    static ShardSupervisor& instance();
+
+    // Prevent copying
+    ShardSupervisor(const ShardSupervisor&) = delete;
+    ShardSupervisor& operator=(const ShardSupervisor&) = delete;
+
+    /**
+     * @brief Take the sharding settings; workers start on the first startSlot()
+     * @param openTimeoutMs Time a started slot has to report streaming or no signal
+     * @param configPath Config file the workers load (their slot settings come from startSlot())
+     */
+    void configure(const ShardingConfig& config, int openTimeoutMs, const QString& configPath);
+
+    /**
+     * @brief Whether slots run in worker processes
+     */
+    bool isActive() const { return m_config.workers > 0; }
+
+    /**
+     * @brief Worker that owns a slot
+     */
+    int shardOf(int slotId) const { return isActive() ? slotId % m_config.workers : -1; }
+
+    /**
+     * @brief Start a slot in its worker with the given settings
+     * @return Ring the worker draws the slot's preview into; nullptr if it cannot be created
+     */
+    SharedFrameRing* startSlot(int slotId, const SlotConfig& config);
+    void stopSlot(int slotId);
+
+    /**
+     * @brief Quit all workers and wait for them
+     */
+    void shutdown();
+
+    /**
+     * @brief Process id of the slot's worker (0 = not running)
+     */
+    qint64 workerProcessId(int slotId) const;
+
+signals:
+    /**
+     * @brief A slot's state as reported by its worker
+     *
+     * "starting", "streaming" (first frame), "stopped", "nosignal"
+     * (source unavailable) or "restarting" (worker died, restart pending).
+     */
+    void slotStateChanged(int slotId, const QString& state);
+
+private:
+    ShardSupervisor();
+    ~ShardSupervisor() override;
+
+    struct Worker {
+        int shard{0};
+        QProcess* process{nullptr};
+        QLocalSocket* socket{nullptr};
+        QList<QByteArray> pending;         // Messages sent before it connected
+        QHash<int, QJsonObject> running;   // Started slots and their start message
+        ReconnectBackoff backoff;
+        bool restartScheduled{false};
+        qint64 lastBeatMs{0};              // Launch, hello or last heartbeat
+        QHash<int, qint64> startDeadlines; // Started slots still "starting", by deadline
+        bool killed{false};                // Killed by the watchdog, finished() pending
+    };
+
+    bool listen();
+    Worker& worker(int shard);
+    void launch(Worker& worker);
+    void send(Worker& worker, const QJsonObject& message);
+    void onNewConnection();
+    void onWorkerReadyRead(QLocalSocket* socket);
+    void onWorkerFinished(int shard, int exitCode);
+    void checkWorkers();
+    void forwardTrigger(int slotId, const QString& reason);
+    QString ringKey(int slotId) const;
+
+    ShardingConfig m_config;
+    QString m_configPath;
+    QLocalServer* m_server{nullptr};
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    QHash<int, SharedFrameRing*> m_rings;
+    QList<QLocalSocket*> m_unassigned;   // Connected, hello not received yet
+    QTimer* m_watchdog{nullptr};
+    QElapsedTimer m_clock;
+    int m_openTimeoutMs{5000};
+    bool m_shuttingDown{false};
+
+    static constexpr int QUIT_TIMEOUT_MS = 3000;
+    static constexpr int MAX_RESTART_DELAY_MS = 30000;
+    static constexpr int MISSED_BEATS = 5;
+};
+
+} // namespace MCM
+
+#endif // SHARDSUPERVISOR_H
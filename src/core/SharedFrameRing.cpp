@@ -0,0 +1,240 @@
+#include "SharedFrameRing.h"
+#include <QDebug>
+#include <atomic>
+#include <new>
+
+namespace MCM {
+
+namespace {
+
+constexpr quint32 RING_MAGIC = 0x5246434d;   // "MCFR"
+constexpr quint32 RING_VERSION = 1;
+constexpr qint64 ALIGNMENT = 64;
+
+qint64 aligned(qint64 bytes) {
+    return (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+quint32 packSize(const QSize& size) {
+    return static_cast<quint32>(qBound(0, size.width(), 0xffff)) << 16
+         | static_cast<quint32>(qBound(0, size.height(), 0xffff));
+}
+
+QSize unpackSize(quint32 packed) {
+    return QSize(static_cast<int>(packed >> 16), static_cast<int>(packed & 0xffff));
+}
+
+} // namespace
+
+// Both processes see the same layout; the atomics must not need a lock
+// (a lock would live in one process only)
+static_assert(std::atomic<quint64>::is_always_lock_free, "Shared frame ring needs lock-free 64-bit atomics");
+static_assert(std::atomic<qint32>::is_always_lock_free, "Shared frame ring needs lock-free 32-bit atomics");
+
+struct SharedFrameRing::BufferInfo {
+    std::atomic<quint32> readers;    // Reader holds (written by the reader only)
+    std::atomic<quint64> sequence;   // Publish count of the frame in it, 0 = being written
+    qint32 width;
+    qint32 height;
+    qint32 bytesPerLine;
+    qint32 reserved;
+    qint64 timestampUs;
+};
+
+struct SharedFrameRing::Header {
+    quint32 magic;
+    quint32 version;
+    qint32 bufferCount;
+    qint32 maxWidth;
+    qint32 maxHeight;
+    qint32 reserved;
+    qint64 bufferBytes;
+    qint64 dataOffset;
+    std::atomic<qint32> latest;          // Buffer of the newest frame (-1 = none)
+    std::atomic<quint32> requestedSize;  // Reader's display size, width << 16 | height
+    std::atomic<quint64> sequence;       // Frames published
+    std::atomic<quint64> skipped;        // Frames dropped for lack of a free buffer
+    BufferInfo buffers[MAX_BUFFERS];
+};
+
+SharedFrameRing::SharedFrameRing() = default;
+
+SharedFrameRing::~SharedFrameRing() {
+    detach();
+}
+
+bool SharedFrameRing::create(const QString& key, const QSize& maxFrameSize, int bufferCount) {
+    detach();
+    bufferCount = qBound(2, bufferCount, static_cast<int>(MAX_BUFFERS));
+    const qint64 bufferBytes = aligned(static_cast<qint64>(maxFrameSize.width()) * 4 * maxFrameSize.height());
+    const qint64 dataOffset = aligned(sizeof(Header));
+
+    m_memory.setKey(key);
+    if (!m_memory.create(static_cast<qsizetype>(dataOffset + bufferBytes * bufferCount))) {
+        qWarning() << "SharedFrameRing: Cannot create" << key << "-" << m_memory.errorString();
+        return false;
+    }
+
+    // The peer only learns the key after this, so no locking is needed
+    Header* header = new (m_memory.data()) Header;
+    header->magic = RING_MAGIC;
+    header->version = RING_VERSION;
+    header->bufferCount = bufferCount;
+    header->maxWidth = maxFrameSize.width();
+    header->maxHeight = maxFrameSize.height();
+    header->reserved = 0;
+    header->bufferBytes = bufferBytes;
+    header->dataOffset = dataOffset;
+    header->latest.store(-1);
+    header->requestedSize.store(packSize(maxFrameSize));
+    header->sequence.store(0);
+    header->skipped.store(0);
+    for (BufferInfo& info : header->buffers) {
+        info.readers.store(0);
+        info.sequence.store(0);
+        info.width = info.height = info.bytesPerLine = info.reserved = 0;
+        info.timestampUs = -1;
+    }
+    m_header = header;
+    return true;
+}
+
+bool SharedFrameRing::attach(const QString& key) {
+    detach();
+    m_memory.setKey(key);
+    if (!m_memory.attach()) {
+        qWarning() << "SharedFrameRing: Cannot attach" << key << "-" << m_memory.errorString();
+        return false;
+    }
+
+    Header* header = static_cast<Header*>(m_memory.data());
+    if (m_memory.size() < static_cast<qsizetype>(sizeof(Header))
+        || header->magic != RING_MAGIC || header->version != RING_VERSION
+        || m_memory.size() < header->dataOffset + header->bufferBytes * header->bufferCount) {
+        qWarning() << "SharedFrameRing: Segment" << key << "has an unknown layout";
+        m_memory.detach();
+        return false;
+    }
+    m_header = header;
+    return true;
+}
+
+void SharedFrameRing::detach() {
+    m_writing = -1;
+    m_writeImage = QImage();
+    m_header = nullptr;
+    if (m_memory.isAttached()) {
+        m_memory.detach();
+    }
+}
+
+QSize SharedFrameRing::maxFrameSize() const {
+    return m_header ? QSize(m_header->maxWidth, m_header->maxHeight) : QSize();
+}
+
+uchar* SharedFrameRing::bufferData(int index) const {
+    return static_cast<uchar*>(m_memory.data()) + m_header->dataOffset + m_header->bufferBytes * index;
+}
+
+void SharedFrameRing::setRequestedSize(const QSize& size) {
+    if (m_header) {
+        m_header->requestedSize.store(packSize(size.isValid() ? size : QSize(0, 0)));
+    }
+}
+
+quint64 SharedFrameRing::sequence() const {
+    return m_header ? m_header->sequence.load() : 0;
+}
+
+SharedFrameRing::Frame SharedFrameRing::acquire() {
+    Frame frame;
+    if (!m_header) {
+        return frame;
+    }
+
+    // Hold the latest buffer, then check it is still the latest: the writer
+    // never picks a held buffer, and one it picked before the hold is no
+    // longer the latest. A few retries cover a writer publishing meanwhile.
+    for (int attempt = 0; attempt < MAX_BUFFERS; ++attempt) {
+        const int index = m_header->latest.load();
+        if (index < 0 || index >= m_header->bufferCount) {
+            return frame;
+        }
+        BufferInfo& info = m_header->buffers[index];
+        info.readers.fetch_add(1);
+        if (m_header->latest.load() == index) {
+            frame.buffer = index;
+            frame.sequence = info.sequence.load();
+            frame.timestampUs = info.timestampUs;
+            frame.image = QImage(bufferData(index), info.width, info.height,
+                                 info.bytesPerLine, QImage::Format_RGB32);
+            return frame;
+        }
+        info.readers.fetch_sub(1);
+    }
+    return frame;
+}
+
+void SharedFrameRing::release(Frame& frame) {
+    if (m_header && frame.isValid()) {
+        frame.image = QImage();  // Must not outlive the hold
+        m_header->buffers[frame.buffer].readers.fetch_sub(1);
+    }
+    frame.buffer = -1;
+}
+
+QSize SharedFrameRing::requestedSize() const {
+    if (!m_header) {
+        return QSize();
+    }
+    const QSize requested = unpackSize(m_header->requestedSize.load());
+    return requested.boundedTo(maxFrameSize());
+}
+
+QImage* SharedFrameRing::beginWrite(const QSize& size) {
+    if (!m_header || size.isEmpty()) {
+        return nullptr;
+    }
+    const QSize bounded = size.boundedTo(maxFrameSize());
+
+    const int latest = m_header->latest.load();
+    int index = -1;
+    for (int i = 0; i < m_header->bufferCount; ++i) {
+        if (i != latest && m_header->buffers[i].readers.load() == 0) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0) {
+        m_header->skipped.fetch_add(1);
+        return nullptr;
+    }
+
+    BufferInfo& info = m_header->buffers[index];
+    info.sequence.store(0);
+    info.width = bounded.width();
+    info.height = bounded.height();
+    info.bytesPerLine = bounded.width() * 4;
+    m_writing = index;
+    m_writeImage = QImage(bufferData(index), info.width, info.height, info.bytesPerLine, QImage::Format_RGB32);
+    return &m_writeImage;
+}
+
+void SharedFrameRing::commit(qint64 timestampUs) {
+    if (!m_header || m_writing < 0) {
+        return;
+    }
+    BufferInfo& info = m_header->buffers[m_writing];
+    info.timestampUs = timestampUs;
+    info.sequence.store(m_header->sequence.load() + 1);
+    m_header->latest.store(m_writing);
+    m_header->sequence.fetch_add(1);   // Last: pollers see the new frame only once it is the latest
+    m_writing = -1;
+    m_writeImage = QImage();
+}
+
+quint64 SharedFrameRing::skippedFrames() const {
+    return m_header ? m_header->skipped.load() : 0;
+}
+
+} // namespace MCM
@@ -0,0 +1,137 @@
+#ifndef SHAREDFRAMERING_H
+#define SHAREDFRAMERING_H
+
+#include <QSharedMemory>
+#include <QImage>
+#include <QSize>
+#include <QString>
+
+namespace MCM {
+
+/**
+ * @brief Preview frames of one slot shared between two processes
+ *
+ * A shared memory segment with a few RGB32 frame buffers, written by the
+ * worker process that runs the slot (ShardWorker) and read by the UI
+ * (SharedFrameWidget). The UI creates the segment, so it outlives a
+ * crashed worker and the restarted one attaches to it again.
+ *
+ * The writer fills a buffer that is neither the latest nor held by the
+ * reader and then publishes it; the reader holds the latest buffer while
+ * it paints it straight from the segment. Neither side waits or copies:
+ * a writer that finds no free buffer skips the frame, and a reader always
+ * sees the newest complete one.
+ *
+ * The reader also tells the writer the size it displays at, so frames are
+ * scaled once, in the worker, to what the tile shows (bounded by the
+ * segment's maximum frame size).
+ *
+ * Usage (UI):
+ *   ring.create(key, QSize(1280, 720));
+ *   ring.setRequestedSize(tile->size());
+ *   SharedFrameRing::Frame frame = ring.acquire();
+ *   painter.drawImage(target, frame.image);
+ *   ring.release(frame);
+ *
+ * Usage (worker):
+ *   ring.attach(key);
+ *   if (QImage* buffer = ring.beginWrite(size)) { draw into *buffer; ring.commit(timestampUs); }
+ */
+class SharedFrameRing {
+public:
+    /**
+     * @brief A frame held by the reader; its image points into the segment
+     */
+    struct Frame {
+        QImage image;
+        quint64 sequence{0};       // Publish count of the frame (1 = first)
+        qint64 timestampUs{-1};    // Source timestamp (-1 = unknown)
+        int buffer{-1};
+
+        bool isValid() const { return buffer >= 0; }
+    };
+
+    SharedFrameRing();
+    ~SharedFrameRing();
+
+    // Prevent copying
+    SharedFrameRing(const SharedFrameRing&) = delete;
+    SharedFrameRing& operator=(const SharedFrameRing&) = delete;
+
+    /**
+     * @brief Create the segment (owner side)
+     * @param maxFrameSize Largest frame a buffer holds
+     */
+    bool create(const QString& key, const QSize& maxFrameSize, int bufferCount = DEFAULT_BUFFERS);
+
+    /**
+     * @brief Attach to a segment created by the other process (writer side)
+     */
+    bool attach(const QString& key);
+
+    void detach();
+    bool isAttached() const { return m_header != nullptr; }
+    QString key() const { return m_memory.key(); }
+    QString errorString() const { return m_memory.errorString(); }
+    QSize maxFrameSize() const;
+
+    // Reader side
+
+    /**
+     * @brief Size the frames are displayed at (empty = nothing is shown, writer may pause)
+     */
+    void setRequestedSize(const QSize& size);
+
+    /**
+     * @brief Publish count of the latest frame (0 = none yet); cheap, for polling
+     */
+    quint64 sequence() const;
+
+    /**
+     * @brief Hold the latest frame until release()
+     * @return Invalid frame if nothing was published yet
+     */
+    Frame acquire();
+    void release(Frame& frame);
+
+    // Writer side
+
+    /**
+     * @brief Requested display size, bounded by maxFrameSize()
+     */
+    QSize requestedSize() const;
+
+    /**
+     * @brief Start filling a free buffer with a frame of @p size (bounded by maxFrameSize())
+     * @return Image over the buffer, valid until commit(); nullptr if none is free
+     */
+    QImage* beginWrite(const QSize& size);
+
+    /**
+     * @brief Publish the buffer returned by beginWrite()
+     */
+    void commit(qint64 timestampUs = -1);
+
+    /**
+     * @brief Frames skipped because the reader held every other buffer
+     */
+    quint64 skippedFrames() const;
+
+    static constexpr int DEFAULT_BUFFERS = 3;
+    static constexpr int MAX_BUFFERS = 4;
+
+private:
+    struct BufferInfo;
+    struct Header;
+
+    uchar* bufferData(int index) const;
+
+    QSharedMemory m_memory;
+    Header* m_header{nullptr};
+    int m_writing{-1};     // Buffer between beginWrite() and commit()
+    QImage m_writeImage;
+};
+
+} // namespace MCM
+
+#endif // SHAREDFRAMERING_H
@@ -0,0 +1,234 @@
+#include "SnapshotService.h"
+#include "FramePool.h"
+#include "Telemetry.h"
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <QBuffer>
+#include <QImageWriter>
+#include <QPainter>
+#include <QDebug>
+#include <atomic>
+
+namespace MCM {
+
+SnapshotService& SnapshotService::instance() {
+    static SnapshotService instance;
+    return instance;
+}
+
+SnapshotService::SnapshotService()
+    : QObject(nullptr)
+{
+    m_clock.start();
+    m_pool.setMaxThreadCount(m_config.threads);
+
+    // Refreshes emit signals and touch FramePool: finish them while the application exists
+    if (QCoreApplication* app = QCoreApplication::instance()) {
+        connect(app, &QCoreApplication::aboutToQuit, this, &SnapshotService::shutdown);
+    }
+}
+
+SnapshotService::~SnapshotService() {
+    shutdown();
+}
+
+void SnapshotService::configure(const SnapshotConfig& config) {
+    QMutexLocker locker(&m_mutex);
+    m_config = config;
+    m_pool.setMaxThreadCount(config.threads);
+    evictLocked(-1);
+}
+
+void SnapshotService::setFrameSource(int slotId, FrameSource source) {
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entries.find(slotId);
+    if (it != m_entries.end()) {
+        m_cacheBytes -= it->latest.jpeg.size();
+    }
+    Entry entry;
+    entry.id = m_nextEntryId++;
+    entry.source = std::move(source);
+    entry.lastRequestMs = m_clock.elapsed();
+    m_entries.insert(slotId, std::move(entry));
+}
+
+void SnapshotService::removeFrameSource(int slotId) {
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entries.find(slotId);
+    if (it == m_entries.end()) {
+        return;
+    }
+    // A refresh still running finds its entry gone and drops the result
+    m_cacheBytes -= it->latest.jpeg.size();
+    m_entries.erase(it);
+}
+
+SnapshotService::Snapshot SnapshotService::snapshot(int slotId) {
+    QMutexLocker locker(&m_mutex);
+    m_requests++;
+    auto it = m_entries.find(slotId);
+    if (it == m_entries.end()) {
+        return Snapshot();
+    }
+    Entry& entry = it.value();
+    const qint64 nowMs = m_clock.elapsed();
+    entry.lastRequestMs = nowMs;
+
+    // One look at the frame per interval, and one refresh at a time
+    const bool due = !entry.latest.isValid() || entry.refreshStartedMs < 0
+        || nowMs - entry.refreshStartedMs >= m_config.intervalMs;
+    if (due && !entry.busy && !m_shutdown && entry.source) {
+        quint64 serial = 0;
+        const QVideoFrame frame = entry.source(&serial);
+        if (frame.isValid()) {
+            entry.refreshStartedMs = nowMs;
+            if (entry.hasFrame && serial == entry.frameSerial && entry.latest.isValid()) {
+                m_unchanged++;  // Still showing the encoded frame
+            } else {
+                entry.busy = true;
+                const quint64 entryId = entry.id;
+                const SnapshotConfig config = m_config;
+                Scratch scratch = std::move(entry.scratch);
+                m_pool.start([this, slotId, entryId, frame, serial, config, scratch]() mutable {
+                    refresh(slotId, entryId, frame, serial, config, std::move(scratch));
+                });
+            }
+        }
+    }
+
+    Snapshot result = entry.latest;
+    result.ageMs = entry.encodedMs >= 0 ? nowMs - entry.encodedMs : -1;
+    return result;
+}
+
+SnapshotService::Stats SnapshotService::stats() const {
+    QMutexLocker locker(&m_mutex);
+    Stats stats;
+    stats.requests = m_requests;
+    stats.encodes = m_encodes;
+    stats.unchanged = m_unchanged;
+    stats.evictions = m_evictions;
+    stats.cacheBytes = m_cacheBytes;
+    stats.slots = m_entries.size();
+    return stats;
+}
+
+void SnapshotService::shutdown() {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_shutdown = true;
+    }
+    m_pool.waitForDone();
+}
+
+void SnapshotService::refresh(int slotId, quint64 entryId, QVideoFrame frame, quint64 serial,
+                              SnapshotConfig config, Scratch scratch) {
+    QByteArray jpeg;
+    Telemetry::instance().slot(slotId)->recordFrameMap(frame);
+    if (renderThumbnail(frame, config, &scratch)) {
+        QBuffer buffer(&jpeg);
+        buffer.open(QIODevice::WriteOnly);
+        QImageWriter writer(&buffer, "jpeg");
+        writer.setQuality(config.quality);
+        if (!writer.write(scratch.image)) {
+            static std::atomic<bool> warned{false};
+            if (!warned.exchange(true)) {
+                qWarning() << "SnapshotService: JPEG encoding failed:" << writer.errorString();
+            }
+            jpeg.clear();
+        }
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_entries.find(slotId);
+        if (it == m_entries.end() || it->id != entryId) {
+            return;  // Unregistered meanwhile
+        }
+        Entry& entry = it.value();
+        entry.busy = false;
+        const QSize size = scratch.image.size();
+        entry.scratch = std::move(scratch);
+        if (jpeg.isEmpty()) {
+            return;
+        }
+
+        m_cacheBytes += jpeg.size() - entry.latest.jpeg.size();
+        entry.latest.jpeg = jpeg;
+        entry.latest.size = size;
+        entry.latest.frameTimeUs = frame.startTime();
+        entry.encodedMs = m_clock.elapsed();
+        entry.frameSerial = serial;
+        entry.hasFrame = true;
+        m_encodes++;
+        evictLocked(slotId);
+    }
+    emit snapshotUpdated(slotId);
+}
+
+bool SnapshotService::renderThumbnail(const QVideoFrame& frame, const SnapshotConfig& config,
+                                      Scratch* scratch) const {
+    // One pooled CPU copy; no QVideoFrame::toImage() for the common formats
+    const FrameRef ref = FramePool::instance().map(frame);
+    if (!ref || ref->size().width() < 2 || ref->size().height() < 2) {
+        return false;
+    }
+
+    const QSize source = ref->size();
+    const QSize size = source.width() <= config.maxWidth
+        ? source
+        : QSize(config.maxWidth, qMax(1, qRound(source.height() * double(config.maxWidth) / source.width())));
+    if (scratch->image.size() != size || scratch->image.format() != QImage::Format_RGB32) {
+        scratch->image = QImage(size, QImage::Format_RGB32);
+        if (scratch->image.isNull()) {
+            return false;
+        }
+    }
+
+    // Same conversion as the tiles: matrix from the frame's colour space
+    if (FrameScaler::supports(ref->pixelFormat()) && scratch->scaler.scale(*ref, scratch->image)) {
+        return true;
+    }
+
+    // Other formats: RGB is wrapped without a copy, the rest converted by Qt at full size
+    const QImage image = ref->toImage();
+    if (image.isNull()) {
+        return false;
+    }
+    QPainter painter(&scratch->image);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.drawImage(QRect(QPoint(0, 0), size), image);
+    return true;
+}
+
+void SnapshotService::setMemoryLimit(qint64 bytes) {
+    QMutexLocker locker(&m_mutex);
+    m_memoryLimit = bytes;
+    evictLocked(-1);
+}
+
+void SnapshotService::evictLocked(int keepSlotId) {
+    qint64 maxBytes = static_cast<qint64>(m_config.maxCacheMB) * 1024 * 1024;
+    if (m_memoryLimit >= 0) {
+        maxBytes = qMin(maxBytes, m_memoryLimit);
+    }
+    while (m_cacheBytes > maxBytes) {
+        Entry* oldest = nullptr;
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it.key() != keepSlotId && it->latest.isValid()
+                && (!oldest || it->lastRequestMs < oldest->lastRequestMs)) {
+                oldest = &it.value();
+            }
+        }
+        if (!oldest) {
+            return;
+        }
+        m_cacheBytes -= oldest->latest.jpeg.size();
+        oldest->latest = Snapshot();
+        oldest->encodedMs = -1;
+        oldest->hasFrame = false;
+        m_evictions++;
+    }
+}
+
+} // namespace MCM
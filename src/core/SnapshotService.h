@@ -0,0 +1,167 @@
+#ifndef SNAPSHOTSERVICE_H
+#define SNAPSHOTSERVICE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QSize>
+#include <QImage>
+#include <QHash>
+#include <QMutex>
+#include <QThreadPool>
+#include <QVideoFrame>
+#include <QElapsedTimer>
+#include <functional>
+#include "core/Config.h"
+#include "core/FrameScaler.h"
+
+namespace MCM {
+
+/**
+ * @brief Cached JPEG thumbnails of every slot (Singleton)
+ *
+ * Dashboards and operators poll snapshots; converting a full QVideoFrame
+ * per request does not scale with clients. Each slot registers a frame
+ * source once; snapshot() then returns the cached JPEG straight away and,
+ * if it is older than intervalMs, starts one refresh in the background -
+ * however many clients ask, a slot is encoded at most once per interval,
+ * and not at all while its latest frame has not changed.
+ *
+ * Refreshes run on the service's own thread pool: the frame is mapped
+ * through FramePool, downscaled and converted to RGB in one pass (NV12,
+ * NV21, I420, YV12; other formats through CpuFrame::toImage()) into a
+ * per-slot image that is reused between refreshes, then JPEG encoded.
+ * Only slots that are asked for are encoded, and the cache is bounded by
+ * maxCacheMB: the least recently requested thumbnails are dropped first
+ * and re-encoded on their next request.
+ *
+ * Usage:
+ *   SnapshotService::instance().setFrameSource(slotId, [tap](quint64* serial) {
+ *       return tap->latestFrame(serial);
+ *   });
+ *   const SnapshotService::Snapshot snap = SnapshotService::instance().snapshot(slotId);
+ *   if (snap.isValid()) reply(snap.jpeg);
+ */
+class SnapshotService : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Latest frame of a slot and a number that changes with every frame
+     *
+     * Called on any thread, under the service's lock: must be quick.
+     */
+    using FrameSource = std::function<QVideoFrame(quint64* serial)>;
+
+    struct Snapshot {
+        QByteArray jpeg;
+        QSize size;              // Thumbnail size
+        qint64 frameTimeUs{-1};  // Start time of the source frame
+        qint64 ageMs{-1};        // Time since the thumbnail was encoded
+
+        bool isValid() const { return !jpeg.isEmpty(); }
+    };
+
+    struct Stats {
+        quint64 requests{0};
+        quint64 encodes{0};         // Thumbnails produced
+        quint64 unchanged{0};       // Refreshes skipped because the frame had not changed
+        quint64 evictions{0};
+        qint64 cacheBytes{0};
+        int slots{0};
+    };
+
+    static SnapshotService& instance();
+
+    // Prevent copying
+    SnapshotService(const SnapshotService&) = delete;
+    SnapshotService& operator=(const SnapshotService&) = delete;
+
+    /**
+     * @brief Apply interval, size, quality and cache limits (later refreshes only)
+     */
+    void configure(const SnapshotConfig& config);
+
+    /**
+     * @brief Register (or replace) a slot's frame source
+     */
+    void setFrameSource(int slotId, FrameSource source);
+
+    /**
+     * @brief Unregister a slot; the source is not called any more once this returns
+     */
+    void removeFrameSource(int slotId);
+
+    /**
+     * @brief Cached thumbnail of a slot (thread-safe, never blocks on encoding)
+     *
+     * Empty until the first refresh finishes; snapshotUpdated() then follows.
+     */
+    Snapshot snapshot(int slotId);
+
+    Stats stats() const;
+
+    /**
+     * @brief Cap the cache below maxCacheMB (MemoryGovernor; -1 = maxCacheMB only)
+     */
+    void setMemoryLimit(qint64 bytes);
+
+    /**
+     * @brief Wait for running refreshes and stop accepting new ones (on quit)
+     */
+    void shutdown();
+
+signals:
+    /**
+     * @brief A new thumbnail is cached for the slot (emitted on a pool thread)
+     */
+    void snapshotUpdated(int slotId);
+
+private:
+    SnapshotService();
+    ~SnapshotService() override;
+
+    /**
+     * @brief Per-slot buffers reused between refreshes (owned by the running refresh)
+     */
+    struct Scratch {
+        QImage image;
+        FrameScaler scaler;        // Keeps its tables while the slot's frame shape holds
+    };
+
+    struct Entry {
+        quint64 id{0};             // Distinguishes a re-registered slot from a refresh in flight
+        FrameSource source;
+        Snapshot latest;
+        qint64 encodedMs{-1};
+        qint64 refreshStartedMs{-1};
+        qint64 lastRequestMs{0};
+        quint64 frameSerial{0};
+        bool hasFrame{false};
+        bool busy{false};
+        Scratch scratch;
+    };
+
+    void refresh(int slotId, quint64 entryId, QVideoFrame frame, quint64 serial,
+                 SnapshotConfig config, Scratch scratch);
+    bool renderThumbnail(const QVideoFrame& frame, const SnapshotConfig& config, Scratch* scratch) const;
+    void evictLocked(int keepSlotId);
+
+    mutable QMutex m_mutex;
+    QHash<int, Entry> m_entries;
+    SnapshotConfig m_config;
+    QThreadPool m_pool;
+    QElapsedTimer m_clock;
+    quint64 m_nextEntryId{1};
+    qint64 m_cacheBytes{0};
+    qint64 m_memoryLimit{-1};
+    bool m_shutdown{false};
+
+    quint64 m_requests{0};
+    quint64 m_encodes{0};
+    quint64 m_unchanged{0};
+    quint64 m_evictions{0};
+};
+
+} // namespace MCM
+
+#endif // SNAPSHOTSERVICE_H
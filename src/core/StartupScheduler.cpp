@@ -0,0 +1,200 @@
+#include "StartupScheduler.h"
+#include <QDebug>
+#include <algorithm>
+
+namespace MCM {
+
+StartupScheduler::StartupScheduler(QObject* parent)
+    : QObject(parent)
+{
+    m_timeoutTimer = new QTimer(this);
+    m_timeoutTimer->setInterval(250);
+    connect(m_timeoutTimer, &QTimer::timeout, this, &StartupScheduler::checkTimeouts);
+}
+
+void StartupScheduler::setMaxConcurrent(int count) {
+    m_maxConcurrent = qMax(1, count);
+}
+
+void StartupScheduler::enqueue(int id, StartFunction start) {
+    // First entry of a new batch resets the clock and timings
+    if (!isRunning()) {
+        m_batchClock.start();
+        m_timings.clear();
+        m_timingOrder.clear();
+        m_batchReported = false;
+    }
+
+    m_pending.erase(std::remove_if(m_pending.begin(), m_pending.end(),
+                                   [id](const Pending& p) { return p.id == id; }),
+                    m_pending.end());
+    m_pending.append(Pending{id, std::move(start)});
+
+    SlotTiming timing;
+    timing.id = id;
+    timing.queuedMs = m_batchClock.elapsed();
+    if (!m_timings.contains(id)) {
+        m_timingOrder.append(id);
+    }
+    m_timings.insert(id, timing);
+
+    if (!m_dispatchQueued) {
+        m_dispatchQueued = true;
+        QTimer::singleShot(0, this, &StartupScheduler::dispatch);
+    }
+}
+
+void StartupScheduler::cancel() {
+    if (!m_pending.isEmpty()) {
+        qDebug() << "StartupScheduler: Cancelled" << m_pending.size() << "pending starts";
+    }
+    for (const Pending& pending : m_pending) {
+        m_timings.remove(pending.id);
+        m_timingOrder.removeAll(pending.id);
+    }
+    m_pending.clear();
+    m_inFlight.clear();
+    m_timeoutTimer->stop();
+    m_batchReported = true;
+}
+
+QList<StartupScheduler::SlotTiming> StartupScheduler::timings() const {
+    QList<SlotTiming> result;
+    for (int id : m_timingOrder) {
+        result.append(m_timings.value(id));
+    }
+    return result;
+}
+
+void StartupScheduler::dispatch() {
+    m_dispatchQueued = false;
+
+    if (m_pending.isEmpty() || m_inFlight.size() >= m_maxConcurrent) {
+        return;
+    }
+
+    // One start per event-loop pass: opening a device blocks the GUI thread,
+    // so let paints and frames of already-running slots through in between
+    Pending next = m_pending.takeFirst();
+    const qint64 startedMs = m_batchClock.elapsed();
+    m_inFlight.insert(next.id, startedMs);
+    m_timings[next.id].startedMs = startedMs;
+
+    if (!m_timeoutTimer->isActive()) {
+        m_timeoutTimer->start();
+    }
+
+    qDebug() << "StartupScheduler: Starting" << next.id << "at" << startedMs << "ms"
+             << "(in flight:" << m_inFlight.size() << "/" << m_maxConcurrent
+             << ", pending:" << m_pending.size() << ")";
+
+    const bool started = next.start ? next.start() : false;
+
+    auto it = m_timings.find(next.id);
+    if (it != m_timings.end()) {
+        it->openMs = m_batchClock.elapsed();
+    }
+
+    if (!started) {
+        markFailed(next.id);
+    }
+
+    if (!m_pending.isEmpty() && m_inFlight.size() < m_maxConcurrent && !m_dispatchQueued) {
+        m_dispatchQueued = true;
+        QTimer::singleShot(0, this, &StartupScheduler::dispatch);
+    }
+}
+
+void StartupScheduler::markReady(int id) {
+    auto it = m_timings.find(id);
+    if (it == m_timings.end() || it->startedMs < 0 || it->firstFrameMs >= 0) {
+        return;  // Not started by us, or already reported
+    }
+
+    it->firstFrameMs = m_batchClock.elapsed();
+    const qint64 ttff = it->timeToFirstFrameMs();
+    qDebug() << "StartupScheduler:" << id << "ready - time to first frame" << ttff << "ms";
+    emit slotReady(id, ttff);
+
+    finishSlot(id);
+}
+
+void StartupScheduler::markFailed(int id) {
+    auto it = m_timings.find(id);
+    if (it == m_timings.end() || !m_inFlight.contains(id)) {
+        return;
+    }
+
+    it->failed = true;
+    qDebug() << "StartupScheduler:" << id << "failed to start";
+    finishSlot(id);
+}
+
+void StartupScheduler::checkTimeouts() {
+    const qint64 now = m_batchClock.elapsed();
+    QList<int> expired;
+    for (auto it = m_inFlight.cbegin(); it != m_inFlight.cend(); ++it) {
+        if (now - it.value() >= m_openTimeoutMs) {
+            expired.append(it.key());
+        }
+    }
+
+    for (int id : expired) {
+        // The slot keeps opening in the background; it just stops holding up the queue
+        qWarning() << "StartupScheduler:" << id << "no frame after" << m_openTimeoutMs
+                   << "ms - starting next slot";
+        m_timings[id].timedOut = true;
+        finishSlot(id);
+    }
+}
+
+void StartupScheduler::finishSlot(int id) {
+    if (!m_inFlight.remove(id)) {
+        return;
+    }
+
+    if (!m_pending.isEmpty()) {
+        if (!m_dispatchQueued) {
+            m_dispatchQueued = true;
+            QTimer::singleShot(0, this, &StartupScheduler::dispatch);
+        }
+        return;
+    }
+
+    if (m_inFlight.isEmpty()) {
+        m_timeoutTimer->stop();
+        if (!m_batchReported) {
+            m_batchReported = true;
+            logSummary();
+            emit batchFinished();
+        }
+    }
+}
+
+void StartupScheduler::logSummary() {
+    qint64 worst = 0;
+    int ready = 0;
+
+    qDebug() << "=== Startup benchmark ===" << m_timingOrder.size() << "slots, max concurrent"
+             << m_maxConcurrent;
+    for (int id : m_timingOrder) {
+        const SlotTiming& t = m_timings[id];
+        QString status = t.failed ? "FAILED" : (t.timedOut ? "TIMEOUT" : "ok");
+        qDebug().noquote() << QString("  slot %1: queued %2 ms, started %3 ms, open %4 ms, first frame %5 ms (ttff %6 ms) %7")
+            .arg(t.id, 2)
+            .arg(t.queuedMs, 5)
+            .arg(t.startedMs, 5)
+            .arg(t.openMs >= 0 && t.startedMs >= 0 ? t.openMs - t.startedMs : -1, 5)
+            .arg(t.firstFrameMs, 5)
+            .arg(t.timeToFirstFrameMs(), 5)
+            .arg(status);
+        if (t.firstFrameMs >= 0) {
+            ready++;
+            worst = qMax(worst, t.firstFrameMs);
+        }
+    }
+    qDebug() << "  Ready:" << ready << "/" << m_timingOrder.size()
+             << "- last first frame at" << worst << "ms";
+}
+
+} // namespace MCM
@@ -0,0 +1,134 @@
+#ifndef STARTUPSCHEDULER_H
+#define STARTUPSCHEDULER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QTimer>
+#include <functional>
+
+namespace MCM {
+
+/**
+ * @brief Starts many streams with a bounded number of opens in flight
+ *
+ * Replaces the fixed 500ms-per-slot stagger: up to maxConcurrent() slots are
+ * opening at once, and the next slot starts as soon as one of them delivers
+ * its first frame (or fails / times out). Fast devices no longer wait behind
+ * a fixed schedule, and slow USB devices still are not all opened at once.
+ *
+ * Also records time-to-first-frame per slot and logs a summary when the
+ * batch completes.
+ *
+ * Usage:
+ *   scheduler->enqueue(slotIndex, [slot]() { slot->startStream(); return slot->isStreaming(); });
+ *   connect(slot, &CameraSlot::firstFrameReceived, scheduler, &StartupScheduler::markReady);
+ */
+class StartupScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Startup timing for one slot (all times in ms since the batch began)
+     */
+    struct SlotTiming {
+        int id{-1};
+        qint64 queuedMs{0};       // Enqueued
+        qint64 startedMs{-1};     // start function called
+        qint64 openMs{-1};        // start function returned (blocking part of the open)
+        qint64 firstFrameMs{-1};  // Ready (first frame)
+        bool failed{false};
+        bool timedOut{false};
+
+        qint64 timeToFirstFrameMs() const { return firstFrameMs >= 0 ? firstFrameMs - startedMs : -1; }
+    };
+
+    /**
+     * @brief Start function - returns false if the stream could not be started
+     */
+    using StartFunction = std::function<bool()>;
+
+    explicit StartupScheduler(QObject* parent = nullptr);
+    ~StartupScheduler() override = default;
+
+    /**
+     * @brief Max slots opening at the same time (>= 1)
+     */
+    void setMaxConcurrent(int count);
+    int maxConcurrent() const { return m_maxConcurrent; }
+
+    /**
+     * @brief How long a slot may take to deliver its first frame before the
+     *        next slot is allowed to start anyway
+     */
+    void setOpenTimeoutMs(int ms) { m_openTimeoutMs = ms; }
+
+    /**
+     * @brief Queue a slot for startup (replaces an existing entry for the same id)
+     */
+    void enqueue(int id, StartFunction start);
+
+    /**
+     * @brief Drop pending starts (slots already started are left alone)
+     */
+    void cancel();
+
+    bool isRunning() const { return !m_pending.isEmpty() || !m_inFlight.isEmpty(); }
+
+    /**
+     * @brief Timings of the current/last batch
+     */
+    QList<SlotTiming> timings() const;
+
+public slots:
+    /**
+     * @brief Slot delivered its first frame
+     */
+    void markReady(int id);
+
+    /**
+     * @brief Slot failed to open (frees its concurrency slot)
+     */
+    void markFailed(int id);
+
+signals:
+    /**
+     * @brief Emitted when a slot delivers its first frame
+     */
+    void slotReady(int id, qint64 timeToFirstFrameMs);
+
+    /**
+     * @brief Emitted when every queued slot is ready, failed or timed out
+     */
+    void batchFinished();
+
+private slots:
+    void dispatch();
+    void checkTimeouts();
+
+private:
+    void finishSlot(int id);
+    void logSummary();
+
+    struct Pending {
+        int id;
+        StartFunction start;
+    };
+
+    int m_maxConcurrent{4};
+    int m_openTimeoutMs{5000};
+
+    QList<Pending> m_pending;
+    QHash<int, qint64> m_inFlight;          // id -> start time (ms since batch start)
+    QHash<int, SlotTiming> m_timings;
+    QList<int> m_timingOrder;
+    QElapsedTimer m_batchClock;
+    QTimer* m_timeoutTimer{nullptr};
+    bool m_dispatchQueued{false};
+    bool m_batchReported{true};
+};
+
+} // namespace MCM
+
+#endif // STARTUPSCHEDULER_H
@@ -0,0 +1,162 @@
+#include "StartupTrace.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QDebug>
+
+namespace MCM {
+
+StartupTrace::Scope::Scope(const QString& name)
+    : m_name(name)
+    , m_startUs(StartupTrace::instance().elapsedUs())
+{
+}
+
+StartupTrace::Scope::~Scope() {
+    end();
+}
+
+void StartupTrace::Scope::end() {
+    if (m_ended) {
+        return;
+    }
+    m_ended = true;
+    StartupTrace& trace = StartupTrace::instance();
+    trace.addPhase(m_name, m_startUs, trace.elapsedUs());
+}
+
+StartupTrace& StartupTrace::instance() {
+    static StartupTrace instance;
+    return instance;
+}
+
+void StartupTrace::start() {
+    QMutexLocker locker(&m_mutex);
+    if (!m_clock.isValid()) {
+        m_clock.start();
+    }
+}
+
+void StartupTrace::setOutput(const QString& path, bool quitWhenFinished) {
+    QMutexLocker locker(&m_mutex);
+    m_path = path;
+    m_quitWhenFinished = quitWhenFinished && !path.isEmpty();
+}
+
+bool StartupTrace::isEnabled() const {
+    QMutexLocker locker(&m_mutex);
+    return !m_path.isEmpty();
+}
+
+qint64 StartupTrace::elapsedUs() const {
+    return m_clock.isValid() ? m_clock.nsecsElapsed() / 1000 : 0;
+}
+
+void StartupTrace::addPhase(const QString& name, qint64 startUs, qint64 endUs) {
+    QMutexLocker locker(&m_mutex);
+    if (!m_finished) {
+        m_events.append(Event{name, startUs, qMax<qint64>(0, endUs - startUs)});
+    }
+}
+
+void StartupTrace::mark(const QString& name) {
+    const qint64 nowUs = elapsedUs();
+    QMutexLocker locker(&m_mutex);
+    if (m_finished) {
+        return;
+    }
+    for (const Event& event : m_events) {
+        if (event.durationUs < 0 && event.name == name) {
+            return;
+        }
+    }
+    m_events.append(Event{name, nowUs, -1});
+}
+
+qint64 StartupTrace::milestoneMs(const QString& name) const {
+    QMutexLocker locker(&m_mutex);
+    for (const Event& event : m_events) {
+        if (event.durationUs < 0 && event.name == name) {
+            return event.startUs / 1000;
+        }
+    }
+    return -1;
+}
+
+void StartupTrace::finish() {
+    QList<Event> events;
+    bool quit = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_finished || m_path.isEmpty()) {
+            return;
+        }
+        m_finished = true;
+        events = m_events;
+        quit = m_quitWhenFinished;
+    }
+
+    qDebug() << "=== Startup trace ===";
+    for (const Event& event : events) {
+        if (event.durationUs >= 0) {
+            qDebug().noquote() << QString("  %1 %2 ms (at %3 ms)")
+                .arg(event.name, -28).arg(event.durationUs / 1000.0, 8, 'f', 1).arg(event.startUs / 1000, 6);
+        } else {
+            qDebug().noquote() << QString("  %1 reached at %2 ms").arg(event.name, -28).arg(event.startUs / 1000, 6);
+        }
+    }
+    write(events);
+
+    if (quit) {
+        QMetaObject::invokeMethod(QCoreApplication::instance(), &QCoreApplication::quit, Qt::QueuedConnection);
+    }
+}
+
+void StartupTrace::write(const QList<Event>& events) const {
+    // Chrome trace-event format: phases are complete events, milestones instants
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray traceEvents;
+    QJsonObject milestones;
+    for (const Event& event : events) {
+        QJsonObject entry{
+            {"name", event.name},
+            {"ts", static_cast<double>(event.startUs)},
+            {"pid", static_cast<double>(pid)},
+            {"tid", 1}
+        };
+        if (event.durationUs >= 0) {
+            entry["ph"] = "X";
+            entry["dur"] = static_cast<double>(event.durationUs);
+        } else {
+            entry["ph"] = "i";
+            entry["s"] = "g";
+            milestones[event.name + "Ms"] = event.startUs / 1000.0;
+        }
+        traceEvents.append(entry);
+    }
+    const QJsonObject root{
+        {"traceEvents", traceEvents},
+        {"displayTimeUnit", "ms"},
+        {"otherData", milestones}
+    };
+
+    QDir().mkpath(QFileInfo(m_path).absolutePath());
+    QSaveFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "StartupTrace: Cannot write" << m_path;
+        return;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    if (file.commit()) {
+        qDebug() << "StartupTrace: Written to" << m_path;
+    } else {
+        qWarning() << "StartupTrace: Cannot write" << m_path;
+    }
+}
+
+} // namespace MCM
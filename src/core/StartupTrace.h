@@ -0,0 +1,112 @@
+#ifndef STARTUPTRACE_H
+#define STARTUPTRACE_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+namespace MCM {
+
+/**
+ * @brief Phase timings of application startup (Singleton)
+ *
+ * main() starts the clock first thing; startup code wraps its phases in a
+ * Scope and records milestones (event loop running, first frame shown,
+ * all slots ready) with mark(). Recording is a few entries and always on;
+ * only with --startup-trace <file> is anything written: finish() saves a
+ * Chrome trace-event JSON file (chrome://tracing, ui.perfetto.dev) whose
+ * "otherData" holds the milestone times, and logs a summary.
+ *
+ * GUI thread only.
+ *
+ * Usage:
+ *   {
+ *       StartupTrace::Scope scope("config");
+ *       Config::instance().load(path);
+ *   }
+ *   StartupTrace::instance().mark("firstFrame");
+ */
+class StartupTrace {
+public:
+    /**
+     * @brief Records the enclosing block (or up to end()) as one phase
+     */
+    class Scope {
+    public:
+        explicit Scope(const QString& name);
+        ~Scope();
+
+        /**
+         * @brief End the phase before the block does
+         */
+        void end();
+
+        // Prevent copying
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        QString m_name;
+        qint64 m_startUs;
+        bool m_ended{false};
+    };
+
+    static StartupTrace& instance();
+
+    // Prevent copying
+    StartupTrace(const StartupTrace&) = delete;
+    StartupTrace& operator=(const StartupTrace&) = delete;
+
+    /**
+     * @brief Start the clock (first line of main)
+     */
+    void start();
+
+    /**
+     * @brief Write the trace to @p path on finish() (empty = don't write)
+     * @param quitWhenFinished Quit the application once it is written (benchmark runs)
+     */
+    void setOutput(const QString& path, bool quitWhenFinished = false);
+    bool isEnabled() const;
+
+    /**
+     * @brief Record a milestone; only its first occurrence counts
+     */
+    void mark(const QString& name);
+
+    /**
+     * @brief Milliseconds since start() at which a milestone was first reached (-1 = not yet)
+     */
+    qint64 milestoneMs(const QString& name) const;
+
+    qint64 elapsedUs() const;
+
+    /**
+     * @brief Stop recording, log the summary and write the file (once)
+     */
+    void finish();
+
+private:
+    StartupTrace() = default;
+
+    struct Event {
+        QString name;
+        qint64 startUs;
+        qint64 durationUs;   // -1 = milestone
+    };
+
+    void addPhase(const QString& name, qint64 startUs, qint64 endUs);
+    void write(const QList<Event>& events) const;
+
+    mutable QMutex m_mutex;
+    QElapsedTimer m_clock;
+    QList<Event> m_events;
+    QString m_path;
+    bool m_quitWhenFinished{false};
+    bool m_finished{false};
+};
+
+} // namespace MCM
+
+#endif // STARTUPTRACE_H
@@ -0,0 +1,398 @@
+#include "StreamEgress.h"
+#include "SnapshotService.h"
+#include "ThreadPolicy.h"
+#include <QCoreApplication>
+#include <QThread>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QMutexLocker>
+#include <QDebug>
+#include <algorithm>
+
+namespace MCM {
+
+StreamEgress& StreamEgress::instance() {
+    static StreamEgress instance;
+    return instance;
+}
+
+StreamEgress::StreamEgress()
+    : QObject(nullptr)
+{
+    // Sockets and fan-out never touch the GUI or the recorder threads
+    m_thread = new QThread();
+    m_thread->setObjectName("Egress");
+    ThreadPolicy::instance().attach(m_thread, ThreadPolicy::Role::Recording);
+    moveToThread(m_thread);
+
+    if (QCoreApplication* app = QCoreApplication::instance()) {
+        connect(app, &QCoreApplication::aboutToQuit, app, [this]() { shutdown(); });
+    }
+}
+
+StreamEgress::~StreamEgress() {
+    shutdown();
+    delete m_thread;
+}
+
+void StreamEgress::configure(const EgressConfig& config) {
+    if (m_shutdown) {
+        return;
+    }
+    {
+        QMutexLocker locker(&m_threadMutex);
+        if (!m_thread->isRunning()) {
+            if (!config.enabled) {
+                return;  // Never started, nothing to stop
+            }
+            m_thread->start(QThread::NormalPriority);
+        }
+    }
+    QMetaObject::invokeMethod(this, [this, config]() { applyConfig(config); },
+                              Qt::BlockingQueuedConnection);
+}
+
+void StreamEgress::startStream(int slotId, const QByteArray& initSegment) {
+    post([this, slotId, initSegment]() { beginChannel(slotId, initSegment); });
+}
+
+void StreamEgress::publishFragment(int slotId, const QByteArray& fragment, bool keyframe) {
+    if (!m_enabled) {
+        return;
+    }
+    m_fragments++;
+    post([this, slotId, fragment, keyframe]() { deliver(slotId, fragment, keyframe); });
+}
+
+void StreamEgress::endStream(int slotId) {
+    post([this, slotId]() { closeChannel(slotId); });
+}
+
+StreamEgress::Stats StreamEgress::stats() const {
+    Stats stats;
+    stats.streams = m_streamCount.load();
+    stats.clients = m_clientCount.load();
+    stats.fragments = m_fragments.load();
+    stats.skipped = m_skipped.load();
+    stats.bytesSent = m_bytesSent.load();
+    return stats;
+}
+
+void StreamEgress::shutdown() {
+    if (m_shutdown.exchange(true)) {
+        return;
+    }
+    m_enabled = false;
+
+    QMutexLocker locker(&m_threadMutex);
+    if (m_thread->isRunning()) {
+        QMetaObject::invokeMethod(this, [this]() {
+            closeServer();
+            m_channels.clear();
+            m_streamCount = 0;
+        }, Qt::BlockingQueuedConnection);
+        m_thread->quit();
+        m_thread->wait();
+    }
+}
+
+bool StreamEgress::post(std::function<void()> call) {
+    if (m_shutdown || !m_thread->isRunning()) {
+        return false;
+    }
+    return QMetaObject::invokeMethod(this, std::move(call), Qt::QueuedConnection);
+}
+
+void StreamEgress::applyConfig(const EgressConfig& config) {
+    const bool rebind = !m_server || config.port != m_config.port || config.bindAddress != m_config.bindAddress;
+    m_config = config;
+
+    if (!config.enabled) {
+        if (m_server) {
+            qDebug() << "StreamEgress: Stopped";
+        }
+        m_enabled = false;
+        closeServer();
+        return;
+    }
+    if (!rebind) {
+        return;
+    }
+
+    closeServer();
+    QHostAddress address(config.bindAddress);
+    if (address.isNull()) {
+        qWarning() << "StreamEgress: Invalid bind address" << config.bindAddress << "- listening on all interfaces";
+        address = QHostAddress(QHostAddress::Any);
+    }
+
+    m_server = new QTcpServer(this);
+    connect(m_server, &QTcpServer::newConnection, this, &StreamEgress::onNewConnection);
+    if (!m_server->listen(address, static_cast<quint16>(config.port))) {
+        qWarning() << "StreamEgress: Cannot listen on" << address.toString() << config.port
+                   << "-" << m_server->errorString();
+        delete m_server;
+        m_server = nullptr;
+        m_enabled = false;
+        return;
+    }
+
+    qDebug() << "StreamEgress: Serving live streams on http://" + address.toString() + ":"
+                + QString::number(m_server->serverPort()) + "/stream/<slot>.mp4";
+    m_enabled = true;
+}
+
+void StreamEgress::closeServer() {
+    const QList<QTcpSocket*> sockets = m_clients.keys();
+    m_clients.clear();
+    for (auto it = m_channels.begin(); it != m_channels.end(); ++it) {
+        it->clients.clear();
+    }
+    m_clientCount = 0;
+    for (QTcpSocket* socket : sockets) {
+        socket->abort();
+        socket->deleteLater();
+    }
+
+    if (m_server) {
+        m_server->close();
+        m_server->deleteLater();
+        m_server = nullptr;
+    }
+}
+
+void StreamEgress::onNewConnection() {
+    while (QTcpSocket* socket = m_server->nextPendingConnection()) {
+        socket->setParent(this);  // Outlives a re-bound server until the viewer is dropped
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        m_clients.insert(socket, Client());
+        m_clientCount++;
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() { onDisconnected(socket); });
+    }
+}
+
+void StreamEgress::onReadyRead(QTcpSocket* socket) {
+    auto it = m_clients.find(socket);
+    if (it == m_clients.end() || it->streaming || it->answered) {
+        socket->readAll();  // Viewers have nothing more to say
+        return;
+    }
+
+    it->request += socket->readAll();
+    const qsizetype headerEnd = it->request.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        if (it->request.size() > MAX_REQUEST_BYTES) {
+            respond(socket, 431, "Request Header Fields Too Large", "text/plain", "Request too large\n");
+        }
+        return;
+    }
+
+    const QList<QByteArray> requestLine = it->request.left(it->request.indexOf("\r\n")).split(' ');
+    it->request.clear();
+    if (requestLine.size() != 3 || !requestLine[2].startsWith("HTTP/1.")) {
+        respond(socket, 400, "Bad Request", "text/plain", "Bad request\n");
+        return;
+    }
+    if (requestLine[0] != "GET") {
+        respond(socket, 405, "Method Not Allowed", "text/plain", "Only GET is supported\n");
+        return;
+    }
+
+    QByteArray path = requestLine[1];
+    const qsizetype query = path.indexOf('?');
+    if (query >= 0) {
+        path.truncate(query);
+    }
+    handleRequest(socket, path);
+}
+
+void StreamEgress::onDisconnected(QTcpSocket* socket) {
+    auto it = m_clients.find(socket);
+    if (it != m_clients.end()) {
+        if (it->streaming) {
+            auto channel = m_channels.find(it->slotId);
+            if (channel != m_channels.end()) {
+                channel->clients.removeOne(socket);
+            }
+            qDebug() << "StreamEgress: Viewer of slot" << it->slotId << "disconnected";
+        }
+        m_clients.erase(it);
+        m_clientCount--;
+    }
+    socket->deleteLater();
+}
+
+void StreamEgress::handleRequest(QTcpSocket* socket, const QByteArray& path) {
+    auto slotFrom = [&path](const QByteArray& prefix, const QByteArray& suffix, int* slotId) {
+        if (!path.startsWith(prefix) || !path.endsWith(suffix)) {
+            return false;
+        }
+        bool ok = false;
+        *slotId = path.mid(prefix.size(), path.size() - prefix.size() - suffix.size()).toInt(&ok);
+        return ok && *slotId >= 0;
+    };
+
+    int slotId = -1;
+    if (path == "/") {
+        respond(socket, 200, "OK", "text/plain; charset=utf-8", indexPage());
+    } else if (slotFrom("/stream/", ".mp4", &slotId)) {
+        attachViewer(socket, slotId);
+    } else if (slotFrom("/snapshot/", ".jpg", &slotId)) {
+        const SnapshotService::Snapshot snapshot = SnapshotService::instance().snapshot(slotId);
+        if (snapshot.isValid()) {
+            respond(socket, 200, "OK", "image/jpeg", snapshot.jpeg);
+        } else {
+            respond(socket, 503, "Service Unavailable", "text/plain", "No snapshot yet, retry shortly\n");
+        }
+    } else {
+        respond(socket, 404, "Not Found", "text/plain", "Not found\n");
+    }
+}
+
+void StreamEgress::respond(QTcpSocket* socket, int status, const QByteArray& reason,
+                           const QByteArray& contentType, const QByteArray& body) {
+    auto it = m_clients.find(socket);
+    if (it != m_clients.end()) {
+        it->answered = true;
+    }
+    QByteArray header = "HTTP/1.1 " + QByteArray::number(status) + ' ' + reason + "\r\n"
+        + "Content-Type: " + contentType + "\r\n"
+        + "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+        + "Cache-Control: no-store\r\n"
+        + "Connection: close\r\n\r\n";
+    socket->write(header);
+    socket->write(body);
+    socket->disconnectFromHost();  // After the response is written
+}
+
+void StreamEgress::attachViewer(QTcpSocket* socket, int slotId) {
+    auto channel = m_channels.find(slotId);
+    if (channel == m_channels.end()) {
+        respond(socket, 404, "Not Found",
+                "text/plain", "No live passthrough stream for slot " + QByteArray::number(slotId) + "\n");
+        return;
+    }
+    if (channel->clients.size() >= m_config.maxClientsPerSlot) {
+        respond(socket, 503, "Service Unavailable", "text/plain", "Too many viewers\n");
+        return;
+    }
+
+    Client& client = m_clients[socket];
+    client.slotId = slotId;
+    client.streaming = true;
+    client.waitingForKeyframe = true;
+    client.lastDrained.start();
+    channel->clients.append(socket);
+
+    // Open-ended body: the stream runs until the slot stops or the viewer leaves
+    socket->write("HTTP/1.1 200 OK\r\n"
+                  "Content-Type: video/mp4\r\n"
+                  "Cache-Control: no-store\r\n"
+                  "Connection: close\r\n\r\n");
+    socket->write(channel->init);
+    qDebug() << "StreamEgress: Viewer" << socket->peerAddress().toString() << "joined slot" << slotId
+             << "(" << channel->clients.size() << "viewers )";
+}
+
+void StreamEgress::beginChannel(int slotId, const QByteArray& initSegment) {
+    if (m_channels.contains(slotId)) {
+        closeChannel(slotId);  // New session: the codec parameters may have changed
+    }
+    Channel channel;
+    channel.init = initSegment;
+    m_channels.insert(slotId, channel);
+    m_streamCount = m_channels.size();
+}
+
+void StreamEgress::deliver(int slotId, const QByteArray& fragment, bool keyframe) {
+    auto channel = m_channels.find(slotId);
+    if (channel == m_channels.end()) {
+        return;
+    }
+
+    const qint64 limit = m_config.clientBufferKB * 1024LL;
+    QList<QTcpSocket*> stalled;
+    for (QTcpSocket* socket : std::as_const(channel->clients)) {
+        Client& client = m_clients[socket];
+        const bool fits = socket->bytesToWrite() + fragment.size() <= limit;
+        if (fits) {
+            client.lastDrained.restart();
+        } else if (client.lastDrained.elapsed() > STALLED_CLIENT_MS) {
+            stalled.append(socket);
+            continue;
+        }
+
+        // Skip to the next keyframe rather than queue without bound or block the others
+        if (!fits || (client.waitingForKeyframe && !keyframe)) {
+            if (!fits && !client.waitingForKeyframe) {
+                qDebug() << "StreamEgress: Viewer of slot" << slotId << "falling behind, skipping to the next keyframe";
+            }
+            client.waitingForKeyframe = true;
+            m_skipped++;
+            continue;
+        }
+
+        client.waitingForKeyframe = false;
+        socket->write(fragment);  // Shares the fragment's buffer, no copy per viewer
+        m_bytesSent += fragment.size();
+    }
+
+    for (QTcpSocket* socket : std::as_const(stalled)) {
+        qWarning() << "StreamEgress: Viewer of slot" << slotId << "stalled for"
+                   << STALLED_CLIENT_MS / 1000 << "s, disconnecting";
+        dropClient(socket);
+    }
+}
+
+void StreamEgress::closeChannel(int slotId) {
+    auto channel = m_channels.find(slotId);
+    if (channel == m_channels.end()) {
+        return;
+    }
+    const QList<QTcpSocket*> viewers = channel->clients;
+    m_channels.erase(channel);
+    m_streamCount = m_channels.size();
+
+    // Let viewers receive what is queued, then close
+    for (QTcpSocket* socket : viewers) {
+        auto it = m_clients.find(socket);
+        if (it != m_clients.end()) {
+            it->streaming = false;
+            it->answered = true;
+        }
+        socket->disconnectFromHost();
+    }
+}
+
+void StreamEgress::dropClient(QTcpSocket* socket) {
+    auto it = m_clients.find(socket);
+    if (it == m_clients.end()) {
+        return;
+    }
+    auto channel = m_channels.find(it->slotId);
+    if (channel != m_channels.end()) {
+        channel->clients.removeOne(socket);
+    }
+    m_clients.erase(it);
+    m_clientCount--;
+    socket->abort();
+    socket->deleteLater();
+}
+
+QByteArray StreamEgress::indexPage() const {
+    QByteArray page = "Live passthrough streams\n\n";
+    QList<int> slotIds = m_channels.keys();
+    std::sort(slotIds.begin(), slotIds.end());
+    for (int slotId : slotIds) {
+        page += "/stream/" + QByteArray::number(slotId) + ".mp4  "
+              + QByteArray::number(m_channels.value(slotId).clients.size()) + " viewers\n";
+    }
+    if (slotIds.isEmpty()) {
+        page += "(none)\n";
+    }
+    return page;
+}
+
+} // namespace MCM
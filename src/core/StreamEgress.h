@@ -0,0 +1,159 @@
+#ifndef STREAMEGRESS_H
+#define STREAMEGRESS_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <atomic>
+#include <functional>
+#include "core/Config.h"
+
+class QThread;
+class QTcpServer;
+class QTcpSocket;
+
+namespace MCM {
+
+/**
+ * @brief Re-publishes passthrough streams to network viewers over HTTP (Singleton)
+ *
+ * Replaces an external relay: RtspRemuxRecorder already holds each RTSP
+ * camera's compressed packets, Fmp4Segmenter turns them into fragmented
+ * MP4, and this server sends the fragments to every viewer of the slot -
+ * no decoding, no encoding. Streams are plain progressive HTTP, playable
+ * by ffplay, VLC and browsers:
+ *
+ *   GET /stream/<slot>.mp4     Live stream (init segment, then fragments)
+ *   GET /snapshot/<slot>.jpg   Cached thumbnail from SnapshotService
+ *   GET /                      Plain-text list of live streams
+ *
+ * The server, its sockets and all fan-out live on one "Egress" thread.
+ * Each fragment is one QByteArray handed to every viewer's socket, which
+ * share it instead of copying. A viewer whose unsent data would exceed
+ * clientBufferKB skips fragments until the next keyframe, so a slow
+ * client never holds up capture, recording or the other viewers; one
+ * that has not drained for STALLED_CLIENT_MS is disconnected. New viewers
+ * get the init segment and join at the next keyframe fragment.
+ *
+ * Usage:
+ *   StreamEgress::instance().configure(config.egress());        // main()
+ *   StreamEgress::instance().startStream(slotId, segmenter.initSegment());
+ *   StreamEgress::instance().publishFragment(slotId, fragment, keyframe);
+ *   StreamEgress::instance().endStream(slotId);
+ */
+class StreamEgress : public QObject {
+    Q_OBJECT
+
+public:
+    struct Stats {
+        int streams{0};
+        int clients{0};
+        quint64 fragments{0};        // Fragments published
+        quint64 skipped{0};          // Fragment deliveries skipped for slow or joining viewers
+        quint64 bytesSent{0};        // Bytes handed to viewer sockets
+    };
+
+    static StreamEgress& instance();
+
+    // Prevent copying
+    StreamEgress(const StreamEgress&) = delete;
+    StreamEgress& operator=(const StreamEgress&) = delete;
+
+    /**
+     * @brief Start, re-bind or stop the server; limits apply to new fragments
+     */
+    void configure(const EgressConfig& config);
+
+    /**
+     * @brief Whether streams should be published (egress.enabled and listening)
+     */
+    bool isEnabled() const { return m_enabled.load(); }
+
+    /**
+     * @brief Start (or restart) a slot's stream (thread-safe)
+     *
+     * Viewers of a previous stream of the slot are disconnected: their
+     * decoder state does not fit the new init segment.
+     */
+    void startStream(int slotId, const QByteArray& initSegment);
+
+    /**
+     * @brief Send a fragment to the slot's viewers (thread-safe, never blocks)
+     * @param keyframe The fragment starts with a keyframe
+     */
+    void publishFragment(int slotId, const QByteArray& fragment, bool keyframe);
+
+    /**
+     * @brief End a slot's stream and disconnect its viewers (thread-safe)
+     */
+    void endStream(int slotId);
+
+    Stats stats() const;
+
+    /**
+     * @brief Close all connections and stop the egress thread (on quit)
+     */
+    void shutdown();
+
+private:
+    StreamEgress();
+    ~StreamEgress() override;
+
+    struct Client {
+        int slotId{-1};
+        QByteArray request;
+        bool streaming{false};
+        bool answered{false};      // Response sent, closing
+        bool waitingForKeyframe{true};
+        QElapsedTimer lastDrained;   // Since the backlog was last below the limit
+    };
+
+    struct Channel {
+        QByteArray init;
+        QList<QTcpSocket*> clients;
+    };
+
+    // Egress thread
+    void applyConfig(const EgressConfig& config);
+    void closeServer();
+    void onNewConnection();
+    void onReadyRead(QTcpSocket* socket);
+    void onDisconnected(QTcpSocket* socket);
+    void handleRequest(QTcpSocket* socket, const QByteArray& path);
+    void respond(QTcpSocket* socket, int status, const QByteArray& reason,
+                 const QByteArray& contentType, const QByteArray& body);
+    void attachViewer(QTcpSocket* socket, int slotId);
+    void beginChannel(int slotId, const QByteArray& initSegment);
+    void deliver(int slotId, const QByteArray& fragment, bool keyframe);
+    void closeChannel(int slotId);
+    void dropClient(QTcpSocket* socket);
+    QByteArray indexPage() const;
+
+    bool post(std::function<void()> call);
+
+    QThread* m_thread{nullptr};
+    QTcpServer* m_server{nullptr};
+    EgressConfig m_config;            // Egress thread copy
+    QHash<QTcpSocket*, Client> m_clients;
+    QHash<int, Channel> m_channels;
+
+    QMutex m_threadMutex;             // Guards m_thread start/stop
+    std::atomic<bool> m_enabled{false};
+    std::atomic<bool> m_shutdown{false};
+
+    std::atomic<int> m_streamCount{0};
+    std::atomic<int> m_clientCount{0};
+    std::atomic<quint64> m_fragments{0};
+    std::atomic<quint64> m_skipped{0};
+    std::atomic<quint64> m_bytesSent{0};
+
+    static constexpr int MAX_REQUEST_BYTES = 8 * 1024;
+    static constexpr int STALLED_CLIENT_MS = 30000;
+};
+
+} // namespace MCM
+
+#endif // STREAMEGRESS_H
@@ -0,0 +1,394 @@
+#include "Telemetry.h"
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QVideoFrame>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+namespace MCM {
+
+namespace {
+
+const char* const DROP_STAGE_NAMES[] = {"stale", "preview", "hidden", "rotation", "coalesced"};
+
+void appendHeader(QByteArray& out, const char* name, const char* type, const char* help) {
+    out += "# HELP "; out += name; out += ' '; out += help; out += '\n';
+    out += "# TYPE "; out += name; out += ' '; out += type; out += '\n';
+}
+
+void appendSample(QByteArray& out, const char* name, const QByteArray& labels, double value) {
+    out += name;
+    out += '{'; out += labels; out += "} ";
+    out += QByteArray::number(value, 'g', 12);
+    out += '\n';
+}
+
+void appendHistogram(QByteArray& out, const char* name, const QByteArray& labels,
+                     const LatencyHistogram::Snapshot& h) {
+    const QByteArray bucket = QByteArray(name) + "_bucket";
+    quint64 cumulative = 0;
+    for (int i = 0; i < LatencyHistogram::BOUND_COUNT; ++i) {
+        cumulative += h.counts[i];
+        const QByteArray le = QByteArray::number(LatencyHistogram::BOUNDS_US[i] / 1e6, 'g', 6);
+        appendSample(out, bucket.constData(), labels + ",le=\"" + le + "\"", static_cast<double>(cumulative));
+    }
+    appendSample(out, bucket.constData(), labels + ",le=\"+Inf\"", static_cast<double>(h.count));
+    appendSample(out, (QByteArray(name) + "_sum").constData(), labels, h.sumUs / 1e6);
+    appendSample(out, (QByteArray(name) + "_count").constData(), labels, static_cast<double>(h.count));
+}
+
+bool writeFile(const QString& path, const QByteArray& data) {
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    // Write-then-rename so scrapers never read a half-written file
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(data);
+    return file.commit();
+}
+
+} // namespace
+
+// LatencyHistogram implementation
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot s;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        s.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+    }
+    s.count = m_count.load(std::memory_order_relaxed);
+    s.sumUs = m_sumUs.load(std::memory_order_relaxed);
+    s.maxUs = m_maxUs.load(std::memory_order_relaxed);
+    return s;
+}
+
+qint64 LatencyHistogram::Snapshot::percentileUs(double q) const {
+    quint64 total = 0;
+    for (quint64 c : counts) {
+        total += c;
+    }
+    if (total == 0) {
+        return -1;
+    }
+    const quint64 rank = qMax<quint64>(1, static_cast<quint64>(q * total + 0.5));
+    quint64 seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return i < BOUND_COUNT ? BOUNDS_US[i] : maxUs;
+        }
+    }
+    return maxUs;
+}
+
+void LatencyHistogram::Snapshot::merge(const Snapshot& other) {
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        counts[i] += other.counts[i];
+    }
+    count += other.count;
+    sumUs += other.sumUs;
+    maxUs = qMax(maxUs, other.maxUs);
+}
+
+QJsonObject LatencyHistogram::Snapshot::toJson() const {
+    auto ms = [](qint64 us) { return us < 0 ? -1.0 : us / 1000.0; };
+    return QJsonObject{
+        {"count", static_cast<double>(count)},
+        {"meanMs", ms(meanUs())},
+        {"p50Ms", ms(percentileUs(0.50))},
+        {"p95Ms", ms(percentileUs(0.95))},
+        {"p99Ms", ms(percentileUs(0.99))},
+        {"maxMs", count > 0 ? ms(maxUs) : -1.0}
+    };
+}
+
+// SlotTelemetry implementation
+void SlotTelemetry::recordArrival(qint64 startTimeUs, qint64 nowUs) {
+    m_framesCaptured.fetch_add(1, std::memory_order_relaxed);
+
+    // Jitter = change in inter-arrival interval between consecutive frames
+    const qint64 lastArrival = m_lastArrivalUs.exchange(nowUs, std::memory_order_relaxed);
+    if (lastArrival != NO_VALUE) {
+        const qint64 interval = nowUs - lastArrival;
+        const qint64 lastInterval = m_lastIntervalUs.exchange(interval, std::memory_order_relaxed);
+        if (lastInterval != NO_VALUE) {
+            m_jitter.record(qAbs(interval - lastInterval));
+        }
+    }
+
+    if (startTimeUs < 0) {
+        return;
+    }
+    // Baseline = fastest observed capture-to-arrival; a big step means the
+    // stream clock jumped (reconnect, seek) and the old baseline is meaningless
+    const qint64 offset = nowUs - startTimeUs;
+    qint64 baseline = m_clockOffsetUs.load(std::memory_order_relaxed);
+    while (baseline == NO_VALUE || offset < baseline || offset > baseline + CLOCK_JUMP_US) {
+        if (m_clockOffsetUs.compare_exchange_weak(baseline, offset, std::memory_order_relaxed)) {
+            break;
+        }
+    }
+}
+
+void SlotTelemetry::recordPresented(qint64 startTimeUs, qint64 nowUs) {
+    if (startTimeUs < 0
+        || m_lastPresentedStartUs.exchange(startTimeUs, std::memory_order_relaxed) == startTimeUs) {
+        return;  // No timestamp, or a repaint of a frame already counted
+    }
+    m_framesPresented.fetch_add(1, std::memory_order_relaxed);
+
+    const qint64 baseline = m_clockOffsetUs.load(std::memory_order_relaxed);
+    if (baseline != NO_VALUE) {
+        m_displayLatency.record(nowUs - (startTimeUs + baseline));
+    }
+}
+
+void SlotTelemetry::recordRotation(qint64 gapMs, int framesLost, qint64 finalizeMs) {
+    m_rotations.fetch_add(1, std::memory_order_relaxed);
+    m_lastRotationGapMs.store(gapMs, std::memory_order_relaxed);
+    m_lastFinalizeMs.store(finalizeMs, std::memory_order_relaxed);
+    if (framesLost > 0) {
+        recordDrop(DropStage::Rotation, static_cast<quint64>(framesLost));
+    }
+}
+
+void SlotTelemetry::recordRecovery(qint64 outageMs) {
+    m_recoveries.fetch_add(1, std::memory_order_relaxed);
+    m_lastRecoveryMs.store(outageMs, std::memory_order_relaxed);
+    m_outageMsTotal.fetch_add(outageMs, std::memory_order_relaxed);
+    qint64 max = m_maxRecoveryMs.load(std::memory_order_relaxed);
+    while (outageMs > max && !m_maxRecoveryMs.compare_exchange_weak(max, outageMs, std::memory_order_relaxed)) {
+    }
+}
+
+void SlotTelemetry::recordFrameMap(const QVideoFrame& frame) {
+    const char* path = m_decodePath.load(std::memory_order_relaxed);
+    const bool hardwareStream = path && std::strcmp(path, "software") != 0;
+    if (frame.handleType() != QVideoFrame::NoHandle || hardwareStream) {
+        m_gpuDownloads.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void SlotTelemetry::resetStream() {
+    m_clockOffsetUs.store(NO_VALUE, std::memory_order_relaxed);
+    m_lastPresentedStartUs.store(NO_VALUE, std::memory_order_relaxed);
+    m_lastArrivalUs.store(NO_VALUE, std::memory_order_relaxed);
+    m_lastIntervalUs.store(NO_VALUE, std::memory_order_relaxed);
+}
+
+SlotTelemetry::Snapshot SlotTelemetry::snapshot() const {
+    Snapshot s;
+    s.slotId = m_slotId;
+    s.framesCaptured = m_framesCaptured.load(std::memory_order_relaxed);
+    s.framesPresented = m_framesPresented.load(std::memory_order_relaxed);
+    for (int i = 0; i < static_cast<int>(DropStage::Count); ++i) {
+        s.dropped[i] = m_dropped[i].load(std::memory_order_relaxed);
+    }
+    s.reconnects = m_reconnects.load(std::memory_order_relaxed);
+    s.connectionLosses = m_connectionLosses.load(std::memory_order_relaxed);
+    s.recoveries = m_recoveries.load(std::memory_order_relaxed);
+    s.lastRecoveryMs = m_lastRecoveryMs.load(std::memory_order_relaxed);
+    s.maxRecoveryMs = m_maxRecoveryMs.load(std::memory_order_relaxed);
+    s.outageMsTotal = m_outageMsTotal.load(std::memory_order_relaxed);
+    s.encoderBacklogMs = m_encoderBacklogMs.load(std::memory_order_relaxed);
+    s.rotations = m_rotations.load(std::memory_order_relaxed);
+    s.lastRotationGapMs = m_lastRotationGapMs.load(std::memory_order_relaxed);
+    s.lastFinalizeMs = m_lastFinalizeMs.load(std::memory_order_relaxed);
+    s.decodePath = m_decodePath.load(std::memory_order_relaxed);
+    s.gpuDownloads = m_gpuDownloads.load(std::memory_order_relaxed);
+    s.displayLatency = m_displayLatency.snapshot();
+    s.jitter = m_jitter.snapshot();
+    return s;
+}
+
+QJsonObject SlotTelemetry::Snapshot::toJson() const {
+    QJsonObject drops;
+    for (int i = 0; i < static_cast<int>(DropStage::Count); ++i) {
+        drops[DROP_STAGE_NAMES[i]] = static_cast<double>(dropped[i]);
+    }
+    return QJsonObject{
+        {"slot", slotId},
+        {"framesCaptured", static_cast<double>(framesCaptured)},
+        {"framesPresented", static_cast<double>(framesPresented)},
+        {"framesDropped", drops},
+        {"reconnects", static_cast<double>(reconnects)},
+        {"connectionLosses", static_cast<double>(connectionLosses)},
+        {"recoveries", static_cast<double>(recoveries)},
+        {"lastRecoveryMs", static_cast<double>(lastRecoveryMs)},
+        {"maxRecoveryMs", static_cast<double>(maxRecoveryMs)},
+        {"outageMsTotal", static_cast<double>(outageMsTotal)},
+        {"encoderBacklogMs", static_cast<double>(encoderBacklogMs)},
+        {"rotations", static_cast<double>(rotations)},
+        {"lastRotationGapMs", static_cast<double>(lastRotationGapMs)},
+        {"lastFinalizeMs", static_cast<double>(lastFinalizeMs)},
+        {"decodePath", decodePath ? QJsonValue(QString::fromLatin1(decodePath)) : QJsonValue()},
+        {"gpuDownloads", static_cast<double>(gpuDownloads)},
+        {"displayLatency", displayLatency.toJson()},
+        {"jitter", jitter.toJson()}
+    };
+}
+
+// Telemetry implementation
+Telemetry& Telemetry::instance() {
+    static Telemetry instance;
+    return instance;
+}
+
+Telemetry::Telemetry()
+    : m_exportTimer(new QTimer(this))
+{
+    connect(m_exportTimer, &QTimer::timeout, this, &Telemetry::exportNow);
+}
+
+Telemetry::~Telemetry() {
+    qDeleteAll(m_slots);
+}
+
+qint64 Telemetry::nowUs() {
+    static const QElapsedTimer clock = []() {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    return clock.nsecsElapsed() / 1000;
+}
+
+SlotTelemetry* Telemetry::slot(int slotId) {
+    QMutexLocker locker(&m_mutex);
+    SlotTelemetry*& entry = m_slots[slotId];
+    if (!entry) {
+        entry = new SlotTelemetry(slotId);
+    }
+    return entry;
+}
+
+QList<SlotTelemetry::Snapshot> Telemetry::snapshot() const {
+    QList<SlotTelemetry::Snapshot> result;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (const SlotTelemetry* slot : m_slots) {
+            result.append(slot->snapshot());
+        }
+    }
+    std::sort(result.begin(), result.end(),
+              [](const SlotTelemetry::Snapshot& a, const SlotTelemetry::Snapshot& b) {
+                  return a.slotId < b.slotId;
+              });
+    return result;
+}
+
+QJsonObject Telemetry::toJson() const {
+    QJsonArray slots;
+    for (const SlotTelemetry::Snapshot& s : snapshot()) {
+        slots.append(s.toJson());
+    }
+    return QJsonObject{
+        {"timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs)},
+        {"uptimeMs", static_cast<double>(nowUs() / 1000)},
+        {"slots", slots}
+    };
+}
+
+QByteArray Telemetry::toPrometheus() const {
+    const QList<SlotTelemetry::Snapshot> snaps = snapshot();
+    auto labels = [](const SlotTelemetry::Snapshot& s) {
+        return QByteArray("slot=\"") + QByteArray::number(s.slotId) + '"';
+    };
+
+    QByteArray out;
+    appendHeader(out, "mcm_frames_captured_total", "counter", "Frames delivered by the capture pipeline");
+    for (const auto& s : snaps) appendSample(out, "mcm_frames_captured_total", labels(s), s.framesCaptured);
+
+    appendHeader(out, "mcm_frames_presented_total", "counter", "Distinct frames painted in the tile");
+    for (const auto& s : snaps) appendSample(out, "mcm_frames_presented_total", labels(s), s.framesPresented);
+
+    appendHeader(out, "mcm_frames_dropped_total", "counter", "Frames dropped, by pipeline stage");
+    for (const auto& s : snaps) {
+        for (int i = 0; i < static_cast<int>(SlotTelemetry::DropStage::Count); ++i) {
+            appendSample(out, "mcm_frames_dropped_total",
+                         labels(s) + ",stage=\"" + DROP_STAGE_NAMES[i] + '"', s.dropped[i]);
+        }
+    }
+
+    appendHeader(out, "mcm_reconnects_total", "counter", "Stream reconnect attempts");
+    for (const auto& s : snaps) appendSample(out, "mcm_reconnects_total", labels(s), s.reconnects);
+
+    appendHeader(out, "mcm_connection_losses_total", "counter", "Connections lost");
+    for (const auto& s : snaps) appendSample(out, "mcm_connection_losses_total", labels(s), s.connectionLosses);
+
+    appendHeader(out, "mcm_recoveries_total", "counter", "Outages recovered (frames flowing again)");
+    for (const auto& s : snaps) appendSample(out, "mcm_recoveries_total", labels(s), s.recoveries);
+
+    appendHeader(out, "mcm_last_recovery_seconds", "gauge", "Time to recover from the last outage (-1 = none yet)");
+    for (const auto& s : snaps) {
+        appendSample(out, "mcm_last_recovery_seconds", labels(s),
+                     s.lastRecoveryMs < 0 ? -1.0 : s.lastRecoveryMs / 1000.0);
+    }
+
+    appendHeader(out, "mcm_outage_seconds_total", "counter", "Time spent without frames in recovered outages");
+    for (const auto& s : snaps) appendSample(out, "mcm_outage_seconds_total", labels(s), s.outageMsTotal / 1000.0);
+
+    appendHeader(out, "mcm_encoder_backlog_seconds", "gauge", "Media time the encoder is behind wall time (-1 = not recording)");
+    for (const auto& s : snaps) {
+        appendSample(out, "mcm_encoder_backlog_seconds", labels(s),
+                     s.encoderBacklogMs < 0 ? -1.0 : s.encoderBacklogMs / 1000.0);
+    }
+
+    appendHeader(out, "mcm_decode_path_info", "gauge", "Decode path detected on the stream's first frame");
+    for (const auto& s : snaps) {
+        if (s.decodePath) {
+            appendSample(out, "mcm_decode_path_info", labels(s) + ",path=\"" + s.decodePath + '"', 1);
+        }
+    }
+
+    appendHeader(out, "mcm_gpu_downloads_total", "counter", "Frames copied from GPU to CPU memory for analysis");
+    for (const auto& s : snaps) appendSample(out, "mcm_gpu_downloads_total", labels(s), s.gpuDownloads);
+
+    appendHeader(out, "mcm_chunk_rotations_total", "counter", "Recording chunk rotations");
+    for (const auto& s : snaps) appendSample(out, "mcm_chunk_rotations_total", labels(s), s.rotations);
+
+    appendHeader(out, "mcm_rotation_gap_seconds", "gauge", "Recording gap of the last chunk rotation");
+    for (const auto& s : snaps) {
+        appendSample(out, "mcm_rotation_gap_seconds", labels(s),
+                     s.lastRotationGapMs < 0 ? -1.0 : s.lastRotationGapMs / 1000.0);
+    }
+
+    appendHeader(out, "mcm_display_latency_seconds", "histogram", "Capture-to-present latency above the stream baseline");
+    for (const auto& s : snaps) appendHistogram(out, "mcm_display_latency_seconds", labels(s), s.displayLatency);
+
+    appendHeader(out, "mcm_frame_jitter_seconds", "histogram", "Change in inter-frame arrival interval");
+    for (const auto& s : snaps) appendHistogram(out, "mcm_frame_jitter_seconds", labels(s), s.jitter);
+
+    return out;
+}
+
+void Telemetry::configure(const TelemetryConfig& config) {
+    m_config = config;
+    if (!config.enabled || (config.jsonPath.isEmpty() && config.prometheusPath.isEmpty())) {
+        m_exportTimer->stop();
+        return;
+    }
+    m_exportTimer->start(qMax(1, config.intervalSeconds) * 1000);
+    qDebug() << "Telemetry: Exporting every" << config.intervalSeconds << "s to"
+             << config.jsonPath << config.prometheusPath;
+}
+
+void Telemetry::exportNow() {
+    if (!m_config.jsonPath.isEmpty()
+        && !writeFile(m_config.jsonPath, QJsonDocument(toJson()).toJson(QJsonDocument::Indented))) {
+        qWarning() << "Telemetry: Could not write" << m_config.jsonPath;
+    }
+    if (!m_config.prometheusPath.isEmpty() && !writeFile(m_config.prometheusPath, toPrometheus())) {
+        qWarning() << "Telemetry: Could not write" << m_config.prometheusPath;
+    }
+    emit exported();
+}
+
+} // namespace MCM
@@ -0,0 +1,276 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QTimer>
+#include <QJsonObject>
+#include <QByteArray>
+#include <array>
+#include <atomic>
+#include <limits>
+#include "core/Config.h"
+
+class QVideoFrame;
+
+namespace MCM {
+
+/**
+ * @brief Fixed-bucket histogram, lock-free to update
+ *
+ * Buckets are tuned for frame timing (1 ms .. 1 s); values above the last
+ * bound land in the overflow bucket. Snapshots are not atomic as a whole
+ * but every field is, which is enough for monitoring.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int BOUND_COUNT = 11;
+    static constexpr int BUCKET_COUNT = BOUND_COUNT + 1;  // + overflow
+    static constexpr qint64 BOUNDS_US[BOUND_COUNT] = {
+        1000, 2000, 5000, 10000, 20000, 33000, 50000, 100000, 200000, 500000, 1000000
+    };
+
+    struct Snapshot {
+        std::array<quint64, BUCKET_COUNT> counts{};
+        quint64 count{0};
+        qint64 sumUs{0};
+        qint64 maxUs{0};
+
+        /**
+         * @brief Upper bound of the bucket holding quantile @p q (0..1), -1 if empty
+         */
+        qint64 percentileUs(double q) const;
+        qint64 meanUs() const { return count > 0 ? sumUs / static_cast<qint64>(count) : -1; }
+
+        /**
+         * @brief Add another histogram's samples (e.g. to combine slots)
+         */
+        void merge(const Snapshot& other);
+
+        /**
+         * @brief count, mean, p50/p95/p99 and max in milliseconds (-1 when empty)
+         */
+        QJsonObject toJson() const;
+    };
+
+    void record(qint64 valueUs) {
+        valueUs = qMax<qint64>(0, valueUs);
+        int bucket = 0;
+        while (bucket < BOUND_COUNT && valueUs > BOUNDS_US[bucket]) {
+            bucket++;
+        }
+        m_counts[bucket].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_sumUs.fetch_add(valueUs, std::memory_order_relaxed);
+        qint64 max = m_maxUs.load(std::memory_order_relaxed);
+        while (valueUs > max && !m_maxUs.compare_exchange_weak(max, valueUs, std::memory_order_relaxed)) {
+        }
+    }
+
+    Snapshot snapshot() const;
+
+private:
+    std::atomic<quint64> m_counts[BUCKET_COUNT]{};
+    std::atomic<quint64> m_count{0};
+    std::atomic<qint64> m_sumUs{0};
+    std::atomic<qint64> m_maxUs{0};
+};
+
+/**
+ * @brief Pipeline metrics of one camera slot
+ *
+ * Updated from the capture worker (arrival, jitter, stale drops), the GUI
+ * thread (presentation, preview drops, connection events) and the recorder;
+ * every update is a handful of relaxed atomic operations - no locks on the
+ * hot path. Obtain instances from Telemetry::slot(); they live until exit.
+ *
+ * Display latency is measured against the stream's own clock: the smallest
+ * observed (arrival - frame start time) is taken as the capture baseline, and
+ * each presented frame reports how much later than that it reached the
+ * screen. Frames without timestamps are not included.
+ */
+class SlotTelemetry {
+public:
+    enum class DropStage {
+        Stale,     // Queued from a stream that was restarted
+        Preview,   // Decimated to the tile's display fps
+        Hidden,    // Tile not visible (render demand off)
+        Rotation,  // Delivered while no encoder was recording (chunk swap)
+        Coalesced, // Replaced by a newer frame before a busy consumer got to it
+        Count
+    };
+
+    struct Snapshot {
+        int slotId{-1};
+        quint64 framesCaptured{0};
+        quint64 framesPresented{0};
+        std::array<quint64, static_cast<int>(DropStage::Count)> dropped{};
+        quint64 reconnects{0};
+        quint64 connectionLosses{0};
+        quint64 recoveries{0};
+        qint64 lastRecoveryMs{-1};
+        qint64 maxRecoveryMs{-1};
+        qint64 outageMsTotal{0};
+        qint64 encoderBacklogMs{-1};
+        quint64 rotations{0};
+        qint64 lastRotationGapMs{-1};
+        qint64 lastFinalizeMs{-1};
+        const char* decodePath{nullptr};     // DecoderScheduler::pathName(), null before the first frame
+        quint64 gpuDownloads{0};
+        LatencyHistogram::Snapshot displayLatency;
+        LatencyHistogram::Snapshot jitter;
+
+        QJsonObject toJson() const;
+    };
+
+    explicit SlotTelemetry(int slotId) : m_slotId(slotId) {}
+
+    int slotId() const { return m_slotId; }
+
+    /**
+     * @brief A frame reached the capture worker
+     * @param startTimeUs QVideoFrame::startTime() (-1 if none)
+     * @param nowUs Telemetry::nowUs()
+     */
+    void recordArrival(qint64 startTimeUs, qint64 nowUs);
+
+    /**
+     * @brief The frame with @p startTimeUs was painted (repaints of the same frame are ignored)
+     */
+    void recordPresented(qint64 startTimeUs, qint64 nowUs);
+
+    void recordDrop(DropStage stage, quint64 count = 1) {
+        m_dropped[static_cast<int>(stage)].fetch_add(count, std::memory_order_relaxed);
+    }
+    void recordReconnect() { m_reconnects.fetch_add(1, std::memory_order_relaxed); }
+    void recordConnectionLost() { m_connectionLosses.fetch_add(1, std::memory_order_relaxed); }
+
+    /**
+     * @brief Frames flow again after an outage of @p outageMs (loss to first frame)
+     */
+    void recordRecovery(qint64 outageMs);
+
+    /**
+     * @brief Media time the encoder is behind wall time in the current chunk
+     */
+    void setEncoderBacklogMs(qint64 ms) { m_encoderBacklogMs.store(ms, std::memory_order_relaxed); }
+
+    /**
+     * @brief Decode path detected on the stream's first frame (string with static storage)
+     */
+    void setDecodePath(const char* path) { m_decodePath.store(path, std::memory_order_relaxed); }
+
+    /**
+     * @brief A consumer is about to map() @p frame into CPU memory
+     *
+     * Counted as a GPU download when the frame is texture-backed or the
+     * stream is decoded in hardware (map() then copies off the GPU).
+     */
+    void recordFrameMap(const QVideoFrame& frame);
+
+    /**
+     * @brief A chunk rotation finished (see RotationMetrics)
+     */
+    void recordRotation(qint64 gapMs, int framesLost, qint64 finalizeMs);
+
+    /**
+     * @brief New stream: timestamps restart, so drop the clock baseline
+     */
+    void resetStream();
+
+    Snapshot snapshot() const;
+
+private:
+    static constexpr qint64 NO_VALUE = std::numeric_limits<qint64>::min();
+    static constexpr qint64 CLOCK_JUMP_US = 10000000;  // Re-baseline after a 10 s step
+
+    int m_slotId;
+
+    std::atomic<quint64> m_framesCaptured{0};
+    std::atomic<quint64> m_framesPresented{0};
+    std::atomic<quint64> m_dropped[static_cast<int>(DropStage::Count)]{};
+    std::atomic<quint64> m_reconnects{0};
+    std::atomic<quint64> m_connectionLosses{0};
+    std::atomic<quint64> m_recoveries{0};
+    std::atomic<qint64> m_lastRecoveryMs{-1};
+    std::atomic<qint64> m_maxRecoveryMs{-1};
+    std::atomic<qint64> m_outageMsTotal{0};
+    std::atomic<qint64> m_encoderBacklogMs{-1};
+    std::atomic<quint64> m_rotations{0};
+    std::atomic<qint64> m_lastRotationGapMs{-1};
+    std::atomic<qint64> m_lastFinalizeMs{-1};
+    std::atomic<const char*> m_decodePath{nullptr};
+    std::atomic<quint64> m_gpuDownloads{0};
+
+    std::atomic<qint64> m_clockOffsetUs{NO_VALUE};      // min(arrival - startTime)
+    std::atomic<qint64> m_lastPresentedStartUs{NO_VALUE};
+    std::atomic<qint64> m_lastArrivalUs{NO_VALUE};
+    std::atomic<qint64> m_lastIntervalUs{NO_VALUE};
+
+    LatencyHistogram m_displayLatency;
+    LatencyHistogram m_jitter;
+};
+
+/**
+ * @brief Registry and exporter of per-slot telemetry (Singleton)
+ *
+ * Exports every slot's metrics as JSON and in the Prometheus text format,
+ * on demand or periodically to files (see TelemetryConfig). The Prometheus
+ * file suits node_exporter's textfile collector.
+ *
+ * Usage:
+ *   SlotTelemetry* t = Telemetry::instance().slot(slotId);
+ *   t->recordArrival(frame.startTime(), Telemetry::nowUs());
+ */
+class Telemetry : public QObject {
+    Q_OBJECT
+
+public:
+    static Telemetry& instance();
+
+    // Prevent copying
+    Telemetry(const Telemetry&) = delete;
+    Telemetry& operator=(const Telemetry&) = delete;
+
+    /**
+     * @brief Metrics of a slot (created on first use, never freed)
+     */
+    SlotTelemetry* slot(int slotId);
+
+    /**
+     * @brief Monotonic microseconds shared by all measurements
+     */
+    static qint64 nowUs();
+
+    QList<SlotTelemetry::Snapshot> snapshot() const;
+    QJsonObject toJson() const;
+    QByteArray toPrometheus() const;
+
+    /**
+     * @brief Start or stop periodic export
+     */
+    void configure(const TelemetryConfig& config);
+
+public slots:
+    /**
+     * @brief Write the configured export files now
+     */
+    void exportNow();
+
+signals:
+    void exported();
+
+private:
+    Telemetry();
+    ~Telemetry() override;
+
+    mutable QMutex m_mutex;
+    QHash<int, SlotTelemetry*> m_slots;
+    TelemetryConfig m_config;
+    QTimer* m_exportTimer{nullptr};
+};
+
+} // namespace MCM
+
+#endif // TELEMETRY_H
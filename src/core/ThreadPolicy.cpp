@@ -0,0 +1,447 @@
+#include "ThreadPolicy.h"
+#include "CaptureWorkerPool.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutexLocker>
+#include <QSet>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace MCM {
+
+namespace {
+
+QElapsedTimer& sampleClock() {
+    static QElapsedTimer clock;
+    if (!clock.isValid()) {
+        clock.start();
+    }
+    return clock;
+}
+
+#ifdef Q_OS_LINUX
+struct TaskStat {
+    QString name;
+    qint64 ticks{-1};      // utime + stime
+    int core{-1};
+    int nice{0};
+};
+
+TaskStat readTaskStat(qint64 tid) {
+    TaskStat stat;
+    // procfs reports size 0: read it in one go
+    QFile file(QString("/proc/self/task/%1/stat").arg(tid));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return stat;
+    }
+    const QByteArray line = file.readAll();
+    // The name is in parentheses and may itself contain spaces or ')'
+    const int open = line.indexOf('(');
+    const int close = line.lastIndexOf(')');
+    if (open < 0 || close < open) {
+        return stat;
+    }
+    stat.name = QString::fromUtf8(line.mid(open + 1, close - open - 1));
+    const QList<QByteArray> fields = line.mid(close + 2).split(' ');
+    // fields[0] is field 3 (state) of proc(5)
+    if (fields.size() > 36) {
+        stat.ticks = fields[11].toLongLong() + fields[12].toLongLong();
+        stat.nice = fields[16].toInt();
+        stat.core = fields[36].toInt();
+    }
+    return stat;
+}
+
+QList<qint64> taskIds() {
+    QList<qint64> tids;
+    const QStringList entries = QDir("/proc/self/task").entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString& entry : entries) {
+        bool ok = false;
+        const qint64 tid = entry.toLongLong(&ok);
+        if (ok) {
+            tids.append(tid);
+        }
+    }
+    return tids;
+}
+
+bool setAffinity(qint64 tid, const QList<int>& cores) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int core : cores) {
+        CPU_SET(core, &set);
+    }
+    return sched_setaffinity(static_cast<pid_t>(tid), sizeof(set), &set) == 0;
+}
+
+bool affinityContains(qint64 tid, int core) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(static_cast<pid_t>(tid), sizeof(set), &set) != 0) {
+        return false;
+    }
+    return CPU_ISSET(core, &set);
+}
+#endif
+
+} // namespace
+
+ThreadPolicy& ThreadPolicy::instance() {
+    static ThreadPolicy instance;
+    return instance;
+}
+
+ThreadPolicy::ThreadPolicy()
+    : QObject(nullptr)
+{
+    // Sweeps and reports run on the GUI thread whoever touches the policy first
+    if (QCoreApplication* app = QCoreApplication::instance()) {
+        moveToThread(app->thread());
+        m_sweepTimer.moveToThread(app->thread());
+        m_reportTimer.moveToThread(app->thread());
+    }
+    connect(&m_sweepTimer, &QTimer::timeout, this, &ThreadPolicy::sweep);
+    connect(&m_reportTimer, &QTimer::timeout, this, &ThreadPolicy::report);
+}
+
+QString ThreadPolicy::roleName(Role role) {
+    switch (role) {
+    case Role::Ui:        return "ui";
+    case Role::Capture:   return "capture";
+    case Role::Recording: return "recording";
+    case Role::Storage:   return "storage";
+    case Role::Analysis:  return "analysis";
+    case Role::Other:     break;
+    }
+    return "other";
+}
+
+QList<int> ThreadPolicy::parseCores(const QString& spec, int coreCount) {
+    QList<int> cores;
+    for (const QString& part : spec.split(',', Qt::SkipEmptyParts)) {
+        const QStringList range = part.trimmed().split('-');
+        bool okFirst = false;
+        bool okLast = false;
+        const int first = range.value(0).toInt(&okFirst);
+        const int last = range.size() > 1 ? range.value(1).toInt(&okLast) : first;
+        if (!okFirst || (range.size() > 1 && !okLast) || range.size() > 2) {
+            qWarning() << "ThreadPolicy: Ignoring core list entry" << part;
+            continue;
+        }
+        for (int core = qMax(0, first); core <= qMin(last, coreCount - 1); ++core) {
+            if (!cores.contains(core)) {
+                cores.append(core);
+            }
+        }
+    }
+    std::sort(cores.begin(), cores.end());
+    return cores;
+}
+
+void ThreadPolicy::configure(const SchedulingConfig& config, Role callerRole) {
+    const int coreCount = qMax(1, QThread::idealThreadCount());
+    bool restore = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        restore = m_config.enabled && !config.enabled;
+        m_config = config;
+
+        const int uiCore = config.uiCore < coreCount ? config.uiCore : -1;
+        m_uiCores.clear();
+        m_otherCores.clear();
+        for (int core = 0; core < coreCount; ++core) {
+            if (core == uiCore) {
+                m_uiCores.append(core);
+            } else {
+                m_otherCores.append(core);
+            }
+        }
+        if (m_otherCores.isEmpty()) {
+            m_otherCores = m_uiCores;  // Single core: nothing to keep apart
+        }
+        m_captureCores = parseCores(config.captureCores, coreCount);
+        m_backgroundCores = parseCores(config.backgroundCores, coreCount);
+        if (m_captureCores.isEmpty()) {
+            m_captureCores = m_otherCores;
+        }
+        if (m_backgroundCores.isEmpty()) {
+            m_backgroundCores = m_otherCores;
+        }
+    }
+
+    // The caller's own thread, and the shared capture and analysis threads
+    applyToCurrentThread(callerRole);
+    CaptureWorkerPool& pool = CaptureWorkerPool::instance();
+    for (QThread* thread : pool.workerThreads()) {
+        attach(thread, Role::Capture);
+    }
+    attach(pool.analysisThreadHandle(), Role::Analysis);
+
+    {
+        QMutexLocker locker(&m_mutex);
+        if (config.enabled || restore) {
+            for (auto it = m_threads.constBegin(); it != m_threads.constEnd(); ++it) {
+                placeLocked(it.key(), it.value().role, it.value().thread);
+            }
+        }
+    }
+    if (config.enabled || restore) {
+        sweep();  // Threads we do not own: off the UI core, or back to every core
+    }
+
+    if (config.enabled) {
+        m_sweepTimer.start(SWEEP_INTERVAL_MS);
+    } else {
+        m_sweepTimer.stop();
+    }
+    if (config.reportIntervalSeconds > 0) {
+        sampleUsage();  // Baseline for the first report
+        m_reportTimer.start(config.reportIntervalSeconds * 1000);
+    } else {
+        m_reportTimer.stop();
+    }
+
+    if (config.enabled) {
+        QMutexLocker locker(&m_mutex);
+        auto list = [](const QList<int>& cores) {
+            QStringList items;
+            for (int core : cores) {
+                items.append(QString::number(core));
+            }
+            return items.join(',');
+        };
+        qDebug() << "ThreadPolicy: UI core" << (m_uiCores.isEmpty() ? QString("none") : list(m_uiCores))
+                 << "- capture" << list(m_captureCores) << "- background" << list(m_backgroundCores)
+                 << "- nice display" << config.displayNice << "background" << config.backgroundNice;
+    } else if (restore) {
+        qDebug() << "ThreadPolicy: Disabled, threads may run on every core again";
+    }
+}
+
+void ThreadPolicy::attach(QThread* thread, Role role) {
+    if (!thread) {
+        return;
+    }
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_attached.contains(thread)) {
+            return;  // configure() re-places it
+        }
+        m_attached.insert(thread);
+    }
+    connect(thread, &QObject::destroyed, this, [this, thread]() {
+        QMutexLocker locker(&m_mutex);
+        m_attached.remove(thread);
+    }, Qt::DirectConnection);
+    // Placement is per OS thread, so it is applied from inside the thread
+    connect(thread, &QThread::started, this, [this, thread, role]() {
+        applyToCurrentThread(role, thread->objectName());
+    }, Qt::DirectConnection);
+    if (thread->isRunning()) {
+        QObject* context = new QObject();
+        context->moveToThread(thread);
+        QMetaObject::invokeMethod(context, [this, thread, role, context]() {
+            applyToCurrentThread(role, thread->objectName());
+            delete context;
+        }, Qt::QueuedConnection);
+    }
+}
+
+void ThreadPolicy::applyToCurrentThread(Role role, const QString& name) {
+    QThread* thread = QThread::currentThread();
+    const QString threadName = name.isEmpty() ? thread->objectName() : name;
+#ifdef Q_OS_LINUX
+    if (!name.isEmpty()) {
+        // Kernel thread names hold 15 characters
+        pthread_setname_np(pthread_self(), name.left(15).toUtf8().constData());
+    }
+#endif
+    const qint64 tid = currentTid();
+    QMutexLocker locker(&m_mutex);
+    m_threads.insert(tid, Registered{role, threadName, thread});
+    if (m_config.enabled) {
+        placeLocked(tid, role, thread);
+    }
+}
+
+QList<int> ThreadPolicy::coresFor(Role role) const {
+    if (!m_config.enabled) {
+        return m_uiCores + m_otherCores;
+    }
+    switch (role) {
+    case Role::Ui:
+        return m_uiCores.isEmpty() ? m_otherCores : m_uiCores;
+    case Role::Capture:
+        return m_captureCores;
+    case Role::Recording:
+    case Role::Storage:
+    case Role::Analysis:
+        return m_backgroundCores;
+    case Role::Other:
+        break;
+    }
+    return m_otherCores;
+}
+
+int ThreadPolicy::niceFor(Role role) const {
+    if (!m_config.enabled) {
+        return 0;
+    }
+    switch (role) {
+    case Role::Ui:
+    case Role::Capture:
+        return m_config.displayNice;
+    case Role::Storage:
+    case Role::Analysis:
+        return m_config.backgroundNice;
+    case Role::Recording:
+    case Role::Other:
+        break;
+    }
+    return 0;
+}
+
+void ThreadPolicy::placeLocked(qint64 tid, Role role, QThread* thread) {
+#ifdef Q_OS_LINUX
+    Q_UNUSED(thread)
+    if (!setAffinity(tid, coresFor(role)) && errno != ESRCH) {
+        qWarning() << "ThreadPolicy: Cannot set the affinity of thread" << tid << "-" << strerror(errno);
+    }
+    // Nice is per thread on Linux; going below the current value needs CAP_SYS_NICE
+    if (setpriority(PRIO_PROCESS, static_cast<id_t>(tid), niceFor(role)) != 0 && !m_niceWarned
+        && (errno == EACCES || errno == EPERM)) {
+        m_niceWarned = true;
+        qWarning() << "ThreadPolicy: Not allowed to set nice" << niceFor(role) << "for" << roleName(role)
+                   << "threads (needs CAP_SYS_NICE or RLIMIT_NICE); priorities left as they are";
+    }
+#else
+    Q_UNUSED(tid)
+    // No hard affinity here; map the roles to QThread priorities
+    if (!thread || thread == QCoreApplication::instance()->thread() || !thread->isRunning()) {
+        return;
+    }
+    const int nice = niceFor(role);
+    thread->setPriority(nice < 0 ? QThread::HighPriority
+                        : nice > 0 ? QThread::LowPriority : QThread::NormalPriority);
+#endif
+}
+
+void ThreadPolicy::sweep() {
+#ifdef Q_OS_LINUX
+    const QList<qint64> tids = taskIds();
+    const QSet<qint64> alive(tids.cbegin(), tids.cend());
+    QMutexLocker locker(&m_mutex);
+    for (auto it = m_threads.begin(); it != m_threads.end();) {
+        it = alive.contains(it.key()) ? std::next(it) : m_threads.erase(it);
+    }
+    if (m_uiCores.isEmpty()) {
+        return;
+    }
+    const int uiCore = m_uiCores.first();
+    for (qint64 tid : tids) {
+        if (m_threads.contains(tid)) {
+            continue;
+        }
+        // Enabled: off the UI core. Disabled: back onto every core
+        if (m_config.enabled ? affinityContains(tid, uiCore) : !affinityContains(tid, uiCore)) {
+            setAffinity(tid, coresFor(Role::Other));
+        }
+    }
+#endif
+}
+
+QList<ThreadPolicy::ThreadUsage> ThreadPolicy::sampleUsage() {
+    QList<ThreadUsage> usage;
+#ifdef Q_OS_LINUX
+    const qint64 nowMs = sampleClock().elapsed();
+    const long ticksPerSecond = sysconf(_SC_CLK_TCK);
+    const QList<qint64> tids = taskIds();
+
+    QMutexLocker locker(&m_mutex);
+    const qint64 intervalMs = nowMs - m_lastSampleMs;
+    m_lastSampleMs = nowMs;
+    QHash<qint64, qint64> ticks;
+    for (qint64 tid : tids) {
+        const TaskStat stat = readTaskStat(tid);
+        if (stat.ticks < 0) {
+            continue;  // Exited meanwhile
+        }
+        ticks.insert(tid, stat.ticks);
+
+        ThreadUsage entry;
+        entry.tid = tid;
+        entry.name = stat.name;
+        entry.lastCore = stat.core;
+        entry.nice = stat.nice;
+        const auto registered = m_threads.constFind(tid);
+        if (registered != m_threads.constEnd()) {
+            entry.role = registered->role;
+            if (!registered->name.isEmpty()) {
+                entry.name = registered->name;
+            }
+        }
+        const auto last = m_lastCpuTicks.constFind(tid);
+        if (last != m_lastCpuTicks.constEnd() && intervalMs > 0 && ticksPerSecond > 0) {
+            entry.cpuPercent = 100.0 * (stat.ticks - *last) * 1000.0 / ticksPerSecond / intervalMs;
+        }
+        entry.onPolicy = !m_config.enabled || coresFor(entry.role).contains(stat.core);
+        usage.append(entry);
+    }
+    m_lastCpuTicks = ticks;
+    std::sort(usage.begin(), usage.end(), [](const ThreadUsage& a, const ThreadUsage& b) {
+        return a.cpuPercent > b.cpuPercent;
+    });
+#endif
+    return usage;
+}
+
+void ThreadPolicy::report() {
+    const QList<ThreadUsage> usage = sampleUsage();
+    if (usage.isEmpty()) {
+        return;
+    }
+    double total = 0.0;
+    int offPolicy = 0;
+    for (const ThreadUsage& entry : usage) {
+        total += entry.cpuPercent;
+        offPolicy += entry.onPolicy ? 0 : 1;
+    }
+    qDebug().noquote() << QString("=== Thread CPU report === %1 threads, %2% CPU, %3 off policy")
+        .arg(usage.size()).arg(total, 0, 'f', 1).arg(offPolicy);
+    for (const ThreadUsage& entry : usage) {
+        // Idle threads are left out unless they break the policy
+        if (entry.cpuPercent < 0.5 && entry.onPolicy) {
+            continue;
+        }
+        qDebug().noquote() << QString("  %1 %2 %3% core %4 nice %5%6")
+            .arg(entry.name.left(20), -20)
+            .arg(roleName(entry.role), -9)
+            .arg(entry.cpuPercent, 6, 'f', 1)
+            .arg(entry.lastCore, 2)
+            .arg(entry.nice, 3)
+            .arg(entry.onPolicy ? QString() : QString("  OFF POLICY"));
+    }
+}
+
+qint64 ThreadPolicy::currentTid() {
+#ifdef Q_OS_LINUX
+    return static_cast<qint64>(syscall(SYS_gettid));
+#else
+    return reinterpret_cast<qint64>(QThread::currentThreadId());
+#endif
+}
+
+} // namespace MCM
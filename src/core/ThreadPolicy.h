@@ -0,0 +1,137 @@
+#ifndef THREADPOLICY_H
+#define THREADPOLICY_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QPointer>
+#include <QSet>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+#include "core/Config.h"
+
+namespace MCM {
+
+/**
+ * @brief Where the application's threads run and at what priority (Singleton)
+ *
+ * Threads register once with their role: the GUI thread, capture workers
+ * and frame generators (display path), recording workers, disk I/O and
+ * analysis. With scheduling.enabled each role is pinned to its core list,
+ * and nothing but the GUI thread runs on scheduling.uiCore. The display
+ * path gets displayNice, writeback/retention and analysis backgroundNice.
+ *
+ * Threads the application does not create itself (Qt Multimedia and
+ * FFmpeg decode/encode threads, thread pools) inherit the placement of
+ * the thread that created them - often the GUI thread's core. A sweep
+ * every few seconds moves any such thread off the UI core.
+ *
+ * Every reportIntervalSeconds a per-thread CPU report is logged: CPU% over
+ * the interval, the core it last ran on and whether its placement matches
+ * the policy. Affinity, nice values and the report are Linux only; other
+ * platforms get QThread priorities.
+ *
+ * Usage:
+ *   ThreadPolicy::instance().attach(m_thread, ThreadPolicy::Role::Capture);   // before start()
+ *   ThreadPolicy::instance().applyToCurrentThread(ThreadPolicy::Role::Storage, "Storage");
+ */
+class ThreadPolicy : public QObject {
+    Q_OBJECT
+
+public:
+    enum class Role {
+        Ui,          // GUI thread: rendering and the tiles' video sinks
+        Capture,     // Capture workers, frame generators
+        Recording,   // Passthrough recorders, egress
+        Storage,     // Writeback, finalize, retention
+        Analysis,    // Motion, analytics
+        Other        // Not registered (Qt / FFmpeg internal threads, pools)
+    };
+
+    struct ThreadUsage {
+        qint64 tid{0};
+        QString name;
+        Role role{Role::Other};
+        double cpuPercent{0.0};    // Over the last report interval (100 = one core)
+        int lastCore{-1};
+        int nice{0};
+        bool onPolicy{true};       // Placement matches the policy (always true while disabled)
+    };
+
+    static ThreadPolicy& instance();
+
+    // Prevent copying
+    ThreadPolicy(const ThreadPolicy&) = delete;
+    ThreadPolicy& operator=(const ThreadPolicy&) = delete;
+
+    /**
+     * @brief Apply the policy to every registered thread
+     *
+     * Also registers the calling thread (the GUI thread, or a worker
+     * process's main thread as Role::Capture) and CaptureWorkerPool's threads.
+     */
+    void configure(const SchedulingConfig& config, Role callerRole = Role::Ui);
+
+    /**
+     * @brief Register a QThread: the policy is applied inside it when it starts (or now, if running)
+     */
+    void attach(QThread* thread, Role role);
+
+    /**
+     * @brief Register and place the calling thread (for QThread::create() bodies)
+     * @param name Thread name shown in the report and by top/perf (empty = keep)
+     */
+    void applyToCurrentThread(Role role, const QString& name = QString());
+
+    /**
+     * @brief Per-thread CPU since the previous call (Linux; empty elsewhere)
+     */
+    QList<ThreadUsage> sampleUsage();
+
+    static QString roleName(Role role);
+
+    /**
+     * @brief Parse a core list ("2-7,10"); invalid and out-of-range entries are dropped
+     */
+    static QList<int> parseCores(const QString& spec, int coreCount);
+
+private:
+    ThreadPolicy();
+    ~ThreadPolicy() override = default;
+
+    struct Registered {
+        Role role;
+        QString name;
+        QPointer<QThread> thread;
+    };
+
+    void placeLocked(qint64 tid, Role role, QThread* thread);
+    QList<int> coresFor(Role role) const;
+    int niceFor(Role role) const;
+    void sweep();
+    void report();
+
+    static qint64 currentTid();
+
+    mutable QMutex m_mutex;
+    SchedulingConfig m_config;
+    QList<int> m_uiCores;
+    QList<int> m_captureCores;
+    QList<int> m_backgroundCores;
+    QList<int> m_otherCores;                  // Every core but the UI core
+    QHash<qint64, Registered> m_threads;      // tid -> registration
+    QSet<QThread*> m_attached;                // attach()ed, placed whenever they start
+    QHash<qint64, qint64> m_lastCpuTicks;     // tid -> utime + stime at the last sample
+    qint64 m_lastSampleMs{0};
+    bool m_niceWarned{false};
+    QTimer m_sweepTimer;
+    QTimer m_reportTimer;
+
+    static constexpr int SWEEP_INTERVAL_MS = 2000;
+};
+
+} // namespace MCM
+
+#endif // THREADPOLICY_H
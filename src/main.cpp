@@ -12,6 +12,11 @@
  * - Chunk-based video recording
  * - Auto-detection of camera devices
  * - Expanded view on double-click
+ *
+ * Startup benchmark:
+ *   --autostart             Open the grid and start every configured slot
+ *   --startup-trace <file>  Write phase timings (Chrome trace JSON) once all slots are up
+ *   --exit-after-startup    Quit after writing the trace
  */
 
 #include <QApplication>
@@ -27,10 +32,27 @@ Q_IMPORT_PLUGIN(QDarwinCameraPermissionPlugin)
 #include <QMediaDevices>
 #include <QCameraDevice>
 #include <QLibraryInfo>
+#include <QTimer>
 #include <cstdlib>
 
 #include "widgets/MainWindow.h"
+#include "widgets/ShardWorker.h"
+#include "core/AnalyticsStage.h"
 #include "core/Config.h"
+#include "core/MemoryGovernor.h"
+#include "core/ConfigWatcher.h"
+#include "core/ChunkIndex.h"
+#include "core/EventTrigger.h"
+#include "core/EncoderScheduler.h"
+#include "core/DecoderScheduler.h"
+#include "core/RecordingStorage.h"
+#include "core/SnapshotService.h"
+#include "core/StreamEgress.h"
+#include "core/QtVideoRecorder.h"
+#include "core/ShardSupervisor.h"
+#include "core/StartupTrace.h"
+#include "core/Telemetry.h"
+#include "core/ThreadPolicy.h"
 
 void logMediaBackendInfo() {
     qDebug() << "========================================";
@@ -56,6 +78,13 @@ void logMediaBackendInfo() {
     qDebug() << "Platform: Windows (WMF)";
 #endif
     
+    // Enumerating devices takes a while on some backends; DeviceDetector
+    // scans right after the window is up anyway
+    if (!std::getenv("MCM_DEBUG")) {
+        qDebug() << "========================================";
+        return;
+    }
+    
     // List available cameras
     QList<QCameraDevice> cameras = QMediaDevices::videoInputs();
     qDebug() << "Available cameras:" << cameras.size();
@@ -69,7 +98,18 @@ void logMediaBackendInfo() {
     qDebug() << "========================================";
 }
 
+// Startup trace is written at the latest this long after launch
+constexpr int STARTUP_TRACE_LIMIT_MS = 60000;
+
+QString argumentValue(const QStringList& arguments, const QString& name) {
+    const int index = arguments.indexOf(name);
+    return index >= 0 && index + 1 < arguments.size() ? arguments.at(index + 1) : QString();
+}
+
 int main(int argc, char *argv[]) {
+    MCM::StartupTrace& trace = MCM::StartupTrace::instance();
+    trace.start();
+    
 #ifdef Q_OS_LINUX
     // Set FFmpeg as default backend on Linux (before QApplication)
     // FFmpeg has better threading and reports only capture devices
@@ -94,7 +134,16 @@ int main(int argc, char *argv[]) {
     QApplication::setHighDpiScaleFactorRoundingPolicy(
         Qt::HighDpiScaleFactorRoundingPolicy::PassThrough);
     
+    MCM::StartupTrace::Scope appScope("qapplication");
     QApplication app(argc, argv);
+    appScope.end();
+    
+    // Worker process of sharded mode, started by ShardSupervisor with the UI's config file
+    const QStringList arguments = QCoreApplication::arguments();
+    const QString workerShard = argumentValue(arguments, "--slot-worker");
+    
+    // Phase timings to a file; with --exit-after-startup the app quits once they are written
+    trace.setOutput(argumentValue(arguments, "--startup-trace"), arguments.contains("--exit-after-startup"));
     
     // Log backend info at startup
     logMediaBackendInfo();
@@ -105,7 +154,11 @@ int main(int argc, char *argv[]) {
     app.setFont(appFont);
     
     // Load configuration
-    QString configPath = "config.json";
+    MCM::StartupTrace::Scope configScope("config");
+    QString configPath = argumentValue(arguments, "--config");
+    if (configPath.isEmpty()) {
+        configPath = "config.json";
+    }
     if (!QFile::exists(configPath)) {
         // Try in application directory
         configPath = QApplication::applicationDirPath() + "/config.json";
@@ -115,6 +168,70 @@ int main(int argc, char *argv[]) {
     if (!config.load(configPath)) {
         qWarning() << "Using default configuration";
     }
+    configScope.end();
+    
+    // A worker runs its slots and nothing else: no windows, no UI services
+    if (!workerShard.isEmpty()) {
+        MCM::ShardWorker worker(workerShard.toInt(), argumentValue(arguments, "--ipc"));
+        if (!worker.start()) {
+            return 1;
+        }
+        return app.exec();
+    }
+    
+    // Process-wide services, in dependency order
+    MCM::StartupTrace::Scope servicesScope("services");
+    
+    // Hardware encoder sessions are shared by all recorders
+    MCM::EncoderScheduler::instance().setHardwareSessionBudget(config.recording().hardwareEncoderSessions);
+    
+    // Decode engine order, before the first player opens
+    QList<QString> decodeRequests;
+    for (int i = 0; i < config.slotCount(); ++i) {
+        const MCM::SourceType type = config.slot(i).type;
+        if (type == MCM::SourceType::Rtsp || type == MCM::SourceType::File) {
+            decodeRequests.append(config.streamProfile(i).decode);
+        }
+    }
+    MCM::DecoderScheduler::instance().configure(config.decode(), decodeRequests);
+    
+    // Writeback, back-pressure and retention for all slots' chunks
+    MCM::RecordingStorage::instance().configure(
+        config.storage(), MCM::QtVideoRecorder::resolveOutputDirectory(config.recording().outputDirectory));
+    
+    // Slots in worker processes (off unless sharding.workers > 0)
+    MCM::ShardSupervisor::instance().configure(config.sharding(), config.startup().openTimeoutMs, config.configPath());
+    
+    // Timeline index next to the chunks; triggers become event markers
+    // (sharded: in the worker that owns the slot, which gets the trigger forwarded)
+    MCM::ChunkIndexWriter::instance().setRootDirectory(
+        MCM::QtVideoRecorder::resolveOutputDirectory(config.recording().outputDirectory));
+    QObject::connect(&MCM::EventTrigger::instance(), &MCM::EventTrigger::triggered,
+                     [](int slotId, const QString& reason) {
+        if (!MCM::ShardSupervisor::instance().isActive()) {
+            MCM::ChunkIndexWriter::instance().marker(slotId, reason);
+        }
+    });
+    
+    // Cached JPEG thumbnails for dashboards
+    MCM::SnapshotService::instance().configure(config.snapshot());
+    
+    // HTTP fMP4 re-publishing of RTSP/file slots (off unless egress.enabled)
+    MCM::StreamEgress::instance().configure(config.egress());
+    
+    // Periodic per-slot pipeline metrics (JSON / Prometheus text)
+    MCM::Telemetry::instance().configure(config.telemetry());
+    
+    // Batched inference over all slots' latest frames (off unless analytics.enabled)
+    MCM::AnalyticsStage::instance().configure(config.analytics());
+    
+    // One memory budget for frame buffers, pre-roll rings and caches (shared with the workers)
+    MCM::MemoryGovernor::instance().configure(
+        MCM::MemoryGovernor::processShare(config.memory(), config.sharding().workers + 1));
+    
+    // Thread placement and priorities (off unless scheduling.enabled): the GUI
+    // thread keeps scheduling.uiCore to itself
+    MCM::ThreadPolicy::instance().configure(config.scheduling());
     
     // Ensure recordings directory exists
     QString recordingsDir = config.recording().outputDirectory;
@@ -122,10 +239,74 @@ int main(int argc, char *argv[]) {
         QDir().mkpath(recordingsDir);
         qDebug() << "Created recordings directory:" << recordingsDir;
     }
+    servicesScope.end();
     
     // Create and show main window
+    MCM::StartupTrace::Scope windowScope("mainwindow");
     MCM::MainWindow mainWindow;
-    mainWindow.show();
+    windowScope.end();
+    {
+        MCM::StartupTrace::Scope scope("show");
+        mainWindow.show();
+    }
+    QTimer::singleShot(0, &app, [&trace]() { trace.mark("eventLoop"); });
+    
+    // Startup benchmark: straight to the grid and start every configured slot;
+    // the trace is written once they all have their first frame
+    if (arguments.contains("--autostart")) {
+        mainWindow.startAllStreams();
+    }
+    if (trace.isEnabled()) {
+        QObject::connect(&app, &QCoreApplication::aboutToQuit, [&trace]() { trace.finish(); });
+        QTimer::singleShot(STARTUP_TRACE_LIMIT_MS, &app, [&trace]() { trace.finish(); });
+    }
+    
+    // Hot reload: edits to config.json are diffed and applied to what they affect
+    MCM::ConfigWatcher configWatcher;
+    QObject::connect(&configWatcher, &MCM::ConfigWatcher::configChanged,
+                     [](const MCM::ConfigDiff& diff) {
+        const MCM::Config& current = MCM::Config::instance();
+        if (diff.has(MCM::ConfigDiff::Storage) || diff.has(MCM::ConfigDiff::Recording)) {
+            MCM::RecordingStorage::instance().configure(
+                current.storage(), MCM::QtVideoRecorder::resolveOutputDirectory(current.recording().outputDirectory));
+            MCM::ChunkIndexWriter::instance().setRootDirectory(
+                MCM::QtVideoRecorder::resolveOutputDirectory(current.recording().outputDirectory));
+        }
+        if (diff.has(MCM::ConfigDiff::Snapshot)) {
+            MCM::SnapshotService::instance().configure(current.snapshot());
+        }
+        if (diff.has(MCM::ConfigDiff::Egress)) {
+            MCM::StreamEgress::instance().configure(current.egress());
+        }
+        if (diff.has(MCM::ConfigDiff::Telemetry)) {
+            MCM::Telemetry::instance().configure(current.telemetry());
+        }
+        if (diff.has(MCM::ConfigDiff::Analytics)) {
+            MCM::AnalyticsStage::instance().configure(current.analytics());
+        }
+        if (diff.has(MCM::ConfigDiff::Memory)) {
+            MCM::MemoryGovernor::instance().configure(
+                MCM::MemoryGovernor::processShare(current.memory(), current.sharding().workers + 1));
+        }
+        if (diff.has(MCM::ConfigDiff::Scheduling)) {
+            MCM::ThreadPolicy::instance().configure(current.scheduling());
+        }
+        if (diff.has(MCM::ConfigDiff::Recording)) {
+            MCM::EncoderScheduler::instance().setHardwareSessionBudget(current.recording().hardwareEncoderSessions);
+        }
+        // The backend reads the decoder device order once, when the first player opens
+        if (diff.has(MCM::ConfigDiff::Decode)) {
+            qWarning() << "Config: decode.acceleration applies after a restart";
+        }
+        if (diff.has(MCM::ConfigDiff::Sharding)) {
+            qWarning() << "Config: sharding applies after a restart";
+        }
+    });
+    QObject::connect(&configWatcher, &MCM::ConfigWatcher::configChanged,
+                     &mainWindow, &MCM::MainWindow::applyConfigChange);
+    if (!config.configPath().isEmpty()) {
+        configWatcher.watch(config.configPath());
+    }
     
     qDebug() << "Multi-Camera Monitor started";
     qDebug() << "Grid:" << config.grid().maxSlots() << "slots ("
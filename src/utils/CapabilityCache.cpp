@@ -0,0 +1,461 @@
+#include "CapabilityCache.h"
+#include <QDebug>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QCoreApplication>
+#include <QThreadPool>
+#include <QTimer>
+
+namespace MCM {
+
+namespace {
+
+constexpr int CACHE_VERSION = 1;
+constexpr int SAVE_DELAY_MS = 2000;   // Coalesces the writes of one probe burst
+
+bool sameFps(float a, float b) {
+    return qAbs(a - b) < 0.01f;
+}
+
+bool sameMode(const CameraMode& a, const CameraMode& b) {
+    return a.resolution == b.resolution
+        && a.pixelFormat == b.pixelFormat
+        && sameFps(a.minFps, b.minFps)
+        && sameFps(a.maxFps, b.maxFps);
+}
+
+bool containsMode(const QList<CameraMode>& modes, const CameraMode& mode) {
+    for (const CameraMode& m : modes) {
+        if (sameMode(m, mode)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+// CameraMode implementation
+bool CameraMode::matches(const QCameraFormat& format) const {
+    return sameMode(*this, fromFormat(format));
+}
+
+CameraMode CameraMode::fromFormat(const QCameraFormat& format) {
+    CameraMode mode;
+    mode.resolution = format.resolution();
+    mode.minFps = format.minFrameRate();
+    mode.maxFps = format.maxFrameRate();
+    mode.pixelFormat = format.pixelFormat();
+    return mode;
+}
+
+QJsonObject CameraMode::toJson() const {
+    return QJsonObject{
+        {"width", resolution.width()},
+        {"height", resolution.height()},
+        {"minFps", minFps},
+        {"maxFps", maxFps},
+        {"pixelFormat", static_cast<int>(pixelFormat)}
+    };
+}
+
+CameraMode CameraMode::fromJson(const QJsonObject& obj) {
+    CameraMode mode;
+    mode.resolution = QSize(obj.value("width").toInt(), obj.value("height").toInt());
+    mode.minFps = static_cast<float>(obj.value("minFps").toDouble());
+    mode.maxFps = static_cast<float>(obj.value("maxFps").toDouble());
+    mode.pixelFormat = static_cast<QVideoFrameFormat::PixelFormat>(
+        obj.value("pixelFormat").toInt(QVideoFrameFormat::Format_Invalid));
+    return mode;
+}
+
+// DeviceCapabilities implementation
+QJsonObject DeviceCapabilities::toJson() const {
+    QJsonArray modesArray;
+    for (const CameraMode& mode : modes) {
+        modesArray.append(mode.toJson());
+    }
+    QJsonArray failedArray;
+    for (const CameraMode& mode : failed) {
+        failedArray.append(mode.toJson());
+    }
+
+    QJsonObject obj{
+        {"key", key},
+        {"description", description},
+        {"modes", modesArray},
+        {"verified", verified},
+        {"lastSeenMs", lastSeenMs}
+    };
+    if (selected.resolution.isValid()) {
+        obj["selected"] = selected.toJson();
+    }
+    if (!failedArray.isEmpty()) {
+        obj["failed"] = failedArray;
+    }
+    return obj;
+}
+
+DeviceCapabilities DeviceCapabilities::fromJson(const QJsonObject& obj) {
+    DeviceCapabilities caps;
+    caps.key = obj.value("key").toString();
+    caps.description = obj.value("description").toString();
+    for (const QJsonValue& val : obj.value("modes").toArray()) {
+        caps.modes.append(CameraMode::fromJson(val.toObject()));
+    }
+    if (obj.contains("selected")) {
+        caps.selected = CameraMode::fromJson(obj.value("selected").toObject());
+    }
+    caps.verified = obj.value("verified").toBool(false);
+    for (const QJsonValue& val : obj.value("failed").toArray()) {
+        caps.failed.append(CameraMode::fromJson(val.toObject()));
+    }
+    caps.lastSeenMs = static_cast<qint64>(obj.value("lastSeenMs").toDouble());
+    return caps;
+}
+
+// CapabilityCache implementation
+CapabilityCache& CapabilityCache::instance() {
+    static CapabilityCache instance;
+    return instance;
+}
+
+CapabilityCache::~CapabilityCache() {
+    save();  // Changes still waiting for the debounce
+}
+
+QString CapabilityCache::busInfoForPath(const QString& devicePath) {
+#ifdef Q_OS_LINUX
+    if (!devicePath.startsWith("/dev/video")) {
+        return QString();
+    }
+    // /sys/class/video4linux/videoN/device -> the USB/PCI interface the node
+    // belongs to; same value V4L2 reports as bus_info, without opening the device
+    const QString node = devicePath.mid(5);  // "videoN"
+    const QString resolved = QFileInfo("/sys/class/video4linux/" + node + "/device").canonicalFilePath();
+    if (resolved.isEmpty()) {
+        return QString();
+    }
+    return resolved.startsWith("/sys/devices/") ? resolved.mid(13) : resolved;
+#else
+    Q_UNUSED(devicePath);
+    return QString();
+#endif
+}
+
+QString CapabilityCache::deviceKey(const QCameraDevice& device) {
+    const QString id = QString::fromUtf8(device.id());
+    const QString busInfo = busInfoForPath(id);
+    if (!busInfo.isEmpty()) {
+        // One interface can expose several nodes (capture + metadata), keep them apart
+        return QString("bus:%1/%2").arg(busInfo, QFileInfo(id).fileName());
+    }
+    return "id:" + id;
+}
+
+QString CapabilityCache::defaultPath() {
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (dir.isEmpty()) {
+        dir = QDir::currentPath();
+    }
+    return dir + "/device_capabilities.json";
+}
+
+QList<CameraMode> CapabilityCache::modesOf(const QCameraDevice& device) {
+    QList<CameraMode> modes;
+    const QList<QCameraFormat> formats = device.videoFormats();
+    modes.reserve(formats.size());
+    for (const QCameraFormat& format : formats) {
+        modes.append(CameraMode::fromFormat(format));
+    }
+    return modes;
+}
+
+bool CapabilityCache::sameModes(const QList<CameraMode>& a, const QList<CameraMode>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (int i = 0; i < a.size(); ++i) {
+        if (!sameMode(a[i], b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+QString CapabilityCache::path() const {
+    QMutexLocker locker(&m_mutex);
+    return m_path.isEmpty() ? defaultPath() : m_path;
+}
+
+bool CapabilityCache::load(const QString& path) {
+    QMutexLocker locker(&m_mutex);
+    return loadLocked(path.isEmpty() ? defaultPath() : path);
+}
+
+void CapabilityCache::ensureLoadedLocked() {
+    if (!m_loaded) {
+        loadLocked(defaultPath());
+    }
+}
+
+bool CapabilityCache::loadLocked(const QString& path) {
+    m_loaded = true;
+    m_path = path;
+    m_devices.clear();
+    m_dirty = false;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "CapabilityCache: No device cache at" << path << "- devices will be probed";
+        return false;
+    }
+
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError) {
+        qWarning() << "CapabilityCache: Ignoring corrupt cache" << path << "-" << error.errorString();
+        return false;
+    }
+
+    QJsonObject root = doc.object();
+    if (root.value("version").toInt() != CACHE_VERSION) {
+        qDebug() << "CapabilityCache: Cache version changed - devices will be probed";
+        return false;
+    }
+
+    for (const QJsonValue& val : root.value("devices").toArray()) {
+        DeviceCapabilities caps = DeviceCapabilities::fromJson(val.toObject());
+        if (!caps.key.isEmpty()) {
+            m_devices.insert(caps.key, caps);
+        }
+    }
+
+    qDebug() << "CapabilityCache: Loaded" << m_devices.size() << "devices from" << path;
+    return true;
+}
+
+bool CapabilityCache::save() {
+    // Snapshot under the lock, write outside it: lookups never wait for the disk
+    QMutexLocker writeLocker(&m_writeMutex);
+    QString path;
+    QByteArray data;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_saveScheduled = false;
+        if (!m_dirty) {
+            return true;
+        }
+        path = m_path.isEmpty() ? defaultPath() : m_path;
+
+        QJsonArray devicesArray;
+        for (const DeviceCapabilities& caps : m_devices) {
+            devicesArray.append(caps.toJson());
+        }
+        QJsonObject root{
+            {"version", CACHE_VERSION},
+            {"devices", devicesArray}
+        };
+        data = QJsonDocument(root).toJson(QJsonDocument::Indented);
+        m_dirty = false;
+    }
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    // Write-then-rename so a crash mid-write never leaves a truncated cache
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qWarning() << "CapabilityCache: Could not write" << path;
+        QMutexLocker locker(&m_mutex);
+        m_dirty = true;  // Retried with the next change or save()
+        return false;
+    }
+    return true;
+}
+
+void CapabilityCache::scheduleSaveLocked() {
+    QCoreApplication* app = QCoreApplication::instance();
+    if (m_saveScheduled || !app) {
+        return;  // Without an application the destructor writes it
+    }
+    m_saveScheduled = true;
+    // Timer on the application thread, write on the pool
+    QTimer::singleShot(SAVE_DELAY_MS, app, [] {
+        QThreadPool::globalInstance()->start([] { CapabilityCache::instance().save(); });
+    });
+}
+
+void CapabilityCache::clear() {
+    QMutexLocker locker(&m_mutex);
+    ensureLoadedLocked();
+    m_devices.clear();
+    m_dirty = true;
+    scheduleSaveLocked();
+}
+
+bool CapabilityCache::contains(const QCameraDevice& device) {
+    const QString key = deviceKey(device);
+
+    QMutexLocker locker(&m_mutex);
+    ensureLoadedLocked();
+    auto it = m_devices.constFind(key);
+    return it != m_devices.constEnd() && it->selected.resolution.isValid();
+}
+
+void CapabilityCache::recordDevice(const QCameraDevice& device) {
+    if (device.isNull()) {
+        return;
+    }
+    const QString key = deviceKey(device);
+    const QList<CameraMode> modes = modesOf(device);
+
+    QMutexLocker locker(&m_mutex);
+    ensureLoadedLocked();
+
+    auto it = m_devices.find(key);
+    if (it != m_devices.end() && it->description == device.description() && sameModes(it->modes, modes)) {
+        return;
+    }
+
+    // New device, or a different device now sits on the same port
+    DeviceCapabilities caps;
+    caps.key = key;
+    caps.description = device.description();
+    caps.modes = modes;
+    caps.lastSeenMs = QDateTime::currentMSecsSinceEpoch();
+    m_devices.insert(key, caps);
+    m_dirty = true;
+
+    qDebug() << "CapabilityCache: Recorded" << caps.description << "(" << key << ")"
+             << modes.size() << "modes";
+    scheduleSaveLocked();
+}
+
+QCameraFormat CapabilityCache::resolveFormat(const QCameraDevice& device,
+                                             QCameraFormat (*score)(const QList<QCameraFormat>&)) {
+    if (device.isNull()) {
+        return QCameraFormat();
+    }
+    const QString key = deviceKey(device);
+    const QList<QCameraFormat> formats = device.videoFormats();
+    QList<CameraMode> modes;
+    modes.reserve(formats.size());
+    for (const QCameraFormat& format : formats) {
+        modes.append(CameraMode::fromFormat(format));
+    }
+
+    QMutexLocker locker(&m_mutex);
+    ensureLoadedLocked();
+
+    auto it = m_devices.find(key);
+    const bool known = it != m_devices.end()
+        && it->description == device.description()
+        && sameModes(it->modes, modes);
+
+    if (known && it->selected.resolution.isValid()) {
+        for (int i = 0; i < modes.size(); ++i) {
+            if (sameMode(modes[i], it->selected)) {
+                return formats[i];
+            }
+        }
+    }
+
+    // Score what is left after dropping modes that already failed on this device
+    QList<CameraMode> failed = known ? it->failed : QList<CameraMode>();
+    QList<QCameraFormat> candidates;
+    for (int i = 0; i < formats.size(); ++i) {
+        if (!containsMode(failed, modes[i])) {
+            candidates.append(formats[i]);
+        }
+    }
+    if (candidates.isEmpty()) {
+        // Everything failed once - the faults may have been transient, start over
+        failed.clear();
+        candidates = formats;
+    }
+
+    QCameraFormat format = score ? score(candidates) : QCameraFormat();
+
+    DeviceCapabilities caps;
+    caps.key = key;
+    caps.description = device.description();
+    caps.modes = modes;
+    caps.failed = failed;
+    caps.lastSeenMs = QDateTime::currentMSecsSinceEpoch();
+    if (!format.isNull()) {
+        caps.selected = CameraMode::fromFormat(format);
+    }
+    m_devices.insert(key, caps);
+    m_dirty = true;
+
+    qDebug() << "CapabilityCache: Selected" << format.resolution() << "@" << format.maxFrameRate()
+             << "fps for" << caps.description << "(" << formats.size() << "modes,"
+             << failed.size() << "known bad)";
+    scheduleSaveLocked();
+    return format;
+}
+
+void CapabilityCache::markVerified(const QCameraDevice& device, const QCameraFormat& format) {
+    if (device.isNull() || format.isNull()) {
+        return;
+    }
+    const QString key = deviceKey(device);
+    const CameraMode mode = CameraMode::fromFormat(format);
+
+    QMutexLocker locker(&m_mutex);
+    ensureLoadedLocked();
+
+    auto it = m_devices.find(key);
+    if (it == m_devices.end()) {
+        return;  // Format was not picked through the cache
+    }
+    if (!sameMode(it->selected, mode) || it->verified) {
+        return;  // Format was overridden by the caller, or nothing new to write
+    }
+
+    it->verified = true;
+    it->lastSeenMs = QDateTime::currentMSecsSinceEpoch();
+    m_dirty = true;
+    scheduleSaveLocked();
+}
+
+void CapabilityCache::markFailed(const QCameraDevice& device, const QCameraFormat& format) {
+    if (device.isNull() || format.isNull()) {
+        return;
+    }
+    const QString key = deviceKey(device);
+    const CameraMode mode = CameraMode::fromFormat(format);
+
+    QMutexLocker locker(&m_mutex);
+    ensureLoadedLocked();
+
+    auto it = m_devices.find(key);
+    if (it == m_devices.end()) {
+        return;
+    }
+    if (it->verified && sameMode(it->selected, mode)) {
+        // Worked before - treat as a transient fault, not a bad format
+        return;
+    }
+
+    if (!containsMode(it->failed, mode)) {
+        it->failed.append(mode);
+    }
+    if (sameMode(it->selected, mode)) {
+        it->selected = CameraMode();
+        it->verified = false;
+    }
+    m_dirty = true;
+
+    qWarning() << "CapabilityCache:" << mode.resolution << "@" << mode.maxFps << "fps failed on"
+               << it->description << "- another format will be used next time";
+    scheduleSaveLocked();
+}
+
+} // namespace MCM
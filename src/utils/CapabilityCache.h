@@ -0,0 +1,155 @@
+#ifndef CAPABILITYCACHE_H
+#define CAPABILITYCACHE_H
+
+#include <QString>
+#include <QSize>
+#include <QList>
+#include <QHash>
+#include <QMutex>
+#include <QJsonObject>
+#include <QCameraDevice>
+#include <QCameraFormat>
+#include <QVideoFrameFormat>
+
+namespace MCM {
+
+/**
+ * @brief One capture mode of a device, as stored in the cache file
+ */
+struct CameraMode {
+    QSize resolution;
+    float minFps{0.0f};
+    float maxFps{0.0f};
+    QVideoFrameFormat::PixelFormat pixelFormat{QVideoFrameFormat::Format_Invalid};
+
+    bool matches(const QCameraFormat& format) const;
+    static CameraMode fromFormat(const QCameraFormat& format);
+
+    QJsonObject toJson() const;
+    static CameraMode fromJson(const QJsonObject& obj);
+};
+
+/**
+ * @brief Known capabilities of one physical device
+ */
+struct DeviceCapabilities {
+    QString key;                 // Stable device key (see CapabilityCache::deviceKey)
+    QString description;
+    QList<CameraMode> modes;     // Supported modes at the time of the last probe
+    CameraMode selected;         // Mode chosen for capture
+    bool verified{false};        // Selected mode delivered frames at least once
+    QList<CameraMode> failed;    // Modes that errored before the first frame
+    qint64 lastSeenMs{0};
+
+    QJsonObject toJson() const;
+    static DeviceCapabilities fromJson(const QJsonObject& obj);
+};
+
+/**
+ * @brief Persistent per-device capture format database
+ *
+ * Remembers, per physical device, the supported modes and the format that
+ * was last opened successfully. On restart or hot-replug the camera opens
+ * straight into that known-good format instead of scoring the format list
+ * again, and a format that failed before its first frame is skipped next time.
+ *
+ * Devices are keyed by bus info on Linux (stable across /dev/video*
+ * renumbering) and by the Qt device id elsewhere. The database lives in
+ * device_capabilities.json under the user cache directory.
+ *
+ * Changes are written in the background a couple of seconds after the last
+ * one, so probing several cameras costs one write and no disk I/O on the
+ * GUI thread; save() writes at once, and the destructor flushes what is left.
+ *
+ * Thread-safe: formats are resolved on the thread pool during prefetch.
+ */
+class CapabilityCache {
+public:
+    static CapabilityCache& instance();
+
+    /**
+     * @brief Stable key for a device
+     *
+     * Linux: "bus:<sysfs path of the USB/PCI interface>"; falls back to the
+     * Qt device id when no bus info is available.
+     */
+    static QString deviceKey(const QCameraDevice& device);
+
+    /**
+     * @brief Linux: bus info for a /dev/video* node (empty elsewhere)
+     */
+    static QString busInfoForPath(const QString& devicePath);
+
+    /**
+     * @brief Format to open the device with
+     *
+     * Returns the cached format when the device is known and its mode list is
+     * unchanged; otherwise scores the format list with @p score, skipping
+     * modes that failed before, and records the result.
+     */
+    QCameraFormat resolveFormat(const QCameraDevice& device,
+                                QCameraFormat (*score)(const QList<QCameraFormat>&));
+
+    /**
+     * @brief Whether a selection for the device is already cached
+     */
+    bool contains(const QCameraDevice& device);
+
+    /**
+     * @brief Record the supported modes of a device (no-op if unchanged)
+     */
+    void recordDevice(const QCameraDevice& device);
+
+    /**
+     * @brief The format delivered frames - keep it for the next open
+     */
+    void markVerified(const QCameraDevice& device, const QCameraFormat& format);
+
+    /**
+     * @brief The format errored before its first frame - pick another next time
+     */
+    void markFailed(const QCameraDevice& device, const QCameraFormat& format);
+
+    /**
+     * @brief Load the database (called lazily on first use)
+     */
+    bool load(const QString& path = QString());
+
+    /**
+     * @brief Write the database now if it changed (blocks on disk I/O)
+     */
+    bool save();
+
+    /**
+     * @brief Drop all cached devices (next open re-probes)
+     */
+    void clear();
+
+    QString path() const;
+
+private:
+    CapabilityCache() = default;
+    ~CapabilityCache();
+    CapabilityCache(const CapabilityCache&) = delete;
+    CapabilityCache& operator=(const CapabilityCache&) = delete;
+
+    static QString defaultPath();
+    static QList<CameraMode> modesOf(const QCameraDevice& device);
+    static bool sameModes(const QList<CameraMode>& a, const QList<CameraMode>& b);
+
+    void ensureLoadedLocked();
+    bool loadLocked(const QString& path);
+    void scheduleSaveLocked();
+
+    mutable QMutex m_mutex;
+    QMutex m_writeMutex;         // Serializes writers; taken before m_mutex
+    QHash<QString, DeviceCapabilities> m_devices;
+    QString m_path;
+    bool m_loaded{false};
+    bool m_dirty{false};
+    bool m_saveScheduled{false};
+};
+
+} // namespace MCM
+
+#endif // CAPABILITYCACHE_H
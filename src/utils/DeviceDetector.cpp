@@ -1,15 +1,30 @@
 #include "DeviceDetector.h"
+#include "CapabilityCache.h"
 #include <QDebug>
 #include <QMediaDevices>
+#include <QHash>
+#include <QElapsedTimer>
 
 namespace MCM {
 
+namespace {
+
+// Replug creates several nodes in quick succession; settle before rescanning
+constexpr int RESCAN_DEBOUNCE_MS = 50;
+
+} // namespace
+
 DeviceDetector::DeviceDetector(QObject* parent)
     : QObject(parent)
     , m_pollTimer(new QTimer(this))
+    , m_rescanTimer(new QTimer(this))
 {
     qRegisterMetaType<QList<MCM::DeviceInfo>>("QList<MCM::DeviceInfo>");
     connect(m_pollTimer, &QTimer::timeout, this, &DeviceDetector::pollDevices);
+    
+    m_rescanTimer->setSingleShot(true);
+    m_rescanTimer->setInterval(RESCAN_DEBOUNCE_MS);
+    connect(m_rescanTimer, &QTimer::timeout, this, &DeviceDetector::pollDevices);
 }
 
 DeviceDetector::~DeviceDetector() {
@@ -52,6 +67,15 @@ QList<DeviceInfo> DeviceDetector::detectDevices() {
         info.index = i;
         info.deviceId = QString::number(i);  // Store Qt array index
         info.available = true;
+        info.cameraId = dev.id();
+        
+        // Physical identity - survives /dev/video* renumbering on replug
+        QString qtId = QString::fromUtf8(dev.id());
+        if (qtId.startsWith("/dev/")) {
+            info.devicePath = qtId;
+            info.busInfo = CapabilityCache::busInfoForPath(qtId);
+        }
+        CapabilityCache::instance().recordDevice(dev);
         
         // Build display name
         QString baseName = dev.description();
@@ -80,7 +104,8 @@ QList<DeviceInfo> DeviceDetector::detectDevices() {
         }
         
         devices.append(info);
-        qDebug() << "  [" << info.index << "]" << info.name << "-> Qt index:" << info.deviceId;
+        qDebug() << "  [" << info.index << "]" << info.name << "-> Qt index:" << info.deviceId
+                 << (info.busInfo.isEmpty() ? QString() : "bus: " + info.busInfo);
     }
     
     qDebug() << "DeviceDetector: Total" << devices.size() << "capture devices available";
@@ -125,64 +150,126 @@ bool DeviceDetector::checkDevice(int index, QString& outName) {
 }
 
 void DeviceDetector::startMonitoring(int intervalMs) {
-    qDebug() << "DeviceDetector: Starting monitoring with" << intervalMs << "ms interval";
+    qDebug() << "DeviceDetector: Starting monitoring";
     
-    // Delay initial detection to prevent main thread blocking
-    // This allows Qt event loop to start and video surfaces to initialize
-    QTimer::singleShot(100, this, [this, intervalMs]() {
+    // First scan as soon as the event loop runs, after the window is shown
+    // (the constructor path stays free of device enumeration; no fixed wait)
+    QTimer::singleShot(0, this, [this, intervalMs]() {
         m_lastKnownDevices = detectDevices();
         emit devicesChanged(m_lastKnownDevices);
         
         qDebug() << "DeviceDetector: Initial detection complete -" 
                  << m_lastKnownDevices.size() << "capture devices";
         
-        // Start periodic polling
-        m_pollTimer->start(intervalMs);
+        m_eventDriven = setupEventSources();
+        if (m_eventDriven) {
+            qDebug() << "DeviceDetector: Hotplug events active - polling disabled";
+        } else {
+            qDebug() << "DeviceDetector: No hotplug events - polling every" << intervalMs << "ms";
+            m_pollTimer->start(intervalMs);
+        }
     });
 }
 
+bool DeviceDetector::setupEventSources() {
+    bool haveEvents = false;
+    
+    if (!m_mediaDevices) {
+        m_mediaDevices = new QMediaDevices(this);
+        connect(m_mediaDevices, &QMediaDevices::videoInputsChanged,
+                this, &DeviceDetector::scheduleRescan);
+    }
+#ifdef Q_OS_LINUX
+    // The GStreamer and FFmpeg backends both emit videoInputsChanged, but only
+    // after their own rescan; watching /dev directly catches the node itself
+    if (!m_devWatcher) {
+        m_devWatcher = new QFileSystemWatcher(this);
+        if (m_devWatcher->addPath("/dev")) {
+            connect(m_devWatcher, &QFileSystemWatcher::directoryChanged,
+                    this, &DeviceDetector::scheduleRescan);
+        } else {
+            qWarning() << "DeviceDetector: Cannot watch /dev for hotplug";
+        }
+    }
+    haveEvents = !m_devWatcher->directories().isEmpty();
+#else
+    // CoreMedia / Media Foundation notify reliably
+    haveEvents = true;
+#endif
+    return haveEvents;
+}
+
 void DeviceDetector::stopMonitoring() {
     m_pollTimer->stop();
+    m_rescanTimer->stop();
+    if (m_mediaDevices) {
+        disconnect(m_mediaDevices, nullptr, this, nullptr);
+        m_mediaDevices->deleteLater();
+        m_mediaDevices = nullptr;
+    }
+    if (m_devWatcher) {
+        m_devWatcher->deleteLater();
+        m_devWatcher = nullptr;
+    }
+    m_eventDriven = false;
+}
+
+void DeviceDetector::scheduleRescan() {
+    // Restart: the rescan runs once the burst of events has settled
+    m_rescanTimer->start();
+}
+
+QString DeviceDetector::identityKey(const DeviceInfo& info) {
+    if (!info.busInfo.isEmpty()) {
+        return "bus:" + info.busInfo + "/" + info.devicePath;
+    }
+    if (!info.cameraId.isEmpty()) {
+        return "id:" + QString::fromUtf8(info.cameraId);
+    }
+    return "index:" + info.deviceId;
 }
 
 void DeviceDetector::pollDevices() {
+    QElapsedTimer timer;
+    timer.start();
+    
     QList<DeviceInfo> currentDevices = detectDevices();
     
-    // Check for added devices
+    QHash<QString, int> knownByKey;
+    knownByKey.reserve(m_lastKnownDevices.size());
+    for (int i = 0; i < m_lastKnownDevices.size(); ++i) {
+        knownByKey.insert(identityKey(m_lastKnownDevices[i]), i);
+    }
+    
+    // Check for added devices (match by identity, not index - index may shift)
+    bool changed = currentDevices.size() != m_lastKnownDevices.size();
     for (const auto& current : currentDevices) {
-        bool found = false;
-        for (const auto& known : m_lastKnownDevices) {
-            // Match by device ID, not index (index may shift)
-            if (known.deviceId == current.deviceId) {
-                found = true;
-                break;
-            }
-        }
-        if (!found) {
+        auto it = knownByKey.find(identityKey(current));
+        if (it == knownByKey.end()) {
             qDebug() << "DeviceDetector: Device added -" << current.index << current.name;
             emit deviceAdded(current.index, current.name);
+            changed = true;
+            continue;
         }
+        const DeviceInfo& known = m_lastKnownDevices[it.value()];
+        if (known.index != current.index || known.name != current.name) {
+            changed = true;
+        }
+        knownByKey.erase(it);
     }
     
-    // Check for removed devices
-    for (const auto& known : m_lastKnownDevices) {
-        bool found = false;
-        for (const auto& current : currentDevices) {
-            if (known.deviceId == current.deviceId) {
-                found = true;
-                break;
-            }
-        }
-        if (!found) {
-            qDebug() << "DeviceDetector: Device removed -" << known.index << known.name;
-            emit deviceRemoved(known.index);
-        }
+    // Whatever was not matched is gone
+    for (auto it = knownByKey.cbegin(); it != knownByKey.cend(); ++it) {
+        const DeviceInfo& known = m_lastKnownDevices[it.value()];
+        qDebug() << "DeviceDetector: Device removed -" << known.index << known.name;
+        emit deviceRemoved(known.index);
+        changed = true;
     }
     
-    // Update if changed
-    if (currentDevices != m_lastKnownDevices) {
+    if (changed) {
         m_lastKnownDevices = currentDevices;
         emit devicesChanged(m_lastKnownDevices);
+        qDebug() << "DeviceDetector: Device list updated in" << timer.elapsed() << "ms";
     }
 }
 
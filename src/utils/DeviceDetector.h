@@ -3,6 +3,8 @@
 
 #include <QObject>
 #include <QTimer>
+#include <QFileSystemWatcher>
+#include <QMediaDevices>
 #include <QList>
 #include <QString>
 #include <QCameraDevice>
@@ -18,6 +20,7 @@ struct DeviceInfo {
     QString deviceId;    // Qt device ID (used to retrieve actual QCameraDevice)
     QString devicePath;  // Linux: actual /dev/video* path; other platforms: empty
     QString busInfo;     // Linux: USB bus info for unique identification; other platforms: empty
+    QByteArray cameraId; // QCameraDevice::id() - stable while the device stays plugged in
     bool available;      // Whether device is currently available
     
     bool operator==(const DeviceInfo& other) const {
@@ -34,7 +37,11 @@ struct DeviceInfo {
  * 
  * Uses platform-specific APIs to detect available video devices.
  * On Linux, filters out metadata nodes and only includes actual video capture devices.
- * Can poll periodically to detect changes.
+ *
+ * Monitoring is event-driven: QMediaDevices::videoInputsChanged everywhere,
+ * plus an inotify watch on /dev on Linux so a replug is seen even before the
+ * multimedia backend refreshes its list. Bursts of events are coalesced into
+ * one rescan. Periodic polling is only used when no event source is available.
  */
 class DeviceDetector : public QObject {
     Q_OBJECT
@@ -51,10 +58,16 @@ public:
 
     /**
      * @brief Start monitoring for device changes
-     * @param intervalMs Polling interval in milliseconds
+     * @param intervalMs Fallback polling interval, used only when no hotplug
+     *                   event source is available
      */
     void startMonitoring(int intervalMs = 1000);
 
+    /**
+     * @brief Whether changes are detected from hotplug events (not polling)
+     */
+    bool isEventDriven() const { return m_eventDriven; }
+
     /**
      * @brief Stop monitoring
      */
@@ -115,6 +128,7 @@ signals:
 
 private slots:
     void pollDevices();
+    void scheduleRescan();
 
 private:
     /**
@@ -122,7 +136,21 @@ private:
      */
     bool checkDevice(int index, QString& outName);
 
+    /**
+     * @brief Identity used to diff device lists (survives index shifts)
+     */
+    static QString identityKey(const DeviceInfo& info);
+
+    /**
+     * @brief Hook up hotplug notifications; false if none are available
+     */
+    bool setupEventSources();
+
     QTimer* m_pollTimer;
+    QTimer* m_rescanTimer;                       // Coalesces hotplug event bursts
+    QMediaDevices* m_mediaDevices{nullptr};
+    QFileSystemWatcher* m_devWatcher{nullptr};   // Linux: inotify on /dev
+    bool m_eventDriven{false};
     QList<DeviceInfo> m_lastKnownDevices;
     int m_maxDevicesToCheck{8};  // Check up to 8 devices (matches slot count)
 };
@@ -1,9 +1,23 @@
 #include "CameraSlot.h"
 #include "OptimizedVideoWidget.h"
+#include "GridVideoView.h"
 #include "RtspInputDialog.h"
+#include "SharedFrameWidget.h"
+#include "VideoWidget.h"
 #include "capture/QtCameraCapture.h"
 #include "capture/QtRtspCapture.h"
+#include "capture/SyntheticCapture.h"
+#include "capture/FrameTap.h"
 #include "core/QtVideoRecorder.h"
+#include "core/RtspRemuxRecorder.h"
+#include "core/StreamEgress.h"
+#include "core/AnalyticsStage.h"
+#include "core/DecoderScheduler.h"
+#include "core/EventTrigger.h"
+#include "core/MotionDetector.h"
+#include "core/Telemetry.h"
+#include "core/ShardSupervisor.h"
+#include "core/StartupTrace.h"
 #include "utils/DeviceDetector.h"
 
 #include <QCameraDevice>
@@ -13,13 +27,34 @@
 #include <QMouseEvent>
 #include <QResizeEvent>
 #include <QShowEvent>
+#include <QContextMenuEvent>
+#include <QMenu>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QStyle>
 #include <QDebug>
 #include <QElapsedTimer>
 #include <QThread>
+#include <QMetaMethod>
+#include <QPointer>
 #include <cstdlib>
 
 namespace MCM {
 
+namespace {
+
+// Outputs added with addVideoOutput() before the pipeline existed
+template <typename Capture>
+void addVideoOutputs(Capture* capture, const QList<QPointer<QObject>>& outputs) {
+    for (const QPointer<QObject>& output : outputs) {
+        if (output) {
+            capture->addVideoOutput(output);
+        }
+    }
+}
+
+} // namespace
+
 CameraSlot::CameraSlot(int slotIndex, DeviceDetector* detector, QWidget* parent)
     : QWidget(parent)
     , m_slotIndex(slotIndex)
@@ -29,9 +64,6 @@ CameraSlot::CameraSlot(int slotIndex, DeviceDetector* detector, QWidget* parent)
     setupUi();
     setupCapture();
     
-    // Start FPS tracking timer
-    m_fpsTimer.start();
-    
     // Debug timer for FPS updates
     if (m_debugMode) {
         m_debugTimer = new QTimer(this);
@@ -39,8 +71,20 @@ CameraSlot::CameraSlot(int slotIndex, DeviceDetector* detector, QWidget* parent)
         m_debugTimer->start(500);  // Update debug info 2x per second
     }
     
+    // Event-triggered recording: triggers from the UI, integrations and motion analytics
+    m_eventTimer = new QTimer(this);
+    m_eventTimer->setSingleShot(true);
+    connect(m_eventTimer, &QTimer::timeout, this, &CameraSlot::onEventEnded);
+    connect(&EventTrigger::instance(), &EventTrigger::triggered,
+            this, &CameraSlot::onEventTriggered);
+    
+    // Sharded mode: state of this slot in its worker process
+    connect(&ShardSupervisor::instance(), &ShardSupervisor::slotStateChanged,
+            this, &CameraSlot::onShardStateChanged);
+    
     // Load slot configuration
     const auto& slotConfig = Config::instance().slot(m_slotIndex);
+    m_selectedSource = slotConfig;
     updateSourceSelector();
     
     // Find and select the configured source (block signals to prevent premature stream start)
@@ -133,43 +177,174 @@ void CameraSlot::setupUi() {
 }
 
 void CameraSlot::setupCapture() {
-    // Create Qt Multimedia capture objects
+    // Capture pipelines and recorders are built on first use (ensureCapture(),
+    // qtRecorder(), rtspRecorder()): a slot only ever pays for its own source type
+    
+    // Per-slot pipeline metrics, exported by Telemetry
+    m_telemetry = Telemetry::instance().slot(m_slotIndex);
+    m_videoWidget->setTelemetry(m_telemetry);
+    
+    // Motion analysis samples whichever tap is active; scores arrive queued
+    // from the analysis thread (deleted after the captures, so after the taps)
+    m_motionDetector = new MotionDetector(m_slotIndex);
+    m_motionDetector->setTelemetry(m_telemetry);
+    updateMotionForwarding();
+    
+    // Thumbnails are encoded on the service's pool from the running stream's tap
+    SnapshotService::instance().setFrameSource(m_slotIndex, [this](quint64* serial) {
+        FrameTap* tap = m_snapshotTap.load();
+        return tap ? tap->latestFrame(serial) : QVideoFrame();
+    });
+    
+    // Analytics batches this slot's latest frame with the other slots'
+    AnalyticsStage::instance().setFrameSource(m_slotIndex, [this](quint64* serial, qint64* arrivalUs) {
+        FrameTap* tap = m_snapshotTap.load();
+        return tap ? tap->latestFrame(serial, arrivalUs) : QVideoFrame();
+    });
+}
+
+void CameraSlot::ensureCapture(SourceType type) {
     // QMediaCaptureSession is created inside these and replaces FrameBuffer
-    
-    m_cameraCapture = new QtCameraCapture(m_slotIndex, this);
-    m_rtspCapture = new QtRtspCapture(m_slotIndex, this);
-    
     // NOTE: Video output is set in startStream() AFTER device is configured
     // This follows the test_camera pattern: setCamera -> setVideoOutput -> start
+    if (type == SourceType::Rtsp || type == SourceType::File) {
+        if (m_rtspCapture) {
+            return;
+        }
+        m_rtspCapture = new QtRtspCapture(m_slotIndex, this);
+        connect(m_rtspCapture, &QtRtspCapture::connectionEstablished,
+                this, &CameraSlot::onConnectionEstablished);
+        connect(m_rtspCapture, &QtRtspCapture::connectionLost,
+                this, &CameraSlot::onConnectionLost);
+        connect(m_rtspCapture, &QtRtspCapture::firstFrameReceived,
+                this, &CameraSlot::onFirstFrame);
+        connect(m_rtspCapture, &QtRtspCapture::errorOccurred,
+                this, [this](const QString& error) {
+                    qWarning() << "CameraSlot" << m_slotIndex << "RTSP error:" << error;
+                    if (!m_connected) {
+                        emit connectionChanged(m_slotIndex, false);  // Failed to open
+                    }
+                });
+        m_rtspCapture->setTelemetry(m_telemetry);
+        addVideoOutputs(m_rtspCapture, m_videoOutputs);
+        attachTap(m_rtspCapture->frameTap());
+    } else if (type == SourceType::Synthetic) {
+        if (m_syntheticCapture) {
+            return;
+        }
+        m_syntheticCapture = new SyntheticCapture(m_slotIndex, this);
+        connect(m_syntheticCapture, &SyntheticCapture::connectionEstablished,
+                this, &CameraSlot::onConnectionEstablished);
+        connect(m_syntheticCapture, &SyntheticCapture::connectionLost,
+                this, &CameraSlot::onConnectionLost);
+        connect(m_syntheticCapture, &SyntheticCapture::firstFrameReceived,
+                this, &CameraSlot::onFirstFrame);
+        connect(m_syntheticCapture, &SyntheticCapture::errorOccurred,
+                this, [this](const QString& error) {
+                    qWarning() << "CameraSlot" << m_slotIndex << "test pattern error:" << error;
+                    if (!m_connected) {
+                        emit connectionChanged(m_slotIndex, false);  // Failed to open
+                    }
+                });
+        m_syntheticCapture->setTelemetry(m_telemetry);
+        addVideoOutputs(m_syntheticCapture, m_videoOutputs);
+        attachTap(m_syntheticCapture->frameTap());
+        attachRecorderTap(m_syntheticCapture->frameTap());
+    } else if (type != SourceType::None) {
+        if (m_cameraCapture) {
+            return;
+        }
+        m_cameraCapture = new QtCameraCapture(m_slotIndex, this);
+        connect(m_cameraCapture, &QtCameraCapture::connectionEstablished,
+                this, &CameraSlot::onConnectionEstablished);
+        connect(m_cameraCapture, &QtCameraCapture::connectionLost,
+                this, &CameraSlot::onConnectionLost);
+        connect(m_cameraCapture, &QtCameraCapture::firstFrameReceived,
+                this, &CameraSlot::onFirstFrame);
+        connect(m_cameraCapture, &QtCameraCapture::errorOccurred,
+                this, [this](const QString& error) {
+                    qWarning() << "CameraSlot" << m_slotIndex << "camera error:" << error;
+                    if (!m_connected) {
+                        emit connectionChanged(m_slotIndex, false);  // Failed to open
+                    }
+                });
+        m_cameraCapture->setTelemetry(m_telemetry);
+        addVideoOutputs(m_cameraCapture, m_videoOutputs);
+        attachTap(m_cameraCapture->frameTap());
+        attachRecorderTap(m_cameraCapture->frameTap());
+    }
+}
+
+void CameraSlot::attachTap(FrameTap* tap) {
+    MotionDetector* motion = m_motionDetector;
+    tap->addObserver([motion](const QVideoFrame& frame) {
+        motion->submit(frame);
+    });
+    // The view is deleted after the captures, so after their taps
+    if (m_softwareView) {
+        tap->addObserver([this](const QVideoFrame& frame) {
+            renderSoftwareFrame(frame);
+        });
+    }
+}
+
+void CameraSlot::renderSoftwareFrame(const QVideoFrame& frame) {
+    SlotTelemetry* telemetry = m_telemetry;
+    const int previewFps = m_softwarePreviewFps.load(std::memory_order_relaxed);
+    if (previewFps > 0) {
+        // Same schedule as OptimizedVideoWidget's preview decimation
+        const qint64 nowUs = frame.startTime() >= 0 ? frame.startTime() : Telemetry::nowUs();
+        const qint64 intervalUs = 1000000 / previewFps;
+        if (m_softwareNextUs >= 0 && (nowUs < m_softwareNextUs - 2 * intervalUs
+                                      || nowUs > m_softwareNextUs + 2 * intervalUs)) {
+            m_softwareNextUs = -1;
+        }
+        if (m_softwareNextUs >= 0 && nowUs < m_softwareNextUs - intervalUs / 4) {
+            if (telemetry) {
+                telemetry->recordDrop(SlotTelemetry::DropStage::Preview);
+            }
+            return;
+        }
+        m_softwareNextUs = (m_softwareNextUs < 0 ? nowUs : m_softwareNextUs) + intervalUs;
+    }
+    if (!m_softwareActive.load(std::memory_order_relaxed)) {
+        if (telemetry) {
+            telemetry->recordDrop(SlotTelemetry::DropStage::Hidden);
+        }
+        return;
+    }
     
-    // Connect camera capture signals
-    connect(m_cameraCapture, &QtCameraCapture::connectionEstablished,
-            this, &CameraSlot::onConnectionEstablished);
-    connect(m_cameraCapture, &QtCameraCapture::connectionLost,
-            this, &CameraSlot::onConnectionLost);
-    connect(m_cameraCapture, &QtCameraCapture::frameReady,
-            this, &CameraSlot::onFrameReady);
-    connect(m_cameraCapture, &QtCameraCapture::errorOccurred,
-            this, [this](const QString& error) {
-                qWarning() << "CameraSlot" << m_slotIndex << "camera error:" << error;
-            });
-    
-    // Connect RTSP capture signals
-    connect(m_rtspCapture, &QtRtspCapture::connectionEstablished,
-            this, &CameraSlot::onConnectionEstablished);
-    connect(m_rtspCapture, &QtRtspCapture::connectionLost,
-            this, &CameraSlot::onConnectionLost);
-    connect(m_rtspCapture, &QtRtspCapture::frameReady,
-            this, &CameraSlot::onFrameReady);
-    connect(m_rtspCapture, &QtRtspCapture::errorOccurred,
-            this, [this](const QString& error) {
-                qWarning() << "CameraSlot" << m_slotIndex << "RTSP error:" << error;
-            });
+    if (telemetry) {
+        telemetry->recordFrameMap(frame);
+    }
+    const FrameRef cpu = FramePool::instance().map(frame);
+    if (cpu) {
+        m_softwareView->displayFrame(cpu);
+        if (telemetry) {
+            telemetry->recordPresented(frame.startTime(), Telemetry::nowUs());
+        }
+    }
+}
+
+void CameraSlot::attachRecorderTap(FrameTap* tap) {
+    // Frame boundaries for chunk rotation, reported from the capture worker
+    // (the recorder is deleted after the capture, so after its tap)
+    if (!m_qtRecorder) {
+        return;
+    }
+    QtVideoRecorder* recorder = m_qtRecorder;
+    tap->addObserver([recorder](const QVideoFrame& frame) {
+        recorder->notifyFrame(frame);
+    });
+}
+
+QtVideoRecorder* CameraSlot::qtRecorder() {
+    if (m_qtRecorder) {
+        return m_qtRecorder;
+    }
     
-    // Create hardware-accelerated video recorder
+    // Hardware-accelerated video recorder, built when recording first starts
     m_qtRecorder = new QtVideoRecorder(m_slotIndex, this);
-    
-    // Connect recorder signals
     connect(m_qtRecorder, &QtVideoRecorder::chunkStarted,
             this, [this](int chunk, const QString& filename) {
                 qDebug() << "CameraSlot" << m_slotIndex << "recording chunk" << chunk << "started:" << filename;
@@ -182,9 +357,45 @@ void CameraSlot::setupCapture() {
             this, [this](const QString& error) {
                 qWarning() << "CameraSlot" << m_slotIndex << "recording error:" << error;
             });
+    m_qtRecorder->setTelemetry(m_telemetry);
+    
+    for (FrameTap* tap : {m_cameraCapture ? m_cameraCapture->frameTap() : nullptr,
+                          m_syntheticCapture ? m_syntheticCapture->frameTap() : nullptr}) {
+        if (tap) {
+            attachRecorderTap(tap);
+        }
+    }
+    return m_qtRecorder;
+}
+
+RtspRemuxRecorder* CameraSlot::rtspRecorder() {
+    if (m_rtspRecorder) {
+        return m_rtspRecorder;
+    }
+    
+    // RTSP recorder copies the camera's compressed stream into chunks
+    m_rtspRecorder = new RtspRemuxRecorder(m_slotIndex, this);
+    connect(m_rtspRecorder, &RtspRemuxRecorder::chunkStarted,
+            this, [this](int chunk, const QString& filename) {
+                qDebug() << "CameraSlot" << m_slotIndex << "RTSP recording chunk" << chunk << "started:" << filename;
+            });
+    connect(m_rtspRecorder, &RtspRemuxRecorder::chunkCompleted,
+            this, [this](int chunk, const QString& filename) {
+                qDebug() << "CameraSlot" << m_slotIndex << "RTSP recording chunk" << chunk << "completed:" << filename;
+            });
+    connect(m_rtspRecorder, &RtspRemuxRecorder::errorOccurred,
+            this, [this](const QString& error) {
+                qWarning() << "CameraSlot" << m_slotIndex << "RTSP recording error:" << error;
+            });
+    return m_rtspRecorder;
 }
 
 void CameraSlot::cleanupCapture() {
+    // Before the taps go away
+    SnapshotService::instance().removeFrameSource(m_slotIndex);
+    AnalyticsStage::instance().removeFrameSource(m_slotIndex);
+    m_snapshotTap = nullptr;
+    
     if (m_cameraCapture) {
         m_cameraCapture->stop();
         delete m_cameraCapture;
@@ -197,11 +408,29 @@ void CameraSlot::cleanupCapture() {
         m_rtspCapture = nullptr;
     }
     
+    if (m_syntheticCapture) {
+        m_syntheticCapture->stop();
+        delete m_syntheticCapture;
+        m_syntheticCapture = nullptr;
+    }
+    
     if (m_qtRecorder) {
         m_qtRecorder->stopRecording();
         delete m_qtRecorder;
         m_qtRecorder = nullptr;
     }
+    
+    if (m_rtspRecorder) {
+        m_rtspRecorder->stopRecording();
+        delete m_rtspRecorder;
+        m_rtspRecorder = nullptr;
+    }
+    
+    if (m_motionDetector) {
+        disconnect(m_motionConnection);
+        m_motionDetector->release();
+        m_motionDetector = nullptr;
+    }
 }
 
 bool CameraSlot::hasSourceSelected() const {
@@ -242,6 +471,26 @@ void CameraSlot::updateSourceSelector() {
         m_sourceSelector->addItem(displayText);
     }
     
+    // Load-testing sources: a generated pattern and a looped media file
+    const QString patternText = QString("Test Pattern (%1)").arg(SyntheticCapture::DEFAULT_SPEC);
+    m_sourceItems.append({SourceType::Synthetic, SyntheticCapture::DEFAULT_SPEC, patternText});
+    m_sourceSelector->addItem(patternText);
+    
+    const auto& slotConfig = Config::instance().slot(m_slotIndex);
+    if (slotConfig.type == SourceType::Synthetic && !slotConfig.source.isEmpty()
+        && slotConfig.source != SyntheticCapture::DEFAULT_SPEC) {
+        const QString text = QString("Test Pattern (%1)").arg(slotConfig.source);
+        m_sourceItems.append({SourceType::Synthetic, slotConfig.source, text});
+        m_sourceSelector->addItem(text);
+    }
+    if (slotConfig.type == SourceType::File && !slotConfig.source.isEmpty()) {
+        const QString text = QString("File: %1").arg(QFileInfo(slotConfig.source).fileName());
+        m_sourceItems.append({SourceType::File, slotConfig.source, text});
+        m_sourceSelector->addItem(text);
+    }
+    m_sourceItems.append({SourceType::File, "", "Media File..."});
+    m_sourceSelector->addItem("Media File...");
+    
     // RTSP option
     m_sourceItems.append({SourceType::Rtsp, "", "RTSP Stream..."});
     m_sourceSelector->addItem("RTSP Stream...");
@@ -294,12 +543,20 @@ void CameraSlot::onSourceSelectorChanged(int index) {
         return;
     }
     
+    // Handle media file selection (show file picker)
+    if (item.type == SourceType::File && item.source.isEmpty()) {
+        qDebug() << "  Media file selected, showing file dialog...";
+        showMediaFileDialog();
+        return;
+    }
+    
     // Save to config
     qDebug() << "  Saving to config...";
     SlotConfig slotConfig;
     slotConfig.type = item.type;
     slotConfig.source = item.source;
     Config::instance().setSlot(m_slotIndex, slotConfig);
+    m_selectedSource = slotConfig;
     
     // Check if we were streaming before any changes
     bool wasStreaming = m_streaming;
@@ -345,6 +602,7 @@ void CameraSlot::showRtspInputDialog() {
     const auto& slotConfig = Config::instance().slot(m_slotIndex);
     if (slotConfig.type == SourceType::Rtsp && !slotConfig.source.isEmpty()) {
         dialog.setUrl(slotConfig.source);
+        dialog.setSubStreamUrl(slotConfig.subSource);
     }
     
     if (dialog.exec() == QDialog::Accepted) {
@@ -373,11 +631,13 @@ void CameraSlot::showRtspInputDialog() {
             
             m_sourceSelector->blockSignals(false);
             
-            // Save and apply
-            SlotConfig slotConfig;
+            // Save and apply (keep per-slot settings such as encoding overrides)
+            SlotConfig slotConfig = Config::instance().slot(m_slotIndex);
             slotConfig.type = SourceType::Rtsp;
             slotConfig.source = url;
+            slotConfig.subSource = dialog.subStreamUrl();
             Config::instance().setSlot(m_slotIndex, slotConfig);
+            m_selectedSource = slotConfig;
             
             if (m_streaming) {
                 stopStream();
@@ -386,17 +646,73 @@ void CameraSlot::showRtspInputDialog() {
         }
     } else {
         // User cancelled, revert to previous selection
-        const auto& slotConfig = Config::instance().slot(m_slotIndex);
+        revertSourceSelection();
+    }
+}
+
+void CameraSlot::showMediaFileDialog() {
+    const auto& currentConfig = Config::instance().slot(m_slotIndex);
+    const QString startDir = currentConfig.type == SourceType::File
+        ? QFileInfo(currentConfig.source).absolutePath() : QString();
+    const QString path = QFileDialog::getOpenFileName(
+        this, QString("Media File for Slot %1").arg(m_slotIndex), startDir,
+        "Video files (*.mp4 *.mkv *.mov *.avi *.ts);;All files (*)");
+    if (path.isEmpty()) {
+        revertSourceSelection();
+        return;
+    }
+    
+    // Add or update the file item, just above "Media File..."
+    const QString text = QString("File: %1").arg(QFileInfo(path).fileName());
+    m_sourceSelector->blockSignals(true);
+    bool found = false;
+    for (int i = 0; i < m_sourceItems.size(); ++i) {
+        if (m_sourceItems[i].type == SourceType::File && !m_sourceItems[i].source.isEmpty()) {
+            m_sourceItems[i].source = path;
+            m_sourceSelector->setItemText(i, text);
+            m_sourceSelector->setCurrentIndex(i);
+            found = true;
+            break;
+        }
+    }
+    if (!found) {
         for (int i = 0; i < m_sourceItems.size(); ++i) {
-            if (m_sourceItems[i].type == slotConfig.type && 
-                m_sourceItems[i].source == slotConfig.source) {
-                m_sourceSelector->blockSignals(true);
+            if (m_sourceItems[i].type == SourceType::File) {
+                m_sourceItems.insert(i, {SourceType::File, path, text});
+                m_sourceSelector->insertItem(i, text);
                 m_sourceSelector->setCurrentIndex(i);
-                m_sourceSelector->blockSignals(false);
                 break;
             }
         }
     }
+    m_sourceSelector->blockSignals(false);
+    
+    // Save and apply (keep per-slot settings such as the playback rate)
+    SlotConfig slotConfig = Config::instance().slot(m_slotIndex);
+    slotConfig.type = SourceType::File;
+    slotConfig.source = path;
+    slotConfig.subSource.clear();
+    Config::instance().setSlot(m_slotIndex, slotConfig);
+    m_selectedSource = slotConfig;
+    
+    if (m_streaming) {
+        stopStream();
+    }
+    startStream();
+    emit sourceChanged(m_slotIndex, SourceType::File, path);
+}
+
+void CameraSlot::revertSourceSelection() {
+    const auto& slotConfig = Config::instance().slot(m_slotIndex);
+    for (int i = 0; i < m_sourceItems.size(); ++i) {
+        if (m_sourceItems[i].type == slotConfig.type && 
+            m_sourceItems[i].source == slotConfig.source) {
+            m_sourceSelector->blockSignals(true);
+            m_sourceSelector->setCurrentIndex(i);
+            m_sourceSelector->blockSignals(false);
+            break;
+        }
+    }
 }
 
 void CameraSlot::startStream() {
@@ -414,6 +730,7 @@ void CameraSlot::startStream() {
     
     const auto& slotConfig = Config::instance().slot(m_slotIndex);
     qDebug() << "  Config - type:" << static_cast<int>(slotConfig.type) << "source:" << slotConfig.source;
+    m_selectedSource = slotConfig;
     
     if (slotConfig.type == SourceType::None) {
         updateStatusLabel("No Signal", true);
@@ -421,14 +738,28 @@ void CameraSlot::startStream() {
         return;
     }
     
+    // Sharded mode: the worker process owning this slot runs the pipeline
+    if (ShardSupervisor::instance().isActive()) {
+        startRemoteStream(slotConfig);
+        return;
+    }
+    
     m_streaming = true;
     m_currentSourceType = slotConfig.type;
     m_currentSource = slotConfig.source;
     
-    // Reset FPS tracking
-    m_frameCount = 0;
-    m_currentFps = 0.0;
-    m_fpsTimer.restart();
+    m_awaitingFirstFrame = true;
+    
+    {
+        StartupTrace::Scope scope(QString("slot%1Pipeline").arg(m_slotIndex));
+        ensureCapture(slotConfig.type);
+    }
+    m_snapshotTap = activeTap();
+    
+    // Fresh reference frame for the new stream
+    m_motionDetector->reset();
+    m_motionDetector->setConfig(Config::instance().motion());
+    m_motionDetector->setEnabled(Config::instance().motionEnabled(m_slotIndex));
     
     // DON'T reset video item - reuse the same one like test_qt_only does
     // Resetting breaks the GStreamer pipeline on Linux USB capture cards
@@ -436,6 +767,20 @@ void CameraSlot::startStream() {
     m_videoWidget->clear();
     updateStatusLabel("Connecting...", true);
     
+    // Tiles show at most previewFps; the session output is then a decimating
+    // sink in front of the item (recording and the frame tap still get every frame)
+    // Player tiles can render hardware-decoded frames without a CPU copy; the
+    // video widget is then the output and preview decimation is skipped
+    // Software tiles keep the item as the (hidden) output and decimate themselves
+    m_videoWidget->setGpuResident(Config::instance().decode().gpuResident && usesPlayer() && !m_softwareView);
+    m_videoWidget->setPreviewFps(m_softwareView ? 0 : Config::instance().previewFps(m_slotIndex));
+    if (m_softwareView) {
+        m_softwarePreviewFps = Config::instance().previewFps(m_slotIndex);
+        m_softwareView->clear();
+        m_softwareView->show();
+    }
+    QObject* videoOutput = m_videoWidget->previewOutput();
+    
     // Get the NEW video item for pipeline
     QGraphicsVideoItem* videoItem = m_videoWidget->videoItem();
     qDebug() << "  [" << timer.elapsed() << "ms] VideoWidget videoItem:" << videoItem;
@@ -448,11 +793,35 @@ void CameraSlot::startStream() {
     if (slotConfig.type == SourceType::Rtsp) {
         // RTSP stream via QMediaPlayer
         // IMPORTANT: For QMediaPlayer, video output should be set BEFORE source
+        // The tile plays the sub-stream when there is one; recording
+        // (m_currentSource) and the expanded view use the main stream
         qDebug() << "  >>> Starting RTSP pipeline <<<";
-        m_rtspCapture->setVideoOutput(videoItem);  // Set video output FIRST
-        m_rtspCapture->setRtspUrl(slotConfig.source);  // Then set source
+        const QString tileUrl = slotConfig.subSource.isEmpty() ? slotConfig.source : slotConfig.subSource;
+        m_rtspCapture->setVideoOutput(videoOutput);  // Set video output FIRST
+        m_rtspCapture->setStreamProfile(Config::instance().streamProfile(m_slotIndex));
+        m_rtspCapture->setRtspUrl(tileUrl);  // Then set source
         m_rtspCapture->start();
-        qDebug() << "  RTSP stream started:" << slotConfig.source;
+        qDebug() << "  RTSP stream started:" << tileUrl
+                 << (slotConfig.subSource.isEmpty() ? "(main stream)" : "(sub-stream)");
+    } else if (slotConfig.type == SourceType::File) {
+        // Media file via the same QMediaPlayer pipeline, looped like a live camera
+        qDebug() << "  >>> Starting file replay pipeline <<<";
+        m_rtspCapture->setVideoOutput(videoOutput);
+        m_rtspCapture->setMediaFile(slotConfig.source, slotConfig.playbackRate);
+        m_rtspCapture->start();
+        qDebug() << "  File replay started:" << slotConfig.source << "rate:" << slotConfig.playbackRate;
+    } else if (slotConfig.type == SourceType::Synthetic) {
+        // Generated test pattern, delivered like camera frames
+        qDebug() << "  >>> Starting test pattern <<<";
+        if (!m_syntheticCapture->setSpec(slotConfig.source)) {
+            m_streaming = false;
+            updateStatusLabel("Invalid Pattern", true);
+            return;
+        }
+        m_syntheticCapture->setVideoOutput(videoOutput);
+        m_syntheticCapture->start();
+        qDebug() << "  Test pattern started:" << m_syntheticCapture->frameSize()
+                 << "@" << m_syntheticCapture->fps() << "fps";
     } else {
         // Wired camera via QCamera + QMediaCaptureSession
         int deviceIndex = slotConfig.source.toInt();
@@ -479,9 +848,12 @@ void CameraSlot::startStream() {
         // Match test_qt_only approach: setCameraDevice -> setVideoOutput -> start()
         // Keep it simple and immediate like the working test code
         qDebug() << "  [" << timer.elapsed() << "ms] Calling setCameraDevice...";
+        // Display-only slots don't need more pixels than the tile shows
+        m_cameraCapture->setMaxCaptureHeight(Config::instance().recording().enabled
+                                             ? 0 : Config::instance().previewMaxHeight(m_slotIndex));
         m_cameraCapture->setCameraDevice(cameraDevice);
         qDebug() << "  [" << timer.elapsed() << "ms] Calling setVideoOutput...";
-        m_cameraCapture->setVideoOutput(videoItem);
+        m_cameraCapture->setVideoOutput(videoOutput);
         qDebug() << "  [" << timer.elapsed() << "ms] Calling start...";
         m_cameraCapture->start();
         qDebug() << "  [" << timer.elapsed() << "ms] Camera started";
@@ -499,14 +871,26 @@ void CameraSlot::stopStream() {
         return;
     }
     
+    if (m_remote) {
+        stopRemoteStream();
+        return;
+    }
+    
     m_streaming = false;
+    m_awaitingFirstFrame = false;
+    m_recordingPending = false;
     
     // Stop the active capture based on current source type
-    if (m_currentSourceType == SourceType::Rtsp) {
+    if (usesPlayer()) {
         qDebug() << "  Stopping RTSP capture...";
         if (m_rtspCapture && m_rtspCapture->isActive()) {
             m_rtspCapture->stop();
         }
+    } else if (m_currentSourceType == SourceType::Synthetic) {
+        qDebug() << "  Stopping test pattern...";
+        if (m_syntheticCapture && m_syntheticCapture->isActive()) {
+            m_syntheticCapture->stop();
+        }
     } else if (m_currentSourceType != SourceType::None) {
         qDebug() << "  Stopping camera capture...";
         qDebug() << "  m_cameraCapture:" << m_cameraCapture << "isActive:" << (m_cameraCapture ? m_cameraCapture->isActive() : false);
@@ -515,15 +899,31 @@ void CameraSlot::stopStream() {
         }
     }
     
+    m_snapshotTap = nullptr;
+    m_motionDetector->setEnabled(false);
+    m_motionDetector->reset();
+    
     // Stop recording
+    m_eventTimer->stop();
     if (m_qtRecorder && m_qtRecorder->isRecording()) {
         qDebug() << "  Stopping recorder...";
         m_qtRecorder->stopRecording();
     }
+    if (m_rtspRecorder && m_rtspRecorder->isRecording()) {
+        qDebug() << "  Stopping RTSP recorder...";
+        m_rtspRecorder->stopRecording();
+    }
     
     // Clear display
     qDebug() << "  Clearing video widget...";
     m_videoWidget->clear();
+    if (FrameTap* tap = activeTap()) {
+        tap->reset();  // The capture may not have been active; drop its last frame anyway
+    }
+    if (m_softwareView) {
+        m_softwareView->clear();
+    }
+    m_latestCpuFrame.reset();
     m_connected = false;
     m_currentSourceType = SourceType::None;
     m_currentSource.clear();
@@ -543,6 +943,70 @@ void CameraSlot::stopStream() {
     qDebug() << "########## CameraSlot" << m_slotIndex << "stopStream() DONE ##########";
 }
 
+void CameraSlot::startRemoteStream(const SlotConfig& slotConfig) {
+    SharedFrameRing* ring = ShardSupervisor::instance().startSlot(m_slotIndex, slotConfig);
+    if (!ring) {
+        updateStatusLabel("Worker Unavailable", true);
+        return;
+    }
+    
+    m_streaming = true;
+    m_remote = true;
+    m_awaitingFirstFrame = true;
+    m_currentSourceType = slotConfig.type;
+    m_currentSource = slotConfig.source;
+    
+    if (!m_sharedView) {
+        m_sharedView = new SharedFrameWidget(m_videoWidget);
+        m_sharedView->stackUnder(m_slotNumberLabel);  // Overlays stay on top
+    }
+    m_sharedView->setRing(ring, Config::instance().previewFps(m_slotIndex));
+    m_sharedView->setActive(m_renderDemand);
+    m_sharedView->show();
+    if (m_softwareView) {
+        m_softwareView->hide();
+    }
+    m_videoWidget->clear();
+    updateStatusLabel("Connecting...", true);
+}
+
+void CameraSlot::stopRemoteStream() {
+    m_streaming = false;
+    m_remote = false;
+    m_awaitingFirstFrame = false;
+    
+    ShardSupervisor::instance().stopSlot(m_slotIndex);
+    if (m_sharedView) {
+        m_sharedView->setRing(nullptr, 0);
+        m_sharedView->hide();
+    }
+    m_currentSourceType = SourceType::None;
+    m_currentSource.clear();
+    
+    if (Config::instance().slot(m_slotIndex).type != SourceType::None) {
+        updateStatusLabel("Ready", true);
+    } else {
+        updateStatusLabel("No Signal", true);
+    }
+}
+
+void CameraSlot::onShardStateChanged(int slotId, const QString& state) {
+    if (slotId != m_slotIndex || !m_remote) {
+        return;
+    }
+    if (state == "streaming") {
+        updateStatusLabel("", false);
+        if (m_awaitingFirstFrame) {
+            m_awaitingFirstFrame = false;
+            emit firstFrameReceived(m_slotIndex);
+        }
+    } else if (state == "restarting") {
+        updateStatusLabel("Restarting...", true);
+    } else if (state == "nosignal") {
+        updateStatusLabel("No Signal", true);
+    }
+}
+
 void CameraSlot::onConnectionEstablished() {
     qDebug() << "*** CameraSlot" << m_slotIndex << "onConnectionEstablished() ***";
     qDebug() << "  VideoItem:" << m_videoWidget->videoItem();
@@ -550,25 +1014,42 @@ void CameraSlot::onConnectionEstablished() {
     
     m_connected = true;
     updateStatusLabel("", false);  // Hide status on successful connection
+    emit connectionChanged(m_slotIndex, true);
     
-    // Delay recording start to let video surface fully initialize
-    // This prevents "Failed to start video surface due to main thread blocked"
+    // Start recording once frames flow: the first frame proves the video
+    // surface is up (the old fixed 200ms delay only guessed), and waiting for
+    // it no longer holds anything up on the GUI thread
     const auto& recordingConfig = Config::instance().recording();
-    if (recordingConfig.enabled && m_currentSourceType != SourceType::Rtsp) {
-        if (m_cameraCapture && m_cameraCapture->captureSession()) {
-            // Capture config values by copy for safe use in lambda
-            QString outputDir = recordingConfig.outputDirectory;
-            int chunkDuration = recordingConfig.chunkDurationSeconds;
-            
-            qDebug() << "  Scheduling recording start (200ms delay)...";
-            QTimer::singleShot(200, this, [this, outputDir, chunkDuration]() {
-                if (m_connected && m_cameraCapture && m_cameraCapture->captureSession()) {
-                    qDebug() << "  Starting hardware-accelerated recording for slot" << m_slotIndex;
-                    m_qtRecorder->setSession(m_cameraCapture->captureSession());
-                    m_qtRecorder->startRecording(outputDir, chunkDuration);
-                }
-            });
+    if (recordingConfig.enabled && !usesPlayer() && recordingConfig.eventTriggered()) {
+        // The encoder only runs during events (see onEventTriggered)
+        qDebug() << "  Event recording: waiting for a trigger";
+    } else if (recordingConfig.enabled && !usesPlayer()) {
+        if (recordingSession()) {
+            m_recordingPending = true;
+            if (!m_awaitingFirstFrame) {
+                startCameraRecording();
+            } else {
+                qDebug() << "  Recording starts with the first frame";
+            }
+        } else {
+            qDebug() << "  Source has no capture session, not recording";
         }
+    } else if (((recordingConfig.enabled && recordingConfig.rtspPassthrough) || StreamEgress::instance().isEnabled())
+               && usesPlayer()) {
+        // RTSP: remux the camera's H.264/H.265 packets directly (no decode/encode);
+        // a media file is remuxed the same way, paced to its playback rate.
+        // The same packets feed the network egress, with or without recording
+        const bool passthroughRecording = recordingConfig.enabled && recordingConfig.rtspPassthrough;
+        qDebug() << "  Starting RTSP passthrough" << (passthroughRecording ? "recording" : "egress")
+                 << "for slot" << m_slotIndex;
+        RtspRemuxRecorder* recorder = rtspRecorder();
+        recorder->setRtspUrl(m_currentSource);
+        recorder->setFileReplay(m_currentSourceType == SourceType::File
+                                ? Config::instance().slot(m_slotIndex).playbackRate : 0.0);
+        recorder->setEventMode(recordingConfig.eventTriggered(), recordingConfig.event);
+        recorder->setEgress(StreamEgress::instance().isEnabled(), passthroughRecording);
+        recorder->startRecording(recordingConfig.outputDirectory,
+                                 recordingConfig.chunkDurationSeconds);
     }
     
     qDebug() << "  Status label hidden, connection complete";
@@ -577,36 +1058,294 @@ void CameraSlot::onConnectionEstablished() {
 void CameraSlot::onConnectionLost() {
     qDebug() << "*** CameraSlot" << m_slotIndex << "onConnectionLost() ***";
     m_connected = false;
+    m_recordingPending = false;
+    if (m_telemetry) {
+        m_telemetry->recordConnectionLost();
+    }
     
     // Clear the video display so last frame doesn't remain visible
     m_videoWidget->clear();
+    if (m_softwareView) {
+        m_softwareView->clear();
+    }
     updateStatusLabel("No Signal", true);
     
     // Stop recording
+    m_eventTimer->stop();
     if (m_qtRecorder && m_qtRecorder->isRecording()) {
         m_qtRecorder->stopRecording();
     }
+    if (m_rtspRecorder && m_rtspRecorder->isRecording()) {
+        m_rtspRecorder->stopRecording();
+    }
     
     qDebug() << "  Display cleared, showing No Signal";
+    emit connectionChanged(m_slotIndex, false);
 }
 
-void CameraSlot::onFrameReady(const QVideoFrame& frame) {
-    // Count frames for FPS calculation
-    m_frameCount++;
+void CameraSlot::onFirstFrame() {
+    if (!m_awaitingFirstFrame) {
+        return;  // Inactive pipeline or a stream that was stopped meanwhile
+    }
+    m_awaitingFirstFrame = false;
+    emit firstFrameReceived(m_slotIndex);
     
-    // Calculate FPS every second
-    qint64 elapsed = m_fpsTimer.elapsed();
-    if (elapsed >= 1000) {
-        m_currentFps = (m_frameCount * 1000.0) / elapsed;
-        m_frameCount = 0;
-        m_fpsTimer.restart();
+    if (m_recordingPending) {
+        startCameraRecording();
     }
     
-    // Emit frame for external use (e.g., expanded view, recording)
-    emit frameUpdated(frame);
+    // Per-frame work (fps, latest frame, recorder frame boundaries) runs in
+    // the capture's FrameTap on a worker thread; display is handled directly
+    // by QMediaCaptureSession -> QGraphicsVideoItem
+}
+
+void CameraSlot::startCameraRecording() {
+    m_recordingPending = false;
+    QMediaCaptureSession* session = recordingSession();
+    if (!m_connected || !session) {
+        return;
+    }
     
-    // Note: Display is handled directly by QMediaCaptureSession -> QGraphicsVideoItem
-    // No need to manually push frames to the widget (GPU pipeline)
+    const auto& recordingConfig = Config::instance().recording();
+    qDebug() << "  Starting hardware-accelerated recording for slot" << m_slotIndex;
+    QtVideoRecorder* recorder = qtRecorder();
+    recorder->setSession(session);
+    recorder->setRotationMode(QtVideoRecorder::rotationModeFromString(recordingConfig.rotationMode));
+    recorder->setEncodingProfile(Config::instance().encodingProfile(m_slotIndex));
+    recorder->startRecording(recordingConfig.outputDirectory, recordingConfig.chunkDurationSeconds);
+}
+
+void CameraSlot::onEventTriggered(int slotId, const QString& reason) {
+    if ((slotId != m_slotIndex && slotId != -1) || !m_streaming || !m_connected) {
+        return;
+    }
+    const auto& recordingConfig = Config::instance().recording();
+    if (!recordingConfig.enabled || !recordingConfig.eventTriggered()) {
+        return;
+    }
+    
+    if (usesPlayer()) {
+        // Passthrough recorder keeps the pre-roll and times the post-roll itself
+        if (m_rtspRecorder && m_rtspRecorder->isRecording()) {
+            m_rtspRecorder->trigger();
+        }
+        return;
+    }
+    
+    // Encoded packets of QMediaRecorder are not accessible, so camera slots
+    // have no pre-roll: the encoder starts now and runs for the post-roll
+    m_eventTimer->start(recordingConfig.event.postRollSeconds * 1000);
+    if ((!m_qtRecorder || !m_qtRecorder->isRecording()) && !m_recordingPending) {
+        qDebug() << "CameraSlot" << m_slotIndex << ": Event (" << reason << "), starting recording";
+        m_recordingPending = true;
+        if (!m_awaitingFirstFrame) {
+            startCameraRecording();
+        }
+    }
+}
+
+void CameraSlot::onEventEnded() {
+    if (m_qtRecorder && m_qtRecorder->isRecording()) {
+        qDebug() << "CameraSlot" << m_slotIndex << ": Event post-roll over, stopping recording";
+        m_qtRecorder->stopRecording();
+    }
+    m_recordingPending = false;
+}
+
+void CameraSlot::contextMenuEvent(QContextMenuEvent* event) {
+    const auto& recordingConfig = Config::instance().recording();
+    if (!recordingConfig.enabled || !recordingConfig.eventTriggered()) {
+        QWidget::contextMenuEvent(event);
+        return;
+    }
+    
+    QMenu menu(this);
+    QAction* triggerAction = menu.addAction("Trigger Recording");
+    triggerAction->setEnabled(m_streaming && m_connected);
+    if (menu.exec(event->globalPos()) == triggerAction) {
+        EventTrigger::instance().trigger(m_slotIndex, "manual");
+    }
+}
+
+SnapshotService::Snapshot CameraSlot::snapshot() const {
+    return SnapshotService::instance().snapshot(m_slotIndex);
+}
+
+double CameraSlot::motionScore() const {
+    return m_motionDetector && m_motionDetector->isEnabled() ? m_motionDetector->score() : 0.0;
+}
+
+FrameTap* CameraSlot::activeTap() const {
+    if (usesPlayer()) {
+        return m_rtspCapture ? m_rtspCapture->frameTap() : nullptr;
+    }
+    if (m_currentSourceType == SourceType::Synthetic) {
+        return m_syntheticCapture ? m_syntheticCapture->frameTap() : nullptr;
+    }
+    return m_cameraCapture ? m_cameraCapture->frameTap() : nullptr;
+}
+
+QMediaCaptureSession* CameraSlot::recordingSession() const {
+    if (m_currentSourceType == SourceType::Synthetic) {
+        // nullptr before Qt 6.8 (no QVideoFrameInput)
+        return m_syntheticCapture ? m_syntheticCapture->captureSession() : nullptr;
+    }
+    return m_cameraCapture ? m_cameraCapture->captureSession() : nullptr;
+}
+
+void CameraSlot::connectNotify(const QMetaMethod& signal) {
+    if (signal == QMetaMethod::fromSignal(&CameraSlot::motionScoreChanged)) {
+        updateMotionForwarding();
+    }
+}
+
+void CameraSlot::disconnectNotify(const QMetaMethod& signal) {
+    // Also called with an invalid method when everything is disconnected
+    if (!signal.isValid() || signal == QMetaMethod::fromSignal(&CameraSlot::motionScoreChanged)) {
+        updateMotionForwarding();
+    }
+}
+
+void CameraSlot::updateMotionForwarding() {
+    // Scores cross to our thread only while someone listens, at most one queued
+    const bool wanted = m_motionDetector
+        && isSignalConnected(QMetaMethod::fromSignal(&CameraSlot::motionScoreChanged));
+    if (wanted && !m_motionConnection) {
+        m_motionConnection = connect(m_motionDetector, &MotionDetector::motionScore, this,
+                                     [this](int, double score) { m_motionMailbox.post(score); },
+                                     Qt::DirectConnection);
+    } else if (!wanted && m_motionConnection) {
+        disconnect(m_motionConnection);
+        m_motionMailbox.clear();
+    }
+}
+
+bool CameraSlot::isGpuResident() const {
+    return m_videoWidget->isGpuResident();
+}
+
+bool CameraSlot::usesPlayer() const {
+    // RTSP streams and media files both play through QtRtspCapture
+    return m_currentSourceType == SourceType::Rtsp || m_currentSourceType == SourceType::File;
+}
+
+QVideoFrame CameraSlot::latestFrame() const {
+    FrameTap* tap = activeTap();
+    return tap ? tap->latestFrame() : QVideoFrame();
+}
+
+double CameraSlot::currentFps() const {
+    if (m_remote) {
+        return m_sharedView ? m_sharedView->fps() : 0.0;
+    }
+    FrameTap* tap = activeTap();
+    return tap && m_streaming ? tap->fps() : 0.0;
+}
+
+void CameraSlot::setRenderDemand(bool visible) {
+    if (m_renderDemand == visible) {
+        return;
+    }
+    m_renderDemand = visible;
+    m_softwareActive = visible;
+    m_videoWidget->setRenderingEnabled(visible && !m_softwareView);
+    if (m_sharedView) {
+        m_sharedView->setActive(visible);
+    }
+    qDebug() << "CameraSlot" << m_slotIndex << (visible ? "visible - rendering resumed"
+                                                        : "hidden - rendering suspended");
+}
+
+bool CameraSlot::isShowingSubStream() const {
+    return m_streaming && m_currentSourceType == SourceType::Rtsp && m_rtspCapture
+        && m_rtspCapture->rtspUrl() != m_currentSource;
+}
+
+void CameraSlot::addVideoOutput(QObject* output) {
+    // Every pipeline keeps the output; only the active one delivers frames
+    // (pipelines built later pick it up from m_videoOutputs)
+    if (!m_videoOutputs.contains(output)) {
+        m_videoOutputs.append(output);
+    }
+    if (m_cameraCapture) {
+        m_cameraCapture->addVideoOutput(output);
+    }
+    if (m_rtspCapture) {
+        m_rtspCapture->addVideoOutput(output);
+    }
+    if (m_syntheticCapture) {
+        m_syntheticCapture->addVideoOutput(output);
+    }
+}
+
+void CameraSlot::removeVideoOutput(QObject* output) {
+    m_videoOutputs.removeAll(output);
+    if (m_cameraCapture) {
+        m_cameraCapture->removeVideoOutput(output);
+    }
+    if (m_rtspCapture) {
+        m_rtspCapture->removeVideoOutput(output);
+    }
+    if (m_syntheticCapture) {
+        m_syntheticCapture->removeVideoOutput(output);
+    }
+}
+
+void CameraSlot::applyPreviewFps() {
+    if (m_softwareView) {
+        m_softwarePreviewFps = Config::instance().previewFps(m_slotIndex);
+        return;
+    }
+    m_videoWidget->setPreviewFps(Config::instance().previewFps(m_slotIndex));
+}
+
+void CameraSlot::useSharedRenderer(GridVideoView* grid) {
+    if (!grid || m_videoWidget->isSharedRendering()) {
+        return;
+    }
+    m_videoWidget->attachToGrid(grid);
+    
+    // Picked up by the "sharedRenderer" rules in styles.qss
+    setProperty("sharedRenderer", true);
+    m_videoWidget->setProperty("sharedRenderer", true);
+    style()->unpolish(this);
+    style()->polish(this);
+    style()->unpolish(m_videoWidget);
+    style()->polish(m_videoWidget);
+}
+
+void CameraSlot::useSoftwareRenderer() {
+    if (m_softwareView || m_videoWidget->isSharedRendering()) {
+        return;
+    }
+    // Over the (hidden) graphics view, under the overlays; grows with the tile in resizeEvent()
+    m_softwareView = new VideoWidget(m_videoWidget);
+    m_softwareView->setMinimumSize(0, 0);
+    m_softwareView->setAttribute(Qt::WA_TransparentForMouseEvents);  // Double-click and context menu reach the slot
+    m_softwareView->setGeometry(m_videoWidget->rect());
+    m_softwareView->stackUnder(m_slotNumberLabel);
+    m_videoWidget->setRenderingEnabled(false);
+}
+
+FrameRef CameraSlot::cpuFrame() const {
+    FrameTap* tap = activeTap();
+    if (!tap) {
+        return nullptr;
+    }
+    quint64 serial = 0;
+    const QVideoFrame frame = tap->latestFrame(&serial);
+    if (!frame.isValid()) {
+        m_latestCpuFrame.reset();
+        return nullptr;
+    }
+    if (!m_latestCpuFrame || serial != m_latestCpuSerial) {
+        if (m_telemetry) {
+            m_telemetry->recordFrameMap(frame);
+        }
+        m_latestCpuFrame = FramePool::instance().map(frame);
+        m_latestCpuSerial = serial;
+    }
+    return m_latestCpuFrame;
 }
 
 void CameraSlot::paintEvent(QPaintEvent* event) {
@@ -623,6 +1362,10 @@ void CameraSlot::mouseDoubleClickEvent(QMouseEvent* event) {
 void CameraSlot::resizeEvent(QResizeEvent* event) {
     QWidget::resizeEvent(event);
     
+    if (m_softwareView) {
+        m_softwareView->setGeometry(m_videoWidget->rect());
+    }
+    
     // Re-center status label
     if (m_statusLabel && m_videoWidget && m_statusLabel->isVisible()) {
         updateStatusLabel(m_statusLabel->text(), true);
@@ -679,9 +1422,27 @@ void CameraSlot::updateDebugLabel() {
     
     // Show FPS (no buffer info - Qt handles buffering internally)
     QString mode = m_connected ? "GPU" : "---";
-    m_debugLabel->setText(QString("%1 | %2 fps")
-        .arg(mode)
-        .arg(m_currentFps, 0, 'f', 1));
+    if (m_remote) {
+        mode = QString("SHARD %1").arg(ShardSupervisor::instance().shardOf(m_slotIndex));
+    }
+    if (m_connected && usesPlayer() && m_rtspCapture) {
+        // Network/file decode: show the path actually seen, so a silent software fallback stands out
+        const auto path = m_rtspCapture->decodePath();
+        if (path == DecoderScheduler::Path::Software) {
+            mode = "SW decode";
+        } else if (path != DecoderScheduler::Path::Unknown) {
+            mode = QString(DecoderScheduler::pathName(path)).toUpper();
+        }
+    }
+    QString text = QString("%1 | %2 fps").arg(mode).arg(currentFps(), 0, 'f', 1);
+    if (m_telemetry) {
+        // Bucket bound, so "<=" - good enough to spot a degrading camera
+        const qint64 p50 = m_telemetry->snapshot().displayLatency.percentileUs(0.5);
+        if (p50 >= 0) {
+            text += QString(" | <=%1 ms").arg(p50 / 1000);
+        }
+    }
+    m_debugLabel->setText(text);
     m_debugLabel->adjustSize();
     
     // Position in top-right corner
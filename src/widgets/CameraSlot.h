@@ -6,30 +6,53 @@
 #include <QComboBox>
 #include <QImage>
 #include <QTimer>
-#include <QElapsedTimer>
 #include <QVideoFrame>
+#include <QPointer>
+#include <QList>
 #include "core/Config.h"
+#include "core/FramePool.h"
+#include "core/SnapshotService.h"
+#include "core/LatestValueMailbox.h"
+#include <atomic>
+
+class QMediaCaptureSession;
 
 namespace MCM {
 
 class QtCameraCapture;
 class QtRtspCapture;
+class SyntheticCapture;
+class FrameTap;
 class QtVideoRecorder;
+class RtspRemuxRecorder;
+class MotionDetector;
 class DeviceDetector;
 class OptimizedVideoWidget;
+class GridVideoView;
+class SlotTelemetry;
+class SharedFrameWidget;
+class VideoWidget;
 
 /**
  * @brief Individual camera slot widget (Qt Multimedia version)
  * 
  * Uses GPU-accelerated Qt Multimedia pipeline:
- * - QtCameraCapture / QtRtspCapture for capture
+ * - QtCameraCapture / QtRtspCapture / SyntheticCapture for capture
  * - QMediaCaptureSession for pipeline management (replaces FrameBuffer)
  * - OptimizedVideoWidget (QGraphicsVideoItem) for GPU rendering
+ *
+ * Only the pipeline of the source type being started is built (on the
+ * first startStream() with that type), and recorders only when recording
+ * first starts, so creating a grid of slots stays cheap.
  * 
  * Benefits:
  * - 67% less CPU usage
  * - Direct GPU pipeline (no frame copying)
  * - 85ms latency (vs 780ms with OpenCV)
+ *
+ * In sharded mode (sharding.workers > 0) the pipeline runs in a worker
+ * process instead (ShardSupervisor); the tile shows the worker's frames
+ * through a SharedFrameWidget and the frame accessors below return nothing.
  */
 class CameraSlot : public QWidget {
     Q_OBJECT
@@ -45,32 +68,175 @@ public:
     bool hasSourceSelected() const;
     void refreshDeviceList();
 
+    /**
+     * @brief CPU view of the latest frame, mapped at most once per frame
+     *
+     * All CPU consumers (snapshots, analytics, software rendering) share the
+     * same pooled copy instead of each mapping the QVideoFrame themselves.
+     * @return Shared read-only frame, or nullptr if no frame is available
+     */
+    FrameRef cpuFrame() const;
+
+    /**
+     * @brief Latest frame delivered by the capture pipeline (GPU-side handle)
+     *
+     * Like cpuFrame() and snapshot(), empty while the slot runs in a worker process.
+     */
+    QVideoFrame latestFrame() const;
+
+    /**
+     * @brief Frame rate of the running stream over the last second
+     */
+    double currentFps() const;
+
+    /**
+     * @brief Cached JPEG thumbnail of the running stream (see SnapshotService)
+     *
+     * Returns at once; refreshed in the background at most every
+     * snapshot.intervalMs, however often it is called.
+     */
+    SnapshotService::Snapshot snapshot() const;
+
+    /**
+     * @brief Latest motion score in [0, 1] (0 when analysis is off)
+     */
+    double motionScore() const;
+
+    /**
+     * @brief Whether anyone is looking at this slot's tile
+     *
+     * When false the tile stops rendering frames (no texture upload or
+     * compositing). Capture, recording and extra outputs such as the
+     * expanded view keep running at the full source rate.
+     */
+    void setRenderDemand(bool visible);
+    bool renderDemand() const { return m_renderDemand; }
+
+    /**
+     * @brief Re-read the tile display rate (Config::previewFps) without restarting
+     */
+    void applyPreviewFps();
+
+    /**
+     * @brief Draw this slot's video in the grid's shared view (before startStream)
+     *
+     * The tile becomes transparent so the shared view shows through; overlays
+     * and the source selector stay on top.
+     */
+    void useSharedRenderer(GridVideoView* grid);
+
+    /**
+     * @brief Paint this slot's frames in software (grid.renderer = "software", before startStream)
+     *
+     * For GPU drivers that cannot run the graphics video item: the frame
+     * worker maps each shown frame (FramePool) and scales it into a
+     * VideoWidget; the item stays hidden and only feeds the frame tap.
+     */
+    void useSoftwareRenderer();
+    bool isSoftwareRendering() const { return m_softwareView != nullptr; }
+
+    /**
+     * @brief Source type and main-stream source of the running stream
+     */
+    SourceType currentSourceType() const { return m_currentSourceType; }
+    QString mainStreamUrl() const { return m_currentSource; }
+
+    /**
+     * @brief Slot configuration the tile was created with or last switched to
+     *
+     * Unlike currentSourceType(), kept while the tile is stopped.
+     */
+    const SlotConfig& selectedSource() const { return m_selectedSource; }
+
+    /**
+     * @brief Whether the tile shows a sub-stream (so latestFrame() is low-res)
+     */
+    bool isShowingSubStream() const;
+
+    /**
+     * @brief Whether the tile renders decoder textures directly (decode.gpuResident, player sources)
+     */
+    bool isGpuResident() const;
+
+    /**
+     * @brief Whether the stream runs in a worker process (sharded mode)
+     */
+    bool isRemote() const { return m_remote; }
+
+    /**
+     * @brief Show this slot's decode on another output too (no per-frame signals)
+     *
+     * Follows the slot across stream restarts and source switches; the
+     * output is detached automatically when it is destroyed.
+     */
+    void addVideoOutput(QObject* output);
+    void removeVideoOutput(QObject* output);
+
 signals:
     void doubleClicked(int slotIndex);
-    void frameUpdated(const QVideoFrame& frame);
     void sourceChanged(int slotIndex, SourceType type, const QString& source);
+    
+    /**
+     * @brief Emitted once per startStream(), when the first frame arrives
+     */
+    void firstFrameReceived(int slotIndex);
+    
+    /**
+     * @brief The capture connected, or lost or failed to open its source
+     */
+    void connectionChanged(int slotIndex, bool connected);
+    
+    /**
+     * @brief Motion score of an analysed frame, at motion.analysisFps
+     *
+     * Only emitted while motion analysis runs for this slot (see
+     * Config::motionEnabled()). Scores are forwarded from the analysis
+     * thread only while something is connected, latest score wins.
+     */
+    void motionScoreChanged(int slotIndex, double score);
 
 protected:
     void paintEvent(QPaintEvent* event) override;
     void mouseDoubleClickEvent(QMouseEvent* event) override;
+    void contextMenuEvent(QContextMenuEvent* event) override;
     void resizeEvent(QResizeEvent* event) override;
     void showEvent(QShowEvent* event) override;
+    void connectNotify(const QMetaMethod& signal) override;
+    void disconnectNotify(const QMetaMethod& signal) override;
 
 private slots:
     void onSourceSelectorChanged(int index);
     void onConnectionEstablished();
     void onConnectionLost();
-    void onFrameReady(const QVideoFrame& frame);
+    void onFirstFrame();
+    void onEventTriggered(int slotId, const QString& reason);
+    void onEventEnded();
+    void onShardStateChanged(int slotId, const QString& state);
     void updateDebugLabel();
 
 private:
     void setupUi();
     void setupCapture();
+    void ensureCapture(SourceType type);   // Build the pipeline for a source type once
+    void attachTap(FrameTap* tap);
+    void attachRecorderTap(FrameTap* tap);
+    void renderSoftwareFrame(const QVideoFrame& frame);   // Frame worker thread
+    QtVideoRecorder* qtRecorder();         // Created on first use
+    RtspRemuxRecorder* rtspRecorder();
     void cleanupCapture();
     void updateSourceSelector();
     void applySourceSelection(SourceType type, const QString& source);
     void showRtspInputDialog();
+    void showMediaFileDialog();
+    void revertSourceSelection();
     void updateStatusLabel(const QString& text, bool show = true);
+    void startCameraRecording();
+    void startRemoteStream(const SlotConfig& slotConfig);
+    void stopRemoteStream();
+    FrameTap* activeTap() const;
+    QMediaCaptureSession* recordingSession() const;
+    bool usesPlayer() const;
+    void updateMotionForwarding();
 
     int m_slotIndex;
     DeviceDetector* m_deviceDetector;
@@ -86,23 +252,57 @@ private:
     bool m_debugMode{false};
     QTimer* m_debugTimer{nullptr};
     
-    // FPS tracking (for debug display)
-    QElapsedTimer m_fpsTimer;
-    int m_frameCount{0};
-    double m_currentFps{0.0};
-    
     // Qt Multimedia capture (replaces OpenCV-based capture + FrameBuffer)
     QtCameraCapture* m_cameraCapture{nullptr};
-    QtRtspCapture* m_rtspCapture{nullptr};
+    QtRtspCapture* m_rtspCapture{nullptr};  // RTSP streams and media files
+    SyntheticCapture* m_syntheticCapture{nullptr};
+    
+    // Lazily mapped CPU copy of the tap's latest frame (shared by all consumers)
+    mutable FrameRef m_latestCpuFrame;
+    mutable quint64 m_latestCpuSerial{0};
+    
+    // Extra outputs (addVideoOutput), handed to pipelines built later too
+    QList<QPointer<QObject>> m_videoOutputs;
     
     // Recording (hardware-accelerated via Qt Multimedia)
     QtVideoRecorder* m_qtRecorder{nullptr};
     
+    // Recording for RTSP and file slots (packet passthrough, no re-encode)
+    RtspRemuxRecorder* m_rtspRecorder{nullptr};
+    
+    // Tap of the running stream, read by SnapshotService on its pool threads
+    std::atomic<FrameTap*> m_snapshotTap{nullptr};
+    
+    // Frame-difference motion analysis (lives on the analysis thread)
+    MotionDetector* m_motionDetector{nullptr};
+    QMetaObject::Connection m_motionConnection;   // Only while motionScoreChanged has receivers
+    LatestValueMailbox<double> m_motionMailbox{this, [this](double score) {
+        emit motionScoreChanged(m_slotIndex, score);
+    }};
+    
+    // Software rendering (useSoftwareRenderer): fed from the frame worker
+    VideoWidget* m_softwareView{nullptr};
+    std::atomic<bool> m_softwareActive{true};     // Render demand
+    std::atomic<int> m_softwarePreviewFps{0};
+    qint64 m_softwareNextUs{-1};                  // Frame worker thread
+    
+    // Sharded mode: frames of the worker process running this slot
+    SharedFrameWidget* m_sharedView{nullptr};
+    bool m_remote{false};
+    
+    // Pipeline metrics (owned by Telemetry)
+    SlotTelemetry* m_telemetry{nullptr};
+    
     // State
     bool m_streaming{false};
     bool m_connected{false};
+    bool m_awaitingFirstFrame{false};
+    bool m_recordingPending{false};  // Start recording at the first frame
+    QTimer* m_eventTimer{nullptr};   // Event recording: post-roll of camera slots
+    bool m_renderDemand{true};
     SourceType m_currentSourceType{SourceType::None};
     QString m_currentSource;
+    SlotConfig m_selectedSource;
     
     // Source selector items data
     struct SourceItem {
@@ -1,5 +1,6 @@
 #include "ExpandedView.h"
 #include "OptimizedVideoWidget.h"
+#include "capture/QtRtspCapture.h"
 #include <QVBoxLayout>
 #include <QKeyEvent>
 #include <QVideoSink>
@@ -32,6 +33,24 @@ ExpandedView::ExpandedView(int slotIndex, QWidget* parent)
     layout->addWidget(m_videoWidget);
 }
 
+ExpandedView::~ExpandedView() {
+    if (m_rtspCapture) {
+        m_rtspCapture->stop();
+    }
+}
+
+void ExpandedView::playStream(const QString& url) {
+    if (!m_rtspCapture) {
+        m_rtspCapture = new QtRtspCapture(m_slotIndex, this);
+    }
+    qDebug() << "ExpandedView: Slot" << m_slotIndex << "playing main stream" << url;
+    m_videoWidget->setGpuResident(Config::instance().decode().gpuResident);
+    m_rtspCapture->setVideoOutput(m_videoWidget->displayOutput());
+    m_rtspCapture->setStreamProfile(Config::instance().streamProfile(m_slotIndex));
+    m_rtspCapture->setRtspUrl(url);
+    m_rtspCapture->start();
+}
+
 void ExpandedView::updateFrame(const QVideoFrame& frame) {
     if (!frame.isValid()) {
         return;
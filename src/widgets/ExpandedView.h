@@ -7,6 +7,7 @@
 namespace MCM {
 
 class OptimizedVideoWidget;
+class QtRtspCapture;
 
 /**
  * @brief Expanded view window for a single camera (GPU-accelerated)
@@ -22,12 +23,24 @@ class ExpandedView : public QMainWindow {
 
 public:
     explicit ExpandedView(int slotIndex, QWidget* parent = nullptr);
+    ~ExpandedView() override;
 
     /**
      * @brief Update the displayed frame (QVideoFrame version for GPU pipeline)
+     *
+     * For sources outside a capture pipeline; slots attach the view with
+     * CameraSlot::addVideoOutput(videoWidget()->displayOutput()) instead.
      */
     void updateFrame(const QVideoFrame& frame);
 
+    /**
+     * @brief Play an RTSP stream directly instead of mirroring the slot
+     *
+     * Used when the grid tile shows a sub-stream: the expanded view opens the
+     * full-resolution main stream for as long as it is open.
+     */
+    void playStream(const QString& url);
+
     /**
      * @brief Get the slot index
      */
@@ -44,6 +57,7 @@ protected:
 private:
     int m_slotIndex;
     OptimizedVideoWidget* m_videoWidget;
+    QtRtspCapture* m_rtspCapture{nullptr};  // Main stream (only when the tile shows a sub-stream)
 };
 
 } // namespace MCM
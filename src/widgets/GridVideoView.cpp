@@ -0,0 +1,260 @@
+#include "GridVideoView.h"
+#include "core/Telemetry.h"
+#include <QEvent>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QResizeEvent>
+#include <QScreen>
+#include <QVideoSink>
+#include <QDebug>
+#include <cmath>
+
+#ifdef MCM_HAVE_OPENGLWIDGETS
+#include <QOpenGLWidget>
+#include <QSurfaceFormat>
+#endif
+
+namespace MCM {
+
+namespace {
+
+// Colors of #gridContainer/#videoDisplay and #cameraSlot in styles.qss; the
+// tile widgets are transparent in shared mode, so the view paints them
+const QColor GRID_BACKGROUND(26, 26, 46);
+const QColor SLOT_BACKGROUND(22, 33, 62);
+
+} // namespace
+
+GridVideoView::GridVideoView(QWidget* parent)
+    : QGraphicsView(parent)
+    , m_scene(new QGraphicsScene(this))
+    , m_refreshTimer(new QTimer(this))
+{
+    setScene(m_scene);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setFrameShape(QFrame::NoFrame);
+    setRenderHint(QPainter::Antialiasing, false);
+    setRenderHint(QPainter::SmoothPixmapTransform, true);
+    setOptimizationFlag(QGraphicsView::DontAdjustForAntialiasing, true);
+    setOptimizationFlag(QGraphicsView::DontSavePainterState, true);
+    setAlignment(Qt::AlignLeft | Qt::AlignTop);
+
+    // Items no longer repaint the viewport themselves - the refresh timer does,
+    // once per refresh interval, for all tiles together
+    setViewportUpdateMode(QGraphicsView::NoViewportUpdate);
+
+    // Overlays above us take the input
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setFocusPolicy(Qt::NoFocus);
+
+#ifdef MCM_HAVE_OPENGLWIDGETS
+    QOpenGLWidget* glViewport = new QOpenGLWidget();
+    QSurfaceFormat format = glViewport->format();
+    format.setSwapInterval(1);  // Present on vsync
+    glViewport->setFormat(format);
+    setViewport(glViewport);
+    m_gpuViewport = true;
+#endif
+
+    m_refreshTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_refreshTimer, &QTimer::timeout, this, &GridVideoView::onRefreshTick);
+    updateRefreshInterval();
+
+    qDebug() << "GridVideoView: Shared grid renderer created"
+             << (m_gpuViewport ? "(OpenGL viewport)" : "(raster viewport)")
+             << "refresh every" << m_refreshTimer->interval() << "ms";
+}
+
+GridVideoView::~GridVideoView() {
+    for (const Tile& tile : m_tiles) {
+        if (tile.anchor) {
+            tile.anchor->removeEventFilter(this);
+            if (tile.anchor->parentWidget()) {
+                tile.anchor->parentWidget()->removeEventFilter(this);
+            }
+        }
+    }
+}
+
+QGraphicsVideoItem* GridVideoView::createTile(QWidget* anchor) {
+    Tile tile;
+    tile.anchor = anchor;
+    tile.item = new QGraphicsVideoItem();
+    tile.item->setAspectRatioMode(Qt::KeepAspectRatio);
+    m_scene->addItem(tile.item);
+
+    // A new frame on any tile only marks the view dirty
+    connect(tile.item->videoSink(), &QVideoSink::videoFrameChanged,
+            this, &GridVideoView::markDirty);
+
+    // Tile widget moves within the slot, the slot moves within the grid
+    if (anchor) {
+        anchor->installEventFilter(this);
+        if (anchor->parentWidget()) {
+            anchor->parentWidget()->installEventFilter(this);
+        }
+    }
+
+    m_tiles.append(tile);
+    scheduleLayout();
+    return tile.item;
+}
+
+void GridVideoView::removeTile(QGraphicsVideoItem* item) {
+    for (int i = 0; i < m_tiles.size(); ++i) {
+        if (m_tiles[i].item != item) {
+            continue;
+        }
+        // Slot widget may still host another tile (item reset) - keep its filter then
+        QWidget* anchor = m_tiles[i].anchor;
+        m_tiles.removeAt(i);
+        if (anchor) {
+            bool stillUsed = false;
+            for (const Tile& other : m_tiles) {
+                stillUsed |= other.anchor == anchor;
+            }
+            if (!stillUsed) {
+                anchor->removeEventFilter(this);
+                if (anchor->parentWidget()) {
+                    anchor->parentWidget()->removeEventFilter(this);
+                }
+            }
+        }
+        m_scene->removeItem(item);
+        delete item;
+        scheduleLayout();
+        return;
+    }
+}
+
+void GridVideoView::setTileEnabled(QGraphicsVideoItem* item, bool enabled) {
+    for (Tile& tile : m_tiles) {
+        if (tile.item == item) {
+            tile.enabled = enabled;
+            scheduleLayout();
+            return;
+        }
+    }
+}
+
+void GridVideoView::setTileTelemetry(QGraphicsVideoItem* item, SlotTelemetry* telemetry) {
+    for (Tile& tile : m_tiles) {
+        if (tile.item == item) {
+            tile.telemetry = telemetry;
+            return;
+        }
+    }
+}
+
+void GridVideoView::scheduleLayout() {
+    if (m_layoutQueued) {
+        return;
+    }
+    m_layoutQueued = true;
+    QTimer::singleShot(0, this, &GridVideoView::layoutTiles);
+}
+
+QRectF GridVideoView::mapWidgetRect(const QWidget* widget) const {
+    const QPoint topLeft = viewport()->mapFromGlobal(widget->mapToGlobal(QPoint(0, 0)));
+    return QRectF(topLeft, QSizeF(widget->size()));
+}
+
+void GridVideoView::layoutTiles() {
+    m_layoutQueued = false;
+
+    for (Tile& tile : m_tiles) {
+        const bool shown = tile.anchor && tile.anchor->isVisible();
+        tile.item->setVisible(shown && tile.enabled);
+        if (!shown) {
+            tile.frameRect = QRectF();
+            tile.videoRect = QRectF();
+            continue;
+        }
+
+        tile.videoRect = mapWidgetRect(tile.anchor);
+        tile.frameRect = tile.anchor->parentWidget() ? mapWidgetRect(tile.anchor->parentWidget())
+                                                     : tile.videoRect;
+
+        // The item letterboxes within its size (KeepAspectRatio)
+        tile.item->setPos(tile.videoRect.topLeft());
+        tile.item->setSize(tile.videoRect.size());
+    }
+
+    m_scene->setSceneRect(QRectF(QPointF(0, 0), QSizeF(viewport()->size())));
+    markDirty();
+}
+
+void GridVideoView::markDirty() {
+    m_dirty = true;
+    if (!m_refreshTimer->isActive()) {
+        m_refreshTimer->start();
+    }
+}
+
+void GridVideoView::updateRefreshInterval() {
+    qreal hz = 60.0;
+    if (QScreen* s = screen()) {
+        hz = qMax<qreal>(1.0, s->refreshRate());
+    }
+    m_refreshTimer->setInterval(qMax(1, static_cast<int>(std::floor(1000.0 / hz))));
+}
+
+void GridVideoView::onRefreshTick() {
+    if (!m_dirty) {
+        // Nothing arrived during a whole interval - stop ticking until it does
+        m_refreshTimer->stop();
+        return;
+    }
+    m_dirty = false;
+    viewport()->update();
+}
+
+void GridVideoView::paintEvent(QPaintEvent* event) {
+    m_repaintCount++;
+    
+    // Every visible tile's current frame goes out with this repaint
+    const qint64 nowUs = Telemetry::nowUs();
+    for (const Tile& tile : m_tiles) {
+        if (tile.telemetry && tile.enabled && tile.item->isVisible()) {
+            tile.telemetry->recordPresented(tile.item->videoSink()->videoFrame().startTime(), nowUs);
+        }
+    }
+    QGraphicsView::paintEvent(event);
+}
+
+void GridVideoView::drawBackground(QPainter* painter, const QRectF& rect) {
+    painter->fillRect(rect, GRID_BACKGROUND);
+
+    painter->setPen(Qt::NoPen);
+    for (const Tile& tile : m_tiles) {
+        if (tile.frameRect.isEmpty() || !tile.frameRect.intersects(rect)) {
+            continue;
+        }
+        painter->setBrush(SLOT_BACKGROUND);
+        painter->drawRoundedRect(tile.frameRect, 8, 8);
+        painter->fillRect(tile.videoRect, GRID_BACKGROUND);
+    }
+}
+
+bool GridVideoView::eventFilter(QObject* watched, QEvent* event) {
+    switch (event->type()) {
+        case QEvent::Move:
+        case QEvent::Resize:
+        case QEvent::Show:
+        case QEvent::Hide:
+            scheduleLayout();
+            break;
+        default:
+            break;
+    }
+    return QGraphicsView::eventFilter(watched, event);
+}
+
+void GridVideoView::resizeEvent(QResizeEvent* event) {
+    QGraphicsView::resizeEvent(event);
+    updateRefreshInterval();
+    scheduleLayout();
+}
+
+} // namespace MCM
@@ -0,0 +1,114 @@
+#ifndef GRIDVIDEOVIEW_H
+#define GRIDVIDEOVIEW_H
+
+#include <QGraphicsView>
+#include <QGraphicsScene>
+#include <QGraphicsVideoItem>
+#include <QPointer>
+#include <QList>
+#include <QTimer>
+
+namespace MCM {
+
+class SlotTelemetry;
+
+/**
+ * @brief One scene and viewport that renders the video of every grid tile
+ *
+ * In per-slot mode each OptimizedVideoWidget owns a QGraphicsView, so a
+ * 32-tile wall has 32 viewports, 32 repaints and 32 upload paths. In shared
+ * mode the tiles hand their video item to this view instead: all items live
+ * in one scene, are positioned under their (transparent) tile widgets, and
+ * are drawn in a single pass.
+ *
+ * Repaints are paced to the screen refresh: a frame arriving on any tile only
+ * marks the view dirty, and at most one repaint (and one present) happens per
+ * refresh interval, with every tile's texture upload batched into it.
+ * When Qt OpenGLWidgets is available the viewport is a QOpenGLWidget.
+ *
+ * Per-slot overlays (labels, source selector, borders) stay ordinary widgets
+ * stacked above this view.
+ */
+class GridVideoView : public QGraphicsView {
+    Q_OBJECT
+
+public:
+    explicit GridVideoView(QWidget* parent = nullptr);
+    ~GridVideoView() override;
+
+    /**
+     * @brief Create the video item for a tile
+     * @param anchor Widget whose area the video fills (tracked on move/resize)
+     * @return Item owned by the scene; pass it to setVideoOutput()
+     */
+    QGraphicsVideoItem* createTile(QWidget* anchor);
+
+    /**
+     * @brief Remove and delete a tile's item
+     */
+    void removeTile(QGraphicsVideoItem* item);
+
+    /**
+     * @brief Show or suspend a tile's video (see OptimizedVideoWidget::setRenderingEnabled)
+     */
+    void setTileEnabled(QGraphicsVideoItem* item, bool enabled);
+
+    /**
+     * @brief Report the tile's presented frames to @p telemetry on each repaint
+     */
+    void setTileTelemetry(QGraphicsVideoItem* item, SlotTelemetry* telemetry);
+
+    int tileCount() const { return m_tiles.size(); }
+
+    /**
+     * @brief Whether the viewport is GPU (OpenGL) backed
+     */
+    bool isGpuViewport() const { return m_gpuViewport; }
+
+    /**
+     * @brief Repaints since creation (one per refresh interval at most)
+     */
+    quint64 repaintCount() const { return m_repaintCount; }
+
+public slots:
+    /**
+     * @brief Recompute tile positions (called automatically on tile move/resize)
+     */
+    void scheduleLayout();
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    void drawBackground(QPainter* painter, const QRectF& rect) override;
+    void paintEvent(QPaintEvent* event) override;
+
+private slots:
+    void layoutTiles();
+    void onRefreshTick();
+
+private:
+    struct Tile {
+        QPointer<QWidget> anchor;
+        QGraphicsVideoItem* item{nullptr};
+        bool enabled{true};
+        SlotTelemetry* telemetry{nullptr};
+        QRectF frameRect;   // Tile widget (slot) area, in view coordinates
+        QRectF videoRect;   // Video area, in view coordinates
+    };
+
+    void markDirty();
+    void updateRefreshInterval();
+    QRectF mapWidgetRect(const QWidget* widget) const;
+
+    QGraphicsScene* m_scene;
+    QList<Tile> m_tiles;
+    QTimer* m_refreshTimer;
+    bool m_dirty{false};
+    bool m_layoutQueued{false};
+    bool m_gpuViewport{false};
+    quint64 m_repaintCount{0};
+};
+
+} // namespace MCM
+
+#endif // GRIDVIDEOVIEW_H
@@ -39,12 +39,17 @@ void HomeScreen::setupUi() {
     m_streamingButton = createNavButton("▶  STREAMING");
     m_streamingButton->setObjectName("streamingButton");
     
+    // Playback button
+    m_playbackButton = createNavButton("⏪  PLAYBACK");
+    m_playbackButton->setObjectName("playbackButton");
+    
     // Settings button
     m_settingsButton = createNavButton("⚙  SETTINGS");
     m_settingsButton->setObjectName("settingsButton");
     
     buttonLayout->addStretch();
     buttonLayout->addWidget(m_streamingButton);
+    buttonLayout->addWidget(m_playbackButton);
     buttonLayout->addWidget(m_settingsButton);
     buttonLayout->addStretch();
     
@@ -59,6 +64,7 @@ void HomeScreen::setupUi() {
     
     // Connect signals
     connect(m_streamingButton, &QPushButton::clicked, this, &HomeScreen::streamingClicked);
+    connect(m_playbackButton, &QPushButton::clicked, this, &HomeScreen::playbackClicked);
     connect(m_settingsButton, &QPushButton::clicked, this, &HomeScreen::settingsClicked);
 }
 
@@ -12,6 +12,7 @@ namespace MCM {
  * 
  * Provides big rectangle buttons for:
  * - Streaming (camera monitoring)
+ * - Playback (recorded chunks, all slots in sync)
  * - Settings (configuration)
  */
 class HomeScreen : public QWidget {
@@ -22,6 +23,7 @@ public:
 
 signals:
     void streamingClicked();
+    void playbackClicked();
     void settingsClicked();
 
 private:
@@ -29,6 +31,7 @@ private:
     QPushButton* createNavButton(const QString& text, const QString& iconPath = QString());
 
     QPushButton* m_streamingButton;
+    QPushButton* m_playbackButton;
     QPushButton* m_settingsButton;
     QLabel* m_titleLabel;
 };
@@ -1,9 +1,11 @@
 #include "MainWindow.h"
 #include "HomeScreen.h"
 #include "MonitoringScreen.h"
+#include "PlaybackScreen.h"
 #include "SettingsScreen.h"
 #include "utils/DeviceDetector.h"
 #include "core/Config.h"
+#include "core/StartupTrace.h"
 
 #include <QApplication>
 #include <QCloseEvent>
@@ -18,13 +20,14 @@ MainWindow::MainWindow(QWidget* parent)
     , m_stackedWidget(new QStackedWidget(this))
     , m_homeScreen(nullptr)
     , m_monitoringScreen(nullptr)
+    , m_playbackScreen(nullptr)
     , m_settingsScreen(nullptr)
     , m_deviceDetector(new DeviceDetector(this))
 {
     setupUi();
     loadStyleSheet();
     
-    // Start device monitoring (poll every 5 seconds)
+    // Start device monitoring (hotplug events; polls every 5 seconds only as a fallback)
     m_deviceDetector->startMonitoring(5000);
 }
 
@@ -37,29 +40,54 @@ void MainWindow::setupUi() {
     setMinimumSize(1280, 720);
     resize(1600, 900);
     
-    // Create screens
-    m_homeScreen = new HomeScreen(this);
-    m_monitoringScreen = new MonitoringScreen(m_deviceDetector, this);
-    m_settingsScreen = new SettingsScreen(this);
+    // Home and grid up front; playback and settings are built when first opened
+    {
+        StartupTrace::Scope scope("homescreen");
+        m_homeScreen = new HomeScreen(this);
+    }
+    {
+        StartupTrace::Scope scope("monitoringscreen");
+        m_monitoringScreen = new MonitoringScreen(m_deviceDetector, this);
+    }
     
     // Add to stacked widget
     m_stackedWidget->addWidget(m_homeScreen);
     m_stackedWidget->addWidget(m_monitoringScreen);
-    m_stackedWidget->addWidget(m_settingsScreen);
     
     setCentralWidget(m_stackedWidget);
     
     // Connect signals
     connect(m_homeScreen, &HomeScreen::streamingClicked, this, &MainWindow::showMonitoringScreen);
+    connect(m_homeScreen, &HomeScreen::playbackClicked, this, &MainWindow::showPlaybackScreen);
     connect(m_homeScreen, &HomeScreen::settingsClicked, this, &MainWindow::showSettingsScreen);
     
     connect(m_monitoringScreen, &MonitoringScreen::backRequested, this, &MainWindow::showHomeScreen);
-    connect(m_settingsScreen, &SettingsScreen::backRequested, this, &MainWindow::showHomeScreen);
     
     // Start with home screen
     showHomeScreen();
 }
 
+PlaybackScreen* MainWindow::playbackScreen() {
+    if (!m_playbackScreen) {
+        m_playbackScreen = new PlaybackScreen(this);
+        m_stackedWidget->addWidget(m_playbackScreen);
+        connect(m_playbackScreen, &PlaybackScreen::backRequested, this, &MainWindow::showHomeScreen);
+    }
+    return m_playbackScreen;
+}
+
+SettingsScreen* MainWindow::settingsScreen() {
+    if (!m_settingsScreen) {
+        m_settingsScreen = new SettingsScreen(this);
+        m_stackedWidget->addWidget(m_settingsScreen);
+        connect(m_settingsScreen, &SettingsScreen::backRequested, this, &MainWindow::showHomeScreen);
+        
+        // Grid size changes apply at once; slots that stay keep their sessions
+        connect(m_settingsScreen, &SettingsScreen::settingsChanged, m_monitoringScreen, &MonitoringScreen::rebuildGrid);
+    }
+    return m_settingsScreen;
+}
+
 void MainWindow::loadStyleSheet() {
     QFile styleFile(":/styles/styles.qss");
     if (!styleFile.exists()) {
@@ -77,6 +105,9 @@ void MainWindow::loadStyleSheet() {
 
 void MainWindow::showHomeScreen() {
     m_monitoringScreen->stopAllStreams();
+    if (m_playbackScreen) {
+        m_playbackScreen->stop();
+    }
     m_stackedWidget->setCurrentWidget(m_homeScreen);
 }
 
@@ -86,15 +117,39 @@ void MainWindow::showMonitoringScreen() {
     // m_monitoringScreen->startAllStreams();
 }
 
+void MainWindow::startAllStreams() {
+    showMonitoringScreen();
+    m_monitoringScreen->startAllStreams();
+}
+
+void MainWindow::showPlaybackScreen() {
+    PlaybackScreen* screen = playbackScreen();
+    m_stackedWidget->setCurrentWidget(screen);
+    screen->loadRecordings();
+}
+
 void MainWindow::showSettingsScreen() {
     m_monitoringScreen->stopAllStreams();
-    m_stackedWidget->setCurrentWidget(m_settingsScreen);
-    m_settingsScreen->loadCurrentSettings();
+    SettingsScreen* screen = settingsScreen();
+    m_stackedWidget->setCurrentWidget(screen);
+    screen->loadCurrentSettings();
+}
+
+void MainWindow::applyConfigChange(const ConfigDiff& diff) {
+    m_monitoringScreen->applyConfigChange(diff);
+    
+    // Keep an open Settings screen in step with the file
+    if (m_settingsScreen && m_stackedWidget->currentWidget() == m_settingsScreen) {
+        m_settingsScreen->loadCurrentSettings();
+    }
 }
 
 void MainWindow::closeEvent(QCloseEvent* event) {
     // Stop all streams before closing
     m_monitoringScreen->stopAllStreams();
+    if (m_playbackScreen) {
+        m_playbackScreen->stop();
+    }
     
     // Save configuration
     Config::instance().save();
@@ -8,8 +8,10 @@ namespace MCM {
 
 class HomeScreen;
 class MonitoringScreen;
+class PlaybackScreen;
 class SettingsScreen;
 class DeviceDetector;
+struct ConfigDiff;
 
 /**
  * @brief Main application window
@@ -17,7 +19,10 @@ class DeviceDetector;
  * Contains a stacked widget to switch between:
  * - HomeScreen (initial screen with navigation buttons)
  * - MonitoringScreen (camera grid)
+ * - PlaybackScreen (recordings, all slots at one time)
  * - SettingsScreen (configuration)
+ *
+ * Playback and settings screens are only built when first opened.
  */
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -36,21 +41,39 @@ public:
      */
     void showMonitoringScreen();
 
+    /**
+     * @brief Show the monitoring screen and start every configured slot (--autostart)
+     */
+    void startAllStreams();
+
+    /**
+     * @brief Show the playback screen
+     */
+    void showPlaybackScreen();
+
     /**
      * @brief Show the settings screen
      */
     void showSettingsScreen();
 
+    /**
+     * @brief Apply a reloaded config.json (see ConfigWatcher)
+     */
+    void applyConfigChange(const ConfigDiff& diff);
+
 protected:
     void closeEvent(QCloseEvent* event) override;
 
 private:
     void setupUi();
     void loadStyleSheet();
+    PlaybackScreen* playbackScreen();   // Created on first use
+    SettingsScreen* settingsScreen();
 
     QStackedWidget* m_stackedWidget;
     HomeScreen* m_homeScreen;
     MonitoringScreen* m_monitoringScreen;
+    PlaybackScreen* m_playbackScreen;
     SettingsScreen* m_settingsScreen;
     DeviceDetector* m_deviceDetector;
 };
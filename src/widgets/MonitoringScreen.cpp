@@ -1,13 +1,25 @@
 #include "MonitoringScreen.h"
 #include "CameraSlot.h"
 #include "ExpandedView.h"
+#include "GridVideoView.h"
+#include "OptimizedVideoWidget.h"
 #include "utils/DeviceDetector.h"
 #include "core/Config.h"
+#include "core/MemoryGovernor.h"
+#include "core/StartupScheduler.h"
+#include "core/StartupTrace.h"
+#include "capture/QtCameraCapture.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QDebug>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QSet>
+#include <QShowEvent>
+#include <QHideEvent>
+#include <QScreen>
 
 namespace MCM {
 
@@ -16,6 +28,18 @@ MonitoringScreen::MonitoringScreen(DeviceDetector* detector, QWidget* parent)
     , m_gridLayout(nullptr)
     , m_deviceDetector(detector)
 {
+    m_startupScheduler = new StartupScheduler(this);
+    
+    // Time to first frame is the startup benchmark (see StartupTrace)
+    connect(m_startupScheduler, &StartupScheduler::slotReady, this, [](int id, qint64) {
+        StartupTrace::instance().mark("firstFrame");
+        StartupTrace::instance().mark(QString("slot%1FirstFrame").arg(id));
+    });
+    connect(m_startupScheduler, &StartupScheduler::batchFinished, this, []() {
+        StartupTrace::instance().mark("startupBatchDone");
+        StartupTrace::instance().finish();
+    });
+    
     setupUi();
     createSlots();
     
@@ -85,6 +109,8 @@ void MonitoringScreen::setupUi() {
     // Grid container
     QWidget* gridContainer = new QWidget(this);
     gridContainer->setObjectName("gridContainer");
+    gridContainer->installEventFilter(this);  // Keeps the shared grid view sized
+    m_gridContainer = gridContainer;
     m_gridLayout = new QGridLayout(gridContainer);
     m_gridLayout->setContentsMargins(5, 5, 5, 5);
     m_gridLayout->setSpacing(8);
@@ -92,33 +118,90 @@ void MonitoringScreen::setupUi() {
     mainLayout->addWidget(gridContainer, 1);
 }
 
+void MonitoringScreen::applyRendererMode() {
+    const QString renderer = Config::instance().grid().renderer;
+    if (renderer == m_renderer) {
+        return;
+    }
+    m_renderer = renderer;
+    const bool shared = renderer == "shared";
+    if (shared == (m_gridView != nullptr)) {
+        qDebug() << "MonitoringScreen: Using" << renderer << "renderers";
+        return;
+    }
+    
+    if (shared) {
+        // Behind the slot widgets, outside the layout, covering the whole grid
+        m_gridView = new GridVideoView(m_gridContainer);
+        m_gridView->setGeometry(m_gridContainer->rect());
+        m_gridView->lower();
+        m_gridView->show();
+        qDebug() << "MonitoringScreen: Using shared grid renderer";
+    } else {
+        delete m_gridView;
+        m_gridView = nullptr;
+        qDebug() << "MonitoringScreen: Using" << renderer << "renderers";
+    }
+}
+
 void MonitoringScreen::createSlots() {
     clearSlots();
+    applyRendererMode();
     
     const auto& config = Config::instance();
     int maxSlots = config.grid().maxSlots();
-    int rows = config.grid().rows;
-    int columns = config.grid().columns;
     
     for (int i = 0; i < maxSlots; ++i) {
-        CameraSlot* slot = new CameraSlot(i, m_deviceDetector, this);
-        
-        // Connect double-click signal
-        connect(slot, &CameraSlot::doubleClicked, this, &MonitoringScreen::onSlotDoubleClicked);
-        
-        // Calculate grid position
-        int row = i / columns;
-        int col = i % columns;
-        
-        m_gridLayout->addWidget(slot, row, col);
-        m_slots.append(slot);
+        m_slots.append(createSlot(i));
     }
+    layoutSlots();
     
     qDebug() << "MonitoringScreen: Created" << maxSlots << "slots in" 
-             << rows << "x" << columns << "grid";
+             << config.grid().rows << "x" << config.grid().columns << "grid";
+    
+    scheduleRenderDemandUpdate();
+}
+
+CameraSlot* MonitoringScreen::createSlot(int index) {
+    CameraSlot* slot = new CameraSlot(index, m_deviceDetector, this);
+    if (m_gridView) {
+        slot->useSharedRenderer(m_gridView);
+    } else if (m_renderer == "software") {
+        slot->useSoftwareRenderer();
+    }
+    
+    // Connect double-click signal
+    connect(slot, &CameraSlot::doubleClicked, this, &MonitoringScreen::onSlotDoubleClicked);
+    
+    // First frame frees the slot's place in the startup pipeline
+    connect(slot, &CameraSlot::firstFrameReceived,
+            m_startupScheduler, &StartupScheduler::markReady);
+    return slot;
+}
+
+void MonitoringScreen::destroySlot(CameraSlot* slot) {
+    // Frees its place if it was still opening; queued starts see the deleted guard
+    m_startupScheduler->markFailed(slot->slotIndex());
+    slot->stopStream();
+    m_gridLayout->removeWidget(slot);
+    delete slot;
+}
+
+void MonitoringScreen::layoutSlots() {
+    const int columns = qMax(1, Config::instance().grid().columns);
+    
+    // Take every tile out first: re-adding a widget the layout still holds
+    // would leave it in two cells
+    for (CameraSlot* slot : m_slots) {
+        m_gridLayout->removeWidget(slot);
+    }
+    for (int i = 0; i < m_slots.size(); ++i) {
+        m_gridLayout->addWidget(m_slots[i], i / columns, i % columns);
+    }
 }
 
 void MonitoringScreen::clearSlots() {
+    m_startupScheduler->cancel();
     for (CameraSlot* slot : m_slots) {
         slot->stopStream();
         m_gridLayout->removeWidget(slot);
@@ -128,23 +211,41 @@ void MonitoringScreen::clearSlots() {
 }
 
 void MonitoringScreen::startAllStreams() {
+    StartupTrace::instance().mark("startAllStreams");
     m_streaming = true;
+    scheduleStart(m_slots);
+}
+
+void MonitoringScreen::scheduleStart(const QVector<CameraSlot*>& slots) {
+    const auto& startup = Config::instance().startup();
+    m_startupScheduler->setMaxConcurrent(startup.maxConcurrentOpens);
+    m_startupScheduler->setOpenTimeoutMs(startup.openTimeoutMs);
     
-    // Stagger camera starts to prevent overwhelming USB/system resources
-    // Each camera gets 500ms to initialize before the next one starts
-    // This prevents "Failed to start video surface due to main thread blocked"
-    for (int i = 0; i < m_slots.size(); ++i) {
-        CameraSlot* slot = m_slots[i];
-        QTimer::singleShot(i * 500, slot, [slot]() {
-            slot->startStream();
+    // Score capture formats for every device on the thread pool while the
+    // first slots are opening, so later setupCamera() calls skip enumeration
+    QtCameraCapture::prefetchFormats(QtCameraCapture::availableDevices());
+    
+    // Instead of a fixed 500ms stagger, keep a bounded number of opens in
+    // flight and start the next slot as soon as one delivers its first frame.
+    // The bound still prevents overwhelming USB/system resources.
+    for (CameraSlot* slot : slots) {
+        QPointer<CameraSlot> guard(slot);
+        m_startupScheduler->enqueue(slot->slotIndex(), [guard]() {
+            if (!guard) {
+                return false;
+            }
+            guard->startStream();
+            return guard->isStreaming();
         });
     }
     
-    qDebug() << "MonitoringScreen: Scheduled staggered start for" << m_slots.size() << "streams (500ms intervals)";
+    qDebug() << "MonitoringScreen: Scheduled start for" << slots.size() << "streams"
+             << "(max" << startup.maxConcurrentOpens << "concurrent opens)";
 }
 
 void MonitoringScreen::stopAllStreams() {
     m_streaming = false;
+    m_startupScheduler->cancel();
     for (CameraSlot* slot : m_slots) {
         slot->stopStream();
     }
@@ -152,17 +253,105 @@ void MonitoringScreen::stopAllStreams() {
 }
 
 void MonitoringScreen::rebuildGrid() {
-    bool wasStreaming = m_streaming;
+    const auto& config = Config::instance();
     
-    if (wasStreaming) {
-        stopAllStreams();
+    // Tiles are bound to one renderer for their lifetime (useSharedRenderer /
+    // useSoftwareRenderer before start), so a renderer switch still recreates every slot
+    if (config.grid().renderer != m_renderer) {
+        bool wasStreaming = m_streaming;
+        
+        if (wasStreaming) {
+            stopAllStreams();
+        }
+        
+        createSlots();
+        
+        if (wasStreaming) {
+            startAllStreams();
+        }
+        return;
     }
     
-    createSlots();
+    QElapsedTimer timer;
+    timer.start();
+    
+    const int maxSlots = config.grid().maxSlots();
+    int removed = 0;
+    int replaced = 0;
+    int added = 0;
+    QVector<CameraSlot*> toStart;
+    
+    // Slots past the new grid go away with their sessions and recorders
+    while (m_slots.size() > maxSlots) {
+        destroySlot(m_slots.takeLast());
+        removed++;
+    }
+    
+    // Slots keep their index, so a slot whose selected source still matches
+    // the config keeps its capture session, recorder and decoder, running or
+    // stopped; only a slot whose source changed behind its back is recreated
+    for (int i = 0; i < m_slots.size(); ++i) {
+        CameraSlot* slot = m_slots[i];
+        const SlotConfig& slotConfig = config.slot(i);
+        const SlotConfig& selected = slot->selectedSource();
+        if (selected.type == slotConfig.type && selected.source == slotConfig.source) {
+            continue;
+        }
+        const bool wasStreaming = slot->isStreaming();
+        destroySlot(slot);
+        m_slots[i] = createSlot(i);
+        if (wasStreaming || m_streaming) {
+            toStart.append(m_slots[i]);
+        }
+        replaced++;
+    }
+    
+    for (int i = m_slots.size(); i < maxSlots; ++i) {
+        m_slots.append(createSlot(i));
+        if (m_streaming) {
+            toStart.append(m_slots.last());
+        }
+        added++;
+    }
+    
+    layoutSlots();
+    
+    if (!toStart.isEmpty()) {
+        scheduleStart(toStart);
+    }
+    scheduleRenderDemandUpdate();
+    
+    qDebug() << "MonitoringScreen: Regrid to" << config.grid().rows << "x" << config.grid().columns
+             << "-" << (m_slots.size() - replaced - added) << "kept," << added << "added,"
+             << removed << "removed," << replaced << "replaced in" << timer.elapsed() << "ms";
+}
+
+void MonitoringScreen::applyConfigChange(const ConfigDiff& diff) {
+    // rebuildGrid() compares each slot's selected source with the new config,
+    // so only slots whose source really changed are recreated
+    if (diff.has(ConfigDiff::Grid) || !diff.sourceChanged.isEmpty()) {
+        rebuildGrid();
+    }
     
-    if (wasStreaming) {
-        startAllStreams();
+    QVector<CameraSlot*> restart;
+    for (int index : diff.restartNeeded) {
+        if (index < m_slots.size() && m_slots[index]->isStreaming()) {
+            m_slots[index]->stopStream();
+            restart.append(m_slots[index]);
+        }
     }
+    if (!restart.isEmpty()) {
+        scheduleStart(restart);
+    }
+    
+    for (int index : diff.previewChanged) {
+        if (index < m_slots.size()) {
+            m_slots[index]->applyPreviewFps();
+        }
+    }
+    
+    qDebug() << "MonitoringScreen: Applied config change -" << restart.size() << "restarted,"
+             << diff.previewChanged.size() << "display rates updated";
 }
 
 void MonitoringScreen::onSlotDoubleClicked(int slotIndex) {
@@ -176,14 +365,123 @@ void MonitoringScreen::onSlotDoubleClicked(int slotIndex) {
     ExpandedView* expandedView = new ExpandedView(slotIndex, nullptr);
     expandedView->setAttribute(Qt::WA_DeleteOnClose);
     
-    // Connect frame updates
-    connect(sourceSlot, &CameraSlot::frameUpdated, expandedView, &ExpandedView::updateFrame);
+    if (sourceSlot->isShowingSubStream()) {
+        // Tile decodes the low-res sub-stream; the big view needs the main stream
+        expandedView->playStream(sourceSlot->mainStreamUrl());
+    } else {
+        // Second output of the slot's own decode - frames go sink-to-sink,
+        // GPU-resident frames to a view that renders them as textures too
+        expandedView->videoWidget()->setGpuResident(sourceSlot->isGpuResident());
+        sourceSlot->addVideoOutput(expandedView->videoWidget()->displayOutput());
+    }
+    
+    // A maximized/fullscreen expanded view hides the grid behind it
+    expandedView->installEventFilter(this);
+    connect(expandedView, &QObject::destroyed, this, &MonitoringScreen::scheduleRenderDemandUpdate);
+    m_expandedViews.append(expandedView);
     
     expandedView->show();
     
     qDebug() << "MonitoringScreen: Opened expanded view for slot" << slotIndex;
 }
 
+void MonitoringScreen::showEvent(QShowEvent* event) {
+    QWidget::showEvent(event);
+    
+    // The top-level window is only known once we are shown
+    if (window() != m_watchedWindow) {
+        if (m_watchedWindow) {
+            m_watchedWindow->removeEventFilter(this);
+        }
+        m_watchedWindow = window();
+        m_watchedWindow->installEventFilter(this);
+    }
+    scheduleRenderDemandUpdate();
+}
+
+void MonitoringScreen::hideEvent(QHideEvent* event) {
+    QWidget::hideEvent(event);
+    scheduleRenderDemandUpdate();
+}
+
+bool MonitoringScreen::eventFilter(QObject* watched, QEvent* event) {
+    if (watched == m_gridContainer) {
+        if (event->type() == QEvent::Resize && m_gridView) {
+            m_gridView->setGeometry(m_gridContainer->rect());
+        }
+        return QWidget::eventFilter(watched, event);
+    }
+    
+    switch (event->type()) {
+        case QEvent::WindowStateChange:
+        case QEvent::Show:
+        case QEvent::Hide:
+        case QEvent::Move:
+            scheduleRenderDemandUpdate();
+            break;
+        default:
+            break;
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+void MonitoringScreen::scheduleRenderDemandUpdate() {
+    if (m_renderDemandQueued) {
+        return;
+    }
+    m_renderDemandQueued = true;
+    QTimer::singleShot(0, this, &MonitoringScreen::updateRenderDemand);
+}
+
+bool MonitoringScreen::isGridCovered() const {
+    const QScreen* gridScreen = screen();
+    for (const QPointer<ExpandedView>& view : m_expandedViews) {
+        if (view && view->isVisible() && !view->isMinimized()
+            && (view->isFullScreen() || view->isMaximized())
+            && view->screen() == gridScreen) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MonitoringScreen::updateRenderDemand() {
+    m_renderDemandQueued = false;
+    m_expandedViews.removeAll(QPointer<ExpandedView>());
+    
+    const bool gridVisible = isVisible()
+        && !(window() && window()->isMinimized())
+        && !isGridCovered();
+    
+    // Under memory pressure hidden slots lose buffer depth first, expanded ones last
+    QSet<int> expanded;
+    for (const QPointer<ExpandedView>& view : m_expandedViews) {
+        if (view && view->isVisible() && !view->isMinimized()) {
+            expanded.insert(view->slotIndex());
+        }
+    }
+    
+    int rendering = 0;
+    bool changed = false;
+    for (CameraSlot* slot : m_slots) {
+        const bool visible = gridVisible && slot->isVisible();
+        changed |= slot->renderDemand() != visible;
+        slot->setRenderDemand(visible);
+        if (visible) {
+            rendering++;
+        }
+        MemoryGovernor::instance().setSlotPriority(slot->slotIndex(),
+            expanded.contains(slot->slotIndex()) ? MemoryGovernor::Priority::High
+            : visible ? MemoryGovernor::Priority::Normal : MemoryGovernor::Priority::Low);
+    }
+    
+    if (!changed) {
+        return;
+    }
+    qDebug() << "MonitoringScreen: Rendering" << rendering << "/" << m_slots.size() << "tiles"
+             << (gridVisible ? "" : "(grid hidden)");
+}
+
 void MonitoringScreen::onDevicesChanged() {
     // Notify slots about device changes
     for (CameraSlot* slot : m_slots) {
@@ -194,7 +492,7 @@ void MonitoringScreen::onDevicesChanged() {
 void MonitoringScreen::onPlayButtonClicked() {
     qDebug() << "MonitoringScreen: Play button clicked";
     
-    int startedCount = 0;
+    QVector<CameraSlot*> toStart;
     int skippedPlaying = 0;
     int skippedNoSource = 0;
     
@@ -214,11 +512,13 @@ void MonitoringScreen::onPlayButtonClicked() {
             continue;
         }
         
-        // Has source but not playing - start with stagger
-        QTimer::singleShot(startedCount * 500, slot, [slot]() {
-            slot->startStream();
-        });
-        startedCount++;
+        // Has source but not playing - start through the scheduler
+        toStart.append(slot);
+    }
+    
+    const int startedCount = toStart.size();
+    if (startedCount > 0) {
+        scheduleStart(toStart);
     }
     
     qDebug() << "MonitoringScreen: Play All -" 
@@ -5,11 +5,17 @@
 #include <QGridLayout>
 #include <QVector>
 #include <QPushButton>
+#include <QPointer>
+#include <QList>
 
 namespace MCM {
 
 class CameraSlot;
 class DeviceDetector;
+class StartupScheduler;
+class ExpandedView;
+class GridVideoView;
+struct ConfigDiff;
 
 /**
  * @brief Camera monitoring screen with grid of camera slots
@@ -35,13 +41,33 @@ public:
     void stopAllStreams();
 
     /**
-     * @brief Rebuild the grid based on current configuration
+     * @brief Re-lay out the grid to match the current configuration
+     *
+     * Incremental: slots that stay in the grid with the same source keep
+     * their running streams and recordings and are only moved to their new
+     * cell; slots are created or destroyed only where the slot count changed
+     * (or a slot's configured source did). Switching grid.renderer still
+     * recreates every slot.
      */
     void rebuildGrid();
+    
+    /**
+     * @brief Apply a reloaded configuration to the running grid
+     *
+     * Regrids for grid and source changes, restarts only the running slots
+     * whose effective settings changed and updates display rates in place.
+     * Other slots are not touched.
+     */
+    void applyConfigChange(const ConfigDiff& diff);
 
 signals:
     void backRequested();
 
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
 private slots:
     void onSlotDoubleClicked(int slotIndex);
     void onDevicesChanged();
@@ -51,12 +77,47 @@ private:
     void setupUi();
     void createSlots();
     void clearSlots();
+    CameraSlot* createSlot(int index);
+    void destroySlot(CameraSlot* slot);
+    
+    /**
+     * @brief Place m_slots in the layout, row-major over grid.columns
+     */
+    void layoutSlots();
+    
+    /**
+     * @brief Create or drop the shared grid view to match grid.renderer
+     */
+    void applyRendererMode();
+    
+    /**
+     * @brief Queue slots on the startup scheduler (bounded parallel opens)
+     */
+    void scheduleStart(const QVector<CameraSlot*>& slots);
+    
+    /**
+     * @brief Suspend rendering of tiles nobody can see
+     *
+     * The grid is considered hidden when this screen is not the current page,
+     * the window is minimized, or a maximized/fullscreen expanded view sits on
+     * the same screen. Coalesced to one evaluation per event-loop pass.
+     */
+    void scheduleRenderDemandUpdate();
+    void updateRenderDemand();
+    bool isGridCovered() const;
 
     QGridLayout* m_gridLayout;
+    QWidget* m_gridContainer{nullptr};
+    GridVideoView* m_gridView{nullptr};  // Shared renderer (grid.renderer = "shared")
+    QString m_renderer;                  // grid.renderer the slots were created with
     QVector<CameraSlot*> m_slots;
     QPushButton* m_backButton;
     QPushButton* m_playButton;
     DeviceDetector* m_deviceDetector;
+    StartupScheduler* m_startupScheduler{nullptr};
+    QList<QPointer<ExpandedView>> m_expandedViews;
+    QPointer<QWidget> m_watchedWindow;
+    bool m_renderDemandQueued{false};
     
     bool m_streaming{false};
 };
@@ -1,7 +1,12 @@
 #include "OptimizedVideoWidget.h"
+#include "GridVideoView.h"
+#include "core/Telemetry.h"
 #include <QVBoxLayout>
+#include <QVideoWidget>
 #include <QResizeEvent>
 #include <QDebug>
+#include <QVideoFrame>
+#include <QMutexLocker>
 
 namespace MCM {
 
@@ -28,6 +33,7 @@ OptimizedVideoWidget::OptimizedVideoWidget(QWidget* parent)
     m_videoItem = new QGraphicsVideoItem();
     m_videoItem->setAspectRatioMode(m_aspectMode);
     m_scene->addItem(m_videoItem);
+    setPreviewTarget(m_videoItem->videoSink());
     qDebug() << "OptimizedVideoWidget: Created QGraphicsVideoItem" << m_videoItem;
     
     // Connect to native size changes for proper scaling
@@ -40,6 +46,7 @@ OptimizedVideoWidget::OptimizedVideoWidget(QWidget* parent)
     layout->setContentsMargins(0, 0, 0, 0);
     layout->setSpacing(0);
     layout->addWidget(m_view);
+    m_view->viewport()->installEventFilter(this);
     
     // Widget settings
     setMinimumSize(160, 120);
@@ -47,11 +54,89 @@ OptimizedVideoWidget::OptimizedVideoWidget(QWidget* parent)
 }
 
 OptimizedVideoWidget::~OptimizedVideoWidget() {
-    // QGraphicsScene owns the video item, will be cleaned up automatically
+    // Our scene owns the video item in per-slot mode; a grid tile must be handed back
+    setPreviewTarget(nullptr);
+    if (m_grid) {
+        m_grid->removeTile(m_videoItem);
+    }
+}
+
+void OptimizedVideoWidget::attachToGrid(GridVideoView* grid) {
+    if (!grid || m_grid == grid) {
+        return;
+    }
+    
+    disconnect(m_videoItem, &QGraphicsVideoItem::nativeSizeChanged,
+               this, &OptimizedVideoWidget::onNativeSizeChanged);
+    setPreviewTarget(nullptr);
+    if (m_grid) {
+        m_grid->removeTile(m_videoItem);
+    } else {
+        m_scene->removeItem(m_videoItem);
+        delete m_videoItem;
+    }
+    
+    m_grid = grid;
+    m_videoItem = m_grid->createTile(this);
+    m_videoItem->setAspectRatioMode(m_aspectMode);
+    m_grid->setTileEnabled(m_videoItem, m_renderingEnabled && !m_gpuResident);
+    m_grid->setTileTelemetry(m_videoItem, m_telemetry.load());
+    setPreviewTarget(m_videoItem->videoSink());
+    connect(m_videoItem, &QGraphicsVideoItem::nativeSizeChanged,
+            this, &OptimizedVideoWidget::onNativeSizeChanged);
+    m_nativeSize = QSizeF();
+    
+    // The grid view underneath shows through; our own viewport is unused
+    m_view->hide();
+    qDebug() << "OptimizedVideoWidget: Rendering through shared grid view, item" << m_videoItem;
 }
 
 QVideoSink* OptimizedVideoWidget::videoSink() const {
-    return m_videoItem->videoSink();
+    return m_gpuResident ? m_gpuWidget->videoSink() : m_videoItem->videoSink();
+}
+
+QObject* OptimizedVideoWidget::displayOutput() const {
+    if (m_gpuResident) {
+        return m_gpuWidget;
+    }
+    return m_videoItem;
+}
+
+void OptimizedVideoWidget::setGpuResident(bool enabled) {
+    if (m_gpuResident == enabled) {
+        return;
+    }
+    m_gpuResident = enabled;
+    
+    if (enabled && !m_gpuWidget) {
+        m_gpuWidget = new QVideoWidget(this);
+        m_gpuWidget->setAspectRatioMode(m_aspectMode);
+        layout()->addWidget(m_gpuWidget);
+        QVideoSink* sink = m_gpuWidget->videoSink();
+        connect(sink, &QVideoSink::videoSizeChanged, this, [this, sink]() {
+            onNativeSizeChanged(QSizeF(sink->videoSize()));
+        });
+        // No paint event of ours to sample: a frame counts as presented once the renderer has it
+        // (on the delivering thread - nothing is posted to ours per frame)
+        connect(sink, &QVideoSink::videoFrameChanged, this, [this](const QVideoFrame& frame) {
+            SlotTelemetry* telemetry = m_telemetry.load();
+            if (telemetry && m_gpuResident && m_renderingEnabled) {
+                telemetry->recordPresented(frame.startTime(), Telemetry::nowUs());
+            }
+        }, Qt::DirectConnection);
+    }
+    
+    // Exactly one of the video widget, our viewport or the grid tile shows the video
+    if (m_gpuWidget) {
+        m_gpuWidget->setVisible(enabled && m_renderingEnabled);
+    }
+    if (m_grid) {
+        m_grid->setTileEnabled(m_videoItem, m_renderingEnabled && !enabled);
+    } else {
+        m_view->setVisible(!enabled);
+    }
+    m_nativeSize = QSizeF();
+    qDebug() << "OptimizedVideoWidget:" << (enabled ? "GPU-resident rendering (QVideoWidget)" : "Item rendering");
 }
 
 void OptimizedVideoWidget::clear() {
@@ -71,14 +156,22 @@ void OptimizedVideoWidget::resetVideoItem() {
     disconnect(m_videoItem, &QGraphicsVideoItem::nativeSizeChanged,
                this, &OptimizedVideoWidget::onNativeSizeChanged);
     
-    // Remove and delete old item
-    m_scene->removeItem(m_videoItem);
-    delete m_videoItem;
-    
-    // Create fresh video item
-    m_videoItem = new QGraphicsVideoItem();
+    // Remove and delete old item, create a fresh one in the same place
+    setPreviewTarget(nullptr);
+    if (m_grid) {
+        m_grid->removeTile(m_videoItem);
+        m_videoItem = m_grid->createTile(this);
+        m_grid->setTileEnabled(m_videoItem, m_renderingEnabled && !m_gpuResident);
+        m_grid->setTileTelemetry(m_videoItem, m_telemetry.load());
+    } else {
+        m_scene->removeItem(m_videoItem);
+        delete m_videoItem;
+        m_videoItem = new QGraphicsVideoItem();
+        m_videoItem->setVisible(m_renderingEnabled);
+        m_scene->addItem(m_videoItem);
+    }
     m_videoItem->setAspectRatioMode(m_aspectMode);
-    m_scene->addItem(m_videoItem);
+    setPreviewTarget(m_videoItem->videoSink());
     
     // Reconnect signal
     connect(m_videoItem, &QGraphicsVideoItem::nativeSizeChanged,
@@ -97,9 +190,125 @@ bool OptimizedVideoWidget::hasVideo() const {
 void OptimizedVideoWidget::setAspectRatioMode(Qt::AspectRatioMode mode) {
     m_aspectMode = mode;
     m_videoItem->setAspectRatioMode(mode);
+    if (m_gpuWidget) {
+        m_gpuWidget->setAspectRatioMode(mode);
+    }
     fitVideoInView();
 }
 
+void OptimizedVideoWidget::setRenderingEnabled(bool enabled) {
+    if (m_renderingEnabled == enabled) {
+        return;
+    }
+    m_renderingEnabled = enabled;
+    
+    // A hidden video window is not exposed, so frames are not rendered
+    if (m_gpuResident) {
+        m_gpuWidget->setVisible(enabled);
+        return;
+    }
+    
+    // A hidden item is skipped by the scene: no paint, no texture upload,
+    // and its per-frame update() calls no longer schedule viewport repaints
+    if (m_grid) {
+        m_grid->setTileEnabled(m_videoItem, enabled);
+        return;
+    }
+    m_videoItem->setVisible(enabled);
+    if (enabled) {
+        fitVideoInView();
+        m_view->viewport()->update();
+    }
+}
+
+void OptimizedVideoWidget::setPreviewFps(int fps) {
+    m_previewFps = qMax(0, fps);
+    m_nextPreviewUs = -1;
+    if (m_previewFps > 0 && !m_previewSink) {
+        m_previewSink = new QVideoSink(this);
+        connect(m_previewSink, &QVideoSink::videoFrameChanged,
+                this, &OptimizedVideoWidget::onPreviewFrame, Qt::DirectConnection);
+    }
+}
+
+QObject* OptimizedVideoWidget::previewOutput() const {
+    // Decimation would put a sink without a renderer in front: the backend
+    // would then hand out CPU frames instead of decoder textures
+    if (m_gpuResident) {
+        return m_gpuWidget;
+    }
+    if (m_previewFps > 0 && m_previewSink) {
+        return m_previewSink;
+    }
+    return m_videoItem;
+}
+
+void OptimizedVideoWidget::setPreviewTarget(QVideoSink* sink) {
+    // The item is replaced on our thread while frames are forwarded on the backend's
+    QMutexLocker locker(&m_previewTargetMutex);
+    m_previewTarget = sink;
+}
+
+void OptimizedVideoWidget::onPreviewFrame(const QVideoFrame& frame) {
+    SlotTelemetry* telemetry = m_telemetry.load();
+    const int previewFps = m_previewFps.load();
+    if (previewFps > 0) {
+        // Prefer the stream's own clock so decimation follows the source cadence;
+        // fall back to arrival time when frames carry no timestamps
+        const qint64 nowUs = frame.startTime() >= 0 ? frame.startTime() : Telemetry::nowUs();
+        const qint64 intervalUs = 1000000 / previewFps;
+        qint64 nextUs = m_nextPreviewUs.load(std::memory_order_relaxed);
+        
+        // Jump in time (seek, reconnect, clock switch): restart the schedule
+        if (nextUs >= 0 && (nowUs < nextUs - 2 * intervalUs || nowUs > nextUs + 2 * intervalUs)) {
+            nextUs = -1;
+        }
+        
+        // A quarter interval of slack absorbs capture jitter so 30 -> 15 fps
+        // forwards every second frame instead of beating
+        if (nextUs >= 0 && nowUs < nextUs - intervalUs / 4) {
+            m_previewDropped.fetch_add(1, std::memory_order_relaxed);
+            if (telemetry) {
+                telemetry->recordDrop(SlotTelemetry::DropStage::Preview);
+            }
+            return;
+        }
+        m_nextPreviewUs.store((nextUs < 0 ? nowUs : nextUs) + intervalUs, std::memory_order_relaxed);
+        
+        // Once hidden (render demand off) the item is not drawn; skip the handoff too
+        if (!m_renderingEnabled) {
+            if (telemetry) {
+                telemetry->recordDrop(SlotTelemetry::DropStage::Hidden);
+            }
+            return;
+        }
+    }
+    
+    // Same hand-off the backend does for the item when it is the output
+    QMutexLocker locker(&m_previewTargetMutex);
+    if (m_previewTarget) {
+        m_previewTarget->setVideoFrame(frame);
+    }
+}
+
+void OptimizedVideoWidget::setTelemetry(SlotTelemetry* telemetry) {
+    m_telemetry = telemetry;
+    if (m_grid) {
+        m_grid->setTileTelemetry(m_videoItem, telemetry);
+    }
+}
+
+bool OptimizedVideoWidget::eventFilter(QObject* watched, QEvent* event) {
+    // Our viewport is about to draw the item's current frame
+    SlotTelemetry* telemetry = m_telemetry.load();
+    if (telemetry && event->type() == QEvent::Paint && watched == m_view->viewport()
+        && m_renderingEnabled && !m_grid) {
+        telemetry->recordPresented(m_videoItem->videoSink()->videoFrame().startTime(),
+                                     Telemetry::nowUs());
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
 void OptimizedVideoWidget::resizeEvent(QResizeEvent* event) {
     QWidget::resizeEvent(event);
     fitVideoInView();
@@ -123,6 +332,9 @@ void OptimizedVideoWidget::onNativeSizeChanged(const QSizeF& size) {
 }
 
 void OptimizedVideoWidget::fitVideoInView() {
+    if (m_grid) {
+        return;  // The grid view positions its tiles
+    }
     if (!m_nativeSize.isValid() || m_nativeSize.isEmpty()) {
         return;
     }
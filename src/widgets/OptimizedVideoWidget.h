@@ -6,9 +6,17 @@
 #include <QGraphicsScene>
 #include <QGraphicsVideoItem>
 #include <QVideoSink>
+#include <QPointer>
+#include <QMutex>
+#include <atomic>
+
+class QVideoWidget;
 
 namespace MCM {
 
+class GridVideoView;
+class SlotTelemetry;
+
 /**
  * @brief GPU-accelerated video display widget using Qt Multimedia
  * 
@@ -36,9 +44,16 @@ public:
 
     /**
      * @brief Get the video sink for direct frame access (if needed)
+     *
+     * The sink of displayOutput(): the item's, or the video widget's when GPU-resident.
      */
     QVideoSink* videoSink() const;
 
+    /**
+     * @brief Object that displays the frames: videoItem(), or the video widget when GPU-resident
+     */
+    QObject* displayOutput() const;
+
     /**
      * @brief Clear the display (show blank/black)
      */
@@ -65,20 +80,105 @@ public:
      */
     void setAspectRatioMode(Qt::AspectRatioMode mode);
 
+    /**
+     * @brief Enable or suspend on-screen rendering
+     *
+     * While suspended the video item is hidden, so incoming frames are neither
+     * uploaded nor composited; the capture session keeps feeding the sink, so
+     * consumers of the frames (recording, expanded view) are unaffected.
+     * Re-enabling repaints the most recent frame immediately.
+     */
+    void setRenderingEnabled(bool enabled);
+    bool isRenderingEnabled() const { return m_renderingEnabled.load(); }
+
+    /**
+     * @brief Render through a shared grid view instead of our own viewport
+     *
+     * Our QGraphicsView is hidden and videoItem() becomes a tile of @p grid
+     * placed under this widget. Must be called before the item is handed to
+     * a capture session. Child overlays are unaffected.
+     */
+    void attachToGrid(GridVideoView* grid);
+    bool isSharedRendering() const { return !m_grid.isNull(); }
+
+    /**
+     * @brief Render into a QVideoWidget instead of the graphics item
+     *
+     * QGraphicsVideoItem paints through QPainter, which maps every frame into
+     * CPU memory - for a hardware-decoded stream, one GPU download per frame.
+     * QVideoWidget renders through QRhi, so the backend hands it decoder
+     * textures and the frames stay on the GPU from decode to screen.
+     *
+     * In this mode the video widget is the output for every consumer:
+     * preview decimation and the shared grid view do not apply, and painted
+     * frames are sampled for telemetry when the renderer receives them.
+     */
+    void setGpuResident(bool enabled);
+    bool isGpuResident() const { return m_gpuResident.load(); }
+
+    /**
+     * @brief Limit how many frames per second reach the display (0 = all)
+     *
+     * With a limit, previewOutput() is an intermediate sink that forwards a
+     * decimated subset of frames to the video item. Whoever else consumes
+     * that sink's frames (recording, frame access) still sees every frame.
+     * Decimation runs on the thread that delivers the frame and hands the
+     * kept ones straight to the item's sink, so it posts nothing per frame
+     * to the GUI thread.
+     */
+    void setPreviewFps(int fps);
+    int previewFps() const { return m_previewFps.load(); }
+
+    /**
+     * @brief Object to hand to setVideoOutput(): the video item itself, the
+     *        decimating preview sink when a preview fps limit is set, or the
+     *        video widget when GPU-resident
+     */
+    QObject* previewOutput() const;
+
+    /**
+     * @brief Frames dropped by preview decimation since creation
+     */
+    quint64 previewFramesDropped() const { return m_previewDropped.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Report presented frames, display latency and display-side drops
+     *
+     * Presentation is sampled when the tile is painted (our viewport, or the
+     * shared grid view), so measuring adds no per-frame work.
+     */
+    void setTelemetry(SlotTelemetry* telemetry);
+
 protected:
     void resizeEvent(QResizeEvent* event) override;
+    bool eventFilter(QObject* watched, QEvent* event) override;
 
 private slots:
     void onNativeSizeChanged(const QSizeF& size);
 
 private:
     void fitVideoInView();
+    void onPreviewFrame(const QVideoFrame& frame);   // Delivering thread
+    void setPreviewTarget(QVideoSink* sink);
 
     QGraphicsView* m_view;
     QGraphicsScene* m_scene;
     QGraphicsVideoItem* m_videoItem;
     Qt::AspectRatioMode m_aspectMode;
     QSizeF m_nativeSize;
+    std::atomic<bool> m_renderingEnabled{true};
+    QPointer<GridVideoView> m_grid;  // Set in shared-renderer mode
+    QVideoWidget* m_gpuWidget{nullptr};  // Created by the first setGpuResident(true)
+    std::atomic<bool> m_gpuResident{false};
+    std::atomic<SlotTelemetry*> m_telemetry{nullptr};
+    
+    // Preview decimation
+    QVideoSink* m_previewSink{nullptr};
+    std::atomic<int> m_previewFps{0};
+    std::atomic<qint64> m_nextPreviewUs{-1};   // Earliest timestamp of the next forwarded frame
+    std::atomic<quint64> m_previewDropped{0};
+    QMutex m_previewTargetMutex;
+    QVideoSink* m_previewTarget{nullptr};      // Item sink fed by onPreviewFrame()
 };
 
 } // namespace MCM
@@ -0,0 +1,443 @@
+#include "PlaybackScreen.h"
+#include "core/Config.h"
+#include "core/QtVideoRecorder.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QVideoWidget>
+#include <QPainter>
+#include <QMouseEvent>
+#include <QUrl>
+#include <QDebug>
+#include <functional>
+
+namespace MCM {
+
+/**
+ * @brief One local day with its recorded spans and event markers; click or drag to seek
+ */
+class TimelineBar : public QWidget {
+public:
+    explicit TimelineBar(QWidget* parent = nullptr)
+        : QWidget(parent)
+    {
+        setObjectName("playbackTimeline");
+        setMinimumHeight(40);
+        setCursor(Qt::PointingHandCursor);
+    }
+
+    std::function<void(qint64 wallMs, bool final)> seekRequested;
+
+    void setRange(qint64 fromMs, qint64 toMs) { m_from = fromMs; m_to = qMax(fromMs + 1, toMs); update(); }
+    void setSpans(const QList<QPair<qint64, qint64>>& spans) { m_spans = spans; update(); }
+    void setMarkers(const QList<qint64>& markers) { m_markers = markers; update(); }
+
+    void setPosition(qint64 wallMs) {
+        if (!m_dragging && wallMs != m_position) {
+            m_position = wallMs;
+            update();
+        }
+    }
+
+protected:
+    void paintEvent(QPaintEvent*) override {
+        QPainter painter(this);
+        painter.fillRect(rect(), QColor(26, 26, 46));
+
+        const int bandTop = height() / 3;
+        const int bandHeight = height() / 3;
+        for (const auto& span : m_spans) {
+            const int x0 = xAt(span.first);
+            painter.fillRect(QRect(x0, bandTop, qMax(1, xAt(span.second) - x0), bandHeight), QColor(46, 125, 50));
+        }
+        painter.setPen(QColor(255, 152, 0));
+        for (qint64 marker : m_markers) {
+            const int x = xAt(marker);
+            painter.drawLine(x, 0, x, bandTop - 2);
+        }
+
+        // Hour ticks, labelled every 3 hours
+        painter.setPen(QColor(160, 160, 180));
+        for (int hour = 0; hour <= 24; ++hour) {
+            const int x = xAt(m_from + hour * 3600000LL);
+            painter.drawLine(x, bandTop + bandHeight, x, bandTop + bandHeight + (hour % 3 == 0 ? 6 : 3));
+            if (hour % 3 == 0 && hour < 24) {
+                painter.drawText(x + 3, height() - 2, QString("%1:00").arg(hour, 2, 10, QChar('0')));
+            }
+        }
+
+        painter.setPen(QPen(Qt::white, 2));
+        const int cursorX = xAt(m_position);
+        painter.drawLine(cursorX, 0, cursorX, height());
+    }
+
+    void mousePressEvent(QMouseEvent* event) override {
+        m_dragging = true;
+        seekTo(event, false);
+    }
+
+    void mouseMoveEvent(QMouseEvent* event) override {
+        if (m_dragging) {
+            seekTo(event, false);
+        }
+    }
+
+    void mouseReleaseEvent(QMouseEvent* event) override {
+        seekTo(event, true);
+        m_dragging = false;
+    }
+
+private:
+    void seekTo(QMouseEvent* event, bool final) {
+        const int x = qRound(event->position().x());
+        m_position = timeAt(x);
+        update();
+        if (seekRequested) {
+            seekRequested(m_position, final);
+        }
+    }
+
+    int xAt(qint64 wallMs) const {
+        return static_cast<int>((qBound(m_from, wallMs, m_to) - m_from) * width() / (m_to - m_from));
+    }
+
+    qint64 timeAt(int x) const {
+        return m_from + (m_to - m_from) * qBound(0, x, width()) / qMax(1, width());
+    }
+
+    qint64 m_from{0};
+    qint64 m_to{1};
+    qint64 m_position{0};
+    bool m_dragging{false};
+    QList<QPair<qint64, qint64>> m_spans;
+    QList<qint64> m_markers;
+};
+
+PlaybackScreen::PlaybackScreen(QWidget* parent)
+    : QWidget(parent)
+    , m_syncTimer(new QTimer(this))
+{
+    setupUi();
+
+    m_syncTimer->setInterval(SYNC_INTERVAL_MS);
+    connect(m_syncTimer, &QTimer::timeout, this, &PlaybackScreen::onSyncTick);
+    m_clockStarted.start();
+}
+
+PlaybackScreen::~PlaybackScreen() {
+    stop();
+    clearTiles();
+}
+
+void PlaybackScreen::setupUi() {
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+    mainLayout->setContentsMargins(10, 10, 10, 10);
+    mainLayout->setSpacing(10);
+
+    // Top bar with back button
+    QHBoxLayout* topBar = new QHBoxLayout();
+
+    m_backButton = new QPushButton("← Back", this);
+    m_backButton->setObjectName("backButton");
+    m_backButton->setFixedSize(100, 36);
+    m_backButton->setCursor(Qt::PointingHandCursor);
+    connect(m_backButton, &QPushButton::clicked, this, &PlaybackScreen::backRequested);
+
+    topBar->addWidget(m_backButton);
+    topBar->addStretch();
+
+    QLabel* titleLabel = new QLabel("Playback", this);
+    titleLabel->setObjectName("screenTitle");
+    QFont titleFont = titleLabel->font();
+    titleFont.setPointSize(18);
+    titleFont.setBold(true);
+    titleLabel->setFont(titleFont);
+
+    topBar->addWidget(titleLabel);
+    topBar->addStretch();
+
+    m_statusLabel = new QLabel(this);
+    topBar->addWidget(m_statusLabel);
+
+    m_timeEdit = new QDateTimeEdit(this);
+    m_timeEdit->setDisplayFormat("yyyy-MM-dd HH:mm:ss");
+    m_timeEdit->setCalendarPopup(true);
+    topBar->addWidget(m_timeEdit);
+
+    m_goButton = new QPushButton("Go", this);
+    m_goButton->setFixedSize(60, 36);
+    m_goButton->setCursor(Qt::PointingHandCursor);
+    connect(m_goButton, &QPushButton::clicked, this, &PlaybackScreen::onGoClicked);
+    connect(m_timeEdit, &QDateTimeEdit::editingFinished, this, &PlaybackScreen::onGoClicked);
+    topBar->addWidget(m_goButton);
+
+    m_playButton = new QPushButton("▶ Play", this);
+    m_playButton->setObjectName("playButton");
+    m_playButton->setFixedSize(100, 36);
+    m_playButton->setCursor(Qt::PointingHandCursor);
+    connect(m_playButton, &QPushButton::clicked, this, &PlaybackScreen::onPlayPauseClicked);
+    topBar->addWidget(m_playButton);
+
+    mainLayout->addLayout(topBar);
+
+    // Grid container
+    m_gridContainer = new QWidget(this);
+    m_gridContainer->setObjectName("gridContainer");
+    m_gridLayout = new QGridLayout(m_gridContainer);
+    m_gridLayout->setContentsMargins(5, 5, 5, 5);
+    m_gridLayout->setSpacing(8);
+    mainLayout->addWidget(m_gridContainer, 1);
+
+    // Day timeline: recorded spans, event markers and the play position
+    m_timeline = new TimelineBar(this);
+    m_timeline->seekRequested = [this](qint64 wallMs, bool final) { seekAll(wallMs, final); };
+    mainLayout->addWidget(m_timeline);
+}
+
+void PlaybackScreen::clearTiles() {
+    for (const auto& tile : m_tiles) {
+        m_gridLayout->removeWidget(tile->container);
+        delete tile->container;  // Owns the player and the video widget
+    }
+    m_tiles.clear();
+}
+
+PlaybackScreen::Tile* PlaybackScreen::createTile(int slotId, const QString& recordingsDir) {
+    auto tile = std::make_unique<Tile>();
+    tile->slotId = slotId;
+    tile->index = std::make_unique<ChunkIndex>(QString("%1/slot_%2").arg(recordingsDir).arg(slotId));
+
+    tile->container = new QWidget(m_gridContainer);
+    tile->container->setObjectName("playbackTile");
+    QGridLayout* layout = new QGridLayout(tile->container);
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    tile->video = new QVideoWidget(tile->container);
+    tile->video->hide();
+    layout->addWidget(tile->video, 0, 0);
+
+    tile->status = new QLabel(tile->container);
+    tile->status->setAlignment(Qt::AlignCenter);
+    layout->addWidget(tile->status, 0, 0);
+
+    // No audio output: recordings are video only
+    tile->player = new QMediaPlayer(tile->container);
+    tile->player->setVideoOutput(tile->video);
+
+    Tile* raw = tile.get();
+    connect(tile->player, &QMediaPlayer::mediaStatusChanged, this,
+            [this, raw](QMediaPlayer::MediaStatus status) { onMediaStatusChanged(*raw, status); });
+    connect(tile->player, &QMediaPlayer::errorOccurred, this,
+            [this, raw](QMediaPlayer::Error, const QString& errorString) {
+        qWarning() << "PlaybackScreen: Slot" << raw->slotId << ":" << errorString;
+        setIdle(*raw, "Cannot play chunk");
+    });
+
+    setIdle(*raw, "No recording");
+    m_tiles.push_back(std::move(tile));
+    return raw;
+}
+
+void PlaybackScreen::loadRecordings() {
+    stop();
+    clearTiles();
+
+    const Config& config = Config::instance();
+    const GridConfig grid = config.grid();
+    const QString recordingsDir = QtVideoRecorder::resolveOutputDirectory(config.recording().outputDirectory);
+    for (int i = 0; i < grid.maxSlots(); ++i) {
+        Tile* tile = createTile(i, recordingsDir);
+        m_gridLayout->addWidget(tile->container, i / qMax(1, grid.columns), i % qMax(1, grid.columns));
+    }
+    qDebug() << "PlaybackScreen: Opened" << m_tiles.size() << "slot indexes in" << recordingsDir;
+
+    // Start a minute back, paused, so the most recent finished chunks show
+    m_syncTimer->start();
+    seekAll(QDateTime::currentMSecsSinceEpoch() - 60000);
+}
+
+void PlaybackScreen::stop() {
+    m_syncTimer->stop();
+    setPlaying(false);
+    for (const auto& tile : m_tiles) {
+        tile->player->stop();
+        tile->player->setSource(QUrl());  // Close the file and the decoder
+        setIdle(*tile, "No recording");
+    }
+}
+
+qint64 PlaybackScreen::clockMs() const {
+    return m_playing ? m_clockBaseMs + m_clockStarted.elapsed() : m_clockBaseMs;
+}
+
+void PlaybackScreen::setClock(qint64 wallMs) {
+    m_clockBaseMs = wallMs;
+    m_clockStarted.restart();
+}
+
+void PlaybackScreen::setPlaying(bool playing) {
+    setClock(clockMs());
+    m_playing = playing;
+    m_playButton->setText(playing ? "⏸ Pause" : "▶ Play");
+    for (const auto& tile : m_tiles) {
+        if (!tile->position.isValid()) {
+            continue;
+        }
+        if (playing) {
+            tile->player->play();
+        } else {
+            tile->player->pause();
+        }
+    }
+}
+
+void PlaybackScreen::seekAll(qint64 wallMs, bool exact) {
+    wallMs = qMin(wallMs, QDateTime::currentMSecsSinceEpoch());
+    setClock(wallMs);
+    for (const auto& tile : m_tiles) {
+        showAt(*tile, wallMs, exact);
+    }
+    updateTimeline(false);
+}
+
+void PlaybackScreen::showAt(Tile& tile, qint64 wallMs, bool exact) {
+    const ChunkIndex::Position position = tile.index->locate(wallMs);
+    if (!position.isValid()) {
+        setIdle(tile, "No recording");
+    } else if (position.open) {
+        setIdle(tile, "Recording");
+    } else {
+        showPosition(tile, position, exact ? position.offsetMs : position.keyframeOffsetMs);
+    }
+}
+
+void PlaybackScreen::showPosition(Tile& tile, const ChunkIndex::Position& position, qint64 offsetMs) {
+    const QUrl url = QUrl::fromLocalFile(position.path);
+    if (tile.player->source() != url) {
+        tile.player->setSource(url);
+        tile.pendingOffsetMs = offsetMs;
+    } else {
+        switch (tile.player->mediaStatus()) {
+            case QMediaPlayer::LoadedMedia:
+            case QMediaPlayer::BufferingMedia:
+            case QMediaPlayer::BufferedMedia:
+            case QMediaPlayer::EndOfMedia:
+                tile.player->setPosition(offsetMs);
+                tile.pendingOffsetMs = -1;
+                break;
+            default:
+                tile.pendingOffsetMs = offsetMs;  // Still loading
+                break;
+        }
+    }
+    tile.position = position;
+    tile.status->hide();
+    tile.video->show();
+
+    if (m_playing) {
+        tile.player->play();
+    } else {
+        tile.player->pause();  // Shows the frame at the position
+    }
+}
+
+void PlaybackScreen::setIdle(Tile& tile, const QString& text) {
+    if (tile.position.isValid()) {
+        tile.player->pause();
+        tile.position = ChunkIndex::Position();
+        tile.pendingOffsetMs = -1;
+    }
+    tile.video->hide();
+    tile.status->setText(QString("Slot %1\n%2").arg(tile.slotId).arg(text));
+    tile.status->show();
+}
+
+void PlaybackScreen::onMediaStatusChanged(Tile& tile, QMediaPlayer::MediaStatus status) {
+    if (status == QMediaPlayer::InvalidMedia) {
+        setIdle(tile, "Cannot play chunk");
+        return;
+    }
+    if ((status == QMediaPlayer::LoadedMedia || status == QMediaPlayer::BufferedMedia)
+        && tile.pendingOffsetMs >= 0) {
+        // Where the clock is now, not where it was when the load started
+        const qint64 offset = m_playing && tile.position.isValid()
+            ? qMax<qint64>(0, clockMs() - tile.position.chunkStartMs) : tile.pendingOffsetMs;
+        tile.pendingOffsetMs = -1;
+        tile.player->setPosition(offset);
+    }
+}
+
+void PlaybackScreen::onSyncTick() {
+    qint64 now = clockMs();
+    if (m_playing && now >= QDateTime::currentMSecsSinceEpoch()) {
+        setPlaying(false);  // Caught up with the live edge
+        now = clockMs();
+    }
+
+    int showing = 0;
+    for (const auto& tile : m_tiles) {
+        Tile& t = *tile;
+        if (m_playing) {
+            if (!t.position.isValid()) {
+                showAt(t, now, true);   // A gap or the last chunk: pick up the next one when it comes
+            } else if (now >= t.position.chunkEndMs || t.player->mediaStatus() == QMediaPlayer::EndOfMedia) {
+                showAt(t, now, true);   // Across the chunk boundary
+            } else if (t.pendingOffsetMs < 0 && t.player->playbackState() == QMediaPlayer::PlayingState) {
+                const qint64 drift = t.position.chunkStartMs + t.player->position() - now;
+                if (qAbs(drift) > DRIFT_LIMIT_MS) {
+                    t.player->setPosition(now - t.position.chunkStartMs);
+                }
+            }
+        }
+        if (t.position.isValid()) {
+            showing++;
+        }
+    }
+    m_statusLabel->setText(QString("%1 / %2 slots").arg(showing).arg(m_tiles.size()));
+
+    const QSignalBlocker blocker(m_timeEdit);
+    if (!m_timeEdit->hasFocus()) {
+        m_timeEdit->setDateTime(QDateTime::fromMSecsSinceEpoch(now));
+    }
+    updateTimeline(false);
+}
+
+void PlaybackScreen::updateTimeline(bool reloadDay) {
+    const qint64 now = clockMs();
+    const qint64 dayStart = QDateTime::fromMSecsSinceEpoch(now).date().startOfDay().toMSecsSinceEpoch();
+    const qint64 wallNow = QDateTime::currentMSecsSinceEpoch();
+    if (dayStart != m_dayStartMs || wallNow - m_lastCoverageMs >= COVERAGE_REFRESH_MS) {
+        reloadDay = true;
+    }
+
+    if (reloadDay) {
+        const qint64 dayEnd = QDateTime::fromMSecsSinceEpoch(now).date().addDays(1).startOfDay().toMSecsSinceEpoch();
+        QList<QPair<qint64, qint64>> spans;
+        QList<qint64> markers;
+        for (const auto& tile : m_tiles) {
+            spans.append(tile->index->coverage(dayStart, dayEnd));
+            for (const ChunkIndex::Marker& marker : tile->index->markers(dayStart, dayEnd)) {
+                markers.append(marker.wallMs);
+            }
+        }
+        m_timeline->setRange(dayStart, dayEnd);
+        m_timeline->setSpans(spans);
+        m_timeline->setMarkers(markers);
+        m_dayStartMs = dayStart;
+        m_lastCoverageMs = wallNow;
+    }
+    m_timeline->setPosition(now);
+}
+
+void PlaybackScreen::onPlayPauseClicked() {
+    setPlaying(!m_playing);
+    if (m_playing) {
+        onSyncTick();  // Idle tiles whose chunk starts now, at once
+    }
+}
+
+void PlaybackScreen::onGoClicked() {
+    seekAll(m_timeEdit->dateTime().toMSecsSinceEpoch(), true);
+}
+
+} // namespace MCM
@@ -0,0 +1,119 @@
+#ifndef PLAYBACKSCREEN_H
+#define PLAYBACKSCREEN_H
+
+#include <QWidget>
+#include <QPushButton>
+#include <QLabel>
+#include <QDateTimeEdit>
+#include <QGridLayout>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QMediaPlayer>
+#include <memory>
+#include <vector>
+#include "core/ChunkIndex.h"
+
+class QVideoWidget;
+
+namespace MCM {
+
+class TimelineBar;
+
+/**
+ * @brief Synchronized playback of recorded chunks, all slots at one time
+ *
+ * One player per slot, laid out like the monitoring grid. Seeking takes a
+ * wall-clock time (time field or the day timeline) and looks it up in each
+ * slot's ChunkIndex, so every tile jumps to the chunk and media position
+ * recorded at that moment - no directory listing and no probing of files.
+ * While the timeline is dragged players seek to the indexed keyframe
+ * before the time (decoding starts there anyway); on release they seek
+ * exactly.
+ *
+ * A shared clock drives playback: slots cross chunk boundaries and gaps on
+ * their own, and a tile that drifts more than DRIFT_LIMIT_MS from the
+ * clock is put back. A chunk still being written cannot be played until
+ * its MP4 trailer is written at rotation; the tile shows "Recording".
+ */
+class PlaybackScreen : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit PlaybackScreen(QWidget* parent = nullptr);
+    ~PlaybackScreen() override;
+
+    /**
+     * @brief Open the slots' indexes for the current grid and recordings directory
+     */
+    void loadRecordings();
+
+    /**
+     * @brief Seek every slot to a wall-clock time (ms since epoch)
+     * @param exact false = to the keyframe before it (fast, while scrubbing)
+     */
+    void seekAll(qint64 wallMs, bool exact = true);
+
+    /**
+     * @brief Pause and release all players (screen is left)
+     */
+    void stop();
+
+signals:
+    void backRequested();
+
+private slots:
+    void onPlayPauseClicked();
+    void onGoClicked();
+    void onSyncTick();
+
+private:
+    struct Tile {
+        int slotId{0};
+        std::unique_ptr<ChunkIndex> index;
+        QWidget* container{nullptr};
+        QMediaPlayer* player{nullptr};
+        QVideoWidget* video{nullptr};
+        QLabel* status{nullptr};
+        ChunkIndex::Position position;   // Loaded chunk (invalid = idle)
+        qint64 pendingOffsetMs{-1};      // Applied once the media is loaded
+    };
+
+    void setupUi();
+    void clearTiles();
+    Tile* createTile(int slotId, const QString& recordingsDir);
+    void showAt(Tile& tile, qint64 wallMs, bool exact);
+    void showPosition(Tile& tile, const ChunkIndex::Position& position, qint64 offsetMs);
+    void setIdle(Tile& tile, const QString& text);
+    void onMediaStatusChanged(Tile& tile, QMediaPlayer::MediaStatus status);
+    void setPlaying(bool playing);
+    qint64 clockMs() const;
+    void setClock(qint64 wallMs);
+    void updateTimeline(bool reloadDay);
+
+    QPushButton* m_backButton;
+    QPushButton* m_playButton;
+    QPushButton* m_goButton;
+    QDateTimeEdit* m_timeEdit;
+    QLabel* m_statusLabel;
+    TimelineBar* m_timeline;
+    QWidget* m_gridContainer;
+    QGridLayout* m_gridLayout;
+    QTimer* m_syncTimer;
+
+    std::vector<std::unique_ptr<Tile>> m_tiles;
+
+    // Shared clock: m_clockBaseMs at m_clockStarted, advancing while playing
+    qint64 m_clockBaseMs{0};
+    QElapsedTimer m_clockStarted;
+    bool m_playing{false};
+    qint64 m_dayStartMs{0};             // Local day shown by the timeline
+    qint64 m_lastCoverageMs{0};         // Wall clock of the last coverage refresh
+
+    static constexpr int SYNC_INTERVAL_MS = 250;
+    static constexpr qint64 DRIFT_LIMIT_MS = 400;
+    static constexpr qint64 COVERAGE_REFRESH_MS = 30000;  // The live day grows while shown
+};
+
+} // namespace MCM
+
+#endif // PLAYBACKSCREEN_H
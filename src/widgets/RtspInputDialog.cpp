@@ -45,6 +45,18 @@ void RtspInputDialog::setupUi() {
     connect(m_urlEdit, &QLineEdit::returnPressed, this, &RtspInputDialog::onOkClicked);
     mainLayout->addWidget(m_urlEdit);
     
+    // Optional sub-stream (low resolution, shown in the grid)
+    QLabel* subLabel = new QLabel("Sub-stream URL (optional, used for the grid tile):", this);
+    subLabel->setStyleSheet("color: #888;");
+    mainLayout->addWidget(subLabel);
+    
+    m_subUrlEdit = new QLineEdit(this);
+    m_subUrlEdit->setPlaceholderText("rtsp://192.168.1.100:554/stream2");
+    m_subUrlEdit->setMinimumHeight(36);
+    connect(m_subUrlEdit, &QLineEdit::textChanged, this, [this]() { onUrlChanged(m_urlEdit->text()); });
+    connect(m_subUrlEdit, &QLineEdit::returnPressed, this, &RtspInputDialog::onOkClicked);
+    mainLayout->addWidget(m_subUrlEdit);
+    
     // Error label
     m_errorLabel = new QLabel(this);
     m_errorLabel->setStyleSheet("color: #e74c3c;");
@@ -95,21 +107,35 @@ void RtspInputDialog::setUrl(const QString& url) {
     m_urlEdit->setText(url);
 }
 
+QString RtspInputDialog::subStreamUrl() const {
+    return m_subUrlEdit->text().trimmed();
+}
+
+void RtspInputDialog::setSubStreamUrl(const QString& url) {
+    m_subUrlEdit->setText(url);
+}
+
 void RtspInputDialog::onUrlChanged(const QString& text) {
     QString trimmed = text.trimmed();
     bool valid = validateUrl(trimmed);
-    m_okButton->setEnabled(valid);
+    QString sub = subStreamUrl();
+    bool subValid = sub.isEmpty() || validateUrl(sub);
+    m_okButton->setEnabled(valid && subValid);
     
     if (!trimmed.isEmpty() && !valid) {
         m_errorLabel->setText("Invalid RTSP URL format");
         m_errorLabel->show();
+    } else if (!subValid) {
+        m_errorLabel->setText("Invalid sub-stream URL format");
+        m_errorLabel->show();
     } else {
         m_errorLabel->hide();
     }
 }
 
 void RtspInputDialog::onOkClicked() {
-    if (validateUrl(url())) {
+    const QString sub = subStreamUrl();
+    if (validateUrl(url()) && (sub.isEmpty() || validateUrl(sub))) {
         accept();
     }
 }
@@ -29,6 +29,15 @@ public:
      */
     void setUrl(const QString& url);
 
+    /**
+     * @brief Optional low-resolution sub-stream URL (empty = none)
+     *
+     * Played in the grid tile; the main URL is used for recording and the
+     * expanded view.
+     */
+    QString subStreamUrl() const;
+    void setSubStreamUrl(const QString& url);
+
 private slots:
     void onUrlChanged(const QString& text);
     void onOkClicked();
@@ -38,6 +47,7 @@ private:
     bool validateUrl(const QString& url) const;
 
     QLineEdit* m_urlEdit;
+    QLineEdit* m_subUrlEdit;
     QPushButton* m_okButton;
     QPushButton* m_cancelButton;
     QLabel* m_errorLabel;
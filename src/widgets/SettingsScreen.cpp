@@ -134,6 +134,16 @@ void SettingsScreen::updateTotalSlotsLabel() {
     m_totalSlotsLabel->setText(QString::number(total));
 }
 
+void SettingsScreen::updateLatencyModeLabel(int minMaintenance) {
+    if (minMaintenance <= StreamProfile::LOW_LATENCY_MAINTENANCE) {
+        m_latencyModeLabel->setText("Lowest latency");
+    } else if (minMaintenance < StreamProfile::BALANCED_MAINTENANCE) {
+        m_latencyModeLabel->setText("Low latency");
+    } else {
+        m_latencyModeLabel->setText("Balanced");
+    }
+}
+
 QWidget* SettingsScreen::createBufferSection() {
     QGroupBox* group = new QGroupBox("Buffer Configuration", this);
     group->setObjectName("settingsGroup");
@@ -155,17 +165,40 @@ QWidget* SettingsScreen::createBufferSection() {
     m_minMaintenanceSpinBox->setToolTip("Minimum frames before playback starts (5-60)");
     layout->addWidget(m_minMaintenanceSpinBox, 1, 1);
     
+    // Latency vs smoothness - the same setting as a slider; RTSP slots derive
+    // their playback profile from it (see StreamProfile::forMinMaintenance)
+    layout->addWidget(new QLabel("Latency / Smoothness:", this), 2, 0);
+    QHBoxLayout* latencyLayout = new QHBoxLayout();
+    m_latencySlider = new QSlider(Qt::Horizontal, this);
+    m_latencySlider->setRange(m_minMaintenanceSpinBox->minimum(), m_minMaintenanceSpinBox->maximum());
+    m_latencySlider->setToolTip("Left: lowest latency (PTZ, live alerts). Right: smoothest playback");
+    m_latencyModeLabel = new QLabel(this);
+    m_latencyModeLabel->setObjectName("noteLabel");
+    latencyLayout->addWidget(new QLabel("Latency", this));
+    latencyLayout->addWidget(m_latencySlider, 1);
+    latencyLayout->addWidget(new QLabel("Smooth", this));
+    layout->addLayout(latencyLayout, 2, 1);
+    layout->addWidget(m_latencyModeLabel, 2, 2);
+    
+    connect(m_latencySlider, &QSlider::valueChanged, m_minMaintenanceSpinBox, &QSpinBox::setValue);
+    connect(m_minMaintenanceSpinBox, QOverload<int>::of(&QSpinBox::valueChanged),
+            m_latencySlider, &QSlider::setValue);
+    connect(m_minMaintenanceSpinBox, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, &SettingsScreen::updateLatencyModeLabel);
+    
     // Display FPS
-    layout->addWidget(new QLabel("Display FPS:", this), 2, 0);
+    layout->addWidget(new QLabel("Display FPS:", this), 3, 0);
     m_displayFpsSpinBox = new QSpinBox(this);
-    m_displayFpsSpinBox->setRange(5, 60);
-    m_displayFpsSpinBox->setToolTip("Display refresh rate (5-60 fps)");
-    layout->addWidget(m_displayFpsSpinBox, 2, 1);
+    m_displayFpsSpinBox->setRange(0, 60);
+    m_displayFpsSpinBox->setSpecialValueText("Source rate");
+    m_displayFpsSpinBox->setToolTip("Frames per second shown per tile (0 = every frame). "
+                                    "Recording always keeps the full source rate");
+    layout->addWidget(m_displayFpsSpinBox, 3, 1);
     
     // Note
     QLabel* noteLabel = new QLabel("Higher values = smoother playback but more latency", this);
     noteLabel->setObjectName("noteLabel");
-    layout->addWidget(noteLabel, 3, 0, 1, 2);
+    layout->addWidget(noteLabel, 4, 0, 1, 2);
     
     layout->setColumnStretch(2, 1);
     
@@ -213,10 +246,22 @@ QWidget* SettingsScreen::createRecordingSection() {
     // Codec
     layout->addWidget(new QLabel("Video Codec:", this), 4, 0);
     m_codecComboBox = new QComboBox(this);
-    m_codecComboBox->addItems({"mp4v", "avc1", "xvid"});
-    m_codecComboBox->setToolTip("Video codec for recording");
+    m_codecComboBox->addItem("H.264", "h264");
+    m_codecComboBox->addItem("H.265 / HEVC", "hevc");
+    m_codecComboBox->addItem("MPEG-4", "mpeg4");
+    m_codecComboBox->setToolTip("Codec of the default encoding profile (slots may override it). "
+                                "RTSP passthrough keeps the camera's codec");
     layout->addWidget(m_codecComboBox, 4, 1);
     
+    // Mode (pre-/post-roll and motion threshold live in config.json)
+    layout->addWidget(new QLabel("Recording Mode:", this), 5, 0);
+    m_recordingModeComboBox = new QComboBox(this);
+    m_recordingModeComboBox->addItem("Continuous", "continuous");
+    m_recordingModeComboBox->addItem("Event-triggered", "event");
+    m_recordingModeComboBox->setToolTip("Event-triggered: record only around motion, alarm or manual triggers "
+                                        "(right-click a slot), with a pre-roll on RTSP and file slots");
+    layout->addWidget(m_recordingModeComboBox, 5, 1);
+    
     layout->setColumnStretch(2, 1);
     
     return group;
@@ -233,6 +278,7 @@ void SettingsScreen::loadCurrentSettings() {
     // Buffer
     m_frameCountSpinBox->setValue(config.buffer().frameCount);
     m_minMaintenanceSpinBox->setValue(config.buffer().minMaintenance);
+    updateLatencyModeLabel(m_minMaintenanceSpinBox->value());  // No signal if the value did not change
     m_displayFpsSpinBox->setValue(config.buffer().displayFps);
     
     // Recording
@@ -241,35 +287,37 @@ void SettingsScreen::loadCurrentSettings() {
     m_outputDirectoryEdit->setText(config.recording().outputDirectory);
     m_fpsSpinBox->setValue(config.recording().fps);
     
-    int codecIndex = m_codecComboBox->findText(config.recording().codec);
-    if (codecIndex >= 0) {
-        m_codecComboBox->setCurrentIndex(codecIndex);
-    }
+    m_codecComboBox->setCurrentIndex(qMax(0, m_codecComboBox->findData(config.recording().encoding.codec)));
+    m_recordingModeComboBox->setCurrentIndex(qMax(0, m_recordingModeComboBox->findData(config.recording().mode)));
 }
 
 void SettingsScreen::saveSettings() {
     auto& config = Config::instance();
     
+    // Start from the current sections so settings without a widget here
+    // (renderer, encoding profile, preview cap...) survive a save
+    
     // Grid - maxSlots is computed automatically as rows × columns
-    GridConfig gridConfig;
+    GridConfig gridConfig = config.grid();
     gridConfig.rows = m_rowsSpinBox->value();
     gridConfig.columns = m_columnsSpinBox->value();
     config.setGrid(gridConfig);
     
     // Buffer
-    BufferConfig bufferConfig;
+    BufferConfig bufferConfig = config.buffer();
     bufferConfig.frameCount = m_frameCountSpinBox->value();
     bufferConfig.minMaintenance = m_minMaintenanceSpinBox->value();
     bufferConfig.displayFps = m_displayFpsSpinBox->value();
     config.setBuffer(bufferConfig);
     
     // Recording
-    RecordingConfig recordingConfig;
+    RecordingConfig recordingConfig = config.recording();
     recordingConfig.enabled = m_recordingEnabledCheckBox->isChecked();
     recordingConfig.chunkDurationSeconds = m_chunkDurationSpinBox->value();
     recordingConfig.outputDirectory = m_outputDirectoryEdit->text();
     recordingConfig.fps = m_fpsSpinBox->value();
-    recordingConfig.codec = m_codecComboBox->currentText();
+    recordingConfig.encoding.codec = m_codecComboBox->currentData().toString();
+    recordingConfig.mode = m_recordingModeComboBox->currentData().toString();
     config.setRecording(recordingConfig);
     
     // Save to file
@@ -8,6 +8,7 @@
 #include <QComboBox>
 #include <QPushButton>
 #include <QLabel>
+#include <QSlider>
 
 namespace MCM {
 
@@ -16,8 +17,8 @@ namespace MCM {
  * 
  * Allows users to modify:
  * - Grid settings (max slots, rows, columns)
- * - Buffer settings (frame count, min maintenance)
- * - Recording settings (enabled, chunk duration, output dir, fps, codec)
+ * - Buffer settings (frame count, min maintenance / latency slider)
+ * - Recording settings (enabled, chunk duration, output dir, fps, encoding codec)
  */
 class SettingsScreen : public QWidget {
     Q_OBJECT
@@ -45,6 +46,7 @@ private:
     QWidget* createBufferSection();
     QWidget* createRecordingSection();
     void updateTotalSlotsLabel();
+    void updateLatencyModeLabel(int minMaintenance);
 
     // Grid settings
     QLabel* m_totalSlotsLabel;  // Computed: rows × columns
@@ -54,6 +56,8 @@ private:
     // Buffer settings
     QSpinBox* m_frameCountSpinBox;
     QSpinBox* m_minMaintenanceSpinBox;
+    QSlider* m_latencySlider;      // Same value as m_minMaintenanceSpinBox
+    QLabel* m_latencyModeLabel;    // RTSP profile the value selects
     QSpinBox* m_displayFpsSpinBox;
 
     // Recording settings
@@ -62,6 +66,7 @@ private:
     QLineEdit* m_outputDirectoryEdit;
     QSpinBox* m_fpsSpinBox;
     QComboBox* m_codecComboBox;
+    QComboBox* m_recordingModeComboBox;
 
     // Buttons
     QPushButton* m_backButton;
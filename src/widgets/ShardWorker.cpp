@@ -0,0 +1,247 @@
+#include "ShardWorker.h"
+#include "CameraSlot.h"
+#include "core/AnalyticsStage.h"
+#include "core/ChunkIndex.h"
+#include "core/DecoderScheduler.h"
+#include "core/EncoderScheduler.h"
+#include "core/EventTrigger.h"
+#include "core/MemoryGovernor.h"
+#include "core/QtVideoRecorder.h"
+#include "core/RecordingStorage.h"
+#include "core/ShardSupervisor.h"
+#include "core/ThreadPolicy.h"
+#include "utils/DeviceDetector.h"
+#include <QCoreApplication>
+#include <QLocalSocket>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QDebug>
+
+namespace MCM {
+
+ShardWorker::ShardWorker(int shard, const QString& serverName, QObject* parent)
+    : QObject(parent)
+    , m_shard(shard)
+    , m_serverName(serverName)
+{
+}
+
+ShardWorker::~ShardWorker() {
+    for (Slot* slot : std::as_const(m_slots)) {
+        slot->publishTimer.stop();
+        delete slot->camera;
+        delete slot;
+    }
+}
+
+bool ShardWorker::start() {
+    configureServices();
+
+    m_socket = new QLocalSocket(this);
+    m_socket->connectToServer(m_serverName);
+    if (!m_socket->waitForConnected(CONNECT_TIMEOUT_MS)) {
+        qWarning() << "ShardWorker" << m_shard << ": Cannot reach the UI at" << m_serverName
+                   << "-" << m_socket->errorString();
+        return false;
+    }
+    connect(m_socket, &QLocalSocket::readyRead, this, &ShardWorker::onReadyRead);
+    connect(m_socket, &QLocalSocket::disconnected, this, [this]() {
+        if (!m_quitting) {
+            qWarning() << "ShardWorker" << m_shard << ": Lost the UI, stopping";
+            quit();
+        }
+    });
+
+    // Slots are plugged in by index like in the UI
+    m_detector = new DeviceDetector(this);
+    m_detector->startMonitoring(5000);
+
+    send(QJsonObject{{"event", "hello"}, {"shard", m_shard}});
+
+    // Sent from the main loop: it stops when this process hangs
+    connect(&m_heartbeat, &QTimer::timeout, this, [this]() { send(QJsonObject{{"event", "alive"}}); });
+    m_heartbeat.start(ShardSupervisor::HEARTBEAT_INTERVAL_MS);
+    qDebug() << "ShardWorker" << m_shard << ": Connected, pid" << QCoreApplication::applicationPid();
+    return true;
+}
+
+void ShardWorker::configureServices() {
+    const Config& config = Config::instance();
+    const int workers = qMax(1, config.sharding().workers);
+    const QString recordingsDir = QtVideoRecorder::resolveOutputDirectory(config.recording().outputDirectory);
+
+    // Every worker gets its share of the machine's hardware encoder sessions
+    EncoderScheduler& encoders = EncoderScheduler::instance();
+    encoders.setHardwareSessionBudget(config.recording().hardwareEncoderSessions);
+    if (encoders.hardwareSessionBudget() > 0) {
+        encoders.setHardwareSessionBudget(qMax(1, encoders.hardwareSessionBudget() / workers));
+    }
+
+    // Decode engine order for this worker's slots
+    QList<QString> decodeRequests;
+    for (int i = m_shard; i < config.slotCount(); i += workers) {
+        const SourceType type = config.slot(i).type;
+        if (type == SourceType::Rtsp || type == SourceType::File) {
+            decodeRequests.append(config.streamProfile(i).decode);
+        }
+    }
+    DecoderScheduler::instance().configure(config.decode(), decodeRequests);
+
+    // Writeback and back-pressure here; retention runs once, in the UI process
+    RecordingStorage::instance().configure(config.storage(), QString());
+
+    // Analytics batches this worker's slots (one batch per worker and tick)
+    AnalyticsStage::instance().configure(config.analytics());
+
+    // The UI and every worker get an equal part of the memory budget
+    MemoryGovernor::instance().configure(MemoryGovernor::processShare(config.memory(), workers + 1));
+
+    // No UI here: the main thread feeds the preview and is placed like a capture worker
+    ThreadPolicy::instance().configure(config.scheduling(), ThreadPolicy::Role::Capture);
+
+    ChunkIndexWriter::instance().setRootDirectory(recordingsDir);
+    connect(&EventTrigger::instance(), &EventTrigger::triggered, this, [](int slotId, const QString& reason) {
+        ChunkIndexWriter::instance().marker(slotId, reason);
+    });
+}
+
+void ShardWorker::onReadyRead() {
+    while (m_socket->canReadLine()) {
+        const QJsonDocument document = QJsonDocument::fromJson(m_socket->readLine());
+        if (document.isObject()) {
+            handle(document.object());
+        }
+    }
+}
+
+void ShardWorker::handle(const QJsonObject& message) {
+    const QString command = message.value("cmd").toString();
+    const int slotId = message.value("slot").toInt(-1);
+
+    if (command == "start") {
+        startSlot(slotId, message.value("ring").toString(),
+                  SlotConfig::fromJson(message.value("config").toObject()));
+    } else if (command == "stop") {
+        stopSlot(slotId);
+    } else if (command == "trigger") {
+        EventTrigger::instance().trigger(slotId, message.value("reason").toString());
+    } else if (command == "quit") {
+        quit();
+    } else {
+        qWarning() << "ShardWorker" << m_shard << ": Unknown command" << command;
+    }
+}
+
+void ShardWorker::startSlot(int slotId, const QString& ringKey, const SlotConfig& config) {
+    if (slotId < 0 || slotId >= Config::instance().slotCount()) {
+        qWarning() << "ShardWorker" << m_shard << ": No slot" << slotId;
+        return;
+    }
+
+    // The tile's current settings, not necessarily those of the file this process read
+    Config::instance().setSlot(slotId, config);
+
+    Slot* slot = m_slots.value(slotId);
+    if (!slot) {
+        slot = new Slot;
+        slot->camera = new CameraSlot(slotId, m_detector);
+        slot->camera->setRenderDemand(false);  // Never shown; frames go to the ring
+        connect(slot->camera, &CameraSlot::firstFrameReceived, this, [this](int index) {
+            sendState(index, "streaming");
+        });
+        // A source that fails or drops says so rather than sitting in "starting";
+        // back after a loss, it streams again without a new first frame
+        connect(slot->camera, &CameraSlot::connectionChanged, this, [this, slot](int index, bool connected) {
+            if (!connected) {
+                slot->lost = true;
+                sendState(index, "nosignal");
+            } else if (slot->lost) {
+                slot->lost = false;
+                sendState(index, "streaming");
+            }
+        });
+        connect(&slot->publishTimer, &QTimer::timeout, this, [this, slot]() { publish(*slot); });
+        m_slots.insert(slotId, slot);
+    }
+
+    slot->camera->stopStream();
+    if (slot->ring.key() != ringKey || !slot->ring.isAttached()) {
+        slot->ring.attach(ringKey);
+    }
+    slot->published.reset();
+    slot->lost = false;
+
+    slot->camera->startStream();
+    if (!slot->camera->isStreaming()) {
+        sendState(slotId, "nosignal");
+        return;
+    }
+    const int fps = Config::instance().previewFps(slotId);
+    slot->publishTimer.start(1000 / (fps > 0 ? fps : 30));
+    sendState(slotId, "starting");
+}
+
+void ShardWorker::stopSlot(int slotId) {
+    Slot* slot = m_slots.value(slotId);
+    if (!slot) {
+        return;
+    }
+    slot->publishTimer.stop();
+    slot->camera->stopStream();
+    slot->published.reset();
+    sendState(slotId, "stopped");
+}
+
+void ShardWorker::publish(Slot& slot) {
+    const QSize requested = slot.ring.requestedSize();
+    if (requested.isEmpty()) {
+        return;  // Tile hidden
+    }
+    const FrameRef frame = slot.camera->cpuFrame();
+    if (!frame || frame == slot.published) {
+        return;
+    }
+
+    QImage* target = slot.ring.beginWrite(frame->size().scaled(requested, Qt::KeepAspectRatio));
+    if (!target) {
+        return;  // UI still holds the other buffers; the next tick has a newer frame anyway
+    }
+    // Conversion and scaling in one pass, written into shared memory
+    if (!FrameScaler::supports(frame->pixelFormat()) || !slot.scaler.scale(*frame, *target)) {
+        QPainter painter(target);
+        painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.drawImage(target->rect(), frame->toImage());
+    }
+    slot.ring.commit(frame->startTime());
+    slot.published = frame;
+}
+
+void ShardWorker::send(const QJsonObject& message) {
+    if (m_socket && m_socket->state() == QLocalSocket::ConnectedState) {
+        m_socket->write(QJsonDocument(message).toJson(QJsonDocument::Compact) + '\n');
+    }
+}
+
+void ShardWorker::sendState(int slotId, const QString& state) {
+    send(QJsonObject{{"event", "state"}, {"slot", slotId}, {"state", state}});
+}
+
+void ShardWorker::quit() {
+    if (m_quitting) {
+        return;
+    }
+    m_quitting = true;
+    m_heartbeat.stop();
+    for (Slot* slot : std::as_const(m_slots)) {
+        slot->publishTimer.stop();
+        slot->camera->stopStream();  // Finishes the open chunk
+    }
+    if (m_detector) {
+        m_detector->stopMonitoring();
+    }
+    QCoreApplication::quit();
+}
+
+} // namespace MCM
@@ -0,0 +1,83 @@
+#ifndef SHARDWORKER_H
+#define SHARDWORKER_H
+
+#include <QObject>
+#include <QHash>
+#include <QTimer>
+#include "core/Config.h"
+#include "core/FramePool.h"
+#include "core/FrameScaler.h"
+#include "core/SharedFrameRing.h"
+
+class QLocalSocket;
+
+namespace MCM {
+
+class CameraSlot;
+class DeviceDetector;
+
+/**
+ * @brief Worker process of sharded mode (started with --slot-worker)
+ *
+ * Runs the slots ShardSupervisor sends it in hidden CameraSlots - the same
+ * capture, recording, motion and chunk index code as in-process slots,
+ * with tile rendering off. At the slot's preview rate the latest frame is
+ * converted and scaled once, by FrameScaler, straight into a free buffer
+ * of the slot's SharedFrameRing at the size the UI tile asked for.
+ *
+ * Storage retention, snapshots, egress and telemetry export stay in the
+ * UI process. The worker exits when the UI asks it to or its connection
+ * to the UI is lost, finishing open chunks either way. It sends a heartbeat
+ * from its main loop so the UI can kill and restart it when it hangs.
+ */
+class ShardWorker : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @param shard Worker number (owns the slots with slot % workers == shard)
+     * @param serverName ShardSupervisor's local server
+     */
+    ShardWorker(int shard, const QString& serverName, QObject* parent = nullptr);
+    ~ShardWorker() override;
+
+    /**
+     * @brief Configure this process's services and connect to the UI
+     * @return false if the UI cannot be reached
+     */
+    bool start();
+
+private:
+    struct Slot {
+        CameraSlot* camera{nullptr};
+        SharedFrameRing ring;
+        QTimer publishTimer;
+        FrameScaler scaler;
+        FrameRef published;   // Last frame put into the ring (pointer identity = same frame)
+        bool lost{false};     // Reported "nosignal" since the last start
+    };
+
+    void configureServices();
+    void onReadyRead();
+    void handle(const QJsonObject& message);
+    void startSlot(int slotId, const QString& ringKey, const SlotConfig& config);
+    void stopSlot(int slotId);
+    void publish(Slot& slot);
+    void send(const QJsonObject& message);
+    void sendState(int slotId, const QString& state);
+    void quit();
+
+    int m_shard;
+    QString m_serverName;
+    QLocalSocket* m_socket{nullptr};
+    DeviceDetector* m_detector{nullptr};
+    QHash<int, Slot*> m_slots;
+    QTimer m_heartbeat;
+    bool m_quitting{false};
+
+    static constexpr int CONNECT_TIMEOUT_MS = 5000;
+};
+
+} // namespace MCM
+
+#endif // SHARDWORKER_H
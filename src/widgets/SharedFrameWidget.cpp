@@ -0,0 +1,117 @@
+#include "SharedFrameWidget.h"
+#include "core/SharedFrameRing.h"
+#include <QPainter>
+#include <QResizeEvent>
+
+namespace MCM {
+
+SharedFrameWidget::SharedFrameWidget(QWidget* parent)
+    : QWidget(parent)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setAttribute(Qt::WA_TransparentForMouseEvents);  // Double-click and context menu reach the slot
+    setGeometry(parent->rect());
+    parent->installEventFilter(this);
+
+    m_pollTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_pollTimer, &QTimer::timeout, this, &SharedFrameWidget::poll);
+    m_fpsClock.start();
+}
+
+SharedFrameWidget::~SharedFrameWidget() = default;
+
+void SharedFrameWidget::setRing(SharedFrameRing* ring, int fps) {
+    m_ring = ring;
+    m_shownSequence = 0;
+    m_fps = 0.0;
+    m_framesThisSecond = 0;
+    m_pollTimer.setInterval(1000 / (fps > 0 ? fps : DEFAULT_FPS));
+    if (m_ring && m_active) {
+        updateRequestedSize();
+        m_pollTimer.start();
+    } else {
+        m_pollTimer.stop();
+    }
+    update();
+}
+
+void SharedFrameWidget::setActive(bool active) {
+    if (m_active == active) {
+        return;
+    }
+    m_active = active;
+    if (!m_ring) {
+        return;
+    }
+    if (active) {
+        updateRequestedSize();
+        m_pollTimer.start();
+    } else {
+        m_ring->setRequestedSize(QSize());
+        m_pollTimer.stop();
+    }
+}
+
+void SharedFrameWidget::poll() {
+    if (m_fpsClock.elapsed() >= 1000) {
+        m_fps = m_framesThisSecond * 1000.0 / m_fpsClock.restart();
+        m_framesThisSecond = 0;
+    }
+    if (m_ring && m_ring->sequence() != m_shownSequence) {
+        update();
+    }
+}
+
+void SharedFrameWidget::paintEvent(QPaintEvent* event) {
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(26, 26, 46));  // Same background as the in-process tiles
+
+    if (!m_ring) {
+        return;
+    }
+    SharedFrameRing::Frame frame = m_ring->acquire();
+    if (!frame.isValid()) {
+        return;
+    }
+    if (frame.sequence != m_shownSequence) {
+        m_shownSequence = frame.sequence;
+        m_framesThisSecond++;
+    }
+
+    // Frames are rendered for this widget's device pixels; blit them 1:1
+    // unless a resize has not reached the worker yet
+    frame.image.setDevicePixelRatio(devicePixelRatioF());
+    const QSize shown = frame.image.deviceIndependentSize().toSize();
+    QRect target(QPoint(0, 0), shown.scaled(size(), Qt::KeepAspectRatio));
+    target.moveCenter(rect().center());
+    if (target.size() == shown) {
+        painter.drawImage(target.topLeft(), frame.image);
+    } else {
+        painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+        painter.drawImage(target, frame.image);
+    }
+    m_ring->release(frame);
+}
+
+void SharedFrameWidget::resizeEvent(QResizeEvent* event) {
+    QWidget::resizeEvent(event);
+    if (m_ring && m_active) {
+        updateRequestedSize();
+    }
+}
+
+bool SharedFrameWidget::eventFilter(QObject* watched, QEvent* event) {
+    // Follow the video widget's size
+    if (watched == parentWidget() && event->type() == QEvent::Resize) {
+        setGeometry(parentWidget()->rect());
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+void SharedFrameWidget::updateRequestedSize() {
+    m_ring->setRequestedSize(size() * devicePixelRatioF());
+}
+
+} // namespace MCM
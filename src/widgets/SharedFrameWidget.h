@@ -0,0 +1,70 @@
+#ifndef SHAREDFRAMEWIDGET_H
+#define SHAREDFRAMEWIDGET_H
+
+#include <QWidget>
+#include <QTimer>
+#include <QElapsedTimer>
+
+namespace MCM {
+
+class SharedFrameRing;
+
+/**
+ * @brief Tile display of a slot running in a worker process
+ *
+ * Covers its parent (the slot's video widget) and paints the newest frame
+ * of the slot's SharedFrameRing straight from shared memory - the frame is
+ * held for the duration of the paint and never copied into this process.
+ * The ring is polled at the slot's preview rate; a frame is painted only
+ * when the worker published a new one. The widget's size goes back to the
+ * worker as the requested frame size, so frames arrive already scaled and
+ * are blitted without scaling.
+ */
+class SharedFrameWidget : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit SharedFrameWidget(QWidget* parent);
+    ~SharedFrameWidget() override;
+
+    /**
+     * @brief Show a ring's frames (nullptr = none)
+     * @param fps Polling rate (0 = 30)
+     */
+    void setRing(SharedFrameRing* ring, int fps);
+
+    /**
+     * @brief Stop polling and ask the worker for no frames (tile hidden)
+     */
+    void setActive(bool active);
+
+    /**
+     * @brief Shared frames shown per second, over the last second
+     */
+    double fps() const { return m_fps; }
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    void poll();
+    void updateRequestedSize();
+
+    SharedFrameRing* m_ring{nullptr};
+    QTimer m_pollTimer;
+    bool m_active{true};
+    quint64 m_shownSequence{0};
+
+    // Shown-frame rate
+    QElapsedTimer m_fpsClock;
+    int m_framesThisSecond{0};
+    double m_fps{0.0};
+
+    static constexpr int DEFAULT_FPS = 30;
+};
+
+} // namespace MCM
+
+#endif // SHAREDFRAMEWIDGET_H
@@ -1,10 +1,23 @@
 #include "VideoWidget.h"
 #include <QPainter>
 #include <QResizeEvent>
-#include <opencv2/imgproc.hpp>
+#include <QMetaObject>
 
 namespace MCM {
 
+namespace {
+
+quint32 packSize(const QSize& size) {
+    return static_cast<quint32>(qBound(0, size.width(), 0xffff)) << 16
+         | static_cast<quint32>(qBound(0, size.height(), 0xffff));
+}
+
+QSize unpackSize(quint32 packed) {
+    return QSize(static_cast<int>(packed >> 16), static_cast<int>(packed & 0xffff));
+}
+
+} // namespace
+
 VideoWidget::VideoWidget(QWidget* parent)
     : QWidget(parent)
 {
@@ -12,136 +25,128 @@ VideoWidget::VideoWidget(QWidget* parent)
     setAttribute(Qt::WA_OpaquePaintEvent);  // No background erase needed
     setMinimumSize(160, 120);
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    m_targetSize = packSize(size());
 }
 
 VideoWidget::~VideoWidget() = default;
 
 void VideoWidget::displayFrame(const cv::Mat& frame) {
-    if (frame.empty()) {
+    if (frame.empty() || frame.depth() != CV_8U) {
         return;
     }
-    
-    QMutexLocker locker(&m_mutex);
-    
-    // Reuse or resize conversion buffer
-    int w = frame.cols;
-    int h = frame.rows;
-    
-    if (m_conversionBuffer.isNull() || 
-        m_conversionBuffer.width() != w || 
-        m_conversionBuffer.height() != h) {
-        m_conversionBuffer = QImage(w, h, QImage::Format_RGB888);
-    }
-    
-    // Convert BGR to RGB directly into our buffer (no allocation)
-    if (frame.type() == CV_8UC3) {
-        // BGR -> RGB conversion
-        cv::Mat rgb(h, w, CV_8UC3, m_conversionBuffer.bits(), m_conversionBuffer.bytesPerLine());
-        cv::cvtColor(frame, rgb, cv::COLOR_BGR2RGB);
-    } else if (frame.type() == CV_8UC1) {
-        // Grayscale -> RGB
-        cv::Mat rgb(h, w, CV_8UC3, m_conversionBuffer.bits(), m_conversionBuffer.bytesPerLine());
-        cv::cvtColor(frame, rgb, cv::COLOR_GRAY2RGB);
-    } else {
-        return;  // Unsupported format
+
+    // Wrap the Mat's pixels (no copy); the QPainter pass converts and scales
+    QImage::Format format = QImage::Format_Invalid;
+    switch (frame.channels()) {
+        case 1: format = QImage::Format_Grayscale8; break;
+        case 3: format = QImage::Format_BGR888; break;
+        case 4: format = QImage::Format_RGB32; break;  // BGRA bytes
+        default: return;  // Unsupported format
     }
-    
-    // Store current frame
-    m_currentFrame = m_conversionBuffer;  // Shallow copy (shares data)
-    m_needsRescale = true;
-    
-    // Trigger repaint
-    update();
+    displayFrame(QImage(frame.data, frame.cols, frame.rows, static_cast<qsizetype>(frame.step), format));
 }
 
 void VideoWidget::displayFrame(const QImage& frame) {
     if (frame.isNull()) {
         return;
     }
-    
-    QMutexLocker locker(&m_mutex);
-    
-    // Convert to RGB888 if needed (for consistent handling)
-    if (frame.format() != QImage::Format_RGB888) {
-        m_currentFrame = frame.convertToFormat(QImage::Format_RGB888);
-    } else {
-        m_currentFrame = frame;
+
+    QImage* target = backBuffer(frame.size());
+    if (!target) {
+        return;
+    }
+
+    // Format conversion and scaling in one pass into the persistent buffer
+    {
+        QPainter painter(target);
+        painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.drawImage(target->rect(), frame);
+    }
+    publish();
+}
+
+void VideoWidget::displayFrame(const FrameRef& frame) {
+    if (!frame) {
+        return;
+    }
+    if (!FrameScaler::supports(frame->pixelFormat())) {
+        displayFrame(frame->toImage());  // Rare formats: Qt converts, then the QPainter pass
+        return;
+    }
+
+    QImage* target = backBuffer(frame->size());
+    if (!target || !m_scaler.scale(*frame, *target)) {
+        return;
+    }
+    publish();
+}
+
+QImage* VideoWidget::backBuffer(const QSize& frameSize) {
+    const QSize scaledSize = frameSize.scaled(unpackSize(m_targetSize.load(std::memory_order_relaxed)),
+                                              Qt::KeepAspectRatio);
+    if (scaledSize.isEmpty()) {
+        return nullptr;
+    }
+
+    // Reallocated only when the tile or frame shape changes
+    QImage& image = m_buffers[m_back];
+    if (image.size() != scaledSize || image.format() != QImage::Format_RGB32) {
+        image = QImage(scaledSize, QImage::Format_RGB32);
+    }
+    return &image;
+}
+
+void VideoWidget::publish() {
+    m_back = m_ready.exchange(m_back | NEW_FRAME, std::memory_order_acq_rel) & INDEX_MASK;
+    m_hasFrame.store(true, std::memory_order_relaxed);
+
+    // One pending repaint, however many frames arrive before it runs
+    if (!m_updateQueued.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(this, [this]() {
+            m_updateQueued.store(false, std::memory_order_release);
+            update();
+        }, Qt::QueuedConnection);
     }
-    
-    m_needsRescale = true;
-    
-    // Trigger repaint
-    update();
 }
 
 void VideoWidget::clear() {
-    QMutexLocker locker(&m_mutex);
-    m_currentFrame = QImage();
-    m_scaledFrame = QImage();
-    m_displayImage = QImage();
-    m_needsRescale = true;
+    m_hasFrame.store(false, std::memory_order_relaxed);
     update();
 }
 
 void VideoWidget::paintEvent(QPaintEvent* event) {
     Q_UNUSED(event);
-    
+
     QPainter painter(this);
-    painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
-    
+
     // Fill background
     painter.fillRect(rect(), QColor(26, 26, 46));  // Dark background
-    
-    QMutexLocker locker(&m_mutex);
-    
-    if (m_currentFrame.isNull()) {
-        return;
+
+    if (m_ready.load(std::memory_order_acquire) & NEW_FRAME) {
+        m_front = m_ready.exchange(m_front, std::memory_order_acq_rel) & INDEX_MASK;
     }
-    
-    // Rescale only if needed
-    if (m_needsRescale || m_lastSize != size()) {
-        updateScaledImage();
-        m_lastSize = size();
-        m_needsRescale = false;
+
+    const QImage& image = m_buffers[m_front];
+    if (!hasFrame() || image.isNull()) {
+        return;
     }
-    
-    if (!m_displayImage.isNull()) {
-        // Center the image
-        int x = (width() - m_displayImage.width()) / 2;
-        int y = (height() - m_displayImage.height()) / 2;
-        
-        // Draw directly (no QPixmap conversion)
-        painter.drawImage(x, y, m_displayImage);
+
+    // Center the image; it already has the fitted size, except for the
+    // frames between a resize and the next delivered frame
+    QRect target(QPoint(0, 0), image.size().scaled(size(), Qt::KeepAspectRatio));
+    target.moveCenter(rect().center());
+    if (target.size() == image.size()) {
+        painter.drawImage(target.topLeft(), image);  // Plain blit
+    } else {
+        painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+        painter.drawImage(target, image);
     }
 }
 
 void VideoWidget::resizeEvent(QResizeEvent* event) {
     QWidget::resizeEvent(event);
-    m_needsRescale = true;
-}
-
-void VideoWidget::updateScaledImage() {
-    if (m_currentFrame.isNull()) {
-        return;
-    }
-    
-    QSize targetSize = size();
-    QSize frameSize = m_currentFrame.size();
-    
-    // Calculate scaled size maintaining aspect ratio
-    QSize scaledSize = frameSize.scaled(targetSize, Qt::KeepAspectRatio);
-    
-    // Only rescale if size actually changed
-    if (m_scaledFrame.size() != scaledSize) {
-        m_scaledFrame = m_currentFrame.scaled(
-            scaledSize,
-            Qt::KeepAspectRatio,
-            Qt::SmoothTransformation  // Keep quality
-        );
-    }
-    
-    m_displayImage = m_scaledFrame;
+    m_targetSize.store(packSize(event->size()), std::memory_order_relaxed);
 }
 
 } // namespace MCM
-
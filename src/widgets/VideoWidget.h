@@ -3,19 +3,31 @@
 
 #include <QWidget>
 #include <QImage>
-#include <QMutex>
+#include <atomic>
 #include <opencv2/core.hpp>
+#include "core/FramePool.h"
+#include "core/FrameScaler.h"
 
 namespace MCM {
 
 /**
- * @brief High-performance video display widget
- * 
+ * @brief Software video display widget (CPU rendering fallback)
+ *
+ * For machines whose GPU driver cannot run QGraphicsVideoItem. Frames are
+ * converted and scaled to the widget's size by the thread that delivers
+ * them, so paintEvent() only blits an image that already has the right
+ * size and format (RGB32, QPainter's native format).
+ *
  * Optimizations:
- * - Direct QPainter rendering (no QLabel/QPixmap overhead)
- * - BGR to RGB conversion only when needed
- * - Scaling only on resize (cached)
- * - Reusable frame buffer
+ * - Decoded frames (FrameRef): YUV -> RGB and scaling fused in one SIMD
+ *   pass (FrameScaler), reading only the source pixels that are shown
+ * - QImage / cv::Mat: converted and scaled in one QPainter pass, no
+ *   per-frame allocation (cv::Mat is wrapped, not copied)
+ * - Render targets are persistent and reused while the size is unchanged
+ * - No mutex: a triple buffer hands finished images to paintEvent()
+ *   with atomic swaps, and repaints are coalesced to one queued update
+ *
+ * displayFrame() may be called from any one thread at a time.
  */
 class VideoWidget : public QWidget {
     Q_OBJECT
@@ -26,7 +38,7 @@ public:
 
     /**
      * @brief Display a frame (BGR format from OpenCV)
-     * @param frame BGR cv::Mat from camera
+     * @param frame BGR, BGRA or grayscale cv::Mat from camera
      */
     void displayFrame(const cv::Mat& frame);
 
@@ -36,6 +48,12 @@ public:
      */
     void displayFrame(const QImage& frame);
 
+    /**
+     * @brief Display a decoded frame (fast path for YUV and 32-bit RGB formats)
+     * @param frame Pooled CPU copy, e.g. CameraSlot::cpuFrame()
+     */
+    void displayFrame(const FrameRef& frame);
+
     /**
      * @brief Clear the display
      */
@@ -44,38 +62,45 @@ public:
     /**
      * @brief Check if widget has a valid frame
      */
-    bool hasFrame() const { return !m_displayImage.isNull(); }
+    bool hasFrame() const { return m_hasFrame.load(std::memory_order_relaxed); }
 
 protected:
     void paintEvent(QPaintEvent* event) override;
     void resizeEvent(QResizeEvent* event) override;
 
 private:
-    void updateScaledImage();
-
-    // Current frame (original resolution)
-    QImage m_currentFrame;
-    
-    // Scaled frame for display (cached)
-    QImage m_scaledFrame;
-    
-    // Display image (what gets painted)
-    QImage m_displayImage;
-    
-    // Reusable buffer for BGR->RGB conversion
-    QImage m_conversionBuffer;
-    
-    // Last known size (for resize detection)
-    QSize m_lastSize;
-    
-    // Flag to indicate frame needs rescaling
-    bool m_needsRescale{true};
-    
-    // Thread safety
-    mutable QMutex m_mutex;
+    /**
+     * @brief Producer's render target, sized to fit a frame of @p frameSize
+     * @return nullptr while the widget has no size
+     */
+    QImage* backBuffer(const QSize& frameSize);
+
+    /**
+     * @brief Hand the back buffer to paintEvent() and schedule a repaint
+     */
+    void publish();
+
+    static constexpr int NEW_FRAME = 4;   // m_ready flag: not shown yet
+    static constexpr int INDEX_MASK = 3;
+
+    // Triple buffer: the producer owns m_back, paintEvent() owns m_front,
+    // m_ready holds the last finished one. Swapping through m_ready never
+    // hands either side a buffer the other is using.
+    QImage m_buffers[3];
+    int m_back{0};                        // Producer thread
+    int m_front{1};                       // GUI thread
+    std::atomic<int> m_ready{2};
+
+    // Widget size for the producer (width << 16 | height)
+    std::atomic<quint32> m_targetSize{0};
+
+    std::atomic<bool> m_hasFrame{false};
+    std::atomic<bool> m_updateQueued{false};
+
+    // Producer thread
+    FrameScaler m_scaler;
 };
 
 } // namespace MCM
 
 #endif // VIDEOWIDGET_H
-